@@ -675,7 +675,9 @@ std::vector<std::byte> mainEncodeFun() {
     ZoneScoped
     LTRACE("main::mainEncodeFun(begin)");
 
-    std::vector<std::byte> data = global::openSpaceEngine->encode();
+    // SGCT takes ownership of the bytes, so this is the only copy of the encoded frame
+    SyncBufferView view = global::openSpaceEngine->encode();
+    std::vector<std::byte> data(view.data, view.data + view.size);
 
     LTRACE("main::mainEncodeFun(end)");
     return data;
@@ -687,7 +689,7 @@ void mainDecodeFun(const std::vector<std::byte>& data, unsigned int) {
     ZoneScoped
     LTRACE("main::mainDecodeFun(begin)");
 
-    global::openSpaceEngine->decode(data);
+    global::openSpaceEngine->decode({ data.data(), data.size() });
 
     LTRACE("main::mainDecodeFun(end)");
 }
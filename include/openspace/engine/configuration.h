@@ -70,6 +70,9 @@ struct Configuration {
 
     std::string versionCheckUrl;
     bool useMultithreadedInitialization = false;
+    bool useDeltaSyncEncoding = false;
+    bool useParallelSceneUpdate = false;
+    int ephemerisCacheMemory = 64;
 
     struct LoadingScreen {
         bool isShowingMessages = true;
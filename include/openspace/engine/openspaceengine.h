@@ -28,6 +28,7 @@
 #include <openspace/properties/stringproperty.h>
 #include <openspace/util/keys.h>
 #include <openspace/util/mouse.h>
+#include <openspace/util/syncbuffer.h>
 #include <openspace/util/touch.h>
 #include <openspace/util/versionchecker.h>
 #include <ghoul/glm.h>
@@ -87,8 +88,8 @@ public:
     void touchUpdateCallback(TouchInput input);
     void touchExitCallback(TouchInput input);
     void handleDragDrop(const std::string& file);
-    std::vector<std::byte> encode();
-    void decode(std::vector<std::byte> data);
+    SyncBufferView encode();
+    void decode(SyncBufferView data);
 
     void scheduleLoadSingleAsset(std::string assetPath);
     void toggleShutdownMode();
@@ -50,16 +50,27 @@ public:
     SyncEngine(unsigned int syncBufferSize);
 
     /**
-     * Encodes all added Syncables in the injected <code>SyncBuffer</code>.
-     * This method is only called on the SGCT master node
+     * Encodes all added Syncables in the injected <code>SyncBuffer</code>. The buffer is
+     * reused between frames and the returned view is valid until the next call to this
+     * function. This method is only called on the SGCT master node
      */
-    std::vector<std::byte> encodeSyncables();
+    SyncBufferView encodeSyncables();
 
     /**
-     * Decodes the <code>SyncBuffer</code> into the added Syncables.
+     * Decodes \p data into the added Syncables without copying it.
      * This method is only called on the SGCT slave nodes
      */
-    void decodeSyncables(std::vector<std::byte> data);
+    void decodeSyncables(SyncBufferView data);
+
+    /**
+     * Enables or disables delta encoding. If it is enabled, Syncables that are delta
+     * encodable (see Syncable::isDeltaEncodable) are only transmitted in frames in which
+     * their encoded state differs from the previous frame. As SGCT only starts a new
+     * frame after all nodes have received the previous one, the previous frame is always
+     * known to have arrived. Which encoding was used is stored in each frame, so only the
+     * master node has to enable this
+     */
+    void setDeltaEncodingEnabled(bool enabled);
 
     /**
      * Invokes the presync method of all added Syncables
@@ -103,6 +114,20 @@ private:
      * Databuffer used in encoding/decoding
      */
     SyncBuffer _syncBuffer;
+
+    bool _isDeltaEncodingEnabled = false;
+
+    /**
+     * If this is true, the next delta encoded frame transmits all Syncables, which is
+     * necessary after the list of Syncables has changed
+     */
+    bool _needsFullFrame = true;
+
+    /**
+     * The bytes that were last transmitted for each of the Syncables when delta encoding
+     * is used
+     */
+    std::vector<std::vector<std::byte>> _previousEncodings;
 };
 
 } // namespace openspace
@@ -30,6 +30,7 @@
 #include <ghoul/glm.h>
 #include <ghoul/misc/boolean.h>
 #include <glm/gtx/quaternion.hpp>
+#include <optional>
 
 namespace openspace {
     class Camera;
@@ -71,6 +72,26 @@ public:
     static bool updateCamera(Camera* camera, const CameraPose prevPose,
         const CameraPose nextPose, double t, bool ignoreFutureKeyframes);
 
+    /**
+     * Returns the camera position in world space that is described by the \p pose,
+     * based on the current position and rotation of its focus node.
+     *
+     * \param pose The camera pose whose position is computed
+     * \return The world space position, or \c std::nullopt if the focus node of the
+     *         \p pose does not exist
+     */
+    static std::optional<glm::dvec3> cameraWorldPosition(const CameraPose& pose);
+
+    /**
+     * Returns the camera position in world space that the keyframes describe
+     * \p secondsAhead seconds of application time from now.
+     *
+     * \param secondsAhead The number of seconds to look ahead in the timeline
+     * \return The interpolated world space position, or \c std::nullopt if there are
+     *         no keyframes at or after that time
+     */
+    std::optional<glm::dvec3> futureCameraPosition(double secondsAhead) const;
+
     Timeline<CameraPose>& timeline();
     void addKeyframe(double timestamp, KeyframeNavigator::CameraPose pose);
     void removeKeyframesAfter(double timestamp, Inclusive inclusive = Inclusive::No);
@@ -29,6 +29,7 @@
 #include <openspace/interaction/keyframenavigator.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/scripting/lualibrary.h>
+#include <optional>
 #include <vector>
 
 namespace openspace::interaction {
@@ -188,6 +189,16 @@ public:
      */
     bool isPlayingBack() const;
 
+    /**
+     * Returns the camera position in world space that the playback will reach
+     * \p secondsAhead seconds from now.
+     *
+     * \param secondsAhead The number of seconds to look ahead in the playback
+     * \return The interpolated world space position, or \c std::nullopt if no camera
+     *         playback is active or the camera keyframes end before that time
+     */
+    std::optional<glm::dvec3> futureCameraPosition(double secondsAhead) const;
+
     /**
      * Is saving frames during playback
      */
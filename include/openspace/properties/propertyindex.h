@@ -0,0 +1,191 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___PROPERTYINDEX___H__
+#define __OPENSPACE_CORE___PROPERTYINDEX___H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace::properties {
+
+class Property;
+class PropertyOwner;
+
+/**
+ * The PropertyIndex provides fast lookup of the Propertys that are owned by a list of
+ * root PropertyOwners, either through their fully qualified URI, through a tag of one of
+ * their (indirect) owners, or through the wildcard patterns that are accepted by the
+ * <code>openspace.setPropertyValue</code> function. The index is updated lazily
+ * whenever the PropertyOwner::structureVersion has changed since the last query. Only
+ * the subtrees whose PropertyOwner::subtreeVersion is newer than the index are visited
+ * and only the PropertyOwners whose Propertys, URI, or tags have changed are indexed
+ * again, so adding or removing a scene graph node does not cause the whole property
+ * tree to be traversed.
+ *
+ * The results of wildcard queries are cached per pattern, which means that repeatedly
+ * setting the same group of Propertys only costs as much as the number of matches. A
+ * cached result is only discarded if one of the URIs that have been added or removed
+ * since it was cached matches its pattern. All returned references are only valid until
+ * the next query after the structure of the property tree has changed.
+ */
+class PropertyIndex {
+public:
+    /**
+     * Sets the root PropertyOwners whose Propertys are contained in this index. The
+     * Propertys are ordered in the same way as if PropertyOwner::propertiesRecursive
+     * were called for each of the \p roots in order.
+     *
+     * \param roots The PropertyOwners that are the roots of the indexed property trees
+     */
+    void setRootOwners(std::vector<const PropertyOwner*> roots);
+
+    /**
+     * Returns all Propertys that are owned directly or indirectly by the root owners.
+     *
+     * \return All Propertys that are owned by the root owners
+     */
+    const std::vector<Property*>& properties();
+
+    /**
+     * Returns the Property with the fully qualified \p uri or \c nullptr if no such
+     * Property exists.
+     *
+     * \param uri The fully qualified URI of the Property that should be returned
+     * \return The Property identified by the \p uri or \c nullptr
+     */
+    Property* property(const std::string& uri);
+
+    /**
+     * Returns all Propertys whose owner, or any owner further up the hierarchy, has been
+     * assigned the \p tag.
+     *
+     * \param tag The tag that is searched for
+     * \return All Propertys that are owned by a PropertyOwner with the \p tag
+     */
+    const std::vector<Property*>& propertiesWithTag(const std::string& tag);
+
+    /**
+     * Returns all Propertys whose fully qualified URI matches the \p regex. The
+     * \p regex is either a literal URI or contains a single <code>*</code> that
+     * separates a node name part from a property name part. If \p groupName is not
+     * empty, only Propertys that are owned by a PropertyOwner tagged with the
+     * \p groupName are considered.
+     *
+     * \param regex The literal URI or wildcard pattern that is matched
+     * \param groupName The optional tag that the Propertys' owners must have
+     * \return The list of matching Propertys
+     *
+     * \pre \p regex must not contain more than one <code>*</code>
+     */
+    const std::vector<Property*>& matchingProperties(const std::string& regex,
+        const std::string& groupName = "");
+
+private:
+    /// The state of a PropertyOwner at the time it was last indexed
+    struct OwnerEntry {
+        /// The owner through which the PropertyOwner was indexed or nullptr for a root
+        const PropertyOwner* parent = nullptr;
+        /// The fully qualified URI of the PropertyOwner including the separator
+        std::string uriPrefix;
+        /// The tags of the PropertyOwner and of all owners up to the root
+        std::vector<std::string> tags;
+        std::vector<Property*> properties;
+        /// The fully qualified URIs of the properties, referenced by _propertiesByUri
+        std::vector<std::string> uris;
+        std::vector<const PropertyOwner*> subOwners;
+    };
+
+    /// Updates the parts of the index whose structure has changed since the last query
+    void updateIfNeeded();
+
+    /**
+     * Indexes the Propertys of the \p owner if they have changed and visits all
+     * sub-owners whose subtree has changed. The \p uriPrefix is the fully qualified URI
+     * of the \p owner including the separator and \p inheritedTags contains the tags of
+     * all PropertyOwners above the \p owner. If \p isForced is \c true, the whole
+     * subtree is indexed again, as the URI prefix or the tags have changed further up.
+     */
+    void updateOwner(const PropertyOwner& owner, const PropertyOwner* parent,
+        std::string uriPrefix, const std::vector<std::string>& inheritedTags,
+        bool isForced);
+
+    /**
+     * Removes the \p owner and its subtree from the index if it was indexed through the
+     * \p parent. The \p owner is not dereferenced, as it might already be destroyed.
+     */
+    void removeOwner(const PropertyOwner* owner, const PropertyOwner* parent);
+
+    /**
+     * Adds or removes the \p uri of the \p prop to or from _propertiesByUri. If
+     * \p isChanged is \c false, the \p uri is only moved to a different OwnerEntry and
+     * does not invalidate any cached patterns.
+     */
+    void addUri(const std::string& uri, Property* prop, bool isChanged);
+    void removeUri(const std::string& uri, Property* prop, bool isChanged);
+
+    /// Discards the cached patterns that match any of the _changedUris
+    void invalidatePatternCache();
+
+    /// Recreates _properties, _uris, and _propertiesByTag if the index has changed
+    void updateOrderedProperties();
+    void addOrderedProperties(const PropertyOwner* owner);
+
+    std::vector<Property*> findMatchingProperties(const std::string& regex,
+        const std::string& groupName);
+
+    std::vector<const PropertyOwner*> _roots;
+    uint64_t _version = 0;
+    bool _isDirty = true;
+
+    std::unordered_map<const PropertyOwner*, OwnerEntry> _owners;
+    /// Maps from the URIs, which are owned by the OwnerEntrys, to the Propertys
+    std::unordered_map<std::string_view, Property*> _propertiesByUri;
+    /// The URIs that have been added or removed since the last invalidation of the
+    /// pattern cache
+    std::vector<std::string> _changedUris;
+
+    /// Whether the following members have to be recreated from the OwnerEntrys
+    bool _isOrderDirty = true;
+    std::vector<Property*> _properties;
+    /// The fully qualified URIs of all Propertys in the same order as _properties
+    std::vector<std::string_view> _uris;
+
+    struct TaggedProperties {
+        std::vector<Property*> properties;
+        /// The locations of the Propertys in _properties and _uris
+        std::vector<size_t> locations;
+    };
+    std::unordered_map<std::string, TaggedProperties> _propertiesByTag;
+
+    /// The cached results of previous matchingProperties queries
+    std::unordered_map<std::string, std::vector<Property*>> _patternCache;
+};
+
+} // namespace openspace::properties
+
+#endif // __OPENSPACE_CORE___PROPERTYINDEX___H__
@@ -27,8 +27,11 @@
 
 #include <openspace/documentation/documentationgenerator.h>
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace openspace::properties {
@@ -141,13 +144,14 @@ public:
      * by this PropertyOwner. If the identifier contains one or more <code>.</code>, the
      * first part of the name will be recursively extracted and used as a name for a
      * sub-owner and only the last part of the identifier is referring to a Property owned
-     * by PropertyOwner named by the second-but-last name.
+     * by PropertyOwner named by the second-but-last name. The \p uri is resolved in
+     * place without creating any temporary strings.
      *
      * \param uri The identifier of the Property that should be extracted
      * \return If the Property cannot be found, \c nullptr is returned, otherwise the
      *         pointer to the Property is returned
      */
-    Property* property(const std::string& uri) const;
+    Property* property(std::string_view uri) const;
 
     /**
      * This method checks if a Property with the provided \p uri exists in this
@@ -158,7 +162,7 @@ public:
      *
      * \return \c true if the \p uri refers to a Property; \c false otherwise.
      */
-    bool hasProperty(const std::string& uri) const;
+    bool hasProperty(std::string_view uri) const;
 
     /**
     * This method checks if a Property exists in this PropertyOwner.
@@ -166,7 +170,7 @@ public:
     */
     bool hasProperty(const Property* prop) const;
 
-    void setPropertyOwner(PropertyOwner* owner) { _owner = owner; }
+    void setPropertyOwner(PropertyOwner* owner);
     PropertyOwner* owner() const { return _owner; }
 
     /**
@@ -188,7 +192,7 @@ public:
      * \param identifier The identifier of the sub-owner that should be returned
      * \return The PropertyOwner with the given \p name, or \c nullptr
      */
-    PropertyOwner* propertySubOwner(const std::string& identifier) const;
+    PropertyOwner* propertySubOwner(std::string_view identifier) const;
 
     /**
      * Returns \c true if this PropertyOwner owns a sub-owner with the provided
@@ -198,7 +202,7 @@ public:
      * \return \c true if this PropertyOwner owns a sub-owner with the provided
      *         \p identifier; returns \c false otherwise
      */
-    bool hasPropertySubOwner(const std::string& identifier) const;
+    bool hasPropertySubOwner(std::string_view identifier) const;
 
     /**
      * This method converts a provided \p groupID, used by the Propertys, into a
@@ -294,6 +298,25 @@ public:
     // Generate JSON for documentation
     std::string generateJson() const override;
 
+    /**
+     * Returns a counter that is incremented whenever any PropertyOwner changes in a way
+     * that might change the URI or the tags of a Property, for example when adding or
+     * removing Propertys and sub-owners, or changing an identifier. This can be used to
+     * invalidate data that is derived from the property tree, such as a PropertyIndex.
+     *
+     * \return The current version of the structure of all PropertyOwners
+     */
+    static uint64_t structureVersion();
+
+    /**
+     * Returns the value of #structureVersion after the most recent change to this
+     * PropertyOwner or any of its direct or indirect sub-owners. Data derived from the
+     * property tree can use this to only update the subtrees that have changed.
+     *
+     * \return The version of the structure of this PropertyOwner's subtree
+     */
+    uint64_t subtreeVersion() const;
+
 protected:
     /// The unique identifier of this PropertyOwner
     std::string _identifier;
@@ -312,6 +335,15 @@ protected:
     std::map<std::string, std::string> _groupNames;
     /// Collection of string tag(s) assigned to this property
     std::vector<std::string> _tags;
+
+private:
+    /// Increments the #structureVersion and stores it as the #subtreeVersion of this
+    /// PropertyOwner and all of its owners
+    void markStructureChanged();
+
+    /// The #structureVersion of the most recent change to this PropertyOwner's subtree.
+    /// Owners might be modified from multiple threads, so this has to be atomic
+    std::atomic<uint64_t> _subtreeVersion = 0;
 };
 
 }  // namespace openspace::properties
@@ -30,7 +30,10 @@
 
 namespace openspace {
 
-namespace properties { class Property; }
+namespace properties {
+    class Property;
+    class PropertyIndex;
+} // namespace properties
 
 class Renderable;
 class Scene;
@@ -43,6 +46,7 @@ SceneGraphNode* sceneGraphNode(const std::string& name);
 const Renderable* renderable(const std::string& name);
 properties::Property* property(const std::string& uri);
 std::vector<properties::Property*> allProperties();
+properties::PropertyIndex& propertyIndex();
 
 } // namespace openspace
 
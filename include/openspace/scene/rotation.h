@@ -51,6 +51,13 @@ public:
 
     const glm::dmat3& matrix() const;
     virtual glm::dmat3 matrix(const UpdateData& time) const = 0;
+
+    /**
+     * Returns whether the matrix of this Rotation can be updated on a worker thread
+     * concurrently with the Rotations of other scene graph nodes. This is only true if
+     * the calculation does not access shared state, such as a Lua state or SPICE.
+     */
+    virtual bool isThreadSafe() const;
     void update(const UpdateData& data);
 
     static documentation::Documentation Documentation();
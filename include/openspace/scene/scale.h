@@ -51,6 +51,13 @@ public:
 
     glm::dvec3 scaleValue() const;
     virtual glm::dvec3 scaleValue(const UpdateData& data) const = 0;
+
+    /**
+     * Returns whether the scale value of this Scale can be updated on a worker thread
+     * concurrently with the Scales of other scene graph nodes. This is only true if the
+     * calculation does not access shared state, such as a Lua state or SPICE.
+     */
+    virtual bool isThreadSafe() const;
     virtual void update(const UpdateData& data);
 
     static documentation::Documentation Documentation();
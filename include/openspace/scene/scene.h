@@ -103,6 +103,20 @@ public:
      */
     void update(const UpdateData& data);
 
+    /**
+     * Enables or disables the parallel update of the transformations of the
+     * SceneGraphNodes on the shared ThreadPool. Nodes whose transformations are
+     * thread-safe and that do not depend on each other are updated concurrently, all
+     * other nodes and all Renderables are updated on the thread calling #update, as are
+     * the callbacks registered through Translation::onParameterChange. Both modes produce
+     * identical transformations. In the serial mode, each node updates its transformation
+     * and then its Renderable in topological order, so a Renderable that reads the
+     * transformation of a node that comes later in that order sees the value of the
+     * previous frame. In the parallel mode, all transformations are updated before the
+     * first Renderable, which therefore sees the value of the current frame instead.
+     */
+    void setParallelUpdate(bool enabled);
+
     /**
      * Render visible SceneGraphNodes using the provided camera.
      */
@@ -241,6 +255,14 @@ private:
 
     void sortTopologically();
 
+    /**
+     * Groups the topologically sorted nodes into levels such that the parent and all
+     * dependencies of a node are in an earlier level than the node itself
+     */
+    void computeUpdateLevels();
+
+    void updateParallel(const UpdateData& data);
+
     std::unique_ptr<Camera> _camera;
     std::vector<SceneGraphNode*> _topologicallySortedNodes;
     std::vector<SceneGraphNode*> _circularNodes;
@@ -249,6 +271,15 @@ private:
     SceneGraphNode _rootDummy;
     std::unique_ptr<SceneInitializer> _initializer;
 
+    struct UpdateLevel {
+        /// Nodes whose transformations can be updated on the worker threads
+        std::vector<SceneGraphNode*> concurrentNodes;
+        /// Nodes whose transformations have to be updated on the calling thread
+        std::vector<SceneGraphNode*> serialNodes;
+    };
+    std::vector<UpdateLevel> _updateLevels;
+    bool _useParallelUpdate = false;
+
     std::vector<InterestingTime> _interestingTimes;
 
     std::mutex _programUpdateLock;
@@ -92,6 +92,28 @@ public:
     void traversePreOrder(const std::function<void(SceneGraphNode*)>& fn);
     void traversePostOrder(const std::function<void(SceneGraphNode*)>& fn);
     void update(const UpdateData& data);
+
+    /**
+     * Updates the translation, rotation, and scale of this node and the cached world
+     * transformation. The world transformations of the parent and all dependencies have
+     * to be up to date. Together with #updateRenderable this is equivalent to #update.
+     */
+    void updateTransform(const UpdateData& data);
+
+    /**
+     * Updates the Renderable of this node with the world transformation that was cached
+     * by the last call to #updateTransform. If that call changed the position of the
+     * Translation, its observers are notified first. This function has to be called on
+     * the main thread.
+     */
+    void updateRenderable(const UpdateData& data);
+
+    /**
+     * Returns whether #updateTransform can be called on a worker thread concurrently with
+     * the #updateTransform of other nodes that do not depend on this node.
+     */
+    bool hasThreadSafeTransform() const;
+
     void render(const RenderData& data, RendererTasks& tasks);
 
     void attachChild(ghoul::mm_unique_ptr<SceneGraphNode> child);
@@ -177,6 +199,13 @@ private:
 
     glm::dmat4 _modelTransformCached = glm::dmat4(1.0);
 
+    // Whether the last call to updateTransform updated the cached transform data, which
+    // determines whether the Renderable should be updated as well
+    bool _isTransformUpdated = false;
+    // Whether the last call to updateTransform changed the position of the Translation,
+    // whose observers are then notified by updateRenderable
+    bool _hasTranslationChanged = false;
+
     properties::DoubleProperty _boundingSphere;
     properties::BoolProperty _computeScreenSpaceValues;
     properties::IVec2Property _screenSpacePosition;
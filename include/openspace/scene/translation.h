@@ -53,16 +53,34 @@ public:
     glm::dvec3 position() const;
     void update(const UpdateData& data);
 
+    /**
+     * Updates the cached position in the same way as #update, but does not call the
+     * callback that was registered through #onParameterChange. Instead, this function
+     * returns whether the position has changed, in which case the caller has to call
+     * #notifyObservers. This makes it possible to update the position on a worker thread
+     * while the callback is still called on the main thread.
+     */
+    bool updatePosition(const UpdateData& data);
+
     virtual glm::dvec3 position(const UpdateData& data) const = 0;
 
+    /**
+     * Returns whether the position of this Translation can be updated on a worker thread
+     * concurrently with the Translations of other scene graph nodes. This is only true
+     * if the calculation does not access shared state, such as a Lua state or SPICE.
+     */
+    virtual bool isThreadSafe() const;
+
     // Registers a callback that gets called when a significant change has been made that
     // invalidates potentially stored points, for example in trails
     void onParameterChange(std::function<void()> callback);
 
+    /// Calls the callback that was registered through #onParameterChange, if any
+    void notifyObservers() const;
+
     static documentation::Documentation Documentation();
 
 protected:
-    void notifyObservers() const;
     void requireUpdate();
 
 private:
@@ -28,7 +28,8 @@
 #include <openspace/util/concurrentqueue.h>
 #include <openspace/util/threadpool.h>
 
-#include <mutex>
+#include <memory>
+#include <vector>
 
 namespace openspace {
 
@@ -49,11 +50,24 @@ public:
 
     std::shared_ptr<Job<P>> popFinishedJob();
 
+    /**
+     * Appends up to \p maxJobs finished jobs to \p jobs without blocking and returns
+     * the number of jobs that were added.
+     */
+    size_t popFinishedJobs(std::vector<std::shared_ptr<Job<P>>>& jobs,
+        size_t maxJobs = std::numeric_limits<size_t>::max());
+
     size_t numFinishedJobs() const;
 
 private:
-    ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
-    std::mutex _finishedJobsMutex;
+    /// The number of finished jobs that can be stored without taking a lock. Further
+    /// finished jobs are kept in an overflow list so that workers never wait for them
+    /// to be popped
+    static constexpr const size_t FinishedJobsCapacity = 1024;
+
+    SpillingConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs{
+        FinishedJobsCapacity
+    };
     ThreadPool threadPool;
 };
 
@@ -36,7 +36,6 @@ template<typename P>
 void ConcurrentJobManager<P>::enqueueJob(std::shared_ptr<Job<P>> job) {
     threadPool.enqueue([this, job]() {
         job->execute();
-        std::lock_guard<std::mutex> lock(_finishedJobsMutex);
         _finishedJobs.push(job);
     });
 }
@@ -50,8 +49,17 @@ template<typename P>
 std::shared_ptr<Job<P>> ConcurrentJobManager<P>::popFinishedJob() {
     ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop!");
 
-    std::lock_guard<std::mutex> lock(_finishedJobsMutex);
-    return _finishedJobs.pop();
+    std::shared_ptr<Job<P>> job;
+    _finishedJobs.tryPop(job);
+    return job;
+}
+
+template<typename P>
+size_t ConcurrentJobManager<P>::popFinishedJobs(
+                                            std::vector<std::shared_ptr<Job<P>>>& jobs,
+                                                                           size_t maxJobs)
+{
+    return _finishedJobs.drain(jobs, maxJobs);
 }
 
 template<typename P>
@@ -25,9 +25,15 @@
 #ifndef __OPENSPACE_CORE___CONCURRENT_QUEUE___H__
 #define __OPENSPACE_CORE___CONCURRENT_QUEUE___H__
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <vector>
 
 namespace openspace {
 
@@ -55,6 +61,107 @@ private:
     mutable std::condition_variable _cond;
 };
 
+/**
+ * Templated bounded multi-producer multi-consumer queue that does not use any locks.
+ * The elements are stored in a ring buffer whose capacity is fixed at construction time
+ * and rounded up to the next power of two. None of the functions block; #tryPush fails
+ * if the queue is full and #tryPop fails if it is empty. This makes it suitable for
+ * queues that are polled every frame, for example from the render thread. The type
+ * \c T has to be default constructible.
+ */
+template <typename T>
+class BoundedConcurrentQueue {
+public:
+    explicit BoundedConcurrentQueue(size_t capacity);
+
+    BoundedConcurrentQueue(const BoundedConcurrentQueue&) = delete;
+    BoundedConcurrentQueue& operator=(const BoundedConcurrentQueue&) = delete;
+
+    /// Returns \c false without modifying \p item if the queue is full
+    bool tryPush(const T& item);
+
+    /// Returns \c false without moving from \p item if the queue is full
+    bool tryPush(T&& item);
+
+    /// Returns \c false without modifying \p item if the queue is empty
+    bool tryPop(T& item);
+
+    std::optional<T> tryPop();
+
+    /**
+     * Pops up to \p maxItems items and appends them to \p items in the order in which
+     * they were pushed. Returns the number of items that were popped.
+     */
+    size_t drain(std::vector<T>& items,
+        size_t maxItems = std::numeric_limits<size_t>::max());
+
+    /// Returns the number of items in the queue, which is only approximate while other
+    /// threads are pushing or popping concurrently
+    size_t size() const;
+
+    bool empty() const;
+
+    size_t capacity() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    template <typename U>
+    bool push(U&& item);
+
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _buffer;
+
+    // The two positions are placed on different cache lines so that producers and
+    // consumers do not invalidate each other's cache line on every operation
+    alignas(64) std::atomic<size_t> _enqueuePosition = 0;
+    alignas(64) std::atomic<size_t> _dequeuePosition = 0;
+};
+
+/**
+ * Templated multi-producer multi-consumer queue that never rejects an item. Items are
+ * pushed into a BoundedConcurrentQueue and only if that is full, they are appended to an
+ * overflow list that is protected by a mutex. As long as the consumers keep up with the
+ * producers, neither pushing nor popping takes a lock, but a producer never has to wait
+ * for a consumer either.
+ */
+template <typename T>
+class SpillingConcurrentQueue {
+public:
+    explicit SpillingConcurrentQueue(size_t capacity);
+
+    SpillingConcurrentQueue(const SpillingConcurrentQueue&) = delete;
+    SpillingConcurrentQueue& operator=(const SpillingConcurrentQueue&) = delete;
+
+    void push(T item);
+
+    /// Returns \c false without modifying \p item if the queue is empty
+    bool tryPop(T& item);
+
+    /**
+     * Pops up to \p maxItems items and appends them to \p items. Returns the number of
+     * items that were popped.
+     */
+    size_t drain(std::vector<T>& items,
+        size_t maxItems = std::numeric_limits<size_t>::max());
+
+    /// Returns the number of items in the queue, which is only approximate while other
+    /// threads are pushing or popping concurrently
+    size_t size() const;
+
+    bool empty() const;
+
+private:
+    BoundedConcurrentQueue<T> _queue;
+
+    std::deque<T> _overflow;
+    std::atomic<size_t> _nOverflow = 0;
+    std::mutex _overflowMutex;
+};
+
 } // namespace openspace
 
 #include "concurrentqueue.inl"
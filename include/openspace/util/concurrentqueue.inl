@@ -64,10 +64,7 @@ void ConcurrentQueue<T>::push(T&& item) {
 template <typename T>
 size_t ConcurrentQueue<T>::size() const {
     std::unique_lock<std::mutex> mlock(_mutex);
-    size_t s = _queue.size();
-    mlock.unlock();
-    _cond.notify_one();
-    return s;
+    return _queue.size();
 }
 
 template <typename T>
@@ -75,5 +72,201 @@ bool ConcurrentQueue<T>::empty() const {
     return size() == 0;
 }
 
+// The BoundedConcurrentQueue is based on Dmitry Vyukov's bounded MPMC queue. Each cell
+// carries a sequence number that tells producers and consumers whether the cell is ready
+// to be written to or read from for the current lap around the ring buffer
+
+template <typename T>
+BoundedConcurrentQueue<T>::BoundedConcurrentQueue(size_t capacity)
+    : _mask([](size_t c) {
+        size_t result = 2;
+        while (result < c) {
+            result *= 2;
+        }
+        return result - 1;
+    }(capacity))
+    , _buffer(std::make_unique<Cell[]>(_mask + 1))
+{
+    for (size_t i = 0; i <= _mask; ++i) {
+        _buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPush(const T& item) {
+    return push(item);
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPush(T&& item) {
+    return push(std::move(item));
+}
+
+template <typename T>
+template <typename U>
+bool BoundedConcurrentQueue<T>::push(U&& item) {
+    size_t pos = _enqueuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _buffer[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            // The cell is free for this lap, try to claim it
+            if (_enqueuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+                ))
+            {
+                cell.data = std::forward<U>(item);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell still contains an item from the previous lap, the queue is full
+            return false;
+        }
+        else {
+            // Another producer claimed the cell before us
+            pos = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPop(T& item) {
+    size_t pos = _dequeuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _buffer[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+        if (diff == 0) {
+            if (_dequeuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+                ))
+            {
+                item = std::move(cell.data);
+                // Reset the cell so that it does not keep resources alive
+                cell.data = T();
+                cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell has not been written to in this lap, the queue is empty
+            return false;
+        }
+        else {
+            pos = _dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+std::optional<T> BoundedConcurrentQueue<T>::tryPop() {
+    T item;
+    if (tryPop(item)) {
+        return item;
+    }
+    else {
+        return std::nullopt;
+    }
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::drain(std::vector<T>& items, size_t maxItems) {
+    size_t nPopped = 0;
+    T item;
+    while (nPopped < maxItems && tryPop(item)) {
+        items.push_back(std::move(item));
+        ++nPopped;
+    }
+    return nPopped;
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::size() const {
+    const size_t dequeue = _dequeuePosition.load(std::memory_order_relaxed);
+    const size_t enqueue = _enqueuePosition.load(std::memory_order_relaxed);
+    return enqueue > dequeue ? enqueue - dequeue : 0;
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::empty() const {
+    return size() == 0;
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::capacity() const {
+    return _mask + 1;
+}
+
+
+template <typename T>
+SpillingConcurrentQueue<T>::SpillingConcurrentQueue(size_t capacity)
+    : _queue(capacity)
+{}
+
+template <typename T>
+void SpillingConcurrentQueue<T>::push(T item) {
+    // As long as there are items in the overflow list, new items are added behind them
+    // so that they are not overtaken by the later ones
+    if (_nOverflow == 0 && _queue.tryPush(std::move(item))) {
+        return;
+    }
+
+    std::lock_guard lock(_overflowMutex);
+    _overflow.push_back(std::move(item));
+    ++_nOverflow;
+}
+
+template <typename T>
+bool SpillingConcurrentQueue<T>::tryPop(T& item) {
+    if (_queue.tryPop(item)) {
+        return true;
+    }
+    if (_nOverflow == 0) {
+        return false;
+    }
+
+    std::lock_guard lock(_overflowMutex);
+    if (_overflow.empty()) {
+        return false;
+    }
+    item = std::move(_overflow.front());
+    _overflow.pop_front();
+    --_nOverflow;
+    return true;
+}
+
+template <typename T>
+size_t SpillingConcurrentQueue<T>::drain(std::vector<T>& items, size_t maxItems) {
+    size_t nPopped = _queue.drain(items, maxItems);
+    if (nPopped == maxItems || _nOverflow == 0) {
+        return nPopped;
+    }
+
+    std::lock_guard lock(_overflowMutex);
+    while (nPopped < maxItems && !_overflow.empty()) {
+        items.push_back(std::move(_overflow.front()));
+        _overflow.pop_front();
+        --_nOverflow;
+        ++nPopped;
+    }
+    return nPopped;
+}
+
+template <typename T>
+size_t SpillingConcurrentQueue<T>::size() const {
+    return _queue.size() + _nOverflow;
+}
+
+template <typename T>
+bool SpillingConcurrentQueue<T>::empty() const {
+    return size() == 0;
+}
 
 } // namespace openspace
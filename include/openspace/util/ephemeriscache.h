@@ -0,0 +1,215 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___EPHEMERISCACHE___H__
+#define __OPENSPACE_CORE___EPHEMERISCACHE___H__
+
+#include <ghoul/glm.h>
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * The EphemerisCache approximates a time-dependent SPICE quantity by piecewise Chebyshev
+ * polynomials that are fitted on demand. The time axis is divided into pieces of
+ * PieceLength seconds. The first query inside a piece samples SPICE and fits the piece,
+ * bisecting it until each segment reproduces SPICE within the tolerance at test points
+ * between the interpolation nodes. All following queries inside the piece are answered
+ * from the fitted coefficients without taking a lock, so a cache can be evaluated from
+ * any number of threads concurrently. Only fitting a new piece is serialized, as SPICE
+ * itself is not thread-safe.
+ *
+ * Segments that cannot be fitted, either because SPICE reported an error or because the
+ * quantity is not smooth at the MinimumSegmentLength (for example at the edge of a
+ * kernel's coverage), are answered by calling SPICE directly. If the loaded kernels
+ * change, all fitted pieces are invalidated and refitted on their next use.
+ *
+ * All caches share a single memory budget (see #setMemoryBudget). If fitting a piece
+ * exceeds the budget, the least recently used pieces of the same cache are evicted.
+ */
+class EphemerisCache {
+public:
+    /// The number of seconds covered by each fitted piece
+    static constexpr const double PieceLength = 86400.0;
+
+    /// The shortest segment that a piece is bisected into before giving up
+    static constexpr const double MinimumSegmentLength = 1.0;
+
+    /// The degree of the Chebyshev polynomial in each segment
+    static constexpr const int Degree = 12;
+
+    virtual ~EphemerisCache();
+
+    /**
+     * Sets the number of bytes that all fitted pieces of all caches together may use.
+     * Lowering the budget takes effect the next time a piece is fitted.
+     */
+    static void setMemoryBudget(size_t bytes);
+
+    /// Returns the number of bytes that all fitted pieces of all caches may use
+    static size_t memoryBudget();
+
+    /// Returns the number of bytes that are currently used by all fitted pieces
+    static size_t memoryUsage();
+
+    /// Returns the number of pieces this cache has fitted, including refitted pieces
+    size_t nFittedPieces() const;
+
+protected:
+    /// The sampled value; unused trailing components are 0
+    using Value = std::array<double, 4>;
+
+    /**
+     * \param nComponents The number of components of the sampled values
+     * \param tolerance The maximum error of the fitted values as measured by #error
+     * \pre \p nComponents must be between 1 and 4
+     * \pre \p tolerance must be positive
+     */
+    EphemerisCache(int nComponents, double tolerance);
+
+    /**
+     * Returns the approximated value at the \p ephemerisTime. This method is safe to be
+     * called concurrently.
+     *
+     * \throw SpiceException If the value is not cached and SPICE cannot provide it
+     */
+    Value value(double ephemerisTime) const;
+
+    /**
+     * Samples the exact value from SPICE. This is only called while SPICE access is
+     * serialized.
+     *
+     * \throw SpiceException If SPICE cannot provide the value
+     */
+    virtual Value sample(double ephemerisTime) const = 0;
+
+    /// Returns the error of an \p approximation with respect to the \p reference value
+    virtual double error(const Value& approximation, const Value& reference) const = 0;
+
+    /**
+     * Adjusts the \p sample so that it forms a smooth curve with the \p previous sample.
+     * This is used for quantities that have more than one representation, such as
+     * quaternions.
+     */
+    virtual void alignSample(Value& sample, const Value& previous) const;
+
+private:
+    struct Segment {
+        double start = 0.0;
+        double end = 0.0;
+        bool isFitted = false;
+        std::array<double, (Degree + 1) * 4> coefficients = {};
+    };
+
+    struct Piece {
+        long long index = 0;
+        unsigned long long generation = 0;
+        std::vector<Segment> segments;
+        size_t nBytes = 0;
+        mutable std::atomic_bool isReferenced = false;
+    };
+
+    static constexpr const int NumSlots = 64;
+
+    Value evaluate(const Segment& segment, double ephemerisTime) const;
+    void fitPiece(long long index, unsigned long long generation) const;
+    void fitSegment(double start, double end, std::vector<Segment>& segments) const;
+    bool tryFitSegment(Segment& segment) const;
+    void install(const Piece* piece) const;
+    void retire(const Piece* piece) const;
+
+    const int _nComponents;
+    const double _tolerance;
+
+    // The pieces are direct-mapped by their index. A slot is only replaced while the
+    // SpiceManager::mutex is held; replaced pieces are kept alive until no reader is
+    // active
+    mutable std::array<std::atomic<const Piece*>, NumSlots> _slots = {};
+    mutable std::atomic_int _nActiveReaders = 0;
+    mutable std::vector<const Piece*> _retiredPieces;
+    mutable int _clockHand = 0;
+    mutable std::atomic<size_t> _nFittedPieces = 0;
+};
+
+/**
+ * Caches the position of a target relative to an observer in a reference frame, in km,
+ * as it would be returned by SpiceManager::targetPosition without aberration correction.
+ */
+class PositionEphemerisCache : public EphemerisCache {
+public:
+    /**
+     * \param target The NAIF name or id of the target body
+     * \param observer The NAIF name or id of the observing body
+     * \param referenceFrame The NAIF name of the reference frame of the position
+     * \param tolerance The maximum distance in km between a cached and a sampled position
+     */
+    PositionEphemerisCache(std::string target, std::string observer,
+        std::string referenceFrame, double tolerance);
+
+    /// Returns the position in km at the \p ephemerisTime
+    glm::dvec3 position(double ephemerisTime) const;
+
+private:
+    Value sample(double ephemerisTime) const override;
+    double error(const Value& approximation, const Value& reference) const override;
+
+    const std::string _target;
+    const std::string _observer;
+    const std::string _referenceFrame;
+};
+
+/**
+ * Caches the matrix that transforms positions from a source to a destination frame as
+ * it would be returned by SpiceManager::positionTransformMatrix. The rotation is fitted
+ * as a quaternion.
+ */
+class RotationEphemerisCache : public EphemerisCache {
+public:
+    /**
+     * \param sourceFrame The NAIF name of the source reference frame
+     * \param destinationFrame The NAIF name of the destination reference frame
+     * \param tolerance The maximum angle in radians between a cached and a sampled
+     *        rotation
+     */
+    RotationEphemerisCache(std::string sourceFrame, std::string destinationFrame,
+        double tolerance);
+
+    /// Returns the transformation matrix at the \p ephemerisTime
+    glm::dmat3 matrix(double ephemerisTime) const;
+
+private:
+    Value sample(double ephemerisTime) const override;
+    double error(const Value& approximation, const Value& reference) const override;
+    void alignSample(Value& sample, const Value& previous) const override;
+
+    const std::string _sourceFrame;
+    const std::string _destinationFrame;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___EPHEMERISCACHE___H__
@@ -0,0 +1,82 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___MAPPEDFILE___H__
+#define __OPENSPACE_CORE___MAPPEDFILE___H__
+
+#include <cstddef>
+#include <string>
+
+namespace openspace {
+
+/**
+ * A read-only memory mapping of a complete file. The contents of the file are not read
+ * when the mapping is created, but the operating system loads the pages lazily when they
+ * are first accessed, so only the parts of a file that are actually used are read from
+ * disk.
+ */
+class MappedFile {
+public:
+    /**
+     * Maps the file at the provided \p path into memory.
+     *
+     * \param path The path to the file that should be mapped
+     *
+     * \throw ghoul::RuntimeError If the file could not be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// Returns the beginning of the mapped file contents
+    const std::byte* data() const;
+
+    /// Returns the size of the mapped file in bytes
+    size_t size() const;
+
+    /**
+     * Forces the pages in the range [\p offset, \p offset + \p size) to be read from disk
+     * so that subsequent accesses to that range do not block on disk reads. The range is
+     * clamped to the size of the file.
+     */
+    void prefault(size_t offset, size_t size) const;
+
+private:
+    void unmap();
+
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+#ifdef WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#endif // WIN32
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___MAPPEDFILE___H__
@@ -0,0 +1,215 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___SPECKLOADER___H__
+#define __OPENSPACE_CORE___SPECKLOADER___H__
+
+#include <ghoul/glm.h>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openspace {
+
+class MappedFile;
+
+namespace speck {
+
+/// A named data variable that was declared with a <code>datavar</code> in a speck file
+struct Variable {
+    /// The column in the Dataset that contains the (first) value of this variable
+    int index;
+    /// The name of the variable
+    std::string name;
+};
+
+/// A texture that was declared with a <code>texture</code> in a speck file
+struct Texture {
+    /// The index that the data entries use to refer to this texture
+    int index;
+    /// The file name of the texture, relative to the speck file
+    std::string file;
+};
+
+/**
+ * The data entries of a speck file, stored in a column-major layout. The first three
+ * columns contain the x, y, and z position of each entry, all other columns are
+ * described by the Dataset's variables. The columns are either owned by the Dataset or
+ * are part of a memory mapped cache file, in which case only the columns that are
+ * accessed are ever read from disk.
+ */
+class Dataset {
+public:
+    Dataset();
+    ~Dataset();
+    Dataset(Dataset&& other) noexcept;
+    Dataset& operator=(Dataset&& other) noexcept;
+
+    /// Returns the number of data entries, which is the length of each column
+    size_t nEntries() const;
+
+    /// Returns the number of columns, including the three position columns
+    int nColumns() const;
+
+    /// Returns \c true if the Dataset does not contain any entries
+    bool isEmpty() const;
+
+    /// Returns the variables that have been declared in the speck file
+    const std::vector<Variable>& variables() const;
+
+    /**
+     * Returns the column that contains the variable with the provided \p name or -1 if
+     * no such variable exists.
+     */
+    int index(std::string_view name) const;
+
+    /// Returns the textures that have been declared in the speck file
+    const std::vector<Texture>& textures() const;
+
+    /// Returns the column that contains the texture index or -1 if there is none
+    int textureDataIndex() const;
+
+    /// Returns the column that contains the first orientation value or -1
+    int orientationDataIndex() const;
+
+    /**
+     * Returns the values of the column with the provided \p index.
+     *
+     * \pre \p index must be smaller than nColumns()
+     */
+    const float* column(int index) const;
+
+    /**
+     * Returns the modifiable values of the column with the provided \p index.
+     *
+     * \pre \p index must be smaller than nColumns()
+     * \pre The Dataset must not be memory mapped
+     */
+    float* mutableColumn(int index);
+
+    /// Returns the value of the \p column for the entry with the index \p entry
+    float value(size_t entry, int column) const {
+        return _columns[column][entry];
+    }
+
+    /// Returns the x, y, and z values of the entry with the index \p entry
+    glm::vec3 position(size_t entry) const {
+        return glm::vec3(_columns[0][entry], _columns[1][entry], _columns[2][entry]);
+    }
+
+    /// Returns whether the columns are part of a memory mapped cache file
+    bool isMemoryMapped() const;
+
+    /**
+     * Removes all entries for which the \p predicate returns \c true. The predicate is
+     * called with the index of each entry.
+     *
+     * \pre The Dataset must not be memory mapped
+     */
+    void removeEntries(const std::function<bool(size_t)>& predicate);
+
+private:
+    friend Dataset loadSpeckFile(const std::string& path, size_t nThreads);
+    friend std::optional<Dataset> loadCachedDataset(const std::string& path);
+
+    std::vector<Variable> _variables;
+    std::vector<Texture> _textures;
+    int _textureDataIndex = -1;
+    int _orientationDataIndex = -1;
+
+    size_t _nEntries = 0;
+    std::vector<const float*> _columns;
+    std::vector<std::vector<float>> _ownedColumns;
+    std::unique_ptr<MappedFile> _mappedFile;
+};
+
+/// A text label that was loaded from a label file
+struct Label {
+    glm::vec3 position;
+    std::string text;
+};
+
+/**
+ * Parses the speck file at the provided \p path. The header of the file can contain
+ * <code>datavar</code>, <code>texturevar</code>, <code>texture</code>,
+ * <code>polyorivar</code>, and <code>maxcomment</code> lines in addition to comments.
+ * Each following line that is not a comment contains one data entry. Large files are
+ * split into chunks at line boundaries that are parsed in parallel; the entries of the
+ * returned Dataset are always in the same order as in the file.
+ *
+ * \param path The path to the speck file that should be loaded
+ * \param nThreads The number of threads the data entries are split up for. If this is
+ *        larger than 1, the chunks are parsed on the shared ThreadPool. If this is 0,
+ *        the number of hardware threads is used
+ * \return The Dataset that contains all entries of the speck file
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened
+ */
+Dataset loadSpeckFile(const std::string& path, size_t nThreads = 0);
+
+/**
+ * Saves the \p dataset into a versioned, column-major binary cache file at \p path that
+ * can be loaded with loadCachedDataset.
+ *
+ * \throw ghoul::RuntimeError If the file could not be written
+ */
+void saveCachedDataset(const Dataset& dataset, const std::string& path);
+
+/**
+ * Memory maps the binary cache file at \p path that was written by saveCachedDataset.
+ * The column values are not read until they are accessed.
+ *
+ * \return The mapped Dataset or \c std::nullopt if the file does not exist, was
+ *         written by a different version, or is corrupt
+ */
+std::optional<Dataset> loadCachedDataset(const std::string& path);
+
+/**
+ * Loads the speck file at \p path through a persistent cache file. If the cache file
+ * does not exist yet, the speck file is parsed, the optional \p postProcessing is
+ * applied, and the result is stored in the cache for the next run. The \p cacheKey is
+ * used to distinguish cache files for the same speck file that were processed
+ * differently.
+ *
+ * \throw ghoul::RuntimeError If the speck file could not be opened
+ */
+Dataset loadSpeckFileCached(const std::string& path, const std::string& cacheKey = "",
+    const std::function<void(Dataset&)>& postProcessing = nullptr);
+
+/**
+ * Parses the label file at the provided \p path. Each label line consists of the
+ * position followed by the keyword <code>text</code> and the label text, which extends
+ * to the end of the line or to a <code>#</code> that starts a comment.
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened
+ */
+std::vector<Label> loadLabelFile(const std::string& path);
+
+} // namespace speck
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___SPECKLOADER___H__
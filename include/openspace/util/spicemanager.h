@@ -32,9 +32,10 @@
 #include <ghoul/misc/exception.h>
 #include <array>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <set>
 
 #ifdef __clang__
 #pragma clang diagnostic push
@@ -167,6 +168,34 @@ public:
      */
     static TerminatorType terminatorTypeFromString(const std::string& type);
 
+    /**
+     * A body whose NAIF ID has been resolved by #bodyHandle. Passing a handle instead of
+     * a name to the SpiceManager avoids looking up the ID and the coverage of the body
+     * on every call. A handle stays valid when kernels are loaded or unloaded.
+     */
+    struct BodyHandle {
+        /// The name of the body as it was passed to #bodyHandle
+        std::string name;
+        /// The NAIF ID of the body
+        int id = 0;
+        /// The index of the SPK coverage of the body or -1 if it has no coverage
+        int coverage = -1;
+    };
+
+    /**
+     * A reference frame whose NAIF ID has been resolved by #frameHandle. Passing a handle
+     * instead of a name to the SpiceManager avoids looking up the ID and the coverage of
+     * the frame on every call. A handle stays valid when kernels are loaded or unloaded.
+     */
+    struct FrameHandle {
+        /// The name of the frame as it was passed to #frameHandle
+        std::string name;
+        /// The NAIF ID of the frame
+        int id = 0;
+        /// The index of the CK coverage of the frame or -1 if it has no coverage
+        int coverage = -1;
+    };
+
     static void initialize();
     static void deinitialize();
     static bool isInitialized();
@@ -226,6 +255,33 @@ public:
      */
     void unloadKernel(std::string filePath);
 
+    /**
+     * Returns a number that changes whenever a kernel is loaded into or unloaded from the
+     * kernel pool. Values that were derived from SPICE with an older generation might be
+     * outdated. This method is safe to be called concurrently.
+     *
+     * \return The current kernel generation
+     */
+    static unsigned long long kernelGeneration();
+
+    /**
+     * Returns the mutex that serializes all calls into CSPICE, which is not re-entrant.
+     * Every method of the SpiceManager locks it, so it only has to be locked by code that
+     * calls CSPICE directly or that has to make multiple calls without interruption. The
+     * mutex is recursive, so SpiceManager methods can be called while holding it.
+     *
+     * \return The mutex that guards CSPICE
+     */
+    static std::recursive_mutex& mutex();
+
+    /**
+     * Returns the paths of all kernels that are currently loaded, in the order in which
+     * they were loaded.
+     *
+     * \return The paths of the loaded kernels
+     */
+    std::vector<std::string> loadedKernels() const;
+
     /**
      * Returns whether a given \p target has an Spk kernel covering it at the designated
      * \p et ephemeris time.
@@ -241,6 +297,17 @@ public:
      */
     bool hasSpkCoverage(const std::string& target, double et) const;
 
+    /**
+     * Returns whether the \p target has an SPK kernel covering it at the \p et ephemeris
+     * time.
+     *
+     * \param target The resolved body to be examined
+     * \param et The time for which the coverage should be checked
+     * \return \c true if SPK kernels have been loaded to cover \p target at the time
+     *         \p et, \c false otherwise
+     */
+    bool hasSpkCoverage(const BodyHandle& target, double et) const;
+
     /**
      * Returns a list of loaded SPK coverage intervals for \p target
      *
@@ -370,6 +437,30 @@ public:
      */
     bool hasFrameId(const std::string& frame) const;
 
+    /**
+     * Resolves the NAIF ID of the \p body so that it can be passed to the methods of the
+     * SpiceManager that accept a BodyHandle.
+     *
+     * \param body The name or the NAIF ID of the body
+     * \return The handle of the \p body
+     *
+     * \throw SpiceException If \p body does not name a valid NAIF object
+     * \pre \p body must not be empty.
+     */
+    BodyHandle bodyHandle(const std::string& body);
+
+    /**
+     * Resolves the NAIF ID of the \p frame so that it can be passed to the methods of the
+     * SpiceManager that accept a FrameHandle.
+     *
+     * \param frame The name of the reference frame
+     * \return The handle of the \p frame
+     *
+     * \throw SpiceException If \p frame is not a valid frame
+     * \pre \p frame must not be empty.
+     */
+    FrameHandle frameHandle(const std::string& frame);
+
     /**
      * Retrieves a single \p value for a certain \p body. This method succeeds iff \p body
      * is the name of a valid body, \p value is a value associated with the body, and the
@@ -550,6 +641,7 @@ public:
         static_assert(N != 0, "Format must not be empty");
         ghoul_assert(N >= bufferSize - 1, "Buffer size too small");
 
+        std::lock_guard lock(mutex());
         timout_c(ephemerisTime, format, bufferSize, outBuf);
         if (failed_c()) {
             throwSpiceError(fmt::format(
@@ -624,6 +716,56 @@ public:
         const std::string& observer, const std::string& referenceFrame,
         AberrationCorrection aberrationCorrection, double ephemerisTime) const;
 
+    /**
+     * Returns the position of a \p target body relative to an \p observer in a specific
+     * \p referenceFrame. This method behaves like the method that takes the names of the
+     * bodies and the frame, but does not need to look up their NAIF IDs.
+     *
+     * \param target The resolved target body
+     * \param observer The resolved observing body
+     * \param referenceFrame The resolved reference frame of the output position vector
+     * \param aberrationCorrection The aberration correction used for the position
+     *        calculation
+     * \param ephemerisTime The time at which the position is to be queried
+     * \param lightTime If the \p aberrationCorrection is different from
+     *        AbberationCorrection::Type::None, this variable will contain the light time
+     *        between the observer and the target.
+     * \return The position of the \p target relative to the \p observer in the specified
+     *         \p referenceFrame
+     *
+     * \throw SpiceException If there is not sufficient data available to compute the
+     *        position or neither the target nor the observer have coverage.
+     * \post If an exception is thrown, \p lightTime will not be modified.
+     *
+     * \sa http://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/spkezp_c.html
+     */
+    glm::dvec3 targetPosition(const BodyHandle& target, const BodyHandle& observer,
+        const FrameHandle& referenceFrame, AberrationCorrection aberrationCorrection,
+        double ephemerisTime, double& lightTime) const;
+
+    /**
+     * Returns the position of a \p target body relative to an \p observer in a specific
+     * \p referenceFrame. This method behaves like the method that takes the names of the
+     * bodies and the frame, but does not need to look up their NAIF IDs.
+     *
+     * \param target The resolved target body
+     * \param observer The resolved observing body
+     * \param referenceFrame The resolved reference frame of the output position vector
+     * \param aberrationCorrection The aberration correction used for the position
+     *        calculation
+     * \param ephemerisTime The time at which the position is to be queried
+     * \return The position of the \p target relative to the \p observer in the specified
+     *         \p referenceFrame
+     *
+     * \throw SpiceException If there is not sufficient data available to compute the
+     *        position or neither the target nor the observer have coverage.
+     *
+     * \sa http://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/spkezp_c.html
+     */
+    glm::dvec3 targetPosition(const BodyHandle& target, const BodyHandle& observer,
+        const FrameHandle& referenceFrame, AberrationCorrection aberrationCorrection,
+        double ephemerisTime) const;
+
     /**
      * This method returns the transformation matrix that defines the transformation from
      * the reference frame \p from to the reference frame \p to. As both reference frames
@@ -823,6 +965,25 @@ public:
     glm::dmat3 positionTransformMatrix(const std::string& sourceFrame,
         const std::string& destinationFrame, double ephemerisTime) const;
 
+    /**
+     * Returns the matrix that transforms position vectors from the resolved
+     * \p sourceFrame to the resolved \p destinationFrame at the specific
+     * \p ephemerisTime.
+     *
+     * \param sourceFrame The resolved source reference frame
+     * \param destinationFrame The resolved destination reference frame
+     * \param ephemerisTime The time at which the transformation matrix is to be queried
+     * \return The transformation matrix that defines the transformation from the
+     *         \p sourceFrame to the \p destinationFrame
+     *
+     * \throw SpiceException If there is no coverage available for the specified
+     *        \p sourceFrame, \p destinationFrame, \p ephemerisTime combination
+     *
+     * \sa http://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/pxform_c.html
+     */
+    glm::dmat3 positionTransformMatrix(const FrameHandle& sourceFrame,
+        const FrameHandle& destinationFrame, double ephemerisTime) const;
+
     /**
      * Returns the transformation matrix that transforms position vectors from the
      * \p sourceFrame at the time \p ephemerisTimeFrom to the \p destinationFrame at the
@@ -981,6 +1142,15 @@ private:
         int refCount; /// How many parts loaded this kernel and are interested in it
     };
 
+    /// The coverage of a single body or frame as provided by all loaded kernels
+    struct Coverage {
+        /// The covered intervals sorted by their start time. Overlapping intervals are
+        /// merged, so at most one interval can contain a specific time
+        std::vector<std::pair<double, double>> intervals;
+        /// The sorted start and end times of all intervals before they were merged
+        std::vector<double> times;
+    };
+
     /// Default constructor setting values for SPICE to not terminate on error
     SpiceManager();
     SpiceManager(const SpiceManager& c) = delete;
@@ -1046,8 +1216,8 @@ private:
      * \pre \p target and \p observer must be different
      * \post If an exception is thrown, \p lightTime will not be modified
      */
-    glm::dvec3 getEstimatedPosition(const std::string& target,
-        const std::string& observer, const std::string& referenceFrame,
+    glm::dvec3 getEstimatedPosition(const BodyHandle& target,
+        const BodyHandle& observer, const FrameHandle& referenceFrame,
         AberrationCorrection aberrationCorrection, double ephemerisTime,
         double& lightTime) const;
 
@@ -1069,17 +1239,32 @@ private:
      * \pre \p fromFrame must not be empty
      * \pre \p toFrame must not be empty
      */
-    glm::dmat3 getEstimatedTransformMatrix(const std::string& fromFrame,
-        const std::string& toFrame, double time) const;
+    glm::dmat3 getEstimatedTransformMatrix(const FrameHandle& fromFrame,
+        const FrameHandle& toFrame, double time) const;
+
+    /**
+     * Returns the handle of the \p body or the \p frame without adding a coverage entry
+     * for it if it does not have one yet. This is used by the methods that accept names.
+     */
+    BodyHandle resolveBody(const std::string& body) const;
+    FrameHandle resolveFrame(const std::string& frame) const;
+
+    /**
+     * Returns the index of the coverage of the NAIF object \p id in \p coverages, adding
+     * a new entry if the object does not have coverage yet.
+     */
+    static int coverageIndex(std::vector<Coverage>& coverages,
+        std::unordered_map<int, int>& indices, int id);
 
     /// A list of all loaded kernels
     std::vector<KernelInformation> _loadedKernels;
 
-    // Map: id, vector of pairs. Pair: Start time, end time;
-    std::map<int, std::vector< std::pair<double, double>>> _ckIntervals;
-    std::map<int, std::vector< std::pair<double, double>>> _spkIntervals;
-    std::map<int, std::set<double>> _ckCoverageTimes;
-    std::map<int, std::set<double>> _spkCoverageTimes;
+    // The coverage of each object is stored at a fixed index that is referenced by the
+    // handles; the maps are only used to find the index of an object by its NAIF ID
+    std::vector<Coverage> _ckCoverages;
+    std::vector<Coverage> _spkCoverages;
+    std::unordered_map<int, int> _ckCoverageIndices;
+    std::unordered_map<int, int> _spkCoverageIndices;
 
     /// Stores whether the SpiceManager throws exceptions (Yes) or fails silently (No)
     UseException _useExceptions = UseException::Yes;
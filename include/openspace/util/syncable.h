@@ -43,6 +43,14 @@ protected:
     // from the used of implementations of the interface
     friend class SyncEngine;
 
+    /**
+     * Returns whether the SyncEngine only has to transmit this Syncable's encoded bytes
+     * when they changed since the previous frame. This is only valid if decoding the same
+     * bytes twice in a row has no additional effect, which is not the case for
+     * Syncables that encode a stream of events, such as queued scripts.
+     */
+    virtual bool isDeltaEncodable() const { return false; }
+
     virtual void preSync(bool /*isMaster*/) {};
     virtual void encode(SyncBuffer* /*syncBuffer*/) = 0;
     virtual void decode(SyncBuffer* /*syncBuffer*/) = 0;
@@ -26,12 +26,22 @@
 #define __OPENSPACE_CORE___SYNCBUFFER___H__
 
 #include <ghoul/glm.h>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace openspace {
 
+/**
+ * Non-owning view of a contiguous range of bytes that have been encoded into or are to
+ * be decoded from a SyncBuffer.
+ */
+struct SyncBufferView {
+    const std::byte* data = nullptr;
+    size_t size = 0;
+};
+
 class SyncBuffer {
 public:
     SyncBuffer(size_t n);
@@ -62,14 +72,52 @@ public:
     //void write();
     //void read();
 
+    /**
+     * Sets the bytes that are decoded by subsequent calls to decode. The buffer takes
+     * ownership of \p data.
+     */
     void setData(std::vector<std::byte> data);
+
+    /**
+     * Sets the bytes that are decoded by subsequent calls to decode without copying
+     * them. The memory that \p data points to has to stay valid until the next call to
+     * #reset or #setData.
+     */
+    void setData(SyncBufferView data);
+
+    /// Returns a copy of the encoded bytes
     std::vector<std::byte> data();
 
+    /**
+     * Returns a view of the encoded bytes. The view is invalidated by the next call to
+     * encode or #reset.
+     */
+    SyncBufferView view() const;
+
+    /// Returns the number of bytes that have been encoded since the last #reset
+    size_t encodedSize() const;
+
+    /**
+     * Discards all bytes that have been encoded after the first \p size bytes.
+     * \pre size must not be bigger than encodedSize()
+     */
+    void truncate(size_t size);
+
+    /// Returns \c true if all bytes passed to #setData have been decoded
+    bool isFullyDecoded() const;
+
 private:
+    /// Makes sure that \p nBytes more bytes can be encoded without reallocating
+    void reserve(size_t nBytes);
+
     size_t _n;
     size_t _encodeOffset = 0;
     size_t _decodeOffset = 0;
     std::vector<std::byte> _dataStream;
+
+    /// Points either into _dataStream or to external memory passed to setData
+    const std::byte* _decodeData = nullptr;
+    size_t _decodeSize = 0;
 };
 
 } // namespace openspace
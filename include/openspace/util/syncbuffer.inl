@@ -31,12 +31,7 @@ namespace openspace {
 template <typename T>
 void SyncBuffer::encode(const T& v) {
     const size_t size = sizeof(T);
-
-    size_t anticpatedBufferSize = _encodeOffset + size;
-    if (anticpatedBufferSize >= _n) {
-        _dataStream.resize(anticpatedBufferSize);
-    }
-
+    reserve(size);
     std::memcpy(_dataStream.data() + _encodeOffset, &v, size);
     _encodeOffset += size;
 }
@@ -44,9 +39,9 @@ void SyncBuffer::encode(const T& v) {
 template <typename T>
 T SyncBuffer::decode() {
     const size_t size = sizeof(T);
-    ghoul_assert(_decodeOffset + size < _n, "");
+    ghoul_assert(_decodeOffset + size <= _decodeSize, "Reading past the end of buffer");
     T value;
-    std::memcpy(&value, _dataStream.data() + _decodeOffset, size);
+    std::memcpy(&value, _decodeData + _decodeOffset, size);
     _decodeOffset += size;
     return value;
 }
@@ -54,8 +49,8 @@ T SyncBuffer::decode() {
 template <typename T>
 void SyncBuffer::decode(T& value) {
     const size_t size = sizeof(T);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(&value, _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeSize, "Reading past the end of buffer");
+    std::memcpy(&value, _decodeData + _decodeOffset, size);
     _decodeOffset += size;
 }
 
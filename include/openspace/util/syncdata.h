@@ -76,6 +76,7 @@ public:
     const T& data() const;
 
 protected:
+    virtual bool isDeltaEncodable() const override;
     virtual void encode(SyncBuffer* syncBuffer) override;
     virtual void decode(SyncBuffer* syncBuffer) override;
     virtual void postSync(bool isMaster) override;
@@ -58,6 +58,13 @@ const T& SyncData<T>::data() const {
     return _data;
 }
 
+template<class T>
+bool SyncData<T>::isDeltaEncodable() const {
+    // The double buffered value is only overwritten by decoding, so a value that did not
+    // change since the last frame does not have to be sent again
+    return true;
+}
+
 template<class T>
 void SyncData<T>::encode(SyncBuffer* syncBuffer) {
     _mutex.lock();
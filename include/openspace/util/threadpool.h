@@ -25,48 +25,150 @@
 #ifndef __OPENSPACE_CORE___THREAD_POOL___H__
 #define __OPENSPACE_CORE___THREAD_POOL___H__
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
-// Implementation based on http://progsch.net/wordpress/?p=81
-
 namespace openspace {
 
-class ThreadPool;
-
-class Worker {
-public:
-    Worker(ThreadPool& p);
-    void operator()();
-
-private:
-    ThreadPool& pool;
-};
-
+/**
+ * A work-stealing thread pool. Every worker thread owns its own task queue that is
+ * protected by its own lock, so that enqueueing and dequeueing tasks does not contend on
+ * a single global mutex. Tasks that are enqueued from a worker thread are placed in that
+ * worker's queue, tasks from other threads are distributed round-robin between the
+ * workers. A worker that runs out of work steals tasks from the other workers' queues.
+ *
+ * Tasks can be given a Priority; a worker will always pick a higher priority task from a
+ * queue before a lower priority one. The functions #submit, #then, #wait, and
+ * #parallelFor provide a way to wait for tasks and to chain continuations.
+ */
 class ThreadPool {
 public:
+    enum class Priority {
+        High = 0,
+        Normal,
+        Low
+    };
+
+    /**
+     * A handle to one or more tasks that have been submitted to the ThreadPool. The
+     * handle is finished once all of the tasks it represents have been executed.
+     */
+    class TaskHandle {
+    public:
+        TaskHandle() = default;
+
+        /// Returns \c true if all tasks represented by this handle have finished
+        bool isFinished() const;
+
+        /// Returns \c true if this handle refers to any submitted task
+        bool isValid() const;
+
+        /**
+         * Returns \c true if any of the tasks represented by this handle, or the task
+         * this handle is a continuation of, was removed by ThreadPool::clearTasks before
+         * it was executed.
+         */
+        bool isCancelled() const;
+
+    private:
+        friend class ThreadPool;
+        struct State;
+        std::shared_ptr<State> _state;
+    };
+
     ThreadPool(size_t numThreads);
     ThreadPool(const ThreadPool& toCopy);
     ~ThreadPool();
 
-    void enqueue(std::function<void()> f);
+    /// Adds the function \p f to the pool without a way to wait for its completion
+    void enqueue(std::function<void()> f, Priority priority = Priority::Normal);
+
+    /// Adds the function \p f to the pool and returns a handle that can be waited for
+    TaskHandle submit(std::function<void()> f, Priority priority = Priority::Normal);
+
+    /**
+     * Registers the function \p f to be enqueued once all tasks represented by
+     * \p handle have finished. If they have already finished, \p f is enqueued
+     * immediately. The returned handle is finished once \p f has been executed.
+     */
+    TaskHandle then(const TaskHandle& handle, std::function<void()> f,
+        Priority priority = Priority::Normal);
+
+    /**
+     * Blocks until all tasks represented by \p handle have finished. If this function
+     * is called from one of the pool's worker threads, that worker keeps executing other
+     * tasks while waiting and only sleeps if there are none left, which makes it safe to
+     * wait from inside a task.
+     */
+    void wait(const TaskHandle& handle);
+
+    /**
+     * Calls \p f for every index in [\p begin, \p end) distributed across the worker
+     * threads in chunks of \p grainSize indices and returns once all calls have
+     * finished. The calling thread participates in the work, but only ever executes
+     * chunks that belong to this call and otherwise sleeps. If chunks are removed by
+     * #clearTasks in the meantime, this function returns once the remaining chunks have
+     * finished and the removed indices are never passed to \p f.
+     */
+    void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& f,
+        size_t grainSize = 1);
+
+    /**
+     * Removes all tasks that have not been started yet. The handles of the removed tasks
+     * are finished and marked as cancelled so that nobody waiting for them is blocked
+     * and their continuations are removed, too.
+     */
     void clearTasks();
 
-private:
-    friend class Worker;
-
-    std::vector<std::thread> workers;
-
-    std::deque<std::function<void()>> tasks;
+    size_t numThreads() const;
 
-    std::mutex queue_mutex;
-    std::condition_variable condition;
+    /**
+     * Returns the pool that is shared by all parts of the engine that split their work
+     * into parallel tasks or run it in the background. One hardware thread is left for
+     * the thread calling #parallelFor, as that thread participates in the work.
+     */
+    static ThreadPool& shared();
 
-    bool stop;
+private:
+    using Task = std::function<void()>;
+    static constexpr int NumPriorities = 3;
+
+    /// A task together with the state of the handle that is finished after it ran
+    struct QueuedTask {
+        Task task;
+        std::shared_ptr<TaskHandle::State> state;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<QueuedTask> tasks[NumPriorities];
+    };
+
+    void workerLoop(size_t index);
+    void push(QueuedTask task, Priority priority);
+    bool tryPop(size_t index, QueuedTask& task);
+    bool trySteal(size_t index, QueuedTask& task);
+    bool tryRunOwnTask(size_t index, const std::shared_ptr<TaskHandle::State>& state);
+    bool tryRunPendingTask(size_t index);
+    void finish(const std::shared_ptr<TaskHandle::State>& state, bool isCancelled);
+
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::atomic<size_t> _nPendingTasks = 0;
+    std::atomic<size_t> _nSleepingWorkers = 0;
+    std::atomic<size_t> _nWaitingWorkers = 0;
+    std::atomic<size_t> _nextQueue = 0;
+    std::mutex _sleepMutex;
+    std::condition_variable _condition;
+
+    std::atomic_bool _stop = false;
 };
 
 } // namespace openspace
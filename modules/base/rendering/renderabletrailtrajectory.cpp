@@ -29,6 +29,9 @@
 #include <openspace/scene/translation.h>
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/updatestructures.h>
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
 
 // This class creates the entire trajectory at once and keeps it in memory the entire
 // time. This means that there is no need for updating the trail at runtime, but also that
@@ -41,8 +44,17 @@
 // bucket that contains the line from the last shown point to the current location of the
 // object iff not the entire path is shown and the object is between _startTime and
 // _endTime. This buffer is updated every frame.
+// The samples are computed by a TrailSampler. If the Translation is thread safe, this
+// happens in the background and the render thread only uploads the finished (or
+// progressively refined) positions. Otherwise, the sampling is spread across multiple
+// frames with a fixed time budget per frame.
 
 namespace {
+    constexpr const char* KeyUseCache = "UseCache";
+
+    // The time that is spent sampling per frame for Translations that are not thread safe
+    constexpr const std::chrono::microseconds SampleBudget = std::chrono::milliseconds(4);
+
     constexpr openspace::properties::Property::PropertyInfo StartTimeInfo = {
         "StartTime",
         "Start Time",
@@ -121,6 +133,14 @@ documentation::Documentation RenderableTrailTrajectory::Documentation() {
                 new BoolVerifier,
                 Optional::Yes,
                 RenderFullPathInfo.description
+            },
+            {
+                KeyUseCache,
+                new BoolVerifier,
+                Optional::Yes,
+                "If this value is 'true', the sampled trail is cached on disk and reused "
+                "as long as the parameters of the translation, the loaded SPICE kernels, "
+                "and the sampled time range do not change. Defaults to 'true'"
             }
         }
     };
@@ -179,6 +199,14 @@ RenderableTrailTrajectory::RenderableTrailTrajectory(const ghoul::Dictionary& di
     }
     addProperty(_renderFullTrail);
 
+    if (dictionary.hasValue<bool>(KeyUseCache)) {
+        _useCache = dictionary.value<bool>(KeyUseCache);
+    }
+
+    _sampler = std::make_unique<TrailSampler>([this](double time) {
+        return _translation->position({ {}, Time(time), Time(0.0) });
+    });
+
     // We store the vertices with ascending temporal order
     _primaryRenderInformation.sorting = RenderInformation::VertexSorting::OldestFirst;
 }
@@ -198,6 +226,10 @@ void RenderableTrailTrajectory::initializeGL() {
 }
 
 void RenderableTrailTrajectory::deinitializeGL() {
+    // The vertex buffers are recreated and refilled on the next initialization
+    _sampler->cancel();
+    _needsFullSweep = true;
+
     glDeleteVertexArrays(1, &_primaryRenderInformation._vaoID);
     glDeleteBuffers(1, &_primaryRenderInformation._vBufferID);
 
@@ -207,6 +239,63 @@ void RenderableTrailTrajectory::deinitializeGL() {
     RenderableTrail::deinitializeGL();
 }
 
+std::string RenderableTrailTrajectory::cacheKey(double interval, int nValues) const {
+    std::string key = fmt::format("{}|{}|{}", _start, interval, nValues);
+    for (const properties::Property* p : _translation->properties()) {
+        key += fmt::format("|{}={}", p->identifier(), p->getStringValue());
+    }
+    // The positions of SPICE based translations depend on the loaded kernels
+    for (const std::string& kernel : SpiceManager::ref().loadedKernels()) {
+        key += '|' + kernel;
+    }
+    return key;
+}
+
+void RenderableTrailTrajectory::uploadVertices(const std::vector<glm::vec3>& positions) {
+    _vertexArray.resize(positions.size());
+    std::transform(
+        positions.begin(),
+        positions.end(),
+        _vertexArray.begin(),
+        [](const glm::vec3& p) { return TrailVBOLayout{ p.x, p.y, p.z }; }
+    );
+
+    glBindVertexArray(_primaryRenderInformation._vaoID);
+    glBindBuffer(GL_ARRAY_BUFFER, _primaryRenderInformation._vBufferID);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        _vertexArray.size() * sizeof(TrailVBOLayout),
+        _vertexArray.data(),
+        GL_STATIC_DRAW
+    );
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glBindVertexArray(0);
+
+    // We clear the indexArray just in case. The base class will take care not to use
+    // it if it is empty
+    _indexArray.clear();
+
+    // Updating bounding sphere
+    glm::vec3 maxVertex(-std::numeric_limits<float>::max());
+    glm::vec3 minVertex(std::numeric_limits<float>::max());
+
+    auto setMax = [&maxVertex, &minVertex](const TrailVBOLayout& vertexData) {
+        maxVertex.x = std::max(maxVertex.x, vertexData.x);
+        maxVertex.y = std::max(maxVertex.y, vertexData.y);
+        maxVertex.z = std::max(maxVertex.z, vertexData.z);
+
+        minVertex.x = std::min(minVertex.x, vertexData.x);
+        minVertex.y = std::min(minVertex.y, vertexData.y);
+        minVertex.z = std::min(minVertex.z, vertexData.z);
+    };
+
+    std::for_each(_vertexArray.begin(), _vertexArray.end(), setMax);
+
+    setBoundingSphere(glm::distance(maxVertex, minVertex) / 2.f);
+}
+
 void RenderableTrailTrajectory::update(const UpdateData& data) {
     if (_needsFullSweep) {
         // Convert the start and end time from string representations to J2000 seconds
@@ -218,39 +307,37 @@ void RenderableTrailTrajectory::update(const UpdateData& data) {
         // end date and the desired sample interval
         const int nValues = static_cast<int>((_end - _start) / totalSampleInterval);
 
-        // Make space for the vertices
-        _vertexArray.clear();
-        _vertexArray.resize(nValues);
-
-        // ... fill all of the values
-        for (int i = 0; i < nValues; ++i) {
-            const glm::vec3 p = _translation->position({
-                {},
-                Time(_start + i * totalSampleInterval),
-                Time(0.0)
-            });
-            _vertexArray[i] = { p.x, p.y, p.z };
+        TrailSampler::Request request;
+        request.start = _start;
+        request.interval = totalSampleInterval;
+        request.nValues = std::max(nValues, 0);
+        request.isThreadSafe = _translation->isThreadSafe();
+        if (_useCache) {
+            request.cacheKey = cacheKey(totalSampleInterval, request.nValues);
+            request.cacheFile = FileSys.cacheManager()->cachedFilename(
+                "RenderableTrailTrajectory",
+                request.cacheKey,
+                ghoul::filesystem::CacheManager::Persistent::Yes
+            );
         }
+        _sampler->request(std::move(request));
 
-        // ... and upload them to the GPU
-        glBindVertexArray(_primaryRenderInformation._vaoID);
-        glBindBuffer(GL_ARRAY_BUFFER, _primaryRenderInformation._vBufferID);
-        glBufferData(
-            GL_ARRAY_BUFFER,
-            _vertexArray.size() * sizeof(TrailVBOLayout),
-            _vertexArray.data(),
-            GL_STATIC_DRAW
-        );
+        _subsamplingIsDirty = true;
+        _needsFullSweep = false;
+    }
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    // Only does work if the translation has to be sampled on this thread
+    _sampler->update(SampleBudget);
 
-        // We clear the indexArray just in case. The base class will take care not to use
-        // it if it is empty
-        _indexArray.clear();
+    if (std::optional<TrailSampler::Result> result = _sampler->popResult(); result) {
+        uploadVertices(result->positions);
+    }
 
-        _subsamplingIsDirty = true;
-        _needsFullSweep = false;
+    if (_vertexArray.empty()) {
+        // Nothing has been sampled yet
+        _primaryRenderInformation.count = 0;
+        _floatingRenderInformation.count = 0;
+        return;
     }
 
     // This has to be done every update step;
@@ -332,25 +419,6 @@ void RenderableTrailTrajectory::update(const UpdateData& data) {
     }
 
     glBindVertexArray(0);
-
-    // Updating bounding sphere
-    glm::vec3 maxVertex(-std::numeric_limits<float>::max());
-    glm::vec3 minVertex(std::numeric_limits<float>::max());
-
-    auto setMax = [&maxVertex, &minVertex](const TrailVBOLayout& vertexData) {
-        maxVertex.x = std::max(maxVertex.x, vertexData.x);
-        maxVertex.y = std::max(maxVertex.y, vertexData.y);
-        maxVertex.z = std::max(maxVertex.z, vertexData.z);
-
-        minVertex.x = std::min(minVertex.x, vertexData.x);
-        minVertex.y = std::min(minVertex.y, vertexData.y);
-        minVertex.z = std::min(minVertex.z, vertexData.z);
-    };
-
-    std::for_each(_vertexArray.begin(), _vertexArray.end(), setMax);
-
-    setBoundingSphere(glm::distance(maxVertex, minVertex) / 2.f);
-
 }
 
 } // namespace openspace
@@ -27,11 +27,13 @@
 
 #include <modules/base/rendering/renderabletrail.h>
 
+#include <modules/base/rendering/trailsampler.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/scalar/doubleproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
 #include <array>
+#include <memory>
 
 namespace openspace {
 
@@ -47,6 +49,11 @@ namespace documentation { struct Documentation; }
  * trail in the future. If _renderFullTrail is false, the current position of the object
  * has to be updated constantly to make the trail connect to the object that has the
  * trail.
+ *
+ * The samples are computed by a TrailSampler, in the background if the Translation is
+ * thread safe, and the trail is shown progressively refined while they are computed.
+ * Finished trails are cached on disk, keyed by the parameters of the Translation, the
+ * loaded SPICE kernels, and the sampled time range.
  */
 class RenderableTrailTrajectory : public RenderableTrail {
 public:
@@ -60,6 +67,12 @@ public:
     static documentation::Documentation Documentation();
 
 private:
+    /// Returns a description of all parameters that influence the sampled positions
+    std::string cacheKey(double interval, int nValues) const;
+
+    /// Replaces the vertex buffer with the provided positions
+    void uploadVertices(const std::vector<glm::vec3>& positions);
+
     /// The start time of the trail
     properties::StringProperty _startTime;
     /// The end time of the trail
@@ -75,6 +88,12 @@ private:
     /// Dirty flag that determines whether the full vertex buffer needs to be resampled
     bool _needsFullSweep = true;
 
+    /// Computes the samples of the trail after a full sweep has been requested
+    std::unique_ptr<TrailSampler> _sampler;
+
+    /// Determines whether finished trails are cached on disk
+    bool _useCache = true;
+
     /// Dirty flag to determine whether the stride information needs to be changed
     bool _subsamplingIsDirty = true;
 
@@ -0,0 +1,329 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/base/rendering/trailsampler.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <fstream>
+
+namespace {
+    constexpr const char* _loggerCat = "TrailSampler";
+
+    // The first pass computes at least this many samples (unless the trail is shorter)
+    // and fewer than twice as many
+    constexpr const int CoarsestSamples = 256;
+
+    // The number of samples that are computed by a single task of a parallel pass
+    constexpr const int ChunkSize = 512;
+
+    // The number of samples that are computed between checks of the time budget when
+    // sampling on the calling thread
+    constexpr const int UpdateChunkSize = 64;
+
+    constexpr const int8_t CurrentCacheVersion = 1;
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "Unexpected glm::vec3 layout");
+} // namespace
+
+namespace openspace {
+
+TrailSampler::TrailSampler(Sampler sampler)
+    : _sampler(std::move(sampler))
+{
+    ghoul_assert(_sampler, "Sampler must not be empty");
+}
+
+TrailSampler::~TrailSampler() {
+    cancel();
+    ThreadPool::shared().wait(_task);
+}
+
+void TrailSampler::request(Request request) {
+    ghoul_assert(request.nValues == 0 || request.interval > 0.0, "Invalid interval");
+
+    uint64_t generation = 0;
+    {
+        std::lock_guard lock(_resultMutex);
+        generation = ++_generation;
+        _result = std::nullopt;
+        _isFinished = false;
+    }
+    _job = std::nullopt;
+
+    auto job = std::make_shared<Job>();
+    job->request = std::move(request);
+    job->generation = generation;
+
+    const int n = std::max(job->request.nValues, 0);
+    job->samples.resize(n);
+    int stride = 1;
+    while (n / (stride * 2) >= CoarsestSamples) {
+        stride *= 2;
+    }
+    job->stride = stride;
+    job->offset = 0;
+    job->step = stride;
+    // The first pass also computes the last sample so that all other samples can be
+    // interpolated between computed neighbors
+    job->nPassValues = n > 0 ? (n - 1) / stride + 1 + ((n - 1) % stride != 0) : 0;
+
+    if (n == 0) {
+        publish(*job, { {}, true });
+        return;
+    }
+
+    if (job->request.isThreadSafe) {
+        // Chaining the tasks guarantees that a cancelled task has returned before the
+        // next one starts and that waiting for the last task waits for all of them
+        _task = ThreadPool::shared().then(
+            _task,
+            [this, job]() { run(*job); },
+            ThreadPool::Priority::Low
+        );
+    }
+    else {
+        if (loadCache(*job)) {
+            ++_nCacheHits;
+            publish(*job, { std::move(job->samples), true });
+            return;
+        }
+        _job = std::move(*job);
+    }
+}
+
+void TrailSampler::cancel() {
+    std::lock_guard lock(_resultMutex);
+    ++_generation;
+    _result = std::nullopt;
+    _isFinished = true;
+    _job = std::nullopt;
+}
+
+void TrailSampler::update(std::chrono::microseconds budget) {
+    if (!_job) {
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point begin = Clock::now();
+    Job& job = *_job;
+    while (true) {
+        const int end = std::min(job.nSampled + UpdateChunkSize, job.nPassValues);
+        sample(job, job.nSampled, end);
+        job.nSampled = end;
+
+        if (job.nSampled == job.nPassValues && finishPass(job)) {
+            _job = std::nullopt;
+            return;
+        }
+        if (Clock::now() - begin >= budget) {
+            return;
+        }
+    }
+}
+
+std::optional<TrailSampler::Result> TrailSampler::popResult() {
+    std::lock_guard lock(_resultMutex);
+    std::optional<Result> result = std::move(_result);
+    _result = std::nullopt;
+    return result;
+}
+
+bool TrailSampler::isFinished() const {
+    return _isFinished;
+}
+
+void TrailSampler::waitUntilFinished() {
+    ghoul_assert(!_job, "Requests that are not thread safe are sampled in update");
+    ThreadPool::shared().wait(_task);
+}
+
+int TrailSampler::nCacheHits() const {
+    return _nCacheHits;
+}
+
+void TrailSampler::run(Job& job) {
+    if (isCancelled(job)) {
+        return;
+    }
+    if (loadCache(job)) {
+        ++_nCacheHits;
+        publish(job, { std::move(job.samples), true });
+        return;
+    }
+
+    while (true) {
+        const int nChunks = (job.nPassValues + ChunkSize - 1) / ChunkSize;
+        ThreadPool::shared().parallelFor(
+            0,
+            nChunks,
+            [this, &job](size_t chunk) {
+                if (isCancelled(job)) {
+                    return;
+                }
+                const int begin = static_cast<int>(chunk) * ChunkSize;
+                sample(job, begin, std::min(begin + ChunkSize, job.nPassValues));
+            }
+        );
+        if (isCancelled(job)) {
+            return;
+        }
+        job.nSampled = job.nPassValues;
+
+        if (finishPass(job)) {
+            return;
+        }
+    }
+}
+
+void TrailSampler::sample(Job& job, int begin, int end) const {
+    const int last = job.request.nValues - 1;
+    for (int i = begin; i < end; ++i) {
+        const int index = std::min(job.offset + i * job.step, last);
+        const double time = job.request.start + index * job.request.interval;
+        job.samples[index] = glm::vec3(_sampler(time));
+    }
+}
+
+bool TrailSampler::finishPass(Job& job) {
+    const int n = job.request.nValues;
+    if (job.stride == 1) {
+        saveCache(job);
+        publish(job, { std::move(job.samples), true });
+        return true;
+    }
+
+    // Every sample that is a multiple of the stride has been computed, as well as the
+    // last one. The others are placed on the line between those neighbors
+    Result result;
+    result.positions.resize(n);
+    const int stride = job.stride;
+    for (int i = 0; i < n; ++i) {
+        const int a = i - i % stride;
+        if (a == i || i == n - 1) {
+            result.positions[i] = job.samples[i];
+        }
+        else {
+            const int b = std::min(a + stride, n - 1);
+            const float t = static_cast<float>(i - a) / static_cast<float>(b - a);
+            result.positions[i] = glm::mix(job.samples[a], job.samples[b], t);
+        }
+    }
+    publish(job, std::move(result));
+
+    // The next pass computes the samples halfway between the ones we already have. The
+    // last sample was computed in the first pass already
+    job.offset = stride / 2;
+    job.step = stride;
+    job.stride = stride / 2;
+    job.nPassValues = job.offset < n - 1 ? (n - 2 - job.offset) / job.step + 1 : 0;
+    job.nSampled = 0;
+    return false;
+}
+
+void TrailSampler::publish(const Job& job, Result result) {
+    std::lock_guard lock(_resultMutex);
+    if (job.generation != _generation) {
+        // The request has been replaced or cancelled in the meantime
+        return;
+    }
+    if (result.isFinal) {
+        _isFinished = true;
+    }
+    _result = std::move(result);
+}
+
+bool TrailSampler::isCancelled(const Job& job) const {
+    return job.generation != _generation;
+}
+
+bool TrailSampler::loadCache(Job& job) const {
+    if (job.request.cacheFile.empty()) {
+        return false;
+    }
+
+    std::ifstream file(job.request.cacheFile, std::ios::binary);
+    if (!file.good()) {
+        return false;
+    }
+
+    int8_t version = 0;
+    file.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
+    if (!file.good() || version != CurrentCacheVersion) {
+        return false;
+    }
+
+    uint32_t keyLength = 0;
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(uint32_t));
+    if (!file.good() || keyLength != job.request.cacheKey.size()) {
+        return false;
+    }
+    std::string key(keyLength, '\0');
+    file.read(key.data(), keyLength);
+    if (!file.good() || key != job.request.cacheKey) {
+        return false;
+    }
+
+    int32_t nValues = 0;
+    file.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
+    if (!file.good() || nValues != job.request.nValues) {
+        return false;
+    }
+
+    file.read(
+        reinterpret_cast<char*>(job.samples.data()),
+        job.samples.size() * sizeof(glm::vec3)
+    );
+    return file.good();
+}
+
+void TrailSampler::saveCache(const Job& job) const {
+    if (job.request.cacheFile.empty()) {
+        return;
+    }
+
+    std::ofstream file(job.request.cacheFile, std::ios::binary);
+    if (!file.good()) {
+        LWARNING(fmt::format(
+            "Could not write trail cache file '{}'", job.request.cacheFile
+        ));
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(&CurrentCacheVersion), sizeof(int8_t));
+    const uint32_t keyLength = static_cast<uint32_t>(job.request.cacheKey.size());
+    file.write(reinterpret_cast<const char*>(&keyLength), sizeof(uint32_t));
+    file.write(job.request.cacheKey.data(), keyLength);
+    const int32_t nValues = job.request.nValues;
+    file.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
+    file.write(
+        reinterpret_cast<const char*>(job.samples.data()),
+        job.samples.size() * sizeof(glm::vec3)
+    );
+}
+
+} // namespace openspace
@@ -0,0 +1,169 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_BASE___TRAILSAMPLER___H__
+#define __OPENSPACE_MODULE_BASE___TRAILSAMPLER___H__
+
+#include <openspace/util/threadpool.h>
+#include <ghoul/glm.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Samples the positions along a trail equitemporally without blocking the render thread.
+ * The samples are computed from coarse to fine: the first pass computes every n-th
+ * sample (and the last one), every following pass halves the distance between computed
+ * samples. After each pass, a Result is published in which the missing samples are
+ * linearly interpolated from their computed neighbors, so that a trail can be shown
+ * right away and is refined progressively.
+ *
+ * If a Request is marked as thread safe, the passes are run as a task on a thread pool
+ * that is shared between all samplers, with each pass being split into chunks that are
+ * sampled in parallel. Otherwise, the sampling function is only ever called from within
+ * #update, which samples for a limited amount of time on the calling thread.
+ *
+ * If a Request has a cache file, the finished trail is written to that file and later
+ * requests with the same cache key are loaded from it instead of being sampled again.
+ */
+class TrailSampler {
+public:
+    /// The function that returns the position of the object at the provided time
+    using Sampler = std::function<glm::dvec3(double time)>;
+
+    struct Request {
+        /// The time of the first sample
+        double start = 0.0;
+        /// The time between two consecutive samples
+        double interval = 0.0;
+        /// The number of samples that make up the trail
+        int nValues = 0;
+        /// If this is \c true, the sampling function can be called concurrently from
+        /// multiple threads
+        bool isThreadSafe = false;
+        /// The file in which the finished samples are cached. No cache is used if this is
+        /// empty
+        std::string cacheFile;
+        /// A description of all parameters that influence the samples. A cache file is
+        /// only used if it was written with the same key
+        std::string cacheKey;
+    };
+
+    struct Result {
+        /// The positions of all samples; samples that have not been computed yet are
+        /// interpolated from their neighbors
+        std::vector<glm::vec3> positions;
+        /// \c true if all samples have been computed
+        bool isFinal = false;
+    };
+
+    explicit TrailSampler(Sampler sampler);
+
+    /// Cancels the current request and waits until its task has returned
+    ~TrailSampler();
+
+    /**
+     * Starts sampling the trail described by \p request. A request that is still being
+     * sampled is cancelled and none of its results are published anymore.
+     */
+    void request(Request request);
+
+    /// Cancels the current request
+    void cancel();
+
+    /**
+     * Progresses a request that is not thread safe by sampling on the calling thread
+     * until the provided \p budget is used up. Requests that are thread safe are sampled
+     * in the background and are not affected by this function.
+     */
+    void update(std::chrono::microseconds budget);
+
+    /**
+     * Returns the latest Result that was published since the last call to this function
+     * or \c std::nullopt if there is no new Result.
+     */
+    std::optional<Result> popResult();
+
+    /// Returns \c true if the current request has been sampled completely or cancelled
+    bool isFinished() const;
+
+    /// Blocks until the current request is finished; must only be used for requests that
+    /// are thread safe
+    void waitUntilFinished();
+
+    /// Returns the number of requests whose samples were loaded from a cache file
+    int nCacheHits() const;
+
+private:
+    /// The state of the sampling of a single request
+    struct Job {
+        Request request;
+        uint64_t generation = 0;
+        std::vector<glm::vec3> samples;
+
+        /// The distance between computed samples after the current pass has finished
+        int stride = 0;
+        /// The index of the first sample of the current pass
+        int offset = 0;
+        /// The distance between two samples of the current pass
+        int step = 0;
+        /// The number of samples in the current pass
+        int nPassValues = 0;
+        /// The number of samples of the current pass that have been computed already
+        int nSampled = 0;
+    };
+
+    void run(Job& job);
+    void sample(Job& job, int begin, int end) const;
+    bool finishPass(Job& job);
+    void publish(const Job& job, Result result);
+    bool isCancelled(const Job& job) const;
+    bool loadCache(Job& job) const;
+    void saveCache(const Job& job) const;
+
+    Sampler _sampler;
+
+    std::atomic<uint64_t> _generation = 0;
+    std::atomic_bool _isFinished = true;
+    std::atomic_int _nCacheHits = 0;
+
+    /// The request that is sampled on the calling thread of #update
+    std::optional<Job> _job;
+
+    /// The task running the last thread safe request, which all later tasks wait for
+    ThreadPool::TaskHandle _task;
+
+    mutable std::mutex _resultMutex;
+    std::optional<Result> _result;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_BASE___TRAILSAMPLER___H__
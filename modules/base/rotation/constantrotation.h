@@ -39,6 +39,7 @@ public:
     ConstantRotation(const ghoul::Dictionary& dictionary);
 
     glm::dmat3 matrix(const UpdateData& data) const override;
+    bool isThreadSafe() const override;
 
     static documentation::Documentation Documentation();
 
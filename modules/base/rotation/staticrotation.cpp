@@ -113,4 +113,8 @@ glm::dmat3 StaticRotation::matrix(const UpdateData&) const {
     return _cachedMatrix;
 }
 
+bool StaticRotation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
@@ -38,6 +38,7 @@ public:
     NonUniformStaticScale();
     NonUniformStaticScale(const ghoul::Dictionary& dictionary);
     glm::dvec3 scaleValue(const UpdateData& data) const override;
+    bool isThreadSafe() const override;
 
     static documentation::Documentation Documentation();
 
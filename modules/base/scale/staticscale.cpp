@@ -67,4 +67,8 @@ StaticScale::StaticScale(const ghoul::Dictionary& dictionary) : StaticScale() {
     _scaleValue = p.scale;
 }
 
+bool StaticScale::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
@@ -31,7 +31,6 @@
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/util/updatestructures.h>
 #include <openspace/rendering/renderengine.h>
-#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/misc/crc32.h>
 #include <ghoul/misc/templatefactory.h>
@@ -66,7 +65,6 @@ namespace {
         "hasColorMap", "enabledRectSizeControl", "hasDvarScaling"
     };
 
-    constexpr int8_t CurrentCacheVersion = 1;
     constexpr double PARSEC = 0.308567756E17;
 
     constexpr const int RenderOptionViewDirection = 0;
@@ -571,12 +569,16 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
 
     _setRangeFromData.onChange([this]() {
         const int colorMapInUse =
-            _hasColorMapFile ? _variableDataPositionMap[_colorOptionString] : 0;
+            _hasColorMapFile ? _dataset.index(_colorOptionString) : -1;
+        if (colorMapInUse < 0) {
+            return;
+        }
 
         float minValue = std::numeric_limits<float>::max();
         float maxValue = std::numeric_limits<float>::min();
-        for (size_t i = 0; i < _fullData.size(); i += _nValuesPerAstronomicalObject) {
-            float colorIdx = _fullData[i + 3 + colorMapInUse];
+        const float* colorValues = _dataset.column(colorMapInUse);
+        for (size_t i = 0; i < _dataset.nEntries(); ++i) {
+            float colorIdx = colorValues[i];
             maxValue = colorIdx >= maxValue ? colorIdx : maxValue;
             minValue = colorIdx < minValue ? colorIdx : minValue;
         }
@@ -591,7 +593,7 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
 }
 
 bool RenderableBillboardsCloud::isReady() const {
-    return ((_program != nullptr) && (!_fullData.empty())) || (!_labelData.empty());
+    return ((_program != nullptr) && (!_dataset.isEmpty())) || (!_labelData.empty());
 }
 
 void RenderableBillboardsCloud::initialize() {
@@ -749,9 +751,7 @@ void RenderableBillboardsCloud::renderBillboards(const RenderData& data,
     _program->setUniform(_uniformCache.hasColormap, _hasColorMapFile);
 
     glBindVertexArray(_vao);
-    const GLsizei nAstronomicalObjects = static_cast<GLsizei>(
-        _fullData.size() / _nValuesPerAstronomicalObject
-    );
+    const GLsizei nAstronomicalObjects = static_cast<GLsizei>(_dataset.nEntries());
     glDrawArrays(GL_POINTS, 0, nAstronomicalObjects);
 
     glBindVertexArray(0);
@@ -1083,174 +1083,42 @@ bool RenderableBillboardsCloud::loadSpeckData() {
     if (!_hasSpeckFile) {
         return true;
     }
-    bool success = true;
-    const std::string& cachedFile = FileSys.cacheManager()->cachedFilename(
-        ghoul::filesystem::File(_speckFile),
-        "RenderableDUMeshes|" + identifier(),
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
 
-    const bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format(
-            "Cached file '{}' used for Speck file '{}'",
-            cachedFile, _speckFile
-        ));
-
-        success = loadCachedFile(cachedFile);
-        if (success) {
-            return true;
-        }
-        else {
-            FileSys.cacheManager()->removeCacheFile(_speckFile);
-            // Intentional fall-through to the 'else' to generate the cache
-            // file for the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Speck file '{}' not found", _speckFile));
+    try {
+        _dataset = speck::loadSpeckFileCached(
+            _speckFile,
+            "RenderableBillboardsCloud|" + identifier()
+        );
     }
-    LINFO(fmt::format("Loading Speck file '{}'", _speckFile));
-
-    success = readSpeckFile();
-    if (!success) {
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
         return false;
     }
-
-    success &= saveCachedFile(cachedFile);
-    return success;
+    return true;
 }
 
 bool RenderableBillboardsCloud::loadLabelData() {
     if (_labelFile.empty()) {
         return true;
     }
-    bool success = true;
-    // I disabled the cache as it didn't work on Mac --- abock
-    const std::string& cachedFile = FileSys.cacheManager()->cachedFilename(
-        ghoul::filesystem::File(_labelFile),
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
-    if (!_hasSpeckFile && !_hasColorMapFile) {
-        success = true;
-    }
-    const bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format(
-            "Cached file '{}' used for Label file '{}'",
-            cachedFile, _labelFile
-        ));
-
-        success &= loadCachedFile(cachedFile);
-        if (!success) {
-            FileSys.cacheManager()->removeCacheFile(_labelFile);
-            // Intentional fall-through to the 'else' to generate the cache
-            // file for the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Label file '{}' not found", _labelFile));
-        LINFO(fmt::format("Loading Label file '{}'", _labelFile));
 
-        success &= readLabelFile();
-        if (!success) {
-            return false;
-        }
+    LINFO(fmt::format("Loading Label file '{}'", _labelFile));
+    std::vector<speck::Label> labels;
+    try {
+        labels = speck::loadLabelFile(_labelFile);
     }
-
-    return success;
-}
-
-bool RenderableBillboardsCloud::readSpeckFile() {
-    std::ifstream file(_speckFile);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _speckFile));
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
         return false;
     }
 
-    _nValuesPerAstronomicalObject = 0;
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        if (line.substr(0, 7) != "datavar" &&
-            line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture" &&
-            line.substr(0, 10) != "polyorivar" &&
-            line.substr(0, 10) != "maxcomment")
-        {
-            // Started reading data
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly overwrite
-            // the 'nValues' variable with the latest index, we will end up with the total
-            // number of values (+3 since X Y Z are not counted in the Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy; // command
-            str >> _nValuesPerAstronomicalObject; // variable index
-            dummy.clear();
-            str >> dummy; // variable name
-
-            _variableDataPositionMap.insert({ dummy, _nValuesPerAstronomicalObject });
-
-            // We want the number, but the index is 0 based
-            _nValuesPerAstronomicalObject += 1;
-        }
+    _labelData.reserve(labels.size());
+    for (speck::Label& label : labels) {
+        glm::vec3 transformedPos = glm::vec3(
+            _transformationMatrix * glm::dvec4(label.position, 1.0)
+        );
+        _labelData.emplace_back(transformedPos, std::move(label.text));
     }
-
-    _nValuesPerAstronomicalObject += 3; // X Y Z are not counted in the Speck file indices
-
-
-
-    do {
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        if (line.empty()) {
-            std::getline(file, line);
-            continue;
-        }
-        else if (line[0] == '#') {
-            std::getline(file, line);
-            continue;
-        }
-
-        std::stringstream str(line);
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
-        for (int i = 0; i < _nValuesPerAstronomicalObject; ++i) {
-            str >> values[i];
-        }
-
-        _fullData.insert(_fullData.end(), values.begin(), values.end());
-
-        // reads new line
-        std::getline(file, line);
-    } while (!file.eof());
-
     return true;
 }
 
@@ -1304,211 +1172,32 @@ bool RenderableBillboardsCloud::readColorMapFile() {
     return true;
 }
 
-bool RenderableBillboardsCloud::readLabelFile() {
-    std::string _file = _labelFile;
-    std::ifstream file(_file);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Label file '{}'", _file));
-        return false;
-    }
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        if (line.substr(0, 9) != "textcolor") {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
-            file.seekg(position);
-            continue;
-        }
-
-        if (line.substr(0, 9) == "textcolor") {
-            // textcolor lines are structured as follows:
-            // textcolor # description
-            // where # is color text defined in configuration file
-            std::stringstream str(line);
-
-            // TODO: handle cases of labels with different colors
-            break;
-        }
-    }
-
-
-    do {
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        if (line.empty()) {
-            continue;
-        }
-
-        std::stringstream str(line);
-
-        glm::vec3 position = glm::vec3(0.f);
-        for (int j = 0; j < 3; ++j) {
-            str >> position[j];
-        }
-
-        std::string dummy;
-        str >> dummy; // text keyword
-
-        std::string label;
-        str >> label;
-        dummy.clear();
-
-        while (str >> dummy) {
-            if (dummy == "#") {
-                break;
-            }
-
-            label += " " + dummy;
-            dummy.clear();
-        }
-
-        glm::vec3 transformedPos = glm::vec3(
-            _transformationMatrix * glm::dvec4(position, 1.0)
-        );
-        _labelData.emplace_back(std::make_pair(transformedPos, label));
-    } while (!file.eof());
-
-    return true;
-}
-
-bool RenderableBillboardsCloud::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
-        return false;
-    }
-    int8_t version = 0;
-    fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-    if (version != CurrentCacheVersion) {
-        LINFO("The format of the cached file has changed: deleting old cache");
-        fileStream.close();
-        FileSys.deleteFile(file);
-        return false;
-    }
-
-    int32_t nValues = 0;
-    fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-    fileStream.read(
-        reinterpret_cast<char*>(&_nValuesPerAstronomicalObject),
-        sizeof(int32_t)
-    );
-
-    _fullData.resize(nValues);
-    fileStream.read(
-        reinterpret_cast<char*>(&_fullData[0]),
-        nValues * sizeof(_fullData[0])
-    );
-
-    if (_hasColorMapFile) {
-        int32_t nItems = 0;
-        fileStream.read(reinterpret_cast<char*>(&nItems), sizeof(int32_t));
-
-        for (int i = 0; i < nItems; ++i) {
-            int32_t keySize = 0;
-            fileStream.read(reinterpret_cast<char*>(&keySize), sizeof(int32_t));
-            std::vector<char> buffer(keySize);
-            fileStream.read(buffer.data(), keySize);
-
-            std::string key(buffer.begin(), buffer.end());
-            int32_t value = 0;
-            fileStream.read(reinterpret_cast<char*>(&value), sizeof(int32_t));
-
-            _variableDataPositionMap.insert({ key, value });
-        }
-    }
-
-    bool success = fileStream.good();
-    return success;
-}
-
-bool RenderableBillboardsCloud::saveCachedFile(const std::string& file) const {
-    std::ofstream fileStream(file, std::ofstream::binary);
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Error opening file '{}' for save cache file", file));
-        return false;
-    }
-    fileStream.write(reinterpret_cast<const char*>(&CurrentCacheVersion), sizeof(int8_t));
-
-    int32_t nValues = static_cast<int32_t>(_fullData.size());
-    if (nValues == 0) {
-        LERROR("Error writing cache: No values were loaded");
-        return false;
-    }
-    fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
-
-    int32_t nValuesPerAstronomicalObject = static_cast<int32_t>(
-        _nValuesPerAstronomicalObject
-    );
-    fileStream.write(
-        reinterpret_cast<const char*>(&nValuesPerAstronomicalObject),
-        sizeof(int32_t)
-    );
-
-    size_t nBytes = nValues * sizeof(_fullData[0]);
-    fileStream.write(reinterpret_cast<const char*>(&_fullData[0]), nBytes);
-
-    if (_hasColorMapFile) {
-        int32_t nItems = static_cast<int32_t>(_variableDataPositionMap.size());
-        fileStream.write(reinterpret_cast<const char*>(&nItems), sizeof(int32_t));
-
-        for (const std::pair<const std::string, int>& pair : _variableDataPositionMap) {
-            int32_t keySize = static_cast<int32_t>(pair.first.size());
-            fileStream.write(reinterpret_cast<const char*>(&keySize), sizeof(int32_t));
-            fileStream.write(pair.first.data(), keySize);
-            int32_t value = static_cast<int32_t>(pair.second);
-            fileStream.write(reinterpret_cast<const char*>(&value), sizeof(int32_t));
-        }
-    }
-
-    return fileStream.good();
-}
-
 void RenderableBillboardsCloud::createDataSlice() {
     ZoneScoped
 
     _slicedData.clear();
     if (_hasColorMapFile) {
-        _slicedData.reserve(8 * (_fullData.size() / _nValuesPerAstronomicalObject));
+        _slicedData.reserve(8 * _dataset.nEntries());
     }
     else {
-        _slicedData.reserve(4 * (_fullData.size() / _nValuesPerAstronomicalObject));
+        _slicedData.reserve(4 * _dataset.nEntries());
     }
 
     // what datavar in use for the index color
-    int colorMapInUse =
-        _hasColorMapFile ? _variableDataPositionMap[_colorOptionString] : 0;
+    const int colorMapInUse =
+        _hasColorMapFile ? _dataset.index(_colorOptionString) : -1;
 
     // what datavar in use for the size scaling (if present)
-    int sizeScalingInUse = _hasDatavarSize ?
-        _variableDataPositionMap[_datavarSizeOptionString] : -1;
+    const int sizeScalingInUse =
+        _hasDatavarSize ? _dataset.index(_datavarSizeOptionString) : -1;
+
+    // Unknown data variables are treated as 0 for all entries
+    auto datavarValue = [this](size_t i, int datavarInUse) {
+        return datavarInUse >= 0 ? _dataset.value(i, datavarInUse) : 0.f;
+    };
 
     auto addDatavarSizeScalling = [&](size_t i, int datavarInUse) {
-        _slicedData.push_back(_fullData[i + 3 + datavarInUse]);
+        _slicedData.push_back(datavarValue(i, datavarInUse));
     };
 
     auto addPosition = [&](const glm::vec4 &pos) {
@@ -1520,20 +1209,16 @@ void RenderableBillboardsCloud::createDataSlice() {
     float minColorIdx = std::numeric_limits<float>::max();
     float maxColorIdx = std::numeric_limits<float>::min();
 
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerAstronomicalObject) {
-        float colorIdx = _fullData[i + 3 + colorMapInUse];
+    for (size_t i = 0; i < _dataset.nEntries(); ++i) {
+        float colorIdx = datavarValue(i, colorMapInUse);
         maxColorIdx = colorIdx >= maxColorIdx ? colorIdx : maxColorIdx;
         minColorIdx = colorIdx < minColorIdx ? colorIdx : minColorIdx;
     }
 
     float biggestCoord = -1.f;
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerAstronomicalObject) {
-        glm::dvec4 transformedPos = _transformationMatrix * glm::dvec4(
-            _fullData[i + 0],
-            _fullData[i + 1],
-            _fullData[i + 2],
-            1.0
-        );
+    for (size_t i = 0; i < _dataset.nEntries(); ++i) {
+        glm::dvec4 transformedPos =
+            _transformationMatrix * glm::dvec4(_dataset.position(i), 1.0);
         // W-normalization
         transformedPos /= transformedPos.w;
         glm::vec4 position(glm::vec3(transformedPos), static_cast<float>(_unit));
@@ -1545,7 +1230,7 @@ void RenderableBillboardsCloud::createDataSlice() {
             }
             // Note: if exact colormap option is not selected, the first color and the
             // last color in the colormap file are the outliers colors.
-            float variableColor = _fullData[i + 3 + colorMapInUse];
+            float variableColor = datavarValue(i, colorMapInUse);
 
             float cmax, cmin;
             if (_colorRangeData.empty()) {
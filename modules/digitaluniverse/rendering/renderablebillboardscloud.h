@@ -34,6 +34,7 @@
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/vector/vec2property.h>
 #include <openspace/properties/vector/vec3property.h>
+#include <openspace/util/speckloader.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/opengl/uniformcache.h>
 #include <functional>
@@ -91,11 +92,7 @@ private:
     bool loadData();
     bool loadSpeckData();
     bool loadLabelData();
-    bool readSpeckFile();
     bool readColorMapFile();
-    bool readLabelFile();
-    bool loadCachedFile(const std::string& file);
-    bool saveCachedFile(const std::string& file) const;
 
     bool _hasSpeckFile = false;
     bool _dataIsDirty = true;
@@ -160,16 +157,13 @@ private:
     Unit _unit = Parsec;
 
     std::vector<float> _slicedData;
-    std::vector<float> _fullData;
+    speck::Dataset _dataset;
     std::vector<glm::vec4> _colorMapData;
     std::vector<glm::vec2> _colorRangeData;
     std::vector<std::pair<glm::vec3, std::string>> _labelData;
-    std::unordered_map<std::string, int> _variableDataPositionMap;
     std::unordered_map<int, std::string> _optionConversionMap;
     std::unordered_map<int, std::string> _optionConversionSizeMap;
 
-    int _nValuesPerAstronomicalObject = 0;
-
     glm::dmat4 _transformationMatrix = glm::dmat4(1.0);
 
     GLuint _vao = 0;
@@ -41,7 +41,6 @@
 #include <ghoul/opengl/texture.h>
 #include <ghoul/opengl/textureunit.h>
 #include <array>
-#include <fstream>
 #include <optional>
 #include <string>
 
@@ -53,7 +52,6 @@ namespace {
         "modelViewProjectionTransform", "alphaValue", "fadeInValue", "galaxyTexture"
     };
 
-    constexpr int8_t CurrentCacheVersion = 2;
     constexpr double PARSEC = 0.308567756E17;
 
     enum BlendMode {
@@ -388,7 +386,7 @@ RenderablePlanesCloud::RenderablePlanesCloud(const ghoul::Dictionary& dictionary
 }
 
 bool RenderablePlanesCloud::isReady() const {
-    return ((_program != nullptr) && (!_fullData.empty())) || (!_labelData.empty());
+    return ((_program != nullptr) && (!_dataset.isEmpty())) || (!_labelData.empty());
 }
 
 void RenderablePlanesCloud::initialize() {
@@ -664,72 +662,55 @@ void RenderablePlanesCloud::update(const UpdateData&) {
 bool RenderablePlanesCloud::loadData() {
     bool success = false;
     if (_hasSpeckFile) {
-        // I disabled the cache as it didn't work on Mac --- abock
-        // std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        //     _speckFile,
-        //     ghoul::filesystem::CacheManager::Persistent::Yes
-        // );
-
-        // bool hasCachedFile = FileSys.fileExists(cachedFile);
-        // if (hasCachedFile) {
-        //     LINFO(
-        //         "Cached file '" << cachedFile <<
-        //         "' used for Speck file '" << _speckFile << "'"
-        //     );
-
-        //     success = loadCachedFile(cachedFile);
-        //     if (!success) {
-        //         FileSys.cacheManager()->removeCacheFile(_speckFile);
-        //         // Intentional fall-through to the 'else' to generate the cache
-        //         // file for the next run
-        //     }
-        // }
-        // else
-        // {
-        //     LINFO("Cache for Speck file '" << _speckFile << "' not found");
-        LINFO(fmt::format("Loading Speck file '{}'", _speckFile));
-
-            success = readSpeckFile();
-            if (!success) {
-                return false;
-            }
+        try {
+            _dataset = speck::loadSpeckFileCached(_speckFile, "RenderablePlanesCloud");
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERROR(e.message);
+            return false;
+        }
+
+        // Speck files without these variables fall back to the first columns
+        _planeStartingIndexPos = std::max(_dataset.orientationDataIndex(), 0);
+        _textureVariableIndex = std::max(_dataset.textureDataIndex(), 0);
 
-            // LINFO("Saving cache");
-            //success &= saveCachedFile(cachedFile);
-        // }
+        for (const speck::Texture& texture : _dataset.textures()) {
+            std::string fullPath = absPath(_texturesPath + '/' + texture.file);
+            std::string pngPath =
+                ghoul::filesystem::File(fullPath).fullBaseName() + ".png";
+
+            if (FileSys.fileExists(fullPath)) {
+                _textureFileMap.insert({ texture.index, fullPath });
+            }
+            else if (FileSys.fileExists(pngPath)) {
+                _textureFileMap.insert({ texture.index, pngPath });
+            }
+            else {
+                LWARNING(fmt::format("Could not find image file {}", texture.file));
+                _textureFileMap.insert({ texture.index, "" });
+            }
+        }
+        success = true;
     }
 
     if (!_labelFile.empty()) {
-        // I disabled the cache as it didn't work on Mac --- abock
-        // std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        //     _labelFile,
-        //     ghoul::filesystem::CacheManager::Persistent::Yes
-        // );
-        // bool hasCachedFile = FileSys.fileExists(cachedFile);
-        // if (hasCachedFile) {
-        //     LINFO(
-        //         "Cached file '" << cachedFile <<
-        //         "' used for Label file '" << _labelFile << "'"
-        //     );
-        //
-        //     success &= loadCachedFile(cachedFile);
-        //     if (!success) {
-        //         FileSys.cacheManager()->removeCacheFile(_labelFile);
-        //         // Intentional fall-through to the 'else' to generate the cache
-        //         // file for the next run
-        //     }
-        // }
-        // else
-        // {
-        //     LINFO("Cache for Label file '" << _labelFile << "' not found");
-            LINFO(fmt::format("Loading Label file '{}'", _labelFile));
-
-            success &= readLabelFile();
-            if (!success) {
-                return false;
-            }
+        LINFO(fmt::format("Loading Label file '{}'", _labelFile));
+        std::vector<speck::Label> labels;
+        try {
+            labels = speck::loadLabelFile(_labelFile);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERROR(e.message);
+            return false;
+        }
 
-        // }
+        _labelData.reserve(labels.size());
+        for (speck::Label& label : labels) {
+            glm::vec3 transformedPos = glm::vec3(
+                _transformationMatrix * glm::dvec4(label.position, 1.0)
+            );
+            _labelData.emplace_back(transformedPos, std::move(label.text));
+        }
     }
 
     return success;
@@ -761,357 +742,24 @@ bool RenderablePlanesCloud::loadTextures() {
     return true;
 }
 
-bool RenderablePlanesCloud::readSpeckFile() {
-    std::ifstream file(_speckFile);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _speckFile));
-        return false;
-    }
-
-    _nValuesPerAstronomicalObject = 0;
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() -1);
-        }
-
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        if (line.substr(0, 7) != "datavar" &&
-            line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture" &&
-            line.substr(0, 10) != "polyorivar" &&
-            line.substr(0, 10) != "maxcomment")
-        {
-            // Started reading data
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly overwrite
-            // the 'nValues' variable with the latest index, we will end up with the total
-            // number of values (+3 since X Y Z are not counted in the Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy; // command
-            str >> _nValuesPerAstronomicalObject; // variable index
-            dummy.clear();
-            str >> dummy; // variable name
-
-            // +3 because of the x, y and z at the begining of each line.
-            _variableDataPositionMap.insert({ dummy, _nValuesPerAstronomicalObject + 3});
-
-            if ((dummy == "orientation") || (dummy == "ori")) { // 3d vectors u and v
-                // We want the number, but the index is 0 based
-                _nValuesPerAstronomicalObject += 6;
-            }
-            else {
-                // We want the number, but the index is 0 based
-                _nValuesPerAstronomicalObject += 1;
-            }
-        }
-
-        if (line.substr(0, 10) == "polyorivar") {
-            _planeStartingIndexPos = 0;
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy; // command
-            str >> _planeStartingIndexPos;
-            _planeStartingIndexPos += 3; // 3 for xyz
-        }
-
-        if (line.substr(0, 10) == "texturevar") {
-            _textureVariableIndex = 0;
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy; // command
-            str >> _textureVariableIndex;
-            _textureVariableIndex += 3; // 3 for xyz
-        }
-
-        if (line.substr(0, 8) == "texture ") {
-            std::stringstream str(line);
-
-            std::size_t found = line.find('-');
-
-            int textureIndex = 0;
-
-            std::string dummy;
-            str >> dummy; // command
-
-            if (found != std::string::npos) {
-                std::string option; // Not being used right now.
-                str >> option;
-            }
-
-            str >> textureIndex;
-            std::string fileName;
-            str >> fileName; // texture file name
-
-            std::string fullPath = absPath(_texturesPath + '/' + fileName);
-            std::string pngPath =
-                ghoul::filesystem::File(fullPath).fullBaseName() + ".png";
-
-            if (FileSys.fileExists(fullPath)) {
-                _textureFileMap.insert({ textureIndex, fullPath });
-
-            }
-            else if (FileSys.fileExists(pngPath)) {
-                _textureFileMap.insert({ textureIndex, pngPath });
-            }
-            else {
-                LWARNING(fmt::format("Could not find image file {}", fileName));
-                _textureFileMap.insert({ textureIndex, "" });
-            }
-        }
-    }
-
-    _nValuesPerAstronomicalObject += 3; // X Y Z are not counted in the Speck file indices
-
-    do {
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() -1);
-        }
-
-        if (line.empty()) {
-            std::getline(file, line);
-            continue;
-        }
-        else if (line[0] == '#') {
-            std::getline(file, line);
-            continue;
-        }
-
-        std::stringstream str(line);
-
-        glm::vec3 u(0.f);
-        glm::vec3 v(0.f);
-
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
-        for (int i = 0; i < _nValuesPerAstronomicalObject; ++i) {
-            str >> values[i];
-            if ((i >= _planeStartingIndexPos) &&
-                (i <= _planeStartingIndexPos + 6)) { // vectors u and v
-                int index = i - _planeStartingIndexPos;
-                switch (index) {
-                    case 0:
-                        u.x = values[i];
-                        break;
-                    case 1:
-                        u.y = values[i];
-                        break;
-                    case 2:
-                        u.z = values[i];
-                        break;
-                    case 3:
-                        v.x = values[i];
-                        break;
-                    case 4:
-                        v.y = values[i];
-                        break;
-                    case 5:
-                        v.z = values[i];
-                        break;
-                }
-            }
-        }
-        _fullData.insert(_fullData.end(), values.begin(), values.end());
-
-        // reads new line
-        std::getline(file, line);
-    } while (!file.eof());
-
-    return true;
-}
-
-bool RenderablePlanesCloud::readLabelFile() {
-    std::ifstream file(_labelFile);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Label file '{}'", _labelFile));
-        return false;
-    }
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() -1);
-        }
-
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        if (line.substr(0, 9) != "textcolor") {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
-            file.seekg(position);
-            continue;
-        }
-
-        if (line.substr(0, 9) == "textcolor") {
-            // textcolor lines are structured as follows:
-            // textcolor # description
-            // where # is color text defined in configuration file
-            std::stringstream str(line);
-
-            // TODO: handle cases of labels with different colors
-            break;
-        }
-    }
-
-    do {
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() -1);
-        }
-
-        if (line.empty()) {
-            continue;
-        }
-
-        std::stringstream str(line);
-
-        glm::vec3 position = glm::vec3(0.f);
-        for (int j = 0; j < 3; ++j) {
-            str >> position[j];
-        }
-
-        std::string dummy;
-        str >> dummy; // text keyword
-
-        std::string label;
-        str >> label;
-        dummy.clear();
-
-        while (str >> dummy) {
-            label += " " + dummy;
-            dummy.clear();
-        }
-
-        glm::vec3 transformedPos = glm::vec3(
-            _transformationMatrix * glm::dvec4(position, 1.0)
-        );
-        _labelData.emplace_back(std::make_pair(transformedPos, label));
-
-    } while (!file.eof());
-
-    return true;
-}
-
-bool RenderablePlanesCloud::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (fileStream.good()) {
-        int8_t version = 0;
-        fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-        if (version != CurrentCacheVersion) {
-            LINFO("The format of the cached file has changed: deleting old cache");
-            fileStream.close();
-            FileSys.deleteFile(file);
-            return false;
-        }
-
-        int32_t nValues = 0;
-        fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(
-            &_nValuesPerAstronomicalObject),
-            sizeof(int32_t)
-        );
-
-        _fullData.resize(nValues);
-        fileStream.read(reinterpret_cast<char*>(&_fullData[0]),
-            nValues * sizeof(_fullData[0]));
-
-        bool success = fileStream.good();
-        return success;
-    }
-    else {
-        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
-        return false;
-    }
-}
-
-bool RenderablePlanesCloud::saveCachedFile(const std::string& file) const {
-    std::ofstream fileStream(file, std::ofstream::binary);
-    if (fileStream.good()) {
-        fileStream.write(reinterpret_cast<const char*>(&CurrentCacheVersion),
-            sizeof(int8_t));
-
-        const int32_t nValues = static_cast<int32_t>(_fullData.size());
-        if (nValues == 0) {
-            LERROR("Error writing cache: No values were loaded");
-            return false;
-        }
-        fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
-
-        const int32_t nValuesPerAstronomicalObject = static_cast<int32_t>(
-            _nValuesPerAstronomicalObject
-        );
-        fileStream.write(reinterpret_cast<const char*>(
-            &nValuesPerAstronomicalObject),
-            sizeof(int32_t)
-        );
-
-        const size_t nBytes = nValues * sizeof(_fullData[0]);
-        fileStream.write(reinterpret_cast<const char*>(&_fullData[0]), nBytes);
-
-        bool success = fileStream.good();
-        return success;
-    }
-    else {
-        LERROR(fmt::format("Error opening file '{}' for save cache file", file));
-        return false;
-    }
-}
-
 void RenderablePlanesCloud::createPlanes() {
     if (_dataIsDirty && _hasSpeckFile) {
         LDEBUG("Creating planes...");
         float maxSize = 0.f;
-        for (size_t p = 0; p < _fullData.size(); p += _nValuesPerAstronomicalObject) {
+        const int lumIndex =
+            !_luminosityVar.empty() ? _dataset.index(_luminosityVar) : -1;
+        for (size_t p = 0; p < _dataset.nEntries(); ++p) {
             const glm::vec4 transformedPos = glm::vec4(
-                _transformationMatrix *
-                glm::dvec4(_fullData[p + 0], _fullData[p + 1], _fullData[p + 2], 1.0)
+                _transformationMatrix * glm::dvec4(_dataset.position(p), 1.0)
             );
 
             // Plane vectors u and v
             glm::vec4 u = glm::vec4(
                 _transformationMatrix *
                 glm::dvec4(
-                    _fullData[p + _planeStartingIndexPos + 0],
-                    _fullData[p + _planeStartingIndexPos + 1],
-                    _fullData[p + _planeStartingIndexPos + 2],
+                    _dataset.value(p, _planeStartingIndexPos + 0),
+                    _dataset.value(p, _planeStartingIndexPos + 1),
+                    _dataset.value(p, _planeStartingIndexPos + 2),
                     1.f
                 )
             );
@@ -1121,18 +769,17 @@ void RenderablePlanesCloud::createPlanes() {
             glm::vec4 v = glm::vec4(
                 _transformationMatrix *
                 glm::dvec4(
-                    _fullData[p + _planeStartingIndexPos + 3],
-                    _fullData[p + _planeStartingIndexPos + 4],
-                    _fullData[p + _planeStartingIndexPos + 5],
+                    _dataset.value(p, _planeStartingIndexPos + 3),
+                    _dataset.value(p, _planeStartingIndexPos + 4),
+                    _dataset.value(p, _planeStartingIndexPos + 5),
                     1.f
                 )
             );
             v /= 2.f;
             v.w = 0.f;
 
-            if (!_luminosityVar.empty()) {
-                float lumS = _fullData[p + _variableDataPositionMap[_luminosityVar]] *
-                             _sluminosity;
+            if (lumIndex >= 0) {
+                float lumS = _dataset.value(p, lumIndex) * _sluminosity;
                 u *= lumS;
                 v *= lumS;
             }
@@ -1192,7 +839,7 @@ void RenderablePlanesCloud::createPlanes() {
                 vertex1.x, vertex1.y, vertex1.z, 1.f, 1.f, 1.f,
             };
 
-            int textureIndex = static_cast<int>(_fullData[p + _textureVariableIndex]);
+            int textureIndex = static_cast<int>(_dataset.value(p, _textureVariableIndex));
             std::unordered_map<int, PlaneAggregate>::iterator found =
                 _planesMap.find(textureIndex);
             if (found != _planesMap.end()) {
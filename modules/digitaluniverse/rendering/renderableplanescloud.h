@@ -33,6 +33,7 @@
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/vector/vec2property.h>
 #include <openspace/properties/vector/vec3property.h>
+#include <openspace/util/speckloader.h>
 
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/opengl/uniformcache.h>
@@ -99,10 +100,6 @@ private:
 
     bool loadData();
     bool loadTextures();
-    bool readSpeckFile();
-    bool readLabelFile();
-    bool loadCachedFile(const std::string& file);
-    bool saveCachedFile(const std::string& file) const;
 
     bool _hasSpeckFile = false;
     bool _dataIsDirty = true;
@@ -143,11 +140,8 @@ private:
 
     Unit _unit = Parsec;
 
-    std::vector<float> _fullData;
+    speck::Dataset _dataset;
     std::vector<std::pair<glm::vec3, std::string>> _labelData;
-    std::unordered_map<std::string, int> _variableDataPositionMap;
-
-    int _nValuesPerAstronomicalObject = 0;
 
     float _sluminosity = 1.f;
 
@@ -30,7 +30,6 @@
 #include <openspace/engine/globals.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/util/updatestructures.h>
-#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/logging/logmanager.h>
@@ -54,7 +53,6 @@ namespace {
         "spriteTexture", "hasColorMap"
     };
 
-    constexpr int8_t CurrentCacheVersion = 1;
     constexpr double PARSEC = 0.308567756E17;
 
     constexpr openspace::properties::Property::PropertyInfo SpriteTextureInfo = {
@@ -197,7 +195,7 @@ RenderablePoints::RenderablePoints(const ghoul::Dictionary& dictionary)
 }
 
 bool RenderablePoints::isReady() const {
-    return (_program != nullptr) && (!_fullData.empty());
+    return (_program != nullptr) && (!_dataset.isEmpty());
 }
 
 void RenderablePoints::initialize() {
@@ -288,9 +286,7 @@ void RenderablePoints::render(const RenderData& data, RendererTasks&) {
 
     glEnable(GL_PROGRAM_POINT_SIZE);
     glBindVertexArray(_vao);
-    const GLsizei nAstronomicalObjects = static_cast<GLsizei>(
-        _fullData.size() / _nValuesPerAstronomicalObject
-    );
+    const GLsizei nAstronomicalObjects = static_cast<GLsizei>(_dataset.nEntries());
     glDrawArrays(GL_POINTS, 0, nAstronomicalObjects);
 
     glDisable(GL_PROGRAM_POINT_SIZE);
@@ -324,12 +320,6 @@ void RenderablePoints::update(const UpdateData&) {
         GLint positionAttrib = _program->attributeLocation("in_position");
 
         if (_hasColorMapFile) {
-
-            // const size_t nAstronomicalObjects = _fullData.size() /
-                                                        // _nValuesPerAstronomicalObject;
-            // const size_t nValues = _slicedData.size() / nAstronomicalObjects;
-            // GLsizei stride = static_cast<GLsizei>(sizeof(double) * nValues);
-
             glEnableVertexAttribArray(positionAttrib);
             glVertexAttribLPointer(
                 positionAttrib, 4, GL_DOUBLE, sizeof(double) * 8, nullptr
@@ -384,118 +374,21 @@ void RenderablePoints::update(const UpdateData&) {
 }
 
 bool RenderablePoints::loadData() {
-    std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        _speckFile,
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
-
-    bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format(
-            "Cached file '{}' used for Speck file '{}'",
-            cachedFile, _speckFile
-        ));
-
-        bool success = loadCachedFile(cachedFile);
-        if (success) {
-            if (_hasColorMapFile) {
-                success &= readColorMapFile();
-            }
-            return success;
-        }
-        else {
-            FileSys.cacheManager()->removeCacheFile(_speckFile);
-            // Intentional fall-through to the 'else' to generate the cache file for
-            // the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Speck file '{}' not found", _speckFile));
+    try {
+        _dataset = speck::loadSpeckFileCached(_speckFile, "RenderablePoints");
     }
-    LINFO(fmt::format("Loading Speck file '{}'", _speckFile));
-
-    bool success = readSpeckFile();
-    if (!success) {
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
         return false;
     }
 
-    LINFO("Saving cache");
-    success = saveCachedFile(cachedFile);
-
+    bool success = true;
     if (_hasColorMapFile) {
         success &= readColorMapFile();
     }
-
     return success;
 }
 
-bool RenderablePoints::readSpeckFile() {
-    std::ifstream file(_speckFile);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _speckFile));
-        return false;
-    }
-
-    _nValuesPerAstronomicalObject = 0;
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line);
-
-        if (line[0] == '#' || line.empty()) {
-            continue;
-        }
-
-        if (line.substr(0, 7) != "datavar" &&
-            line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture")
-        {
-            // we read a line that doesn't belong to the header, so we have to jump
-            // back before the beginning of the current line
-            file.seekg(position);
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly
-            // overwrite the 'nValues' variable with the latest index, we will end up
-            // with the total number of values (+3 since X Y Z are not counted in the
-            // Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy;
-            str >> _nValuesPerAstronomicalObject;
-            // We want the number, but the index is 0 based
-            _nValuesPerAstronomicalObject += 1;
-        }
-    }
-
-    // X Y Z are not counted in the Speck file indices
-    _nValuesPerAstronomicalObject += 3;
-
-    do {
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
-        std::getline(file, line);
-        std::stringstream str(line);
-
-        for (int i = 0; i < _nValuesPerAstronomicalObject; ++i) {
-            str >> values[i];
-        }
-
-        _fullData.insert(_fullData.end(), values.begin(), values.end());
-    } while (!file.eof());
-
-    return true;
-}
-
 bool RenderablePoints::readColorMapFile() {
     std::ifstream file(_colorMapFile);
     if (!file.good()) {
@@ -544,94 +437,18 @@ bool RenderablePoints::readColorMapFile() {
     return true;
 }
 
-bool RenderablePoints::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (fileStream.good()) {
-        int8_t version = 0;
-        fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-        if (version != CurrentCacheVersion) {
-            LINFO("The format of the cached file has changed: deleting old cache");
-            fileStream.close();
-            FileSys.deleteFile(file);
-            return false;
-        }
-
-        int32_t nValues = 0;
-        fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-        fileStream.read(
-            reinterpret_cast<char*>(&_nValuesPerAstronomicalObject),
-            sizeof(int32_t)
-        );
-
-        _fullData.resize(nValues);
-        fileStream.read(reinterpret_cast<char*>(
-            &_fullData[0]),
-            nValues * sizeof(_fullData[0])
-        );
-
-        const bool success = fileStream.good();
-        return success;
-    }
-    else {
-        LERROR(fmt::format(
-            "Error opening file '{}' for loading cache file",
-            file
-        ));
-        return false;
-    }
-}
-
-bool RenderablePoints::saveCachedFile(const std::string& file) const {
-    std::ofstream fileStream(file, std::ofstream::binary);
-    if (fileStream.good()) {
-        fileStream.write(
-            reinterpret_cast<const char*>(&CurrentCacheVersion),
-            sizeof(int8_t)
-        );
-
-        const int32_t nValues = static_cast<int32_t>(_fullData.size());
-        if (nValues == 0) {
-            LERROR("Error writing cache: No values were loaded");
-            return false;
-        }
-        fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
-
-        const int32_t nValuesPerAstronomicalObject = static_cast<int32_t>(
-            _nValuesPerAstronomicalObject
-        );
-        fileStream.write(
-            reinterpret_cast<const char*>(&nValuesPerAstronomicalObject),
-            sizeof(int32_t)
-        );
-
-        const size_t nBytes = nValues * sizeof(_fullData[0]);
-        fileStream.write(reinterpret_cast<const char*>(&_fullData[0]), nBytes);
-
-        const bool success = fileStream.good();
-        return success;
-    }
-    else {
-        LERROR(fmt::format("Error opening file '{}' for save cache file", file));
-        return false;
-    }
-}
-
 void RenderablePoints::createDataSlice() {
     _slicedData.clear();
     if (_hasColorMapFile) {
-        _slicedData.reserve(8 * (_fullData.size() / _nValuesPerAstronomicalObject));
+        _slicedData.reserve(8 * _dataset.nEntries());
     }
     else {
-        _slicedData.reserve(4 * (_fullData.size()/_nValuesPerAstronomicalObject));
+        _slicedData.reserve(4 * _dataset.nEntries());
     }
 
     int colorIndex = 0;
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerAstronomicalObject) {
-        glm::dvec3 p = glm::dvec3(
-            _fullData[i + 0],
-            _fullData[i + 1],
-            _fullData[i + 2]
-        );
+    for (size_t i = 0; i < _dataset.nEntries(); ++i) {
+        glm::dvec3 p = glm::dvec3(_dataset.position(i));
 
         // Converting untis
         if (_unit == Kilometer) {
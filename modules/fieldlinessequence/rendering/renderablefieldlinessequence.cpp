@@ -38,8 +38,9 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/opengl/textureunit.h>
+#include <algorithm>
 #include <fstream>
-#include <thread>
+#include <limits>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableFieldlinesSequence";
@@ -70,6 +71,11 @@ namespace {
     constexpr const char* KeyJsonScalingFactor = "ScaleToMeters";
     // [BOOLEAN] If value False => Load in initializing step and store in RAM
     constexpr const char* KeyOslfsLoadAtRuntime = "LoadAtRuntime";
+    // [INT] Number of states that are loaded ahead of and behind the active state when
+    // using LoadAtRuntime
+    constexpr const char* KeyOslfsPrefetchStates = "PrefetchStates";
+    // [INT] Memory budget in MB for the prefetched states when using LoadAtRuntime
+    constexpr const char* KeyOslfsPrefetchMemoryBudget = "PrefetchMemoryBudget";
 
     // ---------------------------- OPTIONAL MODFILE KEYS  ---------------------------- //
     // [STRING ARRAY] Values should be paths to .txt files
@@ -213,6 +219,18 @@ namespace {
         "Jump to Start Of Sequence",
         "Performs a time jump to the start of the sequence."
     };
+    constexpr openspace::properties::Property::PropertyInfo PrefetchHitsInfo = {
+        "prefetchHits",
+        "Prefetch Hits",
+        "The number of states that had already been loaded from disk at the time they "
+        "were needed. Only used when the states are loaded at runtime."
+    };
+    constexpr openspace::properties::Property::PropertyInfo PrefetchMissesInfo = {
+        "prefetchMisses",
+        "Prefetch Misses",
+        "The number of states that had to be loaded from disk at the time they were "
+        "needed. Only used when the states are loaded at runtime."
+    };
 
     enum class SourceFileType : int {
         Cdf = 0,
@@ -280,6 +298,8 @@ RenderableFieldlinesSequence::RenderableFieldlinesSequence(
     , _pMaskingQuantity(MaskingQuantityInfo, OptionProperty::DisplayType::Dropdown)
     , _pFocusOnOriginBtn(OriginButtonInfo)
     , _pJumpToStartBtn(TimeJumpButtonInfo)
+    , _pPrefetchHits(PrefetchHitsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _pPrefetchMisses(PrefetchMissesInfo, 0, 0, std::numeric_limits<int>::max())
 {
     _dictionary = std::make_unique<ghoul::Dictionary>(dictionary);
 }
@@ -594,6 +614,25 @@ bool RenderableFieldlinesSequence::prepareForOsflsStreaming() {
     _states.push_back(newState);
     _nStates = _startTimes.size();
     _activeStateIndex = 0;
+    _loadedStateIndex = 0;
+
+    _prefetcher = std::make_unique<FieldlinesPrefetcher>(
+        _nStates,
+        [this, files = _sourceFiles](size_t index, FieldlinesState& state) {
+            if (!state.loadStateFromOsfls(files[index])) {
+                return false;
+            }
+            // Memory mapped states are read lazily, so make sure that the parts that
+            // are rendered are read here instead of when they are uploaded
+            state.prefaultMappedData({
+                _prefetchColorQuantity.load(),
+                _prefetchMaskingQuantity.load()
+            });
+            return true;
+        },
+        _prefetchLookAhead,
+        _prefetchMemoryBudget
+    );
     return true;
 }
 
@@ -625,6 +664,16 @@ void RenderableFieldlinesSequence::extractOsflsInfoFromDictionary() {
             _identifier, KeyOslfsLoadAtRuntime
         ));
     }
+
+    if (_dictionary->hasValue<double>(KeyOslfsPrefetchStates)) {
+        _prefetchLookAhead = static_cast<size_t>(
+            std::max(_dictionary->value<double>(KeyOslfsPrefetchStates), 0.0)
+        );
+    }
+    if (_dictionary->hasValue<double>(KeyOslfsPrefetchMemoryBudget)) {
+        const double budget = _dictionary->value<double>(KeyOslfsPrefetchMemoryBudget);
+        _prefetchMemoryBudget = static_cast<size_t>(std::max(budget, 0.0)) * 1024 * 1024;
+    }
 }
 
 void RenderableFieldlinesSequence::setupProperties() {
@@ -639,6 +688,12 @@ void RenderableFieldlinesSequence::setupProperties() {
     }
     addProperty(_pFocusOnOriginBtn);
     addProperty(_pJumpToStartBtn);
+    if (_loadingStatesDynamically) {
+        _pPrefetchHits.setReadOnly(true);
+        addProperty(_pPrefetchHits);
+        _pPrefetchMisses.setReadOnly(true);
+        addProperty(_pPrefetchMisses);
+    }
 
     // ----------------------------- Add Property Groups ----------------------------- //
     addPropertySubOwner(_pColorGroup);
@@ -709,6 +764,7 @@ void RenderableFieldlinesSequence::definePropertyCallbackFunctions() {
     if (hasExtras) {
         _pColorQuantity.onChange([this] {
             _shouldUpdateColorBuffer = true;
+            _prefetchColorQuantity = static_cast<size_t>(_pColorQuantity.value());
             _pColorQuantityMin = std::to_string(_colorTableRanges[_pColorQuantity].x);
             _pColorQuantityMax = std::to_string(_colorTableRanges[_pColorQuantity].y);
             _pColorTablePath = _colorTablePaths[_pColorQuantity];
@@ -739,6 +795,7 @@ void RenderableFieldlinesSequence::definePropertyCallbackFunctions() {
 
         _pMaskingQuantity.onChange([this] {
             _shouldUpdateMaskingBuffer = true;
+            _prefetchMaskingQuantity = static_cast<size_t>(_pMaskingQuantity.value());
             _pMaskingMin = std::to_string(_maskingRanges[_pMaskingQuantity].x);
             _pMaskingMax = std::to_string(_maskingRanges[_pMaskingQuantity].y);
         });
@@ -1041,15 +1098,8 @@ void RenderableFieldlinesSequence::deinitializeGL() {
         _shaderProgram = nullptr;
     }
 
-    // Stall main thread until thread that's loading states is done!
-    bool printedWarning = false;
-    while (_isLoadingStateFromDisk) {
-        if (!printedWarning) {
-            LWARNING("Trying to destroy class when an active thread is still using it");
-            printedWarning = true;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
-    }
+    // Stall main thread until the state that is currently loading is done
+    _prefetcher = nullptr;
 }
 
 bool RenderableFieldlinesSequence::isReady() const {
@@ -1166,7 +1216,17 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
             updateActiveTriggerTimeIndex(currentTime);
 
             if (_loadingStatesDynamically) {
-                _mustLoadNewStateFromDisk = true;
+                if (_activeTriggerTimeIndex == _loadedStateIndex) {
+                    // We went back to the state that is already loaded
+                    _mustLoadNewStateFromDisk = false;
+                    _needsUpdate = true;
+                }
+                else {
+                    _mustLoadNewStateFromDisk = true;
+                    _prefetcher->request(_activeTriggerTimeIndex);
+                    _pPrefetchHits = static_cast<int>(_prefetcher->nHits());
+                    _pPrefetchMisses = static_cast<int>(_prefetcher->nMisses());
+                }
             }
             else {
                 _needsUpdate = true;
@@ -1182,22 +1242,20 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
     }
 
     if (_mustLoadNewStateFromDisk) {
-        if (!_isLoadingStateFromDisk && !_newStateIsReady) {
-            _isLoadingStateFromDisk    = true;
-            _mustLoadNewStateFromDisk  = false;
-            std::string filePath = _sourceFiles[_activeTriggerTimeIndex];
-            std::thread readBinaryThread([this, f = std::move(filePath)] {
-                readNewState(f);
-            });
-            readBinaryThread.detach();
+        std::optional<FieldlinesState> state =
+            _prefetcher->acquire(_activeTriggerTimeIndex);
+        if (state.has_value()) {
+            // Hand the previous state back so that it does not have to be loaded again
+            // if time is going backwards
+            _prefetcher->release(_loadedStateIndex, std::move(_states[0]));
+            _states[0] = std::move(*state);
+            _loadedStateIndex = _activeTriggerTimeIndex;
+            _mustLoadNewStateFromDisk = false;
+            _needsUpdate = true;
         }
     }
 
-    if (_needsUpdate || _newStateIsReady) {
-        if (_loadingStatesDynamically) {
-            _states[0] = std::move(*_newState);
-        }
-
+    if (_needsUpdate) {
         updateVertexPositionBuffer();
 
         if (_states[_activeStateIndex].nExtraQuantities() > 0) {
@@ -1207,7 +1265,6 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
 
         // Everything is set and ready for rendering!
         _needsUpdate = false;
-        _newStateIsReady = false;
     }
 
     if (_shouldUpdateColorBuffer) {
@@ -1239,15 +1296,6 @@ void RenderableFieldlinesSequence::updateActiveTriggerTimeIndex(double currentTi
     }
 }
 
-// Reading state from disk. Must be thread safe!
-void RenderableFieldlinesSequence::readNewState(const std::string& filePath) {
-    _newState = std::make_unique<FieldlinesState>();
-    if (_newState->loadStateFromOsfls(filePath)) {
-        _newStateIsReady = true;
-    }
-    _isLoadingStateFromDisk = false;
-}
-
 // Unbind buffers and arrays
 inline void unbindGL() {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1258,7 +1306,10 @@ void RenderableFieldlinesSequence::updateVertexPositionBuffer() {
     glBindVertexArray(_vertexArrayObject);
     glBindBuffer(GL_ARRAY_BUFFER, _vertexPositionBuffer);
 
-    const std::vector<glm::vec3>& vertPos = _states[_activeStateIndex].vertexPositions();
+    // Memory mapped states are uploaded directly from the mapping without an
+    // intermediate copy
+    const FieldlinesState::ArrayView<glm::vec3> vertPos =
+        _states[_activeStateIndex].vertexPositions();
 
     glBufferData(
         GL_ARRAY_BUFFER,
@@ -1278,10 +1329,8 @@ void RenderableFieldlinesSequence::updateVertexColorBuffer() {
     glBindBuffer(GL_ARRAY_BUFFER, _vertexColorBuffer);
 
     bool isSuccessful;
-    const std::vector<float>& quantities = _states[_activeStateIndex].extraQuantity(
-        _pColorQuantity,
-        isSuccessful
-    );
+    const FieldlinesState::ArrayView<float> quantities =
+        _states[_activeStateIndex].extraQuantity(_pColorQuantity, isSuccessful);
 
     if (isSuccessful) {
         glBufferData(
@@ -1303,10 +1352,8 @@ void RenderableFieldlinesSequence::updateVertexMaskingBuffer() {
     glBindBuffer(GL_ARRAY_BUFFER, _vertexMaskingBuffer);
 
     bool isSuccessful;
-    const std::vector<float>& maskings = _states[_activeStateIndex].extraQuantity(
-        _pMaskingQuantity,
-        isSuccessful
-    );
+    const FieldlinesState::ArrayView<float> maskings =
+        _states[_activeStateIndex].extraQuantity(_pMaskingQuantity, isSuccessful);
 
     if (isSuccessful) {
         glBufferData(
@@ -27,6 +27,7 @@
 
 #include <openspace/rendering/renderable.h>
 
+#include <modules/fieldlinessequence/util/fieldlinesprefetcher.h>
 #include <modules/fieldlinessequence/util/fieldlinesstate.h>
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/stringproperty.h>
@@ -65,21 +66,16 @@ private:
     std::string _identifier;                               // Name of the Node!
 
     // ------------------------------------- FLAGS -------------------------------------//
-    // Used for 'runtime-states'. True when loading a new state from disk on another
-    // thread.
-    std::atomic_bool _isLoadingStateFromDisk = false;
     // False => states are stored in RAM (using 'in-RAM-states'), True => states are
     // loaded from disk during runtime (using 'runtime-states')
     bool _loadingStatesDynamically  = false;
-    // Used for 'runtime-states': True if new 'runtime-state' must be loaded from disk.
-    // False => the previous frame's state should still be shown
+    // Used for 'runtime-states': True while waiting for the prefetcher to provide the
+    // state of the active trigger time. False => the previous frame's state should still
+    // be shown
     bool _mustLoadNewStateFromDisk  = false;
     // Used for 'in-RAM-states' : True if new 'in-RAM-state'  must be loaded.
     // False => the previous frame's state should still be shown
     bool _needsUpdate = false;
-    // Used for 'runtime-states'. True when finished loading a new state from disk on
-    // another thread.
-    std::atomic_bool _newStateIsReady = false;
     // True when new state is loaded or user change which quantity to color the lines by
     bool _shouldUpdateColorBuffer   = false;
     // True when new state is loaded or user change which quantity used for masking out
@@ -93,6 +89,19 @@ private:
     int _activeStateIndex = -1;
     // Active index of _startTimes
     int _activeTriggerTimeIndex = -1;
+    // Used for 'runtime-states'. Index of _startTimes that the state in _states[0]
+    // belongs to
+    int _loadedStateIndex = -1;
+    // Used for 'runtime-states'. Number of states that are prefetched ahead of and behind
+    // the active state
+    size_t _prefetchLookAhead = 2;
+    // Used for 'runtime-states'. Maximum number of bytes used by prefetched states
+    size_t _prefetchMemoryBudget = 512 * 1024 * 1024;
+    // Used for 'runtime-states'. The extra quantities used for coloring and masking are
+    // the only ones that are read from disk when prefetching. Atomic as they are read on
+    // the prefetcher's worker thread
+    std::atomic<size_t> _prefetchColorQuantity = 0;
+    std::atomic<size_t> _prefetchMaskingQuantity = 0;
     // Number of states in the sequence
     size_t _nStates = 0;
     // In setup it is used to scale JSON coordinates. During runtime it is used to scale
@@ -114,8 +123,8 @@ private:
     // ----------------------------------- POINTERS ------------------------------------//
     // The Lua-Modfile-Dictionary used during initialization
     std::unique_ptr<ghoul::Dictionary> _dictionary;
-    // Used for 'runtime-states' when switching out current state to a new state
-    std::unique_ptr<FieldlinesState> _newState;
+    // Used for 'runtime-states' to load states from disk ahead of time
+    std::unique_ptr<FieldlinesPrefetcher> _prefetcher;
     std::unique_ptr<ghoul::opengl::ProgramObject> _shaderProgram;
     // Transfer function used to color lines when _pColorMethod is set to BY_QUANTITY
     std::unique_ptr<TransferFunction> _transferFunction;
@@ -196,6 +205,10 @@ private:
     properties::TriggerProperty _pFocusOnOriginBtn;
     // Button which executes a time jump to start of sequence
     properties::TriggerProperty _pJumpToStartBtn;
+    // Number of 'runtime-states' that were already prefetched when they were needed
+    properties::IntProperty _pPrefetchHits;
+    // Number of 'runtime-states' that had to be loaded when they were needed
+    properties::IntProperty _pPrefetchMisses;
 
     // --------------------- FUNCTIONS USED DURING INITIALIZATION --------------------- //
     void addStateToSequence(FieldlinesState& STATE);
@@ -220,7 +233,6 @@ private:
     bool prepareForOsflsStreaming();
 
     // ------------------------- FUNCTIONS USED DURING RUNTIME ------------------------ //
-    void readNewState(const std::string& filePath);
     void updateActiveTriggerTimeIndex(double currentTime);
     void updateVertexPositionBuffer();
     void updateVertexColorBuffer();
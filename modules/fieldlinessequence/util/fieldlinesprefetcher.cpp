@@ -0,0 +1,256 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/fieldlinessequence/util/fieldlinesprefetcher.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+
+namespace openspace {
+
+FieldlinesPrefetcher::FieldlinesPrefetcher(size_t nStates, Loader loader,
+                                           size_t lookAhead, size_t memoryBudget)
+    : _nStates(nStates)
+    , _loader(std::move(loader))
+    , _lookAhead(lookAhead)
+    , _memoryBudget(memoryBudget)
+{
+    ghoul_assert(_loader, "Loader must not be empty");
+
+    _worker = std::thread([this]() { workerLoop(); });
+}
+
+FieldlinesPrefetcher::~FieldlinesPrefetcher() {
+    {
+        std::lock_guard lock(_mutex);
+        _shouldStop = true;
+        _scheduled.clear();
+    }
+    _workAvailable.notify_all();
+    _worker.join();
+}
+
+void FieldlinesPrefetcher::request(size_t index) {
+    ghoul_assert(index < _nStates, "Index out of range");
+
+    {
+        std::lock_guard lock(_mutex);
+        if (index != _activeIndex) {
+            _isPlayingForward = index > _activeIndex;
+        }
+        _activeIndex = index;
+
+        const bool isAvailable = _cache.find(index) != _cache.end() ||
+                                 _acquiredIndex == index;
+        if (isAvailable) {
+            ++_nHits;
+        }
+        else {
+            ++_nMisses;
+        }
+
+        // Anything that was scheduled for the previous active state and has not been
+        // started yet is stale now
+        schedule();
+    }
+    _workAvailable.notify_one();
+}
+
+std::optional<FieldlinesState> FieldlinesPrefetcher::acquire(size_t index) {
+    std::lock_guard lock(_mutex);
+    auto it = _cache.find(index);
+    if (it == _cache.end()) {
+        return std::nullopt;
+    }
+
+    FieldlinesState state = std::move(it->second.state);
+    _cachedBytes -= it->second.bytes;
+    _cache.erase(it);
+    _acquiredIndex = index;
+    return state;
+}
+
+void FieldlinesPrefetcher::release(size_t index, FieldlinesState state) {
+    ghoul_assert(index < _nStates, "Index out of range");
+
+    std::lock_guard lock(_mutex);
+    if (_acquiredIndex == index) {
+        _acquiredIndex = std::nullopt;
+    }
+    insert(index, std::move(state));
+}
+
+void FieldlinesPrefetcher::waitUntilIdle() {
+    std::unique_lock lock(_mutex);
+    _idle.wait(lock, [this]() { return _scheduled.empty() && !_loadingIndex; });
+}
+
+size_t FieldlinesPrefetcher::nHits() const {
+    return _nHits;
+}
+
+size_t FieldlinesPrefetcher::nMisses() const {
+    return _nMisses;
+}
+
+size_t FieldlinesPrefetcher::cachedBytes() const {
+    std::lock_guard lock(_mutex);
+    return _cachedBytes;
+}
+
+size_t FieldlinesPrefetcher::memoryFootprint(const FieldlinesState& state) {
+    size_t bytes = sizeof(FieldlinesState);
+    bytes += state.vertexPositions().size() * sizeof(glm::vec3);
+    bytes += state.lineCount().size() * sizeof(GLsizei);
+    bytes += state.lineStart().size() * sizeof(GLint);
+    for (size_t i = 0; i < state.nExtraQuantities(); ++i) {
+        bool isSuccessful;
+        bytes += state.extraQuantity(i, isSuccessful).size() * sizeof(float);
+    }
+    for (const std::string& name : state.extraQuantityNames()) {
+        bytes += name.size();
+    }
+    return bytes;
+}
+
+void FieldlinesPrefetcher::workerLoop() {
+    while (true) {
+        size_t index = 0;
+        {
+            std::unique_lock lock(_mutex);
+            _workAvailable.wait(
+                lock,
+                [this]() { return _shouldStop || !_scheduled.empty(); }
+            );
+            if (_shouldStop) {
+                break;
+            }
+
+            index = _scheduled.front();
+            _scheduled.erase(_scheduled.begin());
+            _loadingIndex = index;
+        }
+
+        FieldlinesState state;
+        const bool success = _loader(index, state);
+
+        {
+            std::lock_guard lock(_mutex);
+            _loadingIndex = std::nullopt;
+            // If the time jumped while we were loading, the state might not be needed
+            // anymore, or it might have been handed back to us in the meantime
+            const bool isNeeded = isInWindow(index) && _acquiredIndex != index &&
+                                  _cache.find(index) == _cache.end();
+            if (success && isNeeded) {
+                insert(index, std::move(state));
+            }
+            if (_scheduled.empty()) {
+                _idle.notify_all();
+            }
+        }
+    }
+
+    std::lock_guard lock(_mutex);
+    _loadingIndex = std::nullopt;
+    _idle.notify_all();
+}
+
+void FieldlinesPrefetcher::schedule() {
+    _scheduled.clear();
+
+    auto scheduleIndex = [this](size_t index) {
+        const bool isLoaded = _cache.find(index) != _cache.end() ||
+                              _acquiredIndex == index || _loadingIndex == index;
+        if (!isLoaded) {
+            _scheduled.push_back(index);
+        }
+    };
+
+    scheduleIndex(_activeIndex);
+
+    // States in the direction of playback are needed first
+    for (size_t i = 1; i <= _lookAhead; ++i) {
+        if (_isPlayingForward && _activeIndex + i < _nStates) {
+            scheduleIndex(_activeIndex + i);
+        }
+        else if (!_isPlayingForward && _activeIndex >= i) {
+            scheduleIndex(_activeIndex - i);
+        }
+    }
+    for (size_t i = 1; i <= _lookAhead; ++i) {
+        if (_isPlayingForward && _activeIndex >= i) {
+            scheduleIndex(_activeIndex - i);
+        }
+        else if (!_isPlayingForward && _activeIndex + i < _nStates) {
+            scheduleIndex(_activeIndex + i);
+        }
+    }
+}
+
+bool FieldlinesPrefetcher::isInWindow(size_t index) const {
+    return distanceToActive(index) <= _lookAhead;
+}
+
+size_t FieldlinesPrefetcher::distanceToActive(size_t index) const {
+    return index > _activeIndex ? index - _activeIndex : _activeIndex - index;
+}
+
+void FieldlinesPrefetcher::insert(size_t index, FieldlinesState state) {
+    auto existing = _cache.find(index);
+    if (existing != _cache.end()) {
+        _cachedBytes -= existing->second.bytes;
+        _cache.erase(existing);
+    }
+
+    const size_t bytes = memoryFootprint(state);
+    _cache[index] = CacheEntry{ std::move(state), bytes };
+    _cachedBytes += bytes;
+
+    // Drop the states that are furthest away from the active state until we are within
+    // the budget again, preferring the ones behind the playback direction if they are
+    // equally far away. The active state itself is never dropped as it would otherwise
+    // never become available if it does not fit into the budget on its own
+    while (_cachedBytes > _memoryBudget) {
+        auto furthest = _cache.end();
+        size_t furthestRank = 0;
+        for (auto it = _cache.begin(); it != _cache.end(); ++it) {
+            if (it->first == _activeIndex) {
+                continue;
+            }
+            const bool isAhead = _isPlayingForward == (it->first > _activeIndex);
+            const size_t rank = 2 * distanceToActive(it->first) + (isAhead ? 0 : 1);
+            if (rank > furthestRank) {
+                furthest = it;
+                furthestRank = rank;
+            }
+        }
+        if (furthest == _cache.end()) {
+            break;
+        }
+        _cachedBytes -= furthest->second.bytes;
+        _cache.erase(furthest);
+    }
+}
+
+} // namespace openspace
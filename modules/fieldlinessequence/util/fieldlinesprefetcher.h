@@ -0,0 +1,148 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_FIELDLINESSEQUENCE___FIELDLINESPREFETCHER___H__
+#define __OPENSPACE_MODULE_FIELDLINESSEQUENCE___FIELDLINESPREFETCHER___H__
+
+#include <modules/fieldlinessequence/util/fieldlinesstate.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Loads the states of a streamed fieldlines sequence ahead of time on a single, fixed
+ * worker thread. Whenever the active state changes, #request is called with the new index
+ * and the prefetcher schedules the requested state, followed by the next and previous
+ * \c lookAhead states (the states in the current playback direction first). Decoded
+ * states are kept in a cache whose total size is limited by a memory budget; when the
+ * budget is exceeded, the states furthest away from the active state are dropped first.
+ *
+ * A new request replaces all scheduled loads that have not been started yet, so a time
+ * jump cancels the stale requests from before the jump. A load that is already running
+ * when the jump happens is finished, but its result is discarded if the state is no
+ * longer within the look-ahead window.
+ */
+class FieldlinesPrefetcher {
+public:
+    /**
+     * The function that is used to load the state with the provided index into the
+     * provided state. Returns \c false if the state could not be loaded. The loader is
+     * only ever called from the worker thread.
+     */
+    using Loader = std::function<bool(size_t index, FieldlinesState& state)>;
+
+    /**
+     * Creates the prefetcher and starts its worker thread.
+     *
+     * \param nStates The number of states in the sequence
+     * \param loader The function that is used to load individual states
+     * \param lookAhead The number of states that are loaded ahead of and behind the
+     *        active state
+     * \param memoryBudget The maximum number of bytes used by the cached states
+     */
+    FieldlinesPrefetcher(size_t nStates, Loader loader, size_t lookAhead,
+        size_t memoryBudget);
+
+    /// Cancels all scheduled loads and joins the worker thread
+    ~FieldlinesPrefetcher();
+
+    /**
+     * Informs the prefetcher that the state with the provided \p index is now the active
+     * state. If that state is already cached, this counts as a hit, otherwise as a miss
+     * and the state is scheduled to be loaded before any other state.
+     */
+    void request(size_t index);
+
+    /**
+     * Removes the state with the provided \p index from the cache and returns it. If the
+     * state has not been loaded yet, \c std::nullopt is returned.
+     */
+    std::optional<FieldlinesState> acquire(size_t index);
+
+    /**
+     * Hands a state that was previously returned by #acquire back to the prefetcher so
+     * that it can be reused without being loaded again if playback turns around.
+     */
+    void release(size_t index, FieldlinesState state);
+
+    /// Blocks until there are no more scheduled or running loads
+    void waitUntilIdle();
+
+    /// Returns the number of requests for which the state had already been loaded
+    size_t nHits() const;
+
+    /// Returns the number of requests for which the state had to be loaded on demand
+    size_t nMisses() const;
+
+    /// Returns the number of bytes that are currently used by the cached states
+    size_t cachedBytes() const;
+
+    /// Returns the estimated number of bytes that are used by the provided \p state
+    static size_t memoryFootprint(const FieldlinesState& state);
+
+private:
+    struct CacheEntry {
+        FieldlinesState state;
+        size_t bytes = 0;
+    };
+
+    void workerLoop();
+    void schedule();
+    bool isInWindow(size_t index) const;
+    size_t distanceToActive(size_t index) const;
+    void insert(size_t index, FieldlinesState state);
+
+    const size_t _nStates;
+    const Loader _loader;
+    const size_t _lookAhead;
+    const size_t _memoryBudget;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _idle;
+    std::vector<size_t> _scheduled;
+    std::map<size_t, CacheEntry> _cache;
+    size_t _cachedBytes = 0;
+    size_t _activeIndex = 0;
+    bool _isPlayingForward = true;
+    std::optional<size_t> _loadingIndex;
+    std::optional<size_t> _acquiredIndex;
+    bool _shouldStop = false;
+
+    std::atomic<size_t> _nHits = 0;
+    std::atomic<size_t> _nMisses = 0;
+
+    std::thread _worker;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_FIELDLINESSEQUENCE___FIELDLINESPREFETCHER___H__
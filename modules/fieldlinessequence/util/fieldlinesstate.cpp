@@ -25,16 +25,96 @@
 #include <modules/fieldlinessequence/util/fieldlinesstate.h>
 
 #include <openspace/json.h>
+#include <openspace/util/mappedfile.h>
 #include <openspace/util/time.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <array>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 
 namespace {
     constexpr const char* _loggerCat = "FieldlinesState";
-    constexpr const int CurrentVersion = 0;
+    constexpr const int CurrentVersion = 1;
     using json = nlohmann::json;
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+    static_assert(sizeof(GLint) == sizeof(int32_t));
+    static_assert(sizeof(GLsizei) == sizeof(int32_t));
+
+    // All arrays in a version 1 file start at a multiple of this many bytes so that they
+    // can be used directly from a memory mapping of the file
+    constexpr const size_t Alignment = 64;
+
+    // Offsets of the values in the header of a version 1 file
+    constexpr const size_t HeaderVersion = 0;
+    constexpr const size_t HeaderModel = 4;
+    constexpr const size_t HeaderTriggerTime = 8;
+    constexpr const size_t HeaderNLines = 16;
+    constexpr const size_t HeaderNPoints = 24;
+    constexpr const size_t HeaderNExtras = 32;
+    constexpr const size_t HeaderNNameBytes = 40;
+    constexpr const size_t HeaderIsMorphable = 48;
+    constexpr const size_t HeaderSize = 64;
+
+    struct FileLayout {
+        size_t names = 0;
+        size_t lineStart = 0;
+        size_t lineCount = 0;
+        size_t vertexPositions = 0;
+        std::vector<size_t> extraQuantities;
+        size_t fileSize = 0;
+    };
+
+    FileLayout computeFileLayout(size_t nLines, size_t nPoints, size_t nExtras,
+                                 size_t nNameBytes)
+    {
+        FileLayout layout;
+        size_t end = HeaderSize;
+        auto next = [&end](size_t size) {
+            const size_t offset = (end + Alignment - 1) / Alignment * Alignment;
+            end = offset + size;
+            return offset;
+        };
+
+        layout.names = next(nNameBytes);
+        layout.lineStart = next(nLines * sizeof(int32_t));
+        layout.lineCount = next(nLines * sizeof(int32_t));
+        layout.vertexPositions = next(nPoints * 3 * sizeof(float));
+        layout.extraQuantities.reserve(nExtras);
+        for (size_t i = 0; i < nExtras; ++i) {
+            layout.extraQuantities.push_back(next(nPoints * sizeof(float)));
+        }
+        layout.fileSize = end;
+        return layout;
+    }
+
+    template <typename T>
+    openspace::FieldlinesState::ArrayView<T> mappedView(const openspace::MappedFile& file,
+                                                        size_t offset, size_t size)
+    {
+        return openspace::FieldlinesState::ArrayView<T>(
+            reinterpret_cast<const T*>(file.data() + offset),
+            size
+        );
+    }
+
+    std::vector<std::string> splitNames(const char* data, size_t nBytes, size_t nNames) {
+        // The names are stored as consecutive null-terminated strings
+        std::vector<std::string> names;
+        names.reserve(nNames);
+        size_t offset = 0;
+        for (size_t i = 0; i < nNames && offset < nBytes; ++i) {
+            const size_t length = strnlen(data + offset, nBytes - offset);
+            names.emplace_back(data + offset, length);
+            offset += length + 1;
+        }
+        names.resize(nNames);
+        return names;
+    }
 } // namespace
 
 namespace openspace {
@@ -45,6 +125,7 @@ namespace openspace {
  * expected to be in degrees. scale is an optional scaling factor.
  */
 void FieldlinesState::convertLatLonToCartesian(float scale) {
+    makeOwned();
     for (glm::vec3& p : _vertexPositions) {
         const float r = p.x * scale;
         const float lat = glm::radians(p.y);
@@ -56,6 +137,7 @@ void FieldlinesState::convertLatLonToCartesian(float scale) {
 }
 
 void FieldlinesState::scalePositions(float scale) {
+    makeOwned();
     for (glm::vec3& p : _vertexPositions) {
         p *= scale;
     }
@@ -73,13 +155,19 @@ bool FieldlinesState::loadStateFromOsfls(const std::string& pathToOsflsFile) {
 
     switch (binFileVersion) {
         case 0:
-            // No need to put everything in this scope now, as only version 0 exists!
+            // Version 0 is read into memory in the rest of this function
             break;
+        case 1:
+            ifs.close();
+            return loadMappedStateFromOsfls(pathToOsflsFile);
         default:
             LERROR("VERSION OF BINARY FILE WAS NOT RECOGNIZED!");
             return false;
     }
 
+    _mappedFile = nullptr;
+    _mappedLayout = MappedLayout();
+
     // Define tmp variables to store meta data in
     size_t nLines;
     size_t nPoints;
@@ -116,20 +204,82 @@ bool FieldlinesState::loadStateFromOsfls(const std::string& pathToOsflsFile) {
     }
 
     // Read all extra quantities' names. Stored as multiple c-strings
-    std::string allNamesInOne;
     std::vector<char> buffer(byteSizeAllNames);
     ifs.read(buffer.data(), byteSizeAllNames);
-    allNamesInOne.assign(buffer.data(), byteSizeAllNames);
+    _extraQuantityNames = splitNames(buffer.data(), byteSizeAllNames, nExtras);
 
-    size_t offset = 0;
-    for (size_t i = 0; i < nExtras; ++i) {
-        auto endOfVarName = allNamesInOne.find('\0', offset);
-        endOfVarName -= offset;
-        const std::string varName = allNamesInOne.substr(offset, endOfVarName);
-        offset += varName.size() + 1;
-        _extraQuantityNames[i] = varName;
+    return true;
+}
+
+bool FieldlinesState::loadMappedStateFromOsfls(const std::string& pathToOsflsFile) {
+    std::shared_ptr<MappedFile> file;
+    try {
+        file = std::make_shared<MappedFile>(pathToOsflsFile);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
+        return false;
+    }
+
+    if (file->size() < HeaderSize) {
+        LERROR(fmt::format("File '{}' is too small to be a state", pathToOsflsFile));
+        return false;
+    }
+
+    const std::byte* data = file->data();
+    auto read = [data](size_t offset, auto& value) {
+        std::memcpy(&value, data + offset, sizeof(value));
+    };
+
+    int32_t model;
+    double triggerTime;
+    uint64_t nLines;
+    uint64_t nPoints;
+    uint64_t nExtras;
+    uint64_t nNameBytes;
+    uint8_t isMorphable;
+    read(HeaderModel, model);
+    read(HeaderTriggerTime, triggerTime);
+    read(HeaderNLines, nLines);
+    read(HeaderNPoints, nPoints);
+    read(HeaderNExtras, nExtras);
+    read(HeaderNNameBytes, nNameBytes);
+    read(HeaderIsMorphable, isMorphable);
+
+    // Check the sizes individually first so that a corrupt header can't overflow the
+    // computation of the file layout
+    const size_t size = file->size();
+    if (nLines > size || nPoints > size || nExtras > size || nNameBytes > size) {
+        LERROR(fmt::format("File '{}' is corrupt", pathToOsflsFile));
+        return false;
+    }
+    FileLayout layout = computeFileLayout(nLines, nPoints, nExtras, nNameBytes);
+    if (layout.fileSize != size) {
+        LERROR(fmt::format("File '{}' is corrupt", pathToOsflsFile));
+        return false;
     }
 
+    _triggerTime = triggerTime;
+    _model = static_cast<fls::Model>(model);
+    _isMorphable = isMorphable != 0;
+    _extraQuantityNames = splitNames(
+        reinterpret_cast<const char*>(data + layout.names),
+        nNameBytes,
+        nExtras
+    );
+
+    _lineStart = std::vector<GLint>();
+    _lineCount = std::vector<GLsizei>();
+    _vertexPositions = std::vector<glm::vec3>();
+    _extraQuantities = std::vector<std::vector<float>>();
+
+    _mappedLayout.nLines = nLines;
+    _mappedLayout.nPoints = nPoints;
+    _mappedLayout.lineStart = layout.lineStart;
+    _mappedLayout.lineCount = layout.lineCount;
+    _mappedLayout.vertexPositions = layout.vertexPositions;
+    _mappedLayout.extraQuantities = std::move(layout.extraQuantities);
+    _mappedFile = std::move(file);
     return true;
 }
 
@@ -218,30 +368,9 @@ bool FieldlinesState::loadStateFromJson(const std::string& pathToJsonFile,
 }
 
 /**
- * \param absPath must be the path to the file (incl. filename but excl. extension!)
+ * \param absPath must be the path to the folder in which the file should be created. The
+ * name of the file is derived from the trigger time of the state.
  * Directory must exist! File is created (or overwritten if already existing).
- * File is structured like this: (for version 0)
- *  0. int                    - version number of binary state file! (in case something
- *                              needs to be altered in the future, then increase
- *                              CurrentVersion)
- *  1. double                 - _triggerTime
- *  2. int                    - _model
- *  3. bool                   - _isMorphable
- *  4. size_t                 - Number of lines in the state  == _lineStart.size()
- *                                                            == _lineCount.size()
- *  5. size_t                 - Total number of vertex points == _vertexPositions.size()
- *                                                           == _extraQuantities[i].size()
- *  6. size_t                 - Number of extra quantites     == _extraQuantities.size()
- *                                                           == _extraQuantityNames.size()
- *  7. site_t                 - Number of total bytes that ALL _extraQuantityNames
- *                              consists of (Each such name is stored as a c_str which
- *                              means it ends with the null char '\0' )
- *  7. std::vector<GLint>     - _lineStart
- *  8. std::vector<GLsizei>   - _lineCount
- *  9. std::vector<glm::vec3> - _vertexPositions
- * 10. std::vector<float>     - _extraQuantities
- * 11. array of c_str         - Strings naming the extra quantities (elements of
- *                              _extraQuantityNames). Each string ends with null char '\0'
  */
 void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
     // ------------------------------- Create the file ------------------------------- //
@@ -251,12 +380,45 @@ void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
     pathSafeTimeString.replace(19, 1, "-");
     const std::string& fileName = pathSafeTimeString + ".osfls";
 
-    std::ofstream ofs(absPath + fileName, std::ofstream::binary | std::ofstream::trunc);
+    writeOsflsFile(absPath + fileName);
+}
+
+/**
+ * File is structured like this: (for version 1)
+ * All offsets are given in bytes. Every array starts at the next multiple of 64 bytes
+ * after the end of the previous one; the gaps are filled with zeros.
+ *  0. int32                  - version number of binary state file! (in case something
+ *                              needs to be altered in the future, then increase
+ *                              CurrentVersion)
+ *  4. int32                  - _model
+ *  8. double                 - _triggerTime
+ * 16. uint64                 - Number of lines in the state  == _lineStart.size()
+ *                                                            == _lineCount.size()
+ * 24. uint64                 - Total number of vertex points == _vertexPositions.size()
+ *                                                           == _extraQuantities[i].size()
+ * 32. uint64                 - Number of extra quantites     == _extraQuantities.size()
+ *                                                           == _extraQuantityNames.size()
+ * 40. uint64                 - Number of total bytes that ALL _extraQuantityNames
+ *                              consists of (Each such name is stored as a c_str which
+ *                              means it ends with the null char '\0' )
+ * 48. uint8                  - _isMorphable
+ * 64. array of c_str         - Strings naming the extra quantities (elements of
+ *                              _extraQuantityNames). Each string ends with null char '\0'
+ *  -  std::vector<GLint>     - _lineStart
+ *  -  std::vector<GLsizei>   - _lineCount
+ *  -  std::vector<glm::vec3> - _vertexPositions
+ *  -  std::vector<float>     - _extraQuantities, one array after the other
+ *
+ * Version 0 files store the same information without any alignment in this order:
+ * version, _triggerTime, _model, _isMorphable, number of lines, number of points, number
+ * of extra quantities, number of bytes of the names, _lineStart, _lineCount,
+ * _vertexPositions, _extraQuantities, and the names of the extra quantities.
+ */
+bool FieldlinesState::writeOsflsFile(const std::string& filePath) const {
+    std::ofstream ofs(filePath, std::ofstream::binary | std::ofstream::trunc);
     if (!ofs.is_open()) {
-        LERROR(fmt::format(
-            "Failed to save state to binary file: {}{}", absPath, fileName
-        ));
-        return;
+        LERROR(fmt::format("Failed to save state to binary file: {}", filePath));
+        return false;
     }
 
     // --------- Add each string of _extraQuantityNames into one long string --------- //
@@ -265,37 +427,57 @@ void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
         allExtraQuantityNamesInOne += str + '\0'; // Add null char '\0' for easier reading
     }
 
-    const size_t nLines = _lineStart.size();
-    const size_t nPoints = _vertexPositions.size();
-    const size_t nExtras = _extraQuantities.size();
-    const size_t nStringBytes = allExtraQuantityNamesInOne.size();
-
-    //----------------------------- WRITE EVERYTHING TO FILE -----------------------------
-    // VERSION OF BINARY FIELDLINES STATE FILE - IN CASE STRUCTURE CHANGES IN THE FUTURE
-    ofs.write(reinterpret_cast<const char*>(&CurrentVersion), sizeof(int));
+    const ArrayView<GLint> lineStarts = lineStart();
+    const ArrayView<GLsizei> lineCounts = lineCount();
+    const ArrayView<glm::vec3> positions = vertexPositions();
+    const uint64_t nLines = lineStarts.size();
+    const uint64_t nPoints = positions.size();
+    const uint64_t nExtras = nExtraQuantities();
+    const uint64_t nStringBytes = allExtraQuantityNamesInOne.size();
+    const FileLayout layout = computeFileLayout(nLines, nPoints, nExtras, nStringBytes);
 
     //-------------------- WRITE META DATA FOR STATE --------------------------------
-    ofs.write(reinterpret_cast<const char*>(&_triggerTime), sizeof(_triggerTime));
-    ofs.write(reinterpret_cast<const char*>(&_model), sizeof(int32_t));
-    ofs.write(reinterpret_cast<const char*>(&_isMorphable), sizeof(bool));
-
-    ofs.write(reinterpret_cast<const char*>(&nLines), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nPoints), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nExtras), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nStringBytes), sizeof(uint64_t));
+    std::array<char, HeaderSize> header = {};
+    auto write = [&header](size_t offset, const auto& value) {
+        std::memcpy(header.data() + offset, &value, sizeof(value));
+    };
+    write(HeaderVersion, static_cast<int32_t>(CurrentVersion));
+    write(HeaderModel, static_cast<int32_t>(_model));
+    write(HeaderTriggerTime, _triggerTime);
+    write(HeaderNLines, nLines);
+    write(HeaderNPoints, nPoints);
+    write(HeaderNExtras, nExtras);
+    write(HeaderNNameBytes, nStringBytes);
+    write(HeaderIsMorphable, static_cast<uint8_t>(_isMorphable));
+    ofs.write(header.data(), header.size());
 
     //---------------------- WRITE ALL ARRAYS OF DATA --------------------------------
-    ofs.write(reinterpret_cast<char*>(_lineStart.data()), sizeof(int32_t) * nLines);
-    ofs.write(reinterpret_cast<char*>(_lineCount.data()), sizeof(uint32_t) * nLines);
-    ofs.write(
-        reinterpret_cast<char*>(_vertexPositions.data()),
-        3 * sizeof(float) * nPoints
-    );
-    // Write the data for each vector in _extraQuantities
-    for (std::vector<float>& vec : _extraQuantities) {
-        ofs.write(reinterpret_cast<char*>(vec.data()), sizeof(float) * nPoints);
+    size_t position = HeaderSize;
+    auto writeArray = [&ofs, &position](size_t offset, const void* data, size_t size) {
+        ghoul_assert(offset >= position, "Arrays must be written in order");
+        ghoul_assert(offset - position < Alignment, "Padding must be within alignment");
+        constexpr const std::array<char, Alignment> Padding = {};
+        ofs.write(Padding.data(), offset - position);
+        ofs.write(reinterpret_cast<const char*>(data), size);
+        position = offset + size;
+    };
+    writeArray(layout.names, allExtraQuantityNamesInOne.data(), nStringBytes);
+    writeArray(layout.lineStart, lineStarts.data(), sizeof(int32_t) * nLines);
+    writeArray(layout.lineCount, lineCounts.data(), sizeof(int32_t) * nLines);
+    writeArray(layout.vertexPositions, positions.data(), 3 * sizeof(float) * nPoints);
+    // Write the data for each extra quantity
+    for (size_t i = 0; i < nExtras; ++i) {
+        bool isSuccessful;
+        const ArrayView<float> quantity = extraQuantity(i, isSuccessful);
+        ghoul_assert(quantity.size() == nPoints, "Extra quantity must match vertices");
+        writeArray(layout.extraQuantities[i], quantity.data(), sizeof(float) * nPoints);
+    }
+
+    if (!ofs.good()) {
+        LERROR(fmt::format("Failed to save state to binary file: {}", filePath));
+        return false;
     }
-    ofs.write(allExtraQuantityNamesInOne.c_str(), nStringBytes);
+    return true;
 }
 
 // TODO: This should probably be rewritten, but this is the way the files were structured
@@ -342,19 +524,25 @@ void FieldlinesState::saveStateToJson(const std::string& absPath) {
     json jFile;
 
     std::string_view timeStr = Time(_triggerTime).ISO8601();
-    const size_t nLines = _lineStart.size();
-    // const size_t nPoints      = _vertexPositions.size();
-    const size_t nExtras = _extraQuantities.size();
+    const ArrayView<GLsizei> lineCounts = lineCount();
+    const ArrayView<glm::vec3> positions = vertexPositions();
+    const size_t nLines = lineCounts.size();
+    const size_t nExtras = nExtraQuantities();
+    std::vector<ArrayView<float>> extras(nExtras);
+    for (size_t extraIndex = 0; extraIndex < nExtras; ++extraIndex) {
+        bool isSuccessful;
+        extras[extraIndex] = extraQuantity(extraIndex, isSuccessful);
+    }
 
     size_t pointIndex = 0;
     for (size_t lineIndex = 0; lineIndex < nLines; ++lineIndex) {
         json jData = json::array();
-        for (GLsizei i = 0; i < _lineCount[lineIndex]; i++, ++pointIndex) {
-            const glm::vec3 pos = _vertexPositions[pointIndex];
+        for (GLsizei i = 0; i < lineCounts[lineIndex]; i++, ++pointIndex) {
+            const glm::vec3 pos = positions[pointIndex];
             json jDataElement = { pos.x, pos.y, pos.z };
 
             for (size_t extraIndex = 0; extraIndex < nExtras; ++extraIndex) {
-                jDataElement.push_back(_extraQuantities[extraIndex][pointIndex]);
+                jDataElement.push_back(extras[extraIndex][pointIndex]);
             }
             jData.push_back(jDataElement);
         }
@@ -383,13 +571,22 @@ void FieldlinesState::setTriggerTime(double t) {
     _triggerTime = t;
 }
 
-// Returns one of the extra quantity vectors, _extraQuantities[index].
-// If index is out of scope an empty vector is returned and the referenced bool is false.
-std::vector<float> FieldlinesState::extraQuantity(size_t index, bool& isSuccessful) const
+// Returns a view of one of the extra quantity vectors, _extraQuantities[index].
+// If index is out of scope an empty view is returned and the referenced bool is false.
+FieldlinesState::ArrayView<float> FieldlinesState::extraQuantity(size_t index,
+                                                                bool& isSuccessful) const
 {
-    if (index < _extraQuantities.size()) {
+    if (index < nExtraQuantities()) {
         isSuccessful = true;
-        return _extraQuantities[index];
+        if (_mappedFile) {
+            return mappedView<float>(
+                *_mappedFile,
+                _mappedLayout.extraQuantities[index],
+                _mappedLayout.nPoints
+            );
+        }
+        const std::vector<float>& quantity = _extraQuantities[index];
+        return ArrayView<float>(quantity.data(), quantity.size());
     }
     else {
         isSuccessful = false;
@@ -402,6 +599,7 @@ std::vector<float> FieldlinesState::extraQuantity(size_t index, bool& isSuccessf
 // _lineStart & _lineCount accordingly.
 
 void FieldlinesState::addLine(std::vector<glm::vec3>& line) {
+    makeOwned();
     const size_t nNewPoints = line.size();
     const size_t nOldPoints = _vertexPositions.size();
     _lineStart.push_back(static_cast<GLint>(nOldPoints));
@@ -416,28 +614,40 @@ void FieldlinesState::addLine(std::vector<glm::vec3>& line) {
 }
 
 void FieldlinesState::appendToExtra(size_t idx, float val) {
+    makeOwned();
     _extraQuantities[idx].push_back(val);
 }
 
 void FieldlinesState::setExtraQuantityNames(std::vector<std::string> names) {
+    makeOwned();
     _extraQuantityNames = std::move(names);
     _extraQuantities.resize(_extraQuantityNames.size());
 }
 
-const std::vector<std::vector<float>>& FieldlinesState::extraQuantities() const {
-    return _extraQuantities;
-}
-
 const std::vector<std::string>& FieldlinesState::extraQuantityNames() const {
     return _extraQuantityNames;
 }
 
-const std::vector<GLsizei>& FieldlinesState::lineCount() const {
-    return _lineCount;
+FieldlinesState::ArrayView<GLsizei> FieldlinesState::lineCount() const {
+    if (_mappedFile) {
+        return mappedView<GLsizei>(
+            *_mappedFile,
+            _mappedLayout.lineCount,
+            _mappedLayout.nLines
+        );
+    }
+    return ArrayView<GLsizei>(_lineCount.data(), _lineCount.size());
 }
 
-const std::vector<GLint>& FieldlinesState::lineStart() const {
-    return _lineStart;
+FieldlinesState::ArrayView<GLint> FieldlinesState::lineStart() const {
+    if (_mappedFile) {
+        return mappedView<GLint>(
+            *_mappedFile,
+            _mappedLayout.lineStart,
+            _mappedLayout.nLines
+        );
+    }
+    return ArrayView<GLint>(_lineStart.data(), _lineStart.size());
 }
 
 fls::Model FieldlinesState::FieldlinesState::model() const {
@@ -445,15 +655,71 @@ fls::Model FieldlinesState::FieldlinesState::model() const {
 }
 
 size_t FieldlinesState::nExtraQuantities() const {
-    return _extraQuantities.size();
+    return _mappedFile ? _mappedLayout.extraQuantities.size() : _extraQuantities.size();
 }
 
 double FieldlinesState::triggerTime() const {
     return _triggerTime;
 }
 
-const std::vector<glm::vec3>& FieldlinesState::vertexPositions() const {
-    return _vertexPositions;
+FieldlinesState::ArrayView<glm::vec3> FieldlinesState::vertexPositions() const {
+    if (_mappedFile) {
+        return mappedView<glm::vec3>(
+            *_mappedFile,
+            _mappedLayout.vertexPositions,
+            _mappedLayout.nPoints
+        );
+    }
+    return ArrayView<glm::vec3>(_vertexPositions.data(), _vertexPositions.size());
+}
+
+bool FieldlinesState::isMemoryMapped() const {
+    return _mappedFile != nullptr;
+}
+
+void FieldlinesState::prefaultMappedData(const std::vector<size_t>& extraQuantities) const
+{
+    if (!_mappedFile) {
+        return;
+    }
+
+    const size_t nLineBytes = _mappedLayout.nLines * sizeof(int32_t);
+    _mappedFile->prefault(_mappedLayout.lineStart, nLineBytes);
+    _mappedFile->prefault(_mappedLayout.lineCount, nLineBytes);
+    _mappedFile->prefault(
+        _mappedLayout.vertexPositions,
+        _mappedLayout.nPoints * 3 * sizeof(float)
+    );
+    for (size_t index : extraQuantities) {
+        if (index < _mappedLayout.extraQuantities.size()) {
+            _mappedFile->prefault(
+                _mappedLayout.extraQuantities[index],
+                _mappedLayout.nPoints * sizeof(float)
+            );
+        }
+    }
+}
+
+void FieldlinesState::makeOwned() {
+    if (!_mappedFile) {
+        return;
+    }
+
+    const ArrayView<GLint> lineStarts = lineStart();
+    _lineStart.assign(lineStarts.begin(), lineStarts.end());
+    const ArrayView<GLsizei> lineCounts = lineCount();
+    _lineCount.assign(lineCounts.begin(), lineCounts.end());
+    const ArrayView<glm::vec3> positions = vertexPositions();
+    _vertexPositions.assign(positions.begin(), positions.end());
+    _extraQuantities.resize(nExtraQuantities());
+    for (size_t i = 0; i < _extraQuantities.size(); ++i) {
+        bool isSuccessful;
+        const ArrayView<float> quantity = extraQuantity(i, isSuccessful);
+        _extraQuantities[i].assign(quantity.begin(), quantity.end());
+    }
+
+    _mappedFile = nullptr;
+    _mappedLayout = MappedLayout();
 }
 
 } // namespace openspace
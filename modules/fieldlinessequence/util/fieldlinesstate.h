@@ -28,35 +28,85 @@
 #include <modules/fieldlinessequence/util/commons.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace openspace {
 
+class MappedFile;
+
+/**
+ * A single time step of a fieldlines sequence. States that are loaded from .osfls files
+ * of version 1 and newer do not copy the vertex data, but keep the file memory mapped and
+ * refer to the arrays inside the mapping directly. Only the pages that are actually
+ * accessed are read from disk, so an extra quantity that is never used for coloring or
+ * masking is never loaded. Any function that modifies the vertex data copies the data of
+ * a memory mapped state into memory first.
+ */
 class FieldlinesState {
 public:
+    /**
+     * A non-owning view of one of the arrays of a FieldlinesState. The view is only valid
+     * as long as the state it was retrieved from is alive and not modified.
+     */
+    template <typename T>
+    class ArrayView {
+    public:
+        ArrayView() = default;
+        ArrayView(const T* data, size_t size) : _data(data), _size(size) {}
+
+        const T* data() const { return _data; }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        const T* begin() const { return _data; }
+        const T* end() const { return _data + _size; }
+        const T& operator[](size_t index) const { return _data[index]; }
+
+    private:
+        const T* _data = nullptr;
+        size_t _size = 0;
+    };
+
     void convertLatLonToCartesian(float scale = 1.f);
     void scalePositions(float scale);
 
     bool loadStateFromOsfls(const std::string& pathToOsflsFile);
     void saveStateToOsfls(const std::string& pathToOsflsFile);
 
+    /**
+     * Writes the state to the .osfls file at \p filePath using the current version of
+     * the file format. Returns \c false if the file could not be written.
+     */
+    bool writeOsflsFile(const std::string& filePath) const;
+
     bool loadStateFromJson(const std::string& pathToJsonFile, fls::Model model,
         float coordToMeters);
     void saveStateToJson(const std::string& pathToJsonFile);
 
-    const std::vector<std::vector<float>>& extraQuantities() const;
     const std::vector<std::string>& extraQuantityNames() const;
-    const std::vector<GLsizei>& lineCount() const;
-    const std::vector<GLint>& lineStart() const;
+    ArrayView<GLsizei> lineCount() const;
+    ArrayView<GLint> lineStart() const;
 
     fls::Model model() const;
     size_t nExtraQuantities() const;
     double triggerTime() const;
-    const std::vector<glm::vec3>& vertexPositions() const;
+    ArrayView<glm::vec3> vertexPositions() const;
 
     // Special getter. Returns extraQuantities[index].
-    std::vector<float> extraQuantity(size_t index, bool& isSuccesful) const;
+    ArrayView<float> extraQuantity(size_t index, bool& isSuccesful) const;
+
+    /// Returns \c true if the vertex data is read from a memory mapped file
+    bool isMemoryMapped() const;
+
+    /**
+     * Forces the vertex positions, the line information and the extra quantities with
+     * the provided \p extraQuantities indices of a memory mapped state to be read from
+     * disk, so that accessing them later does not block. Indices that are out of range
+     * are ignored. Does nothing if the state is not memory mapped.
+     */
+    void prefaultMappedData(const std::vector<size_t>& extraQuantities) const;
 
     void setModel(fls::Model m);
     void setTriggerTime(double t);
@@ -66,6 +116,21 @@ public:
     void appendToExtra(size_t idx, float val);
 
 private:
+    // Byte offsets of the arrays inside of a memory mapped .osfls file
+    struct MappedLayout {
+        size_t nLines = 0;
+        size_t nPoints = 0;
+        size_t lineStart = 0;
+        size_t lineCount = 0;
+        size_t vertexPositions = 0;
+        std::vector<size_t> extraQuantities;
+    };
+
+    bool loadMappedStateFromOsfls(const std::string& pathToOsflsFile);
+
+    // Copies the data of a memory mapped state into the vectors and releases the mapping
+    void makeOwned();
+
     bool _isMorphable = false;
     double _triggerTime = -1.0;
     fls::Model _model;
@@ -75,6 +140,10 @@ private:
     std::vector<GLsizei> _lineCount;
     std::vector<GLint> _lineStart;
     std::vector<glm::vec3> _vertexPositions;
+
+    // Shared so that copies of a memory mapped state refer to the same mapping
+    std::shared_ptr<const MappedFile> _mappedFile;
+    MappedLayout _mappedLayout;
 };
 
 } // namespace openspace
@@ -29,7 +29,10 @@
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
 #include <fstream>
+#include <numeric>
 #include <thread>
 
 namespace {
@@ -38,15 +41,24 @@ namespace {
 
 namespace openspace {
 
+OctreeManager::~OctreeManager() {
+    // Detached streaming threads still reference the nodes
+    waitForStreamingJobs();
+}
+
 void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStarsPerNode) {
-    if (_root) {
+    if (!_nodeArena.empty()) {
         LDEBUG("Clear existing Octree");
+        waitForStreamingJobs();
         clearAllData();
+        _nodeArena.clear();
+        _nNodesInArena = 0;
     }
 
     LDEBUG("Initializing new Octree");
-    _root = std::make_shared<OctreeNode>();
-    _root->octreePositionIndex = 8;
+    _root = OctreeNode();
+    _root.isLeaf = false;
+    _root.octreePositionIndex = 8;
 
     // Initialize the culler. The NDC.z of the comparing corners are always -1 or 1.
     globebrowsing::AABB3 box;
@@ -72,29 +84,20 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
         MAX_STARS_PER_NODE = static_cast<size_t>(maxStarsPerNode);
     }
 
+    _root.firstChild = allocateChildren();
     for (size_t i = 0; i < 8; ++i) {
         _numLeafNodes++;
-        _root->Children[i] = std::make_shared<OctreeNode>();
-        _root->Children[i]->posData = std::vector<float>();
-        _root->Children[i]->colData = std::vector<float>();
-        _root->Children[i]->velData = std::vector<float>();
-        _root->Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        _root->Children[i]->isLeaf = true;
-        _root->Children[i]->isLoaded = false;
-        _root->Children[i]->hasLoadedDescendant = false;
-        _root->Children[i]->bufferIndex = DEFAULT_INDEX;
-        _root->Children[i]->octreePositionIndex = 80 + i;
-        _root->Children[i]->numStars = 0;
-        _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-        _root->Children[i]->originX = (i % 2 == 0) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originY = (i % 4 < 2) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originZ = (i < 4) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
+        OctreeNode& child = childNode(_root, i);
+        child.isLeaf = true;
+        child.isLoaded = false;
+        child.hasLoadedDescendant = false;
+        child.bufferIndex = DEFAULT_INDEX;
+        child.octreePositionIndex = 80 + i;
+        child.numStars = 0;
+        child.halfDimension = MAX_DIST / 2.f;
+        child.originX = (i % 2 == 0) ? child.halfDimension : -child.halfDimension;
+        child.originY = (i % 4 < 2) ? child.halfDimension : -child.halfDimension;
+        child.originZ = (i < 4) ? child.halfDimension : -child.halfDimension;
     }
 }
 
@@ -119,16 +122,20 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
 void OctreeManager::insert(const std::vector<float>& starValues) {
     size_t index = getChildIndex(starValues[0], starValues[1], starValues[2]);
 
-    insertInNode(*_root->Children[index], starValues);
+    insertInNode(childNode(_root, index), starValues);
+}
+
+size_t OctreeManager::branchIndex(float posX, float posY, float posZ) {
+    return getChildIndex(posX, posY, posZ);
 }
 
 void OctreeManager::sliceLodData(size_t branchIndex) {
     if (branchIndex != 8) {
-        sliceNodeLodCache(*_root->Children[branchIndex]);
+        sliceNodeLodCache(childNode(_root, branchIndex));
     }
     else {
-        for (int i = 0; i < 7; ++i) {
-            sliceNodeLodCache(*_root->Children[i]);
+        for (size_t i = 0; i < 8; ++i) {
+            sliceNodeLodCache(childNode(_root, i));
         }
     }
 }
@@ -138,7 +145,7 @@ void OctreeManager::printStarsPerNode() const {
 
     for (int i = 0; i < 8; ++i) {
         std::string prefix = "{" + std::to_string(i);
-        accumulatedString += printStarsPerNode(*_root->Children[i], prefix);
+        accumulatedString += printStarsPerNode(childNode(_root, i), prefix);
     }
     LINFO(fmt::format("Number of stars per node: \n{}", accumulatedString));
     LINFO(fmt::format("Number of leaf nodes: {}", std::to_string(_numLeafNodes)));
@@ -157,20 +164,19 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         // Only traverse Octree once!
         if (_parentNodeOfCamera == 8) {
             // Fetch first layer of children
-            fetchChildrenNodes(*_root, 0);
+            fetchChildrenNodes(_root, 0);
 
-            for (int i = 0; i < 8; ++i) {
+            for (size_t i = 0; i < 8; ++i) {
                 // Check so branch doesn't have a single layer.
-                if (_root->Children[i]->isLeaf) {
+                OctreeNode* n = &childNode(_root, i);
+                if (n->isLeaf) {
                     continue;
                 }
 
                 // Use multithreading to load files and detach thread from main execution
                 // so it can execute independently. Thread will be destroyed when
                 // finished!
-                std::thread([this, n = _root->Children[i]]() {
-                    fetchChildrenNodes(*n, -1);
-                }).detach();
+                launchStreamingJob([this, n]() { fetchChildrenNodes(*n, -1); });
             }
             _parentNodeOfCamera = 0;
         }
@@ -182,7 +188,7 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         cameraPos / (1000.0 * distanceconstants::Parsec)
     );
     size_t idx = getChildIndex(fCameraPos.x, fCameraPos.y, fCameraPos.z);
-    std::shared_ptr<OctreeNode> node = _root->Children[idx];
+    const OctreeNode* node = &childNode(_root, idx);
 
     while (!node->isLeaf) {
         idx = getChildIndex(
@@ -193,7 +199,7 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
             node->originY,
             node->originZ
         );
-        node = node->Children[idx];
+        node = &childNode(*node, idx);
     }
     unsigned long long leafId = node->octreePositionIndex;
     unsigned long long firstParentId = leafId / 10;
@@ -288,7 +294,9 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         }
         // Use asynchronous removal.
         if (!nodesToRemove.empty()) {
-            std::thread(&OctreeManager::removeNodesFromRam, this, nodesToRemove).detach();
+            launchStreamingJob([this, nodes = std::move(nodesToRemove)]() {
+                removeNodesFromRam(nodes);
+            });
         }
     }
 }
@@ -301,7 +309,7 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
 
     // Fetch first layer children if we're already at root.
     if (parentId == 8) {
-        fetchChildrenNodes(*_root, 0);
+        fetchChildrenNodes(_root, 0);
         return;
     }
 
@@ -377,9 +385,9 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
     }
 
     // Traverse to that parent node (as long as such a child exists!).
-    std::shared_ptr<OctreeNode> node = _root;
-    while (!indexStack.empty() && !node->Children[indexStack.top()]->isLeaf) {
-        node = node->Children[indexStack.top()];
+    OctreeNode* node = &_root;
+    while (!indexStack.empty() && !childNode(*node, indexStack.top()).isLeaf) {
+        node = &childNode(*node, indexStack.top());
         node->hasLoadedDescendant = true;
         indexStack.pop();
     }
@@ -387,9 +395,9 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
     // Fetch all children nodes from found parent. Use multithreading to load files
     // asynchronously! Detach thread from main execution so it can execute independently.
     // Thread will then be destroyed when it has finished!
-    std::thread([this, node, additionalLevelsToFetch]() {
+    launchStreamingJob([this, node, additionalLevelsToFetch]() {
         fetchChildrenNodes(*node, additionalLevelsToFetch);
-    }).detach();
+    });
 }
 
 std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4& mvp,
@@ -453,7 +461,7 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         // Remove LOD from first layer of children.
         for (int i = 0; i < 8; ++i) {
             std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *_root->Children[i],
+                childNode(_root, i),
                 deltaStars
             );
             renderData.insert(tmpData.begin(), tmpData.end());
@@ -467,7 +475,7 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         }
 
         std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *_root->Children[i],
+            childNode(_root, i),
             mvp,
             screenSize,
             deltaStars,
@@ -525,8 +533,7 @@ std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
     std::vector<float> fullData;
 
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*_root->Children[i], option);
-        fullData.insert(fullData.end(), tmpData.begin(), tmpData.end());
+        getNodeData(childNode(_root, i), option, fullData);
     }
     return fullData;
 }
@@ -534,11 +541,11 @@ std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
 void OctreeManager::clearAllData(int branchIndex) {
     // Don't clear everything if not needed.
     if (branchIndex != -1) {
-        clearNodeData(*_root->Children[branchIndex]);
+        clearNodeData(childNode(_root, branchIndex));
     }
     else {
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*_root->Children[i]);
+            clearNodeData(childNode(_root, i));
         }
     }
 }
@@ -553,7 +560,7 @@ void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData) {
 
     // Use pre-traversal (Morton code / Z-order).
     for (size_t i = 0; i < 8; ++i) {
-        writeNodeToFile(outFileStream, *_root->Children[i], writeData);
+        writeNodeToFile(outFileStream, childNode(_root, i), writeData);
     }
 }
 
@@ -568,26 +575,54 @@ void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, const OctreeNo
 
     // Write node data if specified
     if (writeData) {
-        std::vector<float> nodeData = node.posData;
-        nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-        nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-        int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-        size_t nBytes = nDataSize * sizeof(nodeData[0]);
-
-        outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
-        if (nDataSize > 0) {
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
-        }
+        writeNodeData(outFileStream, node);
     }
 
     // Write children to file (in Morton order) if we're in an inner node.
     if (!node.isLeaf) {
         for (size_t i = 0; i < 8; ++i) {
-            writeNodeToFile(outFileStream, *node.Children[i], writeData);
+            writeNodeToFile(outFileStream, childNode(node, i), writeData);
         }
     }
 }
 
+void OctreeManager::writeNodeData(std::ofstream& outFileStream,
+                                  const OctreeNode& node) const
+{
+    const size_t nStars = starsInData(node);
+    const size_t capacity = starCapacity(node);
+    int32_t nDataSize = static_cast<int32_t>(nStars * (POS_SIZE + COL_SIZE + VEL_SIZE));
+    outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
+    if (nDataSize == 0) {
+        return;
+    }
+
+    // The blocks are only contiguous in memory if the node is tightly packed
+    if (nStars == capacity) {
+        outFileStream.write(
+            reinterpret_cast<const char*>(node.data.data()),
+            nDataSize * sizeof(float)
+        );
+    }
+    else {
+        const float* pos = node.data.data();
+        const float* col = pos + capacity * POS_SIZE;
+        const float* vel = col + capacity * COL_SIZE;
+        outFileStream.write(
+            reinterpret_cast<const char*>(pos),
+            nStars * POS_SIZE * sizeof(float)
+        );
+        outFileStream.write(
+            reinterpret_cast<const char*>(col),
+            nStars * COL_SIZE * sizeof(float)
+        );
+        outFileStream.write(
+            reinterpret_cast<const char*>(vel),
+            nStars * VEL_SIZE * sizeof(float)
+        );
+    }
+}
+
 int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
                                 const std::string& folderPath)
 {
@@ -613,16 +648,11 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
     // Octree Manager root halfDistance must be updated before any nodes are created!
     if (static_cast<int>(MAX_DIST) != oldMaxdist) {
         for (size_t i = 0; i < 8; ++i) {
-            _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-            _root->Children[i]->originX = (i % 2 == 0) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originY = (i % 4 < 2) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originZ = (i < 4) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
+            OctreeNode& child = childNode(_root, i);
+            child.halfDimension = MAX_DIST / 2.f;
+            child.originX = (i % 2 == 0) ? child.halfDimension : -child.halfDimension;
+            child.originY = (i % 4 < 2) ? child.halfDimension : -child.halfDimension;
+            child.originZ = (i < 4) ? child.halfDimension : -child.halfDimension;
         }
     }
 
@@ -632,7 +662,7 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
 
     // Use the same technique to construct octree from file.
     for (size_t i = 0; i < 8; ++i) {
-        nStarsRead += readNodeFromFile(inFileStream, *_root->Children[i], readData);
+        nStarsRead += readNodeFromFile(inFileStream, childNode(_root, i), readData);
     }
     return nStarsRead;
 }
@@ -650,24 +680,17 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
     node.isLeaf = isLeaf;
     node.numStars = numStars;
 
-    // Read node data if specified.
+    // Read node data if specified. The layout in the file is the same as in the node.
     if (readData) {
         int32_t nDataSize = 0;
         inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
 
         if (nDataSize > 0) {
-            std::vector<float> fetchedData(nDataSize, 0.0f);
-            size_t nBytes = nDataSize * sizeof(fetchedData[0]);
-
-            inFileStream.read(reinterpret_cast<char*>(&fetchedData[0]), nBytes);
-
-            int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-            auto posEnd = fetchedData.begin() + (starsInNode * POS_SIZE);
-            auto colEnd = posEnd + (starsInNode * COL_SIZE);
-            auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-            node.posData = std::vector<float>(fetchedData.begin(), posEnd);
-            node.colData = std::vector<float>(posEnd, colEnd);
-            node.velData = std::vector<float>(colEnd, velEnd);
+            node.data.resize(nDataSize);
+            inFileStream.read(
+                reinterpret_cast<char*>(node.data.data()),
+                nDataSize * sizeof(float)
+            );
         }
     }
 
@@ -676,7 +699,7 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
         numStars = 0;
         createNodeChildren(node);
         for (size_t i = 0; i < 8; ++i) {
-            numStars += readNodeFromFile(inFileStream, *node.Children[i], readData);
+            numStars += readNodeFromFile(inFileStream, childNode(node, i), readData);
         }
     }
 
@@ -690,36 +713,23 @@ void OctreeManager::writeToMultipleFiles(const std::string& outFolderPath,
     // Write entire branch to disc, with one file per node.
     std::string outFilePrefix = outFolderPath + std::to_string(branchIndex);
     // More threads doesn't make it much faster, disk speed still the limiter.
-    writeNodeToMultipleFiles(outFilePrefix, *_root->Children[branchIndex], false);
+    writeNodeToMultipleFiles(outFilePrefix, childNode(_root, branchIndex), false);
 
     // Clear all data in branch.
     LINFO(fmt::format("Clear all data from branch {} in octree", branchIndex));
-    clearNodeData(*_root->Children[branchIndex]);
+    clearNodeData(childNode(_root, branchIndex));
 }
 
 void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
                                              OctreeNode& node, bool threadWrites)
 {
-    // Prepare node data, save nothing else.
-    std::vector<float> nodeData = node.posData;
-    nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-    nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-    int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-    size_t nBytes = nDataSize * sizeof(nodeData[0]);
-
     // Only open output stream if we have any values to write.
-    if (nDataSize > 0) {
+    if (starsInData(node) > 0) {
         // Use Morton code to name file (placement in Octree).
         std::string outPath = outFilePrefix + BINARY_SUFFIX;
         std::ofstream outFileStream(outPath, std::ofstream::binary);
         if (outFileStream.good()) {
-            // LINFO("Write " + std::to_string(nDataSize) + " values to " + outPath);
-            outFileStream.write(
-                reinterpret_cast<const char*>(&nDataSize),
-                sizeof(int32_t)
-            );
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
-
+            writeNodeData(outFileStream, node);
             outFileStream.close();
         }
         else {
@@ -735,14 +745,14 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
             if (threadWrites) {
                 // Divide writing to new threads to speed up the process.
                 std::thread t(
-                    [this, newOutFilePrefix, n = node.Children[i]]() {
+                    [this, newOutFilePrefix, n = &childNode(node, i)]() {
                         writeNodeToMultipleFiles(newOutFilePrefix, *n, false);
                     }
                 );
                 writeThreads[i] = std::move(t);
             }
             else {
-                writeNodeToMultipleFiles(newOutFilePrefix, *node.Children[i], false);
+                writeNodeToMultipleFiles(newOutFilePrefix, childNode(node, i), false);
             }
         }
         if (threadWrites) {
@@ -757,23 +767,29 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
 void OctreeManager::fetchChildrenNodes(OctreeNode& parentNode,
                                        int additionalLevelsToFetch)
 {
-    // Lock node to make sure nobody else are trying to load the same children.
-    std::lock_guard lock(parentNode.loadingLock);
+    // Make sure nobody else are trying to load the same children. The lock is released
+    // before descending, as lock stripes are shared with other nodes.
+    {
+        std::lock_guard lock(childrenLoadingLock(parentNode));
 
-    for (int i = 0; i < 8; ++i) {
-        // Fetch node data if we're streaming and it doesn't exist in RAM yet.
-        // (As long as there is any RAM budget left and node actually has any data!)
-        if (!parentNode.Children[i]->isLoaded &&
-            (parentNode.Children[i]->numStars > 0) &&
-            _cpuRamBudget > static_cast<long long>(parentNode.Children[i]->numStars
-            * (POS_SIZE + COL_SIZE + VEL_SIZE) * 4))
-        {
-            fetchNodeDataFromFile(*parentNode.Children[i]);
+        for (size_t i = 0; i < 8; ++i) {
+            // Fetch node data if we're streaming and it doesn't exist in RAM yet.
+            // (As long as there is any RAM budget left and node actually has any data!)
+            OctreeNode& child = childNode(parentNode, i);
+            if (!child.isLoaded && (child.numStars > 0) &&
+                _cpuRamBudget > static_cast<long long>(child.numStars
+                * (POS_SIZE + COL_SIZE + VEL_SIZE) * 4))
+            {
+                fetchNodeDataFromFile(child);
+            }
         }
+    }
 
+    for (size_t i = 0; i < 8; ++i) {
         // Fetch all Children's Children if recursive is set to true!
-        if (additionalLevelsToFetch != 0 && !parentNode.Children[i]->isLeaf) {
-            fetchChildrenNodes(*parentNode.Children[i], --additionalLevelsToFetch);
+        OctreeNode& child = childNode(parentNode, i);
+        if (additionalLevelsToFetch != 0 && !child.isLeaf) {
+            fetchChildrenNodes(child, --additionalLevelsToFetch);
         }
     }
 }
@@ -795,22 +811,25 @@ void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
         // Otherwise don't call this function!
         inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
 
-        std::vector<float> readData(nDataSize, 0.f);
-        int nBytes = nDataSize * sizeof(readData[0]);
+        // The file stores the node data in the same layout as the node, so it is read
+        // straight into the buffer that the node takes over
+        std::vector<float> readData = acquireStarData(nDataSize);
+        long long nBytes = nDataSize * sizeof(float);
         if (nDataSize > 0) {
-            inFileStream.read(reinterpret_cast<char*>(&readData[0]), nBytes);
+            inFileStream.read(reinterpret_cast<char*>(readData.data()), nBytes);
         }
 
-        int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-        auto posEnd = readData.begin() + (starsInNode * POS_SIZE);
-        auto colEnd = posEnd + (starsInNode * COL_SIZE);
-        auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-        node.posData = std::vector<float>(readData.begin(), posEnd);
-        node.colData = std::vector<float>(posEnd, colEnd);
-        node.velData = std::vector<float>(colEnd, velEnd);
+        {
+            std::lock_guard lock(nodeLock(node));
+            if (node.isLoaded) {
+                releaseStarData(std::move(readData));
+                return;
+            }
+            node.data = std::move(readData);
+            node.isLoaded = true;
+        }
 
         // Keep track of nodes that are loaded and update CPU RAM budget.
-        node.isLoaded = true;
         if (!_datasetFitInMemory) {
             std::lock_guard g(_leastRecentlyFetchedNodesMutex);
             _leastRecentlyFetchedNodes.push(node.octreePositionIndex);
@@ -822,6 +841,61 @@ void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
     }
 }
 
+std::vector<float> OctreeManager::acquireStarData(size_t nValues) {
+    {
+        std::lock_guard lock(_starDataPoolMutex);
+        auto it = std::find_if(
+            _starDataPool.begin(),
+            _starDataPool.end(),
+            [nValues](const std::vector<float>& d) { return d.capacity() >= nValues; }
+        );
+        if (it != _starDataPool.end()) {
+            std::vector<float> data = std::move(*it);
+            *it = std::move(_starDataPool.back());
+            _starDataPool.pop_back();
+            data.resize(nValues);
+            return data;
+        }
+    }
+    return std::vector<float>(nValues);
+}
+
+void OctreeManager::releaseStarData(std::vector<float> data) {
+    data.clear();
+    std::lock_guard lock(_starDataPoolMutex);
+    if (data.capacity() > 0 && _starDataPool.size() < MAX_POOLED_BUFFERS) {
+        _starDataPool.push_back(std::move(data));
+    }
+}
+
+void OctreeManager::launchStreamingJob(std::function<void()> job) {
+    {
+        std::lock_guard lock(_streamingJobsMutex);
+        _nStreamingJobs++;
+    }
+    std::thread([this, job = std::move(job)]() {
+        job();
+        std::lock_guard lock(_streamingJobsMutex);
+        _nStreamingJobs--;
+        _streamingJobsDone.notify_all();
+    }).detach();
+}
+
+void OctreeManager::waitForStreamingJobs() {
+    std::unique_lock lock(_streamingJobsMutex);
+    _streamingJobsDone.wait(lock, [this]() { return _nStreamingJobs == 0; });
+}
+
+std::mutex& OctreeManager::nodeLock(const OctreeNode& node) {
+    return _nodeLocks[node.octreePositionIndex % _nodeLocks.size()];
+}
+
+std::mutex& OctreeManager::childrenLoadingLock(const OctreeNode& parentNode) {
+    return _childrenLoadingLocks[
+        parentNode.octreePositionIndex % _childrenLoadingLocks.size()
+    ];
+}
+
 void OctreeManager::removeNodesFromRam(
                                      const std::vector<unsigned long long>& nodesToRemove)
 {
@@ -836,11 +910,11 @@ void OctreeManager::removeNodesFromRam(
         }
 
         // Traverse to node and remove it.
-        std::shared_ptr<OctreeNode> node = _root;
-        std::vector<std::shared_ptr<OctreeNode>> ancestors;
+        OctreeNode* node = &_root;
+        std::vector<OctreeNode*> ancestors;
         while (!indexStack.empty()) {
             ancestors.push_back(node);
-            node = node->Children[indexStack.top()];
+            node = &childNode(*node, indexStack.top());
             indexStack.pop();
         }
         removeNode(*node);
@@ -850,45 +924,34 @@ void OctreeManager::removeNodesFromRam(
 }
 
 void OctreeManager::removeNode(OctreeNode& node) {
-    // Lock node to make sure nobody else is trying to access it while removing.
-    std::lock_guard lock(node.loadingLock);
+    std::vector<float> data;
+    {
+        // Lock node to make sure nobody else is trying to access it while removing.
+        std::lock_guard lock(nodeLock(node));
+        if (!node.isLoaded) {
+            return;
+        }
 
-    int nBytes = static_cast<int>(
-        node.numStars * _valuesPerStar * sizeof(node.posData[0])
-    );
-    // Keep track of which nodes that are loaded and update CPU RAM budget.
-    node.isLoaded = false;
-    _cpuRamBudget += nBytes;
-
-    // Clear data
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
+        // Keep track of which nodes that are loaded.
+        node.isLoaded = false;
+        data = std::move(node.data);
+        node.data = std::vector<float>();
+    }
+
+    // Update CPU RAM budget and hand the buffer over to the next node that is fetched.
+    _cpuRamBudget += static_cast<long long>(data.size() * sizeof(float));
+    releaseStarData(std::move(data));
 }
 
-void OctreeManager::propagateUnloadedNodes(
-                                   std::vector<std::shared_ptr<OctreeNode>> ancestorNodes)
-{
-    std::shared_ptr<OctreeNode> parentNode = ancestorNodes.back();
+void OctreeManager::propagateUnloadedNodes(std::vector<OctreeNode*> ancestorNodes) {
+    OctreeNode* parentNode = ancestorNodes.back();
     while (parentNode->octreePositionIndex != 8) {
         // Check if any children of inner node is still loaded, or has loaded descendants.
-        if (parentNode->Children[0]->isLoaded || parentNode->Children[1]->isLoaded ||
-            parentNode->Children[2]->isLoaded || parentNode->Children[3]->isLoaded ||
-            parentNode->Children[4]->isLoaded || parentNode->Children[5]->isLoaded ||
-            parentNode->Children[6]->isLoaded || parentNode->Children[7]->isLoaded ||
-            parentNode->Children[0]->hasLoadedDescendant ||
-            parentNode->Children[1]->hasLoadedDescendant ||
-            parentNode->Children[2]->hasLoadedDescendant ||
-            parentNode->Children[3]->hasLoadedDescendant ||
-            parentNode->Children[4]->hasLoadedDescendant ||
-            parentNode->Children[5]->hasLoadedDescendant ||
-            parentNode->Children[6]->hasLoadedDescendant ||
-            parentNode->Children[7]->hasLoadedDescendant)
-        {
-            return;
+        for (size_t i = 0; i < 8; ++i) {
+            const OctreeNode& child = childNode(*parentNode, i);
+            if (child.isLoaded || child.hasLoadedDescendant) {
+                return;
+            }
         }
         // Else all children has been unloaded and we can update parent flag.
         parentNode->hasLoadedDescendant = false;
@@ -900,6 +963,44 @@ void OctreeManager::propagateUnloadedNodes(
     }
 }
 
+void OctreeManager::mergeBranch(OctreeManager& other, size_t branchIndex) {
+    ghoul_assert(branchIndex < 8, "Branch index must be smaller than 8");
+    ghoul_assert(
+        childNode(_root, branchIndex).isLeaf &&
+        childNode(_root, branchIndex).numStars == 0,
+        "Branch must be empty"
+    );
+    ghoul_assert(MAX_DIST == other.MAX_DIST, "Octrees must have the same MAX_DIST");
+
+    // The other 7 branches of the other Octree are still empty leaves, and the empty
+    // leaf in this Octree is replaced by the leaves of the merged branch
+    _numLeafNodes += other._numLeafNodes - 8;
+    _numInnerNodes += other._numInnerNodes;
+    _totalDepth = std::max(_totalDepth, other._totalDepth);
+
+    OctreeNode& branch = childNode(_root, branchIndex);
+    branch = std::move(other.childNode(other._root, branchIndex));
+    moveChildren(branch, other);
+}
+
+void OctreeManager::moveChildren(OctreeNode& node, OctreeManager& source) {
+    if (node.isLeaf) {
+        return;
+    }
+
+    std::array<OctreeNode*, 8> sourceChildren;
+    for (size_t i = 0; i < 8; ++i) {
+        sourceChildren[i] = &source.childNode(node, i);
+    }
+
+    node.firstChild = allocateChildren();
+    for (size_t i = 0; i < 8; ++i) {
+        OctreeNode& child = childNode(node, i);
+        child = std::move(*sourceChildren[i]);
+        moveChildren(child, source);
+    }
+}
+
 size_t OctreeManager::numLeafNodes() const {
     return _numLeafNodes;
 }
@@ -974,19 +1075,22 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
         createNodeChildren(node);
 
         // Distribute stars from parent node into children.
+        const size_t capacity = starCapacity(node);
+        const float* pos = node.data.data();
+        const float* col = pos + capacity * POS_SIZE;
+        const float* vel = col + capacity * COL_SIZE;
+        std::vector<float> tmpValues(POS_SIZE + COL_SIZE + VEL_SIZE);
+        // The last value will be used as comparison for what to store in LOD cache
+        node.lodMagnitude = col[0];
         for (size_t n = 0; n < MAX_STARS_PER_NODE; ++n) {
-            // Position data.
-            auto posBegin = node.posData.begin() + n * POS_SIZE;
-            auto posEnd = posBegin + POS_SIZE;
-            std::vector<float> tmpValues(posBegin, posEnd);
-            // Color data.
-            auto colBegin = node.colData.begin() + n * COL_SIZE;
-            auto colEnd = colBegin + COL_SIZE;
-            tmpValues.insert(tmpValues.end(), colBegin, colEnd);
-            // Velocity data.
-            auto velBegin = node.velData.begin() + n * VEL_SIZE;
-            auto velEnd = velBegin + VEL_SIZE;
-            tmpValues.insert(tmpValues.end(), velBegin, velEnd);
+            std::copy_n(pos + n * POS_SIZE, POS_SIZE, tmpValues.begin());
+            std::copy_n(col + n * COL_SIZE, COL_SIZE, tmpValues.begin() + POS_SIZE);
+            std::copy_n(
+                vel + n * VEL_SIZE,
+                VEL_SIZE,
+                tmpValues.begin() + POS_SIZE + COL_SIZE
+            );
+            node.lodMagnitude = std::max(node.lodMagnitude, tmpValues[POS_SIZE]);
 
             // Find out which child that will inherit the data and store it.
             size_t index = getChildIndex(
@@ -997,12 +1101,8 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
                 node.originY,
                 node.originZ
             );
-            insertInNode(*node.Children[index], tmpValues, depth);
+            insertInNode(childNode(node, index), tmpValues, depth);
         }
-
-        // Sort magnitudes in inner node.
-        // (The last value will be used as comparison for what to store in LOD cache.)
-        std::sort(node.magOrder.begin(), node.magOrder.end());
     }
 
     // Node is an inner node, keep recursion going.
@@ -1018,64 +1118,120 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
 
     // Determine if new star should be kept in our LOD cache.
     // Keeps track of the brightest nodes in children.
-    if (starValues[POS_SIZE] < node.magOrder[MAX_STARS_PER_NODE - 1].first) {
+    if (starValues[POS_SIZE] < node.lodMagnitude) {
         storeStarData(node, starValues);
     }
 
-    return insertInNode(*node.Children[index], starValues, ++depth);
+    return insertInNode(childNode(node, index), starValues, ++depth);
 }
 
 void OctreeManager::sliceNodeLodCache(OctreeNode& node) {
     // Slice stored LOD data in inner nodes.
     if (!node.isLeaf) {
-        // Sort by magnitude. Inverse relation (i.e. a lower magnitude means a brighter
-        // star!)
-        std::sort(node.magOrder.begin(), node.magOrder.end());
-        node.magOrder.resize(MAX_STARS_PER_NODE);
-
-        std::vector<float> tmpPos;
-        std::vector<float> tmpCol;
-        std::vector<float> tmpVel;
-        // Ordered map contain the MAX_STARS_PER_NODE brightest stars in all children!
-        for (auto const &[absMag, placement] : node.magOrder) {
-            auto posBegin = node.posData.begin() + placement * POS_SIZE;
-            auto colBegin = node.colData.begin() + placement * COL_SIZE;
-            auto velBegin = node.velData.begin() + placement * VEL_SIZE;
-            tmpPos.insert(tmpPos.end(), posBegin, posBegin + POS_SIZE);
-            tmpCol.insert(tmpCol.end(), colBegin, colBegin + COL_SIZE);
-            tmpVel.insert(tmpVel.end(), velBegin, velBegin + VEL_SIZE);
-        }
-        node.posData = std::move(tmpPos);
-        node.colData = std::move(tmpCol);
-        node.velData = std::move(tmpVel);
-        node.numStars = node.magOrder.size(); // = MAX_STARS_PER_NODE
+        // Only keep the MAX_STARS_PER_NODE brightest stars in all children, tightly
+        // packed as they are written to file and uploaded as they are
+        keepBrightestStars(node, MAX_STARS_PER_NODE, MAX_STARS_PER_NODE);
 
-        for (int i = 0; i < 8; ++i) {
-            sliceNodeLodCache(*node.Children[i]);
+        for (size_t i = 0; i < 8; ++i) {
+            sliceNodeLodCache(childNode(node, i));
         }
     }
 }
 
 void OctreeManager::storeStarData(OctreeNode& node, const std::vector<float>& starValues)
 {
-    // Insert star data at the back of vectors and store a vector with pairs consisting of
-    // star magnitude and insert index for later sorting and slicing of LOD cache.
-    float mag = starValues[POS_SIZE];
-    node.magOrder.insert(node.magOrder.end(), std::make_pair(mag, node.numStars));
+    // Grow the node geometrically. Leaves never hold more than MAX_STARS_PER_NODE stars
+    // and the LOD cache of inner nodes is trimmed when it exceeds twice that amount.
+    size_t capacity = starCapacity(node);
+    if (node.numStars == capacity) {
+        const size_t maxCapacity = node.isLeaf ?
+            MAX_STARS_PER_NODE :
+            2 * MAX_STARS_PER_NODE + 1;
+        capacity = std::min(std::max<size_t>(2 * capacity, 16), maxCapacity);
+        reserveStarData(node, capacity);
+    }
+
+    // Insert star data at the back of each block.
+    float* pos = node.data.data();
+    float* col = pos + capacity * POS_SIZE;
+    float* vel = col + capacity * COL_SIZE;
+    auto posEnd = starValues.begin() + POS_SIZE;
+    auto colEnd = posEnd + COL_SIZE;
+    std::copy(starValues.begin(), posEnd, pos + node.numStars * POS_SIZE);
+    std::copy(posEnd, colEnd, col + node.numStars * COL_SIZE);
+    std::copy(colEnd, colEnd + VEL_SIZE, vel + node.numStars * VEL_SIZE);
     node.numStars++;
 
     // If LOD is growing too large then sort it and resize to [chunk size] to avoid too
     // much RAM usage and increase threshold for adding new stars.
-    if (node.magOrder.size() > MAX_STARS_PER_NODE * 2) {
-        std::sort(node.magOrder.begin(), node.magOrder.end());
-        node.magOrder.resize(MAX_STARS_PER_NODE);
+    if (node.numStars > MAX_STARS_PER_NODE * 2) {
+        keepBrightestStars(node, MAX_STARS_PER_NODE, capacity);
+        const float* sortedCol = node.data.data() + capacity * POS_SIZE;
+        node.lodMagnitude = sortedCol[(MAX_STARS_PER_NODE - 1) * COL_SIZE];
     }
+}
 
-    auto posEnd = starValues.begin() + POS_SIZE;
-    auto colEnd = posEnd + COL_SIZE;
-    node.posData.insert(node.posData.end(), starValues.begin(), posEnd);
-    node.colData.insert(node.colData.end(), posEnd, colEnd);
-    node.velData.insert(node.velData.end(), colEnd, starValues.end());
+void OctreeManager::keepBrightestStars(OctreeNode& node, size_t nStars, size_t capacity)
+{
+    const size_t oldCapacity = starCapacity(node);
+    const float* pos = node.data.data();
+    const float* col = pos + oldCapacity * POS_SIZE;
+    const float* vel = col + oldCapacity * COL_SIZE;
+
+    // Sort by magnitude. Inverse relation (i.e. a lower magnitude means a brighter
+    // star!). The insert order breaks ties, which keeps the order stable.
+    nStars = std::min(nStars, node.numStars);
+    std::vector<uint32_t> order(node.numStars);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(
+        order.begin(),
+        order.begin() + nStars,
+        order.end(),
+        [col, this](uint32_t lhs, uint32_t rhs) {
+            const float lhsMag = col[lhs * COL_SIZE];
+            const float rhsMag = col[rhs * COL_SIZE];
+            return lhsMag < rhsMag || (lhsMag == rhsMag && lhs < rhs);
+        }
+    );
+
+    std::vector<float> data(capacity * (POS_SIZE + COL_SIZE + VEL_SIZE));
+    float* newPos = data.data();
+    float* newCol = newPos + capacity * POS_SIZE;
+    float* newVel = newCol + capacity * COL_SIZE;
+    for (size_t n = 0; n < nStars; ++n) {
+        std::copy_n(pos + order[n] * POS_SIZE, POS_SIZE, newPos + n * POS_SIZE);
+        std::copy_n(col + order[n] * COL_SIZE, COL_SIZE, newCol + n * COL_SIZE);
+        std::copy_n(vel + order[n] * VEL_SIZE, VEL_SIZE, newVel + n * VEL_SIZE);
+    }
+    node.data = std::move(data);
+    node.numStars = nStars;
+}
+
+void OctreeManager::reserveStarData(OctreeNode& node, size_t capacity) {
+    const size_t oldCapacity = starCapacity(node);
+    const size_t nStars = std::min(starsInData(node), capacity);
+    std::vector<float> data(capacity * (POS_SIZE + COL_SIZE + VEL_SIZE));
+
+    // Move each block separately, as the blocks start at different offsets now.
+    const float* pos = node.data.data();
+    const float* col = pos + oldCapacity * POS_SIZE;
+    const float* vel = col + oldCapacity * COL_SIZE;
+    std::copy_n(pos, nStars * POS_SIZE, data.begin());
+    std::copy_n(col, nStars * COL_SIZE, data.begin() + capacity * POS_SIZE);
+    std::copy_n(
+        vel,
+        nStars * VEL_SIZE,
+        data.begin() + capacity * (POS_SIZE + COL_SIZE)
+    );
+    node.data = std::move(data);
+}
+
+size_t OctreeManager::starCapacity(const OctreeNode& node) const {
+    return node.data.size() / (POS_SIZE + COL_SIZE + VEL_SIZE);
+}
+
+size_t OctreeManager::starsInData(const OctreeNode& node) const {
+    return std::min(node.numStars, starCapacity(node));
 }
 
 std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
@@ -1089,10 +1245,10 @@ std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
         return str + " - [Leaf] \n";
     }
     else {
-        str += fmt::format("LOD: {} - [Parent]\n", node.posData.size() / POS_SIZE);
-        for (int i = 0; i < 8; ++i) {
+        str += fmt::format("LOD: {} - [Parent]\n", starsInData(node));
+        for (size_t i = 0; i < 8; ++i) {
             auto pref = prefix + "->" + std::to_string(i);
-            str += printStarsPerNode(*node.Children[i], pref);
+            str += printStarsPerNode(childNode(node, i), pref);
         }
         return str;
     }
@@ -1161,9 +1317,9 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
                 }
 
                 // We're in an inner node, remove indices from potential children in cache
-                for (int i = 0; i < 8; ++i) {
+                for (size_t i = 0; i < 8; ++i) {
                     std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                        *node.Children[i],
+                        childNode(node, i),
                         deltaStars
                     );
                     fetchedData.insert(tmpData.begin(), tmpData.end());
@@ -1207,7 +1363,7 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
         // Observe that if there exists identical keys in fetchedData then those values in
         // tmpData will be ignored! Thus we store the removed keys until next render call!
         std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *node.Children[i],
+            childNode(node, i),
             mvp,
             screenSize,
             deltaStars,
@@ -1243,9 +1399,9 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
 
     // Check children recursively if we're in an inner node.
     if (!(node.isLeaf) && recursive) {
-        for (int i = 0; i < 8; ++i) {
+        for (size_t i = 0; i < 8; ++i) {
             std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *node.Children[i],
+                childNode(node, i),
                 deltaStars
             );
             keysToRemove.insert(tmpData.begin(), tmpData.end());
@@ -1254,74 +1410,55 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
     return keysToRemove;
 }
 
-std::vector<float> OctreeManager::getNodeData(const OctreeNode& node,
-                                              gaia::RenderOption option)
+void OctreeManager::getNodeData(const OctreeNode& node, gaia::RenderOption option,
+                                std::vector<float>& nodeData)
 {
     // Return node data if node is a leaf.
     if (node.isLeaf) {
         int dStars = 0;
-        return constructInsertData(node, option, dStars);
+        std::vector<float> tmpData = constructInsertData(node, option, dStars);
+        nodeData.insert(nodeData.end(), tmpData.begin(), tmpData.end());
+        return;
     }
 
     // If we're not in a leaf, get data from all children recursively.
-    auto nodeData = std::vector<float>();
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*node.Children[i], option);
-        nodeData.insert(nodeData.end(), tmpData.begin(), tmpData.end());
+        getNodeData(childNode(node, i), option, nodeData);
     }
-    return nodeData;
 }
 
 void OctreeManager::clearNodeData(OctreeNode& node) {
     // Clear data and its allocated memory.
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
-
-    // Clear magnitudes as well!
-    //std::vector<std::pair<float, size_t>>().swap(node->magOrder);
-    node.magOrder.clear();
+    std::vector<float>().swap(node.data);
 
     if (!node.isLeaf) {
         // Remove data from all children recursively.
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*node.Children[i]);
+            clearNodeData(childNode(node, i));
         }
     }
 }
 
 void OctreeManager::createNodeChildren(OctreeNode& node) {
+    node.firstChild = allocateChildren();
     for (size_t i = 0; i < 8; ++i) {
         _numLeafNodes++;
-        node.Children[i] = std::make_shared<OctreeNode>();
-        node.Children[i]->isLeaf = true;
-        node.Children[i]->isLoaded = false;
-        node.Children[i]->hasLoadedDescendant = false;
-        node.Children[i]->bufferIndex = DEFAULT_INDEX;
-        node.Children[i]->octreePositionIndex = (node.octreePositionIndex * 10) + i;
-        node.Children[i]->numStars = 0;
-        node.Children[i]->posData = std::vector<float>();
-        node.Children[i]->colData = std::vector<float>();
-        node.Children[i]->velData = std::vector<float>();
-        node.Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        node.Children[i]->halfDimension = node.halfDimension / 2.f;
+        OctreeNode& child = childNode(node, i);
+        child.isLeaf = true;
+        child.isLoaded = false;
+        child.hasLoadedDescendant = false;
+        child.bufferIndex = DEFAULT_INDEX;
+        child.octreePositionIndex = (node.octreePositionIndex * 10) + i;
+        child.numStars = 0;
+        child.halfDimension = node.halfDimension / 2.f;
 
         // Calculate new origin.
-        node.Children[i]->originX = node.originX;
-        node.Children[i]->originX += (i % 2 == 0) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originY = node.originY;
-        node.Children[i]->originY += (i % 4 < 2) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originZ = node.originZ;
-        node.Children[i]->originZ += (i < 4) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
+        child.originX = node.originX;
+        child.originX += (i % 2 == 0) ? child.halfDimension : -child.halfDimension;
+        child.originY = node.originY;
+        child.originY += (i % 4 < 2) ? child.halfDimension : -child.halfDimension;
+        child.originZ = node.originZ;
+        child.originZ += (i < 4) ? child.halfDimension : -child.halfDimension;
     }
 
     // Clean up parent.
@@ -1330,6 +1467,22 @@ void OctreeManager::createNodeChildren(OctreeNode& node) {
     _numInnerNodes++;
 }
 
+uint32_t OctreeManager::allocateChildren() {
+    if (_nNodesInArena % NODES_PER_CHUNK == 0) {
+        _nodeArena.push_back(std::make_unique<OctreeNode[]>(NODES_PER_CHUNK));
+    }
+    const uint32_t firstChild = _nNodesInArena;
+    _nNodesInArena += 8;
+    return firstChild;
+}
+
+OctreeManager::OctreeNode& OctreeManager::childNode(const OctreeNode& node,
+                                                    size_t childIndex) const
+{
+    const size_t index = node.firstChild + childIndex;
+    return _nodeArena[index / NODES_PER_CHUNK][index % NODES_PER_CHUNK];
+}
+
 bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     if (node.bufferIndex != DEFAULT_INDEX) {
         // If we're rebuilding Buffer Index Cache then store indices to overwrite later.
@@ -1337,7 +1490,7 @@ bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     }
 
     // Make sure node isn't loading/unloading as we're checking isLoaded flag.
-    std::lock_guard lock(node.loadingLock);
+    std::lock_guard lock(nodeLock(node));
 
     // Return false if there are no more spots in our buffer, or if we're streaming and
     // node isn't loaded yet, or if node doesn't have any stars.
@@ -1370,19 +1523,29 @@ std::vector<float> OctreeManager::constructInsertData(const OctreeNode& node,
         return std::vector<float>();
     }
 
+    const size_t nStars = starsInData(node);
+    const size_t capacity = starCapacity(node);
+    const float* pos = node.data.data();
+    const float* col = pos + capacity * POS_SIZE;
+    const float* vel = col + capacity * COL_SIZE;
+
     // Fill chunk by appending zeroes to data so we overwrite possible earlier values.
     // And more importantly so our attribute pointers knows where to read!
-    auto insertData = std::vector<float>(node.posData.begin(), node.posData.end());
+    std::vector<float> insertData;
+    insertData.reserve(
+        (POS_SIZE + COL_SIZE + VEL_SIZE) * (_useVBO ? MAX_STARS_PER_NODE : nStars)
+    );
+    insertData.insert(insertData.end(), pos, pos + nStars * POS_SIZE);
     if (_useVBO) {
         insertData.resize(POS_SIZE * MAX_STARS_PER_NODE, 0.f);
     }
     if (option != gaia::RenderOption::Static) {
-        insertData.insert(insertData.end(), node.colData.begin(), node.colData.end());
+        insertData.insert(insertData.end(), col, col + nStars * COL_SIZE);
         if (_useVBO) {
             insertData.resize((POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
         }
         if (option == gaia::RenderOption::Motion) {
-            insertData.insert(insertData.end(), node.velData.begin(), node.velData.end());
+            insertData.insert(insertData.end(), vel, vel + nStars * VEL_SIZE);
             if (_useVBO) {
                 insertData.resize(
                     (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
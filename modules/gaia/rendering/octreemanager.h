@@ -28,9 +28,15 @@
 #include <modules/gaia/rendering/gaiaoptions.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <set>
 #include <stack>
 #include <vector>
 
@@ -40,27 +46,38 @@ class OctreeCuller;
 
 class OctreeManager {
 public:
+    /**
+     * The nodes are stored in an arena owned by the OctreeManager and the 8 children of
+     * an inner node are always allocated next to each other, so they are referenced by
+     * the arena index of the first child.
+     */
     struct OctreeNode {
-        std::shared_ptr<OctreeNode> Children[8];
-        std::vector<float> posData;
-        std::vector<float> colData;
-        std::vector<float> velData;
-        std::vector<std::pair<float, size_t>> magOrder;
-        float originX;
-        float originY;
-        float originZ;
-        float halfDimension;
-        size_t numStars;
-        bool isLeaf;
-        bool isLoaded;
-        bool hasLoadedDescendant;
-        std::mutex loadingLock;
-        int bufferIndex;
-        unsigned long long octreePositionIndex;
+        /**
+         * The star data in a structure-of-arrays layout. The positions of all stars are
+         * followed by all colors and then by all velocities. Each block has room for
+         * <code>data.size() / (POS_SIZE + COL_SIZE + VEL_SIZE)</code> stars, of which
+         * the first <code>numStars</code> are used. Nodes that are read from files are
+         * tightly packed, which makes the layout identical to the one in the files.
+         */
+        std::vector<float> data;
+        float originX = 0.f;
+        float originY = 0.f;
+        float originZ = 0.f;
+        float halfDimension = 0.f;
+        // A star has to be brighter than this magnitude to enter the LOD cache. Only
+        // used while constructing the Octree
+        float lodMagnitude = 0.f;
+        uint32_t firstChild = 0;
+        size_t numStars = 0;
+        bool isLeaf = true;
+        bool isLoaded = false;
+        bool hasLoadedDescendant = false;
+        int bufferIndex = -1;
+        unsigned long long octreePositionIndex = 0;
     };
 
     OctreeManager() = default;
-    ~OctreeManager() = default;
+    ~OctreeManager();
 
     /**
      * Initializes a one layer Octree with root and 8 children that covers all stars.
@@ -85,6 +102,12 @@ public:
      */
     void insert(const std::vector<float>& starValues);
 
+    /**
+     * \returns the index of the branch of the root node into which a star at the position
+     * (\p posX, \p posY, \p posZ) is inserted.
+     */
+    size_t branchIndex(float posX, float posY, float posZ);
+
     /**
      * Slices LOD data so only the MAX_STARS_PER_NODE brightest stars are stored in inner
      * nodes. If \p branchIndex is defined then only that branch will be sliced.
@@ -158,6 +181,15 @@ public:
      */
     void writeToMultipleFiles(const std::string& outFolderPath, size_t branchIndex);
 
+    /**
+     * Moves the branch \p branchIndex of \p other into this Octree, where that branch
+     * has to be empty. Both Octrees have to be initialized with the same MAX_DIST and
+     * MAX_STARS_PER_NODE and \p other must not contain stars in any other branch. This
+     * makes it possible to construct the branches concurrently in separate Octrees.
+     * The node counts of \p other are no longer valid afterwards.
+     */
+    void mergeBranch(OctreeManager& other, size_t branchIndex);
+
     /**
      * Getters.
      */
@@ -199,6 +231,12 @@ private:
     const int DEFAULT_INDEX = -1;
     const std::string BINARY_SUFFIX = ".bin";
 
+    // Number of nodes per chunk of the node arena. Has to be a multiple of 8 so that
+    // siblings never straddle two chunks
+    static constexpr uint32_t NODES_PER_CHUNK = 4096;
+    // Maximum number of star data buffers that are kept for reuse while streaming
+    static constexpr size_t MAX_POOLED_BUFFERS = 64;
+
     /**
      * \returns the correct index of child node. Maps [1,1,1] to 0 and [-1,-1,-1] to 7.
      */
@@ -228,6 +266,29 @@ private:
      */
     void storeStarData(OctreeNode& node, const std::vector<float>& starValues);
 
+    /**
+     * Sorts the stars in \p node by magnitude and only keeps the \p nStars brightest,
+     * stored with room for \p capacity stars. Stars with the same magnitude keep their
+     * relative order.
+     */
+    void keepBrightestStars(OctreeNode& node, size_t nStars, size_t capacity);
+
+    /**
+     * Changes the number of stars that fit in the data of \p node to \p capacity and
+     * moves the stored stars to their new place in the structure-of-arrays layout.
+     */
+    void reserveStarData(OctreeNode& node, size_t capacity);
+
+    /**
+     * \returns the number of stars that fit in the data of \p node.
+     */
+    size_t starCapacity(const OctreeNode& node) const;
+
+    /**
+     * \returns the number of stars that are stored in the data of \p node.
+     */
+    size_t starsInData(const OctreeNode& node) const;
+
     /**
      * Private help function for <code>printStarsPerNode()</code>. \returns an accumulated
      * string containing all descendant nodes.
@@ -256,9 +317,11 @@ private:
         int& deltaStars, bool recursive = true);
 
     /**
-     * Get data in node and its descendants regardless if they are visible or not.
+     * Appends data in node and its descendants to \p nodeData regardless if they are
+     * visible or not.
      */
-    std::vector<float> getNodeData(const OctreeNode& node, gaia::RenderOption option);
+    void getNodeData(const OctreeNode& node, gaia::RenderOption option,
+        std::vector<float>& nodeData);
 
     /**
      * Clear data from node and its descendants and shrink vectors to deallocate memory.
@@ -270,6 +333,22 @@ private:
      */
     void createNodeChildren(OctreeNode& node);
 
+    /**
+     * Allocates 8 consecutive nodes in the node arena. \returns the index of the first.
+     */
+    uint32_t allocateChildren();
+
+    /**
+     * \returns child \p childIndex of the inner node \p node.
+     */
+    OctreeNode& childNode(const OctreeNode& node, size_t childIndex) const;
+
+    /**
+     * Moves all descendants of \p node, whose children are stored in the node arena of
+     * \p source, into the node arena of this Octree.
+     */
+    void moveChildren(OctreeNode& node, OctreeManager& source);
+
     /**
      * Checks if node should be inserted into stream or not. \returns true if it should,
      * (i.e. it doesn't already exists, there is room for it in the buffer and node data
@@ -294,6 +373,12 @@ private:
     void writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
         bool writeData);
 
+    /**
+     * Writes the number of values followed by the (tightly packed) star data of \p node
+     * to \p outFileStream.
+     */
+    void writeNodeData(std::ofstream& outFileStream, const OctreeNode& node) const;
+
     /**
      * Read a node from file and its potential children. \param readData defines if full
      * data or only structure should be read.
@@ -335,6 +420,40 @@ private:
      */
     void fetchNodeDataFromFile(OctreeNode& node);
 
+    /**
+     * \returns a buffer of \p nValues floats. Reuses buffers of unloaded nodes if
+     * possible to avoid allocations while streaming.
+     */
+    std::vector<float> acquireStarData(size_t nValues);
+
+    /**
+     * Returns the buffer \p data of an unloaded node so that it can be reused.
+     */
+    void releaseStarData(std::vector<float> data);
+
+    /**
+     * Runs \p job on a detached thread and keeps track of it, so that the nodes it
+     * accesses are not destroyed before it has finished.
+     */
+    void launchStreamingJob(std::function<void()> job);
+
+    /**
+     * Blocks until all jobs started with <code>launchStreamingJob()</code> are done.
+     */
+    void waitForStreamingJobs();
+
+    /**
+     * \returns the lock guarding the data and flags of \p node. Locks are shared by
+     * several nodes, so no other node lock must be taken while holding it.
+     */
+    std::mutex& nodeLock(const OctreeNode& node);
+
+    /**
+     * \returns the lock that makes sure that only one thread at a time loads the
+     * children of \p parentNode.
+     */
+    std::mutex& childrenLoadingLock(const OctreeNode& parentNode);
+
     /**
     * Loops though all nodes in \param nodesToRemove and clears them from RAM.
     * Also checks if any ancestor should change the <code>hasLoadedDescendant</code> flag
@@ -353,9 +472,18 @@ private:
      * loaded descendants left. If not, then flag <code>hasLoadedDescendant</code> will be
      * set to false for that parent node and next parent in line will be checked.
      */
-    void propagateUnloadedNodes(std::vector<std::shared_ptr<OctreeNode>> ancestorNodes);
-
-    std::shared_ptr<OctreeNode> _root;
+    void propagateUnloadedNodes(std::vector<OctreeNode*> ancestorNodes);
+
+    OctreeNode _root;
+    std::vector<std::unique_ptr<OctreeNode[]>> _nodeArena;
+    uint32_t _nNodesInArena = 0;
+    std::array<std::mutex, 64> _nodeLocks;
+    std::array<std::mutex, 64> _childrenLoadingLocks;
+    std::vector<std::vector<float>> _starDataPool;
+    std::mutex _starDataPoolMutex;
+    int _nStreamingJobs = 0;
+    std::mutex _streamingJobsMutex;
+    std::condition_variable _streamingJobsDone;
     std::unique_ptr<OctreeCuller> _culler;
     std::stack<int> _freeSpotsInBuffer;
     std::set<int> _removedKeysInPrevCall;
@@ -374,7 +502,7 @@ private:
     bool _useVBO = false;
     bool _streamOctree = false;
     bool _datasetFitInMemory = false;
-    long long _cpuRamBudget = 0;
+    std::atomic<long long> _cpuRamBudget = 0;
     long long _maxCpuRamBudget = 0;
     unsigned long long _parentNodeOfCamera = 8;
     std::string _streamFolderPath;
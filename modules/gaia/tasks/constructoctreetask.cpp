@@ -31,7 +31,12 @@
 #include <ghoul/filesystem/directory.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
 #include <fstream>
+#include <numeric>
 #include <thread>
 
 namespace {
@@ -40,6 +45,8 @@ namespace {
     constexpr const char* KeyMaxDist = "MaxDist";
     constexpr const char* KeyMaxStarsPerNode = "MaxStarsPerNode";
     constexpr const char* KeySingleFileInput = "SingleFileInput";
+    constexpr const char* KeyThreadsToUse = "ThreadsToUse";
+    constexpr const char* KeyMemoryBudget = "MemoryBudget";
 
     constexpr const char* KeyFilterPosX = "FilterPosX";
     constexpr const char* KeyFilterPosY = "FilterPosY";
@@ -67,6 +74,21 @@ namespace {
     constexpr const char* KeyFilterRvError = "FilterRvError";
 
     constexpr const char* _loggerCat = "ConstructOctreeTask";
+
+    // [MB]
+    constexpr const size_t DefaultMemoryBudget = 4096;
+
+    // Number of stars that are read from or written to files at once
+    constexpr const size_t StarsPerRead = 1 << 16;
+
+    // Estimates the number of bytes that are needed for a branch containing nStars
+    // stars while it is constructed. Every star is stored with its magnitude order in a
+    // leaf, and the vectors might hold up to twice the memory that they use
+    size_t estimatedBranchSize(size_t nStars, size_t nRenderValues) {
+        const size_t bytesPerStar =
+            nRenderValues * sizeof(float) + sizeof(std::pair<float, size_t>);
+        return 2 * nStars * bytesPerStar;
+    }
 } // namespace
 
 namespace openspace {
@@ -93,6 +115,26 @@ ConstructOctreeTask::ConstructOctreeTask(const ghoul::Dictionary& dictionary) {
         _singleFileInput = dictionary.value<bool>(KeySingleFileInput);
     }
 
+    _threadsToUse = std::max(std::thread::hardware_concurrency(), 1u);
+    if (dictionary.hasKey(KeyThreadsToUse)) {
+        // Clamp before the conversion as casting a negative value is undefined
+        const double threadsToUse = dictionary.value<double>(KeyThreadsToUse);
+        if (threadsToUse < 1.0) {
+            LINFO(fmt::format(
+                "User defined ThreadsToUse was: {}. Will be set to 1", threadsToUse
+            ));
+        }
+        _threadsToUse = static_cast<size_t>(std::max(threadsToUse, 1.0));
+    }
+
+    size_t memoryBudget = DefaultMemoryBudget;
+    if (dictionary.hasKey(KeyMemoryBudget)) {
+        memoryBudget = static_cast<size_t>(
+            std::max(dictionary.value<double>(KeyMemoryBudget), 1.0)
+        );
+    }
+    _memoryBudget = memoryBudget * 1024 * 1024;
+
     _octreeManager = std::make_shared<OctreeManager>();
     _indexOctreeManager = std::make_shared<OctreeManager>();
 
@@ -293,7 +335,7 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
             std::vector<float> renderValues(first, first + RENDER_VALUES);
 
             // Filter data by parameters.
-            if (checkAllFilters(filterValues)) {
+            if (checkAllFilters(filterValues.data())) {
                 nFilteredStars++;
                 continue;
             }
@@ -334,153 +376,145 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
 void ConstructOctreeTask::constructOctreeFromFolder(
                                            const Task::ProgressCallback& progressCallback)
 {
-    int32_t nStars = 0;
-    int32_t nValuesPerStar = 0;
-    size_t nFilteredStars = 0;
-    //float maxRadius = 0.0;
-    //int starsOutside10 = 0;
-    //int starsOutside25 = 0;
-    //int starsOutside50 = 0;
-    //int starsOutside75 = 0;
-    //int starsOutside100 = 0;
-    //int starsOutside200 = 0;
-    //int starsOutside300 = 0;
-    //int starsOutside400 = 0;
-    //int starsOutside500 = 0;
-    //int starsOutside750 = 0;
-    //int starsOutside1000 = 0;
-    //int starsOutside1500 = 0;
-    //int starsOutside2000 = 0;
-    //int starsOutside5000 = 0;
-
     ghoul::filesystem::Directory currentDir(_inFileOrFolderPath);
     std::vector<std::string> allInputFiles = currentDir.readFiles();
-    std::vector<float> filterValues;
-    auto writeThreads = std::vector<std::thread>(8);
 
     _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
 
-    float processOneFile = 1.f / allInputFiles.size();
-
     LINFO(fmt::format(
         "MAX DIST: {} - MAX STARS PER NODE: {}",
         _indexOctreeManager->maxDist(), _indexOctreeManager->maxStarsPerNode()
     ));
 
-    for (size_t idx = 0; idx < allInputFiles.size(); ++idx) {
-        std::string inFilePath = allInputFiles[idx];
-        int nStarsInfile = 0;
+    // Reading the files takes the first half of the progress
+    std::array<BranchInput, 8> branches = partitionStars(
+        allInputFiles,
+        [&progressCallback](float progress) { progressCallback(0.5f * progress); }
+    );
 
-        LINFO("Reading data file: " + inFilePath);
+    // The branches are independent of each other, so they are constructed concurrently
+    // in separate Octrees. The largest branches are started first, and a branch is only
+    // started if its estimated size fits in the memory budget next to the running ones.
+    // A branch that does not fit at all is constructed on its own
+    std::vector<size_t> pendingBranches(branches.size());
+    std::iota(pendingBranches.begin(), pendingBranches.end(), 0);
+    std::stable_sort(
+        pendingBranches.begin(),
+        pendingBranches.end(),
+        [&branches](size_t lhs, size_t rhs) {
+            return branches[lhs].nStars > branches[rhs].nStars;
+        }
+    );
 
-        std::ifstream inFileStream(inFilePath, std::ifstream::binary);
-        if (inFileStream.good()) {
-            inFileStream.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
-            filterValues.resize(nValuesPerStar, 0.f);
+    size_t memoryInUse = 0;
+    for (const BranchInput& branch : branches) {
+        memoryInUse += branch.renderValues.size() * sizeof(float);
+    }
+    size_t nRunningBranches = 0;
+    size_t nFinishedBranches = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable condition;
 
-            while (inFileStream.read(
-                reinterpret_cast<char*>(filterValues.data()),
-                nValuesPerStar * sizeof(filterValues[0])
-            ))
+    auto constructBranches = [&]() {
+        while (true) {
+            size_t branchIndex = 0;
+            size_t estimatedSize = 0;
             {
-                // Filter data by parameters.
-                if (checkAllFilters(filterValues)) {
-                    nFilteredStars++;
-                    continue;
+                std::unique_lock lock(mutex);
+                auto next = pendingBranches.end();
+                condition.wait(lock, [&]() {
+                    next = std::find_if(
+                        pendingBranches.begin(),
+                        pendingBranches.end(),
+                        [&](size_t i) {
+                            const size_t size = estimatedBranchSize(
+                                branches[i].nStars,
+                                RENDER_VALUES
+                            );
+                            return nRunningBranches == 0 ||
+                                memoryInUse + size <= _memoryBudget;
+                        }
+                    );
+                    return pendingBranches.empty() || next != pendingBranches.end();
+                });
+                if (pendingBranches.empty()) {
+                    return;
                 }
-                // Generate a 50/12,5 dataset (gMag <=13/>13).
-                //if ((filterStar(glm::vec2(20.0), filterValues[3], 20.f)) ||
-                //    (filterStar(glm::vec2(0.0), filterValues[16])) ||
-                //    (filterValues[3] > 13.0 && filterValues[17] > 0.125) ||
-                //    (filterValues[3] <= 13.0 && filterValues[17] > 0.5)) {
-                //    nFilteredStars++;
-                //    continue;
-                //}
-
-                // If all filters passed then insert render values into Octree.
-                std::vector<float> renderValues(
-                    filterValues.begin(),
-                    filterValues.begin() + RENDER_VALUES
-                );
 
-                _indexOctreeManager->insert(renderValues);
-                nStarsInfile++;
-
-                //float maxVal = fmax(fmax(fabs(renderValues[0]), fabs(renderValues[1])),
-                //    fabs(renderValues[2]));
-                //if (maxVal > maxRadius) maxRadius = maxVal;
-                //// Calculate how many stars are outside of different thresholds.
-                //if (maxVal > 10) starsOutside10++;
-                //if (maxVal > 25) starsOutside25++;
-                //if (maxVal > 50) starsOutside50++;
-                //if (maxVal > 75) starsOutside75++;
-                //if (maxVal > 100) starsOutside100++;
-                //if (maxVal > 200) starsOutside200++;
-                //if (maxVal > 300) starsOutside300++;
-                //if (maxVal > 400) starsOutside400++;
-                //if (maxVal > 500) starsOutside500++;
-                //if (maxVal > 750) starsOutside750++;
-                //if (maxVal > 1000) starsOutside1000++;
-                //if (maxVal > 1500) starsOutside1500++;
-                //if (maxVal > 2000) starsOutside2000++;
-                //if (maxVal > 5000) starsOutside5000++;
+                branchIndex = *next;
+                pendingBranches.erase(next);
+                estimatedSize = estimatedBranchSize(
+                    branches[branchIndex].nStars,
+                    RENDER_VALUES
+                );
+                memoryInUse += estimatedSize;
+                nRunningBranches++;
             }
-            inFileStream.close();
-        }
-        else {
-            LERROR(fmt::format(
-                "Error opening file '{}' for loading preprocessed file!", inFilePath
-            ));
-        }
 
-        // Slice LOD data.
-        LINFO("Slicing LOD data!");
-        _indexOctreeManager->sliceLodData(idx);
+            // The render values kept in memory are freed by the construction
+            const size_t inputSize =
+                branches[branchIndex].renderValues.size() * sizeof(float);
+            try {
+                constructBranch(branchIndex, branches[branchIndex]);
+            }
+            catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
 
-        progressCallback((idx + 1) * processOneFile);
-        nStars += nStarsInfile;
+            {
+                std::lock_guard lock(mutex);
+                memoryInUse -= estimatedSize + inputSize;
+                nRunningBranches--;
+                nFinishedBranches++;
+            }
+            condition.notify_all();
+        }
+    };
 
-        LINFO(fmt::format("Writing {} stars to octree files!", nStarsInfile));
-        LINFO(fmt::format(
-            "Number leaf nodes: {}\n Number inner nodes: {}\n Total depth of tree: {}",
-            _indexOctreeManager->numLeafNodes(),
-            _indexOctreeManager->numInnerNodes(),
-            _indexOctreeManager->totalDepth()
-        ));
+    const size_t nThreads = std::min(_threadsToUse, branches.size());
+    LINFO(fmt::format("Constructing the octree branches with {} threads", nThreads));
+    std::vector<std::thread> constructThreads;
+    for (size_t i = 0; i < nThreads; ++i) {
+        constructThreads.emplace_back(constructBranches);
+    }
 
-        // Write to 8 separate files in a separate thread. Data will be cleared after it
-        // has been written. Store joinable thread for later sync.
-        std::thread t(
-            &OctreeManager::writeToMultipleFiles,
-            _indexOctreeManager,
-            _outFileOrFolderPath,
-            idx
-        );
-        writeThreads[idx] = std::move(t);
+    // Report the progress from this thread, as the callback is not thread-safe
+    {
+        std::unique_lock lock(mutex);
+        size_t nReported = 0;
+        while (nReported < branches.size()) {
+            condition.wait(lock, [&]() { return nFinishedBranches > nReported; });
+            nReported = nFinishedBranches;
+            lock.unlock();
+            progressCallback(0.5f + 0.5f * nReported / branches.size());
+            lock.lock();
+        }
+    }
+    for (std::thread& t : constructThreads) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
     }
 
+    size_t nStars = 0;
+    for (const BranchInput& branch : branches) {
+        nStars += branch.nStars;
+    }
     LINFO(fmt::format(
         "A total of {} stars were read from files and distributed into {} total nodes",
         nStars, _indexOctreeManager->totalNodes()
     ));
-    LINFO(std::to_string(nFilteredStars) + " stars were filtered");
-
-    //LINFO("Max radius of dataset is: " + std::to_string(maxRadius) +
-    //    "\n Number of stars outside of:" +
-    //    " - 10kPc is " + std::to_string(starsOutside10) + "\n" +
-    //    " - 25kPc is " + std::to_string(starsOutside25) + "\n" +
-    //    " - 50kPc is " + std::to_string(starsOutside50) + "\n" +
-    //    " - 75kPc is " + std::to_string(starsOutside75) + "\n" +
-    //    " - 100kPc is " + std::to_string(starsOutside100) + "\n" +
-    //    " - 200kPc is " + std::to_string(starsOutside200) + "\n" +
-    //    " - 300kPc is " + std::to_string(starsOutside300) + "\n" +
-    //    " - 400kPc is " + std::to_string(starsOutside400) + "\n" +
-    //    " - 500kPc is " + std::to_string(starsOutside500) + "\n" +
-    //    " - 750kPc is " + std::to_string(starsOutside750) + "\n" +
-    //    " - 1000kPc is " + std::to_string(starsOutside1000) + "\n" +
-    //    " - 1500kPc is " + std::to_string(starsOutside1500) + "\n" +
-    //    " - 2000kPc is " + std::to_string(starsOutside2000) + "\n" +
-    //    " - 5000kPc is " + std::to_string(starsOutside5000));
+    LINFO(fmt::format(
+        "Number leaf nodes: {}\n Number inner nodes: {}\n Total depth of tree: {}",
+        _indexOctreeManager->numLeafNodes(),
+        _indexOctreeManager->numInnerNodes(),
+        _indexOctreeManager->totalDepth()
+    ));
 
     // Write index file of Octree structure.
     std::string indexFileOutPath = _outFileOrFolderPath + "index.bin";
@@ -496,14 +530,180 @@ void ConstructOctreeTask::constructOctreeFromFolder(
             "Error opening file: {} as index output file.", indexFileOutPath
         ));
     }
+}
+
+std::array<ConstructOctreeTask::BranchInput, 8> ConstructOctreeTask::partitionStars(
+                                               const std::vector<std::string>& inputFiles,
+                                           const Task::ProgressCallback& progressCallback)
+{
+    const size_t nRenderValues = static_cast<size_t>(RENDER_VALUES);
+
+    std::array<BranchInput, 8> branches;
+    for (size_t i = 0; i < branches.size(); ++i) {
+        branches[i].spillPath = fmt::format("{}branch_{}.spill", _outFileOrFolderPath, i);
+        // Remove leftovers of a previous run that was aborted
+        std::filesystem::remove(branches[i].spillPath);
+    }
+
+    size_t bufferedBytes = 0;
+    bool hasSpilled = false;
+    auto spill = [&]() {
+        for (BranchInput& branch : branches) {
+            if (branch.renderValues.empty()) {
+                continue;
+            }
+            std::ofstream spillStream(
+                branch.spillPath,
+                std::ofstream::binary | std::ofstream::app
+            );
+            spillStream.write(
+                reinterpret_cast<const char*>(branch.renderValues.data()),
+                branch.renderValues.size() * sizeof(float)
+            );
+            if (!spillStream.good()) {
+                throw ghoul::RuntimeError(
+                    fmt::format("Error writing spill file '{}'", branch.spillPath),
+                    "ConstructOctreeTask"
+                );
+            }
+            branch.nSpilledStars += branch.renderValues.size() / nRenderValues;
+            branch.renderValues.clear();
+            branch.renderValues.shrink_to_fit();
+        }
+        bufferedBytes = 0;
+        hasSpilled = true;
+    };
+
+    size_t nFilteredStars = 0;
+    std::vector<float> values;
+    for (size_t idx = 0; idx < inputFiles.size(); ++idx) {
+        const std::string& inFilePath = inputFiles[idx];
+        LINFO("Reading data file: " + inFilePath);
+
+        std::ifstream inFileStream(inFilePath, std::ifstream::binary);
+        int32_t nValuesPerStar = 0;
+        inFileStream.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
+        if (!inFileStream.good()) {
+            LERROR(fmt::format(
+                "Error opening file '{}' for loading preprocessed file!", inFilePath
+            ));
+            continue;
+        }
+        if (nValuesPerStar < RENDER_VALUES) {
+            LERROR(fmt::format(
+                "File '{}' has {} values per star but at least {} are needed",
+                inFilePath, nValuesPerStar, RENDER_VALUES
+            ));
+            continue;
+        }
+
+        // Read many stars at once instead of one at a time
+        const size_t starSize = static_cast<size_t>(nValuesPerStar);
+        values.resize(StarsPerRead * starSize);
+        while (inFileStream) {
+            inFileStream.read(
+                reinterpret_cast<char*>(values.data()),
+                values.size() * sizeof(float)
+            );
+            const size_t nStarsRead =
+                static_cast<size_t>(inFileStream.gcount()) / (starSize * sizeof(float));
+
+            for (size_t i = 0; i < nStarsRead; ++i) {
+                const float* star = values.data() + i * starSize;
+
+                // Filter data by parameters.
+                if (checkAllFilters(star)) {
+                    nFilteredStars++;
+                    continue;
+                }
+
+                const size_t branchIndex =
+                    _indexOctreeManager->branchIndex(star[0], star[1], star[2]);
+                BranchInput& branch = branches[branchIndex];
+                branch.renderValues.insert(
+                    branch.renderValues.end(),
+                    star,
+                    star + nRenderValues
+                );
+                branch.nStars++;
+
+                // The vectors might hold up to twice the memory that they use
+                bufferedBytes += nRenderValues * sizeof(float);
+                if (2 * bufferedBytes > _memoryBudget) {
+                    spill();
+                }
+            }
+        }
+
+        progressCallback(static_cast<float>(idx + 1) / inputFiles.size());
+    }
 
-    // Make sure all threads are done.
-    for (int i = 0; i < 8; ++i) {
-        writeThreads[i].join();
+    if (hasSpilled) {
+        // Start the construction with the whole memory budget available
+        spill();
     }
+
+    LINFO(std::to_string(nFilteredStars) + " stars were filtered");
+    return branches;
 }
 
-bool ConstructOctreeTask::checkAllFilters(const std::vector<float>& filterValues) {
+void ConstructOctreeTask::constructBranch(size_t branchIndex, BranchInput& input) {
+    const size_t nRenderValues = static_cast<size_t>(RENDER_VALUES);
+
+    OctreeManager branchOctree;
+    branchOctree.initOctree(0, _maxDist, _maxStarsPerNode);
+
+    std::vector<float> renderValues(nRenderValues);
+    auto insertStars = [&](const float* values, size_t nStars) {
+        for (size_t i = 0; i < nStars; ++i) {
+            const float* star = values + i * nRenderValues;
+            std::copy(star, star + nRenderValues, renderValues.begin());
+            branchOctree.insert(renderValues);
+        }
+    };
+
+    // The spilled stars were read before the ones in memory, so they are inserted first
+    // to keep the order of the input files, which makes the output deterministic
+    if (input.nSpilledStars > 0) {
+        std::ifstream spillStream(input.spillPath, std::ifstream::binary);
+        std::vector<float> values(StarsPerRead * nRenderValues);
+        size_t nRemaining = input.nSpilledStars;
+        while (nRemaining > 0) {
+            const size_t nStars = std::min(nRemaining, StarsPerRead);
+            spillStream.read(
+                reinterpret_cast<char*>(values.data()),
+                nStars * nRenderValues * sizeof(float)
+            );
+            if (!spillStream.good()) {
+                throw ghoul::RuntimeError(
+                    fmt::format("Error reading spill file '{}'", input.spillPath),
+                    "ConstructOctreeTask"
+                );
+            }
+            insertStars(values.data(), nStars);
+            nRemaining -= nStars;
+        }
+        spillStream.close();
+        std::filesystem::remove(input.spillPath);
+    }
+    insertStars(input.renderValues.data(), input.renderValues.size() / nRenderValues);
+    input.renderValues.clear();
+    input.renderValues.shrink_to_fit();
+
+    // Slice LOD data.
+    branchOctree.sliceLodData(branchIndex);
+
+    LINFO(fmt::format(
+        "Writing {} stars of branch {} to octree files!", input.nStars, branchIndex
+    ));
+    // Data will be cleared after it has been written.
+    branchOctree.writeToMultipleFiles(_outFileOrFolderPath, branchIndex);
+
+    std::lock_guard lock(_indexOctreeMutex);
+    _indexOctreeManager->mergeBranch(branchOctree, branchIndex);
+}
+
+bool ConstructOctreeTask::checkAllFilters(const float* filterValues) {
     // Return true if star is caught in any filter.
     return (_filterPosX && filterStar(_posX, filterValues[0])) ||
         (_filterPosY && filterStar(_posY, filterValues[1])) ||
@@ -585,6 +785,23 @@ documentation::Documentation ConstructOctreeTask::Documentation() {
                 "binary file with the full Octree. If false then task will read all "
                 "files in specified folder and output multiple files for the Octree."
             },
+            {
+                KeyThreadsToUse,
+                new IntVerifier,
+                Optional::Yes,
+                "The number of threads that construct the branches of the Octree "
+                "concurrently when reading from a folder. At most 8 threads are used, "
+                "one per branch. Defaults to the number of hardware threads."
+            },
+            {
+                KeyMemoryBudget,
+                new IntVerifier,
+                Optional::Yes,
+                "The approximate amount of memory (in MB) that is used when reading from "
+                "a folder. Star data that does not fit is temporarily spilled to files "
+                "in the output folder, and branches are only constructed concurrently "
+                "while their estimated sizes fit. Defaults to 4096 MB."
+            },
             {
                 KeyFilterPosX,
                 new Vector2Verifier<double>,
@@ -29,6 +29,8 @@
 
 #include <modules/gaia/rendering/octreeculler.h>
 #include <modules/gaia/rendering/octreemanager.h>
+#include <array>
+#include <mutex>
 
 namespace openspace {
 
@@ -46,6 +48,16 @@ public:
 private:
     const int RENDER_VALUES = 8;
 
+    /// The render values of the stars that belong to one branch of the Octree
+    struct BranchInput {
+        /// The render values that are kept in memory
+        std::vector<float> renderValues;
+        /// The file to which render values are spilled when they exceed the budget
+        std::string spillPath;
+        size_t nSpilledStars = 0;
+        size_t nStars = 0;
+    };
+
     /**
      * Reads a single binary file with preprocessed star data and insert the render values
      * into an octree structure (if star data passed all defined filters).
@@ -57,18 +69,36 @@ private:
      *  Reads binary star data from 8 preprocessed files (one per branch) in specified
      * folder, prepared by ReadFitsTask, and inserts star render data into an octree
      * (if star data passed all defined filters).
+     * The 8 branches of the octree are constructed concurrently, as long as their
+     * estimated sizes fit in the memory budget.
      * Stores octree structure in a binary index file and stores all render data
      * separate files, one file per node in the octree.
      */
     void constructOctreeFromFolder(const Task::ProgressCallback& progressCallback);
 
+    /**
+     * Reads all \p inputFiles, filters the stars and partitions their render values into
+     * the 8 branches of the Octree, keeping the order in which they were read. Whenever
+     * the values kept in memory exceed the memory budget, they are appended to one spill
+     * file per branch in the output folder.
+     */
+    std::array<BranchInput, 8> partitionStars(const std::vector<std::string>& inputFiles,
+        const Task::ProgressCallback& progressCallback);
+
+    /**
+     * Inserts the stars of \p input into a separate Octree, writes the nodes of its
+     * branch \p branchIndex to files and merges its structure into the index Octree.
+     * The spill file and the render values of \p input are freed afterwards.
+     */
+    void constructBranch(size_t branchIndex, BranchInput& input);
+
     /**
      * Checks all defined filter ranges and \returns true if any of the corresponding
      * <code>filterValues</code> are outside of the defined range.
      * \returns false if value should be inserted into Octree.
      * \param filterValues are all read filter values in binary file.
      */
-    bool checkAllFilters(const std::vector<float>& filterValues);
+    bool checkAllFilters(const float* filterValues);
 
     /**
      * \returns true if star should be filtered away and false if all filters passed.
@@ -83,9 +113,12 @@ private:
     int _maxDist = 0;
     int _maxStarsPerNode = 0;
     bool _singleFileInput = false;
+    size_t _threadsToUse = 1;
+    size_t _memoryBudget = 0;
 
     std::shared_ptr<OctreeManager> _octreeManager;
     std::shared_ptr<OctreeManager> _indexOctreeManager;
+    std::mutex _indexOctreeMutex;
 
     // Filter params
     glm::vec2 _posX = glm::vec2(0.f);
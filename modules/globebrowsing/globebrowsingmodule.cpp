@@ -26,6 +26,7 @@
 
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/dashboarditemglobelocation.h>
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/gdalwrapper.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/globelabelscomponent.h>
@@ -107,6 +108,29 @@ namespace {
         "The maximum size of the MemoryAwareTileCache, on the CPU and GPU."
     };
 
+    constexpr openspace::properties::Property::PropertyInfo TileDiskCacheEnabledInfo = {
+        "TileDiskCacheEnabled",
+        "Tile Disk Cache Enabled",
+        "Determines whether decoded tiles are stored on disk, so that they do not have "
+        "to be read and preprocessed again from their original source in later "
+        "sessions. Changing the value of this property will not affect already created "
+        "layers."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo TileDiskCacheLocationInfo = {
+        "TileDiskCacheLocation",
+        "Tile Disk Cache Location",
+        "The location of the cache folder for decoded tiles. Changing the value of this "
+        "property will only have an effect after a restart."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo TileDiskCacheSizeInfo = {
+        "TileDiskCacheSize",
+        "Tile Disk Cache Size",
+        "The maximum size (in MB) of the cache for decoded tiles on disk. If the cache "
+        "grows larger, the least recently used tiles are removed."
+    };
+
 
     openspace::GlobeBrowsingModule::Capabilities
     parseSubDatasets(char** subDatasets, int nSubdatasets)
@@ -176,6 +200,15 @@ namespace {
         // [[codegen::verbatim(TileCacheSizeInfo.description)]]
         std::optional<int> tileCacheSize;
 
+        // [[codegen::verbatim(TileDiskCacheEnabledInfo.description)]]
+        std::optional<bool> tileDiskCacheEnabled;
+
+        // [[codegen::verbatim(TileDiskCacheLocationInfo.description)]]
+        std::optional<std::string> tileDiskCacheLocation;
+
+        // [[codegen::verbatim(TileDiskCacheSizeInfo.description)]]
+        std::optional<int> tileDiskCacheSize;
+
         // If you know what you are doing and you have WMS caching *disabled* but offline
         // mode *enabled*, you can set this value to 'true' to silence a warning that you
         // would otherwise get at startup
@@ -193,12 +226,24 @@ GlobeBrowsingModule::GlobeBrowsingModule()
     , _wmsCacheLocation(WMSCacheLocationInfo, "${BASE}/cache_gdal")
     , _wmsCacheSizeMB(WMSCacheSizeInfo, 1024)
     , _tileCacheSizeMB(TileCacheSizeInfo, 1024)
+    , _tileDiskCacheEnabled(TileDiskCacheEnabledInfo, false)
+    , _tileDiskCacheLocation(TileDiskCacheLocationInfo, "${BASE}/cache_tiles")
+    , _tileDiskCacheSizeMB(TileDiskCacheSizeInfo, 4096)
 {
     addProperty(_wmsCacheEnabled);
     addProperty(_offlineMode);
     addProperty(_wmsCacheLocation);
     addProperty(_wmsCacheSizeMB);
     addProperty(_tileCacheSizeMB);
+    addProperty(_tileDiskCacheEnabled);
+    addProperty(_tileDiskCacheLocation);
+
+    _tileDiskCacheSizeMB.onChange([this]() {
+        if (_tileDiskCache) {
+            _tileDiskCache->setMaximumSize(uint64_t(_tileDiskCacheSizeMB) * 1024 * 1024);
+        }
+    });
+    addProperty(_tileDiskCacheSizeMB);
 }
 
 void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
@@ -210,6 +255,9 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
     _wmsCacheLocation = p.cacheLocation.value_or(_wmsCacheLocation);
     _wmsCacheSizeMB = p.wmsCacheSize.value_or(_wmsCacheSizeMB);
     _tileCacheSizeMB = p.tileCacheSize.value_or(_tileCacheSizeMB);
+    _tileDiskCacheEnabled = p.tileDiskCacheEnabled.value_or(_tileDiskCacheEnabled);
+    _tileDiskCacheLocation = p.tileDiskCacheLocation.value_or(_tileDiskCacheLocation);
+    _tileDiskCacheSizeMB = p.tileDiskCacheSize.value_or(_tileDiskCacheSizeMB);
     const bool noWarning = p.noWarning.value_or(false);
 
     if (!_wmsCacheEnabled && _offlineMode && !noWarning) {
@@ -230,6 +278,14 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
         _tileCache = std::make_unique<cache::MemoryAwareTileCache>(_tileCacheSizeMB);
         addPropertySubOwner(_tileCache.get());
 
+        if (_tileDiskCacheEnabled) {
+            _tileDiskCache = std::make_unique<cache::DiskTileCache>(
+                absPath(_tileDiskCacheLocation),
+                uint64_t(_tileDiskCacheSizeMB) * 1024 * 1024
+            );
+            addPropertySubOwner(_tileDiskCache.get());
+        }
+
         tileprovider::initializeDefaultTile();
 
         // Convert from MB to Bytes
@@ -252,6 +308,9 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
         ZoneScopedN("GlobeBrowsingModule")
 
         _tileCache->update();
+        if (_tileDiskCache) {
+            _tileDiskCache->update();
+        }
     });
 
     // Deinitialize
@@ -321,6 +380,10 @@ globebrowsing::cache::MemoryAwareTileCache* GlobeBrowsingModule::tileCache() {
     return _tileCache.get();
 }
 
+globebrowsing::cache::DiskTileCache* GlobeBrowsingModule::diskTileCache() {
+    return _tileDiskCache.get();
+}
+
 scripting::LuaLibrary GlobeBrowsingModule::luaLibrary() const {
     std::string listLayerGroups = layerGroupNamesList();
 
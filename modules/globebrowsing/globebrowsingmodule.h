@@ -40,7 +40,10 @@ namespace openspace::globebrowsing {
     struct Geodetic2;
     struct Geodetic3;
 
-    namespace cache { class MemoryAwareTileCache; }
+    namespace cache {
+        class DiskTileCache;
+        class MemoryAwareTileCache;
+    } // namespace cache
 } // namespace openspace::globebrowsing
 
 namespace openspace {
@@ -64,6 +67,12 @@ public:
         double latitude, double longitude, double altitude);
 
     globebrowsing::cache::MemoryAwareTileCache* tileCache();
+
+    /**
+     * Returns the persistent cache for decoded tiles, or \c nullptr if the disk cache
+     * is disabled.
+     */
+    globebrowsing::cache::DiskTileCache* diskTileCache();
     scripting::LuaLibrary luaLibrary() const override;
     std::vector<documentation::Documentation> documentations() const override;
 
@@ -127,8 +136,12 @@ private:
     properties::StringProperty _wmsCacheLocation;
     properties::UIntProperty _wmsCacheSizeMB;
     properties::UIntProperty _tileCacheSizeMB;
+    properties::BoolProperty _tileDiskCacheEnabled;
+    properties::StringProperty _tileDiskCacheLocation;
+    properties::UIntProperty _tileDiskCacheSizeMB;
 
     std::unique_ptr<globebrowsing::cache::MemoryAwareTileCache> _tileCache;
+    std::unique_ptr<globebrowsing::cache::DiskTileCache> _tileDiskCache;
 
     // name -> capabilities
     std::map<std::string, std::future<Capabilities>> _inFlightCapabilitiesMap;
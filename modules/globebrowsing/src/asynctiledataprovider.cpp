@@ -40,10 +40,18 @@ namespace {
 } // namespace
 
 AsyncTileDataProvider::AsyncTileDataProvider(std::string name,
-                                    std::unique_ptr<RawTileDataReader> rawTileDataReader)
+                                    std::unique_ptr<RawTileDataReader> rawTileDataReader,
+                                    cache::DiskTileCache* diskCache, uint64_t contentHash,
+                                    std::shared_ptr<ThreadPool> threadPool,
+                                    TileCompression compression)
     : _name(std::move(name))
     , _rawTileDataReader(std::move(rawTileDataReader))
-    , _concurrentJobManager(LRUThreadPool<TileIndex::TileHashKey>(1, 10))
+    , _diskCache(diskCache)
+    , _contentHash(contentHash)
+    , _compression(compression)
+    , _concurrentJobManager(
+        threadPool ? std::move(threadPool) : std::make_shared<ThreadPool>(1, 10)
+    )
 {
     ZoneScoped
 
@@ -59,41 +67,117 @@ const RawTileDataReader& AsyncTileDataProvider::rawTileDataReader() const {
 bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex) {
     ZoneScoped
 
+    _requestedTiles.insert(tileIndex.hashKey());
     if (_resetMode == ResetMode::ShouldNotReset && satisfiesEnqueueCriteria(tileIndex)) {
-        auto job = std::make_unique<TileLoadJob>(*_rawTileDataReader, tileIndex);
-        _concurrentJobManager.enqueueJob(std::move(job), tileIndex.hashKey());
+        // The disk cache is consulted on the worker thread before falling back to the
+        // GDAL read, so that the render thread never blocks on file access
+        auto job = std::make_unique<TileLoadJob>(
+            _rawTileDataReader,
+            tileIndex,
+            _diskCache,
+            _contentHash,
+            _compression
+        );
+        _concurrentJobManager.enqueueJob(
+            std::move(job),
+            tileIndex.hashKey(),
+            tilePriority(tileIndex)
+        );
         _enqueuedTileRequests.insert(tileIndex.hashKey());
         return true;
     }
     return false;
 }
 
-void AsyncTileDataProvider::clearTiles() {
-    std::optional<RawTile> finishedJob = popFinishedRawTile();
-    while (finishedJob) {
-        finishedJob = popFinishedRawTile();
+void AsyncTileDataProvider::prioritizeTileIO(
+                                         std::shared_ptr<const TilePriorities> priorities,
+                                                                     float priorityOffset)
+{
+    ZoneScoped
+
+    _priorities = std::move(priorities);
+    _priorityOffset = priorityOffset;
+
+    using K = TileIndex::TileHashKey;
+    const std::vector<K> cancelled = _concurrentJobManager.prioritizeJobs(
+        [this](const K& key, float priority) -> std::optional<float> {
+            if (_requestedTiles.find(key) == _requestedTiles.end()) {
+                // Nobody asked for this tile since the last frame
+                return std::nullopt;
+            }
+            const auto it = _priorities->find(key);
+            return it != _priorities->end() ? it->second + _priorityOffset : priority;
+        }
+    );
+    for (const K& key : cancelled) {
+        _enqueuedTileRequests.erase(key);
+    }
+    _requestedTiles.clear();
+}
+
+float AsyncTileDataProvider::tilePriority(TileIndex tileIndex) const {
+    if (!_priorities) {
+        return _priorityOffset;
+    }
+
+    // Tiles that were not prioritized yet usually belong to chunks that were just split,
+    // so they inherit the priority of their closest prioritized ancestor
+    while (true) {
+        const auto it = _priorities->find(tileIndex.hashKey());
+        if (it != _priorities->end()) {
+            return it->second + _priorityOffset;
+        }
+        if (tileIndex.level == 0) {
+            return _priorityOffset;
+        }
+        tileIndex = TileIndex(
+            tileIndex.x / 2,
+            tileIndex.y / 2,
+            static_cast<uint8_t>(tileIndex.level - 1)
+        );
     }
 }
 
+void AsyncTileDataProvider::clearTiles() {
+    popFinishedRawTiles();
+}
+
 std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
     if (_concurrentJobManager.numFinishedJobs() > 0) {
         // Now the tile load job looses ownerwhip of the data pointer
-        RawTile product = _concurrentJobManager.popFinishedJob()->product();
+        return handleFinishedTile(_concurrentJobManager.popFinishedJob()->product());
+    }
+    else {
+        return std::nullopt;
+    }
+}
 
-        const TileIndex::TileHashKey key = product.tileIndex.hashKey();
-        // No longer enqueued. Remove from set of enqueued tiles
-        _enqueuedTileRequests.erase(key);
-        // Pbo is still mapped. Set the id for the raw tile
-        if (product.error != RawTile::ReadError::None) {
-            product.imageData = nullptr;
-            return std::nullopt;
-        }
+std::vector<RawTile> AsyncTileDataProvider::popFinishedRawTiles() {
+    std::vector<std::shared_ptr<Job<RawTile>>> jobs;
+    _concurrentJobManager.popFinishedJobs(jobs);
 
-        return product;
+    std::vector<RawTile> tiles;
+    tiles.reserve(jobs.size());
+    for (const std::shared_ptr<Job<RawTile>>& job : jobs) {
+        std::optional<RawTile> tile = handleFinishedTile(job->product());
+        if (tile) {
+            tiles.push_back(std::move(*tile));
+        }
     }
-    else {
+    return tiles;
+}
+
+std::optional<RawTile> AsyncTileDataProvider::handleFinishedTile(RawTile product) {
+    const TileIndex::TileHashKey key = product.tileIndex.hashKey();
+    // No longer enqueued. Remove from set of enqueued tiles
+    _enqueuedTileRequests.erase(key);
+    // Pbo is still mapped. Set the id for the raw tile
+    if (product.error != RawTile::ReadError::None) {
+        product.imageData = nullptr;
         return std::nullopt;
     }
+
+    return product;
 }
 
 bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex) {
@@ -28,14 +28,19 @@
 #include <modules/globebrowsing/src/prioritizingconcurrentjobmanager.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <ghoul/misc/boolean.h>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
+#include <unordered_set>
+#include <vector>
 
 namespace openspace::globebrowsing {
 
 struct RawTile;
+namespace cache { class DiskTileCache; }
 
 /**
  * The responsibility of this class is to enqueue tile requests and fetching finished
@@ -43,25 +48,60 @@ struct RawTile;
  */
 class AsyncTileDataProvider {
 public:
+    using ThreadPool =
+        PrioritizingConcurrentJobManager<RawTile, TileIndex::TileHashKey>::ThreadPool;
+
     /**
      * \param rawTileDataReader is the reader that will be used for the asynchronous
      * tile loading.
+     * \param diskCache is an optional persistent cache that is checked before a tile is
+     * read through the \p rawTileDataReader and that receives all tiles that were read
+     * \param contentHash identifies the tiles of this provider in the \p diskCache
+     * \param threadPool is the thread pool in which the tiles are read. It can be shared
+     * with other AsyncTileDataProviders. If it is <code>nullptr</code>, a thread pool
+     * with a single thread is created for this provider
+     * \param compression is the format into which the tiles are transcoded in the
+     * thread pool, if they are compressible
      */
     AsyncTileDataProvider(std::string name,
-        std::unique_ptr<RawTileDataReader> rawTileDataReader);
+        std::unique_ptr<RawTileDataReader> rawTileDataReader,
+        cache::DiskTileCache* diskCache = nullptr, uint64_t contentHash = 0,
+        std::shared_ptr<ThreadPool> threadPool = nullptr,
+        TileCompression compression = TileCompression::None);
 
     ~AsyncTileDataProvider();
 
     /**
-     * Creates a job which asynchronously loads a raw tile. This job is enqueued.
+     * Creates a job which asynchronously loads a raw tile. This job is enqueued with the
+     * priority that was last provided for the tile or its closest ancestor through
+     * <code>prioritizeTileIO</code>.
      */
     bool enqueueTileIO(const TileIndex& tileIndex);
 
+    /**
+     * Updates the priorities of all enqueued tile requests to the provided
+     * \p priorities. Tiles that are missing from the \p priorities keep their current
+     * priority. Requests for tiles that have not been requested through
+     * <code>enqueueTileIO</code> since the last call to this function are cancelled, as
+     * they are no longer needed. The \p priorities are retained to prioritize tiles
+     * that are enqueued until the next call. The \p priorityOffset is added to all
+     * priorities, which ranks the requests of this provider against the requests of
+     * other providers that share the same thread pool.
+     */
+    void prioritizeTileIO(std::shared_ptr<const TilePriorities> priorities,
+        float priorityOffset = 0.f);
+
     /**
      * Get one finished job.
      */
     std::optional<RawTile> popFinishedRawTile();
 
+    /**
+     * Get all finished jobs at once without taking any locks. Tiles that failed to load
+     * are discarded.
+     */
+    std::vector<RawTile> popFinishedRawTiles();
+
     void update();
     void reset();
     void prepareToBeDeleted();
@@ -95,20 +135,43 @@ protected:
 
     void clearTiles();
 
+    /**
+     * Marks the tile as no longer being enqueued and returns it, or returns
+     * <code>std::nullopt</code> if it could not be read.
+     */
+    std::optional<RawTile> handleFinishedTile(RawTile product);
+
     void endEnqueuedJobs();
 
     void performReset(ResetRawTileDataReader resetRawTileDataReader);
 
+    /**
+     * \returns the last provided priority for the tile <code>tileIndex</code> or its
+     *          closest ancestor, or 0 if neither has a priority. The priority offset
+     *          is added in either case
+     */
+    float tilePriority(TileIndex tileIndex) const;
+
 private:
     const std::string _name;
-    /// The reader used for asynchronous reading
-    std::unique_ptr<RawTileDataReader> _rawTileDataReader;
+    /// The reader used for asynchronous reading. It is shared with the TileLoadJobs,
+    /// which might outlive this object
+    std::shared_ptr<RawTileDataReader> _rawTileDataReader;
+
+    cache::DiskTileCache* _diskCache;
+    const uint64_t _contentHash;
+    const TileCompression _compression;
 
     PrioritizingConcurrentJobManager<RawTile, TileIndex::TileHashKey>
         _concurrentJobManager;
 
     std::set<TileIndex::TileHashKey> _enqueuedTileRequests;
 
+    /// All tiles that were requested since the last call to prioritizeTileIO
+    std::unordered_set<TileIndex::TileHashKey> _requestedTiles;
+    std::shared_ptr<const TilePriorities> _priorities;
+    float _priorityOffset = 0.f;
+
     ResetMode _resetMode = ResetMode::ShouldResetAllButRawTileDataReader;
     bool _shouldBeDeleted = false;
 };
@@ -0,0 +1,541 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/disktilecache.h>
+
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace {
+    constexpr const char* _loggerCat = "DiskTileCache";
+
+    constexpr const uint32_t FileMagic = 0x4344544F; // 'OTDC'
+    constexpr const uint32_t FileVersion = 1;
+    constexpr const size_t HeaderSize = 96;
+    constexpr const char* TileExtension = ".tile";
+    constexpr const char* TemporaryExtension = ".tmp";
+
+    constexpr openspace::properties::Property::PropertyInfo DiskUsageInfo = {
+        "DiskUsage",
+        "Disk usage (MB)",
+        "This value denotes the amount of disk space (in MB) that the cached tiles are "
+        "currently using."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo HitsInfo = {
+        "Hits",
+        "Hits",
+        "The number of tiles that were loaded from the disk cache in this session."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo MissesInfo = {
+        "Misses",
+        "Misses",
+        "The number of tiles that were requested from the disk cache in this session but "
+        "that had to be read from their original data source instead."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo AverageReadTimeInfo = {
+        "AverageReadTime",
+        "Average read time (ms)",
+        "The average time (in milliseconds) it took to load a tile from the disk cache."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo ClearDiskCacheInfo = {
+        "ClearDiskCache",
+        "Clear disk cache",
+        "Removes all tiles from the disk cache."
+    };
+
+    // The on-disk layout of a single tile. All values are stored in the native byte
+    // order, as the cache is never shared between machines:
+    //   0  uint32 magic           4  uint32 version        8  uint64 content hash
+    //  16  uint32 x              20  uint32 y             24  uint32 level
+    //  28  uint32 nValues        32  float[4] maxValues   48  float[4] minValues
+    //  64  uint8[4] hasMissing   72  uint64 data size     80  uint64 init data hash
+    //  96  image data
+    struct Header {
+        uint32_t magic = FileMagic;
+        uint32_t version = FileVersion;
+        uint64_t contentHash = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t level = 0;
+        uint32_t nValues = 0;
+        std::array<float, 4> maxValues = {};
+        std::array<float, 4> minValues = {};
+        std::array<uint8_t, 4> hasMissingData = {};
+        uint64_t dataSize = 0;
+        uint64_t initDataHash = 0;
+    };
+
+    template <typename T>
+    void store(std::array<char, HeaderSize>& buffer, size_t offset, const T& value) {
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void load(const std::array<char, HeaderSize>& buffer, size_t offset, T& value) {
+        std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    }
+
+    std::array<char, HeaderSize> serialize(const Header& h) {
+        std::array<char, HeaderSize> buffer = {};
+        store(buffer, 0, h.magic);
+        store(buffer, 4, h.version);
+        store(buffer, 8, h.contentHash);
+        store(buffer, 16, h.x);
+        store(buffer, 20, h.y);
+        store(buffer, 24, h.level);
+        store(buffer, 28, h.nValues);
+        store(buffer, 32, h.maxValues);
+        store(buffer, 48, h.minValues);
+        store(buffer, 64, h.hasMissingData);
+        store(buffer, 72, h.dataSize);
+        store(buffer, 80, h.initDataHash);
+        return buffer;
+    }
+
+    Header deserialize(const std::array<char, HeaderSize>& buffer) {
+        Header h;
+        load(buffer, 0, h.magic);
+        load(buffer, 4, h.version);
+        load(buffer, 8, h.contentHash);
+        load(buffer, 16, h.x);
+        load(buffer, 20, h.y);
+        load(buffer, 24, h.level);
+        load(buffer, 28, h.nValues);
+        load(buffer, 32, h.maxValues);
+        load(buffer, 48, h.minValues);
+        load(buffer, 64, h.hasMissingData);
+        load(buffer, 72, h.dataSize);
+        load(buffer, 80, h.initDataHash);
+        return h;
+    }
+
+    // 64-bit FNV-1a, which is stable across platforms and standard library versions in
+    // contrast to std::hash
+    struct Fnv1a {
+        template <typename T>
+        void add(const T& value) {
+            add(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void add(const char* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= static_cast<uint8_t>(data[i]);
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        uint64_t hash = 14695981039346656037ULL;
+    };
+
+    namespace gb = openspace::globebrowsing;
+
+    std::optional<gb::RawTile> readTile(const std::filesystem::path& path,
+                                        const gb::cache::DiskTileKey& key,
+                                        const gb::TileTextureInitData& initData)
+    {
+        std::ifstream file(path, std::ifstream::binary);
+        if (!file.good()) {
+            return std::nullopt;
+        }
+
+        std::array<char, HeaderSize> buffer;
+        file.read(buffer.data(), HeaderSize);
+        if (!file.good()) {
+            return std::nullopt;
+        }
+
+        const Header h = deserialize(buffer);
+        const bool isValid = h.magic == FileMagic && h.version == FileVersion &&
+            h.contentHash == key.contentHash && h.x == key.tileIndex.x &&
+            h.y == key.tileIndex.y && h.level == key.tileIndex.level &&
+            h.nValues <= 4 && h.dataSize == initData.totalNumBytes &&
+            h.initDataHash == initData.hashKey;
+        if (!isValid) {
+            return std::nullopt;
+        }
+
+        gb::RawTile tile;
+        tile.imageData = std::unique_ptr<std::byte[]>(new std::byte[h.dataSize]);
+        file.read(reinterpret_cast<char*>(tile.imageData.get()), h.dataSize);
+        if (static_cast<uint64_t>(file.gcount()) != h.dataSize ||
+            file.peek() != std::ifstream::traits_type::eof())
+        {
+            // The file was truncated or has trailing data
+            return std::nullopt;
+        }
+
+        tile.tileMetaData.maxValues = h.maxValues;
+        tile.tileMetaData.minValues = h.minValues;
+        for (size_t i = 0; i < 4; ++i) {
+            tile.tileMetaData.hasMissingData[i] = h.hasMissingData[i] != 0;
+        }
+        tile.tileMetaData.nValues = static_cast<uint8_t>(h.nValues);
+        tile.textureInitData = initData;
+        tile.tileIndex = key.tileIndex;
+        tile.error = gb::RawTile::ReadError::None;
+        return tile;
+    }
+
+    // Inverse of DiskTileCache::tilePath:  <hash>/<level>/<x>_<y>.tile
+    std::optional<gb::cache::DiskTileKey> keyFromPath(const std::filesystem::path& path) {
+        const std::string stem = path.stem().string();
+        const std::string level = path.parent_path().filename().string();
+        const std::string hash = path.parent_path().parent_path().filename().string();
+
+        unsigned int x = 0;
+        unsigned int y = 0;
+        unsigned int l = 0;
+        unsigned long long h = 0;
+        char trailing = 0;
+        const bool success =
+            hash.size() == 16 &&
+            std::sscanf(hash.c_str(), "%16llx%c", &h, &trailing) == 1 &&
+            std::sscanf(level.c_str(), "%u%c", &l, &trailing) == 1 &&
+            std::sscanf(stem.c_str(), "%u_%u%c", &x, &y, &trailing) == 2 &&
+            l <= std::numeric_limits<uint8_t>::max();
+        if (!success) {
+            return std::nullopt;
+        }
+
+        return gb::cache::DiskTileKey{
+            gb::TileIndex(x, y, static_cast<uint8_t>(l)),
+            static_cast<uint64_t>(h)
+        };
+    }
+} // namespace
+
+namespace openspace::globebrowsing::cache {
+
+DiskTileCache::DiskTileCache(std::filesystem::path directory, uint64_t maximumSize)
+    : PropertyOwner({ "DiskTileCache" })
+    , _directory(std::move(directory))
+    , _maximumSize(maximumSize)
+    , _diskUsage(DiskUsageInfo, 0, 0, std::numeric_limits<int>::max())
+    , _hits(HitsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _misses(MissesInfo, 0, 0, std::numeric_limits<int>::max())
+    , _averageReadTime(AverageReadTimeInfo, 0.f, 0.f, 1000.f)
+    , _clearCache(ClearDiskCacheInfo)
+{
+    _diskUsage.setReadOnly(true);
+    addProperty(_diskUsage);
+    _hits.setReadOnly(true);
+    addProperty(_hits);
+    _misses.setReadOnly(true);
+    addProperty(_misses);
+    _averageReadTime.setReadOnly(true);
+    addProperty(_averageReadTime);
+
+    _clearCache.onChange([this]() { clear(); });
+    addProperty(_clearCache);
+
+    std::error_code ec;
+    std::filesystem::create_directories(_directory, ec);
+    if (ec) {
+        LWARNING(fmt::format(
+            "Could not create tile cache directory '{}': {}",
+            _directory.string(), ec.message()
+        ));
+    }
+    loadIndex();
+}
+
+bool DiskTileCache::contains(const DiskTileKey& key) const {
+    std::lock_guard lock(_mutex);
+    return _entryMap.find(key) != _entryMap.end();
+}
+
+std::optional<RawTile> DiskTileCache::get(const DiskTileKey& key,
+                                          const TileTextureInitData& initData)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock(_mutex);
+        const auto it = _entryMap.find(key);
+        if (it == _entryMap.end()) {
+            ++_nMisses;
+            return std::nullopt;
+        }
+        _entries.splice(_entries.begin(), _entries, it->second);
+    }
+
+    // The file is read without holding the lock. If the tile is evicted or replaced in
+    // the meantime, we either read the complete old or the complete new file
+    const std::filesystem::path path = tilePath(key);
+    std::optional<RawTile> tile = readTile(path, key, initData);
+    if (!tile) {
+        std::lock_guard lock(_mutex);
+        const auto it = _entryMap.find(key);
+        if (it != _entryMap.end()) {
+            remove(it->second);
+        }
+        ++_nMisses;
+        return std::nullopt;
+    }
+
+    // Store the time of the last use with the file so that the least recently used
+    // order survives a restart
+    std::error_code ec;
+    std::filesystem::last_write_time(
+        path,
+        std::filesystem::file_time_type::clock::now(),
+        ec
+    );
+
+    const auto end = std::chrono::steady_clock::now();
+    _readTimeMicroseconds += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()
+    );
+    ++_nHits;
+    return tile;
+}
+
+void DiskTileCache::put(const DiskTileKey& key, const RawTile& tile) {
+    if (tile.error != RawTile::ReadError::None || !tile.imageData ||
+        !tile.textureInitData.has_value())
+    {
+        return;
+    }
+
+    Header h;
+    h.contentHash = key.contentHash;
+    h.x = key.tileIndex.x;
+    h.y = key.tileIndex.y;
+    h.level = key.tileIndex.level;
+    h.nValues = tile.tileMetaData.nValues;
+    h.maxValues = tile.tileMetaData.maxValues;
+    h.minValues = tile.tileMetaData.minValues;
+    for (size_t i = 0; i < 4; ++i) {
+        h.hasMissingData[i] = tile.tileMetaData.hasMissingData[i] ? 1 : 0;
+    }
+    h.dataSize = tile.textureInitData->totalNumBytes;
+    h.initDataHash = tile.textureInitData->hashKey;
+    const std::array<char, HeaderSize> header = serialize(h);
+
+    // Write into a uniquely named temporary file first and move it into place when it
+    // is complete. A rename within the same directory is atomic, so readers and a crash
+    // during the write never observe a partially written tile
+    const std::filesystem::path path = tilePath(key);
+    std::filesystem::path tmpPath = path;
+    tmpPath += fmt::format(".{}{}", _nTemporaryFiles++, TemporaryExtension);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    {
+        std::ofstream file(tmpPath, std::ofstream::binary);
+        file.write(header.data(), HeaderSize);
+        file.write(reinterpret_cast<const char*>(tile.imageData.get()), h.dataSize);
+        file.close();
+        if (!file.good()) {
+            LWARNING(fmt::format("Could not write tile '{}'", tmpPath.string()));
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        LWARNING(fmt::format(
+            "Could not move tile '{}' into place: {}", path.string(), ec.message()
+        ));
+        std::filesystem::remove(tmpPath, ec);
+        return;
+    }
+
+    std::lock_guard lock(_mutex);
+    const auto it = _entryMap.find(key);
+    if (it != _entryMap.end()) {
+        // The file has already been replaced, so only the bookkeeping is updated
+        _size -= it->second->size;
+        _entries.erase(it->second);
+        _entryMap.erase(it);
+    }
+    _entries.push_front({ key, HeaderSize + h.dataSize });
+    _entryMap[key] = _entries.begin();
+    _size += HeaderSize + h.dataSize;
+    ensureSize();
+}
+
+void DiskTileCache::clear() {
+    std::lock_guard lock(_mutex);
+    _entries.clear();
+    _entryMap.clear();
+    _size = 0;
+
+    // Remove everything below the directory rather than the individual tiles to also
+    // get rid of the now empty directories
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& e :
+         std::filesystem::directory_iterator(_directory, ec))
+    {
+        std::filesystem::remove_all(e.path(), ec);
+    }
+}
+
+void DiskTileCache::setMaximumSize(uint64_t maximumSize) {
+    std::lock_guard lock(_mutex);
+    _maximumSize = maximumSize;
+    ensureSize();
+}
+
+uint64_t DiskTileCache::size() const {
+    std::lock_guard lock(_mutex);
+    return _size;
+}
+
+uint64_t DiskTileCache::maximumSize() const {
+    std::lock_guard lock(_mutex);
+    return _maximumSize;
+}
+
+uint64_t DiskTileCache::nHits() const {
+    return _nHits;
+}
+
+uint64_t DiskTileCache::nMisses() const {
+    return _nMisses;
+}
+
+double DiskTileCache::averageReadTime() const {
+    const uint64_t hits = _nHits;
+    return hits > 0 ? static_cast<double>(_readTimeMicroseconds) / hits / 1000.0 : 0.0;
+}
+
+void DiskTileCache::update() {
+    constexpr const uint64_t MaxInt = std::numeric_limits<int>::max();
+    _diskUsage = static_cast<int>(std::min(size() / (1024 * 1024), MaxInt));
+    _hits = static_cast<int>(std::min(nHits(), MaxInt));
+    _misses = static_cast<int>(std::min(nMisses(), MaxInt));
+    _averageReadTime = static_cast<float>(averageReadTime());
+}
+
+uint64_t DiskTileCache::contentHash(const std::string& dataset,
+                                    const TileTextureInitData& initData,
+                                    bool preprocessed)
+{
+    Fnv1a fnv;
+    fnv.add(FileVersion);
+    fnv.add(dataset.data(), dataset.size());
+
+    // If the dataset is a local file, a change to it should invalidate the cached tiles.
+    // Online datasets are described by their configuration alone
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(dataset, ec)) {
+        const uint64_t size = std::filesystem::file_size(dataset, ec);
+        const auto modified = std::filesystem::last_write_time(dataset, ec);
+        fnv.add(size);
+        fnv.add(static_cast<int64_t>(modified.time_since_epoch().count()));
+    }
+
+    fnv.add(initData.hashKey);
+    fnv.add(initData.totalNumBytes);
+    fnv.add(preprocessed);
+    return fnv.hash;
+}
+
+std::filesystem::path DiskTileCache::tilePath(const DiskTileKey& key) const {
+    return _directory /
+        fmt::format("{:016x}", key.contentHash) /
+        std::to_string(key.tileIndex.level) /
+        fmt::format("{}_{}{}", key.tileIndex.x, key.tileIndex.y, TileExtension);
+}
+
+void DiskTileCache::loadIndex() {
+    struct File {
+        DiskTileKey key;
+        uint64_t size;
+        std::filesystem::file_time_type lastUsed;
+    };
+    std::vector<File> files;
+
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& e :
+         std::filesystem::recursive_directory_iterator(_directory, ec))
+    {
+        if (!e.is_regular_file(ec)) {
+            continue;
+        }
+
+        const std::filesystem::path& p = e.path();
+        if (p.extension() == TemporaryExtension) {
+            // Left behind by a write that did not finish in an earlier session
+            std::filesystem::remove(p, ec);
+            continue;
+        }
+        if (p.extension() != TileExtension) {
+            continue;
+        }
+
+        std::optional<DiskTileKey> key = keyFromPath(p.lexically_relative(_directory));
+        if (!key.has_value()) {
+            continue;
+        }
+        files.push_back({ *key, e.file_size(ec), e.last_write_time(ec) });
+    }
+
+    std::sort(
+        files.begin(), files.end(),
+        [](const File& lhs, const File& rhs) { return lhs.lastUsed > rhs.lastUsed; }
+    );
+
+    std::lock_guard lock(_mutex);
+    for (const File& f : files) {
+        _entries.push_back({ f.key, f.size });
+        _entryMap[f.key] = std::prev(_entries.end());
+        _size += f.size;
+    }
+    ensureSize();
+
+    LINFO(fmt::format(
+        "Found {} cached tiles ({} MB) in '{}'",
+        _entries.size(), _size / (1024 * 1024), _directory.string()
+    ));
+}
+
+void DiskTileCache::ensureSize() {
+    while (_size > _maximumSize && !_entries.empty()) {
+        remove(std::prev(_entries.end()));
+    }
+}
+
+void DiskTileCache::remove(Entries::iterator it) {
+    std::error_code ec;
+    std::filesystem::remove(tilePath(it->key), ec);
+    _size -= it->size;
+    _entryMap.erase(it->key);
+    _entries.erase(it);
+}
+
+} // namespace openspace::globebrowsing::cache
@@ -0,0 +1,181 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
+
+#include <openspace/properties/propertyowner.h>
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <openspace/properties/scalar/floatproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <openspace/properties/triggerproperty.h>
+#include <atomic>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * Identifies a tile in the DiskTileCache. The provider id of a ProviderTileKey is handed
+ * out at runtime and differs between sessions, so tiles on disk are instead identified
+ * by a hash of the content they were created from (see DiskTileCache::contentHash).
+ */
+struct DiskTileKey {
+    TileIndex tileIndex;
+    uint64_t contentHash;
+
+    bool operator==(const DiskTileKey& r) const {
+        return (contentHash == r.contentHash) && (tileIndex == r.tileIndex);
+    }
+};
+
+struct DiskTileHasher {
+    size_t operator()(const DiskTileKey& k) const {
+        return static_cast<size_t>(k.tileIndex.hashKey() ^ (k.contentHash * 31));
+    }
+};
+
+/**
+ * A persistent tile cache that sits below the MemoryAwareTileCache. It stores the
+ * decoded and preprocessed image data of RawTile%s together with their TileMetaData, so
+ * that a tile that has been read through GDAL once does not have to be read and
+ * preprocessed again in a later session. Each tile is stored in a separate file below
+ * the cache directory and the total size of these files is kept below a byte budget by
+ * removing the least recently used tiles.
+ *
+ * Files are written to a temporary file first that is then renamed into place, so a
+ * crash during a write can never leave a partial tile behind. Every file is validated
+ * against the requested key and texture format when it is read and invalid files are
+ * removed from the cache.
+ *
+ * All public methods are thread-safe and are meant to be called from the tile loading
+ * worker threads, except for #update, which has to be called from the main thread.
+ */
+class DiskTileCache : public properties::PropertyOwner {
+public:
+    /**
+     * Creates a cache in the provided \p directory, creating it if necessary. Tiles that
+     * were stored in an earlier session are picked up, with the most recently written or
+     * used tiles being the last to be evicted.
+     *
+     * \param directory The directory in which the tiles are stored
+     * \param maximumSize The maximum number of bytes that the stored tiles can occupy
+     */
+    DiskTileCache(std::filesystem::path directory, uint64_t maximumSize);
+
+    /**
+     * Returns \c true if a tile for the \p key has been stored in this cache. This check
+     * does not touch the file system.
+     */
+    bool contains(const DiskTileKey& key) const;
+
+    /**
+     * Loads the tile for the \p key from disk and bumps it to the front of the least
+     * recently used queue. Returns \c std::nullopt if no tile is stored for the \p key or
+     * if the stored tile does not match the \p initData, in which case it is removed.
+     */
+    std::optional<RawTile> get(const DiskTileKey& key,
+        const TileTextureInitData& initData);
+
+    /**
+     * Stores the \p tile under the \p key, replacing any previous tile. Tiles that could
+     * not be read without errors are not stored. If the cache grows larger than its
+     * maximum size, the least recently used tiles are removed.
+     */
+    void put(const DiskTileKey& key, const RawTile& tile);
+
+    /// Removes all tiles from this cache and from disk
+    void clear();
+
+    /// Sets the maximum number of bytes, removing tiles if necessary
+    void setMaximumSize(uint64_t maximumSize);
+
+    /// Returns the number of bytes currently used by the stored tiles
+    uint64_t size() const;
+    uint64_t maximumSize() const;
+
+    uint64_t nHits() const;
+    uint64_t nMisses() const;
+
+    /// Returns the average time (in milliseconds) that it took to load a hit from disk
+    double averageReadTime() const;
+
+    /// Updates the statistics properties. Must be called from the main thread
+    void update();
+
+    /**
+     * Computes a key that identifies the content of a tile layer across sessions. It is
+     * derived from the \p dataset, the size and modification time of the \p dataset if it
+     * is a local file, the texture format in \p initData and whether the tiles were
+     * \p preprocessed.
+     */
+    static uint64_t contentHash(const std::string& dataset,
+        const TileTextureInitData& initData, bool preprocessed);
+
+private:
+    struct Entry {
+        DiskTileKey key;
+        uint64_t size;
+    };
+    using Entries = std::list<Entry>;
+
+    std::filesystem::path tilePath(const DiskTileKey& key) const;
+    void loadIndex();
+
+    /// Evicts entries until the size is within the budget. Requires _mutex to be locked
+    void ensureSize();
+
+    /// Removes the entry from the index and disk. Requires _mutex to be locked
+    void remove(Entries::iterator it);
+
+    const std::filesystem::path _directory;
+    uint64_t _maximumSize;
+    uint64_t _size = 0;
+
+    // The front of the list is the most recently used tile
+    Entries _entries;
+    std::unordered_map<DiskTileKey, Entries::iterator, DiskTileHasher> _entryMap;
+    mutable std::mutex _mutex;
+
+    std::atomic<uint64_t> _nHits = 0;
+    std::atomic<uint64_t> _nMisses = 0;
+    std::atomic<uint64_t> _readTimeMicroseconds = 0;
+    std::atomic<uint64_t> _nTemporaryFiles = 0;
+
+    properties::IntProperty _diskUsage;
+    properties::IntProperty _hits;
+    properties::IntProperty _misses;
+    properties::FloatProperty _averageReadTime;
+    properties::TriggerProperty _clearCache;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
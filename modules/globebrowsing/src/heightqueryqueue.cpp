@@ -0,0 +1,141 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/heightqueryqueue.h>
+
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    constexpr const char* _loggerCat = "HeightQueryQueue";
+} // namespace
+
+namespace openspace::globebrowsing {
+
+HeightQueryQueue::HeightQueryQueue(int maxFrames) : _maxFrames(maxFrames) {}
+
+std::future<std::vector<float>> HeightQueryQueue::enqueue(
+                                                         std::vector<Geodetic2> positions,
+                                                                                int level)
+{
+    Query query;
+    query.heights.resize(positions.size());
+    query.positions = std::move(positions);
+    query.level = level;
+    std::future<std::vector<float>> future = query.promise.get_future();
+
+    std::lock_guard lock(_mutex);
+    if (_isEnabled) {
+        _newQueries.push_back(std::move(query));
+    }
+    else {
+        query.promise.set_exception(
+            std::make_exception_ptr(ghoul::RuntimeError(_disabledReason, _loggerCat))
+        );
+    }
+    return future;
+}
+
+void HeightQueryQueue::resolve(const Resolver& resolver) {
+    ZoneScoped
+
+    {
+        std::lock_guard lock(_mutex);
+        acceptNewQueries();
+    }
+
+    auto resolveQuery = [this, &resolver](Query& query) {
+        const bool useAvailableData = query.nFrames >= _maxFrames;
+        query.nFrames++;
+
+        bool isResolved = true;
+        for (size_t i = 0; i < query.positions.size(); ++i) {
+            if (!query.heights[i]) {
+                query.heights[i] = resolver(
+                    query.positions[i],
+                    query.level,
+                    useAvailableData
+                );
+                isResolved &= query.heights[i].has_value();
+            }
+        }
+        if (!isResolved) {
+            return false;
+        }
+
+        std::vector<float> heights;
+        heights.reserve(query.heights.size());
+        for (const std::optional<float>& height : query.heights) {
+            heights.push_back(*height);
+        }
+        query.promise.set_value(std::move(heights));
+        return true;
+    };
+    for (auto it = _queries.begin(); it != _queries.end();) {
+        it = resolveQuery(*it) ? _queries.erase(it) : it + 1;
+    }
+}
+
+bool HeightQueryQueue::hasPendingQueries() {
+    std::lock_guard lock(_mutex);
+    return !_newQueries.empty() || !_queries.empty();
+}
+
+void HeightQueryQueue::enable() {
+    std::lock_guard lock(_mutex);
+    _isEnabled = true;
+    _disabledReason.clear();
+}
+
+void HeightQueryQueue::disable(std::string reason) {
+    {
+        std::lock_guard lock(_mutex);
+        _isEnabled = false;
+        _disabledReason = reason;
+    }
+    abandon(reason);
+}
+
+void HeightQueryQueue::abandon(const std::string& reason) {
+    {
+        std::lock_guard lock(_mutex);
+        acceptNewQueries();
+    }
+
+    for (Query& query : _queries) {
+        query.promise.set_exception(
+            std::make_exception_ptr(ghoul::RuntimeError(reason, _loggerCat))
+        );
+    }
+    _queries.clear();
+}
+
+void HeightQueryQueue::acceptNewQueries() {
+    std::move(_newQueries.begin(), _newQueries.end(), std::back_inserter(_queries));
+    _newQueries.clear();
+}
+
+} // namespace openspace::globebrowsing
@@ -0,0 +1,119 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHTQUERYQUEUE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHTQUERYQUEUE___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * Collects batched height queries from any thread and resolves them incrementally on the
+ * thread that owns the height tiles. #resolve is called once per frame and a query is
+ * fulfilled as soon as all of its positions are resolved. If that did not happen within
+ * the maximum number of frames, the remaining positions are resolved with the data that
+ * is available at that point. While the queue is disabled, the outstanding queries and
+ * all queries that are enqueued in the meantime fail with a ghoul::RuntimeError instead
+ * of waiting for a resolution that might never come.
+ */
+class HeightQueryQueue {
+public:
+    /**
+     * Returns the height at the \p position sampled at the \p level or std::nullopt if
+     * the data is not available yet. If \p useAvailableData is \c true, a height has to
+     * be returned even if the data is not available in the desired level.
+     */
+    using Resolver = std::function<
+        std::optional<float>(const Geodetic2& position, int level, bool useAvailableData)
+    >;
+
+    /**
+     * Creates an empty queue whose queries wait for at most \p maxFrames calls to
+     * #resolve before they settle for the available data.
+     */
+    explicit HeightQueryQueue(int maxFrames);
+
+    /**
+     * Enqueues a query for the heights at the \p positions at \p level. This function
+     * can be called from any thread.
+     *
+     * \return The heights in the same order as the \p positions
+     */
+    std::future<std::vector<float>> enqueue(std::vector<Geodetic2> positions, int level);
+
+    /**
+     * Tries to resolve the outstanding positions of all queries with the \p resolver and
+     * fulfills the queries whose positions are all resolved.
+     */
+    void resolve(const Resolver& resolver);
+
+    /// Returns \c true if there are queries that have not been fulfilled yet
+    bool hasPendingQueries();
+
+    /// Accepts new queries again after a call to #disable
+    void enable();
+
+    /**
+     * Fails all outstanding queries and all queries that are enqueued until the next
+     * call to #enable with a ghoul::RuntimeError containing the \p reason.
+     */
+    void disable(std::string reason);
+
+    /// Fails all outstanding queries with a ghoul::RuntimeError containing the \p reason
+    void abandon(const std::string& reason);
+
+private:
+    struct Query {
+        std::vector<Geodetic2> positions;
+        std::vector<std::optional<float>> heights;
+        int level = 0;
+        int nFrames = 0;
+        std::promise<std::vector<float>> promise;
+    };
+
+    /// Moves the newly enqueued queries into _queries. _mutex has to be locked
+    void acceptNewQueries();
+
+    const int _maxFrames;
+
+    /// Protects the queries that were enqueued since the last call to #resolve and the
+    /// enabled state, all other members are only used by the resolving thread
+    std::mutex _mutex;
+    std::vector<Query> _newQueries;
+    bool _isEnabled = true;
+    std::string _disabledReason;
+
+    std::vector<Query> _queries;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHTQUERYQUEUE___H__
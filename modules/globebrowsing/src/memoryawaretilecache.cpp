@@ -25,10 +25,10 @@
 #include <modules/globebrowsing/src/memoryawaretilecache.h>
 
 #include <modules/globebrowsing/src/basictypes.h>
-#include <modules/globebrowsing/src/layermanager.h>
 #include <modules/globebrowsing/src/rawtile.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
+#include <algorithm>
 #include <numeric>
 
 namespace {
@@ -182,11 +182,39 @@ namespace {
         }
     }
 
-
+    GLenum toGlTextureFormat(const openspace::globebrowsing::TileTextureInitData& data) {
+        using namespace openspace::globebrowsing;
+        switch (data.compression) {
+            case TileCompression::None:
+                return toGlTextureFormat(data.glType, data.ghoulTextureFormat);
+            case TileCompression::BC1:
+                // The transparent pixels of the three-color blocks have to be preserved
+                return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            default:
+                throw ghoul::MissingCaseException();
+        }
+    }
 } // namespace
 
 namespace openspace::globebrowsing::cache {
 
+std::vector<size_t> numTexturesInBudget(size_t budget,
+                                        const std::vector<size_t>& bytesPerTexture)
+{
+    std::vector<size_t> res;
+    res.reserve(bytesPerTexture.size());
+    if (bytesPerTexture.empty()) {
+        return res;
+    }
+
+    const size_t share = budget / bytesPerTexture.size();
+    for (size_t nBytes : bytesPerTexture) {
+        // Every texture type needs at least one texture that its tiles can be put into
+        res.push_back(nBytes > 0 ? std::max<size_t>(share / nBytes, 1) : 0);
+    }
+    return res;
+}
+
 //
 // TextureContainer
 //
@@ -207,30 +235,61 @@ void MemoryAwareTileCache::TextureContainer::reset() {
     _textures.clear();
     _freeTexture = 0;
     for (size_t i = 0; i < _numTextures; ++i) {
-        using namespace ghoul::opengl;
-        std::unique_ptr<Texture> tex = std::make_unique<Texture>(
-            _initData.dimensions,
-            _initData.ghoulTextureFormat,
-            toGlTextureFormat(_initData.glType, _initData.ghoulTextureFormat),
-            _initData.glType,
-            Texture::FilterMode::Linear,
-            Texture::WrappingMode::ClampToEdge,
-            Texture::AllocateData(_initData.shouldAllocateDataOnCPU)
-        );
-
-        tex->setDataOwnership(Texture::TakeOwnership::Yes);
-        tex->uploadTexture();
-        tex->setFilter(Texture::FilterMode::Linear);
-
-        _textures.push_back(std::move(tex));
+        _textures.push_back(createTexture());
     }
 }
 
-void MemoryAwareTileCache::TextureContainer::reset(size_t numTextures) {
+void MemoryAwareTileCache::TextureContainer::resize(size_t numTextures,
+                                                    TileCache& tiles)
+{
     ZoneScoped
 
     _numTextures = numTextures;
-    reset();
+
+    // The textures that were never used are at the end and can be released right away
+    while (_textures.size() > _numTextures && _freeTexture < _textures.size()) {
+        _textures.pop_back();
+    }
+
+    while (_textures.size() > _numTextures && !tiles.isEmpty()) {
+        const ghoul::opengl::Texture* texture = tiles.popLRU().second.texture;
+        const auto it = std::find_if(
+            _textures.begin(),
+            _textures.end(),
+            [texture](const std::unique_ptr<ghoul::opengl::Texture>& t) {
+                return t.get() == texture;
+            }
+        );
+        if (it != _textures.end()) {
+            _textures.erase(it);
+            // All remaining textures are in use, so the free index moves with them
+            _freeTexture = _textures.size();
+        }
+    }
+
+    while (_textures.size() < _numTextures) {
+        _textures.push_back(createTexture());
+    }
+}
+
+std::unique_ptr<ghoul::opengl::Texture>
+MemoryAwareTileCache::TextureContainer::createTexture() const
+{
+    using namespace ghoul::opengl;
+    std::unique_ptr<Texture> tex = std::make_unique<Texture>(
+        _initData.dimensions,
+        _initData.ghoulTextureFormat,
+        toGlTextureFormat(_initData),
+        _initData.glType,
+        Texture::FilterMode::Linear,
+        Texture::WrappingMode::ClampToEdge,
+        Texture::AllocateData(_initData.shouldAllocateDataOnCPU)
+    );
+
+    tex->setDataOwnership(Texture::TakeOwnership::Yes);
+    tex->uploadTexture();
+    tex->setFilter(Texture::FilterMode::Linear);
+    return tex;
 }
 
 ghoul::opengl::Texture* MemoryAwareTileCache::TextureContainer::getTextureIfFree() {
@@ -269,8 +328,6 @@ MemoryAwareTileCache::MemoryAwareTileCache(int tileCacheSize)
 {
     ZoneScoped
 
-    createDefaultTextureContainers();
-
     _clearTileCache.onChange([&]() { clear(); });
     addProperty(_clearTileCache);
 
@@ -311,18 +368,6 @@ void MemoryAwareTileCache::clear() {
     LINFO("Tile cache cleared");
 }
 
-void MemoryAwareTileCache::createDefaultTextureContainers() {
-    ZoneScoped
-
-    for (int id = 0; id < layergroupid::NUM_LAYER_GROUPS; id++) {
-        TileTextureInitData initData = tileTextureInitData(
-            layergroupid::GroupID(id),
-            true
-        );
-        assureTextureContainerExists(initData);
-    }
-}
-
 void MemoryAwareTileCache::assureTextureContainerExists(
                                                       const TileTextureInitData& initData)
 {
@@ -330,52 +375,49 @@ void MemoryAwareTileCache::assureTextureContainerExists(
 
     TileTextureInitData::HashKey initDataKey = initData.hashKey;
     if (_textureContainerMap.find(initDataKey) == _textureContainerMap.end()) {
-        // For now create 500 textures of this type
+        // Textures are only allocated for the texture types that are actually used, so
+        // the budget has to be split again between all of them. The other containers
+        // keep their most recently used tiles when they shrink to make room
         _textureContainerMap.emplace(initDataKey,
             TextureContainerTileCache(
-                std::make_unique<TextureContainer>(initData, 500),
+                std::make_unique<TextureContainer>(initData, 0),
                 std::make_unique<TileCache>(std::numeric_limits<std::size_t>::max())
             )
         );
+        resizeTextureContainers();
     }
 }
 
 void MemoryAwareTileCache::setSizeEstimated(size_t estimatedSize) {
     ZoneScoped
-    ghoul_assert(!_textureContainerMap.empty(), "Texture containers must exist.");
 
     LDEBUG("Resetting tile cache size");
-
-    const size_t sumTextureTypeSize = std::accumulate(
-        _textureContainerMap.cbegin(),
-        _textureContainerMap.cend(),
-        size_t(0),
-        [](size_t s, const std::pair<const TileTextureInitData::HashKey,
-                                     TextureContainerTileCache>& p)
-        {
-            return s + p.second.first->tileTextureInitData().totalNumBytes;
-        }
-    );
-
-    if (sumTextureTypeSize > 0) {
-        const size_t numTexturesPerType = estimatedSize / sumTextureTypeSize;
-        resetTextureContainerSize(numTexturesPerType);
-    }
-    else {
-        resetTextureContainerSize(0);
-    }
+    _estimatedSize = estimatedSize;
+    resizeTextureContainers();
     LINFO("Tile cache size was reset");
 }
 
-void MemoryAwareTileCache::resetTextureContainerSize(size_t numTexturesPerTextureType) {
+void MemoryAwareTileCache::resizeTextureContainers() {
     ZoneScoped
 
-    _numTextureBytesAllocatedOnCPU = 0;
+    std::vector<size_t> bytesPerTexture;
+    bytesPerTexture.reserve(_textureContainerMap.size());
+    for (const std::pair<const TileTextureInitData::HashKey,
+        TextureContainerTileCache>& p : _textureContainerMap)
+    {
+        bytesPerTexture.push_back(p.second.first->tileTextureInitData().totalNumBytes);
+    }
+    const std::vector<size_t> numTextures = numTexturesInBudget(
+        _estimatedSize,
+        bytesPerTexture
+    );
+
+    size_t i = 0;
     for (std::pair<const TileTextureInitData::HashKey,
         TextureContainerTileCache>& p : _textureContainerMap)
     {
-        p.second.first->reset(numTexturesPerTextureType);
-        p.second.second->clear();
+        p.second.first->resize(numTextures[i], *p.second.second);
+        ++i;
     }
 }
 
@@ -441,8 +483,24 @@ void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile
         const TileTextureInitData& initData = *rawTile.textureInitData;
         Texture* tex = texture(initData);
 
-        // Re-upload texture, either using PBO or by using RAM data
-        if (rawTile.pbo != 0) {
+        // Re-upload texture, either using PBO or by using RAM data. Compressed tiles are
+        // never kept in RAM after they have been uploaded
+        if (initData.compression != TileCompression::None) {
+            tex->bind();
+            glCompressedTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                0,
+                0,
+                static_cast<GLsizei>(initData.dimensions.x),
+                static_cast<GLsizei>(initData.dimensions.y),
+                toGlTextureFormat(initData),
+                static_cast<GLsizei>(initData.totalNumBytes),
+                rawTile.imageData.get()
+            );
+            rawTile.imageData = nullptr;
+        }
+        else if (rawTile.pbo != 0) {
             tex->reUploadTextureFromPBO(rawTile.pbo);
             if (initData.shouldAllocateDataOnCPU) {
                 if (!tex->dataOwnership()) {
@@ -469,7 +527,13 @@ void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile
             _numTextureBytesAllocatedOnCPU += numBytes - previousExpectedDataSize;
             tex->reUploadTexture();
         }
-        tex->setFilter(ghoul::opengl::Texture::FilterMode::AnisotropicMipMap);
+        // The mipmaps of S3TC textures can not be generated by the driver, so compressed
+        // tiles are only sampled from their base level
+        tex->setFilter(
+            initData.compression == TileCompression::None ?
+            Texture::FilterMode::AnisotropicMipMap :
+            Texture::FilterMode::Linear
+        );
         Tile tile{ tex, std::move(rawTile.tileMetaData), Tile::Status::OK };
         TileTextureInitData::HashKey initDataKey = initData.hashKey;
         _textureContainerMap[initDataKey].second->put(std::move(key), std::move(tile));
@@ -82,6 +82,15 @@ struct ProviderTileHasher {
     }
 };
 
+/**
+ * Splits the \p budget (in bytes) into equal shares for texture types whose textures
+ * occupy \p bytesPerTexture bytes each and returns the number of textures of each type
+ * that fit into its share, but at least one. Types with smaller textures, such as
+ * compressed ones, are thereby given more textures than types with larger textures.
+ */
+std::vector<size_t> numTexturesInBudget(size_t budget,
+    const std::vector<size_t>& bytesPerTexture);
+
 class MemoryAwareTileCache : public properties::PropertyOwner {
 public:
     explicit MemoryAwareTileCache(int tileCacheSize = 1024);
@@ -100,6 +109,8 @@ public:
     size_t cpuAllocatedDataSize() const;
 
 private:
+    using TileCache = LRUCache<ProviderTileKey, Tile, ProviderTileHasher>;
+
     /**
      * Owner of texture data used for tiles. Instead of dynamically allocating textures
      * one by one, they are created once and reused.
@@ -115,7 +126,14 @@ private:
         ~TextureContainer() = default;
 
         void reset();
-        void reset(size_t numTextures);
+
+        /**
+         * Changes the number of textures to \p numTextures while keeping the textures
+         * that are in use. If the number shrinks, the unused textures are released first
+         * and then the textures of the least recently used tiles in \p tiles, which are
+         * removed from it.
+         */
+        void resize(size_t numTextures, TileCache& tiles);
 
         /**
          * \return A pointer to a texture if there is one texture never used before. If
@@ -132,6 +150,8 @@ private:
         size_t size() const;
 
     private:
+        std::unique_ptr<ghoul::opengl::Texture> createTexture() const;
+
         std::vector<std::unique_ptr<ghoul::opengl::Texture>> _textures;
 
         const TileTextureInitData _initData;
@@ -140,11 +160,9 @@ private:
     };
 
 
-    void createDefaultTextureContainers();
     void assureTextureContainerExists(const TileTextureInitData& initData);
-    void resetTextureContainerSize(size_t numTexturesPerTextureType);
+    void resizeTextureContainers();
 
-    using TileCache = LRUCache<ProviderTileKey, Tile, ProviderTileHasher>;
     using TextureContainerTileCache = std::pair<
         std::unique_ptr<TextureContainer>,
         std::unique_ptr<TileCache>
@@ -156,6 +174,7 @@ private:
 
     TextureContainerMap _textureContainerMap;
     size_t _numTextureBytesAllocatedOnCPU;
+    size_t _estimatedSize = 0;
 
     // Properties
     properties::IntProperty _cpuAllocatedTileData;
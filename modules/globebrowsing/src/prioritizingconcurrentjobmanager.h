@@ -25,29 +25,47 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 
-#include <modules/globebrowsing/src/lruthreadpool.h>
+#include <modules/globebrowsing/src/prioritythreadpool.h>
 #include <openspace/util/concurrentqueue.h>
-#include <mutex>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace openspace { template <typename T> struct Job; }
 
 namespace openspace::globebrowsing {
 
 /**
- * Concurrent job manager which prioritizes which jobs to work on depending on which ones
- * were enqueued latest. The class is templated both on the job type and the key type
+ * Concurrent job manager which prioritizes which jobs to work on depending on the
+ * priority they were enqueued with and, for equal priorities, which ones were enqueued
+ * latest. The class is templated both on the job type and the key type
  * which is used to identify jobs. In case a job need to be explicitly ended. It can be
  * identified using its key.
+ *
+ * The thread pool can be shared between several job managers. Its keys consist of the
+ * job manager that enqueued a job and the key of the job, so every job manager only sees
+ * its own jobs. The destructor cancels all jobs of the job manager that have not been
+ * started yet, but does not wait for the jobs that are currently executed. These jobs
+ * keep the list of finished jobs alive until they are done, so the jobs themselves have
+ * to share the ownership of all resources they depend on.
  */
 template<typename P, typename KeyType>
 class PrioritizingConcurrentJobManager {
 public:
-    PrioritizingConcurrentJobManager(LRUThreadPool<KeyType> pool);
+    using PriorityFunction = std::function<std::optional<float>(const KeyType&, float)>;
+    using PoolKey = std::pair<const void*, KeyType>;
+    using ThreadPool = PriorityThreadPool<PoolKey>;
+
+    PrioritizingConcurrentJobManager(std::shared_ptr<ThreadPool> pool);
+    ~PrioritizingConcurrentJobManager();
 
     /**
-     * Enqueues a job which is identified using a given key
+     * Enqueues a job which is identified using a given key. Jobs with a higher
+     * <code>priority</code> are executed first.
      */
-    void enqueueJob(std::shared_ptr<Job<P>> job, KeyType key);
+    void enqueueJob(std::shared_ptr<Job<P>> job, KeyType key, float priority = 0.f);
 
     /**
      * The keys returned by this function have been popped from the queue and corresponds
@@ -68,6 +86,16 @@ public:
      */
     bool touch(KeyType key);
 
+    /**
+     * Updates the priorities of all enqueued jobs in one go. <code>f</code> is called
+     * with the key and current priority of every job that has not been started yet and
+     * returns its new priority, or <code>std::nullopt</code> if the job should be
+     * cancelled.
+     * \returns the keys of the jobs that were cancelled. These jobs are not reported
+     *          by <code>keysToUnfinishedJobs</code>.
+     */
+    std::vector<KeyType> prioritizeJobs(const PriorityFunction& f);
+
     /**
      * Clear all enqueued jobs. Can not end jobs that workers are currently handling.
      * Therefore it is not safe to assume that there will be no finished jobs after
@@ -80,13 +108,31 @@ public:
      */
     std::shared_ptr<Job<P>> popFinishedJob();
 
+    /**
+     * Appends up to <code>maxJobs</code> finished jobs to <code>jobs</code>. This
+     * function never blocks and does not take any locks.
+     * \returns the number of jobs that were appended.
+     */
+    size_t popFinishedJobs(std::vector<std::shared_ptr<Job<P>>>& jobs,
+        size_t maxJobs = std::numeric_limits<size_t>::max());
+
     size_t numFinishedJobs() const;
 
 private:
-    ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
-    std::mutex _finishedJobsMutex;
-    /// An LRU thread pool is used since the jobs can be bumped and hence prioritized.
-    LRUThreadPool<KeyType> _threadPool;
+    /// The number of finished jobs that can be stored without taking a lock. Workers
+    /// that finish a job while these are all taken add it to a mutex-protected overflow
+    /// list instead of waiting for the finished jobs to be popped, which might never
+    /// happen if the owner of this job manager is no longer updated.
+    static constexpr const size_t FinishedJobsCapacity = 1024;
+
+    bool isOwnJob(const PoolKey& key) const;
+    std::vector<KeyType> jobKeys(std::vector<PoolKey> keys) const;
+
+    /// The finished jobs are shared with the executed tasks, which might outlive this
+    /// object. Its address also identifies the jobs of this job manager in the pool
+    std::shared_ptr<SpillingConcurrentQueue<std::shared_ptr<Job<P>>>> _finishedJobs;
+    /// A priority thread pool is used since the jobs can be bumped and reprioritized.
+    std::shared_ptr<ThreadPool> _threadPool;
 };
 
 } // namespace openspace::globebrowsing
@@ -28,55 +28,109 @@ namespace openspace::globebrowsing {
 
 template <typename P, typename KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::PrioritizingConcurrentJobManager(
-                                                              LRUThreadPool<KeyType> pool)
-    : _threadPool(std::move(pool))
-{}
+                                                         std::shared_ptr<ThreadPool> pool)
+    : _finishedJobs(
+        std::make_shared<SpillingConcurrentQueue<std::shared_ptr<Job<P>>>>(
+            FinishedJobsCapacity
+        )
+    )
+    , _threadPool(std::move(pool))
+{
+    ghoul_assert(_threadPool, "Thread pool must not be nullptr");
+}
+
+template <typename P, typename KeyType>
+PrioritizingConcurrentJobManager<P, KeyType>::~PrioritizingConcurrentJobManager() {
+    // The jobs that are executed right now keep _finishedJobs alive, so we don't have to
+    // wait for them, which would stall the caller for the duration of a tile read
+    _threadPool->removeTasks([this](const PoolKey& key) { return isOwnJob(key); });
+}
 
 template <typename P, typename KeyType>
 void PrioritizingConcurrentJobManager<P, KeyType>::enqueueJob(std::shared_ptr<Job<P>> job,
-                                                              KeyType key)
+                                                              KeyType key, float priority)
 {
-    _threadPool.enqueue([this, job]() {
+    _threadPool->enqueue([finishedJobs = _finishedJobs, job]() {
         job->execute();
-        std::lock_guard lock(_finishedJobsMutex);
-        _finishedJobs.push(job);
-    }, key);
+        finishedJobs->push(job);
+    }, PoolKey(_finishedJobs.get(), std::move(key)), priority);
 }
 
 template <typename P, typename KeyType>
 std::vector<KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::keysToUnfinishedJobs() {
-    return _threadPool.getUnqueuedTasksKeys();
+    return jobKeys(_threadPool->getUnqueuedTasksKeys(
+        [this](const PoolKey& key) { return isOwnJob(key); }
+    ));
 }
 
 template <typename P, typename KeyType>
 std::vector<KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::keysToEnqueuedJobs() {
-    return _threadPool.getQueuedTasksKeys();
+    return jobKeys(_threadPool->getQueuedTasksKeys(
+        [this](const PoolKey& key) { return isOwnJob(key); }
+    ));
 }
 
 template <typename P, typename KeyType>
 bool PrioritizingConcurrentJobManager<P, KeyType>::touch(KeyType key) {
-    return _threadPool.touch(key);
+    return _threadPool->touch(PoolKey(_finishedJobs.get(), std::move(key)));
+}
+
+template <typename P, typename KeyType>
+std::vector<KeyType> PrioritizingConcurrentJobManager<P, KeyType>::prioritizeJobs(
+                                                                const PriorityFunction& f)
+{
+    return jobKeys(_threadPool->reprioritize(
+        [this, &f](const PoolKey& key, float priority) -> std::optional<float> {
+            // The jobs of other job managers sharing the thread pool are left untouched
+            return isOwnJob(key) ? f(key.second, priority) : priority;
+        }
+    ));
 }
 
 template <typename P, typename KeyType>
 void PrioritizingConcurrentJobManager<P, KeyType>::clearEnqueuedJobs() {
-    _threadPool.clearEnqueuedTasks();
+    _threadPool->clearEnqueuedTasks([this](const PoolKey& key) { return isOwnJob(key); });
 }
 
 template <typename P, typename KeyType>
 std::shared_ptr<Job<P>> PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJob() {
-    ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop!");
+    ghoul_assert(!_finishedJobs->empty(), "There is no finished job to pop!");
 
-    std::lock_guard lock(_finishedJobsMutex);
-    std::shared_ptr<Job<P>> result = _finishedJobs.pop();
+    std::shared_ptr<Job<P>> result;
+    _finishedJobs->tryPop(result);
     return result;
 }
 
+template <typename P, typename KeyType>
+size_t PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJobs(
+                                              std::vector<std::shared_ptr<Job<P>>>& jobs,
+                                                                           size_t maxJobs)
+{
+    return _finishedJobs->drain(jobs, maxJobs);
+}
+
 template <typename P, typename KeyType>
 size_t PrioritizingConcurrentJobManager<P, KeyType>::numFinishedJobs() const {
-    return _finishedJobs.size();
+    return _finishedJobs->size();
+}
+
+template <typename P, typename KeyType>
+bool PrioritizingConcurrentJobManager<P, KeyType>::isOwnJob(const PoolKey& key) const {
+    return key.first == _finishedJobs.get();
+}
+
+template <typename P, typename KeyType>
+std::vector<KeyType> PrioritizingConcurrentJobManager<P, KeyType>::jobKeys(
+                                                          std::vector<PoolKey> keys) const
+{
+    std::vector<KeyType> result;
+    result.reserve(keys.size());
+    for (PoolKey& key : keys) {
+        result.push_back(std::move(key.second));
+    }
+    return result;
 }
 
 } // namespace openspace::globebrowsing
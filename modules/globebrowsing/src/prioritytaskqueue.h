@@ -0,0 +1,131 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_TASK_QUEUE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_TASK_QUEUE___H__
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * A bounded queue of tasks that are identified by a key and ordered by a priority. The
+ * task with the highest priority is popped first; if several tasks share the same
+ * priority, the one that was pushed or touched most recently is popped first. This means
+ * that the queue behaves like a most-recently-used queue if all tasks are pushed with the
+ * same priority. If the queue is full, pushing a new task evicts the task with the lowest
+ * priority, which might be the newly pushed task itself.
+ *
+ * The priorities of all enqueued tasks can be updated in bulk, which also allows to
+ * cancel tasks that are no longer needed. This class is not thread-safe.
+ */
+template <typename KeyType, typename TaskType>
+class PriorityTaskQueue {
+public:
+    using Item = std::pair<KeyType, TaskType>;
+
+    /**
+     * \param maximumSize is the maximum number of tasks that can be enqueued at the same
+     *        time
+     */
+    PriorityTaskQueue(size_t maximumSize);
+
+    /**
+     * Enqueues the \p task with the provided \p key and \p priority. If a task with the
+     * same \p key is already enqueued, it is replaced and its priority is updated.
+     *
+     * \return The keys of the tasks that were evicted from the queue to make room for
+     *         the new task. This includes \p key if its \p priority was too low
+     */
+    std::vector<KeyType> push(KeyType key, TaskType task, float priority);
+
+    /**
+     * Pops the task with the highest priority. The queue must not be empty.
+     */
+    Item pop();
+
+    /**
+     * If a task with the \p key exists, it is bumped in front of all other tasks that
+     * have the same priority.
+     *
+     * \return true if a task with this key exists
+     */
+    bool touch(const KeyType& key);
+
+    /**
+     * Sets the priority of the task with the provided \p key.
+     *
+     * \return true if a task with this key exists
+     */
+    bool setPriority(const KeyType& key, float priority);
+
+    /**
+     * Updates the priorities of all enqueued tasks at once. The function \p f is called
+     * for every task with the key and the current priority and returns the new priority
+     * or <code>std::nullopt</code> if the task should be removed from the queue.
+     *
+     * \return The keys of all tasks that were removed from the queue
+     */
+    template <typename Func>
+    std::vector<KeyType> reprioritize(Func f);
+
+    /**
+     * Removes all tasks from the queue and returns their keys in the order in which they
+     * would have been popped.
+     */
+    std::vector<KeyType> popAllKeys();
+
+    void clear();
+    bool exist(const KeyType& key) const;
+    bool isEmpty() const;
+    size_t size() const;
+    size_t maximumSize() const;
+
+private:
+    struct Entry {
+        KeyType key;
+        TaskType task;
+        float priority;
+        uint64_t sequence;
+    };
+
+    /// Heap ordering that puts the task that should be executed first at the front
+    static bool isExecutedLater(const Entry& lhs, const Entry& rhs);
+
+    typename std::vector<Entry>::iterator find(const KeyType& key);
+
+    /// The enqueued tasks, organized as a binary max-heap using isExecutedLater
+    std::vector<Entry> _heap;
+    const size_t _maximumSize;
+    uint64_t _sequence = 0;
+};
+
+} // namespace openspace::globebrowsing
+
+#include <modules/globebrowsing/src/prioritytaskqueue.inl>
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_TASK_QUEUE___H__
@@ -0,0 +1,188 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+
+namespace openspace::globebrowsing {
+
+template <typename KeyType, typename TaskType>
+PriorityTaskQueue<KeyType, TaskType>::PriorityTaskQueue(size_t maximumSize)
+    : _maximumSize(maximumSize)
+{
+    _heap.reserve(_maximumSize + 1);
+}
+
+template <typename KeyType, typename TaskType>
+bool PriorityTaskQueue<KeyType, TaskType>::isExecutedLater(const Entry& lhs,
+                                                           const Entry& rhs)
+{
+    if (lhs.priority != rhs.priority) {
+        return lhs.priority < rhs.priority;
+    }
+    return lhs.sequence < rhs.sequence;
+}
+
+template <typename KeyType, typename TaskType>
+typename std::vector<typename PriorityTaskQueue<KeyType, TaskType>::Entry>::iterator
+PriorityTaskQueue<KeyType, TaskType>::find(const KeyType& key)
+{
+    return std::find_if(
+        _heap.begin(),
+        _heap.end(),
+        [&key](const Entry& e) { return e.key == key; }
+    );
+}
+
+template <typename KeyType, typename TaskType>
+std::vector<KeyType> PriorityTaskQueue<KeyType, TaskType>::push(KeyType key,
+                                                                TaskType task,
+                                                                float priority)
+{
+    const auto it = find(key);
+    if (it != _heap.end()) {
+        it->task = std::move(task);
+        it->priority = priority;
+        it->sequence = ++_sequence;
+        std::make_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+        return {};
+    }
+
+    _heap.push_back({ std::move(key), std::move(task), priority, ++_sequence });
+    std::push_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+
+    std::vector<KeyType> evicted;
+    while (_heap.size() > _maximumSize) {
+        // The entry that would be executed last is the smallest element of the heap
+        const auto last = std::min_element(_heap.begin(), _heap.end(), &isExecutedLater);
+        evicted.push_back(std::move(last->key));
+        std::iter_swap(last, _heap.end() - 1);
+        _heap.pop_back();
+        std::make_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+    }
+    return evicted;
+}
+
+template <typename KeyType, typename TaskType>
+std::pair<KeyType, TaskType> PriorityTaskQueue<KeyType, TaskType>::pop() {
+    ghoul_assert(!_heap.empty(), "Cannot pop task queue. Ensure queue is not empty");
+
+    std::pop_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+    Entry e = std::move(_heap.back());
+    _heap.pop_back();
+    return { std::move(e.key), std::move(e.task) };
+}
+
+template <typename KeyType, typename TaskType>
+bool PriorityTaskQueue<KeyType, TaskType>::touch(const KeyType& key) {
+    const auto it = find(key);
+    if (it == _heap.end()) {
+        return false;
+    }
+
+    it->sequence = ++_sequence;
+    std::make_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+    return true;
+}
+
+template <typename KeyType, typename TaskType>
+bool PriorityTaskQueue<KeyType, TaskType>::setPriority(const KeyType& key,
+                                                       float priority)
+{
+    const auto it = find(key);
+    if (it == _heap.end()) {
+        return false;
+    }
+
+    it->priority = priority;
+    std::make_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+    return true;
+}
+
+template <typename KeyType, typename TaskType>
+template <typename Func>
+std::vector<KeyType> PriorityTaskQueue<KeyType, TaskType>::reprioritize(Func f) {
+    // The new priorities are computed in a plain loop that compacts the kept entries
+    // towards the front, as the predicate of std::remove_if must not modify the entries
+    std::vector<KeyType> removed;
+    size_t nKept = 0;
+    for (size_t i = 0; i < _heap.size(); ++i) {
+        Entry& e = _heap[i];
+        const std::optional<float> priority = f(e.key, e.priority);
+        if (!priority.has_value()) {
+            removed.push_back(e.key);
+            continue;
+        }
+
+        e.priority = *priority;
+        if (nKept != i) {
+            _heap[nKept] = std::move(e);
+        }
+        ++nKept;
+    }
+    _heap.erase(_heap.begin() + nKept, _heap.end());
+    std::make_heap(_heap.begin(), _heap.end(), &isExecutedLater);
+    return removed;
+}
+
+template <typename KeyType, typename TaskType>
+std::vector<KeyType> PriorityTaskQueue<KeyType, TaskType>::popAllKeys() {
+    std::vector<KeyType> keys;
+    keys.reserve(_heap.size());
+    while (!_heap.empty()) {
+        keys.push_back(pop().first);
+    }
+    return keys;
+}
+
+template <typename KeyType, typename TaskType>
+void PriorityTaskQueue<KeyType, TaskType>::clear() {
+    _heap.clear();
+}
+
+template <typename KeyType, typename TaskType>
+bool PriorityTaskQueue<KeyType, TaskType>::exist(const KeyType& key) const {
+    return std::any_of(
+        _heap.begin(),
+        _heap.end(),
+        [&key](const Entry& e) { return e.key == key; }
+    );
+}
+
+template <typename KeyType, typename TaskType>
+bool PriorityTaskQueue<KeyType, TaskType>::isEmpty() const {
+    return _heap.empty();
+}
+
+template <typename KeyType, typename TaskType>
+size_t PriorityTaskQueue<KeyType, TaskType>::size() const {
+    return _heap.size();
+}
+
+template <typename KeyType, typename TaskType>
+size_t PriorityTaskQueue<KeyType, TaskType>::maximumSize() const {
+    return _maximumSize;
+}
+
+} // namespace openspace::globebrowsing
@@ -0,0 +1,128 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_THREAD_POOL___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_THREAD_POOL___H__
+
+#include <modules/globebrowsing/src/prioritytaskqueue.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Implementation based on http://progsch.net/wordpress/?p=81
+
+namespace openspace::globebrowsing {
+
+template<typename KeyType> class PriorityThreadPool;
+
+template<typename KeyType>
+class PriorityThreadPoolWorker {
+public:
+    PriorityThreadPoolWorker(PriorityThreadPool<KeyType>& pool);
+    void operator()();
+
+private:
+    PriorityThreadPool<KeyType>& _pool;
+};
+
+/**
+ * The <code>PriorityThreadPool</code> will only enqueue a certain number of tasks. The
+ * task with the highest priority is the one that will be executed first and among tasks
+ * with the same priority, the most recently enqueued or touched task is executed first.
+ * This class is templated on a key type which used as an identifier to determine wheter
+ * or not a task with the given key has been enqueued or not. This means that a task can
+ * be enqueued several times. The user must ensure that an enqueued task with a given key
+ * should be equal in outcome to a second enqueued task with the same key. If the queue is
+ * full, the task with the lowest priority is removed from the queue and its key is
+ * reported through <code>getUnqueuedTasksKeys</code>.
+ *
+ * A thread pool can be shared by several clients, in which case the keys have to
+ * identify the client as well. The functions that take a <code>KeyPredicate</code> only
+ * operate on the tasks of the client whose keys match the predicate.
+ */
+template<typename KeyType>
+class PriorityThreadPool {
+public:
+    using PriorityFunction = std::function<std::optional<float>(const KeyType&, float)>;
+    using KeyPredicate = std::function<bool(const KeyType&)>;
+
+    PriorityThreadPool(size_t numThreads, size_t queueSize);
+    PriorityThreadPool(const PriorityThreadPool& toCopy);
+    ~PriorityThreadPool();
+
+    void enqueue(std::function<void()> f, KeyType key, float priority = 0.f);
+    bool touch(KeyType key);
+
+    /**
+     * Removes all enqueued tasks whose key matches \p isSelected from the queue.
+     *
+     * \return The keys of the removed tasks
+     */
+    std::vector<KeyType> getQueuedTasksKeys(const KeyPredicate& isSelected);
+
+    /**
+     * Returns and forgets the keys that match \p isSelected of all tasks that were
+     * dropped from the queue because of their low priority.
+     */
+    std::vector<KeyType> getUnqueuedTasksKeys(const KeyPredicate& isSelected);
+
+    void clearEnqueuedTasks(const KeyPredicate& isSelected);
+
+    /**
+     * Removes all enqueued and dropped tasks whose key matches \p isSelected. This does
+     * not wait for the matching tasks that are currently executed, so a client of a
+     * shared thread pool that calls this before it is destroyed has to make sure that
+     * its tasks own the resources they depend on.
+     */
+    void removeTasks(const KeyPredicate& isSelected);
+
+    /**
+     * Updates the priorities of all enqueued tasks while holding the queue lock once.
+     * \p f is called with the key and current priority of every enqueued task and
+     * returns the new priority, or <code>std::nullopt</code> to cancel the task.
+     *
+     * \return The keys of the tasks that were cancelled
+     */
+    std::vector<KeyType> reprioritize(const PriorityFunction& f);
+
+private:
+    friend class PriorityThreadPoolWorker<KeyType>;
+
+    std::vector<std::thread> _workers;
+    PriorityTaskQueue<KeyType, std::function<void()>> _queuedTasks;
+    std::vector<KeyType> _unqueuedTasks;
+    std::mutex _queueMutex;
+    std::condition_variable _condition;
+
+    bool _stop = false;
+};
+
+} // namespace openspace::globebrowsing
+
+#include "prioritythreadpool.inl"
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_THREAD_POOL___H__
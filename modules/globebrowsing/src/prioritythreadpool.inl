@@ -25,12 +25,13 @@
 namespace openspace::globebrowsing {
 
 template<typename KeyType>
-LRUThreadPoolWorker<KeyType>::LRUThreadPoolWorker(LRUThreadPool<KeyType>& pool)
+PriorityThreadPoolWorker<KeyType>::PriorityThreadPoolWorker(
+                                                       PriorityThreadPool<KeyType>& pool)
     : _pool(pool)
 {}
 
 template<typename KeyType>
-void LRUThreadPoolWorker<KeyType>::operator()() {
+void PriorityThreadPoolWorker<KeyType>::operator()() {
     std::function<void()> task;
     while (true) {
         // acquire lock
@@ -48,7 +49,7 @@ void LRUThreadPoolWorker<KeyType>::operator()() {
             }
 
             // get the task from the queue
-            task = _pool._queuedTasks.popMRU().second;
+            task = _pool._queuedTasks.pop().second;
 
         }// release lock
 
@@ -58,22 +59,22 @@ void LRUThreadPoolWorker<KeyType>::operator()() {
 }
 
 template<typename KeyType>
-LRUThreadPool<KeyType>::LRUThreadPool(size_t numThreads, size_t queueSize)
+PriorityThreadPool<KeyType>::PriorityThreadPool(size_t numThreads, size_t queueSize)
     : _queuedTasks(queueSize)
 {
     for (size_t i = 0; i < numThreads; ++i) {
-        _workers.push_back(std::thread(LRUThreadPoolWorker<KeyType>(*this)));
+        _workers.push_back(std::thread(PriorityThreadPoolWorker<KeyType>(*this)));
     }
 }
 
 template<typename KeyType>
-LRUThreadPool<KeyType>::LRUThreadPool(const LRUThreadPool& toCopy)
-    : LRUThreadPool(toCopy._workers.size(), toCopy._queuedTasks.maximumCacheSize())
+PriorityThreadPool<KeyType>::PriorityThreadPool(const PriorityThreadPool& toCopy)
+    : PriorityThreadPool(toCopy._workers.size(), toCopy._queuedTasks.maximumSize())
 {}
 
 // the destructor joins all threads
 template<typename KeyType>
-LRUThreadPool<KeyType>::~LRUThreadPool() {
+PriorityThreadPool<KeyType>::~PriorityThreadPool() {
     {
         std::unique_lock lock(_queueMutex);
         _stop = true;
@@ -88,19 +89,21 @@ LRUThreadPool<KeyType>::~LRUThreadPool() {
 
 // add new work item to the pool
 template<typename KeyType>
-void LRUThreadPool<KeyType>::enqueue(std::function<void()> f, KeyType key) {
+void PriorityThreadPool<KeyType>::enqueue(std::function<void()> f, KeyType key,
+                                          float priority)
+{
     {
         std::unique_lock<std::mutex> lock(_queueMutex);
 
-        // add the task
-        //_queuedTasks.put(key, f);
-        const std::vector<std::pair<KeyType, std::function<void()>>>& unfinishedTasks =
-            _queuedTasks.putAndFetchPopped(key, f);
-        for (const std::pair<KeyType, std::function<void()>>& unfinishedTask :
-             unfinishedTasks)
-        {
-            _unqueuedTasks.push_back(unfinishedTask.first);
-        }
+        // add the task. If the queue is full, the tasks with the lowest priority are
+        // dropped and have to be ended by the caller
+        std::vector<KeyType> unfinishedTasks =
+            _queuedTasks.push(std::move(key), std::move(f), priority);
+        _unqueuedTasks.insert(
+            _unqueuedTasks.end(),
+            unfinishedTasks.begin(),
+            unfinishedTasks.end()
+        );
     }
 
     // wake up one thread
@@ -108,37 +111,61 @@ void LRUThreadPool<KeyType>::enqueue(std::function<void()> f, KeyType key) {
 }
 
 template<typename KeyType>
-bool LRUThreadPool<KeyType>::touch(KeyType key) {
+bool PriorityThreadPool<KeyType>::touch(KeyType key) {
     std::unique_lock<std::mutex> lock(_queueMutex);
     return _queuedTasks.touch(key);
 }
 
 template<typename KeyType>
-std::vector<KeyType> LRUThreadPool<KeyType>::getUnqueuedTasksKeys() {
-    std::vector<KeyType> toReturn = _unqueuedTasks;
+std::vector<KeyType> PriorityThreadPool<KeyType>::getUnqueuedTasksKeys(
+                                                         const KeyPredicate& isSelected)
+{
+    std::vector<KeyType> toReturn;
     {
         std::unique_lock<std::mutex> lock(_queueMutex);
-        _unqueuedTasks.clear();
+        std::vector<KeyType> remaining;
+        for (KeyType& key : _unqueuedTasks) {
+            if (isSelected(key)) {
+                toReturn.push_back(std::move(key));
+            }
+            else {
+                remaining.push_back(std::move(key));
+            }
+        }
+        _unqueuedTasks.swap(remaining);
     }
     return toReturn;
 }
 
 template<typename KeyType>
-std::vector<KeyType> LRUThreadPool<KeyType>::getQueuedTasksKeys() {
-    std::vector<KeyType> queuedTasks;
-    {
-        std::unique_lock<std::mutex> lock(_queueMutex);
-        while (!_queuedTasks.isEmpty()) {
-            queuedTasks.push_back(_queuedTasks.popMRU().first);
+std::vector<KeyType> PriorityThreadPool<KeyType>::getQueuedTasksKeys(
+                                                         const KeyPredicate& isSelected)
+{
+    std::unique_lock<std::mutex> lock(_queueMutex);
+    return _queuedTasks.reprioritize(
+        [&isSelected](const KeyType& key, float priority) -> std::optional<float> {
+            return isSelected(key) ? std::nullopt : std::optional<float>(priority);
         }
-    }
-    return queuedTasks;
+    );
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::clearEnqueuedTasks(const KeyPredicate& isSelected) {
+    getQueuedTasksKeys(isSelected);
 }
 
 template<typename KeyType>
-void LRUThreadPool<KeyType>::clearEnqueuedTasks() {
+void PriorityThreadPool<KeyType>::removeTasks(const KeyPredicate& isSelected) {
+    getQueuedTasksKeys(isSelected);
+    getUnqueuedTasksKeys(isSelected);
+}
+
+template<typename KeyType>
+std::vector<KeyType> PriorityThreadPool<KeyType>::reprioritize(
+                                                                const PriorityFunction& f)
+{
     std::unique_lock<std::mutex> lock(_queueMutex);
-    _queuedTasks.clear();
+    return _queuedTasks.reprioritize(f);
 }
 
 } // namespace openspace::globebrowsing
@@ -26,6 +26,7 @@
 
 #include <modules/globebrowsing/globebrowsingmodule.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tilemetadata.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
 #include <ghoul/fmt.h>
@@ -52,6 +53,7 @@
 #endif // _MSC_VER
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 
 namespace openspace::globebrowsing {
@@ -122,27 +124,21 @@ enum class Side {
     Bottom
 };
 
-float interpretFloat(GLenum glType, const std::byte* src) {
-    switch (glType) {
-        case GL_UNSIGNED_BYTE:
-            return static_cast<float>(*reinterpret_cast<const GLubyte*>(src));
-        case GL_UNSIGNED_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLushort*>(src));
-        case GL_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLshort*>(src));
-        case GL_UNSIGNED_INT:
-            return static_cast<float>(*reinterpret_cast<const GLuint*>(src));
-        case GL_INT:
-            return static_cast<float>(*reinterpret_cast<const GLint*>(src));
-        case GL_HALF_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLhalf*>(src));
-        case GL_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLfloat*>(src));
-        case GL_DOUBLE:
-            return static_cast<float>(*reinterpret_cast<const GLdouble*>(src));
-        default:
-            ghoul_assert(false, "Unknown data type");
-            throw ghoul::MissingCaseException();
+/**
+ * Copies the first channel of each pixel into the \p nCopies channels following it. The
+ * \p data consists of \p nPixels pixels of \p nRasters channels that are
+ * \p DatumSize bytes each.
+ */
+template <size_t DatumSize>
+void replicateFirstChannel(std::byte* data, size_t nPixels, size_t nRasters,
+                           int nCopies)
+{
+    const size_t bytesPerPixel = nRasters * DatumSize;
+    for (size_t i = 0; i < nPixels; ++i) {
+        std::byte* pixel = data + i * bytesPerPixel;
+        for (int c = 1; c <= nCopies; ++c) {
+            std::memcpy(pixel + c * DatumSize, pixel, DatumSize);
+        }
     }
 }
 
@@ -583,7 +579,7 @@ void RawTileDataReader::reset() {
     initialize();
 }
 
-RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
+RawTile::ReadError RawTileDataReader::rasterRead(const BandLayout& layout,
                                                  const IODescription& io,
                                                  char* dataDestination) const
 {
@@ -610,9 +606,12 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
     dataDest -= io.write.region.start.y * io.write.bytesPerLine;
     dataDest += io.write.region.start.x * _initData.bytesPerPixel;
 
-    GDALRasterBand* gdalRasterBand = _dataset->GetRasterBand(rasterBand);
+    // All bands are read with a single call, which lets GDAL fetch and decode each
+    // block of a pixel-interleaved dataset only once for all bands
+    std::array<int, 4> bands = layout.bands;
+    const GSpacing bandSpacing = layout.bandSpacing * _initData.bytesPerDatum;
     CPLErr readError = CE_Failure;
-    readError = gdalRasterBand->RasterIO(
+    readError = _dataset->RasterIO(
         GF_Read,
         io.read.region.start.x,         // Begin read x
         io.read.region.start.y,         // Begin read y
@@ -622,8 +621,11 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
         io.write.region.numPixels.x,    // width to write x in destination
         io.write.region.numPixels.y,    // width to write y in destination
         _dataType,                      // Type
-        static_cast<int>(_initData.bytesPerPixel), // Pixel spacing
-        -static_cast<int>(io.write.bytesPerLine)     // Line spacing
+        layout.nBands,                  // Number of bands to read
+        bands.data(),                   // The bands to read
+        static_cast<GSpacing>(_initData.bytesPerPixel), // Pixel spacing
+        -static_cast<GSpacing>(io.write.bytesPerLine),  // Line spacing
+        bandSpacing                                     // Band spacing
     );
 
     // Convert error to RawTile::ReadError
@@ -677,98 +679,89 @@ RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
 void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& worstError,
                                       char* imageDataDest) const
 {
+    const BandLayout layout = bandLayout();
+    const RawTile::ReadError err = repeatedRasterRead(layout, io, imageDataDest);
+    worstError = std::max(worstError, err);
+
+    if (layout.nCopies > 0) {
+        const size_t nPixels = _initData.totalNumBytes / _initData.bytesPerPixel;
+        std::byte* data = reinterpret_cast<std::byte*>(imageDataDest);
+        const size_t nRasters = _initData.nRasters;
+        switch (_initData.bytesPerDatum) {
+            case 1:
+                replicateFirstChannel<1>(data, nPixels, nRasters, layout.nCopies);
+                break;
+            case 2:
+                replicateFirstChannel<2>(data, nPixels, nRasters, layout.nCopies);
+                break;
+            case 4:
+                replicateFirstChannel<4>(data, nPixels, nRasters, layout.nCopies);
+                break;
+            case 8:
+                replicateFirstChannel<8>(data, nPixels, nRasters, layout.nCopies);
+                break;
+            default:
+                ghoul_assert(false, "Unsupported datum size");
+                throw ghoul::MissingCaseException();
+        }
+    }
+}
+
+RawTileDataReader::BandLayout RawTileDataReader::bandLayout() const {
+    const int nChannels = static_cast<int>(_initData.nRasters);
     // Only read the minimum number of rasters
-    int nRastersToRead = std::min(_rasterCount, static_cast<int>(_initData.nRasters));
+    const int nRastersToRead = std::min(_rasterCount, nChannels);
 
+    BandLayout layout;
     switch (_initData.ghoulTextureFormat) {
-        case ghoul::opengl::Texture::Format::Red: {
-            char* dest = imageDataDest;
-            const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-            worstError = std::max(worstError, err);
+        case ghoul::opengl::Texture::Format::Red:
+            layout.bands[0] = 1;
+            layout.nBands = 1;
             break;
-        }
         case ghoul::opengl::Texture::Format::RG:
         case ghoul::opengl::Texture::Format::RGB:
-        case ghoul::opengl::Texture::Format::RGBA: {
-            if (nRastersToRead == 1) { // Grayscale
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
-            }
-            else if (nRastersToRead == 2) { // Grayscale + alpha
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
-                // Last read is the alpha channel
-                char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = repeatedRasterRead(2, io, dest);
-                worstError = std::max(worstError, err);
-            }
-            else { // Three or more rasters
-                for (int i = 0; i < nRastersToRead; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(i + 1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
-            }
-            break;
-        }
+        case ghoul::opengl::Texture::Format::RGBA:
         case ghoul::opengl::Texture::Format::BGR:
         case ghoul::opengl::Texture::Format::BGRA: {
-            if (nRastersToRead == 1) { // Grayscale
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
+            const bool isBgr =
+                _initData.ghoulTextureFormat == ghoul::opengl::Texture::Format::BGR ||
+                _initData.ghoulTextureFormat == ghoul::opengl::Texture::Format::BGRA;
+
+            if (nRastersToRead <= 2 && nChannels >= 3) {
+                // Grayscale (+ alpha). The gray band is read once into the first channel
+                // and copied into the other two color channels
+                layout.bands[0] = 1;
+                layout.nBands = 1;
+                layout.nCopies = 2;
+                if (nRastersToRead == 2 && nChannels == 4) {
+                    // The alpha band goes into the last channel
+                    layout.bands[1] = 2;
+                    layout.nBands = 2;
+                    layout.bandSpacing = 3;
                 }
             }
-            else if (nRastersToRead == 2) { // Grayscale + alpha
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
-                // Last read is the alpha channel
-                char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = repeatedRasterRead(2, io, dest);
-                worstError = std::max(worstError, err);
+            else if (isBgr && nRastersToRead >= 3) {
+                // The first three bands are stored in reverse order, followed by alpha
+                layout.bands = { 3, 2, 1, 4 };
+                layout.nBands = nRastersToRead;
             }
-            else { // Three or more rasters
-                for (int i = 0; i < 3 && i < nRastersToRead; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(3 - i, io, dest);
-                    worstError = std::max(worstError, err);
+            else {
+                for (int i = 0; i < nRastersToRead; ++i) {
+                    layout.bands[i] = i + 1;
+                }
+                layout.nBands = nRastersToRead;
+                if (nRastersToRead == 1) {
+                    // A single band in a two channel texture
+                    layout.nCopies = nChannels - 1;
                 }
-            }
-            if (nRastersToRead > 3) { // Alpha channel exists
-                // Last read is the alpha channel
-                char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = repeatedRasterRead(4, io, dest);
-                worstError = std::max(worstError, err);
             }
             break;
         }
-        default: {
+        default:
             ghoul_assert(false, "Texture format not supported for tiles");
             break;
-        }
     }
+    return layout;
 }
 
 IODescription RawTileDataReader::ioDescription(const TileIndex& tileIndex) const {
@@ -815,11 +808,15 @@ const TileDepthTransform& RawTileDataReader::depthTransform() const {
     return _depthTransform;
 }
 
+const TileTextureInitData& RawTileDataReader::tileTextureInitData() const {
+    return _initData;
+}
+
 glm::ivec2 RawTileDataReader::fullPixelSize() const {
     return geodeticToPixel(Geodetic2{ 90.0, 180.0 }, _padfTransform);
 }
 
-RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
+RawTile::ReadError RawTileDataReader::repeatedRasterRead(const BandLayout& layout,
                                                          const IODescription& fullIO,
                                                          char* dataDestination,
                                                          int depth) const
@@ -916,7 +913,7 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
                 // as we can see in this example, it still has a top part outside the
                 // defined gdal region. This is handled through recursion.
                 const RawTile::ReadError err = repeatedRasterRead(
-                    rasterBand,
+                    layout,
                     cutoff,
                     dataDestination,
                     depth + 1
@@ -927,7 +924,7 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
         }
     }
 
-    const RawTile::ReadError err = rasterRead(rasterBand, io, dataDestination);
+    const RawTile::ReadError err = rasterRead(layout, io, dataDestination);
 
     // The return error from a repeated rasterRead is ONLY based on the main region,
     // which in the usual case will cover the main area of the patch anyway
@@ -937,49 +934,17 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
 TileMetaData RawTileDataReader::tileMetaData(RawTile& rawTile,
                                              const PixelRegion& region) const
 {
-    const size_t bytesPerLine = _initData.bytesPerPixel * region.numPixels.x;
-
-    TileMetaData ppData;
     ghoul_assert(_initData.nRasters <= 4, "Unexpected number of rasters");
-    ppData.nValues = static_cast<uint8_t>(_initData.nRasters);
-
-    std::fill(ppData.maxValues.begin(), ppData.maxValues.end(), -FLT_MAX);
-    std::fill(ppData.minValues.begin(), ppData.minValues.end(), FLT_MAX);
-    std::fill(ppData.hasMissingData.begin(), ppData.hasMissingData.end(), false);
-
-    bool allIsMissing = true;
-    for (int y = 0; y < region.numPixels.y; ++y) {
-        const size_t yi = (region.numPixels.y - 1 - y) * bytesPerLine;
-        size_t i = 0;
-        for (int x = 0; x < region.numPixels.x; ++x) {
-            for (size_t raster = 0; raster < _initData.nRasters; ++raster) {
-                const float noDataValue = noDataValueAsFloat();
-                const float val = interpretFloat(
-                    _initData.glType,
-                    &(rawTile.imageData.get()[yi + i])
-                );
-                if (val != noDataValue && val == val) {
-                    ppData.maxValues[raster] = std::max(
-                        val,
-                        ppData.maxValues[raster]
-                    );
-                    ppData.minValues[raster] = std::min(
-                        val,
-                        ppData.minValues[raster]
-                    );
-                    allIsMissing = false;
-                }
-                else {
-                    ppData.hasMissingData[raster] = true;
-                    float& floatToRewrite = reinterpret_cast<float&>(
-                        rawTile.imageData[yi + i]
-                    );
-                    floatToRewrite = -std::numeric_limits<float>::max();
-                }
-                i += _initData.bytesPerDatum;
-            }
-        }
-    }
+
+    bool allIsMissing = false;
+    TileMetaData ppData = computeTileMetaData(
+        rawTile.imageData.get(),
+        region.numPixels,
+        _initData.nRasters,
+        _initData.glType,
+        noDataValueAsFloat(),
+        allIsMissing
+    );
 
     if (allIsMissing) {
         rawTile.error = RawTile::ReadError::Failure;
@@ -29,6 +29,7 @@
 #include <modules/globebrowsing/src/rawtile.h>
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <ghoul/misc/boolean.h>
+#include <array>
 #include <string>
 #include <mutex>
 #include <gdal.h>
@@ -62,12 +63,29 @@ public:
 
     RawTile readTileData(TileIndex tileIndex) const;
     const TileDepthTransform& depthTransform() const;
+    const TileTextureInitData& tileTextureInitData() const;
     glm::ivec2 fullPixelSize() const;
 
 private:
+    /**
+     * Describes which raster bands of the dataset are read into which channels of a
+     * tile. All bands are read in a single pass, with the first band going into the
+     * first channel and each following band \c bandSpacing channels further. Afterwards
+     * the first channel is copied into the \c nCopies channels following it, so that
+     * a band that is used for multiple channels is only read once.
+     */
+    struct BandLayout {
+        std::array<int, 4> bands = { 0, 0, 0, 0 };
+        int nBands = 0;
+        int bandSpacing = 1;
+        int nCopies = 0;
+    };
+
     void initialize();
 
-    RawTile::ReadError rasterRead(int rasterBand, const IODescription& io,
+    BandLayout bandLayout() const;
+
+    RawTile::ReadError rasterRead(const BandLayout& layout, const IODescription& io,
         char* dataDestination) const;
 
     void readImageData(IODescription& io, RawTile::ReadError& worstError,
@@ -79,8 +97,8 @@ private:
      * A recursive function that is able to perform wrapping in case the read region of
      * the given IODescription is outside of the given write region.
      */
-    RawTile::ReadError repeatedRasterRead(int rasterBand, const IODescription& fullIO,
-        char* dataDestination, int depth = 0) const;
+    RawTile::ReadError repeatedRasterRead(const BandLayout& layout,
+        const IODescription& fullIO, char* dataDestination, int depth = 0) const;
 
     TileMetaData tileMetaData(RawTile& rawTile, const PixelRegion& region) const;
 
@@ -34,6 +34,7 @@
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
+#include <openspace/engine/windowdelegate.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scene/scene.h>
@@ -49,6 +50,7 @@
 #include <ghoul/opengl/textureunit.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
+#include <algorithm>
 #include <numeric>
 #include <queue>
 #include <vector>
@@ -452,6 +454,57 @@ bool intersects(const AABB3& bb, const AABB3& o) {
         && (bb.min.z <= o.max.z) && (o.min.z <= bb.max.z);
 }
 
+// Tiles of visible chunks are loaded before the tiles of culled chunks. Among the visible
+// chunks, the ones that are the furthest below their desired level are stretched the most
+// on screen and are loaded first. Ties are broken towards coarser levels, as their tiles
+// serve as a fallback for all of their descendants
+float tilePriority(const Chunk& chunk, int desiredLevel) {
+    const int level = chunk.tileIndex.level;
+    if (!chunk.isVisible) {
+        return -static_cast<float>(level);
+    }
+    const int deficit = std::max(desiredLevel - level, 0);
+    return 1.f + static_cast<float>(deficit) + 1.f / static_cast<float>(level + 1);
+}
+
+// Prefetched tiles are only loaded if there is nothing else to do, so their priority has
+// to be lower than the priority of every culled chunk
+constexpr const float PrefetchTilePriority = -1000.f;
+
+// The heights of the height queries are cached for this many cells per side of a tile,
+// which matches the resolution of the height tiles
+constexpr const unsigned int HeightCellsPerTile = 64;
+constexpr const size_t HeightCacheSize = 1 << 16;
+
+// The number of frames a height query waits for missing height tiles before it settles
+// for the best tiles that are loaded
+constexpr const int MaxHeightQueryFrames = 60;
+
+TileIndex tileIndexAt(const Geodetic2& position, int level) {
+    const int numIndicesAtLevel = 1 << level;
+    const double u = 0.5 + position.lon / glm::two_pi<double>();
+    const double v = 0.25 - position.lat / glm::two_pi<double>();
+    const int x = static_cast<int>(std::floor(u * numIndicesAtLevel));
+    const int y = static_cast<int>(std::floor(v * numIndicesAtLevel));
+
+    // There are twice as many tiles in longitude as in latitude
+    return TileIndex(
+        glm::clamp(x, 0, numIndicesAtLevel - 1),
+        glm::clamp(y, 0, numIndicesAtLevel / 2 - 1),
+        static_cast<uint8_t>(level)
+    );
+}
+
+// Returns the position relative to the south-west corner of the patch in [0, 1]
+glm::dvec2 patchUv(const GeodeticPatch& patch, const Geodetic2& position) {
+    const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
+    const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
+    return glm::dvec2(
+        (position.lon - southWest.lon) / (northEast.lon - southWest.lon),
+        (position.lat - southWest.lat) / (northEast.lat - southWest.lat)
+    );
+}
+
 } // namespace
 
 Chunk::Chunk(const TileIndex& ti)
@@ -536,6 +589,8 @@ RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     , _grid(DefaultSkirtedGridSegments, DefaultSkirtedGridSegments)
     , _leftRoot(Chunk(LeftHemisphereIndex))
     , _rightRoot(Chunk(RightHemisphereIndex))
+    , _heightQueries(MaxHeightQueryFrames)
+    , _heightCache(HeightCacheSize)
     , _ringsComponent(dictionary)
     , _shadowComponent(dictionary)
 {
@@ -611,15 +666,28 @@ RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     _debugProperties.showHeightResolution.onChange(notifyShaderRecompilation);
     _debugProperties.showHeightIntensities.onChange(notifyShaderRecompilation);
 
+    // Nothing resolves the height queries while the globe is disabled, so they would
+    // never be answered otherwise
+    onEnabledChange([this](bool isEnabled) {
+        if (isEnabled) {
+            _heightQueries.enable();
+        }
+        else {
+            _heightQueries.disable("The globe was disabled");
+        }
+    });
+
     _layerManager.onChange([&](Layer* l) {
         _shadersNeedRecompilation = true;
         _chunkCornersDirty = true;
         _nLayersIsDirty = true;
         _lastChangedLayer = l;
+        _heightCache.clear();
     });
 
     addPropertySubOwner(_debugPropertyOwner);
     addPropertySubOwner(_layerManager);
+    addPropertySubOwner(_tilePrefetcher);
 
     _globalChunkBuffer.resize(2048);
     _localChunkBuffer.resize(2048);
@@ -709,6 +777,9 @@ void RenderableGlobe::initializeGL() {
 }
 
 void RenderableGlobe::deinitialize() {
+    _heightQueries.abandon("The globe was deinitialized");
+    _heightCache.clear();
+
     _layerManager.deinitialize();
 }
 
@@ -881,6 +952,7 @@ void RenderableGlobe::update(const UpdateData& data) {
 
     if (_debugProperties.resetTileProviders) {
         _layerManager.reset();
+        _heightCache.clear();
         _debugProperties.resetTileProviders = false;
     }
 
@@ -892,6 +964,19 @@ void RenderableGlobe::update(const UpdateData& data) {
         _shadowComponent.update(data);
     }
 
+    // The height queries are resolved here instead of while rendering so that they are
+    // also answered while the globe is culled. If the globe was not rendered since the
+    // last update, the layers have to be updated here to receive the requested tiles
+    if (_heightQueries.hasPendingQueries()) {
+        if (!_renderedSinceLastUpdate) {
+            _layerManager.update();
+        }
+        _heightQueries.resolve([this](const Geodetic2& position, int level, bool use) {
+            return queryHeight(position, level, use);
+        });
+    }
+    _renderedSinceLastUpdate = false;
+
     // abock (2020-08-21)
     // This is a bit nasty every since we removed the second update call from the render
     // loop. The problem is when we enable a new layer, the dirty flags above will be set
@@ -943,6 +1028,7 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&,
         _layerManager.update();
         _layerManagerDirty = false;
     }
+    _renderedSinceLastUpdate = true;
 
     if (_nLayersIsDirty) {
         std::array<LayerGroup*, LayerManager::NumLayerGroups> lgs =
@@ -1056,6 +1142,41 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&,
     _allChunksAvailable = true;
     updateChunkTree(_leftRoot, data, mvp);
     updateChunkTree(_rightRoot, data, mvp);
+    std::vector<TileIndex> prefetchedTiles;
+    if (_tilePrefetcher.isEnabled()) {
+        // A prefetched tile is loaded as soon as any of the layers has its data
+        auto isLoaded = [this](const TileIndex& tileIndex) {
+            for (size_t i = 0; i < layergroupid::NUM_LAYER_GROUPS; ++i) {
+                for (Layer* layer :
+                     _layerManager.layerGroup(layergroupid::GroupID(i)).activeLayers())
+                {
+                    tileprovider::TileProvider* tileProvider = layer->tileProvider();
+                    if (tileProvider &&
+                        tileprovider::tileStatus(*tileProvider, tileIndex) ==
+                        Tile::Status::OK)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+        prefetchedTiles = _tilePrefetcher.update(
+            data.camera.positionVec3(),
+            _cachedInverseModelTransform,
+            _ellipsoid,
+            _generalProperties.currentLodScaleFactor,
+            MaxSplitDepth,
+            _tilePriorities,
+            global::windowDelegate->applicationTime(),
+            isLoaded
+        );
+        for (const TileIndex& tileIndex : prefetchedTiles) {
+            _tilePriorities.try_emplace(tileIndex.hashKey(), PrefetchTilePriority);
+        }
+    }
+    prioritizeTileRequests();
+    prefetchTiles(prefetchedTiles);
     _chunkCornersDirty = false;
     _iterationsOfAvailableData =
         (_allChunksAvailable ? _iterationsOfAvailableData + 1 : 0);
@@ -1897,8 +2018,6 @@ int RenderableGlobe::desiredLevel(const Chunk& chunk, const RenderData& renderDa
 float RenderableGlobe::getHeight(const glm::dvec3& position) const {
     ZoneScoped
 
-    float height = 0;
-
     // Get the uv coordinates to sample from
     const Geodetic2 geodeticPosition = _ellipsoid.cartesianToGeodetic2(position);
     const Chunk& node = geodeticPosition.lon < Coverage.center().lon ?
@@ -1906,39 +2025,18 @@ float RenderableGlobe::getHeight(const glm::dvec3& position) const {
         findChunkNode(_rightRoot, geodeticPosition);
     const int chunkLevel = node.tileIndex.level;
 
-
-    //TileIndex::TileIndex(const Geodetic2& point, int level_)
-    //    : level(level_)
-    //{
-    const int numIndicesAtLevel = 1 << chunkLevel;
-    const double u = 0.5 + geodeticPosition.lon / glm::two_pi<double>();
-    const double v = 0.25 - geodeticPosition.lat / glm::two_pi<double>();
-    const double xIndexSpace = u * numIndicesAtLevel;
-    const double yIndexSpace = v * numIndicesAtLevel;
-
-    const int x = static_cast<int>(floor(xIndexSpace));
-    const int y = static_cast<int>(floor(yIndexSpace));
-
     ghoul_assert(chunkLevel < std::numeric_limits<uint8_t>::max(), "Too high level");
-    const TileIndex tileIndex(x, y, static_cast<uint8_t>(chunkLevel));
-    const GeodeticPatch patch = GeodeticPatch(tileIndex);
+    return sampleHeight(geodeticPosition, tileIndexAt(geodeticPosition, chunkLevel));
+}
 
-    const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
-    const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
+float RenderableGlobe::sampleHeight(const Geodetic2& position,
+                                    const TileIndex& tileIndex) const
+{
+    ZoneScoped
 
-    const Geodetic2 geoDiffPatch = {
-        northEast.lat - southWest.lat,
-        northEast.lon - southWest.lon
-    };
+    float height = 0;
 
-    const Geodetic2 geoDiffPoint = {
-        geodeticPosition.lat - southWest.lat,
-        geodeticPosition.lon - southWest.lon
-    };
-    const glm::vec2 patchUV = glm::vec2(
-        geoDiffPoint.lon / geoDiffPatch.lon,
-        geoDiffPoint.lat / geoDiffPatch.lat
-    );
+    const glm::vec2 patchUV = glm::vec2(patchUv(GeodeticPatch(tileIndex), position));
 
     // Get the tile providers for the height maps
     const std::vector<Layer*>& heightMapLayers =
@@ -2046,6 +2144,88 @@ float RenderableGlobe::getHeight(const glm::dvec3& position) const {
     return height;
 }
 
+std::future<std::vector<float>> RenderableGlobe::heights(std::vector<Geodetic2> positions,
+                                                        int level)
+{
+    return _heightQueries.enqueue(
+        std::move(positions),
+        glm::clamp(level, MinSplitDepth, MaxSplitDepth)
+    );
+}
+
+std::optional<float> RenderableGlobe::queryHeight(const Geodetic2& position, int level,
+                                                  bool useAvailableData)
+{
+    const TileIndex tileIndex = tileIndexAt(position, level);
+    const GeodeticPatch patch = GeodeticPatch(tileIndex);
+
+    const glm::dvec2 uv = patchUv(patch, position);
+    const glm::uvec2 cellIndex = glm::min(
+        glm::uvec2(glm::max(uv, 0.0) * static_cast<double>(HeightCellsPerTile)),
+        glm::uvec2(HeightCellsPerTile - 1)
+    );
+    const HeightCell cell = {
+        tileIndex.hashKey(),
+        cellIndex.y * HeightCellsPerTile + cellIndex.x
+    };
+    if (_heightCache.exist(cell)) {
+        return _heightCache.get(cell);
+    }
+
+    bool isLoaded = true;
+    const std::vector<Layer*>& heightMapLayers =
+        _layerManager.layerGroup(layergroupid::GroupID::HeightLayers).activeLayers();
+    for (Layer* layer : heightMapLayers) {
+        tileprovider::TileProvider* tileProvider = layer->tileProvider();
+        if (!tileProvider) {
+            continue;
+        }
+
+        // Tile providers can not deliver tiles beyond their maximum level, so the tile
+        // that covers the tileIndex at that level is the best one to wait for
+        TileIndex ti = tileIndex;
+        const int maxLevel = tileprovider::maxLevel(*tileProvider);
+        while (ti.level > std::max(maxLevel, 0)) {
+            ti = TileIndex(ti.x / 2, ti.y / 2, static_cast<uint8_t>(ti.level - 1));
+        }
+        if (tileprovider::tileStatus(*tileProvider, ti) != Tile::Status::OK) {
+            isLoaded = false;
+            // The request has to be repeated every frame as it is cancelled otherwise
+            tileprovider::prefetch(*tileProvider, ti);
+        }
+    }
+    if (!isLoaded && !useAvailableData) {
+        return std::nullopt;
+    }
+
+    const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
+    const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
+    const glm::dvec2 cellCenter =
+        (glm::dvec2(cellIndex) + 0.5) / static_cast<double>(HeightCellsPerTile);
+    const Geodetic2 center = {
+        southWest.lat + cellCenter.y * (northEast.lat - southWest.lat),
+        southWest.lon + cellCenter.x * (northEast.lon - southWest.lon)
+    };
+    const float height = sampleHeight(center, tileIndex);
+
+    // Heights that were sampled from a coarser tile are improved on the next request
+    if (isLoaded) {
+        _heightCache.put(cell, height);
+    }
+    return height;
+}
+
+bool RenderableGlobe::HeightCell::operator==(const HeightCell& other) const {
+    return tileHashKey == other.tileHashKey && cell == other.cell;
+}
+
+size_t RenderableGlobe::HeightCellHasher::operator()(const HeightCell& heightCell) const
+{
+    const size_t tileHash = std::hash<TileIndex::TileHashKey>()(heightCell.tileHashKey);
+    return tileHash ^ (std::hash<unsigned int>()(heightCell.cell) + 0x9e3779b9 +
+        (tileHash << 6) + (tileHash >> 2));
+}
+
 void RenderableGlobe::calculateEclipseShadows(ghoul::opengl::ProgramObject& programObject,
                                              const RenderData& data, ShadowCompType stype)
 {
@@ -2516,6 +2696,7 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
     if (isLeaf(cn)) {
         ZoneScopedN("leaf")
         updateChunk(cn, data, mvp);
+        recordTilePriority(cn);
 
         if (cn.status == Chunk::Status::WantSplit) {
             splitChunkNode(cn, 1);
@@ -2538,6 +2719,7 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
 
         const bool allChildrenWantsMerge = requestedMergeMask == 0xf;
         updateChunk(cn, data, mvp);
+        recordTilePriority(cn);
 
         if (allChildrenWantsMerge && (cn.status != Chunk::Status::WantSplit)) {
             mergeChunkNode(cn);
@@ -2587,6 +2769,76 @@ void RenderableGlobe::updateChunk(Chunk& chunk, const RenderData& data,
     else {
         chunk.status = Chunk::Status::DoNothing;
     }
+
+    chunk.tilePriority = tilePriority(chunk, dl);
+}
+
+void RenderableGlobe::recordTilePriority(const Chunk& chunk) {
+    TileIndex ti = chunk.tileIndex;
+    while (true) {
+        const auto [it, inserted] =
+            _tilePriorities.try_emplace(ti.hashKey(), chunk.tilePriority);
+        if (!inserted) {
+            if (it->second >= chunk.tilePriority) {
+                // All ancestors already have at least this priority
+                break;
+            }
+            it->second = chunk.tilePriority;
+        }
+
+        if (ti.level == 0) {
+            break;
+        }
+        ti = TileIndex(ti.x / 2, ti.y / 2, static_cast<uint8_t>(ti.level - 1));
+    }
+}
+
+void RenderableGlobe::prioritizeTileRequests() {
+    ZoneScoped
+
+    auto priorities = std::make_shared<const TilePriorities>(std::move(_tilePriorities));
+    _tilePriorities = TilePriorities();
+    _tilePriorities.reserve(priorities->size());
+
+    for (size_t i = 0; i < layergroupid::NUM_LAYER_GROUPS; ++i) {
+        for (Layer* layer :
+             _layerManager.layerGroup(layergroupid::GroupID(i)).activeLayers())
+        {
+            tileprovider::TileProvider* tileProvider = layer->tileProvider();
+            if (tileProvider) {
+                tileprovider::prioritize(*tileProvider, priorities);
+            }
+        }
+    }
+}
+
+void RenderableGlobe::prefetchTiles(const std::vector<TileIndex>& tiles) {
+    ZoneScoped
+
+    // The tiles are sorted from coarse to fine, so the budget is spent on the tiles that
+    // cover the largest area first
+    int budget = _tilePrefetcher.budget();
+    for (const TileIndex& tileIndex : tiles) {
+        if (budget <= 0) {
+            break;
+        }
+
+        bool isRequested = false;
+        for (size_t i = 0; i < layergroupid::NUM_LAYER_GROUPS; ++i) {
+            for (Layer* layer :
+                 _layerManager.layerGroup(layergroupid::GroupID(i)).activeLayers())
+            {
+                tileprovider::TileProvider* tileProvider = layer->tileProvider();
+                if (tileProvider) {
+                    isRequested |= tileprovider::prefetch(*tileProvider, tileIndex);
+                }
+            }
+        }
+        if (isRequested) {
+            _tilePrefetcher.addRequestedTile(tileIndex);
+            budget--;
+        }
+    }
 }
 
 } // namespace openspace::globebrowsing
@@ -31,17 +31,23 @@
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/globelabelscomponent.h>
 #include <modules/globebrowsing/src/gpulayergroup.h>
+#include <modules/globebrowsing/src/heightqueryqueue.h>
 #include <modules/globebrowsing/src/layermanager.h>
+#include <modules/globebrowsing/src/lrucache.h>
 #include <modules/globebrowsing/src/ringscomponent.h>
 #include <modules/globebrowsing/src/shadowcomponent.h>
 #include <modules/globebrowsing/src/skirtedgrid.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tileprefetcher.h>
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <ghoul/misc/memorypool.h>
 #include <ghoul/opengl/uniformcache.h>
 #include <cstddef>
+#include <future>
+#include <optional>
+#include <vector>
 
 namespace openspace::documentation { struct Documentation; }
 
@@ -79,6 +85,9 @@ struct Chunk {
     bool colorTileOK = false;
     bool heightTileOK = false;
 
+    /// The priority with which the tiles of this chunk should be loaded
+    float tilePriority = 0.f;
+
     std::array<glm::dvec4, 8> corners;
     std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
 };
@@ -108,6 +117,26 @@ public:
     SurfacePositionHandle calculateSurfacePositionHandle(
         const glm::dvec3& targetModelSpace) const override;
 
+    /**
+     * Requests the heights of the height mapped surface above the reference ellipsoid at
+     * all \p positions, sampled from the height tiles at the provided \p level. Height
+     * tiles that are not loaded yet are requested and the returned future is fulfilled
+     * in a later frame, once they are available. If a tile could not be loaded after a
+     * number of frames, the best tile that is loaded at that point is used instead.
+     *
+     * The heights are cached per cell of the height tiles, so each returned height is
+     * the height at the center of the cell that contains the position. This function can
+     * be called from any thread. The queries are resolved during the update of the globe,
+     * so they are also answered while the globe is culled or not rendered at all. If the
+     * globe is disabled or deinitialized, the outstanding queries fail with a
+     * ghoul::RuntimeError.
+     *
+     * \param positions The geodetic positions for which the heights are requested
+     * \param level The level of the height tiles, clamped to the supported levels
+     * \return The heights in the same order as the \p positions
+     */
+    std::future<std::vector<float>> heights(std::vector<Geodetic2> positions, int level);
+
     bool renderedWithDesiredData() const override;
 
     const Ellipsoid& ellipsoid() const;
@@ -151,6 +180,18 @@ private:
 
     properties::PropertyOwner _shadowMappingPropertyOwner;
 
+    /// A cell of a height tile whose height is cached
+    struct HeightCell {
+        TileIndex::TileHashKey tileHashKey;
+        unsigned int cell;
+
+        bool operator==(const HeightCell& other) const;
+    };
+
+    struct HeightCellHasher {
+        size_t operator()(const HeightCell& heightCell) const;
+    };
+
     /**
      * Test if a specific chunk can safely be culled without affecting the rendered
      * image.
@@ -187,6 +228,21 @@ private:
      */
     float getHeight(const glm::dvec3& position) const;
 
+    /**
+     * Samples the height at the \p position from all active height layers, using the
+     * tile at \p tileIndex or, if that one is not loaded, its closest loaded ancestor.
+     */
+    float sampleHeight(const Geodetic2& position, const TileIndex& tileIndex) const;
+
+    /**
+     * Returns the height at the center of the height tile cell at \p level that
+     * contains \p position. If the tiles are not loaded, they are requested and
+     * std::nullopt is returned, unless \p useAvailableData is true, in which case the
+     * best loaded tiles are used instead.
+     */
+    std::optional<float> queryHeight(const Geodetic2& position, int level,
+        bool useAvailableData);
+
     void renderChunks(const RenderData& data, RendererTasks& rendererTask,
         const ShadowComponent::ShadowMapData& shadowData = {}, bool renderGeomOnly = false
     );
@@ -247,6 +303,24 @@ private:
     void mergeChunkNode(Chunk& cn);
     bool updateChunkTree(Chunk& cn, const RenderData& data, const glm::dmat4& mvp);
     void updateChunk(Chunk& chunk, const RenderData& data, const glm::dmat4& mvp) const;
+
+    /**
+     * Stores the tile priority of the \p chunk for itself and all of its ancestors, whose
+     * tiles are used as a fallback until the tile of the \p chunk is loaded.
+     */
+    void recordTilePriority(const Chunk& chunk);
+
+    /**
+     * Passes the tile priorities that were recorded during the last chunk tree traversal
+     * to the tile providers of all active layers.
+     */
+    void prioritizeTileRequests();
+
+    /**
+     * Requests the tiles that the globe is predicted to need in the near future, up to
+     * the per-frame budget of the TilePrefetcher.
+     */
+    void prefetchTiles(const std::vector<TileIndex>& tiles);
     void freeChunkNode(Chunk* n);
 
     Ellipsoid _ellipsoid;
@@ -266,6 +340,14 @@ private:
     Chunk _leftRoot;  // Covers all negative longitudes
     Chunk _rightRoot; // Covers all positive longitudes
 
+    TilePriorities _tilePriorities;
+    TilePrefetcher _tilePrefetcher;
+
+    HeightQueryQueue _heightQueries;
+    /// Whether the layers were updated while rendering since the last update
+    bool _renderedSinceLastUpdate = false;
+    cache::LRUCache<HeightCell, float, HeightCellHasher> _heightCache;
+
     // Two different shader programs. One for global and one for local rendering.
     struct {
         std::unique_ptr<ghoul::opengl::ProgramObject> program;
@@ -0,0 +1,318 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilecompression.h>
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    // The pixels of one block of 4x4 pixels in row-major order
+    struct Block {
+        std::array<glm::vec3, 16> colors;
+        std::array<bool, 16> isOpaque;
+        int nOpaque = 0;
+    };
+
+    struct EncodedBlock {
+        uint16_t color0 = 0;
+        uint16_t color1 = 0;
+        uint32_t indices = 0;
+        float error = std::numeric_limits<float>::max();
+    };
+
+    uint16_t packColor(const glm::vec3& color) {
+        const glm::vec3 c = glm::clamp(color, glm::vec3(0.f), glm::vec3(255.f));
+        const uint16_t r = static_cast<uint16_t>(c.r * (31.f / 255.f) + 0.5f);
+        const uint16_t g = static_cast<uint16_t>(c.g * (63.f / 255.f) + 0.5f);
+        const uint16_t b = static_cast<uint16_t>(c.b * (31.f / 255.f) + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    glm::vec3 unpackColor(uint16_t color) {
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+        return glm::vec3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+    }
+
+    float distanceSquared(const glm::vec3& lhs, const glm::vec3& rhs) {
+        const glm::vec3 d = lhs - rhs;
+        return glm::dot(d, d);
+    }
+
+    // Chooses the closest palette entry for each pixel of the block. Opaque blocks use
+    // the four-color mode (color0 > color1), blocks with transparent pixels the
+    // three-color mode (color0 <= color1) in which index 3 is transparent
+    EncodedBlock selectIndices(const Block& block, uint16_t color0, uint16_t color1) {
+        const bool isOpaque = block.nOpaque == 16;
+        if ((isOpaque && color0 < color1) || (!isOpaque && color0 > color1)) {
+            std::swap(color0, color1);
+        }
+
+        const glm::vec3 c0 = unpackColor(color0);
+        const glm::vec3 c1 = unpackColor(color1);
+        std::array<glm::vec3, 4> palette = { c0, c1, glm::vec3(0.f), glm::vec3(0.f) };
+        int nColors = 3;
+        if (isOpaque && color0 != color1) {
+            palette[2] = (2.f * c0 + c1) / 3.f;
+            palette[3] = (c0 + 2.f * c1) / 3.f;
+            nColors = 4;
+        }
+        else if (isOpaque) {
+            // Both colors are the same, which would select the three-color mode, but all
+            // pixels are represented by the first color anyway
+            nColors = 1;
+        }
+        else {
+            palette[2] = (c0 + c1) / 2.f;
+        }
+
+        EncodedBlock result = { color0, color1, 0, 0.f };
+        for (int i = 0; i < 16; ++i) {
+            uint32_t index = 3;
+            if (block.isOpaque[i]) {
+                index = 0;
+                float bestError = distanceSquared(block.colors[i], palette[0]);
+                for (int j = 1; j < nColors; ++j) {
+                    const float error = distanceSquared(block.colors[i], palette[j]);
+                    if (error < bestError) {
+                        bestError = error;
+                        index = j;
+                    }
+                }
+                result.error += bestError;
+            }
+            result.indices |= index << (2 * i);
+        }
+        return result;
+    }
+
+    // Finds the endpoints that minimize the squared error for the chosen indices of the
+    // opaque pixels, where each index interpolates between the endpoints with a fixed
+    // weight
+    EncodedBlock refineEndpoints(const Block& block, const EncodedBlock& encoded) {
+        const bool isOpaque = block.nOpaque == 16;
+        constexpr const std::array<float, 4> WeightsFourColors = { 1.f, 0.f, 2.f / 3.f,
+            1.f / 3.f };
+        constexpr const std::array<float, 4> WeightsThreeColors = { 1.f, 0.f, 0.5f, 0.f };
+        const std::array<float, 4>& weights =
+            isOpaque ? WeightsFourColors : WeightsThreeColors;
+
+        float aa = 0.f;
+        float ab = 0.f;
+        float bb = 0.f;
+        glm::vec3 ax = glm::vec3(0.f);
+        glm::vec3 bx = glm::vec3(0.f);
+        for (int i = 0; i < 16; ++i) {
+            if (!block.isOpaque[i]) {
+                continue;
+            }
+            const float w = weights[(encoded.indices >> (2 * i)) & 3];
+            aa += w * w;
+            ab += w * (1.f - w);
+            bb += (1.f - w) * (1.f - w);
+            ax += w * block.colors[i];
+            bx += (1.f - w) * block.colors[i];
+        }
+
+        const float det = aa * bb - ab * ab;
+        if (std::abs(det) < 1e-6f) {
+            return encoded;
+        }
+        const glm::vec3 a = (bb * ax - ab * bx) / det;
+        const glm::vec3 b = (aa * bx - ab * ax) / det;
+        return selectIndices(block, packColor(a), packColor(b));
+    }
+
+    EncodedBlock encodeBlock(const Block& block) {
+        if (block.nOpaque == 0) {
+            // Three-color mode with only transparent pixels
+            return { 0, 0, std::numeric_limits<uint32_t>::max(), 0.f };
+        }
+
+        glm::vec3 mean = glm::vec3(0.f);
+        glm::vec3 minimum = glm::vec3(255.f);
+        glm::vec3 maximum = glm::vec3(0.f);
+        for (int i = 0; i < 16; ++i) {
+            if (block.isOpaque[i]) {
+                mean += block.colors[i];
+                minimum = glm::min(minimum, block.colors[i]);
+                maximum = glm::max(maximum, block.colors[i]);
+            }
+        }
+        mean /= static_cast<float>(block.nOpaque);
+
+        // The endpoints are placed on the principal axis of the colors, which is found
+        // by a few power iterations on their covariance matrix
+        glm::mat3 covariance = glm::mat3(0.f);
+        for (int i = 0; i < 16; ++i) {
+            if (block.isOpaque[i]) {
+                const glm::vec3 d = block.colors[i] - mean;
+                covariance += glm::outerProduct(d, d);
+            }
+        }
+        glm::vec3 axis = maximum - minimum;
+        for (int i = 0; i < 4 && glm::dot(axis, axis) > 0.f; ++i) {
+            axis = covariance * axis;
+            const float length = std::max({ axis.r, axis.g, axis.b, -axis.r, -axis.g,
+                -axis.b });
+            if (length > 0.f) {
+                axis /= length;
+            }
+        }
+
+        glm::vec3 low = mean;
+        glm::vec3 high = mean;
+        if (glm::dot(axis, axis) > 0.f) {
+            float minProjection = std::numeric_limits<float>::max();
+            float maxProjection = -std::numeric_limits<float>::max();
+            for (int i = 0; i < 16; ++i) {
+                if (!block.isOpaque[i]) {
+                    continue;
+                }
+                const float projection = glm::dot(block.colors[i] - mean, axis);
+                if (projection < minProjection) {
+                    minProjection = projection;
+                    low = block.colors[i];
+                }
+                if (projection > maxProjection) {
+                    maxProjection = projection;
+                    high = block.colors[i];
+                }
+            }
+        }
+
+        const EncodedBlock initial =
+            selectIndices(block, packColor(high), packColor(low));
+        const EncodedBlock refined = refineEndpoints(block, initial);
+        return refined.error < initial.error ? refined : initial;
+    }
+
+    void writeBlock(const EncodedBlock& encoded, std::byte* destination) {
+        const std::array<uint8_t, 8> bytes = {
+            static_cast<uint8_t>(encoded.color0 & 0xFF),
+            static_cast<uint8_t>(encoded.color0 >> 8),
+            static_cast<uint8_t>(encoded.color1 & 0xFF),
+            static_cast<uint8_t>(encoded.color1 >> 8),
+            static_cast<uint8_t>(encoded.indices & 0xFF),
+            static_cast<uint8_t>((encoded.indices >> 8) & 0xFF),
+            static_cast<uint8_t>((encoded.indices >> 16) & 0xFF),
+            static_cast<uint8_t>(encoded.indices >> 24)
+        };
+        std::transform(
+            bytes.begin(),
+            bytes.end(),
+            destination,
+            [](uint8_t b) { return static_cast<std::byte>(b); }
+        );
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+bool isCompressible(const TileTextureInitData& initData, TileCompression compression) {
+    return compression != TileCompression::None &&
+        initData.compression == TileCompression::None &&
+        initData.glType == GL_UNSIGNED_BYTE &&
+        initData.ghoulTextureFormat == ghoul::opengl::Texture::Format::BGRA;
+}
+
+TileTextureInitData compressedTileTextureInitData(const TileTextureInitData& initData,
+                                                  TileCompression compression)
+{
+    return TileTextureInitData(
+        initData.dimensions.x,
+        initData.dimensions.y,
+        initData.glType,
+        initData.ghoulTextureFormat,
+        TileTextureInitData::PadTiles(initData.padTiles),
+        TileTextureInitData::ShouldAllocateDataOnCPU::No,
+        compression
+    );
+}
+
+void compressRawTile(RawTile& rawTile, TileCompression compression) {
+    const bool hasData = rawTile.error == RawTile::ReadError::None &&
+        rawTile.imageData && rawTile.textureInitData.has_value();
+    if (!hasData || !isCompressible(*rawTile.textureInitData, compression)) {
+        return;
+    }
+
+    const TileTextureInitData& initData = *rawTile.textureInitData;
+    TileTextureInitData compressed = compressedTileTextureInitData(initData, compression);
+    std::unique_ptr<std::byte[]> data(new std::byte[compressed.totalNumBytes]);
+    switch (compression) {
+        case TileCompression::BC1:
+            compressBC1(
+                rawTile.imageData.get(),
+                glm::ivec2(initData.dimensions),
+                data.get()
+            );
+            break;
+        default:
+            throw ghoul::MissingCaseException();
+    }
+
+    rawTile.imageData = std::move(data);
+    // The TileTextureInitData can not be assigned, so it has to be recreated in place
+    rawTile.textureInitData.reset();
+    rawTile.textureInitData.emplace(std::move(compressed));
+}
+
+void compressBC1(const std::byte* pixels, glm::ivec2 dimensions, std::byte* blocks) {
+    const glm::ivec2 nBlocks = (dimensions + 3) / 4;
+
+    Block block;
+    for (int by = 0; by < nBlocks.y; ++by) {
+        for (int bx = 0; bx < nBlocks.x; ++bx) {
+            block.nOpaque = 0;
+            for (int i = 0; i < 16; ++i) {
+                const int x = std::min(bx * 4 + i % 4, dimensions.x - 1);
+                const int y = std::min(by * 4 + i / 4, dimensions.y - 1);
+                const size_t offset = static_cast<size_t>(y) * dimensions.x + x;
+                const std::byte* p = pixels + 4 * offset;
+                block.colors[i] = glm::vec3(
+                    std::to_integer<int>(p[2]),
+                    std::to_integer<int>(p[1]),
+                    std::to_integer<int>(p[0])
+                );
+                block.isOpaque[i] = std::to_integer<int>(p[3]) >= 128;
+                block.nOpaque += block.isOpaque[i] ? 1 : 0;
+            }
+
+            const size_t blockIndex = static_cast<size_t>(by) * nBlocks.x + bx;
+            writeBlock(encodeBlock(block), blocks + 8 * blockIndex);
+        }
+    }
+}
+
+} // namespace openspace::globebrowsing
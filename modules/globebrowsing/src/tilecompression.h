@@ -0,0 +1,74 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_COMPRESSION___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_COMPRESSION___H__
+
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <ghoul/glm.h>
+#include <cstddef>
+
+namespace openspace::globebrowsing {
+
+struct RawTile;
+
+/**
+ * Returns whether tiles described by \p initData can be transcoded into the
+ * \p compression format. Only tiles with 8-bit BGRA pixels can be compressed.
+ */
+bool isCompressible(const TileTextureInitData& initData, TileCompression compression);
+
+/**
+ * Returns the description of the tiles described by \p initData after they have been
+ * transcoded into the \p compression format. Compressed textures are never kept in CPU
+ * memory, so the returned TileTextureInitData does not allocate data on the CPU.
+ */
+TileTextureInitData compressedTileTextureInitData(const TileTextureInitData& initData,
+    TileCompression compression);
+
+/**
+ * Transcodes the image data of the \p rawTile into the \p compression format and
+ * updates its TileTextureInitData accordingly. Tiles that failed to load or that are not
+ * compressible are left unchanged. This function is meant to be called on the threads
+ * that load the tiles before the tiles are handed to the render thread for upload.
+ */
+void compressRawTile(RawTile& rawTile, TileCompression compression);
+
+/**
+ * Compresses the image \p pixels of size \p dimensions, which consists of interleaved
+ * 8-bit blue, green, red, and alpha values, into BC1 blocks of 4x4 pixels. The blocks
+ * are written row by row to \p blocks, which has to be large enough to store
+ * <code>ceil(dimensions.x / 4) * ceil(dimensions.y / 4)</code> blocks of 8 bytes each.
+ *
+ * Each block consists of two little-endian 5:6:5 colors followed by 16 two-bit indices.
+ * Blocks that contain pixels with an alpha value below 128 are stored in the
+ * three-color mode of BC1, in which these pixels are transparent. If the \p dimensions
+ * are not a multiple of 4, the last row and column of the image are repeated to fill
+ * the blocks at the edges.
+ */
+void compressBC1(const std::byte* pixels, glm::ivec2 dimensions, std::byte* blocks);
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_COMPRESSION___H__
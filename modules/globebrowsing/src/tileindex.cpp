@@ -36,6 +36,12 @@ TileIndex::TileIndex(uint32_t x_, uint32_t y_, uint8_t level_)
     , level(level_)
 {}
 
+TileIndex::TileIndex(TileHashKey hashKey)
+    : x(static_cast<uint32_t>((hashKey >> 5) & ((1ULL << 30) - 1)))
+    , y(static_cast<uint32_t>(hashKey >> 35))
+    , level(static_cast<uint8_t>(hashKey & ((1ULL << 5) - 1)))
+{}
+
 TileIndex TileIndex::child(Quad q) const {
     return TileIndex(2 * x + q % 2, 2 * y + q / 2, level + 1);
 }
@@ -28,6 +28,7 @@
 #include <modules/globebrowsing/src/basictypes.h>
 #include <ghoul/glm.h>
 #include <stdint.h>
+#include <unordered_map>
 
 namespace openspace::globebrowsing {
 
@@ -36,6 +37,9 @@ struct TileIndex {
 
     TileIndex(uint32_t x, uint32_t y, uint8_t level);
 
+    /// Recreates the TileIndex from the key that was returned by <code>hashKey</code>
+    explicit TileIndex(TileHashKey hashKey);
+
     uint32_t x = 0;
     uint32_t y = 0;
     uint8_t level = 0;
@@ -47,6 +51,9 @@ struct TileIndex {
 
 bool operator==(const TileIndex& lhs, const TileIndex& rhs);
 
+/// Maps the hash keys of tiles to the priority with which they should be loaded
+using TilePriorities = std::unordered_map<TileIndex::TileHashKey, float>;
+
 } // namespace openspace::globebrowsing
 
 #endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_INDEX___H__
@@ -24,13 +24,20 @@
 
 #include <modules/globebrowsing/src/tileloadjob.h>
 
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tilecompression.h>
 
 namespace openspace::globebrowsing {
 
-TileLoadJob::TileLoadJob(RawTileDataReader& rawTileDataReader, TileIndex tileIndex)
-    : _rawTileDataReader(rawTileDataReader)
+TileLoadJob::TileLoadJob(std::shared_ptr<RawTileDataReader> rawTileDataReader,
+                         TileIndex tileIndex, cache::DiskTileCache* diskCache,
+                         uint64_t contentHash, TileCompression compression)
+    : _rawTileDataReader(std::move(rawTileDataReader))
     , _chunkIndex(std::move(tileIndex))
+    , _diskCache(diskCache)
+    , _contentHash(contentHash)
+    , _compression(compression)
 {}
 
 TileLoadJob::~TileLoadJob() {
@@ -40,7 +47,26 @@ TileLoadJob::~TileLoadJob() {
 }
 
 void TileLoadJob::execute() {
-    _rawTile = _rawTileDataReader.readTileData(_chunkIndex);
+    if (_diskCache) {
+        const cache::DiskTileKey key = { _chunkIndex, _contentHash };
+        std::optional<RawTile> tile = _diskCache->get(
+            key,
+            _rawTileDataReader->tileTextureInitData()
+        );
+        if (tile.has_value()) {
+            _rawTile = std::move(*tile);
+        }
+        else {
+            _rawTile = _rawTileDataReader->readTileData(_chunkIndex);
+            _diskCache->put(key, _rawTile);
+        }
+    }
+    else {
+        _rawTile = _rawTileDataReader->readTileData(_chunkIndex);
+    }
+
+    // Transcoding is done here, rather than on the render thread before the upload
+    compressRawTile(_rawTile, _compression);
     _hasTile = true;
 }
 
@@ -29,10 +29,13 @@
 
 #include <modules/globebrowsing/src/rawtile.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <memory>
 
 namespace openspace::globebrowsing {
 
 class RawTileDataReader;
+namespace cache { class DiskTileCache; }
 
 struct TileLoadJob : public Job<RawTile> {
     /**
@@ -40,8 +43,20 @@ struct TileLoadJob : public Job<RawTile> {
      * ownership of this data will be released. If <code>product()</code> has not been
      * called before the TileLoadJob is finished, the data will be deleted as it has not
      * been exposed outside of this object.
+     *
+     * If a \p diskCache is provided, the tile is loaded from it if it has been stored
+     * there under the \p contentHash and tiles that are read through the
+     * \p rawTileDataReader are added to it.
+     *
+     * If a \p compression is provided, compressible tiles are transcoded into it after
+     * they have been loaded. The disk cache always stores the uncompressed tiles.
+     *
+     * The job shares the ownership of the \p rawTileDataReader, so that a job that is
+     * still executed when its AsyncTileDataProvider is destroyed can finish.
      */
-    TileLoadJob(RawTileDataReader& rawTileDataReader, TileIndex tileIndex);
+    TileLoadJob(std::shared_ptr<RawTileDataReader> rawTileDataReader, TileIndex tileIndex,
+        cache::DiskTileCache* diskCache = nullptr, uint64_t contentHash = 0,
+        TileCompression compression = TileCompression::None);
 
     /**
      * Destroys the allocated data pointer if it has been allocated and the TileLoadJob
@@ -64,9 +79,12 @@ struct TileLoadJob : public Job<RawTile> {
     RawTile product() override;
 
 protected:
-    RawTileDataReader& _rawTileDataReader;
+    std::shared_ptr<RawTileDataReader> _rawTileDataReader;
     RawTile _rawTile;
     const TileIndex _chunkIndex;
+    cache::DiskTileCache* _diskCache;
+    const uint64_t _contentHash;
+    const TileCompression _compression;
     bool _hasTile = false;
 };
 
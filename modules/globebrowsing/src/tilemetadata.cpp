@@ -0,0 +1,437 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilemetadata.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_TILEMETADATA_SSE2
+#include <emmintrin.h>
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+
+namespace {
+    using openspace::globebrowsing::TileMetaData;
+
+    struct Accumulator {
+        TileMetaData metaData;
+        std::array<bool, 4> hasValidData = { false, false, false, false };
+    };
+
+    Accumulator initialAccumulator(size_t nRasters) {
+        Accumulator acc;
+        acc.metaData.nValues = static_cast<uint8_t>(nRasters);
+        std::fill(acc.metaData.maxValues.begin(), acc.metaData.maxValues.end(), -FLT_MAX);
+        std::fill(acc.metaData.minValues.begin(), acc.metaData.minValues.end(), FLT_MAX);
+        std::fill(
+            acc.metaData.hasMissingData.begin(),
+            acc.metaData.hasMissingData.end(),
+            false
+        );
+        return acc;
+    }
+
+    TileMetaData finish(const Accumulator& acc, bool& allIsMissing) {
+        allIsMissing = std::none_of(
+            acc.hasValidData.begin(),
+            acc.hasValidData.end(),
+            [](bool v) { return v; }
+        );
+        return acc.metaData;
+    }
+
+    // Inspects the values in [begin, end) one at a time. The value at index 0 belongs to
+    // the first raster
+    template <typename T>
+    void accumulate(T* values, size_t begin, size_t end, size_t nRasters,
+                    float noDataValue, Accumulator& acc)
+    {
+        size_t raster = begin % nRasters;
+        for (size_t i = begin; i < end; ++i) {
+            const float val = static_cast<float>(values[i]);
+            if (val != noDataValue && val == val) {
+                acc.metaData.maxValues[raster] = std::max(
+                    val,
+                    acc.metaData.maxValues[raster]
+                );
+                acc.metaData.minValues[raster] = std::min(
+                    val,
+                    acc.metaData.minValues[raster]
+                );
+                acc.hasValidData[raster] = true;
+            }
+            else {
+                acc.metaData.hasMissingData[raster] = true;
+                values[i] = std::numeric_limits<T>::lowest();
+            }
+            raster = (raster + 1 == nRasters) ? 0 : raster + 1;
+        }
+    }
+
+    template <typename T>
+    TileMetaData scalarKernel(std::byte* data, glm::ivec2 nPixels, size_t nRasters,
+                              float noDataValue, bool& allIsMissing)
+    {
+        Accumulator acc = initialAccumulator(nRasters);
+
+        // The lines are inspected from the bottom to the top. This order only matters
+        // for ties between positive and negative zero
+        T* values = reinterpret_cast<T*>(data);
+        const size_t valuesPerLine = static_cast<size_t>(nPixels.x) * nRasters;
+        for (int y = 0; y < nPixels.y; ++y) {
+            T* line = values + (nPixels.y - 1 - y) * valuesPerLine;
+            accumulate(line, 0, valuesPerLine, nRasters, noDataValue, acc);
+        }
+        return finish(acc, allIsMissing);
+    }
+
+#ifdef OPENSPACE_TILEMETADATA_SSE2
+    constexpr const size_t SimdWidth = 16;
+
+    __m128i select(__m128i mask, __m128i ifTrue, __m128i ifFalse) {
+        return _mm_or_si128(_mm_and_si128(mask, ifTrue), _mm_andnot_si128(mask, ifFalse));
+    }
+
+    // Applies the per-lane results of a SIMD kernel to the rasters. A lane l of a
+    // vector whose first value belongs to the first raster contains values of the
+    // raster l % nRasters. The lane masks contain sizeof(T) bits per lane
+    template <typename T>
+    void mergeLanes(const std::array<T, SimdWidth / sizeof(T)>& maxLanes,
+                    const std::array<T, SimdWidth / sizeof(T)>& minLanes,
+                    int validMask, int missingMask, size_t nRasters, Accumulator& acc)
+    {
+        for (size_t l = 0; l < maxLanes.size(); ++l) {
+            const size_t raster = l % nRasters;
+            const int bit = 1 << (l * sizeof(T));
+            if (validMask & bit) {
+                acc.metaData.maxValues[raster] = std::max(
+                    static_cast<float>(maxLanes[l]),
+                    acc.metaData.maxValues[raster]
+                );
+                acc.metaData.minValues[raster] = std::min(
+                    static_cast<float>(minLanes[l]),
+                    acc.metaData.minValues[raster]
+                );
+                acc.hasValidData[raster] = true;
+            }
+            if (missingMask & bit) {
+                acc.metaData.hasMissingData[raster] = true;
+            }
+        }
+    }
+
+    size_t simdKernel(float* values, size_t count, size_t nRasters, float noDataValue,
+                      Accumulator& acc)
+    {
+        const __m128 noData = _mm_set1_ps(noDataValue);
+        const __m128 lowest = _mm_set1_ps(-FLT_MAX);
+        const __m128 highest = _mm_set1_ps(FLT_MAX);
+
+        __m128 vMax = lowest;
+        __m128 vMin = highest;
+        int validMask = 0;
+        int missingMask = 0;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v = _mm_loadu_ps(values + i);
+            const __m128 valid = _mm_and_ps(
+                _mm_cmpneq_ps(v, noData),
+                _mm_cmpord_ps(v, v)
+            );
+            const int mask = _mm_movemask_epi8(_mm_castps_si128(valid));
+            validMask |= mask;
+            missingMask |= ~mask & 0xFFFF;
+
+            // Missing values are replaced by the lowest value, which is also the neutral
+            // element for the maximum
+            const __m128 forMax = _mm_or_ps(
+                _mm_and_ps(valid, v),
+                _mm_andnot_ps(valid, lowest)
+            );
+            const __m128 forMin = _mm_or_ps(
+                _mm_and_ps(valid, v),
+                _mm_andnot_ps(valid, highest)
+            );
+            vMax = _mm_max_ps(vMax, forMax);
+            vMin = _mm_min_ps(vMin, forMin);
+            if (mask != 0xFFFF) {
+                _mm_storeu_ps(values + i, forMax);
+            }
+        }
+
+        std::array<float, 4> maxLanes;
+        std::array<float, 4> minLanes;
+        _mm_storeu_ps(maxLanes.data(), vMax);
+        _mm_storeu_ps(minLanes.data(), vMin);
+        mergeLanes(maxLanes, minLanes, validMask, missingMask, nRasters, acc);
+        return i;
+    }
+
+    size_t simdKernel(int16_t* values, size_t count, size_t nRasters, float noDataValue,
+                      Accumulator& acc)
+    {
+        // Integer values can only be equal to a no data value that they can represent
+        const bool hasNoData = noDataValue >= std::numeric_limits<int16_t>::lowest() &&
+            noDataValue <= std::numeric_limits<int16_t>::max() &&
+            static_cast<float>(static_cast<int16_t>(noDataValue)) == noDataValue;
+        const __m128i noData = _mm_set1_epi16(
+            hasNoData ? static_cast<int16_t>(noDataValue) : 0
+        );
+        const __m128i lowest = _mm_set1_epi16(std::numeric_limits<int16_t>::lowest());
+        const __m128i highest = _mm_set1_epi16(std::numeric_limits<int16_t>::max());
+
+        __m128i vMax = lowest;
+        __m128i vMin = highest;
+        int validMask = 0;
+        int missingMask = 0;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i* p = reinterpret_cast<__m128i*>(values + i);
+            const __m128i v = _mm_loadu_si128(p);
+            const __m128i missing =
+                hasNoData ? _mm_cmpeq_epi16(v, noData) : _mm_setzero_si128();
+            const int mask = _mm_movemask_epi8(missing);
+            validMask |= ~mask & 0xFFFF;
+            missingMask |= mask;
+
+            const __m128i forMax = select(missing, lowest, v);
+            vMax = _mm_max_epi16(vMax, forMax);
+            vMin = _mm_min_epi16(vMin, select(missing, highest, v));
+            if (mask != 0) {
+                _mm_storeu_si128(p, forMax);
+            }
+        }
+
+        std::array<int16_t, 8> maxLanes;
+        std::array<int16_t, 8> minLanes;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxLanes.data()), vMax);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(minLanes.data()), vMin);
+        mergeLanes(maxLanes, minLanes, validMask, missingMask, nRasters, acc);
+        return i;
+    }
+
+    size_t simdKernel(uint8_t* values, size_t count, size_t nRasters, float noDataValue,
+                      Accumulator& acc)
+    {
+        // Integer values can only be equal to a no data value that they can represent
+        const bool hasNoData = noDataValue >= 0.f &&
+            noDataValue <= std::numeric_limits<uint8_t>::max() &&
+            static_cast<float>(static_cast<uint8_t>(noDataValue)) == noDataValue;
+        const __m128i noData = _mm_set1_epi8(
+            static_cast<char>(hasNoData ? static_cast<uint8_t>(noDataValue) : 0)
+        );
+        const __m128i lowest = _mm_setzero_si128();
+        const __m128i highest = _mm_set1_epi8(static_cast<char>(0xFF));
+
+        __m128i vMax = lowest;
+        __m128i vMin = highest;
+        int validMask = 0;
+        int missingMask = 0;
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i* p = reinterpret_cast<__m128i*>(values + i);
+            const __m128i v = _mm_loadu_si128(p);
+            const __m128i missing =
+                hasNoData ? _mm_cmpeq_epi8(v, noData) : _mm_setzero_si128();
+            const int mask = _mm_movemask_epi8(missing);
+            validMask |= ~mask & 0xFFFF;
+            missingMask |= mask;
+
+            const __m128i forMax = select(missing, lowest, v);
+            vMax = _mm_max_epu8(vMax, forMax);
+            vMin = _mm_min_epu8(vMin, select(missing, highest, v));
+            if (mask != 0) {
+                _mm_storeu_si128(p, forMax);
+            }
+        }
+
+        std::array<uint8_t, 16> maxLanes;
+        std::array<uint8_t, 16> minLanes;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxLanes.data()), vMax);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(minLanes.data()), vMin);
+        mergeLanes(maxLanes, minLanes, validMask, missingMask, nRasters, acc);
+        return i;
+    }
+
+    template <typename T>
+    constexpr bool HasSimdKernel = std::is_same_v<T, float> ||
+        std::is_same_v<T, int16_t> || std::is_same_v<T, uint8_t>;
+#else // ^^^ OPENSPACE_TILEMETADATA_SSE2 / !OPENSPACE_TILEMETADATA_SSE2 vvv
+    constexpr const size_t SimdWidth = 16;
+
+    template <typename T>
+    size_t simdKernel(T*, size_t, size_t, float, Accumulator&) {
+        return 0;
+    }
+
+    template <typename T>
+    constexpr bool HasSimdKernel = false;
+#endif // OPENSPACE_TILEMETADATA_SSE2
+
+    // The SIMD kernels process the values in a different order than the scalar kernel.
+    // The only observable difference is the sign of a zero minimum or maximum, which the
+    // scalar kernel takes from the last zero it inspected
+    void fixSignOfZeros(const float* values, glm::ivec2 nPixels, size_t nRasters,
+                        Accumulator& acc)
+    {
+        const size_t valuesPerLine = static_cast<size_t>(nPixels.x) * nRasters;
+        for (size_t raster = 0; raster < nRasters; ++raster) {
+            float& maxValue = acc.metaData.maxValues[raster];
+            float& minValue = acc.metaData.minValues[raster];
+            if (!acc.hasValidData[raster] || (maxValue != 0.f && minValue != 0.f)) {
+                continue;
+            }
+
+            // Search backwards through the order in which the scalar kernel inspects the
+            // values, that is top to bottom and right to left
+            bool found = false;
+            for (int y = 0; y < nPixels.y && !found; ++y) {
+                const float* line = values + y * valuesPerLine;
+                for (size_t i = valuesPerLine - nRasters + raster; ; i -= nRasters) {
+                    if (line[i] == 0.f) {
+                        if (maxValue == 0.f) {
+                            maxValue = line[i];
+                        }
+                        if (minValue == 0.f) {
+                            minValue = line[i];
+                        }
+                        found = true;
+                        break;
+                    }
+                    if (i < nRasters) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    TileMetaData kernel(std::byte* data, glm::ivec2 nPixels, size_t nRasters,
+                        float noDataValue, bool& allIsMissing)
+    {
+        // A SIMD vector has to contain the same rasters in the same lanes throughout
+        constexpr const size_t Lanes = SimdWidth / sizeof(T);
+        if constexpr (HasSimdKernel<T>) {
+            if (Lanes % nRasters == 0) {
+                Accumulator acc = initialAccumulator(nRasters);
+                T* values = reinterpret_cast<T*>(data);
+                const size_t count =
+                    static_cast<size_t>(nPixels.x) * static_cast<size_t>(nPixels.y) *
+                    nRasters;
+                const size_t end = simdKernel(values, count, nRasters, noDataValue, acc);
+                accumulate(values, end, count, nRasters, noDataValue, acc);
+                if constexpr (std::is_same_v<T, float>) {
+                    fixSignOfZeros(values, nPixels, nRasters, acc);
+                }
+                return finish(acc, allIsMissing);
+            }
+        }
+        return scalarKernel<T>(data, nPixels, nRasters, noDataValue, allIsMissing);
+    }
+
+    template <template <typename> typename Function>
+    TileMetaData dispatch(GLenum glType, std::byte* data, glm::ivec2 nPixels,
+                          size_t nRasters, float noDataValue, bool& allIsMissing)
+    {
+        ghoul_assert(nRasters >= 1 && nRasters <= 4, "Unexpected number of rasters");
+
+        if (nPixels.x <= 0 || nPixels.y <= 0) {
+            allIsMissing = true;
+            return initialAccumulator(nRasters).metaData;
+        }
+
+        const auto f = [&](auto t) {
+            using T = decltype(t);
+            return Function<T>()(data, nPixels, nRasters, noDataValue, allIsMissing);
+        };
+
+        switch (glType) {
+            case GL_UNSIGNED_BYTE:  return f(GLubyte());
+            case GL_UNSIGNED_SHORT: return f(GLushort());
+            case GL_SHORT:          return f(GLshort());
+            case GL_UNSIGNED_INT:   return f(GLuint());
+            case GL_INT:            return f(GLint());
+            case GL_HALF_FLOAT:     return f(GLhalf());
+            case GL_FLOAT:          return f(GLfloat());
+            case GL_DOUBLE:         return f(GLdouble());
+            default:
+                ghoul_assert(false, "Unknown data type");
+                throw ghoul::MissingCaseException();
+        }
+    }
+
+    template <typename T>
+    struct Kernel {
+        TileMetaData operator()(std::byte* data, glm::ivec2 nPixels, size_t nRasters,
+                                float noDataValue, bool& allIsMissing) const
+        {
+            return kernel<T>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        }
+    };
+
+    template <typename T>
+    struct ScalarKernel {
+        TileMetaData operator()(std::byte* data, glm::ivec2 nPixels, size_t nRasters,
+                                float noDataValue, bool& allIsMissing) const
+        {
+            return scalarKernel<T>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        }
+    };
+} // namespace
+
+namespace openspace::globebrowsing {
+
+TileMetaData computeTileMetaData(std::byte* data, glm::ivec2 nPixels, size_t nRasters,
+                                 GLenum glType, float noDataValue, bool& allIsMissing)
+{
+    return dispatch<Kernel>(glType, data, nPixels, nRasters, noDataValue, allIsMissing);
+}
+
+namespace detail {
+
+TileMetaData computeTileMetaDataScalar(std::byte* data, glm::ivec2 nPixels,
+                                       size_t nRasters, GLenum glType,
+                                       float noDataValue, bool& allIsMissing)
+{
+    return dispatch<ScalarKernel>(
+        glType,
+        data,
+        nPixels,
+        nRasters,
+        noDataValue,
+        allIsMissing
+    );
+}
+
+} // namespace detail
+
+} // namespace openspace::globebrowsing
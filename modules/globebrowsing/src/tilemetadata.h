@@ -0,0 +1,64 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <ghoul/glm.h>
+#include <ghoul/opengl/ghoul_gl.h>
+#include <cstddef>
+
+namespace openspace::globebrowsing {
+
+/**
+ * Computes the minimum and maximum value of each raster of the tile image in \p data,
+ * ignoring values that are NaN or equal to the \p noDataValue. These missing values are
+ * overwritten in \p data with the lowest value that is representable by the \p glType
+ * and the rasters that contained them are flagged in the returned TileMetaData.
+ *
+ * The \p data consists of \p nPixels.y lines of \p nPixels.x pixels without padding,
+ * each pixel consisting of \p nRasters interleaved values of the type \p glType. The
+ * computation is specialized for each \p glType and uses SIMD instructions, where
+ * available, for 8-bit unsigned, 16-bit signed, and 32-bit floating point values.
+ *
+ * \param allIsMissing Is set to \c true if all values in the \p data are missing
+ */
+TileMetaData computeTileMetaData(std::byte* data, glm::ivec2 nPixels, size_t nRasters,
+    GLenum glType, float noDataValue, bool& allIsMissing);
+
+namespace detail {
+
+/**
+ * The scalar reference implementation of computeTileMetaData that inspects one value
+ * at a time. The results of both functions are identical.
+ */
+TileMetaData computeTileMetaDataScalar(std::byte* data, glm::ivec2 nPixels,
+    size_t nRasters, GLenum glType, float noDataValue, bool& allIsMissing);
+
+} // namespace detail
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA___H__
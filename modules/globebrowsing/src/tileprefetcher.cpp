@@ -0,0 +1,273 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tileprefetcher.h>
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <openspace/engine/globals.h>
+#include <openspace/interaction/keyframenavigator.h>
+#include <openspace/interaction/navigationhandler.h>
+#include <openspace/interaction/sessionrecording.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+namespace {
+    // The weight of the newest velocity sample in the exponentially smoothed camera
+    // velocity that is used for the extrapolation
+    constexpr const double VelocitySmoothing = 0.2;
+
+    // Prefetched tiles that have not been requested after this many look-ahead times
+    // are considered wasted
+    constexpr const double ExpirationFactor = 2.0;
+
+    // The maximum number of tiles that are predicted per frame. Most of them are usually
+    // already loaded, so this is considerably larger than the budget
+    constexpr const size_t MaxPredictedTiles = 1024;
+
+    constexpr openspace::properties::Property::PropertyInfo EnabledInfo = {
+        "Enabled",
+        "Enabled",
+        "If enabled, tiles that the globe is predicted to need in the near future are "
+        "requested at a low priority before they are needed."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo LookAheadInfo = {
+        "LookAhead",
+        "Look ahead (s)",
+        "The number of seconds into the future for which the camera position is "
+        "predicted."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo BudgetInfo = {
+        "Budget",
+        "Budget",
+        "The maximum number of tiles that are prefetched per frame."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo UsedTilesInfo = {
+        "UsedTiles",
+        "Used tiles",
+        "The number of prefetched tiles that were later requested by the globe."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo WastedTilesInfo = {
+        "WastedTiles",
+        "Wasted tiles",
+        "The number of prefetched tiles that were not requested by the globe within "
+        "twice the look-ahead time."
+    };
+} // namespace
+
+namespace openspace::globebrowsing {
+
+TilePrefetcher::TilePrefetcher()
+    : properties::PropertyOwner({ "TilePrefetch" })
+    , _enabled(EnabledInfo, true)
+    , _lookAhead(LookAheadInfo, 2.f, 0.1f, 10.f)
+    , _budget(BudgetInfo, 16, 0, 256)
+    , _usedTiles(UsedTilesInfo, 0, 0, std::numeric_limits<int>::max())
+    , _wastedTiles(WastedTilesInfo, 0, 0, std::numeric_limits<int>::max())
+{
+    addProperty(_enabled);
+    addProperty(_lookAhead);
+    addProperty(_budget);
+    _usedTiles.setReadOnly(true);
+    addProperty(_usedTiles);
+    _wastedTiles.setReadOnly(true);
+    addProperty(_wastedTiles);
+}
+
+std::vector<TileIndex> TilePrefetcher::update(const glm::dvec3& cameraPosition,
+                                              const glm::dmat4& inverseModelTransform,
+                                              const Ellipsoid& ellipsoid,
+                                              double lodScaleFactor, int maxLevel,
+                                              const TilePriorities& requestedTiles,
+                                              double time,
+                               const std::function<bool(const TileIndex&)>& isLoaded)
+{
+    ZoneScoped
+
+    // A prefetch request only counts once its data has arrived. Requests for tiles that
+    // the globe needed before that did not save any time, and the remaining ones have
+    // most likely been dropped from the tile queue without ever being executed
+    for (auto it = _requestedTiles.begin(); it != _requestedTiles.end();) {
+        if (isLoaded(TileIndex(it->first))) {
+            _pendingTiles[it->first] = time + ExpirationFactor * _lookAhead;
+            it = _requestedTiles.erase(it);
+        }
+        else if (requestedTiles.find(it->first) != requestedTiles.end() ||
+            time > it->second)
+        {
+            it = _requestedTiles.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    for (auto it = _pendingTiles.begin(); it != _pendingTiles.end();) {
+        if (requestedTiles.find(it->first) != requestedTiles.end()) {
+            _nUsedTiles++;
+            it = _pendingTiles.erase(it);
+        }
+        else if (time > it->second) {
+            _nWastedTiles++;
+            it = _pendingTiles.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    _usedTiles = _nUsedTiles;
+    _wastedTiles = _nWastedTiles;
+
+    const std::optional<glm::dvec3> predicted =
+        predictCameraPosition(cameraPosition, inverseModelTransform, time);
+    if (!predicted.has_value()) {
+        return {};
+    }
+
+    return predictedTiles(
+        *predicted,
+        ellipsoid,
+        lodScaleFactor,
+        maxLevel,
+        requestedTiles,
+        MaxPredictedTiles
+    );
+}
+
+void TilePrefetcher::addRequestedTile(const TileIndex& tileIndex) {
+    _requestedTiles[tileIndex.hashKey()] = _previousTime + ExpirationFactor * _lookAhead;
+}
+
+std::vector<TileIndex> TilePrefetcher::predictedTiles(const glm::dvec3& cameraPosition,
+                                                      const Ellipsoid& ellipsoid,
+                                                      double lodScaleFactor,
+                                                      int maxLevel,
+                                                      const TilePriorities& exclude,
+                                                      size_t maxTiles)
+{
+    ZoneScoped
+
+    const Geodetic2 cameraGeodetic = ellipsoid.cartesianToGeodetic2(cameraPosition);
+    const double scaleFactor = lodScaleFactor * ellipsoid.minimumRadius();
+
+    std::vector<TileIndex> tiles;
+    // Breadth-first traversal starting from the two hemispheres, so that the coarsest
+    // tiles are returned first
+    std::deque<TileIndex> queue = { TileIndex(0, 0, 1), TileIndex(1, 0, 1) };
+    while (!queue.empty() && tiles.size() < maxTiles) {
+        const TileIndex tileIndex = queue.front();
+        queue.pop_front();
+
+        const GeodeticPatch patch(tileIndex);
+        const Geodetic2 closestPoint = patch.closestPoint(cameraGeodetic);
+        const glm::dvec3 surface = ellipsoid.cartesianSurfacePosition(closestPoint);
+        const glm::dvec3 toCamera = cameraPosition - surface;
+
+        // If the closest point of the patch faces away from the camera, the entire patch
+        // is hidden behind the horizon
+        const glm::dvec3 normal = ellipsoid.geodeticSurfaceNormal(closestPoint);
+        if (glm::dot(normal, toCamera) < 0.0) {
+            continue;
+        }
+
+        if (exclude.find(tileIndex.hashKey()) == exclude.end()) {
+            tiles.push_back(tileIndex);
+        }
+
+        // Avoid division by zero if the camera is located on the surface
+        const double distance = std::max(glm::length(toCamera), 1.0);
+        const double desiredLevel = std::ceil(std::log2(scaleFactor / distance));
+        if (tileIndex.level < std::min(desiredLevel, static_cast<double>(maxLevel))) {
+            for (int q = 0; q < 4; ++q) {
+                queue.push_back(tileIndex.child(static_cast<Quad>(q)));
+            }
+        }
+    }
+    return tiles;
+}
+
+std::optional<glm::dvec3> TilePrefetcher::predictCameraPosition(
+                                                 const glm::dvec3& cameraPosition,
+                                                 const glm::dmat4& inverseModelTransform,
+                                                 double time)
+{
+    const glm::dvec3 position =
+        glm::dvec3(inverseModelTransform * glm::dvec4(cameraPosition, 1.0));
+
+    if (_previousTime >= 0.0 && time > _previousTime) {
+        const double dt = time - _previousTime;
+        const glm::dvec3 v = (position - _previousCameraPosition) / dt;
+        _velocity = glm::mix(_velocity, v, VelocitySmoothing);
+    }
+    _previousCameraPosition = position;
+    _previousTime = time;
+
+    // If the camera follows a recorded path, we can read ahead in the path instead of
+    // guessing where the camera will go
+    std::optional<glm::dvec3> future;
+    if (global::sessionRecording->isPlayingBack()) {
+        future = global::sessionRecording->futureCameraPosition(_lookAhead);
+    }
+    else {
+        interaction::KeyframeNavigator& navigator =
+            global::navigationHandler->keyframeNavigator();
+        if (navigator.nKeyframes() > 0) {
+            future = navigator.futureCameraPosition(_lookAhead);
+        }
+    }
+    if (future.has_value()) {
+        return glm::dvec3(inverseModelTransform * glm::dvec4(*future, 1.0));
+    }
+
+    if (_velocity == glm::dvec3(0.0)) {
+        return std::nullopt;
+    }
+    return position + _velocity * static_cast<double>(_lookAhead);
+}
+
+bool TilePrefetcher::isEnabled() const {
+    return _enabled;
+}
+
+int TilePrefetcher::budget() const {
+    return _budget;
+}
+
+int TilePrefetcher::nUsedTiles() const {
+    return _nUsedTiles;
+}
+
+int TilePrefetcher::nWastedTiles() const {
+    return _nWastedTiles;
+}
+
+} // namespace openspace::globebrowsing
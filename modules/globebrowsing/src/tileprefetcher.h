@@ -0,0 +1,141 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILEPREFETCHER___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILEPREFETCHER___H__
+
+#include <openspace/properties/propertyowner.h>
+
+#include <modules/globebrowsing/src/tileindex.h>
+#include <openspace/properties/scalar/boolproperty.h>
+#include <openspace/properties/scalar/floatproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <ghoul/glm.h>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+class Ellipsoid;
+
+/**
+ * Predicts where the camera of a globe will be a few seconds into the future and which
+ * tiles the globe will need at that point. If a session recording is played back or the
+ * KeyframeNavigator has camera keyframes, the prediction reads ahead in the recorded
+ * camera path; otherwise the current camera motion is extrapolated. A tile that is
+ * requested for prefetching only enters the statistics once its data has been loaded, as
+ * the request might be dropped from the tile queue before it is executed. From then on,
+ * it is tracked until it is either requested by the globe, in which case it counts as
+ * used, or until it has not been requested for twice the look-ahead time, in which case
+ * it counts as wasted.
+ */
+class TilePrefetcher : public properties::PropertyOwner {
+public:
+    TilePrefetcher();
+
+    /**
+     * Updates the statistics of the previously prefetched tiles and predicts the camera
+     * position. Returns the tiles that the globe will need at the predicted camera
+     * position, coarsest level first, excluding the \p requestedTiles.
+     *
+     * \param cameraPosition The current camera position in world space
+     * \param inverseModelTransform The transformation from world space into the model
+     *        space of the globe
+     * \param ellipsoid The ellipsoid of the globe
+     * \param lodScaleFactor The level of detail scale factor of the globe
+     * \param maxLevel The highest level that will be returned
+     * \param requestedTiles The tiles that the globe requested in the current frame
+     * \param time The current application time in seconds
+     * \param isLoaded Returns whether the data of a tile that was requested through
+     *        #addRequestedTile has been loaded
+     */
+    std::vector<TileIndex> update(const glm::dvec3& cameraPosition,
+        const glm::dmat4& inverseModelTransform, const Ellipsoid& ellipsoid,
+        double lodScaleFactor, int maxLevel, const TilePriorities& requestedTiles,
+        double time, const std::function<bool(const TileIndex&)>& isLoaded);
+
+    /**
+     * Marks that a load request for the \p tileIndex has been issued ahead of time. The
+     * tile is taken into account in the used and wasted tile statistics once #update
+     * finds its data loaded. If that does not happen within twice the look-ahead time or
+     * if the globe requests the tile before that, it is not counted at all.
+     */
+    void addRequestedTile(const TileIndex& tileIndex);
+
+    /**
+     * Returns the camera position in model space one look-ahead time into the future or
+     * std::nullopt if the camera is not expected to move. The current camera position
+     * and \p time are used to update the estimated camera velocity, so this function
+     * must only be called once per frame.
+     */
+    std::optional<glm::dvec3> predictCameraPosition(const glm::dvec3& cameraPosition,
+        const glm::dmat4& inverseModelTransform, double time);
+
+    /**
+     * Returns the tiles that a globe needs if the camera is located at
+     * \p cameraPosition in model space, in breadth-first order. The desired level of
+     * each tile is determined by its distance to the camera, similar to
+     * RenderableGlobe::desiredLevelByDistance, and tiles behind the horizon are culled.
+     * Tiles that are part of \p exclude are traversed but not returned.
+     */
+    static std::vector<TileIndex> predictedTiles(const glm::dvec3& cameraPosition,
+        const Ellipsoid& ellipsoid, double lodScaleFactor, int maxLevel,
+        const TilePriorities& exclude, size_t maxTiles);
+
+    bool isEnabled() const;
+
+    /// The maximum number of tiles that should be prefetched per frame
+    int budget() const;
+
+    int nUsedTiles() const;
+    int nWastedTiles() const;
+
+private:
+    properties::BoolProperty _enabled;
+    properties::FloatProperty _lookAhead;
+    properties::IntProperty _budget;
+    properties::IntProperty _usedTiles;
+    properties::IntProperty _wastedTiles;
+
+    /// The camera position in model space and the time of the previous update
+    glm::dvec3 _previousCameraPosition = glm::dvec3(0.0);
+    double _previousTime = -1.0;
+    /// The smoothed velocity of the camera in model space
+    glm::dvec3 _velocity = glm::dvec3(0.0);
+
+    /// The tiles whose prefetch requests have been issued but whose data has not been
+    /// loaded yet, mapped to the time at which the requests are given up on
+    std::unordered_map<TileIndex::TileHashKey, double> _requestedTiles;
+    /// The prefetched tiles that have not been requested by the globe yet, mapped to the
+    /// time at which they are considered to be wasted
+    std::unordered_map<TileIndex::TileHashKey, double> _pendingTiles;
+    int _nUsedTiles = 0;
+    int _nWastedTiles = 0;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILEPREFETCHER___H__
@@ -26,14 +26,17 @@
 
 #include <modules/globebrowsing/globebrowsingmodule.h>
 #include <modules/globebrowsing/src/asynctiledataprovider.h>
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/layermanager.h>
 #include <modules/globebrowsing/src/memoryawaretilecache.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tilecompression.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/util/factorymanager.h>
+#include <openspace/util/threadpool.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/spicemanager.h>
 #include <ghoul/filesystem/file.h>
@@ -44,7 +47,12 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
 #include <ghoul/opengl/openglstatecache.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <fstream>
+#include <functional>
+#include <optional>
 #include "cpl_minixml.h"
 
 namespace ghoul {
@@ -88,6 +96,7 @@ namespace defaultprovider {
     constexpr const char* KeyPerformPreProcessing = "PerformPreProcessing";
     constexpr const char* KeyTilePixelSize = "TilePixelSize";
     constexpr const char* KeyPadTiles = "PadTiles";
+    constexpr const char* KeyCompressTiles = "CompressTiles";
 
     constexpr openspace::properties::Property::PropertyInfo FilePathInfo = {
         "FilePath",
@@ -141,6 +150,24 @@ namespace temporal {
     constexpr const char* TimeEnd = "OpenSpaceTimeEnd";
     constexpr const char* TimeResolution = "OpenSpaceTimeResolution";
     constexpr const char* TimeFormat = "OpenSpaceTimeIdFormat";
+    constexpr const char* KeyCacheSize = "CacheSize";
+
+    // The number of tile providers of different times that are kept alive by default
+    constexpr const int DefaultCacheSize = 16;
+    constexpr const int MaxPreloadSteps = 4;
+    // The current time and the preloaded times in both directions have to fit into the
+    // cache at the same time
+    constexpr const int MinCacheSize = 2 * MaxPreloadSteps + 2;
+
+    constexpr const size_t NumThreads = 2;
+    constexpr const size_t ThreadPoolQueueSize = 32;
+    // The number of tiles of all preloaded times together that are requested in one
+    // frame, which leaves most of the thread pool's queue to the current time
+    constexpr const size_t MaxPreloadedTilesPerFrame = ThreadPoolQueueSize / 4;
+
+    // The requests of the preloaded times are ranked below all requests of the current
+    // time, including the tiles of culled chunks and prefetched tiles
+    constexpr const float PreloadPriorityOffset = -2000.f;
 
     constexpr openspace::properties::Property::PropertyInfo FilePathInfo = {
         "FilePath",
@@ -148,6 +175,15 @@ namespace temporal {
         "This is the path to the XML configuration file that describes the temporal tile "
         "information."
     };
+
+    constexpr openspace::properties::Property::PropertyInfo PreloadStepsInfo = {
+        "PreloadSteps",
+        "Preload Steps",
+        "The number of time steps for which the visible tiles are loaded ahead of time. "
+        "The time steps are chosen in the direction in which time is passing and spaced "
+        "such that they are reached in consecutive seconds. If the time is paused, the "
+        "time steps before and after the current time are loaded."
+    };
 } // namespace temporal
 
 
@@ -158,29 +194,40 @@ namespace temporal {
 void initAsyncTileDataReader(DefaultTileProvider& t, TileTextureInitData initData) {
     ZoneScoped
 
+    cache::DiskTileCache* diskCache =
+        global::moduleEngine->module<GlobeBrowsingModule>()->diskTileCache();
+    const uint64_t contentHash = diskCache ?
+        cache::DiskTileCache::contentHash(t.filePath, initData, t.performPreProcessing) :
+        0;
+
     t.asyncTextureDataProvider = std::make_unique<AsyncTileDataProvider>(
         t.name,
         std::make_unique<RawTileDataReader>(
             t.filePath,
             initData,
             RawTileDataReader::PerformPreprocessing(t.performPreProcessing)
-        )
+        ),
+        diskCache,
+        contentHash,
+        t.threadPool,
+        t.compression
     );
 }
 
-bool initTexturesFromLoadedData(DefaultTileProvider& t) {
+int initTexturesFromLoadedData(DefaultTileProvider& t) {
     ZoneScoped
 
-    if (t.asyncTextureDataProvider) {
-        std::optional<RawTile> tile = t.asyncTextureDataProvider->popFinishedRawTile();
-        if (tile) {
-            const cache::ProviderTileKey key = { tile->tileIndex, t.uniqueIdentifier };
-            ghoul_assert(!t.tileCache->exist(key), "Tile must not be existing in cache");
-            t.tileCache->createTileAndPut(key, std::move(*tile));
-            return true;
-        }
+    if (!t.asyncTextureDataProvider) {
+        return 0;
+    }
+
+    std::vector<RawTile> tiles = t.asyncTextureDataProvider->popFinishedRawTiles();
+    for (RawTile& tile : tiles) {
+        const cache::ProviderTileKey key = { tile.tileIndex, t.uniqueIdentifier };
+        ghoul_assert(!t.tileCache->exist(key), "Tile must not be existing in cache");
+        t.tileCache->createTileAndPut(key, std::move(tile));
     }
-    return false;
+    return static_cast<int>(tiles.size());
 }
 
 
@@ -323,8 +370,9 @@ int timeStringify(TemporalTileProvider::TimeFormatType type, const Time& t, char
     }
 }
 
-std::unique_ptr<TileProvider> initTileProvider(TemporalTileProvider& t,
-                                               std::string_view timekey)
+// Returns the dictionary from which the DefaultTileProvider of the time is created
+ghoul::Dictionary tileProviderDictionary(const TemporalTileProvider& t,
+                                         std::string_view timekey)
 {
     ZoneScoped
 
@@ -349,38 +397,111 @@ std::unique_ptr<TileProvider> initTileProvider(TemporalTileProvider& t,
 
     FileSys.expandPathTokens(gdalDatasetXml, IgnoredTokens);
 
-    t.initDict.setValue(KeyFilePath, gdalDatasetXml);
-    return std::make_unique<DefaultTileProvider>(t.initDict);
+    ghoul::Dictionary dictionary = t.initDict;
+    dictionary.setValue(KeyFilePath, gdalDatasetXml);
+    return dictionary;
+}
+
+// Initializes the tile provider and adds it to the cache, deinitializing the evicted ones
+std::shared_ptr<TileProvider> addTileProvider(TemporalTileProvider& t,
+                                              const std::string& key,
+                                              std::shared_ptr<TileProvider> tileProvider)
+{
+    initialize(*tileProvider);
+
+    using Item = std::pair<TemporalTileProvider::TimeKey, std::shared_ptr<TileProvider>>;
+    for (const Item& evicted : t.tileProviderCache.putAndFetchPopped(key, tileProvider)) {
+        deinitialize(*evicted.second);
+
+        // Deinitializing the tile provider already removed all of its pending requests
+        std::vector<std::shared_ptr<TileProvider>>& retired = t.retiredTileProviders;
+        retired.erase(
+            std::remove(retired.begin(), retired.end(), evicted.second),
+            retired.end()
+        );
+    }
+    return tileProvider;
 }
 
-TileProvider* getTileProvider(TemporalTileProvider& t, std::string_view timekey) {
+std::shared_ptr<TileProvider> getTileProvider(TemporalTileProvider& t,
+                                              const std::string& key)
+{
     ZoneScoped
 
-    // @TODO (abock, 2020-08-20) This std::string creation can be removed once we switch
-    // to C++20 thanks to P0919R2
-    const auto it = t.tileProviderMap.find(std::string(timekey));
-    if (it != t.tileProviderMap.end()) {
-        return it->second.get();
+    if (t.tileProviderCache.exist(key)) {
+        return t.tileProviderCache.get(key);
     }
-    else {
-        std::unique_ptr<TileProvider> tileProvider = initTileProvider(t, timekey);
-        initialize(*tileProvider);
 
-        TileProvider* res = tileProvider.get();
-        t.tileProviderMap[std::string(timekey)] = std::move(tileProvider);
-        return res;
+    auto it = t.pendingTileProviders.find(key);
+    if (it != t.pendingTileProviders.end()) {
+        // The tile provider is already being created for preloading, which is faster
+        // than starting over
+        std::future<std::shared_ptr<TileProvider>> tileProvider = std::move(it->second);
+        t.pendingTileProviders.erase(it);
+        return addTileProvider(t, key, tileProvider.get());
     }
+
+    ghoul::Dictionary dictionary = tileProviderDictionary(t, key);
+    return addTileProvider(
+        t,
+        key,
+        std::make_shared<DefaultTileProvider>(dictionary, t.threadPool)
+    );
 }
 
-TileProvider* getTileProvider(TemporalTileProvider& t, const Time& time) {
+// Returns the cached tile provider of the time. If it does not exist yet, it is created
+// in the background and nullptr is returned until it has been finished
+std::shared_ptr<TileProvider> preloadTileProvider(TemporalTileProvider& t,
+                                                  const std::string& key)
+{
     ZoneScoped
 
+    if (t.tileProviderCache.exist(key)) {
+        return t.tileProviderCache.get(key);
+    }
+
+    auto it = t.pendingTileProviders.find(key);
+    if (it == t.pendingTileProviders.end()) {
+        using Task = std::packaged_task<std::shared_ptr<TileProvider>()>;
+        auto task = std::make_shared<Task>(
+            [dictionary = tileProviderDictionary(t, key), threadPool = t.threadPool]() {
+                return std::make_shared<DefaultTileProvider>(dictionary, threadPool);
+            }
+        );
+        t.pendingTileProviders[key] = task->get_future();
+        ThreadPool::shared().enqueue([task]() { (*task)(); }, ThreadPool::Priority::Low);
+        return nullptr;
+    }
+
+    using namespace std::chrono;
+    if (it->second.wait_for(seconds(0)) != std::future_status::ready) {
+        return nullptr;
+    }
+
+    // The tile provider has to be initialized on the main thread
+    std::future<std::shared_ptr<TileProvider>> tileProvider = std::move(it->second);
+    t.pendingTileProviders.erase(it);
+    return addTileProvider(t, key, tileProvider.get());
+}
+
+// Returns the key of the quantized time or std::nullopt if the time cannot be quantized
+std::optional<std::string> timeKey(TemporalTileProvider& t, const Time& time) {
     Time tCopy(time);
     if (t.timeQuantizer.quantize(tCopy, true)) {
         char Buffer[22];
         const int size = timeStringify(t.timeFormat, tCopy, Buffer);
+        return std::string(Buffer, size);
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<TileProvider> getTileProvider(TemporalTileProvider& t, const Time& time) {
+    ZoneScoped
+
+    std::optional<std::string> key = timeKey(t, time);
+    if (key.has_value()) {
         try {
-            return getTileProvider(t, std::string_view(Buffer, size));
+            return getTileProvider(t, *key);
         }
         catch (const ghoul::RuntimeError& e) {
             LERRORC("TemporalTileProvider", e.message);
@@ -390,6 +511,143 @@ TileProvider* getTileProvider(TemporalTileProvider& t, const Time& time) {
     return nullptr;
 }
 
+// Returns the number of quantized time steps relative to the current one, nearest first,
+// whose tiles should be loaded ahead of time
+std::vector<int> preloadedTimeSteps(const TemporalTileProvider& t, double deltaTime) {
+    const int nSteps = t.preloadSteps;
+    std::vector<int> steps;
+    steps.reserve(2 * nSteps);
+    if (deltaTime == 0.0) {
+        for (int i = 1; i <= nSteps; ++i) {
+            steps.push_back(i);
+            steps.push_back(-i);
+        }
+    }
+    else {
+        // Preload the times that are reached in one, two, ... seconds from now
+        const double resolution = t.timeQuantizer.resolution();
+        const double stepsPerSecond = std::abs(deltaTime) / resolution;
+        const int stride = std::max(static_cast<int>(std::round(stepsPerSecond)), 1);
+        const int direction = deltaTime > 0.0 ? 1 : -1;
+        for (int i = 1; i <= nSteps; ++i) {
+            steps.push_back(direction * stride * i);
+        }
+    }
+    return steps;
+}
+
+void updateTileProviders(TemporalTileProvider& t, const Time& time, double deltaTime) {
+    ZoneScoped
+
+    std::vector<std::shared_ptr<TileProvider>> preloaded;
+    std::vector<std::string> preloadedKeys;
+    Time quantized(time);
+    if (t.preloadSteps > 0 && t.timeQuantizer.quantize(quantized, true)) {
+        const double resolution = t.timeQuantizer.resolution();
+        for (int step : preloadedTimeSteps(t, deltaTime)) {
+            // Aim for the middle of the time step, as the steps are not equally long for
+            // calendar-based resolutions
+            const double offset = (static_cast<double>(step) + 0.5) * resolution;
+            std::optional<std::string> key =
+                timeKey(t, Time(quantized.j2000Seconds() + offset));
+            if (!key.has_value()) {
+                continue;
+            }
+
+            std::shared_ptr<TileProvider> tp;
+            try {
+                tp = preloadTileProvider(t, *key);
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERRORC("TemporalTileProvider", e.message);
+            }
+            const bool isNew = tp &&
+                std::find(preloaded.begin(), preloaded.end(), tp) == preloaded.end();
+            if (isNew) {
+                preloaded.push_back(std::move(tp));
+            }
+            preloadedKeys.push_back(std::move(*key));
+        }
+    }
+
+    // The current tile provider is retrieved last so that it is the most recently used
+    std::shared_ptr<TileProvider> current = getTileProvider(t, time);
+    if (current) {
+        preloaded.erase(
+            std::remove(preloaded.begin(), preloaded.end(), current),
+            preloaded.end()
+        );
+    }
+
+    // Tile providers that are no longer preloaded are not needed once they are created
+    for (auto it = t.pendingTileProviders.begin(); it != t.pendingTileProviders.end();) {
+        const bool isPreloaded = std::find(
+            preloadedKeys.begin(),
+            preloadedKeys.end(),
+            it->first
+        ) != preloadedKeys.end();
+        if (isPreloaded) {
+            ++it;
+        }
+        else {
+            t.discardedTileProviders.push_back(std::move(it->second));
+            it = t.pendingTileProviders.erase(it);
+        }
+    }
+    t.discardedTileProviders.erase(
+        std::remove_if(
+            t.discardedTileProviders.begin(),
+            t.discardedTileProviders.end(),
+            [](const std::future<std::shared_ptr<TileProvider>>& tileProvider) {
+                using namespace std::chrono;
+                return tileProvider.wait_for(seconds(0)) == std::future_status::ready;
+            }
+        ),
+        t.discardedTileProviders.end()
+    );
+
+    std::vector<std::shared_ptr<TileProvider>>& retired = t.retiredTileProviders;
+    auto isRetired = [&](const std::shared_ptr<TileProvider>& tp) {
+        return tp && tp != current &&
+            std::find(preloaded.begin(), preloaded.end(), tp) == preloaded.end() &&
+            std::find(retired.begin(), retired.end(), tp) == retired.end();
+    };
+    if (current && isRetired(t.currentTileProvider)) {
+        retired.push_back(t.currentTileProvider);
+    }
+    for (const std::shared_ptr<TileProvider>& tp : t.preloadedTileProviders) {
+        if (isRetired(tp)) {
+            retired.push_back(tp);
+        }
+    }
+
+    if (current) {
+        t.currentTileProvider = std::move(current);
+    }
+    t.preloadedTileProviders = std::move(preloaded);
+}
+
+void clearTileProviders(TemporalTileProvider& t) {
+    for (auto& [key, tileProvider] : t.pendingTileProviders) {
+        t.discardedTileProviders.push_back(std::move(tileProvider));
+    }
+    t.pendingTileProviders.clear();
+    t.currentTileProvider = nullptr;
+    t.preloadedTileProviders.clear();
+    t.retiredTileProviders.clear();
+    while (!t.tileProviderCache.isEmpty()) {
+        deinitialize(*t.tileProviderCache.popLRU().second);
+    }
+}
+
+size_t temporalCacheSize(const ghoul::Dictionary& dictionary) {
+    int cacheSize = temporal::DefaultCacheSize;
+    if (dictionary.hasValue<double>(temporal::KeyCacheSize)) {
+        cacheSize = static_cast<int>(dictionary.value<double>(temporal::KeyCacheSize));
+    }
+    return static_cast<size_t>(std::max(cacheSize, temporal::MinCacheSize));
+}
+
 void ensureUpdated(TemporalTileProvider& t) {
     ZoneScoped
 
@@ -550,8 +808,10 @@ std::unique_ptr<TileProvider> createFromDictionary(layergroupid::TypeID layerTyp
 
 TileProvider::TileProvider() : properties::PropertyOwner({ "tileProvider" }) {}
 
-DefaultTileProvider::DefaultTileProvider(const ghoul::Dictionary& dictionary)
-    : filePath(defaultprovider::FilePathInfo, "")
+DefaultTileProvider::DefaultTileProvider(const ghoul::Dictionary& dictionary,
+                                         std::shared_ptr<TileThreadPool> threadPool_)
+    : threadPool(std::move(threadPool_))
+    , filePath(defaultprovider::FilePathInfo, "")
     , tilePixelSize(defaultprovider::TilePixelSizeInfo, 32, 32, 2048)
 {
     ZoneScoped
@@ -605,6 +865,22 @@ DefaultTileProvider::DefaultTileProvider(const ghoul::Dictionary& dictionary)
         ));
     }
 
+    const bool compressTiles =
+        dictionary.hasValue<bool>(defaultprovider::KeyCompressTiles) &&
+        dictionary.value<bool>(defaultprovider::KeyCompressTiles);
+    if (compressTiles) {
+        // BC1 only stores fully opaque or fully transparent pixels, which is fine for
+        // color and night layers, but not for overlays and water masks
+        const bool isOpaqueLayer = layerGroupID == layergroupid::GroupID::ColorLayers ||
+                                   layerGroupID == layergroupid::GroupID::NightLayers;
+        if (isOpaqueLayer && isCompressible(initData, TileCompression::BC1)) {
+            compression = TileCompression::BC1;
+        }
+        else {
+            LWARNING("Tile compression is only supported for color and night layers");
+        }
+    }
+
     initAsyncTileDataReader(*this, initData);
 
     addProperty(filePath);
@@ -827,6 +1103,14 @@ TileProviderByLevel::TileProviderByLevel(const ghoul::Dictionary& dictionary) {
 TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
     : initDict(dictionary)
     , filePath(temporal::FilePathInfo)
+    , preloadSteps(temporal::PreloadStepsInfo, 2, 0, temporal::MaxPreloadSteps)
+    , threadPool(
+        std::make_shared<TileThreadPool>(
+            temporal::NumThreads,
+            temporal::ThreadPoolQueueSize
+        )
+    )
+    , tileProviderCache(temporalCacheSize(dictionary))
 {
     ZoneScoped
 
@@ -834,6 +1118,7 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
 
     filePath = dictionary.value<std::string>(KeyFilePath);
     addProperty(filePath);
+    addProperty(preloadSteps);
 
     successfulInitialization = readFilePath(*this);
 
@@ -934,8 +1219,18 @@ bool deinitialize(TileProvider& tp) {
             }
             return success;
         }
-        case Type::TemporalTileProvider:
+        case Type::TemporalTileProvider: {
+            TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
+            clearTileProviders(t);
+            // The tile providers that are still being created use the caches of the
+            // GlobeBrowsingModule, so they have to finish before it is deinitialized
+            using Future = std::future<std::shared_ptr<TileProvider>>;
+            for (const Future& tileProvider : t.discardedTileProviders) {
+                tileProvider.wait();
+            }
+            t.discardedTileProviders.clear();
             break;
+        }
         default:
             throw ghoul::MissingCaseException();
     }
@@ -1069,6 +1364,55 @@ Tile tile(TileProvider& tp, const TileIndex& tileIndex) {
 
 
 
+bool prefetch(TileProvider& tp, const TileIndex& tileIndex) {
+    ZoneScoped
+
+    switch (tp.type) {
+        case Type::DefaultTileProvider: {
+            DefaultTileProvider& t = static_cast<DefaultTileProvider&>(tp);
+            if (!t.asyncTextureDataProvider || tileIndex.level > maxLevel(t)) {
+                return false;
+            }
+            const cache::ProviderTileKey key = { tileIndex, t.uniqueIdentifier };
+            if (t.tileCache->exist(key)) {
+                return false;
+            }
+            return t.asyncTextureDataProvider->enqueueTileIO(tileIndex);
+        }
+        case Type::SingleImageTileProvider:
+        case Type::SizeReferenceTileProvider:
+        case Type::TileIndexTileProvider:
+            // These tiles are either static or created on demand
+            return false;
+        case Type::ByIndexTileProvider: {
+            TileProviderByIndex& t = static_cast<TileProviderByIndex&>(tp);
+            const auto it = t.tileProviderMap.find(tileIndex.hashKey());
+            const bool hasProvider = it != t.tileProviderMap.end();
+            return hasProvider ? prefetch(*it->second, tileIndex) : false;
+        }
+        case Type::ByLevelTileProvider: {
+            TileProviderByLevel& t = static_cast<TileProviderByLevel&>(tp);
+            TileProvider* provider = levelProvider(t, tileIndex.level);
+            return provider ? prefetch(*provider, tileIndex) : false;
+        }
+        case Type::TemporalTileProvider: {
+            TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
+            if (t.successfulInitialization) {
+                ensureUpdated(t);
+                return prefetch(*t.currentTileProvider, tileIndex);
+            }
+            else {
+                return false;
+            }
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+
+
+
 Tile::Status tileStatus(TileProvider& tp, const TileIndex& index) {
     ZoneScoped
 
@@ -1187,7 +1531,7 @@ int update(TileProvider& tp) {
             }
 
             t.asyncTextureDataProvider->update();
-            bool hasUploaded = initTexturesFromLoadedData(t);
+            const int nUploaded = initTexturesFromLoadedData(t);
 
             if (t.asyncTextureDataProvider->shouldBeDeleted()) {
                 t.asyncTextureDataProvider = nullptr;
@@ -1196,10 +1540,7 @@ int update(TileProvider& tp) {
                     tileTextureInitData(t.layerGroupID, t.padTiles, t.tilePixelSize)
                 );
             }
-            if (hasUploaded) {
-                return 1;
-            }
-            break;
+            return nUploaded;
         }
         case Type::SingleImageTileProvider:
             break;
@@ -1227,13 +1568,17 @@ int update(TileProvider& tp) {
         case Type::TemporalTileProvider: {
             TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
             if (t.successfulInitialization) {
-                TileProvider* newCurr = getTileProvider(t, global::timeManager->time());
-                if (newCurr) {
-                    t.currentTileProvider = newCurr;
-                }
+                updateTileProviders(
+                    t,
+                    global::timeManager->time(),
+                    global::timeManager->deltaTime()
+                );
                 if (t.currentTileProvider) {
                     update(*t.currentTileProvider);
                 }
+                for (const std::shared_ptr<TileProvider>& p : t.preloadedTileProviders) {
+                    update(*p);
+                }
             }
             break;
         }
@@ -1248,6 +1593,108 @@ int update(TileProvider& tp) {
 
 
 
+void prioritize(TileProvider& tp, std::shared_ptr<const TilePriorities> priorities,
+                float priorityOffset)
+{
+    ZoneScoped
+
+    switch (tp.type) {
+        case Type::DefaultTileProvider: {
+            DefaultTileProvider& t = static_cast<DefaultTileProvider&>(tp);
+            if (t.asyncTextureDataProvider) {
+                t.asyncTextureDataProvider->prioritizeTileIO(
+                    std::move(priorities),
+                    priorityOffset
+                );
+            }
+            break;
+        }
+        case Type::SingleImageTileProvider:
+            break;
+        case Type::SizeReferenceTileProvider:
+            break;
+        case Type::TileIndexTileProvider:
+            break;
+        case Type::ByIndexTileProvider: {
+            TileProviderByIndex& t = static_cast<TileProviderByIndex&>(tp);
+            using K = TileIndex::TileHashKey;
+            using V = std::unique_ptr<TileProvider>;
+            for (std::pair<const K, V>& it : t.tileProviderMap) {
+                prioritize(*it.second, priorities, priorityOffset);
+            }
+            prioritize(*t.defaultTileProvider, priorities, priorityOffset);
+            break;
+        }
+        case Type::ByLevelTileProvider: {
+            TileProviderByLevel& t = static_cast<TileProviderByLevel&>(tp);
+            for (const std::unique_ptr<TileProvider>& provider : t.levelTileProviders) {
+                prioritize(*provider, priorities, priorityOffset);
+            }
+            break;
+        }
+        case Type::TemporalTileProvider: {
+            TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
+            if (!t.successfulInitialization || !t.currentTileProvider) {
+                break;
+            }
+            prioritize(*t.currentTileProvider, priorities, priorityOffset);
+
+            // Only the most important visible tiles are preloaded, starting with the
+            // nearest time. Tiles that are already loaded do not count towards the
+            // budget, so the preloading moves on to the less important tiles and the
+            // later times as the earlier ones finish
+            std::vector<std::pair<float, TileIndex::TileHashKey>> visible;
+            if (!t.preloadedTileProviders.empty()) {
+                for (const std::pair<const TileIndex::TileHashKey, float>& it :
+                     *priorities)
+                {
+                    if (it.second > 0.f) {
+                        visible.emplace_back(it.second, it.first);
+                    }
+                }
+                std::sort(visible.begin(), visible.end(), std::greater<>());
+            }
+
+            size_t budget = temporal::MaxPreloadedTilesPerFrame;
+            for (size_t i = 0; i < t.preloadedTileProviders.size(); ++i) {
+                TileProvider& p = *t.preloadedTileProviders[i];
+                const float offset = priorityOffset +
+                    temporal::PreloadPriorityOffset * static_cast<float>(i + 1);
+                prioritize(p, priorities, offset);
+
+                // Requesting the tiles keeps them alive until the next call. The
+                // requests of the tiles beyond the budget are cancelled
+                for (size_t j = 0; j < visible.size() && budget > 0; ++j) {
+                    const TileIndex tileIndex(visible[j].second);
+                    const Tile::Status status = tileStatus(p, tileIndex);
+                    const bool needsLoading = status != Tile::Status::OK &&
+                                              status != Tile::Status::OutOfRange;
+                    if (!needsLoading) {
+                        continue;
+                    }
+                    prefetch(p, tileIndex);
+                    --budget;
+                }
+            }
+
+            // None of the tiles of the retired tile providers were requested since the
+            // last call, so all of their pending requests are cancelled
+            for (const std::shared_ptr<TileProvider>& p : t.retiredTileProviders) {
+                prioritize(*p, priorities, priorityOffset);
+            }
+            t.retiredTileProviders.clear();
+            break;
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+
+
+
+
+
 void reset(TileProvider& tp) {
     ZoneScoped
 
@@ -1318,11 +1765,8 @@ void reset(TileProvider& tp) {
         case Type::TemporalTileProvider: {
             TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
             if (t.successfulInitialization) {
-                using K = TemporalTileProvider::TimeKey;
-                using V = std::unique_ptr<TileProvider>;
-                for (std::pair<const K, V>& it : t.tileProviderMap) {
-                    reset(*it.second);
-                }
+                // The tile providers are recreated on demand
+                clearTileProviders(t);
             }
             break;
         }
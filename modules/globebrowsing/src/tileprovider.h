@@ -30,12 +30,18 @@
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/ellipsoid.h>
 #include <modules/globebrowsing/src/layergroupid.h>
+#include <modules/globebrowsing/src/lrucache.h>
 #include <modules/globebrowsing/src/tileindex.h>
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <modules/globebrowsing/src/timequantizer.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
+#include <future>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 struct CPLXMLNode;
 
@@ -48,6 +54,7 @@ namespace openspace { class PixelBuffer; }
 
 namespace openspace::globebrowsing {
     class AsyncTileDataProvider;
+    template <typename KeyType> class PriorityThreadPool;
     struct RawTile;
     struct TileIndex;
     namespace cache { class MemoryAwareTileCache; }
@@ -66,6 +73,9 @@ enum class Type {
 };
 
 
+/// The thread pool in which the tiles are read, see AsyncTileDataProvider::ThreadPool
+using TileThreadPool = PriorityThreadPool<std::pair<const void*, TileIndex::TileHashKey>>;
+
 struct TileProvider : public properties::PropertyOwner {
     static unsigned int NumTileProviders;
 
@@ -81,9 +91,16 @@ struct TileProvider : public properties::PropertyOwner {
 };
 
 struct DefaultTileProvider : public TileProvider {
-    DefaultTileProvider(const ghoul::Dictionary& dictionary);
+    /**
+     * If a \p threadPool is provided, the tiles are read in this thread pool, which can
+     * be shared with other tile providers. Otherwise, a thread pool is created for this
+     * tile provider.
+     */
+    DefaultTileProvider(const ghoul::Dictionary& dictionary,
+        std::shared_ptr<TileThreadPool> threadPool = nullptr);
 
     std::unique_ptr<AsyncTileDataProvider> asyncTextureDataProvider;
+    std::shared_ptr<TileThreadPool> threadPool;
 
     cache::MemoryAwareTileCache* tileCache = nullptr;
 
@@ -92,6 +109,7 @@ struct DefaultTileProvider : public TileProvider {
     layergroupid::GroupID layerGroupID = layergroupid::GroupID::Unknown;
     bool performPreProcessing = false;
     bool padTiles = true;
+    TileCompression compression = TileCompression::None;
 };
 
 struct SingleImageProvider : public TileProvider {
@@ -174,11 +192,36 @@ struct TemporalTileProvider : public TileProvider {
 
     ghoul::Dictionary initDict;
     properties::StringProperty filePath;
+    properties::IntProperty preloadSteps;
     std::string gdalXmlTemplate;
 
-    std::unordered_map<TimeKey, std::unique_ptr<TileProvider>> tileProviderMap;
+    /// All tile providers of this layer read their tiles in this shared thread pool
+    std::shared_ptr<TileThreadPool> threadPool;
+
+    /// The tile providers of the most recently used times. Tile providers that are
+    /// evicted from this cache are deinitialized
+    cache::LRUCache<TimeKey, std::shared_ptr<TileProvider>, std::hash<TimeKey>>
+        tileProviderCache;
+
+    /// The tile providers of preloaded times that are created in the background, as
+    /// opening their datasets might take a long time. They are initialized and added
+    /// to the cache once they are finished
+    std::unordered_map<TimeKey, std::future<std::shared_ptr<TileProvider>>>
+        pendingTileProviders;
+
+    /// The tile providers that were still being created when they were no longer
+    /// needed. They are destroyed once they are finished
+    std::vector<std::future<std::shared_ptr<TileProvider>>> discardedTileProviders;
 
-    TileProvider* currentTileProvider = nullptr;
+    std::shared_ptr<TileProvider> currentTileProvider;
+
+    /// The tile providers of the times that are expected to be shown next, ordered by
+    /// their distance to the current time
+    std::vector<std::shared_ptr<TileProvider>> preloadedTileProviders;
+
+    /// The tile providers that were current or preloaded until the last update and
+    /// whose pending tile requests are cancelled in the next call to prioritize
+    std::vector<std::shared_ptr<TileProvider>> retiredTileProviders;
 
     TimeFormatType timeFormat;
     TimeQuantizer timeQuantizer;
@@ -204,6 +247,16 @@ ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, int parents = 0,
 
 ChunkTilePile chunkTilePile(TileProvider& tp, TileIndex tileIndex, int pileSize);
 
+/**
+ * Requests the tile with the provided <code>tileIndex</code> ahead of time if it is not
+ * already loaded. Contrary to <code>tile</code>, this does not create tiles that are
+ * generated on demand.
+ *
+ * \return <code>true</code> if a new load request was issued for the tile. Tiles that
+ *         are already requested are kept alive, but do not issue a new request
+ */
+bool prefetch(TileProvider& tp, const TileIndex& tileIndex);
+
 /**
  * Returns the status of a <code>Tile</code>. The <code>Tile::Status</code>
  * corresponds the <code>Tile</code> that would be returned
@@ -227,6 +280,17 @@ TileDepthTransform depthTransform(TileProvider& tp);
  */
 int update(TileProvider& tp);
 
+/**
+ * Reorders the pending tile requests of the TileProvider according to the provided
+ * <code>priorities</code> and cancels the requests for tiles that have not been asked
+ * for since the previous call. This method should be called once per frame after all
+ * tiles for the frame have been requested. The <code>priorityOffset</code> is added to
+ * all priorities. Tiles with a positive priority are considered to be visible, which
+ * TemporalTileProviders use to decide which tiles to preload.
+ */
+void prioritize(TileProvider& tp, std::shared_ptr<const TilePriorities> priorities,
+    float priorityOffset = 0.f);
+
 /**
  * Provides a uniform way of all TileProviders to reload or
  * restore all of its internal state. This is mainly useful
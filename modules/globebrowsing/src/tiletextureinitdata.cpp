@@ -78,10 +78,29 @@ unsigned int uniqueIdForTextureFormat(ghoul::opengl::Texture::Format textureForm
     }
 }
 
+size_t totalNumberOfBytes(const glm::ivec3& dimensions, size_t bytesPerLine,
+                          openspace::globebrowsing::TileCompression compression)
+{
+    using namespace openspace::globebrowsing;
+    switch (compression) {
+        case TileCompression::None:
+            return bytesPerLine * dimensions.y;
+        case TileCompression::BC1: {
+            // Each block of 4x4 pixels is stored in 8 bytes
+            const size_t nBlocksX = (dimensions.x + 3) / 4;
+            const size_t nBlocksY = (dimensions.y + 3) / 4;
+            return nBlocksX * nBlocksY * 8;
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
 openspace::globebrowsing::TileTextureInitData::HashKey calculateHashKey(
                                                              const glm::ivec3& dimensions,
                                              const ghoul::opengl::Texture::Format& format,
-                                                                     const GLenum& glType)
+                                                                    const GLenum& glType,
+                                    openspace::globebrowsing::TileCompression compression)
 {
     ghoul_assert(dimensions.x > 0, "Incorrect dimension");
     ghoul_assert(dimensions.y > 0, "Incorrect dimension");
@@ -97,6 +116,8 @@ openspace::globebrowsing::TileTextureInitData::HashKey calculateHashKey(
     res |= dimensions.y << 10;
     res |= static_cast<std::underlying_type_t<GLenum>>(glType) << (10 + 16);
     res |= formatId << (10 + 16 + 4);
+    // The GL types occupy up to 13 bits, so the compression is stored above them
+    res |= static_cast<uint64_t>(compression) << 48;
 
     return res;
 }
@@ -168,20 +189,22 @@ TileTextureInitData tileTextureInitData(layergroupid::GroupID id, bool shouldPad
 
 TileTextureInitData::TileTextureInitData(size_t width, size_t height, GLenum type,
                                          ghoul::opengl::Texture::Format textureFormat,
-                                         PadTiles pad, ShouldAllocateDataOnCPU allocCpu)
+                                         PadTiles pad, ShouldAllocateDataOnCPU allocCpu,
+                                         TileCompression compression_)
     : dimensions(width, height, 1)
     , tilePixelStartOffset(pad ? TilePixelStartOffset : glm::ivec2(0))
     , tilePixelSizeDifference(pad ? TilePixelSizeDifference : glm::ivec2(0))
     , glType(type)
     , ghoulTextureFormat(textureFormat)
+    , compression(compression_)
     , nRasters(numberOfRasters(ghoulTextureFormat))
     , bytesPerDatum(numberOfBytes(glType))
     , bytesPerPixel(nRasters * bytesPerDatum)
     , bytesPerLine(bytesPerPixel * width)
-    , totalNumBytes(bytesPerLine * height)
+    , totalNumBytes(totalNumberOfBytes(dimensions, bytesPerLine, compression))
     , shouldAllocateDataOnCPU(allocCpu)
     , padTiles(pad)
-    , hashKey(calculateHashKey(dimensions, ghoulTextureFormat, glType))
+    , hashKey(calculateHashKey(dimensions, ghoulTextureFormat, glType, compression))
 {}
 
 TileTextureInitData TileTextureInitData::operator=(const TileTextureInitData& rhs) {
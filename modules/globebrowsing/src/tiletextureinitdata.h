@@ -33,6 +33,11 @@
 
 namespace openspace::globebrowsing {
 
+/// The block compression format in which the texture data of a Tile is stored
+enum class TileCompression {
+    None = 0,
+    BC1
+};
 
 /// All information needed to create a texture used for a Tile.
 class TileTextureInitData {
@@ -43,7 +48,8 @@ public:
 
     TileTextureInitData(size_t width, size_t height, GLenum type,
         ghoul::opengl::Texture::Format textureFormat, PadTiles pad,
-        ShouldAllocateDataOnCPU allocCpu = ShouldAllocateDataOnCPU::No);
+        ShouldAllocateDataOnCPU allocCpu = ShouldAllocateDataOnCPU::No,
+        TileCompression compression = TileCompression::None);
 
     TileTextureInitData(const TileTextureInitData& original) = default;
     TileTextureInitData(TileTextureInitData&& original) = default;
@@ -58,6 +64,9 @@ public:
     const glm::ivec2 tilePixelSizeDifference;
     const GLenum glType;
     const ghoul::opengl::Texture::Format ghoulTextureFormat;
+    /// If the texture is compressed, all sizes except totalNumBytes refer to the pixels
+    /// before compression
+    const TileCompression compression;
     const size_t nRasters;
     const size_t bytesPerDatum;
     const size_t bytesPerPixel;
@@ -368,6 +368,10 @@ void TimeQuantizer::setResolution(const std::string& resolutionString) {
     _resolution = parseTimeResolutionStr(resolutionString);
 }
 
+double TimeQuantizer::resolution() const {
+    return _resolution;
+}
+
 void TimeQuantizer::verifyStartTimeRestrictions() {
     if (_start.day() < 1 || _start.day() > 28) {
         throw ghoul::RuntimeError(fmt::format(
@@ -328,6 +328,11 @@ public:
     */
     double parseTimeResolutionStr(const std::string& resolutionStr);
 
+    /**
+     * Returns the (approximate) length of one quantized time step in seconds.
+     */
+    double resolution() const;
+
     /**
     * Quantizes a OpenSpace Time into descrete values. If the provided Time \p t is
     * outside the time range, it will be clamped to the the time range.
@@ -0,0 +1,480 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/space/rendering/orbitalcatalog.h>
+
+#include <openspace/util/mappedfile.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace {
+    constexpr const char* _loggerCat = "OrbitalCatalog";
+
+    constexpr const uint32_t CacheMagic = 0x4342524f; // 'ORBC'
+    constexpr const int32_t CurrentCacheVersion = 1;
+    // The sections of the cache file start at a multiple of this to keep the mapped
+    // values aligned
+    constexpr const size_t SectionAlignment = 16;
+
+    // The entries are parsed in ranges of this many objects
+    constexpr const size_t EntriesPerTask = 4096;
+
+    using Entry = openspace::orbitalcatalog::Entry;
+    static_assert(
+        std::is_trivially_copyable_v<Entry> && sizeof(Entry) % alignof(uint64_t) == 0,
+        "The entries are written to and mapped from the cache file as they are"
+    );
+
+    const char* findLineEnd(const char* begin, const char* end) {
+        // memchr is vectorized in all standard libraries that we care about
+        const void* res = std::memchr(begin, '\n', end - begin);
+        return res ? static_cast<const char*>(res) : end;
+    }
+
+    // Guard against wrong line endings (copying files from Windows to Mac) causes lines
+    // to have a final \r
+    std::string_view makeLine(const char* begin, const char* end) {
+        if (end > begin && *(end - 1) == '\r') {
+            end--;
+        }
+        return std::string_view(begin, static_cast<size_t>(end - begin));
+    }
+
+    // Splits the file into its lines. A final line that is not terminated by a line
+    // break is only counted if it is not empty
+    std::vector<std::string_view> splitLines(const char* begin, const char* end) {
+        std::vector<std::string_view> lines;
+        const char* cursor = begin;
+        while (cursor < end) {
+            const char* lineEnd = findLineEnd(cursor, end);
+            lines.push_back(makeLine(cursor, lineEnd));
+            cursor = lineEnd < end ? lineEnd + 1 : end;
+        }
+        return lines;
+    }
+
+    size_t alignedOffset(size_t offset) {
+        return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+    }
+
+    template <typename T>
+    void write(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writePadding(std::ofstream& file) {
+        const size_t offset = static_cast<size_t>(file.tellp());
+        const char zeros[SectionAlignment] = {};
+        file.write(zeros, alignedOffset(offset) - offset);
+    }
+
+    // Reads the header values of a cache file while making sure that no read goes past
+    // the end of the mapped memory
+    struct CacheReader {
+        template <typename T>
+        bool read(T& value) {
+            if (offset + sizeof(T) > size) {
+                return false;
+            }
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        const std::byte* data;
+        size_t size;
+        size_t offset = 0;
+    };
+} // namespace
+
+namespace openspace::orbitalcatalog {
+
+Catalog::Catalog() {} // NOLINT
+Catalog::~Catalog() {} // NOLINT
+
+Catalog::Catalog(Catalog&& other) noexcept {
+    *this = std::move(other);
+}
+
+Catalog& Catalog::operator=(Catalog&& other) noexcept {
+    if (this != &other) {
+        _nEntries = std::exchange(other._nEntries, 0);
+        _entries = std::exchange(other._entries, nullptr);
+        _isValid = std::exchange(other._isValid, nullptr);
+        _nameOffsets = std::exchange(other._nameOffsets, nullptr);
+        _names = std::exchange(other._names, nullptr);
+        // Moving the vectors and the mapping does not change the addresses of their
+        // contents, so the pointers above stay valid
+        _ownedEntries = std::move(other._ownedEntries);
+        _ownedIsValid = std::move(other._ownedIsValid);
+        _ownedNameOffsets = std::move(other._ownedNameOffsets);
+        _mappedFile = std::move(other._mappedFile);
+        // The characters of a short string might be stored inside the string object
+        _ownedNames = std::move(other._ownedNames);
+        if (!_mappedFile) {
+            setOwnedPointers();
+        }
+    }
+    return *this;
+}
+
+void Catalog::setOwnedPointers() {
+    _nEntries = _ownedEntries.size();
+    _entries = _ownedEntries.data();
+    _isValid = _ownedIsValid.data();
+    _nameOffsets = _ownedNameOffsets.data();
+    _names = _ownedNames.data();
+}
+
+size_t Catalog::nEntries() const {
+    return _nEntries;
+}
+
+bool Catalog::isValid(size_t i) const {
+    ghoul_assert(i < _nEntries, "Index out of range");
+    return _isValid[i] != 0;
+}
+
+const Entry& Catalog::entry(size_t i) const {
+    ghoul_assert(i < _nEntries, "Index out of range");
+    return _entries[i];
+}
+
+std::string_view Catalog::name(size_t i) const {
+    ghoul_assert(i < _nEntries, "Index out of range");
+    return std::string_view(
+        _names + _nameOffsets[i],
+        static_cast<size_t>(_nameOffsets[i + 1] - _nameOffsets[i])
+    );
+}
+
+bool Catalog::isMemoryMapped() const {
+    return _mappedFile != nullptr;
+}
+
+Catalog loadCatalog(const std::string& path, const Format& format, Parallel parallel) {
+    ghoul_assert(format.nLinesPerEntry > 0, "Each object needs at least one line");
+    ghoul_assert(format.parser, "The format needs a parser");
+
+    if (!FileSys.fileExists(path)) {
+        throw ghoul::RuntimeError(fmt::format("Catalog file {} does not exist", path));
+    }
+
+    MappedFile file(path);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    std::vector<std::string_view> lines = splitLines(begin, begin + file.size());
+
+    Catalog res;
+    size_t firstLine = 0;
+    if (!format.header.empty()) {
+        if (lines.empty() || lines.front() != format.header) {
+            LERROR(fmt::format(
+                "File {} does not have the expected header '{}' at line 1",
+                path, format.header
+            ));
+            res.setOwnedPointers();
+            return res;
+        }
+        firstLine = 1;
+    }
+
+    const size_t nLinesPerEntry = static_cast<size_t>(format.nLinesPerEntry);
+    const size_t nEntries = (lines.size() - firstLine) / nLinesPerEntry;
+    res._ownedEntries.resize(nEntries);
+    res._ownedIsValid.resize(nEntries, 0);
+    std::vector<std::string> names(nEntries);
+
+    // Each task writes to a disjoint range of the entries. Exceptions are passed on to
+    // the calling thread as they cannot leave a task of the thread pool
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+    auto parse = [&](size_t task) {
+        const size_t taskBegin = task * EntriesPerTask;
+        const size_t taskEnd = std::min(taskBegin + EntriesPerTask, nEntries);
+        std::vector<std::string_view> entryLines(nLinesPerEntry);
+        for (size_t i = taskBegin; i < taskEnd; ++i) {
+            const size_t line = firstLine + i * nLinesPerEntry;
+            std::copy_n(lines.begin() + line, nLinesPerEntry, entryLines.begin());
+            try {
+                const bool isValid =
+                    format.parser(entryLines, res._ownedEntries[i], names[i]);
+                res._ownedIsValid[i] = isValid ? 1 : 0;
+            }
+            catch (const std::invalid_argument& e) {
+                LINFO(fmt::format(
+                    "Ignoring line {} of {}: invalid value ({})", line + 1, path, e.what()
+                ));
+            }
+            catch (const std::out_of_range& e) {
+                LINFO(fmt::format(
+                    "Ignoring line {} of {}: value out of range ({})",
+                    line + 1, path, e.what()
+                ));
+            }
+            catch (const ghoul::RuntimeError& e) {
+                std::lock_guard lock(exceptionMutex);
+                if (!exception) {
+                    exception = std::make_exception_ptr(ghoul::RuntimeError(fmt::format(
+                        "File {} entry {}: {}", path, i + 1, e.message
+                    )));
+                }
+                return;
+            }
+            catch (...) {
+                std::lock_guard lock(exceptionMutex);
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+                return;
+            }
+        }
+    };
+
+    const size_t nTasks = (nEntries + EntriesPerTask - 1) / EntriesPerTask;
+    if (parallel && nTasks > 1) {
+        // The calling thread participates in the work as well
+        ThreadPool::shared().parallelFor(0, nTasks, parse);
+    }
+    else {
+        for (size_t task = 0; task < nTasks; ++task) {
+            parse(task);
+        }
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+
+    if (format.maxSequentialErrors > 0) {
+        int sequentialErrors = 0;
+        for (size_t i = 0; i < nEntries; ++i) {
+            sequentialErrors = res._ownedIsValid[i] ? 0 : sequentialErrors + 1;
+            if (sequentialErrors == format.maxSequentialErrors) {
+                LERROR(fmt::format(
+                    "Abandoning data file {} (too many sequential line errors)", path
+                ));
+                Catalog empty;
+                empty.setOwnedPointers();
+                return empty;
+            }
+        }
+    }
+
+    size_t namesSize = 0;
+    for (const std::string& name : names) {
+        namesSize += name.size();
+    }
+    res._ownedNames.reserve(namesSize);
+    res._ownedNameOffsets.reserve(nEntries + 1);
+    res._ownedNameOffsets.push_back(0);
+    for (const std::string& name : names) {
+        res._ownedNames += name;
+        res._ownedNameOffsets.push_back(res._ownedNames.size());
+    }
+
+    res.setOwnedPointers();
+    return res;
+}
+
+uint64_t contentHash(const std::string& path) {
+    MappedFile file(path);
+    const std::byte* data = file.data();
+    const size_t size = file.size();
+
+    // 64-bit FNV-1a that consumes eight bytes per step, which is stable across
+    // platforms and standard library versions in contrast to std::hash
+    constexpr const uint64_t Prime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+    hash = (hash ^ static_cast<uint64_t>(size)) * Prime;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(uint64_t));
+        hash = (hash ^ word) * Prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<uint64_t>(data[i])) * Prime;
+    }
+    return hash;
+}
+
+void saveCachedCatalog(const Catalog& catalog, const std::string& path,
+                       uint64_t contentHash)
+{
+    std::ofstream file(path, std::ofstream::binary);
+    if (!file.good()) {
+        throw ghoul::RuntimeError(fmt::format("Error opening cache file '{}'", path));
+    }
+
+    const size_t n = catalog.nEntries();
+    const uint64_t namesSize = n > 0 ? catalog._nameOffsets[n] : 0;
+
+    write(file, CacheMagic);
+    write(file, CurrentCacheVersion);
+    write(file, contentHash);
+    write(file, static_cast<uint64_t>(n));
+    write(file, namesSize);
+
+    // Each section is aligned so that it can be used directly once the file is mapped
+    writePadding(file);
+    file.write(reinterpret_cast<const char*>(catalog._entries), n * sizeof(Entry));
+    writePadding(file);
+    if (n > 0) {
+        file.write(
+            reinterpret_cast<const char*>(catalog._nameOffsets),
+            (n + 1) * sizeof(uint64_t)
+        );
+    }
+    else {
+        write(file, uint64_t(0));
+    }
+    writePadding(file);
+    file.write(reinterpret_cast<const char*>(catalog._isValid), n);
+    file.write(catalog._names, namesSize);
+
+    if (!file.good()) {
+        throw ghoul::RuntimeError(fmt::format("Error writing cache file '{}'", path));
+    }
+}
+
+std::optional<Catalog> loadCachedCatalog(const std::string& path, uint64_t contentHash)
+{
+    std::unique_ptr<MappedFile> mapped;
+    try {
+        mapped = std::make_unique<MappedFile>(path);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
+        return std::nullopt;
+    }
+
+    CacheReader reader = { mapped->data(), mapped->size() };
+
+    uint32_t magic = 0;
+    int32_t version = 0;
+    if (!reader.read(magic) || magic != CacheMagic || !reader.read(version) ||
+        version != CurrentCacheVersion)
+    {
+        LINFO(fmt::format("The format of the cache file '{}' has changed", path));
+        return std::nullopt;
+    }
+
+    uint64_t hash = 0;
+    uint64_t nEntries = 0;
+    uint64_t namesSize = 0;
+    if (!reader.read(hash) || !reader.read(nEntries) || !reader.read(namesSize)) {
+        LERROR(fmt::format("The cache file '{}' is corrupt", path));
+        return std::nullopt;
+    }
+    if (hash != contentHash) {
+        LINFO(fmt::format("The cache file '{}' is out of date", path));
+        return std::nullopt;
+    }
+
+    const size_t entriesOffset = alignedOffset(reader.offset);
+    const size_t offsetsOffset = alignedOffset(entriesOffset + nEntries * sizeof(Entry));
+    const size_t isValidOffset =
+        alignedOffset(offsetsOffset + (nEntries + 1) * sizeof(uint64_t));
+    const size_t namesOffset = isValidOffset + nEntries;
+    if (namesOffset + namesSize != mapped->size()) {
+        LERROR(fmt::format("The cache file '{}' is corrupt", path));
+        return std::nullopt;
+    }
+
+    const std::byte* data = mapped->data();
+    Catalog res;
+    res._nEntries = static_cast<size_t>(nEntries);
+    res._entries = reinterpret_cast<const Entry*>(data + entriesOffset);
+    res._nameOffsets = reinterpret_cast<const uint64_t*>(data + offsetsOffset);
+    res._isValid = reinterpret_cast<const uint8_t*>(data + isValidOffset);
+    res._names = reinterpret_cast<const char*>(data + namesOffset);
+    if (res._nameOffsets[nEntries] != namesSize) {
+        LERROR(fmt::format("The cache file '{}' is corrupt", path));
+        return std::nullopt;
+    }
+    res._mappedFile = std::move(mapped);
+    return res;
+}
+
+Catalog loadCatalogCached(const std::string& path, const Format& format) {
+    if (!FileSys.fileExists(path)) {
+        throw ghoul::RuntimeError(fmt::format("Catalog file {} does not exist", path));
+    }
+
+    // The hash is part of the cache key, so that a changed file does not overwrite the
+    // cache of a different version of the same file that might still be used elsewhere
+    const uint64_t hash = contentHash(path);
+    const std::string cachedFile = FileSys.cacheManager()->cachedFilename(
+        ghoul::filesystem::File(path),
+        fmt::format("{}|{:016x}", format.identifier, hash),
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+
+    if (FileSys.fileExists(cachedFile)) {
+        LINFO(fmt::format(
+            "Cached file '{}' used for catalog file '{}'", cachedFile, path
+        ));
+
+        std::optional<Catalog> catalog = loadCachedCatalog(cachedFile, hash);
+        if (catalog.has_value()) {
+            return std::move(*catalog);
+        }
+        // Intentional fall-through to regenerate the cache file for the next run
+    }
+    else {
+        LINFO(fmt::format("Cache for catalog file '{}' not found", path));
+    }
+
+    LINFO(fmt::format("Loading catalog file '{}'", path));
+    Catalog catalog = loadCatalog(path, format);
+    if (catalog.nEntries() == 0) {
+        // Nothing worth caching, and problems with the file are reported again
+        return catalog;
+    }
+
+    try {
+        saveCachedCatalog(catalog, cachedFile, hash);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        // Not being able to write the cache is not fatal as we have the data already
+        LERROR(e.message);
+    }
+    return catalog;
+}
+
+} // namespace openspace::orbitalcatalog
@@ -0,0 +1,199 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_SPACE___ORBITALCATALOG___H__
+#define __OPENSPACE_MODULE_SPACE___ORBITALCATALOG___H__
+
+#include <ghoul/misc/boolean.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openspace {
+
+class MappedFile;
+
+namespace orbitalcatalog {
+
+/// The Keplerian elements of a single object of an orbital catalog
+struct Entry {
+    double inclination = 0.0;
+    double semiMajorAxis = 0.0;
+    double ascendingNode = 0.0;
+    double eccentricity = 0.0;
+    double argumentOfPeriapsis = 0.0;
+    double meanAnomaly = 0.0;
+    double meanMotion = 0.0;
+    double epoch = 0.0;
+    double period = 0.0;
+};
+
+/**
+ * Describes the text format of a catalog file, in which every object is described by a
+ * fixed number of lines that follow an optional header.
+ */
+struct Format {
+    /**
+     * Parses the \p lines of a single object into the \p entry and its \p name. Returns
+     * \c false if the object cannot be used, in which case it is kept in the Catalog as
+     * an invalid entry so that the indices of all other objects are unchanged. The
+     * std::invalid_argument and std::out_of_range exceptions that std::stod throws are
+     * logged and also mark the object as invalid, while a ghoul::RuntimeError makes the
+     * entire file unusable. This function is called concurrently for different objects
+     * and must not modify any shared state.
+     */
+    using Parser = std::function<
+        bool(const std::vector<std::string_view>& lines, Entry& entry, std::string& name)
+    >;
+
+    /// The identifier of the format that has to change whenever the parser changes
+    std::string identifier;
+
+    /// If this is not empty, the first line of the file has to be exactly this header
+    std::string header;
+
+    /// The number of lines that describe a single object
+    int nLinesPerEntry = 1;
+
+    /// The parser that is called for the lines of every object
+    Parser parser;
+
+    /// If this many objects in a row are invalid, the entire file is rejected. A value
+    /// of 0 means that the file is never rejected
+    int maxSequentialErrors = 0;
+};
+
+BooleanType(Parallel);
+
+/**
+ * The objects of a catalog file in the order in which they appear in the file. The
+ * entries are either owned by the Catalog or are part of a memory mapped cache file, in
+ * which case only the pages of the entries that are accessed are ever read from disk.
+ */
+class Catalog {
+public:
+    Catalog();
+    ~Catalog();
+    Catalog(Catalog&& other) noexcept;
+    Catalog& operator=(Catalog&& other) noexcept;
+
+    /// Returns the number of objects, including the invalid ones
+    size_t nEntries() const;
+
+    /// Returns whether the object with the index \p i could be parsed
+    bool isValid(size_t i) const;
+
+    /// Returns the elements of the object with the index \p i
+    const Entry& entry(size_t i) const;
+
+    /// Returns the name of the object with the index \p i
+    std::string_view name(size_t i) const;
+
+    /// Returns whether the entries are part of a memory mapped cache file
+    bool isMemoryMapped() const;
+
+private:
+    friend Catalog loadCatalog(const std::string& path, const Format& format,
+        Parallel parallel);
+    friend void saveCachedCatalog(const Catalog& catalog, const std::string& path,
+        uint64_t contentHash);
+    friend std::optional<Catalog> loadCachedCatalog(const std::string& path,
+        uint64_t contentHash);
+
+    void setOwnedPointers();
+
+    size_t _nEntries = 0;
+    const Entry* _entries = nullptr;
+    const uint8_t* _isValid = nullptr;
+    // The name of object i is stored in _names[_nameOffsets[i], _nameOffsets[i + 1])
+    const uint64_t* _nameOffsets = nullptr;
+    const char* _names = nullptr;
+
+    std::vector<Entry> _ownedEntries;
+    std::vector<uint8_t> _ownedIsValid;
+    std::vector<uint64_t> _ownedNameOffsets;
+    std::string _ownedNames;
+    std::unique_ptr<MappedFile> _mappedFile;
+};
+
+/**
+ * Parses the catalog file at the provided \p path with the \p format. The objects are
+ * split into ranges that are parsed in parallel; the entries of the returned Catalog are
+ * always in the same order as in the file. If the header does not match or too many
+ * objects in a row are invalid, an error is logged and an empty Catalog is returned.
+ *
+ * \param path The path to the catalog file that should be loaded
+ * \param format The format of the catalog file
+ * \param parallel If this is \c Yes, the objects are parsed on the thread pool of the
+ *        SpaceModule, otherwise they are only parsed on the calling thread
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened or the parser of the
+ *        \p format reported an error for the whole file
+ */
+Catalog loadCatalog(const std::string& path, const Format& format,
+    Parallel parallel = Parallel::Yes);
+
+/**
+ * Returns a hash of the contents of the file at \p path that is stable across platforms
+ * and runs and that is used to detect whether a cache file is out of date.
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened
+ */
+uint64_t contentHash(const std::string& path);
+
+/**
+ * Saves the \p catalog into a versioned binary cache file at \p path that can be loaded
+ * with loadCachedCatalog. The \p contentHash of the catalog file is stored alongside.
+ *
+ * \throw ghoul::RuntimeError If the file could not be written
+ */
+void saveCachedCatalog(const Catalog& catalog, const std::string& path,
+    uint64_t contentHash);
+
+/**
+ * Memory maps the binary cache file at \p path that was written by saveCachedCatalog.
+ *
+ * \return The mapped Catalog or \c std::nullopt if the file does not exist, was written
+ *         by a different version or for different file contents than \p contentHash, or
+ *         is corrupt
+ */
+std::optional<Catalog> loadCachedCatalog(const std::string& path, uint64_t contentHash);
+
+/**
+ * Loads the catalog file at \p path through a persistent cache file that is keyed by the
+ * hash of the file's contents and the identifier of the \p format. If no matching cache
+ * file exists yet, the file is parsed and the result is stored for the next run.
+ *
+ * \throw ghoul::RuntimeError If the catalog file could not be opened or parsed
+ */
+Catalog loadCatalogCached(const std::string& path, const Format& format);
+
+} // namespace orbitalcatalog
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_SPACE___ORBITALCATALOG___H__
@@ -24,6 +24,7 @@
 
 #include <modules/space/rendering/renderableorbitalkepler.h>
 
+#include <modules/space/translation/keplerpropagator.h>
 #include <modules/space/translation/keplertranslation.h>
 #include <modules/space/translation/tletranslation.h>
 #include <modules/space/spacemodule.h>
@@ -32,6 +33,7 @@
 #include <openspace/engine/globals.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/util/threadpool.h>
 #include <openspace/util/time.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/filesystem.h>
@@ -48,6 +50,9 @@ namespace {
     constexpr const char* _loggerCat = "OrbitalKepler";
     constexpr const char* ProgramName = "OrbitalKepler";
 
+    // The number of orbits whose vertices are computed by a single task in updateBuffers
+    constexpr const size_t OrbitsPerTask = 1024;
+
     // Fragile! Keep in sync with documentation
     const std::map<std::string, openspace::Renderable::RenderBin> RenderBinConversion = {
         { "Background", openspace::Renderable::RenderBin::Background },
@@ -267,7 +272,7 @@ documentation::Documentation RenderableOrbitalKepler::Documentation() {
     return doc;
 }
 
-double RenderableOrbitalKepler::calculateSemiMajorAxis(double meanMotion) const {
+double RenderableOrbitalKepler::calculateSemiMajorAxis(double meanMotion) {
     constexpr const double GravitationalConstant = 6.6740831e-11;
     constexpr const double MassEarth = 5.9721986e24;
     constexpr const double muEarth = GravitationalConstant * MassEarth;
@@ -288,7 +293,7 @@ double RenderableOrbitalKepler::calculateSemiMajorAxis(double meanMotion) const
     return semiMajorAxis / 1000.0;
 }
 
-double RenderableOrbitalKepler::epochFromSubstring(const std::string& epochString) const {
+double RenderableOrbitalKepler::epochFromSubstring(const std::string& epochString) {
     // The epochString is in the form:
     // YYDDD.DDDDDDDD
     // With YY being the last two years of the launch epoch, the first DDD the day
@@ -386,6 +391,21 @@ double RenderableOrbitalKepler::epochFromYMDdSubstring(const std::string& epochS
     return epoch;
 }
 
+const orbitalcatalog::Catalog& RenderableOrbitalKepler::catalog(
+                                                              const std::string& filename,
+                                                     const orbitalcatalog::Format& format)
+{
+    std::error_code ec;
+    const std::filesystem::file_time_type timestamp =
+        std::filesystem::last_write_time(filename, ec);
+    if (filename != _catalogPath || timestamp != _catalogTimestamp) {
+        _catalog = orbitalcatalog::loadCatalogCached(filename, format);
+        _catalogPath = filename;
+        _catalogTimestamp = timestamp;
+    }
+    return _catalog;
+}
+
 RenderableOrbitalKepler::RenderableOrbitalKepler(const ghoul::Dictionary& dict)
     : Renderable(dict)
     , _segmentQuality(SegmentQualityInfo, 2, 1, 10)
@@ -547,47 +567,72 @@ void RenderableOrbitalKepler::render(const RenderData& data, RendererTasks&) {
 void RenderableOrbitalKepler::updateBuffers() {
     readDataFile(_path);
 
-    size_t nVerticesTotal = 0;
-
-    int numOrbits = static_cast<int>(_data.size());
-    for (int i = 0; i < numOrbits; ++i) {
-        nVerticesTotal += _segmentSize[i] + 1;
+    // The vertices of each orbit directly follow the ones of the previous orbit
+    const size_t nOrbits = _data.size();
+    std::vector<size_t> firstVertex(nOrbits + 1, 0);
+    for (size_t i = 0; i < nOrbits; ++i) {
+        firstVertex[i + 1] = firstVertex[i] + _segmentSize[i] + 1;
     }
-    _vertexBufferData.resize(nVerticesTotal);
-
-    size_t vertexBufIdx = 0;
-    for (int orbitIdx = 0; orbitIdx < numOrbits; ++orbitIdx) {
-        const KeplerParameters& orbit = _data[orbitIdx];
-
-        _keplerTranslator.setKeplerElements(
-            orbit.eccentricity,
-            orbit.semiMajorAxis,
-            orbit.inclination,
-            orbit.ascendingNode,
-            orbit.argumentOfPeriapsis,
-            orbit.meanAnomaly,
-            orbit.period,
-            orbit.epoch
-        );
-
-        for (size_t j = 0 ; j < (_segmentSize[orbitIdx] + 1); ++j) {
-            double timeOffset = orbit.period *
-                static_cast<double>(j)/ static_cast<double>(_segmentSize[orbitIdx]);
-
-            glm::dvec3 position = _keplerTranslator.position({
-                {},
-                Time(timeOffset + orbit.epoch),
-                Time(0.0)
-            });
+    _vertexBufferData.resize(firstVertex.back());
+
+    KeplerPropagator::Elements elements;
+    for (const KeplerParameters& orbit : _data) {
+        elements.eccentricity.push_back(orbit.eccentricity);
+        elements.semiMajorAxis.push_back(orbit.semiMajorAxis);
+        elements.inclination.push_back(orbit.inclination);
+        elements.ascendingNode.push_back(orbit.ascendingNode);
+        elements.argumentOfPeriapsis.push_back(orbit.argumentOfPeriapsis);
+        elements.meanAnomalyAtEpoch.push_back(orbit.meanAnomaly);
+        elements.period.push_back(orbit.period);
+        elements.epoch.push_back(orbit.epoch);
+    }
+    const KeplerPropagator propagator(elements);
+
+    // Each task evaluates the vertices of a range of orbits, so that only the (orbit,
+    // time) pairs of the ranges that are currently worked on have to be kept in memory
+    auto computeVertices = [&](size_t task) {
+        const size_t beginOrbit = task * OrbitsPerTask;
+        const size_t endOrbit = std::min(beginOrbit + OrbitsPerTask, nOrbits);
+        const size_t offset = firstVertex[beginOrbit];
+        const size_t nVertices = firstVertex[endOrbit] - offset;
+
+        std::vector<uint32_t> orbits(nVertices);
+        std::vector<double> times(nVertices);
+        std::vector<double> timeOffsets(nVertices);
+        for (size_t orbitIdx = beginOrbit; orbitIdx < endOrbit; ++orbitIdx) {
+            const KeplerParameters& orbit = _data[orbitIdx];
+            for (size_t j = 0; j < (_segmentSize[orbitIdx] + 1); ++j) {
+                const size_t i = firstVertex[orbitIdx] + j - offset;
+                timeOffsets[i] = orbit.period *
+                    static_cast<double>(j) / static_cast<double>(_segmentSize[orbitIdx]);
+                orbits[i] = static_cast<uint32_t>(orbitIdx);
+                times[i] = timeOffsets[i] + orbit.epoch;
+            }
+        }
 
-            _vertexBufferData[vertexBufIdx].x = static_cast<float>(position.x);
-            _vertexBufferData[vertexBufIdx].y = static_cast<float>(position.y);
-            _vertexBufferData[vertexBufIdx].z = static_cast<float>(position.z);
-            _vertexBufferData[vertexBufIdx].time = static_cast<float>(timeOffset);
-            _vertexBufferData[vertexBufIdx].epoch = orbit.epoch;
-            _vertexBufferData[vertexBufIdx].period = orbit.period;
+        std::vector<glm::dvec3> positions(nVertices);
+        propagator.evaluate(orbits.data(), times.data(), nVertices, positions.data());
+
+        for (size_t i = 0; i < nVertices; ++i) {
+            const KeplerParameters& orbit = _data[orbits[i]];
+            TrailVBOLayout& vertex = _vertexBufferData[offset + i];
+            vertex.x = static_cast<float>(positions[i].x);
+            vertex.y = static_cast<float>(positions[i].y);
+            vertex.z = static_cast<float>(positions[i].z);
+            vertex.time = static_cast<float>(timeOffsets[i]);
+            vertex.epoch = orbit.epoch;
+            vertex.period = orbit.period;
+        }
+    };
 
-            vertexBufIdx++;
+    const size_t nTasks = (nOrbits + OrbitsPerTask - 1) / OrbitsPerTask;
+    if (nTasks > 1) {
+        // The calling thread participates in the work as well
+        ThreadPool::shared().parallelFor(0, nTasks, computeVertices);
+    }
+    else {
+        for (size_t task = 0; task < nTasks; ++task) {
+            computeVertices(task);
         }
     }
 
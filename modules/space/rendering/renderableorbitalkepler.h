@@ -28,12 +28,14 @@
 #include <openspace/rendering/renderable.h>
 
 #include <modules/base/rendering/renderabletrail.h>
+#include <modules/space/rendering/orbitalcatalog.h>
 #include <modules/space/translation/keplertranslation.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/scalar/uintproperty.h>
 #include <ghoul/glm.h>
 #include <ghoul/misc/objectmanager.h>
 #include <ghoul/opengl/programobject.h>
+#include <filesystem>
 
 namespace openspace {
 
@@ -66,25 +68,26 @@ public:
 protected:
     static documentation::Documentation Documentation();
 
-    double calculateSemiMajorAxis(double meanMotion) const;
-    double epochFromSubstring(const std::string& epochString) const;
-    double epochFromYMDdSubstring(const std::string& epochString);
+    static double calculateSemiMajorAxis(double meanMotion);
+    static double epochFromSubstring(const std::string& epochString);
+    static double epochFromYMDdSubstring(const std::string& epochString);
+
+    /**
+     * Returns the catalog of the file \p filename that is in the provided \p format. The
+     * file is only ingested again if \p filename or the modification time of the file
+     * changed since the last call, so changes to the rendered range of objects are only
+     * a slice of the returned catalog that does not require any text parsing.
+     *
+     * \throw ghoul::RuntimeError If the file could not be opened or parsed
+     */
+    const orbitalcatalog::Catalog& catalog(const std::string& filename,
+        const orbitalcatalog::Format& format);
 
     std::function<void()> _reinitializeTrailBuffers;
     std::function<void()> _updateStartRenderIdxSelect;
     std::function<void()> _updateRenderSizeSelect;
 
-    struct KeplerParameters {
-        double inclination = 0.0;
-        double semiMajorAxis = 0.0;
-        double ascendingNode = 0.0;
-        double eccentricity = 0.0;
-        double argumentOfPeriapsis = 0.0;
-        double meanAnomaly = 0.0;
-        double meanMotion = 0.0;
-        double epoch = 0.0;
-        double period = 0.0;
-    };
+    using KeplerParameters = orbitalcatalog::Entry;
 
     bool _updateDataBuffersAtNextRender = false;
     std::streamoff _numObjects;
@@ -100,6 +103,10 @@ protected:
     properties::Property::OnChangeHandle _sizeRenderCallbackHandle;
 
 private:
+    orbitalcatalog::Catalog _catalog;
+    std::string _catalogPath;
+    std::filesystem::file_time_type _catalogTimestamp;
+
     struct Vertex {
         glm::vec3 position = glm::vec3(0.f);
         glm::vec3 color = glm::vec3(0.f);
@@ -116,8 +123,6 @@ private:
         double period = 0.0;
     };
 
-    KeplerTranslation _keplerTranslator;
-
     /// The backend storage for the vertex buffer object containing all points for this
     /// trail.
     std::vector<TrailVBOLayout> _vertexBufferData;
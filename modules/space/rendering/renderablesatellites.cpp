@@ -42,6 +42,7 @@
 #include <chrono>
 #include <math.h>
 #include <fstream>
+#include <sstream>
 #include <vector>
 
 namespace {
@@ -104,143 +105,151 @@ RenderableSatellites::RenderableSatellites(const ghoul::Dictionary& dictionary)
     _sizeRenderCallbackHandle = _sizeRender.onChange(_updateRenderSizeSelect);
 }
 
+orbitalcatalog::Format RenderableSatellites::catalogFormat() {
+    orbitalcatalog::Format format;
+    // Has to change whenever parseCatalogEntry changes to invalidate the cache files
+    format.identifier = "TLE-2";
+    format.nLinesPerEntry = nLineEntriesPerSatellite;
+    format.parser = &RenderableSatellites::parseCatalogEntry;
+    return format;
+}
+
 void RenderableSatellites::readDataFile(const std::string& filename) {
     if (!FileSys.fileExists(filename)) {
         throw ghoul::RuntimeError(fmt::format(
             "Satellite TLE file {} does not exist.", filename
         ));
     }
+
+    // The file is only parsed the first time, changes to the rendered objects only copy
+    // the elements from the catalog
+    const orbitalcatalog::Catalog& tle = catalog(filename, catalogFormat());
     _data.clear();
     _segmentSize.clear();
 
-    std::ifstream file;
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    file.open(filename);
-
-    std::streamoff numberOfLines = std::count(
-        std::istreambuf_iterator<char>(file),
-        std::istreambuf_iterator<char>(),
-        '\n'
-    );
-    file.seekg(std::ios_base::beg); // reset iterator to beginning of file
-
-    _numObjects = numberOfLines / nLineEntriesPerSatellite;
+    _numObjects = static_cast<std::streamoff>(tle.nEntries());
+    if (_numObjects == 0) {
+        return;
+    }
 
     if (!_isFileReadinitialized) {
         _isFileReadinitialized = true;
         initializeFileReading();
     }
 
-    std::string line = "-";
-    std::string name;
     long long endElement = _startRenderIdx + _sizeRender - 1;
     endElement = (endElement >= _numObjects) ? _numObjects - 1 : endElement;
-    //Burn lines if not starting at first element
-    for (unsigned int k = 0; k < _startRenderIdx; ++k) {
-        skipSingleEntryInFile(file);
-    }
     for (std::streamoff i = _startRenderIdx; i <= endElement; i++) {
-        //Read title line
-        std::getline(file, name);
-        KeplerParameters keplerElements;
-
-        std::getline(file, line);
-        if (line[0] == '1') {
-            // First line
-            // Field Columns   Content
-            //     1   01-01   Line number
-            //     2   03-07   Satellite number
-            //     3   08-08   Classification (U = Unclassified)
-            //     4   10-11   International Designator (Last two digits of launch year)
-            //     5   12-14   International Designator (Launch number of the year)
-            //     6   15-17   International Designator(piece of the launch)    A
-            name += " " + line.substr(2, 15);
-            if (_startRenderIdx == i && _sizeRender == 1) {
-                LINFO(fmt::format(
-                    "Set render block to start at object  {}",
-                    name
-                ));
-            }
-            //     7   19-20   Epoch Year(last two digits of year)
-            //     8   21-32   Epoch(day of the year and fractional portion of the day)
-            //     9   34-43   First Time Derivative of the Mean Motion divided by two
-            //    10   45-52   Second Time Derivative of Mean Motion divided by six
-            //    11   54-61   BSTAR drag term(decimal point assumed)[10] - 11606 - 4
-            //    12   63-63   The "Ephemeris type"
-            //    13   65-68   Element set  number.Incremented when a new TLE is generated
-            //    14   69-69   Checksum (modulo 10)
-            keplerElements.epoch = epochFromSubstring(line.substr(18, 14));
-        }
-        else {
-            throw ghoul::RuntimeError(fmt::format(
-                "File {} entry {} does not have '1' header", filename, i + 1
-            ));
+        if (_startRenderIdx == i && _sizeRender == 1) {
+            LINFO(fmt::format("Set render block to start at object  {}", tle.name(i)));
         }
 
-        std::getline(file, line);
-        if (line[0] == '2') {
-            // Second line
-            // Field    Columns   Content
-            //     1      01-01   Line number
-            //     2      03-07   Satellite number
-            //     3      09-16   Inclination (degrees)
-            //     4      18-25   Right ascension of the ascending node (degrees)
-            //     5      27-33   Eccentricity (decimal point assumed)
-            //     6      35-42   Argument of perigee (degrees)
-            //     7      44-51   Mean Anomaly (degrees)
-            //     8      53-63   Mean Motion (revolutions per day)
-            //     9      64-68   Revolution number at epoch (revolutions)
-            //    10      69-69   Checksum (modulo 10)
-
-            std::stringstream stream;
-            stream.exceptions(std::ios::failbit);
-
-            // Get inclination
-            stream.str(line.substr(8, 8));
-            stream >> keplerElements.inclination;
-            stream.clear();
-
-            // Get Right ascension of the ascending node
-            stream.str(line.substr(17, 8));
-            stream >> keplerElements.ascendingNode;
-            stream.clear();
-
-            // Get Eccentricity
-            stream.str("0." + line.substr(26, 7));
-            stream >> keplerElements.eccentricity;
-            stream.clear();
-
-            // Get argument of periapsis
-            stream.str(line.substr(34, 8));
-            stream >> keplerElements.argumentOfPeriapsis;
-            stream.clear();
-
-            // Get mean anomaly
-            stream.str(line.substr(43, 8));
-            stream >> keplerElements.meanAnomaly;
-            stream.clear();
-
-            // Get mean motion
-            stream.str(line.substr(52, 11));
-            stream >> keplerElements.meanMotion;
-        }
-        else {
-            throw ghoul::RuntimeError(fmt::format(
-                "File {} entry {} does not have '2' header", filename, i + 1
-            ));
+        // Entries that could not be parsed have no orbital period and are not rendered
+        if (!tle.isValid(i)) {
+            continue;
         }
 
-        // Calculate the semi major axis based on the mean motion using kepler's laws
-        keplerElements.semiMajorAxis = calculateSemiMajorAxis(keplerElements.meanMotion);
+        _data.push_back(tle.entry(i));
+        _segmentSize.push_back(_segmentQuality * 16);
+    }
+}
+
+bool RenderableSatellites::parseCatalogEntry(const std::vector<std::string_view>& lines,
+                                             KeplerParameters& keplerElements,
+                                             std::string& name)
+{
+    // Title line
+    name = std::string(lines[0]);
+
+    std::string line = std::string(lines[1]);
+    if (!line.empty() && line[0] == '1') {
+        // First line
+        // Field Columns   Content
+        //     1   01-01   Line number
+        //     2   03-07   Satellite number
+        //     3   08-08   Classification (U = Unclassified)
+        //     4   10-11   International Designator (Last two digits of launch year)
+        //     5   12-14   International Designator (Launch number of the year)
+        //     6   15-17   International Designator(piece of the launch)    A
+        name += " " + line.substr(2, 15);
+        //     7   19-20   Epoch Year(last two digits of year)
+        //     8   21-32   Epoch(day of the year and fractional portion of the day)
+        //     9   34-43   First Time Derivative of the Mean Motion divided by two
+        //    10   45-52   Second Time Derivative of Mean Motion divided by six
+        //    11   54-61   BSTAR drag term(decimal point assumed)[10] - 11606 - 4
+        //    12   63-63   The "Ephemeris type"
+        //    13   65-68   Element set  number.Incremented when a new TLE is generated
+        //    14   69-69   Checksum (modulo 10)
+        keplerElements.epoch = epochFromSubstring(line.substr(18, 14));
+    }
+    else {
+        throw ghoul::RuntimeError("Entry does not have '1' header");
+    }
 
-        using namespace std::chrono;
-        double period = seconds(hours(24)).count() / keplerElements.meanMotion;
-        keplerElements.period = period;
+    line = std::string(lines[2]);
+    if (!line.empty() && line[0] == '2') {
+        // Second line
+        // Field    Columns   Content
+        //     1      01-01   Line number
+        //     2      03-07   Satellite number
+        //     3      09-16   Inclination (degrees)
+        //     4      18-25   Right ascension of the ascending node (degrees)
+        //     5      27-33   Eccentricity (decimal point assumed)
+        //     6      35-42   Argument of perigee (degrees)
+        //     7      44-51   Mean Anomaly (degrees)
+        //     8      53-63   Mean Motion (revolutions per day)
+        //     9      64-68   Revolution number at epoch (revolutions)
+        //    10      69-69   Checksum (modulo 10)
+
+        std::stringstream stream;
+        stream.exceptions(std::ios::failbit);
+
+        // Get inclination
+        stream.str(line.substr(8, 8));
+        stream >> keplerElements.inclination;
+        stream.clear();
+
+        // Get Right ascension of the ascending node
+        stream.str(line.substr(17, 8));
+        stream >> keplerElements.ascendingNode;
+        stream.clear();
+
+        // Get Eccentricity
+        stream.str("0." + line.substr(26, 7));
+        stream >> keplerElements.eccentricity;
+        stream.clear();
+
+        // Get argument of periapsis
+        stream.str(line.substr(34, 8));
+        stream >> keplerElements.argumentOfPeriapsis;
+        stream.clear();
+
+        // Get mean anomaly
+        stream.str(line.substr(43, 8));
+        stream >> keplerElements.meanAnomaly;
+        stream.clear();
+
+        // Get mean motion
+        stream.str(line.substr(52, 11));
+        stream >> keplerElements.meanMotion;
+    }
+    else {
+        throw ghoul::RuntimeError("Entry does not have '2' header");
+    }
 
-        _data.push_back(keplerElements);
-        _segmentSize.push_back(_segmentQuality * 16);
+    if (keplerElements.meanMotion <= 0.0) {
+        // The object would not have a finite orbital period
+        return false;
     }
-    file.close();
+
+    // Calculate the semi major axis based on the mean motion using kepler's laws
+    keplerElements.semiMajorAxis = calculateSemiMajorAxis(keplerElements.meanMotion);
+
+    using namespace std::chrono;
+    double period = seconds(hours(24)).count() / keplerElements.meanMotion;
+    keplerElements.period = period;
+
+    return true;
 }
 
 void RenderableSatellites::initializeFileReading() {
@@ -251,11 +260,4 @@ void RenderableSatellites::initializeFileReading() {
     }
 }
 
-void RenderableSatellites::skipSingleEntryInFile(std::ifstream& file) {
-    std::string line;
-    for (unsigned int i = 0; i < nLineEntriesPerSatellite; i++) {
-        std::getline(file, line);
-    }
-}
-
 }
@@ -47,9 +47,13 @@ public:
     static documentation::Documentation Documentation();
     void initializeFileReading();
 
+    /// Returns the format of the two-line element set files that are read
+    static orbitalcatalog::Format catalogFormat();
+
 private:
-    void skipSingleEntryInFile(std::ifstream& file);
-    const unsigned int nLineEntriesPerSatellite = 3;
+    static bool parseCatalogEntry(const std::vector<std::string_view>& lines,
+        KeplerParameters& keplerElements, std::string& name);
+    static constexpr const int nLineEntriesPerSatellite = 3;
 };
 
 } // namespace openspace
@@ -40,9 +40,11 @@
 #include <ghoul/misc/csvreader.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/logging/logmanager.h>
+#include <array>
 #include <chrono>
 #include <fstream>
 #include <math.h>
+#include <stdexcept>
 #include <vector>
 
 namespace {
@@ -171,6 +173,17 @@ RenderableSmallBody::RenderableSmallBody(const ghoul::Dictionary& dictionary)
         _contiguousMode.onChange(_updateContiguousModeSelect);
 }
 
+orbitalcatalog::Format RenderableSmallBody::catalogFormat() {
+    orbitalcatalog::Format format;
+    // Has to change whenever parseCatalogEntry changes to invalidate the cache files
+    format.identifier = "JPL-SBDB-1";
+    format.header = "full_name,epoch_cal,e,a,i,om,w,ma,per";
+    format.nLinesPerEntry = 1;
+    format.parser = &RenderableSmallBody::parseCatalogEntry;
+    format.maxSequentialErrors = 4;
+    return format;
+}
+
 void RenderableSmallBody::readDataFile(const std::string& filename) {
     if (!FileSys.fileExists(filename)) {
         throw ghoul::RuntimeError(fmt::format(
@@ -178,126 +191,62 @@ void RenderableSmallBody::readDataFile(const std::string& filename) {
         ));
     }
 
-    std::ifstream file;
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    file.open(filename);
-
-    std::streamoff numberOfLines = std::count(
-        std::istreambuf_iterator<char>(file),
-        std::istreambuf_iterator<char>(),
-        '\n'
-    );
-    file.seekg(std::ios_base::beg); // reset iterator to beginning of file
+    // The file is only parsed the first time, changes to the rendered objects only copy
+    // the elements from the catalog
+    const orbitalcatalog::Catalog& sbdb = catalog(filename, catalogFormat());
     _data.clear();
-    _sbNames.clear();
     _segmentSize.clear();
 
-    std::string line;
-    unsigned int csvLine = 0;
-    int fieldCount = 0;
-    const std::string expectedHeaderLine = "full_name,epoch_cal,e,a,i,om,w,ma,per";
+    const std::streamoff numberOfObjects = static_cast<std::streamoff>(sbdb.nEntries());
+    if (_numObjects != numberOfObjects) {
+        _isFileReadinitialized = false;
+    }
+    _numObjects = numberOfObjects;
+    if (_numObjects == 0) {
+        return;
+    }
 
-    try {
-        std::getline(file, line); // get rid of first line (header)
-        numberOfLines -= 1;
-        if (_numObjects != numberOfLines) {
-            _isFileReadinitialized = false;
-        }
-        _numObjects = numberOfLines;
+    if (!_isFileReadinitialized) {
+        _isFileReadinitialized = true;
+        initializeFileReading();
+    }
 
-        float lineSkipFraction = 1.0;
-        if (!_isFileReadinitialized) {
-            _isFileReadinitialized = true;
-            initializeFileReading();
-        }
+    float lineSkipFraction = 1.f;
+    unsigned int startElement = 0;
+    unsigned int endElement;
+    if (_contiguousMode) {
+        startElement = _startRenderIdx;
+        endElement = _startRenderIdx + _sizeRender - 1;
+    }
+    else {
+        lineSkipFraction = static_cast<float>(_upperLimit)
+            / static_cast<float>(_numObjects);
+        endElement = static_cast<unsigned int>(_numObjects - 1);
+    }
+    endElement =
+        (endElement >= _numObjects) ?
+        static_cast<unsigned int>(_numObjects - 1) :
+        endElement;
 
-        unsigned int startElement = 0;
-        unsigned int endElement;
-        if (_contiguousMode) {
-            lineSkipFraction = 1.0;
-            startElement = _startRenderIdx;
-            endElement = _startRenderIdx + _sizeRender - 1;
-        }
-        else {
-            lineSkipFraction = static_cast<float>(_upperLimit)
-                / static_cast<float>(_numObjects);
-            endElement = _numObjects - 1;
-        }
+    const double scale = static_cast<double>(_segmentQuality) * 10.0;
+    int lastLineCount = -1;
+    for (unsigned int i = startElement; i <= endElement; ++i) {
+        const float currLineFraction = static_cast<float>(i) * lineSkipFraction;
+        const int currLineCount = static_cast<int>(currLineFraction);
+        if (currLineCount > lastLineCount && sbdb.isValid(i)) {
+            const KeplerParameters& keplerElements = sbdb.entry(i);
+            if (_startRenderIdx > 0 && _startRenderIdx == i && _sizeRender == 1) {
+                LINFO(fmt::format(
+                    "Set render block to start at object  {}", sbdb.name(i)
+                ));
+            }
 
-        if (line.compare(expectedHeaderLine) != 0) {
-            LERROR(fmt::format(
-                "File {} does not have the appropriate JPL SBDB header at line 1",
-                filename
+            _data.push_back(keplerElements);
+            _segmentSize.push_back(static_cast<size_t>(
+                scale + (scale / pow(1 - keplerElements.eccentricity, 1.2))
             ));
-            return;
-        }
-
-        unsigned int sequentialLineErrors = 0;
-        endElement =
-            (endElement >= _numObjects) ?
-            static_cast<unsigned int>(_numObjects - 1) :
-            endElement;
-        // Burn lines if not starting at first element
-        for (unsigned int k = 0; k < startElement; ++k) {
-            skipSingleLineInFile(file);
-        }
-        bool firstDataLine = true;
-        int lastLineCount = -1;
-        for (csvLine = startElement + 1;
-             csvLine <= endElement + 1;
-             csvLine++, sequentialLineErrors++)
-        {
-            float currLineFraction = static_cast<float>(csvLine - 1) * lineSkipFraction;
-            int currLineCount = static_cast<int>(currLineFraction);
-            if (currLineCount > lastLineCount) {
-                try {
-                    readOrbitalParamsFromThisLine(firstDataLine, fieldCount, csvLine,
-                        file);
-                    sequentialLineErrors = 0;
-                }
-                catch (std::invalid_argument&) {
-                    const char* errMsg = "Unable to convert field {} to double value "\
-                        "(invalid_argument exception). Ignoring line {}/{} of {}.";
-                    LINFO(fmt::format(
-                        errMsg,
-                        fieldCount, csvLine + 1, numberOfLines, filename
-                    ));
-                }
-                catch (std::out_of_range&) {
-                    const char* errMsg = "Unable to convert field {} to double value "\
-                        "(out_of_range exception). Ignoring line {}/{} of {}.";
-                    LINFO(fmt::format(
-                        errMsg,
-                        fieldCount, csvLine + 1, numberOfLines, filename
-                    ));
-                }
-                catch (std::ios_base::failure&) {
-                    throw;
-                }
-
-                if (sequentialLineErrors == 4) {
-                    _data.clear();
-                    _sbNames.clear();
-                    LERROR(fmt::format(
-                        "Abandoning data file {} (too many sequential line errors).",
-                        filename
-                    ));
-                    break;
-                }
-            }
-            else {
-                skipSingleLineInFile(file);
-            }
-            lastLineCount = currLineCount;
-            firstDataLine = false;
         }
-    }
-    catch (const std::ios_base::failure&) {
-        LERROR(fmt::format(
-            "File read exception (ios_base::failure) while trying to read field {} at "
-            "line {}/{} of {}",
-            fieldCount, csvLine + 1, numberOfLines, filename
-        ));
+        lastLineCount = currLineCount;
     }
 }
 
@@ -314,116 +263,61 @@ void RenderableSmallBody::initializeFileReading() {
     }
 }
 
-void RenderableSmallBody::skipSingleLineInFile(std::ifstream& file) {
-    std::string line;
-    std::getline(file, line);
-}
-
-void RenderableSmallBody::readOrbitalParamsFromThisLine(bool firstDataLine,
-                                                        int& fieldCount,
-                                                        unsigned int& csvLine,
-                                                        std::ifstream& file)
+bool RenderableSmallBody::parseCatalogEntry(const std::vector<std::string_view>& lines,
+                                            KeplerParameters& keplerElements,
+                                            std::string& name)
 {
-    const int numDataFields = 8;
-    std::string name;
-    std::string field;
-    KeplerParameters keplerElements;
-
-    //If there was a read/conversion error in the previous line, then read the remainder
-    // of that line and throw it out first before proceeding with the next line.
-    if (fieldCount != (numDataFields + 1) && !firstDataLine) {
-        std::getline(file, field);
+    // The fields in the order of the header, where the last one extends to the end of
+    // the line
+    constexpr const std::array<const char*, 9> FieldNames = {
+        "object designator", "epoch", "eccentricity", "semi-major axis", "inclination",
+        "ascending node", "arg of periapsis", "mean anomaly", "period"
+    };
+    std::array<std::string, FieldNames.size()> fields;
+    std::string_view line = lines.front();
+    for (size_t i = 0; i < fields.size() - 1; ++i) {
+        const size_t separator = line.find(',');
+        if (separator == std::string_view::npos) {
+            throw std::invalid_argument(
+                fmt::format("Unable to read {}", FieldNames[i + 1])
+            );
+        }
+        fields[i] = std::string(line.substr(0, separator));
+        line.remove_prefix(separator + 1);
     }
-    fieldCount = 0;
+    fields.back() = std::string(line);
 
     // Object designator string
-    std::getline(file, name, ',');
-    if (_startRenderIdx > 0 && _startRenderIdx == (csvLine - 1) && _sizeRender == 1) {
-        formatObjectName(name);
-        LINFO(fmt::format("Set render block to start at object  {}", name));
-    }
-    fieldCount++;
+    name = std::move(fields[0]);
+    formatObjectName(name);
 
     // Epoch
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read epoch from line"  + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.epoch = epochFromYMDdSubstring(field);
-    fieldCount++;
+    keplerElements.epoch = epochFromYMDdSubstring(fields[1]);
 
     // Eccentricity (unit-less)
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read eccentricity from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.eccentricity = std::stod(field);
-    fieldCount++;
+    keplerElements.eccentricity = std::stod(fields[2]);
 
     // Semi-major axis (astronomical units - au)
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read semi-major axis from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.semiMajorAxis = std::stod(field);
+    keplerElements.semiMajorAxis = std::stod(fields[3]);
     keplerElements.semiMajorAxis *= convertAuToKm;
-    fieldCount++;
 
     // Inclination (degrees)
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read inclination from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.inclination = importAngleValue(field);
-    fieldCount++;
+    keplerElements.inclination = importAngleValue(fields[4]);
 
     // Longitude of ascending node (degrees)
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read ascending node from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.ascendingNode = importAngleValue(field);
-    fieldCount++;
+    keplerElements.ascendingNode = importAngleValue(fields[5]);
 
     // Argument of Periapsis (degrees)
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read arg of periapsis from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.argumentOfPeriapsis = importAngleValue(field);
-    fieldCount++;
+    keplerElements.argumentOfPeriapsis = importAngleValue(fields[6]);
 
     // Mean Anomaly (degrees)
-    if (!std::getline(file, field, ',')) {
-        throw std::invalid_argument(
-            "Unable to read mean anomaly from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.meanAnomaly = importAngleValue(field);
-    fieldCount++;
+    keplerElements.meanAnomaly = importAngleValue(fields[7]);
 
     // Period (days)
-    if (!std::getline(file, field)) {
-        throw std::invalid_argument(
-            "Unable to read period from line" + std::to_string(csvLine + 1)
-        );
-    }
-    keplerElements.period = std::stod(field);
+    keplerElements.period = std::stod(fields[8]);
     keplerElements.period *= convertDaysToSecs;
-    fieldCount++;
 
-    _data.push_back(keplerElements);
-    _sbNames.push_back(name);
-    const double scale = static_cast<double>(_segmentQuality) * 10.0;
-    _segmentSize.push_back(
-        static_cast<size_t>(scale + (scale / pow(1 - keplerElements.eccentricity, 1.2)))
-    );
+    return true;
 }
 
 } // namespace openspace
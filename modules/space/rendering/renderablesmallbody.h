@@ -45,14 +45,15 @@ public:
     RenderableSmallBody(const ghoul::Dictionary& dictionary);
     static documentation::Documentation Documentation();
 
+    /// Returns the format of the JPL Small-Body Database CSV files that are read
+    static orbitalcatalog::Format catalogFormat();
+
 private:
-    void readOrbitalParamsFromThisLine(bool firstDataLine, int& fieldCount,
-        unsigned int& csvLine, std::ifstream& file);
+    static bool parseCatalogEntry(const std::vector<std::string_view>& lines,
+        KeplerParameters& keplerElements, std::string& name);
     virtual void readDataFile(const std::string& filename) override;
     void initializeFileReading();
-    void skipSingleLineInFile(std::ifstream& file);
 
-    std::vector<std::string> _sbNames;
     std::function<void()> _updateContiguousModeSelect;
     std::function<void()> _updateRenderUpperLimitSelect;
 
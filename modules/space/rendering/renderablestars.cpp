@@ -31,7 +31,6 @@
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/globals.h>
 #include <openspace/rendering/renderengine.h>
-#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/templatefactory.h>
@@ -43,7 +42,6 @@
 #include <array>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <limits>
 #include <type_traits>
@@ -59,8 +57,6 @@ namespace {
         "filterOutOfRange", "fixedColor"
     };
 
-    constexpr int8_t CurrentCacheVersion = 3;
-
     constexpr const int RenderOptionPointSpreadFunction = 0;
     constexpr const int RenderOptionTexture = 1;
 
@@ -880,7 +876,7 @@ void RenderableStars::renderPSFToTexture() {
 }
 
 void RenderableStars::render(const RenderData& data, RendererTasks&) {
-    if (_fullData.empty()) {
+    if (_dataset.isEmpty()) {
         return;
     }
 
@@ -980,7 +976,7 @@ void RenderableStars::render(const RenderData& data, RendererTasks&) {
 
 
     glBindVertexArray(_vao);
-    const GLsizei nStars = static_cast<GLsizei>(_fullData.size() / _nValuesPerStar);
+    const GLsizei nStars = static_cast<GLsizei>(_dataset.nEntries());
     glDrawArrays(GL_POINTS, 0, nStars);
 
     glBindVertexArray(0);
@@ -998,7 +994,7 @@ void RenderableStars::update(const UpdateData&) {
         _dataIsDirty = true;
     }
 
-    if (_fullData.empty()) {
+    if (_dataset.isEmpty()) {
         return;
     }
 
@@ -1031,7 +1027,7 @@ void RenderableStars::update(const UpdateData&) {
             "in_bvLumAbsMagAppMag"
         );
 
-        const size_t nStars = _fullData.size() / _nValuesPerStar;
+        const size_t nStars = _dataset.nEntries();
         const size_t nValues = _slicedData.size() / nStars;
 
         GLsizei stride = static_cast<GLsizei>(sizeof(GLfloat) * nValues);
@@ -1242,239 +1238,64 @@ void RenderableStars::loadData() {
         return;
     }
 
-    std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        file,
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
-
-    _nValuesPerStar = 0;
     _slicedData.clear();
-    _fullData.clear();
     _dataNames.clear();
 
-    bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format("Cached file '{}' used for Speck file '{}'",
-            cachedFile, file
-        ));
-
-        bool success = loadCachedFile(cachedFile);
-        if (success) {
+    // The luminosity is normalized and entries that only contain 0 are removed before
+    // the data is stored in the cache, so that none of this has to happen on later runs
+    auto postProcessing = [](speck::Dataset& dataset) {
+        const int lumIndex = dataset.index("lum");
+        if (lumIndex < 0) {
             return;
         }
-        else {
-            FileSys.cacheManager()->removeCacheFile(file);
-            // Intentional fall-through to the 'else' computation to generate the cache
-            // file for the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Speck file '{}' not found", file));
-    }
-    LINFO(fmt::format("Loading Speck file '{}'", file));
-
-    readSpeckFile();
-
-    LINFO("Saving cache");
-    saveCachedFile(cachedFile);
-}
-
-void RenderableStars::readSpeckFile() {
-    std::string _file = _speckFile;
-    std::ifstream file(_file);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _file));
-        return;
-    }
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line, '\n');
-
-        if (line[0] == '#' || line.empty()) {
-            continue;
-        }
 
-        if (line.substr(0, 7) != "datavar" &&
-            line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture")
-        {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
-            if (_enableTestGrid) {
-                file.seekg(position - std::streamoff(8));
-            }
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly overwrite
-            // the 'nValues' variable with the latest index, we will end up with the total
-            // number of values (+3 since X Y Z are not counted in the Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy;
-            str >> _nValuesPerStar;
-
-            std::string name;
-            str >> name;
-            _dataNames.push_back(name);
-
-            // +3 because the position x, y, z
-            if (name == "lum") {
-                _lumArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "absmag") {
-                _absMagArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "appmag") {
-                _appMagArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "colorb_v") {
-                _bvColorArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "vx") {
-                _velocityArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "speed") {
-                _speedArrayPos = _nValuesPerStar + 3;
-            }
-            _nValuesPerStar += 1; // We want the number, but the index is 0 based
-        }
-    }
-
-    _nValuesPerStar += 3; // X Y Z are not counted in the Speck file indices
-    _otherDataOption.addOptions(_dataNames);
-
-    float minLumValue = std::numeric_limits<float>::max();
-    float maxLumValue = std::numeric_limits<float>::min();
-
-    do {
-        std::vector<float> values(_nValuesPerStar);
-        std::stringstream str(line);
-
-        for (int i = 0; i < _nValuesPerStar; ++i) {
-            str >> values[i];
-        }
-
-        bool nullArray = true;
-        for (float v : values) {
-            if (v != 0.0) {
-                nullArray = false;
-                break;
+        std::vector<bool> isNull(dataset.nEntries(), true);
+        for (int c = 0; c < dataset.nColumns(); ++c) {
+            const float* values = dataset.column(c);
+            for (size_t i = 0; i < dataset.nEntries(); ++i) {
+                if (values[i] != 0.f) {
+                    isNull[i] = false;
+                }
             }
         }
-        minLumValue = values[_lumArrayPos] < minLumValue ?
-            values[_lumArrayPos] : minLumValue;
-        maxLumValue = values[_lumArrayPos] > maxLumValue ?
-            values[_lumArrayPos] : maxLumValue;
-        if (!nullArray) {
-            _fullData.insert(_fullData.end(), values.begin(), values.end());
-        }
-
-        std::getline(file, line, '\n');
-
-    } while (!file.eof());
-
-    // Normalize Luminosity:
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerStar) {
-        _fullData[i + _lumArrayPos] =
-            (_fullData[i + _lumArrayPos] - minLumValue) / (maxLumValue - minLumValue);
-    }
-}
 
-bool RenderableStars::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (fileStream.good()) {
-        int8_t version = 0;
-        fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-        if (version != CurrentCacheVersion) {
-            LINFO("The format of the cached file has changed: deleting old cache");
-            fileStream.close();
-            FileSys.deleteFile(file);
-            return false;
+        float minLumValue = std::numeric_limits<float>::max();
+        float maxLumValue = std::numeric_limits<float>::min();
+        float* lum = dataset.mutableColumn(lumIndex);
+        for (size_t i = 0; i < dataset.nEntries(); ++i) {
+            minLumValue = std::min(minLumValue, lum[i]);
+            maxLumValue = std::max(maxLumValue, lum[i]);
         }
-
-        int32_t nValues = 0;
-        fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_nValuesPerStar), sizeof(int32_t));
-
-        fileStream.read(reinterpret_cast<char*>(&_lumArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_absMagArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_appMagArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_bvColorArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_velocityArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_speedArrayPos), sizeof(int32_t));
-
-        for (int i = 0; i < _nValuesPerStar - 3; ++i) {
-            uint16_t len;
-            fileStream.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-            std::vector<char> buffer(len);
-            fileStream.read(buffer.data(), len);
-            std::string value(buffer.begin(), buffer.end());
-            _dataNames.push_back(value);
+        for (size_t i = 0; i < dataset.nEntries(); ++i) {
+            lum[i] = (lum[i] - minLumValue) / (maxLumValue - minLumValue);
         }
-        _otherDataOption.addOptions(_dataNames);
 
-        _fullData.resize(nValues);
-        fileStream.read(reinterpret_cast<char*>(
-            _fullData.data()),
-            nValues * sizeof(_fullData[0])
-        );
+        dataset.removeEntries([&isNull](size_t i) { return isNull[i]; });
+    };
 
-        bool success = fileStream.good();
-        return success;
+    try {
+        _dataset = speck::loadSpeckFileCached(file, "RenderableStars", postProcessing);
     }
-    else {
-        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
-        return false;
-    }
-}
-
-void RenderableStars::saveCachedFile(const std::string& file) const {
-    std::ofstream fileStream(file, std::ofstream::binary);
-
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Error opening file '{}' for save cache file", file));
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
         return;
     }
 
-    fileStream.write(
-        reinterpret_cast<const char*>(&CurrentCacheVersion),
-        sizeof(int8_t)
-    );
-
-    int32_t nValues = static_cast<int32_t>(_fullData.size());
-    if (nValues == 0) {
-        throw ghoul::RuntimeError("Error writing cache: No values were loaded");
-    }
-    fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
-
-    int32_t nValuesPerStar = static_cast<int32_t>(_nValuesPerStar);
-    fileStream.write(reinterpret_cast<const char*>(&nValuesPerStar), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_lumArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_absMagArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_appMagArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_bvColorArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_velocityArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_speedArrayPos), sizeof(int32_t));
-
-    // -3 as we don't want to save the xyz values that are in the beginning of the file
-    for (int i = 0; i < _nValuesPerStar - 3; ++i) {
-        uint16_t len = static_cast<uint16_t>(_dataNames[i].size());
-        fileStream.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        fileStream.write(_dataNames[i].c_str(), len);
+    for (const speck::Variable& v : _dataset.variables()) {
+        _dataNames.push_back(v.name);
     }
+    _otherDataOption.addOptions(_dataNames);
 
-    size_t nBytes = nValues * sizeof(_fullData[0]);
-    fileStream.write(reinterpret_cast<const char*>(_fullData.data()), nBytes);
+    // Missing variables fall back to the first column
+    auto column = [this](std::string_view name) {
+        return std::max(_dataset.index(name), 0);
+    };
+    _lumArrayPos = column("lum");
+    _absMagArrayPos = column("absmag");
+    _appMagArrayPos = column("appmag");
+    _bvColorArrayPos = column("colorb_v");
+    _velocityArrayPos = column("vx");
+    _speedArrayPos = column("speed");
 }
 
 void RenderableStars::createDataSlice(ColorOption option) {
@@ -1485,12 +1306,8 @@ void RenderableStars::createDataSlice(ColorOption option) {
         -std::numeric_limits<float>::max()
     );
 
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerStar) {
-        glm::vec3 position = glm::vec3(
-            _fullData[i + 0],
-            _fullData[i + 1],
-            _fullData[i + 2]
-        );
+    for (size_t i = 0; i < _dataset.nEntries(); ++i) {
+        glm::vec3 position = _dataset.position(i);
         position *= openspace::distanceconstants::Parsec;
 
         switch (option) {
@@ -1506,15 +1323,15 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 if (_enableTestGrid) {
                     float sunColor = 0.650f;
-                    layout.value.value = sunColor;// _fullData[i + 3];
+                    layout.value.value = sunColor;
                 }
                 else {
-                    layout.value.value = _fullData[i + _bvColorArrayPos];
+                    layout.value.value = _dataset.value(i, _bvColorArrayPos);
                 }
 
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.luminance = _dataset.value(i, _lumArrayPos);
+                layout.value.absoluteMagnitude = _dataset.value(i, _absMagArrayPos);
+                layout.value.apparentMagnitude = _dataset.value(i, _appMagArrayPos);
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1532,14 +1349,14 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                layout.value.value = _fullData[i + _bvColorArrayPos];
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.value = _dataset.value(i, _bvColorArrayPos);
+                layout.value.luminance = _dataset.value(i, _lumArrayPos);
+                layout.value.absoluteMagnitude = _dataset.value(i, _absMagArrayPos);
+                layout.value.apparentMagnitude = _dataset.value(i, _appMagArrayPos);
 
-                layout.value.vx = _fullData[i + _velocityArrayPos];
-                layout.value.vy = _fullData[i + _velocityArrayPos + 1];
-                layout.value.vz = _fullData[i + _velocityArrayPos + 2];
+                layout.value.vx = _dataset.value(i, _velocityArrayPos);
+                layout.value.vy = _dataset.value(i, _velocityArrayPos + 1);
+                layout.value.vz = _dataset.value(i, _velocityArrayPos + 2);
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1557,12 +1374,12 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                layout.value.value = _fullData[i + _bvColorArrayPos];
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.value = _dataset.value(i, _bvColorArrayPos);
+                layout.value.luminance = _dataset.value(i, _lumArrayPos);
+                layout.value.absoluteMagnitude = _dataset.value(i, _absMagArrayPos);
+                layout.value.apparentMagnitude = _dataset.value(i, _appMagArrayPos);
 
-                layout.value.speed = _fullData[i + _speedArrayPos];
+                layout.value.speed = _dataset.value(i, _speedArrayPos);
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1580,9 +1397,9 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                int index = _otherDataOption.value();
-                // plus 3 because of the position
-                layout.value.value = _fullData[i + index + 3];
+                const int index = _otherDataOption.value();
+                const int column = _dataset.variables()[index].index;
+                layout.value.value = _dataset.value(i, column);
 
                 if (_staticFilterValue.has_value() &&
                     layout.value.value == _staticFilterValue)
@@ -1597,9 +1414,9 @@ void RenderableStars::createDataSlice(ColorOption option) {
                 _otherDataRange.setMinValue(glm::vec2(range.x));
                 _otherDataRange.setMaxValue(glm::vec2(range.y));
 
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.luminance = _dataset.value(i, _lumArrayPos);
+                layout.value.absoluteMagnitude = _dataset.value(i, _absMagArrayPos);
+                layout.value.apparentMagnitude = _dataset.value(i, _appMagArrayPos);
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -34,6 +34,7 @@
 #include <openspace/properties/propertyowner.h>
 #include <openspace/properties/vector/vec2property.h>
 #include <openspace/properties/vector/vec3property.h>
+#include <openspace/util/speckloader.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/opengl/uniformcache.h>
 #include <optional>
@@ -80,9 +81,6 @@ private:
     void createDataSlice(ColorOption option);
 
     void loadData();
-    void readSpeckFile();
-    bool loadCachedFile(const std::string& file);
-    void saveCachedFile(const std::string& file) const;
 
     properties::StringProperty _speckFile;
 
@@ -146,21 +144,20 @@ private:
     bool _enableTestGrid = false;
 
     std::vector<float> _slicedData;
-    std::vector<float> _fullData;
+    speck::Dataset _dataset;
 
-    int _nValuesPerStar = 0;
     std::string _queuedOtherData;
     std::vector<std::string> _dataNames;
 
     std::optional<float> _staticFilterValue;
     float _staticFilterReplacementValue = 0.f;
 
-    std::size_t _lumArrayPos = 0;
-    std::size_t _absMagArrayPos = 0;
-    std::size_t _appMagArrayPos = 0;
-    std::size_t _bvColorArrayPos = 0;
-    std::size_t _velocityArrayPos = 0;
-    std::size_t _speedArrayPos = 0;
+    int _lumArrayPos = 0;
+    int _absMagArrayPos = 0;
+    int _appMagArrayPos = 0;
+    int _bvColorArrayPos = 0;
+    int _velocityArrayPos = 0;
+    int _speedArrayPos = 0;
 
     GLuint _vao = 0;
     GLuint _vbo = 0;
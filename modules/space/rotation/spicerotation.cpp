@@ -26,6 +26,7 @@
 
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/util/ephemeriscache.h>
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/time.h>
 #include <openspace/util/updatestructures.h>
@@ -65,6 +66,16 @@ namespace {
 
         // [[codegen::verbatim(TimeFrameInfo.description)]]
         std::optional<std::monostate> timeFrame [[codegen::reference("core_time_frame")]];
+
+        // If this value is 'true', the rotation is evaluated from piecewise polynomials
+        // that are fitted to the SPICE kernels on demand instead of querying SPICE in
+        // every frame. This also allows the rotation to be updated on multiple threads.
+        // Defaults to 'false'
+        std::optional<bool> useEphemerisCache;
+
+        // The maximum angle in radians between a rotation computed from the ephemeris
+        // cache and the rotation provided by SPICE. Defaults to 1e-8 radians
+        std::optional<double> ephemerisCacheTolerance [[codegen::greater(0.0)]];
     };
 #include "spicerotation_codegen.cpp"
 } // namespace
@@ -86,6 +97,11 @@ SpiceRotation::SpiceRotation(const ghoul::Dictionary& dictionary)
     _sourceFrame = p.sourceFrame;
     _destinationFrame = p.destinationFrame;
 
+    _useEphemerisCache = p.useEphemerisCache.value_or(_useEphemerisCache);
+    _ephemerisCacheTolerance =
+        p.ephemerisCacheTolerance.value_or(_ephemerisCacheTolerance);
+    createEphemerisCache();
+
     if (p.kernels.has_value()) {
         if (std::holds_alternative<std::string>(*p.kernels)) {
             SpiceManager::ref().loadKernel(std::get<std::string>(*p.kernels));
@@ -110,19 +126,60 @@ SpiceRotation::SpiceRotation(const ghoul::Dictionary& dictionary)
     addProperty(_sourceFrame);
     addProperty(_destinationFrame);
 
-    _sourceFrame.onChange([this]() { requireUpdate(); });
-    _destinationFrame.onChange([this]() { requireUpdate(); });
+    _sourceFrame.onChange([this]() {
+        _handleGeneration = std::nullopt;
+        createEphemerisCache();
+        requireUpdate();
+    });
+    _destinationFrame.onChange([this]() {
+        _handleGeneration = std::nullopt;
+        createEphemerisCache();
+        requireUpdate();
+    });
+}
+
+SpiceRotation::~SpiceRotation() {} // NOLINT
+
+void SpiceRotation::createEphemerisCache() {
+    if (!_useEphemerisCache) {
+        return;
+    }
+
+    _ephemerisCache = std::make_unique<RotationEphemerisCache>(
+        _sourceFrame,
+        _destinationFrame,
+        _ephemerisCacheTolerance
+    );
+}
+
+void SpiceRotation::resolveHandles() const {
+    const unsigned long long generation = SpiceManager::kernelGeneration();
+    if (_handleGeneration == generation) {
+        return;
+    }
+
+    _sourceHandle = SpiceManager::ref().frameHandle(_sourceFrame);
+    _destinationHandle = SpiceManager::ref().frameHandle(_destinationFrame);
+    _handleGeneration = generation;
 }
 
 glm::dmat3 SpiceRotation::matrix(const UpdateData& data) const {
     if (_timeFrame && !_timeFrame->isActive(data.time)) {
         return glm::dmat3(1.0);
     }
+    if (_ephemerisCache) {
+        return _ephemerisCache->matrix(data.time.j2000Seconds());
+    }
+    resolveHandles();
     return SpiceManager::ref().positionTransformMatrix(
-        _sourceFrame,
-        _destinationFrame,
+        _sourceHandle,
+        _destinationHandle,
         data.time.j2000Seconds()
     );
 }
 
+bool SpiceRotation::isThreadSafe() const {
+    return _ephemerisCache != nullptr;
+}
+
 } // namespace openspace
@@ -29,24 +29,45 @@
 
 #include <openspace/properties/stringproperty.h>
 #include <openspace/scene/timeframe.h>
+#include <openspace/util/spicemanager.h>
+#include <memory>
+#include <optional>
 
 namespace openspace {
 
 namespace documentation { struct Documentation; }
+class RotationEphemerisCache;
 
 class SpiceRotation : public Rotation {
 public:
     SpiceRotation(const ghoul::Dictionary& dictionary);
+    ~SpiceRotation();
 
     const glm::dmat3& matrix() const;
     glm::dmat3 matrix(const UpdateData& data) const override;
 
+    /// The matrix can only be computed concurrently if the ephemeris cache is used
+    bool isThreadSafe() const override;
+
     static documentation::Documentation Documentation();
 
 private:
+    void createEphemerisCache();
+    void resolveHandles() const;
+
     properties::StringProperty _sourceFrame;
     properties::StringProperty _destinationFrame;
     ghoul::mm_unique_ptr<TimeFrame> _timeFrame;
+
+    // The handles are resolved on first use and again whenever kernels are loaded or
+    // unloaded, as kernels can define new frames
+    mutable SpiceManager::FrameHandle _sourceHandle;
+    mutable SpiceManager::FrameHandle _destinationHandle;
+    mutable std::optional<unsigned long long> _handleGeneration;
+
+    bool _useEphemerisCache = false;
+    double _ephemerisCacheTolerance = 1e-8;
+    std::unique_ptr<RotationEphemerisCache> _ephemerisCache;
 };
 
 } // namespace openspace
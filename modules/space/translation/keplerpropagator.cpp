@@ -0,0 +1,438 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/space/translation/keplerpropagator.h>
+
+#include <modules/space/translation/keplertranslation.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_KEPLERPROPAGATOR_SSE2
+#include <emmintrin.h>
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+
+namespace {
+    // The number of (orbit, time) pairs that are solved in lockstep
+    constexpr const size_t Width = 8;
+
+    // With the starting value below, two Halley iterations solve Kepler's equation to
+    // machine precision for all eccentricities in [0, 1)
+    constexpr const int NIterations = 2;
+
+    // The number of pairs that are evaluated by a single task in the threaded evaluation
+    constexpr const size_t ChunkSize = 16384;
+
+    constexpr const double TwoPi = glm::two_pi<double>();
+
+    // Taylor coefficients of sine and cosine, which are accurate to 3e-15 for |x| <= 1
+    constexpr const double S3 = -1.0 / 6.0;
+    constexpr const double S5 = 1.0 / 120.0;
+    constexpr const double S7 = -1.0 / 5040.0;
+    constexpr const double S9 = 1.0 / 362880.0;
+    constexpr const double S11 = -1.0 / 39916800.0;
+    constexpr const double S13 = 1.0 / 6227020800.0;
+    constexpr const double S15 = -1.0 / 1307674368000.0;
+    constexpr const double C2 = -1.0 / 2.0;
+    constexpr const double C4 = 1.0 / 24.0;
+    constexpr const double C6 = -1.0 / 720.0;
+    constexpr const double C8 = 1.0 / 40320.0;
+    constexpr const double C10 = -1.0 / 3628800.0;
+    constexpr const double C12 = 1.0 / 479001600.0;
+    constexpr const double C14 = -1.0 / 87178291200.0;
+    constexpr const double C16 = 1.0 / 20922789888000.0;
+
+    // Returns the mean anomaly m reduced to [-pi, pi]
+    inline double reduceAngle(double m) {
+        return m - TwoPi * std::floor(m / TwoPi + 0.5);
+    }
+
+    /**
+     * The lanes of a block that is solved for. Kepler's equation is solved with the
+     * starting value from Mikkola (1987), which is accurate to about 1e-3 and is improved
+     * by Halley iterations. Instead of evaluating sin and cos in every iteration, the
+     * sine and cosine of the mean anomaly are rotated by each correction, which is small
+     * enough for the Taylor polynomials above. The only transcendental functions are
+     * evaluated once per pair between the prepare and refine steps, which have no
+     * data-dependent branches and are vectorized where SSE2 is available.
+     */
+    struct Lanes {
+        double e[Width];
+        double m[Width];
+        double alpha[Width];
+        double z[Width];
+        double s[Width];
+        double c[Width];
+        double eccentricAnomaly[Width];
+    };
+
+#ifdef OPENSPACE_KEPLERPROPAGATOR_SSE2
+    // The SSE2 versions perform the same operations in the same order as the scalar
+    // versions below for two lanes at a time, so their results are identical
+
+    constexpr const size_t LaneStep = 2;
+
+    inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+    inline __m128d set(double v) {
+        return _mm_set1_pd(v);
+    }
+
+    void prepare(Lanes& l, size_t j) {
+        const __m128d e = _mm_loadu_pd(l.e + j);
+        const __m128d m = _mm_loadu_pd(l.m + j);
+        const __m128d den = _mm_add_pd(_mm_mul_pd(set(4.0), e), set(0.5));
+        const __m128d alpha = _mm_div_pd(_mm_sub_pd(set(1.0), e), den);
+        const __m128d beta = _mm_div_pd(m, _mm_mul_pd(set(2.0), den));
+        const __m128d root = _mm_sqrt_pd(_mm_add_pd(
+            _mm_mul_pd(beta, beta),
+            _mm_mul_pd(_mm_mul_pd(alpha, alpha), alpha)
+        ));
+        // copysign(root, beta)
+        const __m128d signMask = set(-0.0);
+        const __m128d signedRoot = _mm_or_pd(
+            _mm_andnot_pd(signMask, root),
+            _mm_and_pd(signMask, beta)
+        );
+        _mm_storeu_pd(l.alpha + j, alpha);
+        _mm_storeu_pd(l.z + j, _mm_add_pd(beta, signedRoot));
+    }
+
+    inline void sinCos(__m128d x, __m128d& s, __m128d& c) {
+        const __m128d x2 = _mm_mul_pd(x, x);
+        __m128d ps = _mm_add_pd(set(S13), _mm_mul_pd(x2, set(S15)));
+        ps = _mm_add_pd(set(S11), _mm_mul_pd(x2, ps));
+        ps = _mm_add_pd(set(S9), _mm_mul_pd(x2, ps));
+        ps = _mm_add_pd(set(S7), _mm_mul_pd(x2, ps));
+        ps = _mm_add_pd(set(S5), _mm_mul_pd(x2, ps));
+        ps = _mm_add_pd(set(S3), _mm_mul_pd(x2, ps));
+        s = _mm_add_pd(x, _mm_mul_pd(_mm_mul_pd(x, x2), ps));
+
+        __m128d pc = _mm_add_pd(set(C14), _mm_mul_pd(x2, set(C16)));
+        pc = _mm_add_pd(set(C12), _mm_mul_pd(x2, pc));
+        pc = _mm_add_pd(set(C10), _mm_mul_pd(x2, pc));
+        pc = _mm_add_pd(set(C8), _mm_mul_pd(x2, pc));
+        pc = _mm_add_pd(set(C6), _mm_mul_pd(x2, pc));
+        pc = _mm_add_pd(set(C4), _mm_mul_pd(x2, pc));
+        pc = _mm_add_pd(set(C2), _mm_mul_pd(x2, pc));
+        c = _mm_add_pd(set(1.0), _mm_mul_pd(x2, pc));
+    }
+
+    void refine(Lanes& l, size_t j) {
+        const __m128d e = _mm_loadu_pd(l.e + j);
+        const __m128d m = _mm_loadu_pd(l.m + j);
+        const __m128d z = _mm_loadu_pd(l.z + j);
+        const __m128d nonZero = _mm_cmpneq_pd(z, _mm_setzero_pd());
+        const __m128d safeZ = select(nonZero, z, set(1.0));
+        __m128d w = select(
+            nonZero,
+            _mm_sub_pd(z, _mm_div_pd(_mm_loadu_pd(l.alpha + j), safeZ)),
+            _mm_setzero_pd()
+        );
+        const __m128d w2 = _mm_mul_pd(w, w);
+        const __m128d w5 = _mm_mul_pd(_mm_mul_pd(w2, w2), w);
+        w = _mm_sub_pd(
+            w,
+            _mm_div_pd(_mm_mul_pd(set(0.078), w5), _mm_add_pd(set(1.0), e))
+        );
+        const __m128d w3 = _mm_mul_pd(_mm_mul_pd(w, w), w);
+        __m128d d = _mm_mul_pd(
+            e,
+            _mm_sub_pd(_mm_mul_pd(set(3.0), w), _mm_mul_pd(set(4.0), w3))
+        );
+        __m128d ea = _mm_add_pd(m, d);
+
+        __m128d sd;
+        __m128d cd;
+        sinCos(d, sd, cd);
+        const __m128d s0 = _mm_loadu_pd(l.s + j);
+        const __m128d c0 = _mm_loadu_pd(l.c + j);
+        __m128d s = _mm_add_pd(_mm_mul_pd(s0, cd), _mm_mul_pd(c0, sd));
+        __m128d c = _mm_sub_pd(_mm_mul_pd(c0, cd), _mm_mul_pd(s0, sd));
+
+        for (int i = 0; i < NIterations; ++i) {
+            const __m128d f = _mm_sub_pd(_mm_sub_pd(ea, _mm_mul_pd(e, s)), m);
+            const __m128d f1 = _mm_sub_pd(set(1.0), _mm_mul_pd(e, c));
+            const __m128d f2 = _mm_mul_pd(e, s);
+            const __m128d num = _mm_mul_pd(f, f1);
+            const __m128d den = _mm_sub_pd(
+                _mm_mul_pd(f1, f1),
+                _mm_mul_pd(set(0.5), _mm_mul_pd(f, f2))
+            );
+            d = _mm_div_pd(_mm_xor_pd(num, set(-0.0)), den);
+            d = _mm_min_pd(_mm_max_pd(d, set(-1.0)), set(1.0));
+            ea = _mm_add_pd(ea, d);
+
+            sinCos(d, sd, cd);
+            const __m128d sNew = _mm_add_pd(_mm_mul_pd(s, cd), _mm_mul_pd(c, sd));
+            c = _mm_sub_pd(_mm_mul_pd(c, cd), _mm_mul_pd(s, sd));
+            s = sNew;
+        }
+
+        _mm_storeu_pd(l.eccentricAnomaly + j, ea);
+        _mm_storeu_pd(l.s + j, s);
+        _mm_storeu_pd(l.c + j, c);
+    }
+#else // ^^^ OPENSPACE_KEPLERPROPAGATOR_SSE2 / !OPENSPACE_KEPLERPROPAGATOR_SSE2 vvv
+    constexpr const size_t LaneStep = 1;
+
+    void prepare(Lanes& l, size_t j) {
+        l.alpha[j] = (1.0 - l.e[j]) / (4.0 * l.e[j] + 0.5);
+        const double beta = l.m[j] / (2.0 * (4.0 * l.e[j] + 0.5));
+        const double root = std::sqrt(beta * beta + l.alpha[j] * l.alpha[j] * l.alpha[j]);
+        l.z[j] = beta + std::copysign(root, beta);
+    }
+
+    inline void sinCos(double x, double& s, double& c) {
+        const double x2 = x * x;
+        s = x + x * x2 * (S3 + x2 * (S5 + x2 * (S7 + x2 * (S9 + x2 * (S11 + x2 *
+            (S13 + x2 * S15))))));
+        c = 1.0 + x2 * (C2 + x2 * (C4 + x2 * (C6 + x2 * (C8 + x2 * (C10 + x2 *
+            (C12 + x2 * (C14 + x2 * C16)))))));
+    }
+
+    void refine(Lanes& l, size_t j) {
+        const double e = l.e[j];
+        const double m = l.m[j];
+        const double z = l.z[j];
+        double w = z != 0.0 ? z - l.alpha[j] / (z != 0.0 ? z : 1.0) : 0.0;
+        const double w2 = w * w;
+        w = w - 0.078 * (w2 * w2 * w) / (1.0 + e);
+        double d = e * (3.0 * w - 4.0 * (w * w * w));
+        double ea = m + d;
+
+        double sd;
+        double cd;
+        sinCos(d, sd, cd);
+        double s = l.s[j] * cd + l.c[j] * sd;
+        double c = l.c[j] * cd - l.s[j] * sd;
+
+        for (int i = 0; i < NIterations; ++i) {
+            const double f = ea - e * s - m;
+            const double f1 = 1.0 - e * c;
+            const double f2 = e * s;
+            d = -(f * f1) / (f1 * f1 - 0.5 * (f * f2));
+            d = std::min(std::max(d, -1.0), 1.0);
+            ea = ea + d;
+
+            sinCos(d, sd, cd);
+            const double sNew = s * cd + c * sd;
+            c = c * cd - s * sd;
+            s = sNew;
+        }
+
+        l.eccentricAnomaly[j] = ea;
+        l.s[j] = s;
+        l.c[j] = c;
+    }
+#endif // OPENSPACE_KEPLERPROPAGATOR_SSE2
+
+    /**
+     * Solves Kepler's equation for the mean anomalies l.m in [-pi, pi] and the
+     * eccentricities l.e of all lanes and stores the eccentric anomaly and its sine and
+     * cosine in the lanes. As in KeplerTranslation, the eccentric anomaly is 0 for
+     * eccentricities of 1 or above.
+     */
+    void solve(Lanes& l) {
+        double e[Width];
+        for (size_t j = 0; j < Width; ++j) {
+            // Eccentricities of 1 or above are not solved, see below
+            e[j] = l.e[j];
+            l.e[j] = e[j] < 1.0 ? e[j] : 0.0;
+        }
+
+        for (size_t j = 0; j < Width; j += LaneStep) {
+            prepare(l, j);
+        }
+        for (size_t j = 0; j < Width; ++j) {
+            l.s[j] = std::sin(l.m[j]);
+            l.c[j] = std::cos(l.m[j]);
+            l.z[j] = std::cbrt(l.z[j]);
+        }
+        for (size_t j = 0; j < Width; j += LaneStep) {
+            refine(l, j);
+        }
+
+        for (size_t j = 0; j < Width; ++j) {
+            const bool isValid = e[j] < 1.0;
+            l.e[j] = e[j];
+            l.eccentricAnomaly[j] = isValid ? l.eccentricAnomaly[j] : 0.0;
+            l.s[j] = isValid ? l.s[j] : 0.0;
+            l.c[j] = isValid ? l.c[j] : 1.0;
+        }
+    }
+} // namespace
+
+namespace openspace {
+
+size_t KeplerPropagator::Elements::size() const {
+    return eccentricity.size();
+}
+
+KeplerPropagator::KeplerPropagator(const Elements& elements) {
+    const size_t n = elements.size();
+    ghoul_assert(
+        elements.semiMajorAxis.size() == n && elements.inclination.size() == n &&
+        elements.ascendingNode.size() == n && elements.argumentOfPeriapsis.size() == n &&
+        elements.meanAnomalyAtEpoch.size() == n && elements.period.size() == n &&
+        elements.epoch.size() == n,
+        "All elements must have the same number of values"
+    );
+
+    _eccentricity.resize(n);
+    _semiMajorAxis.resize(n);
+    _semiMinorAxis.resize(n);
+    _meanAnomalyAtEpoch.resize(n);
+    _meanMotion.resize(n);
+    _epoch.resize(n);
+    _px.resize(n);
+    _py.resize(n);
+    _pz.resize(n);
+    _qx.resize(n);
+    _qy.resize(n);
+    _qz.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const double e = elements.eccentricity[i];
+        if (e < 0.0 || e > 1.0) {
+            throw KeplerTranslation::RangeError("Eccentricity");
+        }
+        if (elements.inclination[i] < 0.0 || elements.inclination[i] > 360.0) {
+            throw KeplerTranslation::RangeError("Inclination");
+        }
+
+        _eccentricity[i] = e;
+        _semiMajorAxis[i] = elements.semiMajorAxis[i] * 1000.0;
+        _semiMinorAxis[i] = _semiMajorAxis[i] * std::sqrt(1.0 - e * e);
+        _meanAnomalyAtEpoch[i] = glm::radians(elements.meanAnomalyAtEpoch[i]);
+        _meanMotion[i] = TwoPi / elements.period[i];
+        _epoch[i] = elements.epoch[i];
+
+        // The same rotations as in KeplerTranslation::computeOrbitPlane: around z by the
+        // ascending node, around x by the inclination, and around z by the argument of
+        // periapsis
+        const double asc = glm::radians(elements.ascendingNode[i]);
+        const double inc = glm::radians(elements.inclination[i]);
+        const double per = glm::radians(elements.argumentOfPeriapsis[i]);
+        const double cosAsc = std::cos(asc);
+        const double sinAsc = std::sin(asc);
+        const double cosInc = std::cos(inc);
+        const double sinInc = std::sin(inc);
+        const double cosPer = std::cos(per);
+        const double sinPer = std::sin(per);
+
+        _px[i] = cosAsc * cosPer - sinAsc * cosInc * sinPer;
+        _py[i] = sinAsc * cosPer + cosAsc * cosInc * sinPer;
+        _pz[i] = sinInc * sinPer;
+        _qx[i] = -cosAsc * sinPer - sinAsc * cosInc * cosPer;
+        _qy[i] = -sinAsc * sinPer + cosAsc * cosInc * cosPer;
+        _qz[i] = sinInc * cosPer;
+    }
+}
+
+size_t KeplerPropagator::nOrbits() const {
+    return _eccentricity.size();
+}
+
+void KeplerPropagator::evaluate(const uint32_t* orbits, const double* times, size_t n,
+                                glm::dvec3* positions) const
+{
+    Lanes lanes;
+    for (size_t begin = 0; begin < n; begin += Width) {
+        const size_t count = std::min(Width, n - begin);
+
+        // Gather the elements for the pairs of this block. Unused lanes are padded with
+        // a circular orbit
+        for (size_t j = 0; j < Width; ++j) {
+            if (j < count) {
+                const uint32_t o = orbits[begin + j];
+                ghoul_assert(o < nOrbits(), "Orbit index out of range");
+                const double t = times[begin + j] - _epoch[o];
+                lanes.e[j] = _eccentricity[o];
+                lanes.m[j] = reduceAngle(_meanAnomalyAtEpoch[o] + t * _meanMotion[o]);
+            }
+            else {
+                lanes.e[j] = 0.0;
+                lanes.m[j] = 0.0;
+            }
+        }
+
+        solve(lanes);
+
+        for (size_t j = 0; j < count; ++j) {
+            const uint32_t o = orbits[begin + j];
+            const double x = _semiMajorAxis[o] * (lanes.c[j] - lanes.e[j]);
+            const double y = _semiMinorAxis[o] * lanes.s[j];
+            positions[begin + j] = glm::dvec3(
+                _px[o] * x + _qx[o] * y,
+                _py[o] * x + _qy[o] * y,
+                _pz[o] * x + _qz[o] * y
+            );
+        }
+    }
+}
+
+void KeplerPropagator::evaluate(const uint32_t* orbits, const double* times, size_t n,
+                                glm::dvec3* positions, ThreadPool& pool) const
+{
+    const size_t nChunks = (n + ChunkSize - 1) / ChunkSize;
+    pool.parallelFor(
+        0,
+        nChunks,
+        [&](size_t chunk) {
+            const size_t begin = chunk * ChunkSize;
+            const size_t count = std::min(ChunkSize, n - begin);
+            evaluate(orbits + begin, times + begin, count, positions + begin);
+        }
+    );
+}
+
+void KeplerPropagator::solveKeplerEquation(const double* eccentricities,
+                                           const double* meanAnomalies, size_t n,
+                                           double* eccentricAnomalies)
+{
+    Lanes lanes;
+    for (size_t begin = 0; begin < n; begin += Width) {
+        const size_t count = std::min(Width, n - begin);
+        for (size_t j = 0; j < Width; ++j) {
+            lanes.e[j] = j < count ? eccentricities[begin + j] : 0.0;
+            lanes.m[j] = j < count ? reduceAngle(meanAnomalies[begin + j]) : 0.0;
+        }
+
+        solve(lanes);
+
+        for (size_t j = 0; j < count; ++j) {
+            // Undo the reduction of the mean anomaly
+            const double offset = meanAnomalies[begin + j] - lanes.m[j];
+            eccentricAnomalies[begin + j] =
+                lanes.e[j] < 1.0 ? lanes.eccentricAnomaly[j] + offset : 0.0;
+        }
+    }
+}
+
+} // namespace openspace
@@ -0,0 +1,128 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_SPACE___KEPLERPROPAGATOR___H__
+#define __OPENSPACE_MODULE_SPACE___KEPLERPROPAGATOR___H__
+
+#include <ghoul/glm.h>
+#include <cstdint>
+#include <vector>
+
+namespace openspace {
+
+class ThreadPool;
+
+/**
+ * Computes the positions of many objects on Keplerian orbits at once. The results agree
+ * with those of a KeplerTranslation with the same elements, but the elements are stored
+ * as structures of arrays and the positions are computed in fixed-size blocks, solving
+ * Kepler's equation for all (orbit, time) pairs of a block in lockstep with a fixed
+ * number of branch-free Halley iterations, which use SSE2 where it is available.
+ * Evaluations can be split across the threads of a ThreadPool.
+ */
+class KeplerPropagator {
+public:
+    /**
+     * The Keplerian elements of all orbits as structure of arrays. All vectors must have
+     * the same length. The units are the same as for KeplerTranslation::setKeplerElements
+     */
+    struct Elements {
+        /// The eccentricities in [0, 1]
+        std::vector<double> eccentricity;
+        /// The semi-major axes in km
+        std::vector<double> semiMajorAxis;
+        /// The inclinations in degrees in [0, 360]
+        std::vector<double> inclination;
+        /// The right ascensions of the ascending node in degrees
+        std::vector<double> ascendingNode;
+        /// The arguments of periapsis in degrees
+        std::vector<double> argumentOfPeriapsis;
+        /// The mean anomalies at the epoch in degrees
+        std::vector<double> meanAnomalyAtEpoch;
+        /// The orbital periods in seconds
+        std::vector<double> period;
+        /// The epochs in seconds past the J2000 epoch
+        std::vector<double> epoch;
+
+        /// Returns the number of orbits
+        size_t size() const;
+    };
+
+    /**
+     * Precomputes the orbit planes for all orbits in \p elements.
+     *
+     * \throw KeplerTranslation::RangeError If the eccentricity or inclination of any
+     *        orbit is outside the range that is accepted by KeplerTranslation
+     * \pre All vectors in \p elements must have the same length
+     */
+    explicit KeplerPropagator(const Elements& elements);
+
+    /// Returns the number of orbits
+    size_t nOrbits() const;
+
+    /**
+     * Computes the positions (in meters) of the orbits with indices \p orbits at the
+     * corresponding \p times (in seconds past the J2000 epoch) and writes them into
+     * \p positions. All three arrays contain \p n values.
+     */
+    void evaluate(const uint32_t* orbits, const double* times, size_t n,
+        glm::dvec3* positions) const;
+
+    /**
+     * Computes the same as the other #evaluate function, but splits the pairs into
+     * chunks that are evaluated in parallel on the provided \p pool.
+     */
+    void evaluate(const uint32_t* orbits, const double* times, size_t n,
+        glm::dvec3* positions, ThreadPool& pool) const;
+
+    /**
+     * Solves Kepler's equation <code>E - e * sin(E) = M</code> for the eccentric
+     * anomalies \p eccentricAnomalies of \p n pairs of \p eccentricities and
+     * \p meanAnomalies (in radians). This is the solver that is used by #evaluate. For an
+     * eccentricity of 1 or above, the result is 0, as for KeplerTranslation.
+     */
+    static void solveKeplerEquation(const double* eccentricities,
+        const double* meanAnomalies, size_t n, double* eccentricAnomalies);
+
+private:
+    std::vector<double> _eccentricity;
+    /// The semi-major axes in meters
+    std::vector<double> _semiMajorAxis;
+    /// The semi-minor axes in meters
+    std::vector<double> _semiMinorAxis;
+    /// The mean anomalies at the epoch in radians
+    std::vector<double> _meanAnomalyAtEpoch;
+    /// The mean motions in radians per second
+    std::vector<double> _meanMotion;
+    std::vector<double> _epoch;
+
+    /// The first two columns of the rotation into the orbit plane, which are the
+    /// directions to the periapsis (p) and 90 degrees ahead of it (q)
+    std::vector<double> _px, _py, _pz;
+    std::vector<double> _qx, _qy, _qz;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_SPACE___KEPLERPROPAGATOR___H__
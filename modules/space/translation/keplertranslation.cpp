@@ -156,32 +156,46 @@ KeplerTranslation::KeplerTranslation()
     , _epoch(EpochInfo, 0.0, 0.0, 1e9)
     , _period(PeriodInfo, 0.0, 0.0, 1e6)
 {
-    auto update = [this]() {
-        _orbitPlaneDirty = true;
+    // The orbit is recomputed right away instead of lazily in the position method so
+    // that the position can be calculated concurrently on worker threads. Only the
+    // eccentricity, semimajor axis, inclination, and location of ascending node
+    // invalidate the shape of the orbit. The other parameters only determine the location
+    // the spacecraft on that orbit
+    auto updateShape = [this]() {
+        updateOrbit();
+        notifyObservers();
+        requireUpdate();
+    };
+    auto updateLocation = [this]() {
+        updateOrbit();
         requireUpdate();
     };
 
-    // Only the eccentricity, semimajor axis, inclination, and location of ascending node
-    // invalidate the shape of the orbit. The other parameters only determine the location
-    // the spacecraft on that orbit
-    _eccentricity.onChange(update);
+    _eccentricity.onChange(updateShape);
     addProperty(_eccentricity);
 
-    _semiMajorAxis.onChange(update);
+    _semiMajorAxis.onChange(updateShape);
     addProperty(_semiMajorAxis);
 
-    _inclination.onChange(update);
+    _inclination.onChange(updateShape);
     addProperty(_inclination);
 
-    _ascendingNode.onChange(update);
+    _ascendingNode.onChange(updateShape);
     addProperty(_ascendingNode);
 
-    _argumentOfPeriapsis.onChange(update);
+    _argumentOfPeriapsis.onChange(updateShape);
     addProperty(_argumentOfPeriapsis);
 
+    _meanAnomalyAtEpoch.onChange(updateLocation);
     addProperty(_meanAnomalyAtEpoch);
+
+    _epoch.onChange(updateLocation);
     addProperty(_epoch);
+
+    _period.onChange(updateLocation);
     addProperty(_period);
+
+    updateOrbit();
 }
 
 KeplerTranslation::KeplerTranslation(const ghoul::Dictionary& dictionary)
@@ -201,38 +215,38 @@ KeplerTranslation::KeplerTranslation(const ghoul::Dictionary& dictionary)
     );
 }
 
-double KeplerTranslation::eccentricAnomaly(double meanAnomaly) const {
+double KeplerTranslation::eccentricAnomaly(double meanAnomaly, double eccentricity) {
     // Compute the eccentric anomaly (the location of the spacecraft taking the
     // eccentricity of the orbit into account) using different solves for the regimes in
     // which they are most efficient
 
-    if (_eccentricity == 0.0) {
+    if (eccentricity == 0.0) {
         // In a circular orbit, the eccentric anomaly = mean anomaly
         return meanAnomaly;
     }
-    else if (_eccentricity < 0.2) {
-        auto solver = [this, &meanAnomaly](double x) -> double {
+    else if (eccentricity < 0.2) {
+        auto solver = [eccentricity, &meanAnomaly](double x) -> double {
             // For low eccentricity, using a first order solver sufficient
-            return meanAnomaly + _eccentricity * sin(x);
+            return meanAnomaly + eccentricity * sin(x);
         };
         return solveIteration(solver, meanAnomaly, 0.0, 5);
     }
-    else if (_eccentricity < 0.9) {
-        auto solver = [this, &meanAnomaly](double x) -> double {
-            const double e = _eccentricity;
+    else if (eccentricity < 0.9) {
+        auto solver = [eccentricity, &meanAnomaly](double x) -> double {
+            const double e = eccentricity;
             return x + (meanAnomaly + e * sin(x) - x) / (1.0 - e * cos(x));
         };
         return solveIteration(solver, meanAnomaly, 0.0, 6);
     }
-    else if (_eccentricity < 1.0) {
+    else if (eccentricity < 1.0) {
         auto sign = [](double val) -> double {
             return val > 0.0 ? 1.0 : ((val < 0.0) ? -1.0 : 0.0);
         };
-        double e = meanAnomaly + 0.85 * _eccentricity * sign(sin(meanAnomaly));
+        double e = meanAnomaly + 0.85 * eccentricity * sign(sin(meanAnomaly));
 
-        auto solver = [this, &meanAnomaly, &sign](double x) -> double {
-            const double s = _eccentricity * sin(x);
-            const double c = _eccentricity * cos(x);
+        auto solver = [eccentricity, &meanAnomaly, &sign](double x) -> double {
+            const double s = eccentricity * sin(x);
+            const double c = eccentricity * cos(x);
             const double f = x - s - meanAnomaly;
             const double f1 = 1 - c;
             const double f2 = s;
@@ -249,26 +263,23 @@ double KeplerTranslation::eccentricAnomaly(double meanAnomaly) const {
 }
 
 glm::dvec3 KeplerTranslation::position(const UpdateData& data) const {
-    if (_orbitPlaneDirty) {
-        computeOrbitPlane();
-        _orbitPlaneDirty = false;
-    }
+    const std::shared_ptr<const Orbit> orbit = std::atomic_load(&_orbit);
 
-    const double t = data.time.j2000Seconds() - _epoch;
-    const double meanMotion = glm::two_pi<double>() / _period;
-    const double meanAnomaly = glm::radians(_meanAnomalyAtEpoch.value()) + t * meanMotion;
-    const double e = eccentricAnomaly(meanAnomaly);
+    const double t = data.time.j2000Seconds() - orbit->epoch;
+    const double meanAnomaly = orbit->meanAnomalyAtEpoch + t * orbit->meanMotion;
+    const double e = eccentricAnomaly(meanAnomaly, orbit->eccentricity);
 
     // Use the eccentric anomaly to compute the actual location
+    const double ecc = orbit->eccentricity;
     const glm::dvec3 p = {
-        _semiMajorAxis * 1000.0 * (cos(e) - _eccentricity),
-        _semiMajorAxis * 1000.0 * sin(e) * sqrt(1.0 - _eccentricity * _eccentricity),
+        orbit->semiMajorAxis * (cos(e) - ecc),
+        orbit->semiMajorAxis * sin(e) * sqrt(1.0 - ecc * ecc),
         0.0
     };
-    return _orbitPlaneRotation * p;
+    return orbit->planeRotation * p;
 }
 
-void KeplerTranslation::computeOrbitPlane() const {
+void KeplerTranslation::updateOrbit() {
     // We assume the following coordinate system:
     // z = axis of rotation
     // x = pointing towards the first point of Aries
@@ -288,12 +299,16 @@ void KeplerTranslation::computeOrbitPlane() const {
     const double inc = glm::radians(_inclination.value());
     const double per = glm::radians(_argumentOfPeriapsis.value());
 
-    _orbitPlaneRotation = glm::rotate(asc, glm::dvec3(ascendingNodeAxisRot)) *
-                          glm::rotate(inc, glm::dvec3(inclinationAxisRot)) *
-                          glm::rotate(per, glm::dvec3(argPeriapsisAxisRot));
-
-    notifyObservers();
-    _orbitPlaneDirty = false;
+    auto orbit = std::make_shared<Orbit>();
+    orbit->eccentricity = _eccentricity;
+    orbit->semiMajorAxis = _semiMajorAxis * 1000.0;
+    orbit->meanAnomalyAtEpoch = glm::radians(_meanAnomalyAtEpoch.value());
+    orbit->epoch = _epoch;
+    orbit->meanMotion = glm::two_pi<double>() / _period;
+    orbit->planeRotation = glm::rotate(asc, glm::dvec3(ascendingNodeAxisRot)) *
+                           glm::rotate(inc, glm::dvec3(inclinationAxisRot)) *
+                           glm::rotate(per, glm::dvec3(argPeriapsisAxisRot));
+    std::atomic_store(&_orbit, std::shared_ptr<const Orbit>(std::move(orbit)));
 }
 
 void KeplerTranslation::setKeplerElements(double eccentricity, double semiMajorAxis,
@@ -363,7 +378,12 @@ void KeplerTranslation::setKeplerElements(double eccentricity, double semiMajorA
     _period = orbitalPeriod;
     _epoch = epoch;
 
-    computeOrbitPlane();
+    updateOrbit();
+    notifyObservers();
+}
+
+bool KeplerTranslation::isThreadSafe() const {
+    return true;
 }
 
 } // namespace openspace
@@ -32,6 +32,7 @@
 #include <ghoul/glm.h>
 #include <ghoul/misc/exception.h>
 #include <openspace/util/time.h>
+#include <memory>
 
 namespace openspace {
 
@@ -70,6 +71,12 @@ public:
     */
     glm::dvec3 position(const UpdateData& data) const override;
 
+    /**
+     * The position only depends on the Keplerian elements of this translation, which are
+     * not modified by the position method
+     */
+    bool isThreadSafe() const override;
+
     /**
      * Method returning the openspace::Documentation that describes the ghoul::Dictinoary
      * that can be passed to the constructor.
@@ -124,10 +131,25 @@ public:
     /// Default construct that initializes all the properties and member variables
     KeplerTranslation();
 
-    /// Recombutes the rotation matrix used in the update method
-    void computeOrbitPlane() const;
-
 private:
+    /// The Keplerian elements in the units in which they are used by the position method
+    struct Orbit {
+        double eccentricity = 0.0;
+        /// The semi-major axis in meters
+        double semiMajorAxis = 0.0;
+        /// The mean anomaly at the epoch in radians
+        double meanAnomalyAtEpoch = 0.0;
+        /// The epoch in seconds relative to the J2000 epoch
+        double epoch = 0.0;
+        /// The mean motion in radians per second
+        double meanMotion = 0.0;
+        /// The rotation matrix that defines the plane of the orbit
+        glm::dmat3 planeRotation = glm::dmat3(1.0);
+    };
+
+    /// Recomputes the Orbit used in the position method from the current properties
+    void updateOrbit();
+
     /**
      * This method computes the eccentric anomaly (location of the space craft taking the
      * eccentricity into acount) based on the mean anomaly (location of the space craft
@@ -135,9 +157,10 @@ private:
      *
      * \param meanAnomaly The mean anomaly for which the eccentric anomaly shall be
      *        computed
+     * \param eccentricity The eccentricity of the orbit
      * \return The eccentric anomaly for the provided \p meanAnomaly
      */
-    double eccentricAnomaly(double meanAnomaly) const;
+    static double eccentricAnomaly(double meanAnomaly, double eccentricity);
 
     /// The eccentricity of the orbit in [0, 1)
     properties::DoubleProperty _eccentricity;
@@ -157,10 +180,10 @@ private:
     /// The period of the orbit in seconds
     properties::DoubleProperty _period;
 
-    /// Dirty flag for the _orbitPlaneRotation parameters
-    mutable bool _orbitPlaneDirty = true;
-    /// The rotation matrix that defines the plane of the orbit
-    mutable glm::dmat3 _orbitPlaneRotation = glm::dmat3(1.0);
+    /// The orbit that is computed from the properties above. It is replaced as a whole
+    /// whenever a property changes, as the position method might be called concurrently
+    /// by a TrailSampler; only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<const Orbit> _orbit;
 
     /// The cached position for the last time with which the update method was called
     glm::dvec3 _position = glm::dvec3(0.0);
@@ -26,6 +26,7 @@
 
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/util/ephemeriscache.h>
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/time.h>
 #include <openspace/util/updatestructures.h>
@@ -33,6 +34,7 @@
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
+#include <memory>
 #include <optional>
 
 namespace {
@@ -76,6 +78,16 @@ namespace {
         // A single kernel or list of kernels that this SpiceTranslation depends on. All
         // provided kernels will be loaded before any other operation is performed
         std::optional<std::variant<std::vector<std::string>, std::string>> kernels;
+
+        // If this value is 'true', the position is evaluated from piecewise polynomials
+        // that are fitted to the SPICE kernels on demand instead of querying SPICE in
+        // every frame. This also allows the translation to be updated on multiple
+        // threads. Defaults to 'false'
+        std::optional<bool> useEphemerisCache;
+
+        // The maximum distance in meters between a position computed from the
+        // ephemeris cache and the position provided by SPICE. Defaults to 1 meter
+        std::optional<double> ephemerisCacheTolerance [[codegen::greater(0.0)]];
     };
 #include "spicetranslation_codegen.cpp"
 } // namespace
@@ -122,8 +134,14 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
         }
     }
 
+    _useEphemerisCache = p.useEphemerisCache.value_or(_useEphemerisCache);
+    _ephemerisCacheTolerance =
+        p.ephemerisCacheTolerance.value_or(_ephemerisCacheTolerance);
+
     _target.onChange([this]() {
         _cachedTarget = _target;
+        _handleGeneration = std::nullopt;
+        createEphemerisCache();
         requireUpdate();
         notifyObservers();
     });
@@ -131,6 +149,8 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
 
     _observer.onChange([this]() {
         _cachedObserver = _observer;
+        _handleGeneration = std::nullopt;
+        createEphemerisCache();
         requireUpdate();
         notifyObservers();
     });
@@ -138,6 +158,8 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
 
     _frame.onChange([this]() {
         _cachedFrame = _frame;
+        _handleGeneration = std::nullopt;
+        createEphemerisCache();
         requireUpdate();
         notifyObservers();
     });
@@ -148,16 +170,59 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
     _frame = p.frame.value_or(_frame);
 }
 
+SpiceTranslation::~SpiceTranslation() {} // NOLINT
+
+void SpiceTranslation::createEphemerisCache() {
+    if (!_useEphemerisCache) {
+        return;
+    }
+
+    // The cache works in km, which is the unit returned by SPICE. Threads that are still
+    // sampling the previous cache keep it alive until they are done with it
+    std::atomic_store(
+        &_ephemerisCache,
+        std::make_shared<PositionEphemerisCache>(
+            _cachedTarget,
+            _cachedObserver,
+            _cachedFrame,
+            _ephemerisCacheTolerance / 1000.0
+        )
+    );
+}
+
+void SpiceTranslation::resolveHandles() const {
+    const unsigned long long generation = SpiceManager::kernelGeneration();
+    if (_handleGeneration == generation) {
+        return;
+    }
+
+    _targetHandle = SpiceManager::ref().bodyHandle(_cachedTarget);
+    _observerHandle = SpiceManager::ref().bodyHandle(_cachedObserver);
+    _frameHandle = SpiceManager::ref().frameHandle(_cachedFrame);
+    _handleGeneration = generation;
+}
+
 glm::dvec3 SpiceTranslation::position(const UpdateData& data) const {
+    const std::shared_ptr<PositionEphemerisCache> cache =
+        std::atomic_load(&_ephemerisCache);
+    if (cache) {
+        return cache->position(data.time.j2000Seconds()) * 1000.0;
+    }
+
+    resolveHandles();
     double lightTime = 0.0;
     return SpiceManager::ref().targetPosition(
-        _cachedTarget,
-        _cachedObserver,
-        _cachedFrame,
+        _targetHandle,
+        _observerHandle,
+        _frameHandle,
         {},
         data.time.j2000Seconds(),
         lightTime
     ) * 1000.0;
 }
 
+bool SpiceTranslation::isThreadSafe() const {
+    return std::atomic_load(&_ephemerisCache) != nullptr;
+}
+
 } // namespace openspace
@@ -28,18 +28,30 @@
 #include <openspace/scene/translation.h>
 
 #include <openspace/properties/stringproperty.h>
+#include <openspace/util/spicemanager.h>
+#include <memory>
+#include <optional>
 
 namespace openspace {
 
+class PositionEphemerisCache;
+
 class SpiceTranslation : public Translation {
 public:
     SpiceTranslation(const ghoul::Dictionary& dictionary);
+    ~SpiceTranslation();
 
     glm::dvec3 position(const UpdateData& data) const override;
 
+    /// The position can only be computed concurrently if the ephemeris cache is used
+    bool isThreadSafe() const override;
+
     static documentation::Documentation Documentation();
 
 private:
+    void createEphemerisCache();
+    void resolveHandles() const;
+
     properties::StringProperty _target;
     properties::StringProperty _observer;
     properties::StringProperty _frame;
@@ -52,6 +64,20 @@ private:
     std::string _cachedObserver;
     std::string _cachedFrame;
 
+    // The handles are resolved on first use and again whenever kernels are loaded or
+    // unloaded, as kernels can define new names for bodies and frames
+    mutable SpiceManager::BodyHandle _targetHandle;
+    mutable SpiceManager::BodyHandle _observerHandle;
+    mutable SpiceManager::FrameHandle _frameHandle;
+    mutable std::optional<unsigned long long> _handleGeneration;
+
+    bool _useEphemerisCache = false;
+    double _ephemerisCacheTolerance = 1.0;
+    // The cache is replaced when the target, observer, or frame changes, while threads
+    // that sample the translation might still be using the previous one. It is therefore
+    // only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<PositionEphemerisCache> _ephemerisCache;
+
     glm::dvec3 _position = glm::dvec3(0.0);
 };
 
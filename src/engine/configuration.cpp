@@ -84,6 +84,9 @@ namespace {
     constexpr const char* KeyVersionCheckUrl = "VersionCheckUrl";
     constexpr const char* KeyUseMultithreadedInitialization =
                                                          "UseMultithreadedInitialization";
+    constexpr const char* KeyUseDeltaSyncEncoding = "UseDeltaSyncEncoding";
+    constexpr const char* KeyUseParallelSceneUpdate = "UseParallelSceneUpdate";
+    constexpr const char* KeyEphemerisCacheMemory = "EphemerisCacheMemory";
     constexpr const char* KeyLoadingScreen = "LoadingScreen";
     constexpr const char* KeyShowMessage = "ShowMessage";
     constexpr const char* KeyShowNodeNames = "ShowNodeNames";
@@ -326,6 +329,9 @@ void parseLuaState(Configuration& configuration) {
     getValue(s, KeyScriptLog, c.scriptLog);
     getValue(s, KeyVersionCheckUrl, c.versionCheckUrl);
     getValue(s, KeyUseMultithreadedInitialization, c.useMultithreadedInitialization);
+    getValue(s, KeyUseDeltaSyncEncoding, c.useDeltaSyncEncoding);
+    getValue(s, KeyUseParallelSceneUpdate, c.useParallelSceneUpdate);
+    getValue(s, KeyEphemerisCacheMemory, c.ephemerisCacheMemory);
     getValue(s, KeyCheckOpenGLState, c.isCheckingOpenGLState);
     getValue(s, KeyLogEachOpenGLCall, c.isLoggingOpenGLCalls);
     getValue(s, KeyShutdownCountdown, c.shutdownCountdown);
@@ -402,6 +402,31 @@ documentation::Documentation Configuration::Documentation = {
             "initialize in parallel. The only use for this value is to disable it for "
             "debugging support."
         },
+        {
+            KeyUseDeltaSyncEncoding,
+            new BoolVerifier,
+            Optional::Yes,
+            "If this value is enabled, the master node in a cluster only sends the "
+            "synchronized values that have changed since the previous frame instead of "
+            "all values each frame. This defaults to 'false'."
+        },
+        {
+            KeyUseParallelSceneUpdate,
+            new BoolVerifier,
+            Optional::Yes,
+            "If this value is enabled, the transformations of scene graph nodes that do "
+            "not depend on each other are updated on multiple threads. Only nodes whose "
+            "translation, rotation, and scale are thread-safe are affected. This "
+            "defaults to 'false'."
+        },
+        {
+            KeyEphemerisCacheMemory,
+            new IntGreaterEqualVerifier(0),
+            Optional::Yes,
+            "The amount of memory in MB that is used by all SpiceTranslations and "
+            "SpiceRotations that cache the values provided by SPICE. This defaults to "
+            "64 MB."
+        },
         {
             KeyLoadingScreen,
             new TableVerifier({
@@ -61,6 +61,7 @@
 #include <openspace/scripting/scriptscheduler.h>
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/util/camera.h>
+#include <openspace/util/ephemeriscache.h>
 #include <openspace/util/factorymanager.h>
 #include <openspace/util/memorymanager.h>
 #include <openspace/util/spicemanager.h>
@@ -271,6 +272,10 @@ void OpenSpaceEngine::initialize() {
     LINFOC("OpenSpace Version", std::string(OPENSPACE_VERSION_STRING_FULL));
     LINFOC("Commit", std::string(OPENSPACE_GIT_FULL));
 
+    EphemerisCache::setMemoryBudget(
+        static_cast<size_t>(global::configuration->ephemerisCacheMemory) * 1024 * 1024
+    );
+
     // Register modules
     global::moduleEngine->initialize(global::configuration->moduleConfigurations);
 
@@ -720,6 +725,7 @@ void OpenSpaceEngine::loadSingleAsset(const std::string& assetPath) {
     }
 
     _scene = std::make_unique<Scene>(std::move(sceneInitializer));
+    _scene->setParallelUpdate(global::configuration->useParallelSceneUpdate);
     global::renderEngine->setScene(_scene.get());
 
     global::rootPropertyOwner->addPropertySubOwner(_scene.get());
@@ -839,6 +845,9 @@ void OpenSpaceEngine::loadSingleAsset(const std::string& assetPath) {
 
     global::renderEngine->updateScene();
 
+    global::syncEngine->setDeltaEncodingEnabled(
+        global::configuration->useDeltaSyncEncoding
+    );
     global::syncEngine->addSyncables(global::timeManager->getSyncables());
     if (_scene && _scene->camera()) {
         global::syncEngine->addSyncables(_scene->camera()->getSyncables());
@@ -1490,17 +1499,16 @@ void OpenSpaceEngine::handleDragDrop(const std::string& file) {
     );
 }
 
-std::vector<std::byte> OpenSpaceEngine::encode() {
+SyncBufferView OpenSpaceEngine::encode() {
     ZoneScoped
 
-    std::vector<std::byte> buffer = global::syncEngine->encodeSyncables();
-    return buffer;
+    return global::syncEngine->encodeSyncables();
 }
 
-void OpenSpaceEngine::decode(std::vector<std::byte> data) {
+void OpenSpaceEngine::decode(SyncBufferView data) {
     ZoneScoped
 
-    global::syncEngine->decodeSyncables(std::move(data));
+    global::syncEngine->decodeSyncables(data);
 }
 
 void OpenSpaceEngine::toggleShutdownMode() {
@@ -37,27 +37,95 @@ SyncEngine::SyncEngine(unsigned int syncBufferSize)
     ghoul_assert(syncBufferSize > 0, "syncBufferSize must be bigger than 0");
 }
 
+namespace {
+    // Each frame starts with one byte that describes how the Syncables were encoded
+    enum class Encoding : uint8_t {
+        Full = 0,
+        Delta
+    };
+
+    // In a delta encoded frame each Syncable is preceeded by one of these flags
+    enum class DeltaFlag : uint8_t {
+        Unchanged = 0,
+        Changed
+    };
+} // namespace
+
 // Should be called on sgct master
-std::vector<std::byte> SyncEngine::encodeSyncables() {
-    for (Syncable* syncable : _syncables) {
+SyncBufferView SyncEngine::encodeSyncables() {
+    ZoneScoped
+
+    _syncBuffer.reset();
+
+    if (!_isDeltaEncodingEnabled) {
+        _syncBuffer.encode(Encoding::Full);
+        for (Syncable* syncable : _syncables) {
+            syncable->encode(&_syncBuffer);
+        }
+        return _syncBuffer.view();
+    }
+
+    _syncBuffer.encode(Encoding::Delta);
+    _previousEncodings.resize(_syncables.size());
+    for (size_t i = 0; i < _syncables.size(); ++i) {
+        Syncable* syncable = _syncables[i];
+
+        const size_t flagOffset = _syncBuffer.encodedSize();
+        _syncBuffer.encode(DeltaFlag::Changed);
+        const size_t begin = _syncBuffer.encodedSize();
         syncable->encode(&_syncBuffer);
+
+        if (!syncable->isDeltaEncodable()) {
+            continue;
+        }
+
+        // The view has to be requested after encoding as the buffer might have grown
+        const SyncBufferView view = _syncBuffer.view();
+        const std::byte* first = view.data + begin;
+        const std::byte* last = view.data + view.size;
+        std::vector<std::byte>& previous = _previousEncodings[i];
+
+        const bool isUnchanged = !_needsFullFrame &&
+            std::equal(first, last, previous.begin(), previous.end());
+        if (isUnchanged) {
+            _syncBuffer.truncate(flagOffset);
+            _syncBuffer.encode(DeltaFlag::Unchanged);
+        }
+        else {
+            previous.assign(first, last);
+        }
     }
+    _needsFullFrame = false;
 
-    std::vector<std::byte> data = _syncBuffer.data();
-    _syncBuffer.reset();
-    return data;
+    return _syncBuffer.view();
 }
 
 // Should be called on sgct slaves
-void SyncEngine::decodeSyncables(std::vector<std::byte> data) {
-    _syncBuffer.setData(std::move(data));
+void SyncEngine::decodeSyncables(SyncBufferView data) {
+    ZoneScoped
+
+    _syncBuffer.setData(data);
+
+    const Encoding encoding = _syncBuffer.decode<Encoding>();
     for (Syncable* syncable : _syncables) {
+        if (encoding == Encoding::Delta &&
+            _syncBuffer.decode<DeltaFlag>() == DeltaFlag::Unchanged)
+        {
+            // The Syncable still holds the value that was decoded in an earlier frame
+            continue;
+        }
         syncable->decode(&_syncBuffer);
     }
+    ghoul_assert(_syncBuffer.isFullyDecoded(), "Not all synchronized data was decoded");
 
     _syncBuffer.reset();
 }
 
+void SyncEngine::setDeltaEncodingEnabled(bool enabled) {
+    _isDeltaEncodingEnabled = enabled;
+    _needsFullFrame = true;
+}
+
 void SyncEngine::preSynchronization(IsMaster isMaster) {
     ZoneScoped
 
@@ -78,6 +146,7 @@ void SyncEngine::addSyncable(Syncable* syncable) {
     ghoul_assert(syncable, "Syncable must not be nullptr");
 
     _syncables.push_back(syncable);
+    _needsFullFrame = true;
 }
 
 void SyncEngine::addSyncables(const std::vector<Syncable*>& syncables) {
@@ -92,6 +161,7 @@ void SyncEngine::removeSyncable(Syncable* syncable) {
         std::remove(_syncables.begin(), _syncables.end(), syncable),
         _syncables.end()
     );
+    _needsFullFrame = true;
 }
 
 void SyncEngine::removeSyncables(const std::vector<Syncable*>& syncables) {
@@ -26,6 +26,7 @@
 
 #include <openspace/engine/globals.h>
 #include <openspace/engine/windowdelegate.h>
+#include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scene/scene.h>
 #include <openspace/util/camera.h>
@@ -34,6 +35,7 @@
 #include <ghoul/logging/logmanager.h>
 
 #include <glm/gtx/quaternion.hpp>
+#include <algorithm>
 
 #ifdef INTERPOLATION_DEBUG_PRINT
 namespace {
@@ -181,6 +183,52 @@ bool KeyframeNavigator::updateCamera(Camera* camera, const CameraPose prevPose,
     return true;
 }
 
+std::optional<glm::dvec3> KeyframeNavigator::cameraWorldPosition(
+                                                                   const CameraPose& pose)
+{
+    Scene* scene = global::renderEngine->scene();
+    SceneGraphNode* focusNode = scene ? scene->sceneGraphNode(pose.focusNode) : nullptr;
+    if (!focusNode) {
+        return std::nullopt;
+    }
+
+    glm::dvec3 position = pose.position;
+    if (pose.followFocusNodeRotation) {
+        position = focusNode->worldRotationMatrix() * position;
+    }
+    return position + focusNode->worldPosition();
+}
+
+std::optional<glm::dvec3> KeyframeNavigator::futureCameraPosition(
+                                                               double secondsAhead) const
+{
+    // Keyframes in simulation time advance with the simulation time delta instead
+    double timeAhead = secondsAhead;
+    if (_timeframeMode == KeyframeTimeRef::Absolute_simTimeJ2000) {
+        timeAhead *= global::timeManager->deltaTime();
+    }
+    const double t = currentTime() + timeAhead;
+
+    const Keyframe<CameraPose>* next = _cameraPoseTimeline.firstKeyframeAfter(t, true);
+    if (!next) {
+        return std::nullopt;
+    }
+    const std::optional<glm::dvec3> nextPosition = cameraWorldPosition(next->data);
+
+    const Keyframe<CameraPose>* prev = _cameraPoseTimeline.lastKeyframeBefore(t, true);
+    if (!prev || !nextPosition) {
+        return nextPosition;
+    }
+    const std::optional<glm::dvec3> prevPosition = cameraWorldPosition(prev->data);
+    if (!prevPosition) {
+        return nextPosition;
+    }
+
+    const double dt = next->timestamp - prev->timestamp;
+    const double w = dt > 0.0 ? std::clamp((t - prev->timestamp) / dt, 0.0, 1.0) : 1.0;
+    return *prevPosition * (1.0 - w) + *nextPosition * w;
+}
+
 double KeyframeNavigator::currentTime() const {
     if (_timeframeMode == KeyframeTimeRef::Relative_recordedStart) {
         return (global::windowDelegate->applicationTime() - _referenceTimestamp);
@@ -47,6 +47,7 @@
 #include <ghoul/font/fontrenderer.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
+#include <algorithm>
 #include <iomanip>
 
 namespace {
@@ -742,6 +743,57 @@ bool SessionRecording::isPlayingBack() const {
     return (_state == SessionState::Playback);
 }
 
+std::optional<glm::dvec3> SessionRecording::futureCameraPosition(
+                                                               double secondsAhead) const
+{
+    if (!_playbackActive_camera || _keyframesCamera.empty() || _timeline.empty()) {
+        return std::nullopt;
+    }
+
+    // Keyframes in simulation time advance with the simulation time delta instead
+    double timeAhead = secondsAhead;
+    if (_playbackTimeReferenceMode == KeyframeTimeRef::Absolute_simTimeJ2000) {
+        timeAhead *= global::timeManager->deltaTime();
+    }
+    const double t = currentTime() + timeAhead;
+
+    // Find the camera keyframes surrounding t, starting from the current one
+    const timelineEntry* prev = nullptr;
+    const timelineEntry* next = nullptr;
+    for (size_t i = _idxTimeline_cameraPtrPrev; i < _timeline.size(); ++i) {
+        const timelineEntry& entry = _timeline[i];
+        if (entry.keyframeType != RecordedType::Camera) {
+            continue;
+        }
+        if (entry.timestamp <= t) {
+            prev = &entry;
+        }
+        if (entry.timestamp >= t) {
+            next = &entry;
+            break;
+        }
+    }
+    if (!next) {
+        return std::nullopt;
+    }
+
+    using KN = KeyframeNavigator;
+    const std::optional<glm::dvec3> nextPosition =
+        KN::cameraWorldPosition(_keyframesCamera[next->idxIntoKeyframeTypeArray]);
+    if (!prev || !nextPosition) {
+        return nextPosition;
+    }
+    const std::optional<glm::dvec3> prevPosition =
+        KN::cameraWorldPosition(_keyframesCamera[prev->idxIntoKeyframeTypeArray]);
+    if (!prevPosition) {
+        return nextPosition;
+    }
+
+    const double dt = next->timestamp - prev->timestamp;
+    const double w = dt > 0.0 ? std::clamp((t - prev->timestamp) / dt, 0.0, 1.0) : 1.0;
+    return *prevPosition * (1.0 - w) + *nextPosition * w;
+}
+
 bool SessionRecording::isSavingFramesDuringPlayback() const {
     return (_state == SessionState::Playback && _saveRenderingDuringPlayback);
 }
@@ -0,0 +1,459 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/properties/propertyindex.h>
+
+#include <openspace/properties/property.h>
+#include <openspace/properties/propertyowner.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+    // The number of patterns after which the pattern cache is cleared to prevent
+    // scripts that generate unique patterns from growing the cache indefinitely
+    constexpr const size_t MaxCachedPatterns = 1024;
+
+    struct Pattern {
+        std::string nodeName;
+        std::string propertyName;
+        bool isLiteral = false;
+        bool isGroupMode = false;
+    };
+
+    Pattern parsePattern(const std::string& regex, const std::string& groupName) {
+        Pattern pattern;
+        pattern.isGroupMode = !groupName.empty();
+
+        const size_t wildPos = regex.find_first_of('*');
+        if (wildPos != std::string::npos) {
+            pattern.nodeName = regex.substr(0, wildPos);
+            pattern.propertyName = regex.substr(wildPos + 1);
+        }
+        else {
+            pattern.propertyName = regex;
+            pattern.isLiteral = !pattern.isGroupMode;
+        }
+        return pattern;
+    }
+
+    // Checks whether the fully qualified URI matches the pattern. The group tag has to
+    // be checked separately
+    bool matches(std::string_view id, const Pattern& pattern) {
+        if (pattern.isLiteral) {
+            return id == pattern.propertyName;
+        }
+
+        if (!pattern.propertyName.empty()) {
+            const size_t propertyPos = id.find(pattern.propertyName);
+            if (propertyPos == std::string::npos) {
+                return false;
+            }
+            // Check that the propertyName fully matches the property in id
+            if ((propertyPos + pattern.propertyName.length() + 1) < id.length()) {
+                return false;
+            }
+            // Match node name
+            return pattern.nodeName.empty() ||
+                   id.find(pattern.nodeName) != std::string::npos;
+        }
+
+        if (!pattern.nodeName.empty()) {
+            const size_t nodePos = id.find(pattern.nodeName);
+            if (nodePos == std::string::npos) {
+                return false;
+            }
+            // Check that the nodeName fully matches the node in id. With a group tag,
+            // the tag takes the role of the beginning of the URI instead
+            return pattern.isGroupMode || nodePos == 0;
+        }
+
+        return true;
+    }
+
+    // Checks whether the elements that both vectors contain are in the same order
+    template <typename T, typename U>
+    bool hasSameRelativeOrder(const std::vector<T*>& lhs, const std::vector<U*>& rhs) {
+        const std::unordered_set<const void*> inLhs(lhs.begin(), lhs.end());
+        const std::unordered_set<const void*> inRhs(rhs.begin(), rhs.end());
+
+        auto l = lhs.begin();
+        auto r = rhs.begin();
+        while (true) {
+            l = std::find_if(l, lhs.end(), [&inRhs](T* t) { return inRhs.count(t) > 0; });
+            r = std::find_if(r, rhs.end(), [&inLhs](U* u) { return inLhs.count(u) > 0; });
+            if (l == lhs.end() || r == rhs.end()) {
+                return l == lhs.end() && r == rhs.end();
+            }
+            if (*l != *r) {
+                return false;
+            }
+            ++l;
+            ++r;
+        }
+    }
+} // namespace
+
+namespace openspace::properties {
+
+void PropertyIndex::setRootOwners(std::vector<const PropertyOwner*> roots) {
+    if (roots != _roots) {
+        _roots = std::move(roots);
+        _isDirty = true;
+    }
+}
+
+const std::vector<Property*>& PropertyIndex::properties() {
+    updateIfNeeded();
+    updateOrderedProperties();
+    return _properties;
+}
+
+Property* PropertyIndex::property(const std::string& uri) {
+    updateIfNeeded();
+    auto it = _propertiesByUri.find(uri);
+    return it != _propertiesByUri.end() ? it->second : nullptr;
+}
+
+const std::vector<Property*>& PropertyIndex::propertiesWithTag(const std::string& tag) {
+    static const std::vector<Property*> Empty;
+
+    updateIfNeeded();
+    updateOrderedProperties();
+    auto it = _propertiesByTag.find(tag);
+    return it != _propertiesByTag.end() ? it->second.properties : Empty;
+}
+
+const std::vector<Property*>& PropertyIndex::matchingProperties(const std::string& regex,
+                                                           const std::string& groupName)
+{
+    ZoneScoped
+
+    updateIfNeeded();
+
+    // Identifiers cannot contain whitespace, so a newline cannot be part of the pattern
+    std::string key = groupName + '\n' + regex;
+    auto it = _patternCache.find(key);
+    if (it != _patternCache.end()) {
+        return it->second;
+    }
+
+    if (_patternCache.size() >= MaxCachedPatterns) {
+        _patternCache.clear();
+    }
+    std::vector<Property*> result = findMatchingProperties(regex, groupName);
+    return _patternCache.emplace(std::move(key), std::move(result)).first->second;
+}
+
+std::vector<Property*> PropertyIndex::findMatchingProperties(const std::string& regex,
+                                                             const std::string& groupName)
+{
+    ghoul_precondition(
+        std::count(regex.begin(), regex.end(), '*') <= 1,
+        "Only a single wildcard is supported"
+    );
+
+    const Pattern pattern = parsePattern(regex, groupName);
+    std::vector<Property*> result;
+
+    if (pattern.isLiteral) {
+        Property* prop = property(regex);
+        if (prop) {
+            result.push_back(prop);
+        }
+        return result;
+    }
+
+    updateOrderedProperties();
+    if (pattern.isGroupMode) {
+        // Only the tagged Propertys are candidates, which are usually only a fraction
+        auto it = _propertiesByTag.find(groupName);
+        if (it != _propertiesByTag.end()) {
+            for (size_t location : it->second.locations) {
+                if (matches(_uris[location], pattern)) {
+                    result.push_back(_properties[location]);
+                }
+            }
+        }
+    }
+    else {
+        for (size_t i = 0; i < _properties.size(); ++i) {
+            if (matches(_uris[i], pattern)) {
+                result.push_back(_properties[i]);
+            }
+        }
+    }
+    return result;
+}
+
+void PropertyIndex::updateIfNeeded() {
+    const uint64_t version = PropertyOwner::structureVersion();
+    if (!_isDirty && version == _version) {
+        return;
+    }
+
+    ZoneScoped
+
+    if (_isDirty) {
+        // The roots have changed, so nothing from the previous index can be reused
+        _owners.clear();
+        _propertiesByUri.clear();
+        _patternCache.clear();
+        _isOrderDirty = true;
+    }
+
+    for (const PropertyOwner* root : _roots) {
+        if (!root) {
+            continue;
+        }
+
+        // The root might itself be owned by other PropertyOwners whose identifiers are
+        // part of the fully qualified URI, but whose tags do not apply to the root
+        std::string prefix;
+        for (const PropertyOwner* o = root; o; o = o->owner()) {
+            if (!o->identifier().empty()) {
+                prefix = o->identifier() + PropertyOwner::URISeparator + prefix;
+            }
+        }
+        updateOwner(*root, nullptr, std::move(prefix), {}, false);
+    }
+    invalidatePatternCache();
+
+    _version = version;
+    _isDirty = false;
+}
+
+void PropertyIndex::updateOwner(const PropertyOwner& owner, const PropertyOwner* parent,
+                                std::string uriPrefix,
+                                const std::vector<std::string>& inheritedTags,
+                                bool isForced)
+{
+    auto it = _owners.find(&owner);
+    if (it != _owners.end() && it->second.parent != parent) {
+        // The owner has been moved to a different parent since it was indexed
+        removeOwner(&owner, it->second.parent);
+        it = _owners.end();
+    }
+    const bool isNew = (it == _owners.end());
+    OwnerEntry& entry = isNew ? _owners[&owner] : it->second;
+    entry.parent = parent;
+
+    std::vector<std::string> tags = inheritedTags;
+    for (const std::string& tag : owner.tags()) {
+        // Owners might share a tag, but each Property is only listed once per tag
+        if (std::find(tags.begin(), tags.end(), tag) == tags.end()) {
+            tags.push_back(tag);
+        }
+    }
+
+    // A changed URI prefix or changed tags apply to all Propertys in the subtree
+    const bool isChanged =
+        isForced || isNew || entry.uriPrefix != uriPrefix || entry.tags != tags;
+    const std::vector<Property*>& properties = owner.properties();
+    if (isChanged || entry.properties != properties) {
+        // Unless the URI prefix, the tags, or the order have changed, only the URIs of
+        // the added and removed Propertys count as changes for the pattern cache
+        const bool isReordered = !hasSameRelativeOrder(entry.properties, properties);
+        std::unordered_set<const Property*> previous;
+        std::unordered_set<const Property*> current;
+        if (!isChanged) {
+            previous.insert(entry.properties.begin(), entry.properties.end());
+            current.insert(properties.begin(), properties.end());
+        }
+
+        // The URIs are only referenced by _propertiesByUri once the vector is complete,
+        // as growing it might move the characters of short strings
+        std::vector<std::string> uris;
+        uris.reserve(properties.size());
+        for (Property* prop : properties) {
+            uris.push_back(uriPrefix + prop->identifier());
+        }
+
+        for (size_t i = 0; i < entry.properties.size(); ++i) {
+            const bool isRemoved = current.find(entry.properties[i]) == current.end();
+            removeUri(entry.uris[i], entry.properties[i], isReordered || isRemoved);
+        }
+        entry.uris = std::move(uris);
+        for (size_t i = 0; i < properties.size(); ++i) {
+            const bool isAdded = previous.find(properties[i]) == previous.end();
+            addUri(entry.uris[i], properties[i], isReordered || isAdded);
+        }
+
+        entry.uriPrefix = std::move(uriPrefix);
+        entry.tags = std::move(tags);
+        entry.properties = properties;
+    }
+
+    const std::vector<PropertyOwner*>& subOwners = owner.propertySubOwners();
+    if (!std::equal(
+            entry.subOwners.begin(), entry.subOwners.end(),
+            subOwners.begin(), subOwners.end()
+        ))
+    {
+        const std::unordered_set<const PropertyOwner*> current(
+            subOwners.begin(),
+            subOwners.end()
+        );
+        for (const PropertyOwner* subOwner : entry.subOwners) {
+            if (current.find(subOwner) == current.end()) {
+                removeOwner(subOwner, &owner);
+            }
+        }
+        if (!hasSameRelativeOrder(entry.subOwners, subOwners)) {
+            // The cached results would no longer be in the same order as the Propertys
+            _patternCache.clear();
+        }
+        entry.subOwners.assign(subOwners.begin(), subOwners.end());
+        _isOrderDirty = true;
+    }
+
+    std::string subOwnerPrefix;
+    for (const PropertyOwner* subOwner : subOwners) {
+        if (!isChanged) {
+            // Subtrees that have not changed since the last update can be skipped
+            auto sub = _owners.find(subOwner);
+            if (sub != _owners.end() && sub->second.parent == &owner &&
+                subOwner->subtreeVersion() <= _version)
+            {
+                continue;
+            }
+        }
+
+        // Owners without an identifier do not contribute to the fully qualified URI
+        subOwnerPrefix = entry.uriPrefix;
+        if (!subOwner->identifier().empty()) {
+            subOwnerPrefix += subOwner->identifier();
+            subOwnerPrefix += PropertyOwner::URISeparator;
+        }
+        updateOwner(*subOwner, &owner, subOwnerPrefix, entry.tags, isChanged);
+    }
+}
+
+void PropertyIndex::removeOwner(const PropertyOwner* owner, const PropertyOwner* parent) {
+    auto it = _owners.find(owner);
+    if (it == _owners.end() || it->second.parent != parent) {
+        return;
+    }
+
+    const OwnerEntry& entry = it->second;
+    for (size_t i = 0; i < entry.properties.size(); ++i) {
+        removeUri(entry.uris[i], entry.properties[i], true);
+    }
+    for (const PropertyOwner* subOwner : entry.subOwners) {
+        removeOwner(subOwner, owner);
+    }
+    _owners.erase(owner);
+}
+
+void PropertyIndex::addUri(const std::string& uri, Property* prop, bool isChanged) {
+    // If another Property had the same URI, its key would point into an OwnerEntry that
+    // is about to change, so the key is replaced, too
+    auto it = _propertiesByUri.find(uri);
+    if (it != _propertiesByUri.end()) {
+        _propertiesByUri.erase(it);
+    }
+    _propertiesByUri.emplace(uri, prop);
+    _isOrderDirty = true;
+
+    if (isChanged && !_patternCache.empty()) {
+        _changedUris.push_back(uri);
+    }
+}
+
+void PropertyIndex::removeUri(const std::string& uri, Property* prop, bool isChanged) {
+    auto it = _propertiesByUri.find(uri);
+    if (it != _propertiesByUri.end() && it->second == prop) {
+        _propertiesByUri.erase(it);
+    }
+    _isOrderDirty = true;
+
+    if (isChanged && !_patternCache.empty()) {
+        _changedUris.push_back(uri);
+    }
+}
+
+void PropertyIndex::invalidatePatternCache() {
+    if (_changedUris.empty()) {
+        return;
+    }
+
+    for (auto it = _patternCache.begin(); it != _patternCache.end();) {
+        const size_t separator = it->first.find('\n');
+        const Pattern pattern = parsePattern(
+            it->first.substr(separator + 1),
+            it->first.substr(0, separator)
+        );
+
+        // Changed tags cause the affected URIs to be removed and added again, so checking
+        // only the URIs is sufficient to also catch changed group memberships
+        const bool isAffected = std::any_of(
+            _changedUris.begin(),
+            _changedUris.end(),
+            [&pattern](const std::string& uri) { return matches(uri, pattern); }
+        );
+        it = isAffected ? _patternCache.erase(it) : std::next(it);
+    }
+    _changedUris.clear();
+}
+
+void PropertyIndex::updateOrderedProperties() {
+    if (!_isOrderDirty) {
+        return;
+    }
+
+    ZoneScoped
+
+    _properties.clear();
+    _uris.clear();
+    _propertiesByTag.clear();
+    for (const PropertyOwner* root : _roots) {
+        addOrderedProperties(root);
+    }
+    _isOrderDirty = false;
+}
+
+void PropertyIndex::addOrderedProperties(const PropertyOwner* owner) {
+    auto it = _owners.find(owner);
+    if (it == _owners.end()) {
+        return;
+    }
+
+    const OwnerEntry& entry = it->second;
+    for (size_t i = 0; i < entry.properties.size(); ++i) {
+        for (const std::string& tag : entry.tags) {
+            TaggedProperties& tagged = _propertiesByTag[tag];
+            tagged.properties.push_back(entry.properties[i]);
+            tagged.locations.push_back(_properties.size());
+        }
+        _properties.push_back(entry.properties[i]);
+        _uris.push_back(entry.uris[i]);
+    }
+
+    for (const PropertyOwner* subOwner : entry.subOwners) {
+        addOrderedProperties(subOwner);
+    }
+}
+
+} // namespace openspace::properties
@@ -31,11 +31,20 @@
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/invariants.h>
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 
 namespace {
     constexpr const char* _loggerCat = "PropertyOwner";
 
+    // Incremented on every change to the property tree. Owners might be modified from
+    // the threads of the MultiThreadedSceneInitializer, so this has to be atomic
+    std::atomic<uint64_t> StructureVersion = 0;
+
+    uint64_t incrementStructureVersion() {
+        return StructureVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
     std::string escapedJson(const std::string& text) {
         std::string jsonString;
         for (const char& c : text) {
@@ -174,6 +183,9 @@ PropertyOwner::PropertyOwner(PropertyOwnerInfo info)
 PropertyOwner::~PropertyOwner() {
     _properties.clear();
     _subOwners.clear();
+    // The owners of this PropertyOwner might have been destroyed already, so only the
+    // global version can be changed here
+    incrementStructureVersion();
 }
 
 const std::vector<Property*>& PropertyOwner::properties() const {
@@ -191,41 +203,33 @@ std::vector<Property*> PropertyOwner::propertiesRecursive() const {
     return props;
 }
 
-Property* PropertyOwner::property(const std::string& uri) const {
-    auto it = std::find_if(
-        _properties.begin(),
-        _properties.end(),
-        [&uri](Property* prop) { return prop->identifier() == uri; }
-    );
+Property* PropertyOwner::property(std::string_view uri) const {
+    const PropertyOwner* owner = this;
+    while (owner) {
+        auto it = std::find_if(
+            owner->_properties.begin(),
+            owner->_properties.end(),
+            [uri](Property* prop) { return prop->identifier() == uri; }
+        );
+        if (it != owner->_properties.end()) {
+            return *it;
+        }
 
-    if (it == _properties.end() || (*it)->identifier() != uri) {
         // if we do not own the searched property, it must consist of a concatenated
         // name and we can delegate it to a subowner
         const size_t ownerSeparator = uri.find(URISeparator);
-        if (ownerSeparator == std::string::npos) {
+        if (ownerSeparator == std::string_view::npos) {
             // if we do not own the property and there is no separator, it does not exist
             return nullptr;
         }
-        else {
-            const std::string ownerName = uri.substr(0, ownerSeparator);
-            const std::string propertyName = uri.substr(ownerSeparator + 1);
 
-            PropertyOwner* owner = propertySubOwner(ownerName);
-            if (!owner) {
-                return nullptr;
-            }
-            else {
-                // Recurse into the subOwner
-                return owner->property(propertyName);
-            }
-        }
-    }
-    else {
-        return *it;
+        owner = owner->propertySubOwner(uri.substr(0, ownerSeparator));
+        uri.remove_prefix(ownerSeparator + 1);
     }
+    return nullptr;
 }
 
-bool PropertyOwner::hasProperty(const std::string& uri) const {
+bool PropertyOwner::hasProperty(std::string_view uri) const {
     return property(uri) != nullptr;
 }
 
@@ -239,26 +243,25 @@ bool PropertyOwner::hasProperty(const Property* prop) const {
     return it != _properties.end();
 }
 
+void PropertyOwner::setPropertyOwner(PropertyOwner* owner) {
+    _owner = owner;
+    markStructureChanged();
+}
+
 const std::vector<PropertyOwner*>& PropertyOwner::propertySubOwners() const {
     return _subOwners;
 }
 
-PropertyOwner* PropertyOwner::propertySubOwner(const std::string& identifier) const {
+PropertyOwner* PropertyOwner::propertySubOwner(std::string_view identifier) const {
     std::vector<PropertyOwner*>::const_iterator it = std::find_if(
         _subOwners.begin(),
         _subOwners.end(),
-        [&identifier](PropertyOwner* owner) { return owner->identifier() == identifier; }
+        [identifier](PropertyOwner* owner) { return owner->identifier() == identifier; }
     );
-
-    if (it == _subOwners.end() || (*it)->identifier() != identifier) {
-        return nullptr;
-    }
-    else {
-        return *it;
-    }
+    return it != _subOwners.end() ? *it : nullptr;
 }
 
-bool PropertyOwner::hasPropertySubOwner(const std::string& identifier) const {
+bool PropertyOwner::hasPropertySubOwner(std::string_view identifier) const {
     return propertySubOwner(identifier) != nullptr;
 }
 
@@ -312,6 +315,7 @@ void PropertyOwner::addProperty(Property* prop) {
         else {
             _properties.push_back(prop);
             prop->setPropertyOwner(this);
+            markStructureChanged();
         }
     }
 }
@@ -357,6 +361,7 @@ void PropertyOwner::addPropertySubOwner(openspace::properties::PropertyOwner* ow
         else {
             _subOwners.push_back(owner);
             owner->setPropertyOwner(this);
+            markStructureChanged();
         }
     }
 }
@@ -379,6 +384,7 @@ void PropertyOwner::removeProperty(Property* prop) {
     if (it != _properties.end() && (*it)->identifier() == prop->identifier()) {
         (*it)->setPropertyOwner(nullptr);
         _properties.erase(it);
+        markStructureChanged();
     }
     else {
         LERROR(fmt::format(
@@ -406,6 +412,7 @@ void PropertyOwner::removePropertySubOwner(openspace::properties::PropertyOwner*
     // If we found the propertyowner, we can delete it
     if (it != _subOwners.end() && (*it)->identifier() == owner->identifier()) {
         _subOwners.erase(it);
+        markStructureChanged();
     }
     else {
         LERROR(fmt::format(
@@ -429,6 +436,7 @@ void PropertyOwner::setIdentifier(std::string identifier) {
     );
 
     _identifier = std::move(identifier);
+    markStructureChanged();
 }
 
 const std::string& PropertyOwner::identifier() const {
@@ -457,10 +465,30 @@ const std::vector<std::string>& PropertyOwner::tags() const {
 
 void PropertyOwner::addTag(std::string tag) {
     _tags.push_back(std::move(tag));
+    markStructureChanged();
 }
 
 void PropertyOwner::removeTag(const std::string& tag) {
     _tags.erase(std::remove(_tags.begin(), _tags.end(), tag), _tags.end());
+    markStructureChanged();
+}
+
+uint64_t PropertyOwner::structureVersion() {
+    return StructureVersion.load(std::memory_order_relaxed);
+}
+
+uint64_t PropertyOwner::subtreeVersion() const {
+    return _subtreeVersion.load(std::memory_order_relaxed);
+}
+
+void PropertyOwner::markStructureChanged() {
+    const uint64_t version = incrementStructureVersion();
+    for (PropertyOwner* owner = this; owner; owner = owner->_owner) {
+        // Another thread might have stored a newer version in the meantime
+        std::atomic<uint64_t>& subtreeVersion = owner->_subtreeVersion;
+        uint64_t v = subtreeVersion.load(std::memory_order_relaxed);
+        while (v < version && !subtreeVersion.compare_exchange_weak(v, version)) {}
+    }
 }
 
 std::string PropertyOwner::generateJson() const {
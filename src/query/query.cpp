@@ -26,6 +26,8 @@
 
 #include <openspace/engine/globals.h>
 #include <openspace/engine/virtualpropertymanager.h>
+#include <openspace/properties/propertyindex.h>
+#include <openspace/properties/propertyowner.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scene.h>
 
@@ -52,26 +54,23 @@ const Renderable* renderable(const std::string& name) {
 }
 
 properties::Property* property(const std::string& uri) {
-    properties::Property* property = global::rootPropertyOwner->property(uri);
-    return property;
+    // A single URI is resolved by walking the owner hierarchy, which does not depend on
+    // the PropertyIndex being rebuilt after the property tree has changed. The index is
+    // only used for queries that have to look at many Propertys, such as wildcards
+    return global::rootPropertyOwner->property(uri);
 }
 
 std::vector<properties::Property*> allProperties() {
-    std::vector<properties::Property*> properties;
-
-    std::vector<properties::Property*> p =
-        global::rootPropertyOwner->propertiesRecursive();
+    return propertyIndex().properties();
+}
 
-    properties.insert(properties.end(), p.begin(), p.end());
+properties::PropertyIndex& propertyIndex() {
+    static properties::PropertyIndex index;
 
     // The virtual property manager is not part of the rootProperty owner since it cannot
     // have an identifier or the "regex as identifier" trick would not work
-    std::vector<properties::Property*> p2 =
-        global::virtualPropertyManager->propertiesRecursive();
-
-    properties.insert(properties.end(), p2.begin(), p2.end());
-
-    return properties;
+    index.setRootOwners({ global::rootPropertyOwner, global::virtualPropertyManager });
+    return index;
 }
 
 }  // namespace
@@ -94,6 +94,10 @@ const glm::dmat3& Rotation::matrix() const {
     return _cachedMatrix;
 }
 
+bool Rotation::isThreadSafe() const {
+    return false;
+}
+
 void Rotation::update(const UpdateData& data) {
     if (!_needsUpdate && (data.time.j2000Seconds() == _cachedTime)) {
         return;
@@ -91,6 +91,10 @@ glm::dvec3 Scale::scaleValue() const {
     return _cachedScale;
 }
 
+bool Scale::isThreadSafe() const {
+    return false;
+}
+
 void Scale::update(const UpdateData& data) {
     if (!_needsUpdate && data.time.j2000Seconds() == _cachedTime) {
         return;
@@ -34,10 +34,12 @@
 #include <openspace/scene/sceneinitializer.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/camera.h>
+#include <openspace/util/threadpool.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
+#include <algorithm>
 #include <string>
 #include <stack>
 
@@ -48,6 +50,10 @@ namespace {
     constexpr const char* KeyIdentifier = "Identifier";
     constexpr const char* KeyParent = "Parent";
 
+    // The number of nodes whose transformations are updated by one task when the scene is
+    // updated in parallel. Levels with fewer nodes are updated on the calling thread
+    constexpr const size_t ParallelUpdateGrainSize = 16;
+
 #ifdef TRACY_ENABLE
     constexpr const char* renderBinToString(int renderBin) {
         // Synced with Renderable::RenderBin
@@ -222,6 +228,34 @@ void Scene::sortTopologically() {
     }
 
     _topologicallySortedNodes = nodes;
+    computeUpdateLevels();
+}
+
+void Scene::computeUpdateLevels() {
+    _updateLevels.clear();
+
+    std::unordered_map<const SceneGraphNode*, size_t> levels;
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        // As the nodes are sorted, the parent and dependencies already have their level
+        size_t level = 0;
+        if (node->parent()) {
+            level = levels[node->parent()] + 1;
+        }
+        for (const SceneGraphNode* dependency : node->dependencies()) {
+            level = std::max(level, levels[dependency] + 1);
+        }
+        levels[node] = level;
+
+        if (level >= _updateLevels.size()) {
+            _updateLevels.resize(level + 1);
+        }
+        if (node->hasThreadSafeTransform()) {
+            _updateLevels[level].concurrentNodes.push_back(node);
+        }
+        else {
+            _updateLevels[level].serialNodes.push_back(node);
+        }
+    }
 }
 
 void Scene::initializeNode(SceneGraphNode* node) {
@@ -316,6 +350,12 @@ void Scene::update(const UpdateData& data) {
     if (_dirtyNodeRegistry) {
         updateNodeRegistry();
     }
+
+    if (_useParallelUpdate) {
+        updateParallel(data);
+        return;
+    }
+
     for (SceneGraphNode* node : _topologicallySortedNodes) {
         try {
             node->update(data);
@@ -326,6 +366,58 @@ void Scene::update(const UpdateData& data) {
     }
 }
 
+void Scene::updateParallel(const UpdateData& data) {
+    ZoneScoped
+
+    auto updateTransform = [&data](SceneGraphNode* node) {
+        try {
+            node->updateTransform(data);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.what());
+        }
+    };
+
+    // All nodes in one level only depend on nodes in previous levels, so each level can
+    // be processed concurrently once the previous level has finished
+    for (const UpdateLevel& level : _updateLevels) {
+        for (SceneGraphNode* node : level.serialNodes) {
+            updateTransform(node);
+        }
+
+        const std::vector<SceneGraphNode*>& nodes = level.concurrentNodes;
+        if (nodes.size() <= ParallelUpdateGrainSize) {
+            for (SceneGraphNode* node : nodes) {
+                updateTransform(node);
+            }
+        }
+        else {
+            ThreadPool::shared().parallelFor(
+                0,
+                nodes.size(),
+                [&](size_t i) { updateTransform(nodes[i]); },
+                ParallelUpdateGrainSize
+            );
+        }
+    }
+
+    // Renderables might use OpenGL or other non thread-safe resources in their update.
+    // Unlike the serial update, all transformations are up to date at this point, so
+    // Renderables that read the transformation of a later node do not lag a frame behind
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        try {
+            node->updateRenderable(data);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.what());
+        }
+    }
+}
+
+void Scene::setParallelUpdate(bool enabled) {
+    _useParallelUpdate = enabled;
+}
+
 void Scene::render(const RenderData& data, RendererTasks& tasks) {
     ZoneScoped
     ZoneName(
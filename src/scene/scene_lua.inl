@@ -25,6 +25,8 @@
 #include <openspace/documentation/documentation.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/openspaceengine.h>
+#include <openspace/properties/propertyindex.h>
+#include <openspace/query/query.h>
 #include <ghoul/misc/defer.h>
 #include <ghoul/misc/easing.h>
 
@@ -32,33 +34,7 @@ namespace openspace {
 
 namespace {
 
-template <class T>
-properties::PropertyOwner* findPropertyOwnerWithMatchingGroupTag(T* prop,
-    const std::string& tagToMatch)
-{
-    properties::PropertyOwner* tagMatchOwner = nullptr;
-    properties::PropertyOwner* owner = prop->owner();
-
-    if (owner) {
-        const std::vector<std::string>& tags = owner->tags();
-        for (const std::string& currTag : tags) {
-            if (tagToMatch == currTag) {
-                tagMatchOwner = owner;
-                break;
-            }
-        }
-
-        // Call recursively until we find an owner with matching tag or the top of the
-        // ownership list
-        if (tagMatchOwner == nullptr) {
-            tagMatchOwner = findPropertyOwnerWithMatchingGroupTag(owner, tagToMatch);
-        }
-    }
-    return tagMatchOwner;
-}
-
 void applyRegularExpression(lua_State* L, const std::string& regex,
-    const std::vector<properties::Property*>& properties,
     double interpolationDuration,
     const std::string& groupName,
     ghoul::EasingFunction easingFunction)
@@ -66,21 +42,12 @@ void applyRegularExpression(lua_State* L, const std::string& regex,
     using ghoul::lua::errorLocation;
     using ghoul::lua::luaTypeToString;
 
-    const bool isGroupMode = !groupName.empty();
-    bool isLiteral = false;
-
     const int type = lua_type(L, -1);
 
-    // Extract the property and node name to be searched for from regex
-    std::string propertyName = "";
-    std::string nodeName = "";
     size_t wildPos = regex.find_first_of("*");
     if (wildPos != std::string::npos) {
-        nodeName = regex.substr(0, wildPos);
-        propertyName = regex.substr(wildPos + 1, regex.length());
-
         // If none then malformed regular expression
-        if (propertyName.empty() && nodeName.empty()) {
+        if (regex.length() == 1) {
             LERRORC(
                 "applyRegularExpression",
                 fmt::format(
@@ -103,78 +70,16 @@ void applyRegularExpression(lua_State* L, const std::string& regex,
             return;
         }
     }
-    // Literal or tag
-    else {
-        propertyName = regex;
-        if (!isGroupMode) {
-            isLiteral = true;
-        }
-    }
+
+    // The value change might trigger callbacks that modify the property tree, which
+    // would invalidate the list of matches owned by the index
+    const std::vector<properties::Property*> properties =
+        propertyIndex().matchingProperties(regex, groupName);
 
     // Stores whether we found at least one matching property. If this is false at the end
     // of the loop, the property name regex was probably misspelled.
     bool foundMatching = false;
     for (properties::Property* prop : properties) {
-        // Check the regular expression for all properties
-        const std::string& id = prop->fullyQualifiedIdentifier();
-
-        if (isLiteral && id != propertyName) {
-            continue;
-        }
-        else if (!propertyName.empty()){
-            size_t propertyPos = id.find(propertyName);
-            if (propertyPos != std::string::npos) {
-                // Check that the propertyName fully matches the property in id
-                if ((propertyPos + propertyName.length() + 1) < id.length()) {
-                    continue;
-                }
-
-                // Match node name
-                if (!nodeName.empty() && id.find(nodeName) == std::string::npos) {
-                    continue;
-                }
-
-                // Check tag
-                if (isGroupMode) {
-                    properties::PropertyOwner* matchingTaggedOwner =
-                        findPropertyOwnerWithMatchingGroupTag(
-                            prop,
-                            groupName
-                        );
-                    if (!matchingTaggedOwner) {
-                        continue;
-                    }
-                }
-            }
-            else {
-                continue;
-            }
-        }
-        else if (!nodeName.empty()) {
-            size_t nodePos = id.find(nodeName);
-            if (nodePos != std::string::npos) {
-
-                // Check tag
-                if (isGroupMode) {
-                    properties::PropertyOwner* matchingTaggedOwner =
-                        findPropertyOwnerWithMatchingGroupTag(
-                            prop,
-                            groupName
-                        );
-                    if (!matchingTaggedOwner) {
-                        continue;
-                    }
-                }
-                // Check that the nodeName fully matches the node in id
-                else if (nodePos != 0) {
-                    continue;
-                }
-            }
-            else {
-                continue;
-            }
-        }
-
         // Check that the types match
         if (type != prop->typeLua()) {
             LERRORC(
@@ -361,7 +266,6 @@ int property_setValue(lua_State* L) {
         applyRegularExpression(
             L,
             uriOrRegex,
-            allProperties(),
             interpolationDuration,
             groupName,
             easingMethod
@@ -372,7 +276,6 @@ int property_setValue(lua_State* L) {
         applyRegularExpression(
             L,
             uriOrRegex,
-            allProperties(),
             interpolationDuration,
             "",
             easingMethod
@@ -497,17 +400,10 @@ int property_getProperty(lua_State* L) {
         regex = removeGroupNameFromUri(regex);
     }
 
-    // Extract the property and node name to be searched for from regex
-    bool isLiteral = false;
-    std::string propertyName = "";
-    std::string nodeName = "";
     size_t wildPos = regex.find_first_of("*");
     if (wildPos != std::string::npos) {
-        nodeName = regex.substr(0, wildPos);
-        propertyName = regex.substr(wildPos + 1, regex.length());
-
         // If none then malformed regular expression
-        if (propertyName.empty() && nodeName.empty()) {
+        if (regex.length() == 1) {
             LERRORC(
                 "property_getProperty",
                 fmt::format(
@@ -530,79 +426,13 @@ int property_getProperty(lua_State* L) {
             return 0;
         }
     }
-    // Literal or tag
-    else {
-        propertyName = regex;
-        if (groupName.empty()) {
-            isLiteral = true;
-        }
-    }
 
     // Get all matching property uris and save to res
-    std::vector<properties::Property*> props = allProperties();
     std::vector<std::string> res;
-    for (properties::Property* prop : props) {
-        // Check the regular expression for all properties
-        const std::string& id = prop->fullyQualifiedIdentifier();
-
-        if (isLiteral && id != propertyName) {
-            continue;
-        }
-        else if (!propertyName.empty()) {
-            size_t propertyPos = id.find(propertyName);
-            if (propertyPos != std::string::npos) {
-                // Check that the propertyName fully matches the property in id
-                if ((propertyPos + propertyName.length() + 1) < id.length()) {
-                    continue;
-                }
-
-                // Match node name
-                if (!nodeName.empty() && id.find(nodeName) == std::string::npos) {
-                    continue;
-                }
-
-                // Check tag
-                if (!groupName.empty()) {
-                    properties::PropertyOwner* matchingTaggedOwner =
-                        findPropertyOwnerWithMatchingGroupTag(
-                            prop,
-                            groupName
-                        );
-                    if (!matchingTaggedOwner) {
-                        continue;
-                    }
-                }
-            }
-            else {
-                continue;
-            }
-        }
-        else if (!nodeName.empty()) {
-            size_t nodePos = id.find(nodeName);
-            if (nodePos != std::string::npos) {
-
-                // Check tag
-                if (!groupName.empty()) {
-                    properties::PropertyOwner* matchingTaggedOwner =
-                        findPropertyOwnerWithMatchingGroupTag(
-                            prop,
-                            groupName
-                        );
-                    if (!matchingTaggedOwner) {
-                        continue;
-                    }
-                }
-                // Check that the nodeName fully matches the node in id
-                else if (nodePos != 0) {
-                    continue;
-                }
-            }
-            else {
-                continue;
-            }
-        }
-
-        res.push_back(id);
+    for (properties::Property* prop :
+         propertyIndex().matchingProperties(regex, groupName))
+    {
+        res.push_back(prop->fullyQualifiedIdentifier());
     }
 
     lua_newtable(L);
@@ -435,9 +435,17 @@ void SceneGraphNode::traversePostOrder(const std::function<void(SceneGraphNode*)
 }
 
 void SceneGraphNode::update(const UpdateData& data) {
+    updateTransform(data);
+    updateRenderable(data);
+}
+
+void SceneGraphNode::updateTransform(const UpdateData& data) {
     ZoneScoped
     ZoneName(identifier().c_str(), identifier().size())
 
+    _isTransformUpdated = false;
+    _hasTranslationChanged = false;
+
     State s = _state;
     if (s != State::Initialized && _state != State::GLInitialized) {
         return;
@@ -447,7 +455,7 @@ void SceneGraphNode::update(const UpdateData& data) {
     }
 
     if (_transform.translation) {
-        _transform.translation->update(data);
+        _hasTranslationChanged = _transform.translation->updatePosition(data);
     }
 
     if (_transform.rotation) {
@@ -457,36 +465,52 @@ void SceneGraphNode::update(const UpdateData& data) {
     if (_transform.scale) {
         _transform.scale->update(data);
     }
-    UpdateData newUpdateData = data;
 
     // Assumes _worldRotationCached and _worldScaleCached have been calculated for parent
     _worldPositionCached = calculateWorldPosition();
     _worldRotationCached = calculateWorldRotation();
     _worldScaleCached = calculateWorldScale();
 
-    newUpdateData.modelTransform.translation = _worldPositionCached;
-    newUpdateData.modelTransform.rotation = _worldRotationCached;
-    newUpdateData.modelTransform.scale = _worldScaleCached;
-
-    glm::dmat4 translation = glm::translate(
-        glm::dmat4(1.0),
-        newUpdateData.modelTransform.translation
-    );
-    glm::dmat4 rotation = glm::dmat4(newUpdateData.modelTransform.rotation);
-    glm::dmat4 scaling = glm::scale(
-        glm::dmat4(1.0),
-        newUpdateData.modelTransform.scale
-    );
+    glm::dmat4 translation = glm::translate(glm::dmat4(1.0), _worldPositionCached);
+    glm::dmat4 rotation = glm::dmat4(_worldRotationCached);
+    glm::dmat4 scaling = glm::scale(glm::dmat4(1.0), _worldScaleCached);
 
     _modelTransformCached = translation * rotation * scaling;
+    _isTransformUpdated = true;
+}
+
+void SceneGraphNode::updateRenderable(const UpdateData& data) {
+    ZoneScoped
+    ZoneName(identifier().c_str(), identifier().size())
+
+    if (!_isTransformUpdated) {
+        return;
+    }
+
+    // The observers of the Translation are notified here instead of in updateTransform
+    // as that function might have been called on a worker thread
+    if (_hasTranslationChanged) {
+        _transform.translation->notifyObservers();
+        _hasTranslationChanged = false;
+    }
 
     if (_renderable && _renderable->isReady() &&
         (_renderable->isEnabled() || _renderable->shouldUpdateIfDisabled()))
     {
+        UpdateData newUpdateData = data;
+        newUpdateData.modelTransform.translation = _worldPositionCached;
+        newUpdateData.modelTransform.rotation = _worldRotationCached;
+        newUpdateData.modelTransform.scale = _worldScaleCached;
         _renderable->update(newUpdateData);
     }
 }
 
+bool SceneGraphNode::hasThreadSafeTransform() const {
+    return (!_transform.translation || _transform.translation->isThreadSafe()) &&
+           (!_transform.rotation || _transform.rotation->isThreadSafe()) &&
+           (!_transform.scale || _transform.scale->isThreadSafe());
+}
+
 void SceneGraphNode::render(const RenderData& data, RendererTasks& tasks) {
     ZoneScoped
     ZoneName(identifier().c_str(), identifier().size())
@@ -83,17 +83,25 @@ bool Translation::initialize() {
 }
 
 void Translation::update(const UpdateData& data) {
+    if (updatePosition(data)) {
+        notifyObservers();
+    }
+}
+
+bool Translation::updatePosition(const UpdateData& data) {
     if (!_needsUpdate && data.time.j2000Seconds() == _cachedTime) {
-        return;
+        return false;
     }
     const glm::dvec3 oldPosition = _cachedPosition;
     _cachedPosition = position(data);
     _cachedTime = data.time.j2000Seconds();
     _needsUpdate = false;
 
-    if (oldPosition != _cachedPosition) {
-        notifyObservers();
-    }
+    return oldPosition != _cachedPosition;
+}
+
+bool Translation::isThreadSafe() const {
+    return false;
 }
 
 glm::dvec3 Translation::position() const {
@@ -0,0 +1,388 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/ephemeriscache.h>
+
+#include <openspace/util/spicemanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // The bisection of a piece stops at this many segments and the remaining parts of
+    // the piece are answered by SPICE directly
+    constexpr const size_t MaxSegmentsPerPiece = 1024;
+
+    // Pieces further away from the J2000 epoch than this are not cached
+    constexpr const double MaxPieceIndex = 1e12;
+
+    constexpr const int NumNodes = openspace::EphemerisCache::Degree + 1;
+
+    std::atomic<size_t> MemoryBudget = 64 * 1024 * 1024;
+    std::atomic<size_t> MemoryUsage = 0;
+
+    struct ReaderGuard {
+        explicit ReaderGuard(std::atomic_int& n) : nReaders(n) { nReaders++; }
+        ~ReaderGuard() { nReaders--; }
+
+        std::atomic_int& nReaders;
+    };
+
+    int slotIndex(long long index, int nSlots) {
+        return static_cast<int>(((index % nSlots) + nSlots) % nSlots);
+    }
+} // namespace
+
+namespace openspace {
+
+EphemerisCache::EphemerisCache(int nComponents, double tolerance)
+    : _nComponents(nComponents)
+    , _tolerance(tolerance)
+{
+    ghoul_assert(nComponents >= 1 && nComponents <= 4, "Invalid number of components");
+    ghoul_assert(tolerance > 0.0, "Tolerance must be positive");
+}
+
+EphemerisCache::~EphemerisCache() {
+    std::lock_guard lock(SpiceManager::mutex());
+    for (std::atomic<const Piece*>& slot : _slots) {
+        const Piece* piece = slot.exchange(nullptr);
+        if (piece) {
+            retire(piece);
+        }
+    }
+    for (const Piece* piece : _retiredPieces) {
+        MemoryUsage -= piece->nBytes;
+        delete piece;
+    }
+}
+
+void EphemerisCache::setMemoryBudget(size_t bytes) {
+    MemoryBudget = bytes;
+}
+
+size_t EphemerisCache::memoryBudget() {
+    return MemoryBudget;
+}
+
+size_t EphemerisCache::memoryUsage() {
+    return MemoryUsage;
+}
+
+size_t EphemerisCache::nFittedPieces() const {
+    return _nFittedPieces;
+}
+
+EphemerisCache::Value EphemerisCache::value(double ephemerisTime) const {
+    const double pieceIndex = std::floor(ephemerisTime / PieceLength);
+    // The comparison is also false for NaN values
+    if (std::abs(pieceIndex) < MaxPieceIndex) {
+        const long long index = static_cast<long long>(pieceIndex);
+        const unsigned long long generation = SpiceManager::kernelGeneration();
+        const int slot = slotIndex(index, NumSlots);
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            {
+                ReaderGuard guard(_nActiveReaders);
+                const Piece* piece = _slots[slot].load();
+                if (piece && piece->index == index && piece->generation == generation) {
+                    if (!piece->isReferenced.load(std::memory_order_relaxed)) {
+                        piece->isReferenced.store(true, std::memory_order_relaxed);
+                    }
+
+                    const std::vector<Segment>& segments = piece->segments;
+                    auto it = std::upper_bound(
+                        segments.begin(),
+                        segments.end(),
+                        ephemerisTime,
+                        [](double t, const Segment& s) { return t < s.start; }
+                    );
+                    const Segment& segment =
+                        it == segments.begin() ? segments.front() : *(it - 1);
+                    if (!segment.isFitted) {
+                        break;
+                    }
+                    return evaluate(segment, ephemerisTime);
+                }
+            }
+
+            // The reader guard has to be released before fitting, or else the retired
+            // pieces could never be reclaimed by the fitting thread
+            if (attempt == 0) {
+                fitPiece(index, generation);
+            }
+        }
+    }
+
+    std::lock_guard lock(SpiceManager::mutex());
+    return sample(ephemerisTime);
+}
+
+void EphemerisCache::alignSample(Value&, const Value&) const {}
+
+EphemerisCache::Value EphemerisCache::evaluate(const Segment& segment,
+                                               double ephemerisTime) const
+{
+    const double x = std::clamp(
+        (2.0 * ephemerisTime - segment.start - segment.end) /
+        (segment.end - segment.start),
+        -1.0,
+        1.0
+    );
+
+    // Clenshaw recurrence for the sum of the Chebyshev polynomials
+    Value result = { 0.0, 0.0, 0.0, 0.0 };
+    for (int c = 0; c < _nComponents; ++c) {
+        const double* coefficients = &segment.coefficients[c * NumNodes];
+        double b1 = 0.0;
+        double b2 = 0.0;
+        for (int j = Degree; j >= 1; --j) {
+            const double b = 2.0 * x * b1 - b2 + coefficients[j];
+            b2 = b1;
+            b1 = b;
+        }
+        result[c] = x * b1 - b2 + coefficients[0];
+    }
+    return result;
+}
+
+void EphemerisCache::fitPiece(long long index, unsigned long long generation) const {
+    std::lock_guard lock(SpiceManager::mutex());
+
+    // Another thread might have fitted this piece while we were waiting for the lock
+    const Piece* current = _slots[slotIndex(index, NumSlots)].load();
+    if (current && current->index == index && current->generation == generation) {
+        return;
+    }
+
+    auto piece = std::make_unique<Piece>();
+    piece->index = index;
+    piece->generation = generation;
+    const double start = static_cast<double>(index) * PieceLength;
+    fitSegment(start, start + PieceLength, piece->segments);
+    piece->segments.shrink_to_fit();
+    piece->nBytes = sizeof(Piece) + piece->segments.size() * sizeof(Segment);
+
+    MemoryUsage += piece->nBytes;
+    _nFittedPieces++;
+    install(piece.release());
+}
+
+void EphemerisCache::fitSegment(double start, double end,
+                                std::vector<Segment>& segments) const
+{
+    Segment segment;
+    segment.start = start;
+    segment.end = end;
+    try {
+        if (tryFitSegment(segment)) {
+            segments.push_back(segment);
+            return;
+        }
+    }
+    catch (const ghoul::RuntimeError&) {
+        // If SPICE cannot provide a value, there is no point in bisecting further. The
+        // error is reported when the value is requested through the fallback instead
+        segment.isFitted = false;
+        segments.push_back(segment);
+        return;
+    }
+
+    const bool canBisect = (end - start) >= 2.0 * MinimumSegmentLength &&
+                           segments.size() < MaxSegmentsPerPiece;
+    if (!canBisect) {
+        segment.isFitted = false;
+        segments.push_back(segment);
+        return;
+    }
+
+    const double middle = (start + end) / 2.0;
+    fitSegment(start, middle, segments);
+    fitSegment(middle, end, segments);
+}
+
+bool EphemerisCache::tryFitSegment(Segment& segment) const {
+    const double center = (segment.start + segment.end) / 2.0;
+    const double halfLength = (segment.end - segment.start) / 2.0;
+    const double pi = glm::pi<double>();
+
+    // Sample at the Chebyshev nodes of the first kind, which are ordered by decreasing
+    // time. Each sample is aligned to the previous one to form a continuous curve
+    std::array<Value, NumNodes> samples;
+    for (int k = 0; k < NumNodes; ++k) {
+        const double x = std::cos(pi * (k + 0.5) / NumNodes);
+        samples[k] = sample(center + halfLength * x);
+        if (k > 0) {
+            alignSample(samples[k], samples[k - 1]);
+        }
+    }
+
+    for (int c = 0; c < _nComponents; ++c) {
+        for (int j = 0; j < NumNodes; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < NumNodes; ++k) {
+                sum += samples[k][c] * std::cos(pi * j * (k + 0.5) / NumNodes);
+            }
+            const double scale = (j == 0) ? 1.0 : 2.0;
+            segment.coefficients[c * NumNodes + j] = scale * sum / NumNodes;
+        }
+    }
+    segment.isFitted = true;
+
+    // The error is largest between the interpolation nodes and at the ends of the
+    // segment, so those are the places where the fit is tested against SPICE
+    for (int m = 0; m <= NumNodes; ++m) {
+        const double x = std::cos(pi * m / NumNodes);
+        const double t = center + halfLength * x;
+        if (error(evaluate(segment, t), sample(t)) > _tolerance) {
+            segment.isFitted = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+void EphemerisCache::install(const Piece* piece) const {
+    const Piece* previous = _slots[slotIndex(piece->index, NumSlots)].exchange(piece);
+    if (previous) {
+        retire(previous);
+    }
+
+    // Evict pieces of this cache that have not been used recently until the memory
+    // usage is below the budget again, giving each used piece a second chance
+    for (int i = 0; i < 2 * NumSlots && MemoryUsage > MemoryBudget; ++i) {
+        std::atomic<const Piece*>& slot = _slots[_clockHand];
+        _clockHand = (_clockHand + 1) % NumSlots;
+
+        const Piece* p = slot.load();
+        if (!p || p == piece) {
+            continue;
+        }
+        if (p->isReferenced.exchange(false)) {
+            continue;
+        }
+        slot.store(nullptr);
+        retire(p);
+    }
+
+    // Readers register themselves before loading a piece from a slot, so if there are
+    // no active readers after the pieces were removed from their slots, nobody can hold
+    // a pointer to a retired piece anymore
+    if (_nActiveReaders == 0) {
+        for (const Piece* p : _retiredPieces) {
+            MemoryUsage -= p->nBytes;
+            delete p;
+        }
+        _retiredPieces.clear();
+    }
+}
+
+void EphemerisCache::retire(const Piece* piece) const {
+    _retiredPieces.push_back(piece);
+}
+
+PositionEphemerisCache::PositionEphemerisCache(std::string target, std::string observer,
+                                               std::string referenceFrame,
+                                               double tolerance)
+    : EphemerisCache(3, tolerance)
+    , _target(std::move(target))
+    , _observer(std::move(observer))
+    , _referenceFrame(std::move(referenceFrame))
+{}
+
+glm::dvec3 PositionEphemerisCache::position(double ephemerisTime) const {
+    const Value v = value(ephemerisTime);
+    return glm::dvec3(v[0], v[1], v[2]);
+}
+
+EphemerisCache::Value PositionEphemerisCache::sample(double ephemerisTime) const {
+    const glm::dvec3 p = SpiceManager::ref().targetPosition(
+        _target,
+        _observer,
+        _referenceFrame,
+        {},
+        ephemerisTime
+    );
+    return { p.x, p.y, p.z, 0.0 };
+}
+
+double PositionEphemerisCache::error(const Value& approximation,
+                                     const Value& reference) const
+{
+    return glm::length(
+        glm::dvec3(approximation[0], approximation[1], approximation[2]) -
+        glm::dvec3(reference[0], reference[1], reference[2])
+    );
+}
+
+RotationEphemerisCache::RotationEphemerisCache(std::string sourceFrame,
+                                               std::string destinationFrame,
+                                               double tolerance)
+    : EphemerisCache(4, tolerance)
+    , _sourceFrame(std::move(sourceFrame))
+    , _destinationFrame(std::move(destinationFrame))
+{}
+
+glm::dmat3 RotationEphemerisCache::matrix(double ephemerisTime) const {
+    const Value v = value(ephemerisTime);
+    return glm::mat3_cast(glm::normalize(glm::dquat(v[0], v[1], v[2], v[3])));
+}
+
+EphemerisCache::Value RotationEphemerisCache::sample(double ephemerisTime) const {
+    const glm::dquat q = glm::quat_cast(SpiceManager::ref().positionTransformMatrix(
+        _sourceFrame,
+        _destinationFrame,
+        ephemerisTime
+    ));
+    return { q.w, q.x, q.y, q.z };
+}
+
+double RotationEphemerisCache::error(const Value& approximation,
+                                     const Value& reference) const
+{
+    const glm::dvec4 a = glm::normalize(glm::dvec4(
+        approximation[0], approximation[1], approximation[2], approximation[3]
+    ));
+    const glm::dvec4 r(reference[0], reference[1], reference[2], reference[3]);
+
+    // q and -q describe the same rotation. The chord between the two unit quaternions
+    // is used instead of the dot product, which loses precision for small angles
+    const double chord = std::min(glm::length(a - r), glm::length(a + r));
+    return 4.0 * std::asin(std::min(chord / 2.0, 1.0));
+}
+
+void RotationEphemerisCache::alignSample(Value& sample, const Value& previous) const {
+    const double dot = sample[0] * previous[0] + sample[1] * previous[1] +
+                       sample[2] * previous[2] + sample[3] * previous[3];
+    if (dot < 0.0) {
+        for (double& v : sample) {
+            v = -v;
+        }
+    }
+}
+
+} // namespace openspace
@@ -0,0 +1,192 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/mappedfile.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <utility>
+
+#ifdef WIN32
+#include <Windows.h>
+#else // ^^^ WIN32 / !WIN32 vvv
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace openspace {
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef WIN32
+    _file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        throw ghoul::RuntimeError(fmt::format("Could not open file '{}'", path));
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size)) {
+        unmap();
+        throw ghoul::RuntimeError(fmt::format("Could not get size of '{}'", path));
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if (_size == 0) {
+        // Empty files cannot be mapped, but they are valid nonetheless
+        return;
+    }
+
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mapping) {
+        unmap();
+        throw ghoul::RuntimeError(fmt::format("Could not map file '{}'", path));
+    }
+
+    _data = reinterpret_cast<const std::byte*>(
+        MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)
+    );
+    if (!_data) {
+        unmap();
+        throw ghoul::RuntimeError(fmt::format("Could not map file '{}'", path));
+    }
+#else // ^^^ WIN32 / !WIN32 vvv
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw ghoul::RuntimeError(fmt::format("Could not open file '{}'", path));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        throw ghoul::RuntimeError(fmt::format("Could not get size of '{}'", path));
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size == 0) {
+        // Empty files cannot be mapped, but they are valid nonetheless
+        close(fd);
+        return;
+    }
+
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        _size = 0;
+        throw ghoul::RuntimeError(fmt::format("Could not map file '{}'", path));
+    }
+    _data = reinterpret_cast<const std::byte*>(data);
+#endif // WIN32
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+#ifdef WIN32
+        _file = std::exchange(other._file, nullptr);
+        _mapping = std::exchange(other._mapping, nullptr);
+#endif // WIN32
+    }
+    return *this;
+}
+
+const std::byte* MappedFile::data() const {
+    return _data;
+}
+
+size_t MappedFile::size() const {
+    return _size;
+}
+
+void MappedFile::prefault(size_t offset, size_t size) const {
+    if (offset >= _size || size == 0) {
+        return;
+    }
+    size = std::min(size, _size - offset);
+
+#ifndef WIN32
+    // Let the kernel start reading ahead while we are touching the pages below. madvise
+    // requires a page aligned address
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t alignedOffset = offset - offset % pageSize;
+    posix_madvise(
+        const_cast<std::byte*>(_data + alignedOffset),
+        size + offset - alignedOffset,
+        POSIX_MADV_WILLNEED
+    );
+#endif // WIN32
+
+    // Reading a single byte from every page is enough to make the page resident. 4096 is
+    // the smallest page size on all supported platforms
+    constexpr const size_t MinPageSize = 4096;
+    std::byte touched = _data[offset + size - 1];
+    for (size_t i = offset; i < offset + size; i += MinPageSize) {
+        touched |= _data[i];
+    }
+    // Storing the result prevents the compiler from optimizing the reads away
+    [[maybe_unused]] volatile std::byte sink = touched;
+}
+
+void MappedFile::unmap() {
+#ifdef WIN32
+    if (_data) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+    if (_file) {
+        CloseHandle(_file);
+        _file = nullptr;
+    }
+#else // ^^^ WIN32 / !WIN32 vvv
+    if (_data) {
+        munmap(const_cast<std::byte*>(_data), _size);
+    }
+#endif // WIN32
+    _data = nullptr;
+    _size = 0;
+}
+
+} // namespace openspace
@@ -0,0 +1,649 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/speckloader.h>
+
+#include <openspace/util/mappedfile.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace {
+    constexpr const char* _loggerCat = "SpeckLoader";
+
+    constexpr const uint32_t CacheMagic = 0x4b435053; // 'SPCK'
+    constexpr const int32_t CurrentCacheVersion = 1;
+    // The column data starts at a multiple of this to keep the mapped floats aligned
+    constexpr const size_t ColumnAlignment = 16;
+
+    bool startsWith(std::string_view line, std::string_view keyword) {
+        return line.substr(0, keyword.size()) == keyword;
+    }
+
+    // Reads the header values of a cache file while making sure that no read goes past
+    // the end of the mapped memory
+    struct CacheReader {
+        template <typename T>
+        bool read(T& value) {
+            if (offset + sizeof(T) > size) {
+                return false;
+            }
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool read(std::string& value) {
+            uint16_t length = 0;
+            if (!read(length) || offset + length > size) {
+                return false;
+            }
+            value.assign(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return true;
+        }
+
+        const std::byte* data;
+        size_t size;
+        size_t offset = 0;
+    };
+
+    // Data sections smaller than this are not split up any further
+    constexpr const size_t MinimumChunkSize = 1024 * 1024;
+    // Using more chunks than threads evens out differences in the parsing speed
+    constexpr const size_t ChunksPerThread = 4;
+
+    // A part of the data section of a speck file that starts at the beginning of a line
+    // and ends after a line break or at the end of the file
+    struct ParsedChunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        // The values of all entries in this chunk, stored row by row
+        std::vector<float> values;
+        size_t nEntries = 0;
+        size_t firstEntry = 0;
+    };
+
+    const char* findLineEnd(const char* begin, const char* end) {
+        // memchr is vectorized in all standard libraries that we care about
+        const void* res = std::memchr(begin, '\n', end - begin);
+        return res ? static_cast<const char*>(res) : end;
+    }
+
+    // Guard against wrong line endings (copying files from Windows to Mac) causes lines
+    // to have a final \r
+    const char* trimLineEnd(const char* begin, const char* end) {
+        return (end > begin && *(end - 1) == '\r') ? end - 1 : end;
+    }
+
+    // Parses a single floating point value starting at the cursor and skipping leading
+    // whitespace. Returns false and leaves the cursor unchanged if no value was found
+    bool parseValue(const char*& cursor, const char* end, float& value) {
+        const char* c = cursor;
+        while (c < end && (*c == ' ' || *c == '\t')) {
+            c++;
+        }
+        if (c < end && *c == '+') {
+            // std::from_chars does not accept the leading '+' that strtof accepts
+            c++;
+        }
+#ifdef __cpp_lib_to_chars
+        const std::from_chars_result res = std::from_chars(c, end, value);
+        if (res.ec != std::errc() || res.ptr == c) {
+            return false;
+        }
+        cursor = res.ptr;
+        return true;
+#else // ^^^ __cpp_lib_to_chars / !__cpp_lib_to_chars vvv
+        // The line is not null-terminated, so we need to copy the token first
+        std::array<char, 64> buffer = {};
+        size_t n = 0;
+        while (c + n < end && n < buffer.size() - 1 &&
+            !std::isspace(static_cast<unsigned char>(c[n])))
+        {
+            buffer[n] = c[n];
+            n++;
+        }
+        char* tokenEnd = nullptr;
+        value = std::strtof(buffer.data(), &tokenEnd);
+        if (tokenEnd == buffer.data()) {
+            return false;
+        }
+        cursor = c + (tokenEnd - buffer.data());
+        return true;
+#endif // __cpp_lib_to_chars
+    }
+
+    void parseChunk(ParsedChunk& chunk, int nColumns) {
+        const char* cursor = chunk.begin;
+        while (cursor < chunk.end) {
+            const char* lineEnd = findLineEnd(cursor, chunk.end);
+            const char* valuesEnd = trimLineEnd(cursor, lineEnd);
+            const char* lineBegin = cursor;
+            cursor = lineEnd < chunk.end ? lineEnd + 1 : chunk.end;
+
+            if (valuesEnd == lineBegin || *lineBegin == '#') {
+                continue;
+            }
+
+            const char* c = lineBegin;
+            for (int i = 0; i < nColumns; ++i) {
+                float value = 0.f;
+                // Missing values at the end of a line are treated as 0; once a value
+                // could not be parsed, all following values of the line are 0 as well
+                if (!parseValue(c, valuesEnd, value)) {
+                    value = 0.f;
+                }
+                chunk.values.push_back(value);
+            }
+            chunk.nEntries++;
+        }
+    }
+
+    template <typename T>
+    void write(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(std::ofstream& file, const std::string& value) {
+        const uint16_t length = static_cast<uint16_t>(value.size());
+        write(file, length);
+        file.write(value.data(), length);
+    }
+} // namespace
+
+namespace openspace::speck {
+
+Dataset::Dataset() = default;
+Dataset::~Dataset() = default;
+Dataset::Dataset(Dataset&& other) noexcept = default;
+Dataset& Dataset::operator=(Dataset&& other) noexcept = default;
+
+size_t Dataset::nEntries() const {
+    return _nEntries;
+}
+
+int Dataset::nColumns() const {
+    return static_cast<int>(_columns.size());
+}
+
+bool Dataset::isEmpty() const {
+    return _nEntries == 0;
+}
+
+const std::vector<Variable>& Dataset::variables() const {
+    return _variables;
+}
+
+int Dataset::index(std::string_view name) const {
+    const auto it = std::find_if(
+        _variables.begin(),
+        _variables.end(),
+        [name](const Variable& v) { return v.name == name; }
+    );
+    return it != _variables.end() ? it->index : -1;
+}
+
+const std::vector<Texture>& Dataset::textures() const {
+    return _textures;
+}
+
+int Dataset::textureDataIndex() const {
+    return _textureDataIndex;
+}
+
+int Dataset::orientationDataIndex() const {
+    return _orientationDataIndex;
+}
+
+const float* Dataset::column(int index) const {
+    ghoul_assert(index >= 0 && index < nColumns(), "Column index out of range");
+    return _columns[index];
+}
+
+float* Dataset::mutableColumn(int index) {
+    ghoul_assert(index >= 0 && index < nColumns(), "Column index out of range");
+    ghoul_assert(!isMemoryMapped(), "Memory mapped columns cannot be modified");
+    return _ownedColumns[index].data();
+}
+
+bool Dataset::isMemoryMapped() const {
+    return _mappedFile != nullptr;
+}
+
+void Dataset::removeEntries(const std::function<bool(size_t)>& predicate) {
+    ghoul_assert(!isMemoryMapped(), "Entries of a memory mapped Dataset are immutable");
+
+    std::vector<bool> remove(_nEntries);
+    for (size_t i = 0; i < _nEntries; ++i) {
+        remove[i] = predicate(i);
+    }
+
+    size_t nRemaining = 0;
+    for (std::vector<float>& column : _ownedColumns) {
+        nRemaining = 0;
+        for (size_t i = 0; i < _nEntries; ++i) {
+            if (!remove[i]) {
+                column[nRemaining] = column[i];
+                nRemaining++;
+            }
+        }
+        column.resize(nRemaining);
+    }
+    _nEntries = nRemaining;
+
+    for (size_t i = 0; i < _ownedColumns.size(); ++i) {
+        _columns[i] = _ownedColumns[i].data();
+    }
+}
+
+Dataset loadSpeckFile(const std::string& path, size_t nThreads) {
+    if (!FileSys.fileExists(path)) {
+        throw ghoul::RuntimeError(fmt::format("Failed to open Speck file '{}'", path));
+    }
+
+    MappedFile file(path);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+
+    Dataset res;
+
+    // The number of values per entry, not counting the x, y, and z position
+    int nValues = 0;
+
+    // The beginning of the speck file has a header that either contains comments
+    // (signaled by a preceding '#') or information about the structure of the file
+    // (signaled by the keywords 'datavar', 'texturevar', 'texture', 'polyorivar',
+    // and 'maxcomment')
+    const char* dataBegin = end;
+    const char* cursor = begin;
+    while (cursor < end) {
+        const char* lineEnd = findLineEnd(cursor, end);
+        std::string line = std::string(cursor, trimLineEnd(cursor, lineEnd));
+        const char* lineBegin = cursor;
+        cursor = lineEnd < end ? lineEnd + 1 : end;
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        if (startsWith(line, "datavar")) {
+            // datavar lines are structured as follows:
+            // datavar # description
+            // where # is the index of the data variable, which does not count the x, y,
+            // and z position at the beginning of each line
+            std::stringstream str(line);
+            std::string dummy;
+            int index = 0;
+            std::string name;
+            str >> dummy >> index >> name;
+
+            res._variables.push_back({ index + 3, name });
+
+            // Orientations are stored as two 3D vectors u and v
+            const int nComponents = (name == "orientation" || name == "ori") ? 6 : 1;
+            nValues = std::max(nValues, index + nComponents);
+        }
+        else if (startsWith(line, "texturevar")) {
+            std::stringstream str(line);
+            std::string dummy;
+            int index = 0;
+            str >> dummy >> index;
+            res._textureDataIndex = index + 3;
+        }
+        else if (startsWith(line, "texture")) {
+            // texture lines are structured as follows:
+            // texture [-option] # filename
+            std::stringstream str(line);
+            std::string dummy;
+            str >> dummy;
+
+            std::string token;
+            str >> token;
+            if (!token.empty() && token[0] == '-') {
+                // The options are not used right now
+                str >> token;
+            }
+
+            Texture texture;
+            texture.index = std::atoi(token.c_str());
+            str >> texture.file;
+            res._textures.push_back(std::move(texture));
+        }
+        else if (startsWith(line, "polyorivar")) {
+            std::stringstream str(line);
+            std::string dummy;
+            int index = 0;
+            str >> dummy >> index;
+            res._orientationDataIndex = index + 3;
+        }
+        else if (startsWith(line, "maxcomment")) {
+            continue;
+        }
+        else {
+            // Started reading data
+            dataBegin = lineBegin;
+            break;
+        }
+    }
+
+    const int nColumns = nValues + 3;
+
+    // Split the data section into chunks that start at the beginning of a line. The
+    // chunks are parsed independently and are then copied into the columns in the
+    // order in which they appear in the file
+    if (nThreads == 0) {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    const size_t dataSize = static_cast<size_t>(end - dataBegin);
+    const size_t nChunks = std::clamp<size_t>(
+        dataSize / MinimumChunkSize,
+        1,
+        nThreads * ChunksPerThread
+    );
+
+    std::vector<ParsedChunk> chunks(nChunks);
+    const char* chunkBegin = dataBegin;
+    for (size_t i = 0; i < nChunks; ++i) {
+        const char* chunkEnd = end;
+        if (i < nChunks - 1) {
+            const char* target =
+                std::max(chunkBegin, dataBegin + dataSize / nChunks * (i + 1));
+            chunkEnd = findLineEnd(target, end);
+            chunkEnd = chunkEnd < end ? chunkEnd + 1 : end;
+        }
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    auto parse = [&chunks, nColumns](size_t i) { parseChunk(chunks[i], nColumns); };
+    const bool isParallel = nThreads > 1 && nChunks > 1;
+    if (isParallel) {
+        ThreadPool::shared().parallelFor(0, nChunks, parse);
+    }
+    else {
+        for (size_t i = 0; i < nChunks; ++i) {
+            parse(i);
+        }
+    }
+
+    size_t nEntries = 0;
+    for (ParsedChunk& chunk : chunks) {
+        chunk.firstEntry = nEntries;
+        nEntries += chunk.nEntries;
+    }
+
+    res._nEntries = nEntries;
+    res._ownedColumns.resize(nColumns);
+    for (std::vector<float>& column : res._ownedColumns) {
+        column.resize(nEntries);
+    }
+
+    // Each chunk writes to a disjoint range of every column
+    auto transpose = [&chunks, &res, nColumns](size_t i) {
+        ParsedChunk& chunk = chunks[i];
+        for (int c = 0; c < nColumns; ++c) {
+            float* column = res._ownedColumns[c].data() + chunk.firstEntry;
+            for (size_t e = 0; e < chunk.nEntries; ++e) {
+                column[e] = chunk.values[e * nColumns + c];
+            }
+        }
+        chunk.values = std::vector<float>();
+    };
+    if (isParallel) {
+        ThreadPool::shared().parallelFor(0, nChunks, transpose);
+    }
+    else {
+        for (size_t i = 0; i < nChunks; ++i) {
+            transpose(i);
+        }
+    }
+
+    res._columns.resize(nColumns);
+    for (int i = 0; i < nColumns; ++i) {
+        res._columns[i] = res._ownedColumns[i].data();
+    }
+    return res;
+}
+
+void saveCachedDataset(const Dataset& dataset, const std::string& path) {
+    std::ofstream file(path, std::ofstream::binary);
+    if (!file.good()) {
+        throw ghoul::RuntimeError(fmt::format("Error opening cache file '{}'", path));
+    }
+
+    write(file, CacheMagic);
+    write(file, CurrentCacheVersion);
+    write(file, static_cast<uint64_t>(dataset.nEntries()));
+    write(file, static_cast<int32_t>(dataset.nColumns()));
+    write(file, static_cast<int32_t>(dataset.textureDataIndex()));
+    write(file, static_cast<int32_t>(dataset.orientationDataIndex()));
+
+    write(file, static_cast<uint32_t>(dataset.variables().size()));
+    for (const Variable& v : dataset.variables()) {
+        write(file, static_cast<int32_t>(v.index));
+        write(file, v.name);
+    }
+
+    write(file, static_cast<uint32_t>(dataset.textures().size()));
+    for (const Texture& t : dataset.textures()) {
+        write(file, static_cast<int32_t>(t.index));
+        write(file, t.file);
+    }
+
+    // Pad the header so that the columns are aligned once the file is mapped
+    const size_t headerSize = static_cast<size_t>(file.tellp());
+    const size_t padding =
+        (ColumnAlignment - headerSize % ColumnAlignment) % ColumnAlignment;
+    const char zeros[ColumnAlignment] = {};
+    file.write(zeros, padding);
+
+    // Each column is stored contiguously so that it can be accessed without touching
+    // the pages of any other column
+    for (int i = 0; i < dataset.nColumns(); ++i) {
+        file.write(
+            reinterpret_cast<const char*>(dataset.column(i)),
+            dataset.nEntries() * sizeof(float)
+        );
+    }
+
+    if (!file.good()) {
+        throw ghoul::RuntimeError(fmt::format("Error writing cache file '{}'", path));
+    }
+}
+
+std::optional<Dataset> loadCachedDataset(const std::string& path) {
+    std::unique_ptr<MappedFile> mapped;
+    try {
+        mapped = std::make_unique<MappedFile>(path);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(e.message);
+        return std::nullopt;
+    }
+
+    CacheReader reader = { mapped->data(), mapped->size() };
+
+    uint32_t magic = 0;
+    int32_t version = 0;
+    if (!reader.read(magic) || magic != CacheMagic || !reader.read(version) ||
+        version != CurrentCacheVersion)
+    {
+        LINFO(fmt::format("The format of the cache file '{}' has changed", path));
+        return std::nullopt;
+    }
+
+    Dataset res;
+    uint64_t nEntries = 0;
+    int32_t nColumns = 0;
+    int32_t textureDataIndex = 0;
+    int32_t orientationDataIndex = 0;
+    uint32_t nVariables = 0;
+    bool success = reader.read(nEntries) && reader.read(nColumns) &&
+        reader.read(textureDataIndex) && reader.read(orientationDataIndex) &&
+        reader.read(nVariables);
+
+    for (uint32_t i = 0; success && i < nVariables; ++i) {
+        Variable v;
+        int32_t index = 0;
+        success = reader.read(index) && reader.read(v.name);
+        v.index = index;
+        res._variables.push_back(std::move(v));
+    }
+
+    uint32_t nTextures = 0;
+    success = success && reader.read(nTextures);
+    for (uint32_t i = 0; success && i < nTextures; ++i) {
+        Texture t;
+        int32_t index = 0;
+        success = reader.read(index) && reader.read(t.file);
+        t.index = index;
+        res._textures.push_back(std::move(t));
+    }
+
+    const size_t columnsOffset =
+        (reader.offset + ColumnAlignment - 1) / ColumnAlignment * ColumnAlignment;
+    const size_t columnSize = nEntries * sizeof(float);
+    if (!success || nColumns < 0 ||
+        columnsOffset + nColumns * columnSize != mapped->size())
+    {
+        LERROR(fmt::format("The cache file '{}' is corrupt", path));
+        return std::nullopt;
+    }
+
+    res._nEntries = static_cast<size_t>(nEntries);
+    res._textureDataIndex = textureDataIndex;
+    res._orientationDataIndex = orientationDataIndex;
+    res._columns.resize(nColumns);
+    for (int32_t i = 0; i < nColumns; ++i) {
+        res._columns[i] = reinterpret_cast<const float*>(
+            mapped->data() + columnsOffset + i * columnSize
+        );
+    }
+    res._mappedFile = std::move(mapped);
+    return res;
+}
+
+Dataset loadSpeckFileCached(const std::string& path, const std::string& cacheKey,
+                            const std::function<void(Dataset&)>& postProcessing)
+{
+    const std::string cachedFile = FileSys.cacheManager()->cachedFilename(
+        ghoul::filesystem::File(path),
+        cacheKey,
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+
+    if (FileSys.fileExists(cachedFile)) {
+        LINFO(fmt::format(
+            "Cached file '{}' used for Speck file '{}'", cachedFile, path
+        ));
+
+        std::optional<Dataset> dataset = loadCachedDataset(cachedFile);
+        if (dataset.has_value()) {
+            return std::move(*dataset);
+        }
+        // Intentional fall-through to regenerate the cache file for the next run
+    }
+    else {
+        LINFO(fmt::format("Cache for Speck file '{}' not found", path));
+    }
+
+    LINFO(fmt::format("Loading Speck file '{}'", path));
+    Dataset dataset = loadSpeckFile(path);
+    if (postProcessing) {
+        postProcessing(dataset);
+    }
+
+    try {
+        saveCachedDataset(dataset, cachedFile);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        // Not being able to write the cache is not fatal as we have the data already
+        LERROR(e.message);
+    }
+    return dataset;
+}
+
+std::vector<Label> loadLabelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.good()) {
+        throw ghoul::RuntimeError(fmt::format("Failed to open Label file '{}'", path));
+    }
+
+    std::vector<Label> res;
+    std::string line;
+    while (std::getline(file, line)) {
+        // Guard against wrong line endings (copying files from Windows to Mac) causes
+        // lines to have a final \r
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        // The textcolor header lines are not supported yet
+        if (line.empty() || line[0] == '#' || startsWith(line, "textcolor")) {
+            continue;
+        }
+
+        std::stringstream str(line);
+
+        Label label;
+        label.position = glm::vec3(0.f);
+        str >> label.position.x >> label.position.y >> label.position.z;
+
+        std::string dummy;
+        str >> dummy; // text keyword
+
+        // The label extends to the end of the line or the beginning of a comment
+        while (str >> dummy) {
+            if (dummy[0] == '#') {
+                break;
+            }
+            if (!label.text.empty()) {
+                label.text += ' ';
+            }
+            label.text += dummy;
+        }
+
+        res.push_back(std::move(label));
+    }
+    return res;
+}
+
+} // namespace openspace::speck
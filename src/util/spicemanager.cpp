@@ -32,12 +32,56 @@
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/profiling.h>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include "SpiceUsr.h"
 #include "SpiceZpr.h"
 
 namespace {
     constexpr const char* _loggerCat = "SpiceManager";
 
+    // This is not a member as caches of SPICE values can outlive the SpiceManager
+    std::atomic<unsigned long long> KernelGeneration = 0;
+
+    // CSPICE is not re-entrant, so every call into it has to hold this mutex. It is
+    // recursive as the public methods call each other
+    std::recursive_mutex SpiceMutex;
+
+    // The intervals are sorted and disjoint, so only the last interval that starts
+    // before the time can contain it
+    bool isCovered(const std::vector<std::pair<double, double>>& intervals, double et) {
+        auto it = std::upper_bound(
+            intervals.begin(),
+            intervals.end(),
+            et,
+            [](double t, const std::pair<double, double>& i) { return t <= i.first; }
+        );
+        return it != intervals.begin() && std::prev(it)->second > et;
+    }
+
+    // Sorts the intervals and merges the ones that overlap, and sorts the start and end
+    // times while removing duplicates
+    void sortCoverage(std::vector<std::pair<double, double>>& intervals,
+                      std::vector<double>& times)
+    {
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+
+        std::sort(intervals.begin(), intervals.end());
+        std::vector<std::pair<double, double>> merged;
+        merged.reserve(intervals.size());
+        for (const std::pair<double, double>& i : intervals) {
+            // The intervals are open, so intervals that only touch are kept separate
+            if (!merged.empty() && i.first < merged.back().second) {
+                merged.back().second = std::max(merged.back().second, i.second);
+            }
+            else {
+                merged.push_back(i);
+            }
+        }
+        intervals = std::move(merged);
+    }
+
     // The value comes from
     // http://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/getmsg_c.html
     // as the maximum message length
@@ -155,6 +199,8 @@ SpiceManager::SpiceManager() {
 }
 
 SpiceManager::~SpiceManager() {
+    std::lock_guard lock(SpiceMutex);
+
     for (const KernelInformation& i : _loadedKernels) {
         unload_c(i.path.c_str());
     }
@@ -179,6 +225,25 @@ bool SpiceManager::isInitialized() {
     return _instance != nullptr;
 }
 
+unsigned long long SpiceManager::kernelGeneration() {
+    return KernelGeneration;
+}
+
+std::recursive_mutex& SpiceManager::mutex() {
+    return SpiceMutex;
+}
+
+std::vector<std::string> SpiceManager::loadedKernels() const {
+    std::lock_guard lock(SpiceMutex);
+
+    std::vector<std::string> res;
+    res.reserve(_loadedKernels.size());
+    for (const KernelInformation& kernel : _loadedKernels) {
+        res.push_back(kernel.path);
+    }
+    return res;
+}
+
 SpiceManager& SpiceManager::ref() {
     ghoul_assert(isInitialized(), "SpiceManager is not initialized");
     return *_instance;
@@ -213,6 +278,8 @@ SpiceManager::KernelHandle SpiceManager::loadKernel(std::string filePath) {
         )
     );
 
+    std::lock_guard lock(SpiceMutex);
+
     std::string path = absPath(std::move(filePath));
     const auto it = std::find_if(
         _loadedKernels.begin(),
@@ -258,6 +325,8 @@ SpiceManager::KernelHandle SpiceManager::loadKernel(std::string filePath) {
         findSpkCoverage(path); // binary spk kernel
     }
 
+    KernelGeneration++;
+
     KernelHandle kernelId = ++_lastAssignedKernel;
     ghoul_assert(kernelId != 0, fmt::format("Kernel Handle wrapped around to 0"));
     _loadedKernels.push_back({std::move(path), kernelId, 1});
@@ -268,6 +337,8 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
     ghoul_assert(kernelId <= _lastAssignedKernel, "Invalid unassigned kernel");
     ghoul_assert(kernelId != KernelHandle(0), "Invalid zero handle");
 
+    std::lock_guard lock(SpiceMutex);
+
     const auto it = std::find_if(
         _loadedKernels.begin(),
         _loadedKernels.end(),
@@ -281,6 +352,7 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
             LINFO(fmt::format("Unloading SPICE kernel '{}'", it->path));
             unload_c(it->path.c_str());
             _loadedKernels.erase(it);
+            KernelGeneration++;
         }
         // Otherwise, we hold on to it, but reduce the reference counter by 1
         else {
@@ -293,6 +365,8 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
 void SpiceManager::unloadKernel(std::string filePath) {
     ghoul_assert(!filePath.empty(), "Empty filename");
 
+    std::lock_guard lock(SpiceMutex);
+
     std::string path = absPath(std::move(filePath));
 
     const auto it = std::find_if(
@@ -317,6 +391,7 @@ void SpiceManager::unloadKernel(std::string filePath) {
             LINFO(fmt::format("Unloading SPICE kernel '{}'", path));
             unload_c(path.c_str());
             _loadedKernels.erase(it);
+            KernelGeneration++;
         }
         else {
             // Otherwise, we hold on to it, but reduce the reference counter by 1
@@ -329,17 +404,14 @@ void SpiceManager::unloadKernel(std::string filePath) {
 bool SpiceManager::hasSpkCoverage(const std::string& target, double et) const {
     ghoul_assert(!target.empty(), "Empty target");
 
-    const int id = naifId(target);
-    const auto it = _spkIntervals.find(id);
-    if (it != _spkIntervals.end()) {
-        const std::vector<std::pair<double, double>>& intervalVector = it->second;
-        for (const std::pair<double, double>& vecElement : intervalVector) {
-            if ((vecElement.first < et) && (vecElement.second > et)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return hasSpkCoverage(resolveBody(target), et);
+}
+
+bool SpiceManager::hasSpkCoverage(const BodyHandle& target, double et) const {
+    std::lock_guard lock(SpiceMutex);
+
+    return target.coverage != -1 &&
+           isCovered(_spkCoverages[target.coverage].intervals, et);
 }
 
 std::vector<std::pair<double, double>> SpiceManager::spkCoverage(
@@ -347,10 +419,11 @@ std::vector<std::pair<double, double>> SpiceManager::spkCoverage(
 {
     ghoul_assert(!target.empty(), "Empty target");
 
-    const int id = naifId(target);
-    const auto it = _spkIntervals.find(id);
-    if (it != _spkIntervals.end()) {
-        return it->second;
+    std::lock_guard lock(SpiceMutex);
+
+    const BodyHandle handle = resolveBody(target);
+    if (handle.coverage != -1) {
+        return _spkCoverages[handle.coverage].intervals;
     }
     else {
         std::vector<std::pair<double, double>> emptyList;
@@ -362,17 +435,11 @@ std::vector<std::pair<double, double>> SpiceManager::spkCoverage(
 bool SpiceManager::hasCkCoverage(const std::string& frame, double et) const {
     ghoul_assert(!frame.empty(), "Empty target");
 
-    const int id = frameId(frame);
-    const auto it = _ckIntervals.find(id);
-    if (it != _ckIntervals.end()) {
-        const std::vector<std::pair<double, double>>& intervalVector = it->second;
-        for (const std::pair<double, double>& i : intervalVector) {
-            if ((i.first < et) && (i.second > et)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    std::lock_guard lock(SpiceMutex);
+
+    const FrameHandle handle = resolveFrame(frame);
+    return handle.coverage != -1 &&
+           isCovered(_ckCoverages[handle.coverage].intervals, et);
 }
 
 std::vector<std::pair<double, double>> SpiceManager::ckCoverage(
@@ -380,16 +447,18 @@ std::vector<std::pair<double, double>> SpiceManager::ckCoverage(
 {
     ghoul_assert(!target.empty(), "Empty target");
 
+    std::lock_guard lock(SpiceMutex);
+
     int id = naifId(target);
-    const auto it = _ckIntervals.find(id);
-    if (it != _ckIntervals.end()) {
-        return it->second;
+    const auto it = _ckCoverageIndices.find(id);
+    if (it != _ckCoverageIndices.end()) {
+        return _ckCoverages[it->second].intervals;
     }
     else {
         id *= 1000;
-        const auto it2 = _ckIntervals.find(id);
-        if (it2 != _ckIntervals.end()) {
-            return it2->second;
+        const auto it2 = _ckCoverageIndices.find(id);
+        if (it2 != _ckCoverageIndices.end()) {
+            return _ckCoverages[it2->second].intervals;
         }
         else {
             std::vector<std::pair<double, double>> emptyList;
@@ -401,6 +470,8 @@ std::vector<std::pair<double, double>> SpiceManager::ckCoverage(
 std::vector<std::pair<int, std::string>> SpiceManager::spiceBodies(
                                                                  bool builtInFrames) const
 {
+    std::lock_guard lock(SpiceMutex);
+
     std::vector<std::pair<int, std::string>> bodies;
 
     constexpr const int Frnmln = 33;
@@ -444,6 +515,8 @@ std::vector<std::pair<int, std::string>> SpiceManager::spiceBodies(
 }
 
 bool SpiceManager::hasValue(int naifId, const std::string& item) const {
+    std::lock_guard lock(SpiceMutex);
+
     return bodfnd_c(naifId, item.c_str());
 }
 
@@ -458,6 +531,8 @@ bool SpiceManager::hasValue(const std::string& body, const std::string& item) co
 int SpiceManager::naifId(const std::string& body) const {
     ghoul_assert(!body.empty(), "Empty body");
 
+    std::lock_guard lock(SpiceMutex);
+
     SpiceBoolean success;
     SpiceInt id;
     bods2c_c(body.c_str(), &id, &success);
@@ -470,6 +545,8 @@ int SpiceManager::naifId(const std::string& body) const {
 bool SpiceManager::hasNaifId(const std::string& body) const {
     ghoul_assert(!body.empty(), "Empty body");
 
+    std::lock_guard lock(SpiceMutex);
+
     SpiceBoolean success;
     SpiceInt id;
     bods2c_c(body.c_str(), &id, &success);
@@ -480,6 +557,8 @@ bool SpiceManager::hasNaifId(const std::string& body) const {
 int SpiceManager::frameId(const std::string& frame) const {
     ghoul_assert(!frame.empty(), "Empty frame");
 
+    std::lock_guard lock(SpiceMutex);
+
     SpiceInt id;
     namfrm_c(frame.c_str(), &id);
     if (id == 0 && _useExceptions) {
@@ -491,11 +570,71 @@ int SpiceManager::frameId(const std::string& frame) const {
 bool SpiceManager::hasFrameId(const std::string& frame) const {
     ghoul_assert(!frame.empty(), "Empty frame");
 
+    std::lock_guard lock(SpiceMutex);
+
     SpiceInt id;
     namfrm_c(frame.c_str(), &id);
     return id != 0;
 }
 
+SpiceManager::BodyHandle SpiceManager::bodyHandle(const std::string& body) {
+    ghoul_assert(!body.empty(), "Empty body");
+
+    std::lock_guard lock(SpiceMutex);
+
+    // Adding an empty coverage means that the handle will see the coverage of kernels
+    // that are loaded after the handle was created
+    BodyHandle handle = resolveBody(body);
+    handle.coverage = coverageIndex(_spkCoverages, _spkCoverageIndices, handle.id);
+    return handle;
+}
+
+SpiceManager::FrameHandle SpiceManager::frameHandle(const std::string& frame) {
+    ghoul_assert(!frame.empty(), "Empty frame");
+
+    std::lock_guard lock(SpiceMutex);
+
+    FrameHandle handle = resolveFrame(frame);
+    handle.coverage = coverageIndex(_ckCoverages, _ckCoverageIndices, handle.id);
+    return handle;
+}
+
+SpiceManager::BodyHandle SpiceManager::resolveBody(const std::string& body) const {
+    BodyHandle handle;
+    handle.name = body;
+    handle.id = naifId(body);
+    const auto it = _spkCoverageIndices.find(handle.id);
+    if (it != _spkCoverageIndices.end()) {
+        handle.coverage = it->second;
+    }
+    return handle;
+}
+
+SpiceManager::FrameHandle SpiceManager::resolveFrame(const std::string& frame) const {
+    FrameHandle handle;
+    handle.name = frame;
+    handle.id = frameId(frame);
+    const auto it = _ckCoverageIndices.find(handle.id);
+    if (it != _ckCoverageIndices.end()) {
+        handle.coverage = it->second;
+    }
+    return handle;
+}
+
+int SpiceManager::coverageIndex(std::vector<Coverage>& coverages,
+                                std::unordered_map<int, int>& indices, int id)
+{
+    const auto it = indices.find(id);
+    if (it != indices.end()) {
+        return it->second;
+    }
+
+    const int index = static_cast<int>(coverages.size());
+    coverages.emplace_back();
+    indices[id] = index;
+    return index;
+}
+
 void getValueInternal(const std::string& body, const std::string& value, int size,
                       double* v)
 {
@@ -503,6 +642,8 @@ void getValueInternal(const std::string& body, const std::string& value, int siz
     ghoul_assert(!value.empty(), "Empty value");
     ghoul_assert(v != nullptr, "Empty value pointer");
 
+    std::lock_guard lock(SpiceMutex);
+
     SpiceInt n;
     bodvrd_c(body.c_str(), value.c_str(), size, &n, v);
 
@@ -548,6 +689,8 @@ void SpiceManager::getValue(const std::string& body, const std::string& value,
 double SpiceManager::spacecraftClockToET(const std::string& craft, double craftTicks) {
     ghoul_assert(!craft.empty(), "Empty craft");
 
+    std::lock_guard lock(SpiceMutex);
+
     int craftId = naifId(craft);
     double et;
     sct2e_c(craftId, craftTicks, &et);
@@ -566,6 +709,8 @@ double SpiceManager::ephemerisTimeFromDate(const std::string& timeString) const
 }
 
 double SpiceManager::ephemerisTimeFromDate(const char* timeString) const {
+    std::lock_guard lock(SpiceMutex);
+
     double et;
     str2et_c(timeString, &et);
     if (failed_c()) {
@@ -576,6 +721,8 @@ double SpiceManager::ephemerisTimeFromDate(const char* timeString) const {
 
 std::string SpiceManager::dateFromEphemerisTime(double ephemerisTime, const char* format)
 {
+    std::lock_guard lock(SpiceMutex);
+
     char Buffer[128];
     std::memset(Buffer, char(0), 128);
 
@@ -600,14 +747,54 @@ glm::dvec3 SpiceManager::targetPosition(const std::string& target,
     ghoul_assert(!observer.empty(), "Observer is not empty");
     ghoul_assert(!referenceFrame.empty(), "Reference frame is not empty");
 
-    bool targetHasCoverage = hasSpkCoverage(target, ephemerisTime);
-    bool observerHasCoverage = hasSpkCoverage(observer, ephemerisTime);
+    std::lock_guard lock(SpiceMutex);
+
+    // The reference frame is only passed by name, so its ID is not needed
+    FrameHandle frame;
+    frame.name = referenceFrame;
+    return targetPosition(
+        resolveBody(target),
+        resolveBody(observer),
+        frame,
+        aberrationCorrection,
+        ephemerisTime,
+        lightTime
+    );
+}
+
+glm::dvec3 SpiceManager::targetPosition(const std::string& target,
+                                        const std::string& observer,
+                                        const std::string& referenceFrame,
+                                        AberrationCorrection aberrationCorrection,
+                                        double ephemerisTime) const
+{
+    double unused = 0.0;
+    return targetPosition(
+        target,
+        observer,
+        referenceFrame,
+        aberrationCorrection,
+        ephemerisTime,
+        unused
+    );
+}
+
+glm::dvec3 SpiceManager::targetPosition(const BodyHandle& target,
+                                        const BodyHandle& observer,
+                                        const FrameHandle& referenceFrame,
+                                        AberrationCorrection aberrationCorrection,
+                                        double ephemerisTime, double& lightTime) const
+{
+    std::lock_guard lock(SpiceMutex);
+
+    const bool targetHasCoverage = hasSpkCoverage(target, ephemerisTime);
+    const bool observerHasCoverage = hasSpkCoverage(observer, ephemerisTime);
     if (!targetHasCoverage && !observerHasCoverage) {
         if (_useExceptions) {
             throw SpiceException(
                 fmt::format(
                     "Neither target '{}' nor observer '{}' has SPK coverage at time {}",
-                    target, observer, ephemerisTime
+                    target.name, observer.name, ephemerisTime
                 )
             );
         }
@@ -617,19 +804,19 @@ glm::dvec3 SpiceManager::targetPosition(const std::string& target,
     }
     else if (targetHasCoverage && observerHasCoverage) {
         glm::dvec3 position = glm::dvec3(0.0);
-        spkpos_c(
-            target.c_str(),
+        spkezp_c(
+            target.id,
             ephemerisTime,
-            referenceFrame.c_str(),
+            referenceFrame.name.c_str(),
             aberrationCorrection,
-            observer.c_str(),
+            observer.id,
             glm::value_ptr(position),
             &lightTime
         );
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error getting position from '{}' to '{}' in frame '{}' at time {}",
-                target, observer, referenceFrame, ephemerisTime
+                target.name, observer.name, referenceFrame.name, ephemerisTime
             ));
         }
         return position;
@@ -658,9 +845,9 @@ glm::dvec3 SpiceManager::targetPosition(const std::string& target,
     }
 }
 
-glm::dvec3 SpiceManager::targetPosition(const std::string& target,
-                                        const std::string& observer,
-                                        const std::string& referenceFrame,
+glm::dvec3 SpiceManager::targetPosition(const BodyHandle& target,
+                                        const BodyHandle& observer,
+                                        const FrameHandle& referenceFrame,
                                         AberrationCorrection aberrationCorrection,
                                         double ephemerisTime) const
 {
@@ -682,6 +869,8 @@ glm::dmat3 SpiceManager::frameTransformationMatrix(const std::string& from,
     ghoul_assert(!from.empty(), "From must not be empty");
     ghoul_assert(!to.empty(), "To must not be empty");
 
+    std::lock_guard lock(SpiceMutex);
+
     // get rotation matrix from frame A - frame B
     glm::dmat3 transform;
     pxform_c(
@@ -720,6 +909,8 @@ SpiceManager::SurfaceInterceptResult SpiceManager::surfaceIntercept(
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
     ghoul_assert(directionVector != glm::dvec3(0.0), "Direction vector must not be zero");
 
+    std::lock_guard lock(SpiceMutex);
+
     const std::string ComputationMethod = "ELLIPSOID";
 
     SurfaceInterceptResult result;
@@ -765,6 +956,8 @@ bool SpiceManager::isTargetInFieldOfView(const std::string& target,
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
     ghoul_assert(!instrument.empty(), "Instrument must not be empty");
 
+    std::lock_guard lock(SpiceMutex);
+
     int visible;
     fovtrg_c(instrument.c_str(),
         target.c_str(),
@@ -796,6 +989,8 @@ SpiceManager::TargetStateResult SpiceManager::targetState(const std::string& tar
     ghoul_assert(!observer.empty(), "Observer must not be empty");
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
 
+    std::lock_guard lock(SpiceMutex);
+
     TargetStateResult result;
     result.lightTime = 0.0;
 
@@ -832,6 +1027,8 @@ SpiceManager::TransformMatrix SpiceManager::stateTransformMatrix(
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "toFrame must not be empty");
 
+    std::lock_guard lock(SpiceMutex);
+
     TransformMatrix m;
     sxform_c(
         sourceFrame.c_str(),
@@ -856,6 +1053,8 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
 
+    std::lock_guard lock(SpiceMutex);
+
     glm::dmat3 result;
     pxform_c(
         sourceFrame.c_str(),
@@ -864,6 +1063,38 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
         reinterpret_cast<double(*)[3]>(glm::value_ptr(result))
     );
 
+    if (failed_c()) {
+        throwSpiceError("");
+    }
+    SpiceBoolean success = !(failed_c());
+    reset_c();
+    if (!success) {
+        result = getEstimatedTransformMatrix(
+            resolveFrame(sourceFrame),
+            resolveFrame(destinationFrame),
+            ephemerisTime
+        );
+    }
+
+    return glm::transpose(result);
+}
+
+glm::dmat3 SpiceManager::positionTransformMatrix(const FrameHandle& sourceFrame,
+                                                 const FrameHandle& destinationFrame,
+                                                 double ephemerisTime) const
+{
+    std::lock_guard lock(SpiceMutex);
+
+    // There is no variant of pxform_c that accepts frame IDs, so the frames are still
+    // passed by name
+    glm::dmat3 result;
+    pxform_c(
+        sourceFrame.name.c_str(),
+        destinationFrame.name.c_str(),
+        ephemerisTime,
+        reinterpret_cast<double(*)[3]>(glm::value_ptr(result))
+    );
+
     if (failed_c()) {
         throwSpiceError("");
     }
@@ -888,6 +1119,8 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
 
+    std::lock_guard lock(SpiceMutex);
+
     glm::dmat3 result;
 
     pxfrm2_c(
@@ -915,6 +1148,8 @@ SpiceManager::fieldOfView(const std::string& instrument) const
 }
 
 SpiceManager::FieldOfViewResult SpiceManager::fieldOfView(int instrument) const {
+    std::lock_guard lock(SpiceMutex);
+
     constexpr int MaxBoundsSize = 64;
     constexpr int BufferSize = 128;
 
@@ -976,6 +1211,8 @@ SpiceManager::TerminatorEllipseResult SpiceManager::terminatorEllipse(
     ghoul_assert(!lightSource.empty(), "Light source must not be empty");
     ghoul_assert(numberOfTerminatorPoints >= 1, "Terminator points must be >= 1");
 
+    std::lock_guard lock(SpiceMutex);
+
     TerminatorEllipseResult res;
 
     // Warning: This assumes std::vector<glm::dvec3> to have all values memory contiguous
@@ -1045,6 +1282,8 @@ void SpiceManager::findCkCoverage(const std::string& path) {
         // Get the number of intervals in the coverage window.
         const SpiceInt numberOfIntervals = wncard_c(&cover);
 
+        Coverage& coverage =
+            _ckCoverages[coverageIndex(_ckCoverages, _ckCoverageIndices, frame)];
         for (SpiceInt j = 0; j < numberOfIntervals; ++j) {
             // Get the endpoints of the jth interval.
             SpiceDouble b, e;
@@ -1053,10 +1292,11 @@ void SpiceManager::findCkCoverage(const std::string& path) {
                 throwSpiceError("Error finding Ck Coverage");
             }
 
-            _ckCoverageTimes[frame].insert(e);
-            _ckCoverageTimes[frame].insert(b);
-            _ckIntervals[frame].emplace_back(b, e);
+            coverage.times.push_back(e);
+            coverage.times.push_back(b);
+            coverage.intervals.emplace_back(b, e);
         }
+        sortCoverage(coverage.intervals, coverage.times);
     }
 }
 
@@ -1101,6 +1341,8 @@ void SpiceManager::findSpkCoverage(const std::string& path) {
         // Get the number of intervals in the coverage window.
         const SpiceInt numberOfIntervals = wncard_c(&cover);
 
+        Coverage& coverage =
+            _spkCoverages[coverageIndex(_spkCoverages, _spkCoverageIndices, obj)];
         for (SpiceInt j = 0; j < numberOfIntervals; ++j) {
             //Get the endpoints of the jth interval.
             SpiceDouble b, e;
@@ -1109,82 +1351,79 @@ void SpiceManager::findSpkCoverage(const std::string& path) {
                 throwSpiceError("Error finding Spk coverage");
             }
 
-            // insert all into coverage time set, the windows could be merged @AA
-            _spkCoverageTimes[obj].insert(e);
-            _spkCoverageTimes[obj].insert(b);
-            _spkIntervals[obj].emplace_back(b, e);
+            coverage.times.push_back(e);
+            coverage.times.push_back(b);
+            coverage.intervals.emplace_back(b, e);
         }
+        sortCoverage(coverage.intervals, coverage.times);
     }
 }
 
-glm::dvec3 SpiceManager::getEstimatedPosition(const std::string& target,
-                                              const std::string& observer,
-                                              const std::string& referenceFrame,
+glm::dvec3 SpiceManager::getEstimatedPosition(const BodyHandle& target,
+                                              const BodyHandle& observer,
+                                              const FrameHandle& referenceFrame,
                                               AberrationCorrection aberrationCorrection,
                                               double ephemerisTime,
                                               double& lightTime) const
 {
     ZoneScoped
 
-    ghoul_assert(!target.empty(), "Target must not be empty");
-    ghoul_assert(!observer.empty(), "Observer must not be empty");
-    ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
-    ghoul_assert(target != observer, "Target and observer must be different");
-
-    int targetId = naifId(target);
+    ghoul_assert(target.name != observer.name, "Target and observer must be different");
 
-    if (targetId == 0) {
+    if (target.id == 0) {
         // SOLAR SYSTEM BARYCENTER special case, no definition in kernels
         return glm::dvec3(0.0);
     }
 
-    if (_spkCoverageTimes.find(targetId) == _spkCoverageTimes.end()) {
+    if (target.coverage == -1 || _spkCoverages[target.coverage].times.empty()) {
         if (_useExceptions) {
             // no coverage
-            throw SpiceException(fmt::format("No position for '{}' at any time", target));
+            throw SpiceException(
+                fmt::format("No position for '{}' at any time", target.name)
+            );
         }
         else {
             return glm::dvec3();
         }
     }
 
-    const std::set<double>& coveredTimes = _spkCoverageTimes.find(targetId)->second;
-
-    glm::dvec3 pos = glm::dvec3(0.0);
-    if (coveredTimes.lower_bound(ephemerisTime) == coveredTimes.begin()) {
-        // coverage later, fetch first position
-        spkpos_c(
-            target.c_str(),
-            *(coveredTimes.begin()),
-            referenceFrame.c_str(),
+    const std::vector<double>& coveredTimes = _spkCoverages[target.coverage].times;
+    auto position = [&](double et, glm::dvec3& pos, double& lt) {
+        spkezp_c(
+            target.id,
+            et,
+            referenceFrame.name.c_str(),
             aberrationCorrection,
-            observer.c_str(),
+            observer.id,
             glm::value_ptr(pos),
-            &lightTime
+            &lt
         );
+    };
+
+    const auto lower =
+        std::lower_bound(coveredTimes.begin(), coveredTimes.end(), ephemerisTime);
+    const auto upper =
+        std::upper_bound(coveredTimes.begin(), coveredTimes.end(), ephemerisTime);
+
+    glm::dvec3 pos = glm::dvec3(0.0);
+    if (lower == coveredTimes.begin()) {
+        // coverage later, fetch first position
+        position(coveredTimes.front(), pos, lightTime);
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating position for '{}' with observer '{}' in frame '{}'",
-                target, observer, referenceFrame
+                target.name, observer.name, referenceFrame.name
             ));
         }
 
     }
-    else if (coveredTimes.upper_bound(ephemerisTime) == coveredTimes.end()) {
+    else if (upper == coveredTimes.end()) {
         // coverage earlier, fetch last position
-        spkpos_c(
-            target.c_str(),
-            *(coveredTimes.rbegin()),
-            referenceFrame.c_str(),
-            aberrationCorrection,
-            observer.c_str(),
-            glm::value_ptr(pos),
-            &lightTime
-        );
+        position(coveredTimes.back(), pos, lightTime);
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating position for '{}' with observer '{}' in frame '{}'",
-                target, observer, referenceFrame
+                target.name, observer.name, referenceFrame.name
             ));
         }
     }
@@ -1192,34 +1431,18 @@ glm::dvec3 SpiceManager::getEstimatedPosition(const std::string& target,
         // coverage both earlier and later, interpolate these positions
         glm::dvec3 posEarlier = glm::dvec3(0.0);
         double ltEarlier;
-        double timeEarlier = *std::prev((coveredTimes.lower_bound(ephemerisTime)));
-        spkpos_c(
-            target.c_str(),
-            timeEarlier,
-            referenceFrame.c_str(),
-            aberrationCorrection,
-            observer.c_str(),
-            glm::value_ptr(posEarlier),
-            &ltEarlier
-        );
+        double timeEarlier = *std::prev(lower);
+        position(timeEarlier, posEarlier, ltEarlier);
 
         glm::dvec3 posLater = glm::dvec3(0.0);
         double ltLater;
-        double timeLater = *(coveredTimes.upper_bound(ephemerisTime));
-        spkpos_c(
-            target.c_str(),
-            timeLater,
-            referenceFrame.c_str(),
-            aberrationCorrection,
-            observer.c_str(),
-            glm::value_ptr(posLater),
-            &ltLater
-        );
+        double timeLater = *upper;
+        position(timeLater, posLater, ltLater);
 
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating position for '{}' with observer '{}' in frame '{}'",
-                target, observer, referenceFrame
+                target.name, observer.name, referenceFrame.name
             ));
         }
 
@@ -1232,19 +1455,18 @@ glm::dvec3 SpiceManager::getEstimatedPosition(const std::string& target,
     return pos;
 }
 
-glm::dmat3 SpiceManager::getEstimatedTransformMatrix(const std::string& fromFrame,
-                                                     const std::string& toFrame,
+glm::dmat3 SpiceManager::getEstimatedTransformMatrix(const FrameHandle& fromFrame,
+                                                     const FrameHandle& toFrame,
                                                      double time) const
 {
     glm::dmat3 result = glm::dmat3(1.0);
-    const int idFrame = frameId(fromFrame);
 
-    if (_ckCoverageTimes.find(idFrame) == _ckCoverageTimes.end()) {
+    if (fromFrame.coverage == -1 || _ckCoverages[fromFrame.coverage].times.empty()) {
         if (_useExceptions) {
             // no coverage
             throw SpiceException(fmt::format(
                 "No data available for transform matrix from '{}' to '{}' at any time",
-                fromFrame, toFrame
+                fromFrame.name, toFrame.name
             ));
         }
         else {
@@ -1252,68 +1474,59 @@ glm::dmat3 SpiceManager::getEstimatedTransformMatrix(const std::string& fromFram
         }
     }
 
-    std::set<double> coveredTimes = _ckCoverageTimes.find(idFrame)->second;
-
-    if (coveredTimes.lower_bound(time) == coveredTimes.begin()) {
-        // coverage later, fetch first transform
+    const std::vector<double>& coveredTimes = _ckCoverages[fromFrame.coverage].times;
+    auto transform = [&](double t, glm::dmat3& m) {
         pxform_c(
-            fromFrame.c_str(),
-            toFrame.c_str(),
-            *(coveredTimes.begin()),
-            reinterpret_cast<double(*)[3]>(glm::value_ptr(result))
+            fromFrame.name.c_str(),
+            toFrame.name.c_str(),
+            t,
+            reinterpret_cast<double(*)[3]>(glm::value_ptr(m))
         );
+    };
+
+    const auto lower = std::lower_bound(coveredTimes.begin(), coveredTimes.end(), time);
+    const auto upper = std::upper_bound(coveredTimes.begin(), coveredTimes.end(), time);
+
+    if (lower == coveredTimes.begin()) {
+        // coverage later, fetch first transform
+        transform(coveredTimes.front(), result);
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating transform matrix from '{}' to from '{}' at time '{}'",
-                fromFrame, toFrame, time
+                fromFrame.name, toFrame.name, time
             ));
         }
     }
-    else if (coveredTimes.upper_bound(time) == coveredTimes.end()) {
+    else if (upper == coveredTimes.end()) {
         // coverage earlier, fetch last transform
-        pxform_c(
-            fromFrame.c_str(),
-            toFrame.c_str(),
-            *(coveredTimes.rbegin()),
-            reinterpret_cast<double(*)[3]>(glm::value_ptr(result))
-        );
+        transform(coveredTimes.back(), result);
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating transform matrix from frame '{}' to '{}' at time '{}'",
-                fromFrame, toFrame, time
+                fromFrame.name, toFrame.name, time
             ));
         }
     }
     else {
         // coverage both earlier and later, interpolate these transformations
-        double earlier = *std::prev((coveredTimes.lower_bound(time)));
-        double later = *(coveredTimes.upper_bound(time));
+        double earlier = *std::prev(lower);
+        double later = *upper;
 
         glm::dmat3 earlierTransform = glm::dmat3(1.0);
-        pxform_c(
-            fromFrame.c_str(),
-            toFrame.c_str(),
-            earlier,
-            reinterpret_cast<double(*)[3]>(glm::value_ptr(earlierTransform))
-        );
+        transform(earlier, earlierTransform);
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating transform matrix from frame '{}' to '{}' at time '{}'",
-                fromFrame, toFrame, time
+                fromFrame.name, toFrame.name, time
             ));
         }
 
         glm::dmat3 laterTransform = glm::dmat3(1.0);
-        pxform_c(
-            fromFrame.c_str(),
-            toFrame.c_str(),
-            later,
-            reinterpret_cast<double(*)[3]>(glm::value_ptr(laterTransform))
-        );
+        transform(later, laterTransform);
         if (failed_c()) {
             throwSpiceError(fmt::format(
                 "Error estimating transform matrix from frame '{}' to '{}' at time '{}'",
-                fromFrame, toFrame, time
+                fromFrame.name, toFrame.name, time
             ));
         }
 
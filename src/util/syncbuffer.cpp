@@ -25,6 +25,7 @@
 #include <openspace/util/syncbuffer.h>
 
 #include <ghoul/misc/profiling.h>
+#include <algorithm>
 
 namespace openspace {
 
@@ -39,14 +40,9 @@ SyncBuffer::~SyncBuffer() {} // NOLINT
 void SyncBuffer::encode(const std::string& s) {
     ZoneScoped
 
-    int32_t anticpatedBufferSize = static_cast<int32_t>(
-        _encodeOffset + (sizeof(char) * s.size()) + sizeof(int32_t)
-    );
-    if (anticpatedBufferSize >= static_cast<int32_t>(_n)) {
-        _dataStream.resize(anticpatedBufferSize);
-    }
-
     int32_t length = static_cast<int32_t>(s.size() * sizeof(char));
+    reserve(sizeof(int32_t) + length);
+
     memcpy(
         _dataStream.data() + _encodeOffset,
         reinterpret_cast<const char*>(&length),
@@ -63,15 +59,14 @@ std::string SyncBuffer::decode() {
     int32_t length;
     memcpy(
         reinterpret_cast<char*>(&length),
-        _dataStream.data() + _decodeOffset,
+        _decodeData + _decodeOffset,
         sizeof(int32_t)
     );
-    std::vector<char> tmp(length + 1);
     _decodeOffset += sizeof(int32_t);
-    memcpy(tmp.data(), _dataStream.data() + _decodeOffset, length);
+    ghoul_assert(_decodeOffset + length <= _decodeSize, "Reading past the end of buffer");
+
+    std::string ret(reinterpret_cast<const char*>(_decodeData + _decodeOffset), length);
     _decodeOffset += length;
-    tmp[length] = '\0';
-    std::string ret(tmp.data());
     return ret;
 }
 
@@ -81,46 +76,86 @@ void SyncBuffer::decode(std::string& s) {
 
 void SyncBuffer::decode(glm::quat& value) {
     const size_t size = sizeof(glm::quat);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeSize, "Reading past the end of buffer");
+    std::memcpy(glm::value_ptr(value), _decodeData + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::decode(glm::dquat& value) {
     const size_t size = sizeof(glm::dquat);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeSize, "Reading past the end of buffer");
+    std::memcpy(glm::value_ptr(value), _decodeData + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::decode(glm::vec3& value) {
     const size_t size = sizeof(glm::vec3);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeSize, "Reading past the end of buffer");
+    std::memcpy(glm::value_ptr(value), _decodeData + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::decode(glm::dvec3& value) {
     const size_t size = sizeof(glm::dvec3);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeSize, "Reading past the end of buffer");
+    std::memcpy(glm::value_ptr(value), _decodeData + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::setData(std::vector<std::byte> data) {
     _dataStream = std::move(data);
+    _decodeData = _dataStream.data();
+    _decodeSize = _dataStream.size();
+    _decodeOffset = 0;
+}
+
+void SyncBuffer::setData(SyncBufferView data) {
+    _decodeData = data.data;
+    _decodeSize = data.size;
+    _decodeOffset = 0;
 }
 
 std::vector<std::byte> SyncBuffer::data() {
-    _dataStream.resize(_encodeOffset);
+    return std::vector<std::byte>(
+        _dataStream.begin(),
+        _dataStream.begin() + _encodeOffset
+    );
+}
 
-    return _dataStream;
+SyncBufferView SyncBuffer::view() const {
+    return { _dataStream.data(), _encodeOffset };
+}
+
+size_t SyncBuffer::encodedSize() const {
+    return _encodeOffset;
+}
+
+void SyncBuffer::truncate(size_t size) {
+    ghoul_assert(size <= _encodeOffset, "Cannot truncate past the encoded bytes");
+    _encodeOffset = size;
+}
+
+bool SyncBuffer::isFullyDecoded() const {
+    return _decodeOffset == _decodeSize;
 }
 
 void SyncBuffer::reset() {
-    _dataStream.resize(_n);
+    // The encoded bytes are left in place, so that the memory is reused between frames
+    if (_dataStream.size() < _n) {
+        _dataStream.resize(_n);
+    }
     _encodeOffset = 0;
     _decodeOffset = 0;
+    _decodeData = nullptr;
+    _decodeSize = 0;
+}
+
+void SyncBuffer::reserve(size_t nBytes) {
+    const size_t anticipatedBufferSize = _encodeOffset + nBytes;
+    if (anticipatedBufferSize > _dataStream.size()) {
+        // Grow geometrically so that a growing payload does not reallocate every frame
+        _dataStream.resize(std::max(anticipatedBufferSize, 2 * _dataStream.size()));
+    }
 }
 
 } // namespace openspace
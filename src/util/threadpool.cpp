@@ -24,79 +24,363 @@
 
 #include <openspace/util/threadpool.h>
 
-namespace openspace {
+#include <algorithm>
+#include <iterator>
+#include <limits>
 
-Worker::Worker(ThreadPool& p) : pool(p) {}
+namespace {
+    constexpr const size_t NoWorker = std::numeric_limits<size_t>::max();
 
-void Worker::operator()() {
-    std::function<void()> task;
-    while (true) {
-        // acquire lock
-        {
-            std::unique_lock<std::mutex> lock(pool.queue_mutex);
+    // The pool and the worker index that the current thread belongs to, or nullptr and
+    // NoWorker if the current thread is not a worker thread
+    thread_local const openspace::ThreadPool* CurrentPool = nullptr;
+    thread_local size_t CurrentWorker = NoWorker;
+} // namespace
 
-            // look for a work item
-            while (!pool.stop && pool.tasks.empty()) {
-                // if there are none wait for notification
-                pool.condition.wait(lock);
-            }
+namespace openspace {
 
-            if (pool.stop) { // exit if the pool is stopped
-                return;
-            }
+struct ThreadPool::TaskHandle::State {
+    explicit State(size_t nTasks) : remaining(nTasks) {}
 
-            // get the task from the queue
-            task = pool.tasks.front();
-            pool.tasks.pop_front();
+    std::atomic<size_t> remaining;
+    std::atomic_bool isCancelled = false;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::pair<QueuedTask, Priority>> continuations;
+};
 
-        } // release lock
+bool ThreadPool::TaskHandle::isFinished() const {
+    return !_state || _state->remaining.load() == 0;
+}
 
-        // execute the task
-        task();
-    }
+bool ThreadPool::TaskHandle::isValid() const {
+    return _state != nullptr;
 }
 
-ThreadPool::ThreadPool(size_t numThreads) : stop(false) {
+bool ThreadPool::TaskHandle::isCancelled() const {
+    return _state && _state->isCancelled.load();
+}
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    // Even without any workers we need a queue to store the enqueued tasks in
+    const size_t nQueues = std::max<size_t>(numThreads, 1);
+    _queues.reserve(nQueues);
+    for (size_t i = 0; i < nQueues; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    _workers.reserve(numThreads);
     for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(std::thread(Worker(*this)));
+        _workers.emplace_back([this, i]() { workerLoop(i); });
     }
 }
 
-ThreadPool::ThreadPool(const ThreadPool& toCopy) : ThreadPool(toCopy.workers.size()) {}
+ThreadPool::ThreadPool(const ThreadPool& toCopy) : ThreadPool(toCopy._workers.size()) {}
 
-// the destructor joins all threads
 ThreadPool::~ThreadPool() {
-    // stop all threads
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
     }
-    condition.notify_all();
+    _condition.notify_all();
 
-    // join them
-    for (std::thread& w : workers) {
+    for (std::thread& w : _workers) {
         w.join();
     }
 }
 
-// add new work item to the pool
-void ThreadPool::enqueue(std::function<void()> f) {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
+void ThreadPool::enqueue(std::function<void()> f, Priority priority) {
+    push({ std::move(f), nullptr }, priority);
+}
 
-        // add the task
-        tasks.push_back(std::move(f));
-    } // release lock
+ThreadPool::TaskHandle ThreadPool::submit(std::function<void()> f, Priority priority) {
+    TaskHandle handle;
+    handle._state = std::make_shared<TaskHandle::State>(1);
 
-    // wake up one thread
-    condition.notify_one();
+    push({ std::move(f), handle._state }, priority);
+    return handle;
+}
+
+ThreadPool::TaskHandle ThreadPool::then(const TaskHandle& handle,
+                                        std::function<void()> f, Priority priority)
+{
+    TaskHandle result;
+    result._state = std::make_shared<TaskHandle::State>(1);
+
+    QueuedTask continuation = { std::move(f), result._state };
+
+    if (handle._state) {
+        std::lock_guard<std::mutex> lock(handle._state->mutex);
+        if (handle._state->remaining > 0) {
+            handle._state->continuations.emplace_back(
+                std::move(continuation),
+                priority
+            );
+            return result;
+        }
+    }
+
+    if (handle.isCancelled()) {
+        finish(result._state, true);
+    }
+    else {
+        push(std::move(continuation), priority);
+    }
+    return result;
+}
+
+void ThreadPool::wait(const TaskHandle& handle) {
+    if (!handle._state) {
+        return;
+    }
+
+    if (CurrentPool == this) {
+        // We are on one of our own worker threads, so blocking here could starve the
+        // pool. Instead we keep executing other tasks until the handle is finished and
+        // only go to sleep if there is nothing left to run. We are woken up again by
+        // new tasks or by the finishing of any handle
+        while (!handle.isFinished()) {
+            if (tryRunPendingTask(CurrentWorker)) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            ++_nSleepingWorkers;
+            ++_nWaitingWorkers;
+            _condition.wait(
+                lock,
+                [&]() { return _nPendingTasks > 0 || handle.isFinished(); }
+            );
+            --_nWaitingWorkers;
+            --_nSleepingWorkers;
+        }
+    }
+    else {
+        std::unique_lock<std::mutex> lock(handle._state->mutex);
+        handle._state->condition.wait(lock, [&]() { return handle.isFinished(); });
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end,
+                             const std::function<void(size_t)>& f, size_t grainSize)
+{
+    if (begin >= end) {
+        return;
+    }
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t nChunks = (end - begin + grainSize - 1) / grainSize;
+
+    auto state = std::make_shared<TaskHandle::State>(nChunks);
+    for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+        const size_t b = begin + chunk * grainSize;
+        const size_t e = std::min(b + grainSize, end);
+        push(
+            {
+                [&f, b, e]() {
+                    for (size_t i = b; i < e; ++i) {
+                        f(i);
+                    }
+                },
+                state
+            },
+            Priority::Normal
+        );
+    }
+
+    // The calling thread helps out with its own chunks until there are none left to
+    // grab. At that point all of them are either running on a worker or were removed,
+    // so it is safe to block until the running ones have finished
+    const size_t index = (CurrentPool == this) ? CurrentWorker : NoWorker;
+    while (tryRunOwnTask(index, state)) {}
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&]() { return state->remaining == 0; });
 }
 
 void ThreadPool::clearTasks() {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.clear();
-    } // release lock
+    std::vector<std::shared_ptr<TaskHandle::State>> cancelled;
+    for (const std::unique_ptr<WorkerQueue>& queue : _queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        for (std::deque<QueuedTask>& tasks : queue->tasks) {
+            _nPendingTasks -= tasks.size();
+            for (QueuedTask& task : tasks) {
+                if (task.state) {
+                    cancelled.push_back(std::move(task.state));
+                }
+            }
+            tasks.clear();
+        }
+    }
+
+    // The handles are finished outside of the queue locks as finishing them might push
+    // continuations or wake up threads that immediately enqueue new tasks
+    for (const std::shared_ptr<TaskHandle::State>& state : cancelled) {
+        finish(state, true);
+    }
+}
+
+size_t ThreadPool::numThreads() const {
+    return _workers.size();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool Pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return Pool;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    CurrentPool = this;
+    CurrentWorker = index;
+
+    while (!_stop) {
+        if (tryRunPendingTask(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        ++_nSleepingWorkers;
+        _condition.wait(lock, [this]() { return _stop || _nPendingTasks > 0; });
+        --_nSleepingWorkers;
+    }
+}
+
+void ThreadPool::push(QueuedTask task, Priority priority) {
+    const size_t index = (CurrentPool == this) ?
+        CurrentWorker :
+        _nextQueue.fetch_add(1) % _queues.size();
+
+    // The counter is incremented before the task becomes visible so that it can never
+    // drop below zero when another worker picks up the task right away
+    ++_nPendingTasks;
+    {
+        WorkerQueue& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks[static_cast<int>(priority)].push_back(std::move(task));
+    }
+
+    if (_nSleepingWorkers > 0) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _condition.notify_one();
+    }
+}
+
+bool ThreadPool::tryPop(size_t index, QueuedTask& task) {
+    WorkerQueue& queue = *_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (std::deque<QueuedTask>& tasks : queue.tasks) {
+        if (!tasks.empty()) {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            --_nPendingTasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::trySteal(size_t index, QueuedTask& task) {
+    const size_t nQueues = _queues.size();
+    const size_t start = (index == NoWorker) ? 0 : index + 1;
+    for (size_t i = 0; i < nQueues; ++i) {
+        const size_t victim = (start + i) % nQueues;
+        if (victim == index) {
+            continue;
+        }
+
+        WorkerQueue& queue = *_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (std::deque<QueuedTask>& tasks : queue.tasks) {
+            if (!tasks.empty()) {
+                // Steal from the opposite end than the owner to reduce the interference
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                --_nPendingTasks;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::tryRunOwnTask(size_t index,
+                               const std::shared_ptr<TaskHandle::State>& state)
+{
+    QueuedTask task;
+    bool hasTask = false;
+    const size_t nQueues = _queues.size();
+    const size_t start = (index == NoWorker) ? 0 : index;
+    for (size_t i = 0; i < nQueues && !hasTask; ++i) {
+        WorkerQueue& queue = *_queues[(start + i) % nQueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        std::deque<QueuedTask>& tasks = queue.tasks[static_cast<int>(Priority::Normal)];
+        auto it = std::find_if(
+            tasks.rbegin(),
+            tasks.rend(),
+            [&state](const QueuedTask& t) { return t.state == state; }
+        );
+        if (it != tasks.rend()) {
+            task = std::move(*it);
+            tasks.erase(std::next(it).base());
+            --_nPendingTasks;
+            hasTask = true;
+        }
+    }
+
+    if (hasTask) {
+        task.task();
+        finish(task.state, false);
+    }
+    return hasTask;
+}
+
+bool ThreadPool::tryRunPendingTask(size_t index) {
+    QueuedTask task;
+    const bool hasTask =
+        (index != NoWorker && tryPop(index, task)) || trySteal(index, task);
+    if (hasTask) {
+        task.task();
+        if (task.state) {
+            finish(task.state, false);
+        }
+    }
+    return hasTask;
+}
+
+void ThreadPool::finish(const std::shared_ptr<TaskHandle::State>& state,
+                        bool isCancelled)
+{
+    if (isCancelled) {
+        state->isCancelled = true;
+    }
+    if (--state->remaining > 0) {
+        return;
+    }
+
+    std::vector<std::pair<QueuedTask, Priority>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        continuations = std::move(state->continuations);
+    }
+    state->condition.notify_all();
+
+    // Workers that are waiting for a handle are sleeping on the pool's condition
+    if (_nWaitingWorkers > 0) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _condition.notify_all();
+    }
+
+    // Continuations of a cancelled task are cancelled as well, as whatever they depend
+    // on has never been executed
+    const bool cancelContinuations = state->isCancelled;
+    for (std::pair<QueuedTask, Priority>& c : continuations) {
+        if (cancelContinuations) {
+            finish(c.first.state, true);
+        }
+        else {
+            push(std::move(c.first), c.second);
+        }
+    }
 }
 
 } // namespace openspace
@@ -127,3 +127,27 @@ TEST_CASE("ConcurrentJobmanager: Job Creation", "[concurrentjobmanager]") {
         auto product = finishedJob->product();
     }
 }
+
+TEST_CASE("ConcurrentJobmanager: Jobs Beyond Capacity", "[concurrentjobmanager]") {
+    using namespace openspace;
+
+    // None of the finished jobs are popped while they are executed, so the workers must
+    // not wait for room to store them in
+    constexpr const int NJobs = 3000;
+    ConcurrentJobManager<int> jobManager(ThreadPool(2));
+    for (int i = 0; i < NJobs; ++i) {
+        jobManager.enqueueJob(std::make_shared<TestJob>(0));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    while (jobManager.numFinishedJobs() < NJobs &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    {
+        std::this_thread::yield();
+    }
+    REQUIRE(jobManager.numFinishedJobs() == NJobs);
+
+    std::vector<std::shared_ptr<Job<int>>> jobs;
+    REQUIRE(jobManager.popFinishedJobs(jobs) == NJobs);
+    REQUIRE(jobs.back()->product() == 1337);
+}
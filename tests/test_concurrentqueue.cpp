@@ -25,6 +25,10 @@
 #include "catch2/catch.hpp"
 
 #include <openspace/util/concurrentqueue.h>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
 
 TEST_CASE("ConcurrentQueue: Basic", "[concurrentqueue]") {
     using namespace openspace;
@@ -34,3 +38,190 @@ TEST_CASE("ConcurrentQueue: Basic", "[concurrentqueue]") {
     int val = q1.pop();
     REQUIRE(val == 4);
 }
+
+TEST_CASE("BoundedConcurrentQueue: Basic", "[concurrentqueue]") {
+    using namespace openspace;
+
+    BoundedConcurrentQueue<int> q(3);
+    REQUIRE(q.capacity() == 4);
+    REQUIRE(q.empty());
+    REQUIRE_FALSE(q.tryPop().has_value());
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(q.tryPush(i));
+    }
+    REQUIRE(q.size() == 4);
+    REQUIRE_FALSE(q.tryPush(4));
+
+    int val = -1;
+    REQUIRE(q.tryPop(val));
+    REQUIRE(val == 0);
+    REQUIRE(q.tryPush(4));
+
+    std::vector<int> items;
+    REQUIRE(q.drain(items, 2) == 2);
+    REQUIRE(items == std::vector<int>{ 1, 2 });
+    REQUIRE(q.drain(items) == 2);
+    REQUIRE(items == std::vector<int>{ 1, 2, 3, 4 });
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("BoundedConcurrentQueue: Move Only On Success", "[concurrentqueue]") {
+    using namespace openspace;
+
+    BoundedConcurrentQueue<std::shared_ptr<int>> q(2);
+    REQUIRE(q.tryPush(std::make_shared<int>(1)));
+    REQUIRE(q.tryPush(std::make_shared<int>(2)));
+
+    auto item = std::make_shared<int>(3);
+    REQUIRE_FALSE(q.tryPush(std::move(item)));
+    REQUIRE(item != nullptr);
+
+    std::optional<std::shared_ptr<int>> popped = q.tryPop();
+    REQUIRE(popped.has_value());
+    REQUIRE(**popped == 1);
+}
+
+TEST_CASE("BoundedConcurrentQueue: Stress", "[concurrentqueue]") {
+    using namespace openspace;
+
+    constexpr const int NProducers = 4;
+    constexpr const int NConsumers = 4;
+    constexpr const int NItemsPerProducer = 100000;
+
+    BoundedConcurrentQueue<int> q(64);
+    std::vector<std::atomic<int>> seen(NProducers * NItemsPerProducer);
+    std::atomic<int> nConsumed = 0;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < NProducers; ++p) {
+        threads.emplace_back([&q, p]() {
+            for (int i = 0; i < NItemsPerProducer; ++i) {
+                const int value = p * NItemsPerProducer + i;
+                while (!q.tryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < NConsumers; ++c) {
+        // Half of the consumers pop single items, the other half drain in batches
+        threads.emplace_back([&, c]() {
+            std::vector<int> batch;
+            while (nConsumed < NProducers * NItemsPerProducer) {
+                batch.clear();
+                if (c % 2 == 0) {
+                    int value;
+                    if (q.tryPop(value)) {
+                        batch.push_back(value);
+                    }
+                }
+                else {
+                    q.drain(batch, 16);
+                }
+
+                for (int value : batch) {
+                    seen[value]++;
+                }
+                nConsumed += static_cast<int>(batch.size());
+                if (batch.empty()) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    REQUIRE(q.empty());
+    const bool allSeenOnce = std::all_of(
+        seen.begin(),
+        seen.end(),
+        [](const std::atomic<int>& s) { return s == 1; }
+    );
+    REQUIRE(allSeenOnce);
+}
+
+TEST_CASE("BoundedConcurrentQueue: Order Per Producer", "[concurrentqueue]") {
+    using namespace openspace;
+
+    constexpr const int NItems = 200000;
+    BoundedConcurrentQueue<int> q(128);
+
+    std::thread producer([&q]() {
+        for (int i = 0; i < NItems; ++i) {
+            while (!q.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool isInOrder = true;
+    std::vector<int> batch;
+    while (expected < NItems) {
+        batch.clear();
+        q.drain(batch);
+        for (int value : batch) {
+            isInOrder &= (value == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    REQUIRE(isInOrder);
+}
+
+TEST_CASE("SpillingConcurrentQueue: Overflow", "[concurrentqueue]") {
+    using namespace openspace;
+
+    SpillingConcurrentQueue<int> q(4);
+    for (int i = 0; i < 10; ++i) {
+        q.push(i);
+    }
+    REQUIRE(q.size() == 10);
+
+    int val = -1;
+    REQUIRE(q.tryPop(val));
+    REQUIRE(val == 0);
+
+    // Items that did not fit in the bounded part are returned after the ones that did
+    std::vector<int> items;
+    REQUIRE(q.drain(items, 5) == 5);
+    REQUIRE(items == std::vector<int>{ 1, 2, 3, 4, 5 });
+    q.push(10);
+    REQUIRE(q.drain(items) == 5);
+    REQUIRE(items == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 });
+    REQUIRE(q.empty());
+    REQUIRE_FALSE(q.tryPop(val));
+}
+
+TEST_CASE("SpillingConcurrentQueue: Producers Without Consumer", "[concurrentqueue]") {
+    using namespace openspace;
+
+    // Nobody is popping while the producers are running, so they would never finish if
+    // pushing had to wait for room in the bounded part
+    constexpr const int NProducers = 4;
+    constexpr const int NItemsPerProducer = 10000;
+    SpillingConcurrentQueue<int> q(64);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < NProducers; ++p) {
+        producers.emplace_back([&q, p]() {
+            for (int i = 0; i < NItemsPerProducer; ++i) {
+                q.push(p * NItemsPerProducer + i);
+            }
+        });
+    }
+    for (std::thread& t : producers) {
+        t.join();
+    }
+    REQUIRE(q.size() == NProducers * NItemsPerProducer);
+
+    std::vector<int> items;
+    q.drain(items);
+    std::sort(items.begin(), items.end());
+    std::vector<int> expected(NProducers * NItemsPerProducer);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(items == expected);
+}
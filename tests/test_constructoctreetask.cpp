@@ -0,0 +1,194 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_GAIA_ENABLED
+
+#include "catch2/catch.hpp"
+
+#include <modules/gaia/rendering/octreemanager.h>
+#include <modules/gaia/tasks/constructoctreetask.h>
+#include <ghoul/filesystem/directory.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/misc/dictionary.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr const int32_t ValuesPerStar = 8;
+    constexpr const int MaxDist = 10;
+
+    std::string folder(const std::string& name) {
+        const std::string path = absPath("${TESTDIR}/constructoctreetask/" + name) + "/";
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        return path;
+    }
+
+    // Writes nFiles files with random stars in the format produced by ReadFitsTask. The
+    // stars of all files are spread over all branches of the Octree
+    void createDataset(const std::string& path, size_t nStars, size_t nFiles) {
+        std::mt19937 gen(static_cast<unsigned int>(nStars));
+        std::normal_distribution<float> position(0.f, MaxDist / 8.f);
+        std::uniform_real_distribution<float> magnitude(-5.f, 20.f);
+        std::uniform_real_distribution<float> other(-1.f, 1.f);
+
+        constexpr const float Limit = 0.99f * MaxDist;
+        std::vector<float> values;
+        for (size_t f = 0; f < nFiles; ++f) {
+            const size_t nFileStars = nStars / nFiles + (f < nStars % nFiles ? 1 : 0);
+            values.resize(nFileStars * ValuesPerStar);
+            for (size_t i = 0; i < nFileStars; ++i) {
+                float* star = values.data() + i * ValuesPerStar;
+                for (int c = 0; c < 3; ++c) {
+                    star[c] = std::clamp(position(gen), -Limit, Limit);
+                }
+                star[3] = magnitude(gen);
+                for (int c = 4; c < ValuesPerStar; ++c) {
+                    star[c] = other(gen);
+                }
+            }
+
+            std::ofstream file(
+                fmt::format("{}octant_{}.bin", path, f),
+                std::ofstream::binary
+            );
+            file.write(reinterpret_cast<const char*>(&ValuesPerStar), sizeof(int32_t));
+            file.write(
+                reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(float)
+            );
+        }
+    }
+
+    // Constructs the Octree on a single thread by inserting all stars into one
+    // OctreeManager in the order in which they are stored in the files
+    void constructSerially(const std::string& inPath, const std::string& outPath,
+                           int maxStarsPerNode)
+    {
+        using namespace openspace;
+
+        OctreeManager octree;
+        octree.initOctree(0, MaxDist, maxStarsPerNode);
+
+        ghoul::filesystem::Directory dir(inPath);
+        for (const std::string& file : dir.readFiles()) {
+            std::ifstream stream(file, std::ifstream::binary);
+            int32_t nValuesPerStar = 0;
+            stream.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
+            std::vector<float> star(nValuesPerStar);
+            while (stream.read(
+                reinterpret_cast<char*>(star.data()),
+                nValuesPerStar * sizeof(float)
+            ))
+            {
+                octree.insert(star);
+            }
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            octree.sliceLodData(i);
+            octree.writeToMultipleFiles(outPath, i);
+        }
+        std::ofstream index(outPath + "index.bin", std::ofstream::binary);
+        octree.writeToFile(index, false);
+    }
+
+    void constructWithTask(const std::string& inPath, const std::string& outPath,
+                           int maxStarsPerNode, int threads, int memoryBudget)
+    {
+        ghoul::Dictionary dictionary;
+        dictionary.setValue("InFileOrFolderPath", inPath);
+        dictionary.setValue("OutFileOrFolderPath", outPath);
+        dictionary.setValue("MaxDist", static_cast<double>(MaxDist));
+        dictionary.setValue("MaxStarsPerNode", static_cast<double>(maxStarsPerNode));
+        dictionary.setValue("SingleFileInput", false);
+        dictionary.setValue("ThreadsToUse", static_cast<double>(threads));
+        dictionary.setValue("MemoryBudget", static_cast<double>(memoryBudget));
+
+        openspace::ConstructOctreeTask task(dictionary);
+        task.perform([](float) {});
+    }
+
+    std::vector<char> readFile(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ifstream::binary);
+        return std::vector<char>(
+            std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>()
+        );
+    }
+
+    void compareFolders(const std::filesystem::path& expected,
+                        const std::filesystem::path& actual)
+    {
+        size_t nExpected = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(expected)) {
+            const std::filesystem::path name = entry.path().filename();
+            INFO(name.string());
+            REQUIRE(std::filesystem::exists(actual / name));
+            CHECK(readFile(entry.path()) == readFile(actual / name));
+            nExpected++;
+        }
+
+        const size_t nActual = std::distance(
+            std::filesystem::directory_iterator(actual),
+            std::filesystem::directory_iterator()
+        );
+        // No spill files are left behind
+        CHECK(nActual == nExpected);
+    }
+} // namespace
+
+TEST_CASE("ConstructOctreeTask: Parallel Construction Matches Serial", "[gaia]") {
+    const std::string input = folder("parallel/input");
+    createDataset(input, 200000, 5);
+
+    const std::string expected = folder("parallel/expected");
+    constructSerially(input, expected, 500);
+
+    const std::string actual = folder("parallel/actual");
+    constructWithTask(input, actual, 500, 4, 1024);
+    compareFolders(expected, actual);
+}
+
+TEST_CASE("ConstructOctreeTask: Spilled Construction Matches Serial", "[gaia]") {
+    const std::string input = folder("spilled/input");
+    createDataset(input, 200000, 8);
+
+    const std::string expected = folder("spilled/expected");
+    constructSerially(input, expected, 500);
+
+    // 200000 stars need about 6 MB, so a budget of 1 MB spills them multiple times and
+    // only lets a single branch be constructed at a time
+    const std::string actual = folder("spilled/actual");
+    constructWithTask(input, actual, 500, 8, 1);
+    compareFolders(expected, actual);
+}
+
+#endif // OPENSPACE_MODULE_GAIA_ENABLED
@@ -0,0 +1,234 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/disktilecache.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    TileTextureInitData initData(size_t tileSize = 64) {
+        return tileTextureInitData(layergroupid::GroupID::ColorLayers, false, tileSize);
+    }
+
+    RawTile createTile(const TileIndex& index, const TileTextureInitData& data,
+                       uint8_t value)
+    {
+        RawTile tile;
+        tile.imageData = std::unique_ptr<std::byte[]>(new std::byte[data.totalNumBytes]);
+        std::memset(tile.imageData.get(), value, data.totalNumBytes);
+        tile.tileMetaData.maxValues = { 1.f, 2.f, 3.f, 4.f };
+        tile.tileMetaData.minValues = { -1.f, -2.f, -3.f, -4.f };
+        tile.tileMetaData.hasMissingData = { false, true, false, true };
+        tile.tileMetaData.nValues = 4;
+        tile.textureInitData = data;
+        tile.tileIndex = index;
+        return tile;
+    }
+
+    std::filesystem::path cacheDirectory(const std::string& name) {
+        const std::filesystem::path dir = absPath("${TESTDIR}/disktilecache/" + name);
+        std::filesystem::remove_all(dir);
+        return dir;
+    }
+} // namespace
+
+TEST_CASE("DiskTileCache: Put and Get", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    cache::DiskTileCache c(cacheDirectory("putget"), 1024 * 1024);
+    const TileTextureInitData data = initData();
+    const cache::DiskTileKey key = { TileIndex(3, 2, 4), 1234 };
+
+    CHECK_FALSE(c.contains(key));
+    CHECK_FALSE(c.get(key, data).has_value());
+    CHECK(c.nMisses() == 1);
+
+    c.put(key, createTile(key.tileIndex, data, 42));
+    CHECK(c.contains(key));
+    CHECK(c.size() > data.totalNumBytes);
+
+    std::optional<RawTile> tile = c.get(key, data);
+    REQUIRE(tile.has_value());
+    CHECK(c.nHits() == 1);
+    CHECK(tile->tileIndex == key.tileIndex);
+    CHECK(tile->error == RawTile::ReadError::None);
+    REQUIRE(tile->textureInitData.has_value());
+    CHECK(tile->textureInitData->hashKey == data.hashKey);
+    CHECK(tile->tileMetaData.nValues == 4);
+    CHECK(tile->tileMetaData.maxValues[2] == 3.f);
+    CHECK(tile->tileMetaData.minValues[3] == -4.f);
+    CHECK(tile->tileMetaData.hasMissingData[1]);
+    CHECK_FALSE(tile->tileMetaData.hasMissingData[2]);
+    for (size_t i = 0; i < data.totalNumBytes; ++i) {
+        REQUIRE(tile->imageData[i] == std::byte(42));
+    }
+
+    // The same tile index for a different layer is a different tile
+    CHECK_FALSE(c.contains({ key.tileIndex, 4321 }));
+}
+
+TEST_CASE("DiskTileCache: Failed Tiles Are Not Stored", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    cache::DiskTileCache c(cacheDirectory("failed"), 1024 * 1024);
+    const TileTextureInitData data = initData();
+    const cache::DiskTileKey key = { TileIndex(0, 0, 1), 1 };
+
+    RawTile tile = createTile(key.tileIndex, data, 1);
+    tile.error = RawTile::ReadError::Failure;
+    c.put(key, tile);
+    CHECK_FALSE(c.contains(key));
+    CHECK(c.size() == 0);
+}
+
+TEST_CASE("DiskTileCache: Mismatching Format", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    cache::DiskTileCache c(cacheDirectory("format"), 1024 * 1024);
+    const cache::DiskTileKey key = { TileIndex(0, 0, 1), 1 };
+
+    c.put(key, createTile(key.tileIndex, initData(64), 1));
+    REQUIRE(c.contains(key));
+
+    // A tile stored with a different texture format is discarded
+    CHECK_FALSE(c.get(key, initData(32)).has_value());
+    CHECK_FALSE(c.contains(key));
+    CHECK(c.size() == 0);
+}
+
+TEST_CASE("DiskTileCache: Least Recently Used Eviction", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    const TileTextureInitData data = initData();
+    // Room for three tiles including their headers
+    const uint64_t budget = 3 * data.totalNumBytes + 3 * 128;
+    cache::DiskTileCache c(cacheDirectory("eviction"), budget);
+
+    const cache::DiskTileKey k0 = { TileIndex(0, 0, 2), 7 };
+    const cache::DiskTileKey k1 = { TileIndex(1, 0, 2), 7 };
+    const cache::DiskTileKey k2 = { TileIndex(2, 0, 2), 7 };
+    const cache::DiskTileKey k3 = { TileIndex(3, 0, 2), 7 };
+
+    c.put(k0, createTile(k0.tileIndex, data, 0));
+    c.put(k1, createTile(k1.tileIndex, data, 1));
+    c.put(k2, createTile(k2.tileIndex, data, 2));
+
+    // Using the oldest tile makes the second oldest the least recently used one
+    CHECK(c.get(k0, data).has_value());
+    c.put(k3, createTile(k3.tileIndex, data, 3));
+
+    CHECK(c.contains(k0));
+    CHECK_FALSE(c.contains(k1));
+    CHECK(c.contains(k2));
+    CHECK(c.contains(k3));
+    CHECK(c.size() <= budget);
+
+    c.setMaximumSize(0);
+    CHECK(c.size() == 0);
+    CHECK_FALSE(c.contains(k0));
+}
+
+TEST_CASE("DiskTileCache: Persistence", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    const std::filesystem::path dir = cacheDirectory("persistence");
+    const TileTextureInitData data = initData();
+    const cache::DiskTileKey key = { TileIndex(5, 3, 3), 0xABCDEF0123456789 };
+    uint64_t size = 0;
+    {
+        cache::DiskTileCache c(dir, 1024 * 1024);
+        c.put(key, createTile(key.tileIndex, data, 7));
+        size = c.size();
+    }
+
+    // Simulate a crash during a write in the previous session
+    const std::filesystem::path leftover = dir / "leftover.tile.0.tmp";
+    std::ofstream(leftover) << "partial";
+
+    cache::DiskTileCache c(dir, 1024 * 1024);
+    CHECK_FALSE(std::filesystem::exists(leftover));
+    CHECK(c.contains(key));
+    CHECK(c.size() == size);
+    std::optional<RawTile> tile = c.get(key, data);
+    REQUIRE(tile.has_value());
+    CHECK(tile->imageData[0] == std::byte(7));
+
+    c.clear();
+    CHECK(c.size() == 0);
+    CHECK_FALSE(c.contains(key));
+    CHECK(std::filesystem::is_empty(dir));
+}
+
+TEST_CASE("DiskTileCache: Corrupted Files", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    const std::filesystem::path dir = cacheDirectory("corrupted");
+    const TileTextureInitData data = initData();
+    const cache::DiskTileKey key = { TileIndex(1, 1, 1), 99 };
+    {
+        cache::DiskTileCache c(dir, 1024 * 1024);
+        c.put(key, createTile(key.tileIndex, data, 7));
+    }
+
+    std::filesystem::path file;
+    for (const auto& e : std::filesystem::recursive_directory_iterator(dir)) {
+        if (e.path().extension() == ".tile") {
+            file = e.path();
+        }
+    }
+    REQUIRE_FALSE(file.empty());
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) / 2);
+
+    cache::DiskTileCache c(dir, 1024 * 1024);
+    REQUIRE(c.contains(key));
+    CHECK_FALSE(c.get(key, data).has_value());
+    CHECK_FALSE(c.contains(key));
+    CHECK_FALSE(std::filesystem::exists(file));
+}
+
+TEST_CASE("DiskTileCache: Content Hash", "[disktilecache]") {
+    using namespace openspace::globebrowsing;
+
+    const TileTextureInitData data = initData();
+    const uint64_t h = cache::DiskTileCache::contentHash("a.wms", data, false);
+    CHECK(h == cache::DiskTileCache::contentHash("a.wms", data, false));
+    CHECK(h != cache::DiskTileCache::contentHash("b.wms", data, false));
+    CHECK(h != cache::DiskTileCache::contentHash("a.wms", data, true));
+    CHECK(h != cache::DiskTileCache::contentHash("a.wms", initData(32), false));
+
+    // Modifying a local dataset invalidates its tiles
+    const std::string path = absPath("${TESTDIR}/disktilecache/dataset.vrt");
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream(path) << "version 1";
+    const uint64_t h1 = cache::DiskTileCache::contentHash(path, data, false);
+    std::ofstream(path) << "version 2 with more content";
+    CHECK(h1 != cache::DiskTileCache::contentHash(path, data, false));
+}
@@ -0,0 +1,163 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/util/ephemeriscache.h>
+#include <openspace/util/spicemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <random>
+
+namespace {
+    void loadKernels() {
+        using openspace::SpiceManager;
+        const char* kernels[] = {
+            "${TESTDIR}/SpiceTest/spicekernels/naif0008.tls",
+            "${TESTDIR}/SpiceTest/spicekernels/cas00084.tsc",
+            "${TESTDIR}/SpiceTest/spicekernels/981005_PLTEPH-DE405S.bsp",
+            "${TESTDIR}/SpiceTest/spicekernels/020514_SE_SAT105.bsp",
+            "${TESTDIR}/SpiceTest/spicekernels/030201AP_SK_SM546_T45.bsp",
+            "${TESTDIR}/SpiceTest/spicekernels/cas_v37.tf",
+            "${TESTDIR}/SpiceTest/spicekernels/04135_04171pc_psiv2.bc",
+            "${TESTDIR}/SpiceTest/spicekernels/cpck05Mar2004.tpc"
+        };
+        for (const char* kernel : kernels) {
+            SpiceManager::ref().loadKernel(absPath(kernel));
+        }
+    }
+
+    // Random times within 15 days around the Phoebe flyby of Cassini
+    std::vector<double> sampleTimes(int n) {
+        const double center =
+            openspace::SpiceManager::ref().ephemerisTimeFromDate("2004 jun 11 19:32:00");
+
+        std::mt19937 generator(1337);
+        std::uniform_real_distribution<double> distribution(-15 * 86400.0, 15 * 86400.0);
+        std::vector<double> times(n);
+        for (double& t : times) {
+            t = center + distribution(generator);
+        }
+        return times;
+    }
+
+    double maxDeviation(const glm::dmat3& lhs, const glm::dmat3& rhs) {
+        double deviation = 0.0;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                deviation = std::max(deviation, std::abs(lhs[i][j] - rhs[i][j]));
+            }
+        }
+        return deviation;
+    }
+} // namespace
+
+TEST_CASE("EphemerisCache: Position Accuracy", "[ephemeriscache]") {
+    using namespace openspace;
+    SpiceManager::initialize();
+    loadKernels();
+
+    // The Earth moves smoothly, but the distance between Cassini and Phoebe changes
+    // rapidly during the flyby, which forces the pieces to be bisected
+    constexpr const double Tolerance = 1e-3;
+    const std::pair<const char*, const char*> series[] = {
+        { "EARTH", "SUN" },
+        { "CASSINI", "PHOEBE" }
+    };
+    for (const std::pair<const char*, const char*>& s : series) {
+        PositionEphemerisCache cache(s.first, s.second, "J2000", Tolerance);
+        for (double et : sampleTimes(2000)) {
+            const glm::dvec3 cached = cache.position(et);
+            const glm::dvec3 reference = SpiceManager::ref().targetPosition(
+                s.first,
+                s.second,
+                "J2000",
+                {},
+                et
+            );
+            REQUIRE(glm::length(cached - reference) <= Tolerance);
+        }
+        CHECK(cache.nFittedPieces() > 0);
+    }
+
+    SpiceManager::deinitialize();
+}
+
+TEST_CASE("EphemerisCache: Rotation Accuracy", "[ephemeriscache]") {
+    using namespace openspace;
+    SpiceManager::initialize();
+    loadKernels();
+
+    // IAU_EARTH is defined by the PCK, CASSINI_HGA by the CK, which has gaps in which
+    // the SpiceManager estimates the rotation
+    constexpr const double Tolerance = 1e-8;
+    const std::pair<const char*, const char*> series[] = {
+        { "IAU_EARTH", "J2000" },
+        { "CASSINI_HGA", "J2000" }
+    };
+    for (const std::pair<const char*, const char*>& s : series) {
+        RotationEphemerisCache cache(s.first, s.second, Tolerance);
+        for (double et : sampleTimes(2000)) {
+            const glm::dmat3 cached = cache.matrix(et);
+            const glm::dmat3 reference =
+                SpiceManager::ref().positionTransformMatrix(s.first, s.second, et);
+            // The entries of a rotation matrix change by at most the rotation angle
+            REQUIRE(maxDeviation(cached, reference) <= 2.0 * Tolerance);
+        }
+    }
+
+    SpiceManager::deinitialize();
+}
+
+TEST_CASE("EphemerisCache: Kernel Change Invalidates Pieces", "[ephemeriscache]") {
+    using namespace openspace;
+    SpiceManager::initialize();
+    loadKernels();
+
+    const double et = SpiceManager::ref().ephemerisTimeFromDate("2004 jun 11 19:32:00");
+    PositionEphemerisCache cache("EARTH", "SUN", "J2000", 1e-3);
+    cache.position(et);
+    cache.position(et + 60.0);
+    REQUIRE(cache.nFittedPieces() == 1);
+
+    SpiceManager::ref().loadKernel(
+        absPath("${TESTDIR}/SpiceTest/spicekernels/cas_iss_v09.ti")
+    );
+    cache.position(et);
+    REQUIRE(cache.nFittedPieces() == 2);
+
+    SpiceManager::deinitialize();
+}
+
+TEST_CASE("EphemerisCache: Missing Data Throws", "[ephemeriscache]") {
+    using namespace openspace;
+    SpiceManager::initialize();
+    loadKernels();
+
+    // Errors are reported in the same way as if SPICE were queried directly
+    const double et = SpiceManager::ref().ephemerisTimeFromDate("2004 jun 11 19:32:00");
+    PositionEphemerisCache cache("NOT A BODY", "SUN", "J2000", 1e-3);
+    REQUIRE_THROWS_AS(cache.position(et), SpiceManager::SpiceException);
+
+    SpiceManager::deinitialize();
+}
@@ -0,0 +1,267 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_FIELDLINESSEQUENCE_ENABLED
+
+#include "catch2/catch.hpp"
+
+#include <modules/fieldlinessequence/util/fieldlinesprefetcher.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <thread>
+
+namespace {
+    // A loader that creates a state with a single line of nPoints vertices instead of
+    // reading an .osfls file from disk. It records which states were loaded and on which
+    // thread the loading happened
+    struct FakeLoader {
+        explicit FakeLoader(size_t nPoints) : nPoints(nPoints) {}
+
+        bool operator()(size_t index, openspace::FieldlinesState& state) {
+            {
+                std::unique_lock lock(mutex);
+                loadedIndices.push_back(index);
+                threadIds.insert(std::this_thread::get_id());
+                condition.notify_all();
+                condition.wait(lock, [this]() { return !isBlocked; });
+            }
+
+            std::vector<glm::vec3> line(nPoints, glm::vec3(static_cast<float>(index)));
+            state.addLine(line);
+            state.setTriggerTime(static_cast<double>(index));
+            return true;
+        }
+
+        void block() {
+            std::lock_guard lock(mutex);
+            isBlocked = true;
+        }
+
+        void unblock() {
+            {
+                std::lock_guard lock(mutex);
+                isBlocked = false;
+            }
+            condition.notify_all();
+        }
+
+        void waitForLoads(size_t n) {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this, n]() { return loadedIndices.size() >= n; });
+        }
+
+        const size_t nPoints;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool isBlocked = false;
+        std::vector<size_t> loadedIndices;
+        std::set<std::thread::id> threadIds;
+    };
+
+    openspace::FieldlinesPrefetcher::Loader wrap(FakeLoader& loader) {
+        return [&loader](size_t index, openspace::FieldlinesState& state) {
+            return loader(index, state);
+        };
+    }
+
+    // Replays the playback of states in the same way that RenderableFieldlinesSequence
+    // does: request the new state, acquire it once it is available and hand the
+    // previously active state back to the prefetcher
+    struct Playback {
+        explicit Playback(openspace::FieldlinesPrefetcher& p) : prefetcher(p) {}
+
+        void play(const std::vector<size_t>& sequence) {
+            for (size_t index : sequence) {
+                if (activeIndex == index) {
+                    continue;
+                }
+                prefetcher.request(index);
+                // Playing at a rate at which the worker can keep up
+                prefetcher.waitUntilIdle();
+
+                std::optional<openspace::FieldlinesState> state =
+                    prefetcher.acquire(index);
+                REQUIRE(state.has_value());
+                REQUIRE(state->triggerTime() == static_cast<double>(index));
+                if (activeState.has_value()) {
+                    prefetcher.release(*activeIndex, std::move(*activeState));
+                }
+                activeIndex = index;
+                activeState = std::move(state);
+            }
+        }
+
+        openspace::FieldlinesPrefetcher& prefetcher;
+        std::optional<size_t> activeIndex;
+        std::optional<openspace::FieldlinesState> activeState;
+    };
+
+    size_t nRunningThreads() {
+#ifdef __linux__
+        const std::filesystem::path tasks = "/proc/self/task";
+        return std::distance(
+            std::filesystem::directory_iterator(tasks),
+            std::filesystem::directory_iterator()
+        );
+#else // ^^^ __linux__ / !__linux__ vvv
+        return 0;
+#endif // __linux__
+    }
+} // namespace
+
+TEST_CASE("FieldlinesPrefetcher: Sequential Playback", "[fieldlinesprefetcher]") {
+    using namespace openspace;
+
+    constexpr const size_t NStates = 50;
+    FakeLoader loader(100);
+    FieldlinesPrefetcher prefetcher(NStates, wrap(loader), 3, 1024 * 1024 * 1024);
+
+    Playback playback(prefetcher);
+    std::vector<size_t> sequence(NStates);
+    std::iota(sequence.begin(), sequence.end(), 0);
+    playback.play(sequence);
+
+    // Only the very first state should have been requested before it was prefetched
+    CHECK(prefetcher.nMisses() == 1);
+    CHECK(prefetcher.nHits() == NStates - 1);
+
+    // Playing backwards again should not require any additional loads as all states fit
+    // into the memory budget and are handed back to the prefetcher
+    const size_t nLoads = loader.loadedIndices.size();
+    CHECK(nLoads == NStates);
+    std::reverse(sequence.begin(), sequence.end());
+    playback.play(sequence);
+    CHECK(loader.loadedIndices.size() == nLoads);
+
+    const double hitRate = static_cast<double>(prefetcher.nHits()) /
+        static_cast<double>(prefetcher.nHits() + prefetcher.nMisses());
+    CHECK(hitRate > 0.95);
+
+    // All states are loaded on the same worker thread
+    CHECK(loader.threadIds.size() == 1);
+    CHECK(loader.threadIds.count(std::this_thread::get_id()) == 0);
+}
+
+TEST_CASE("FieldlinesPrefetcher: Skipping Playback", "[fieldlinesprefetcher]") {
+    using namespace openspace;
+
+    // At high delta times every other state is skipped, which the look-ahead covers
+    FakeLoader loader(100);
+    FieldlinesPrefetcher prefetcher(100, wrap(loader), 2, 1024 * 1024 * 1024);
+
+    std::vector<size_t> sequence;
+    for (size_t i = 0; i < 100; i += 2) {
+        sequence.push_back(i);
+    }
+    Playback playback(prefetcher);
+    playback.play(sequence);
+
+    CHECK(prefetcher.nMisses() == 1);
+    CHECK(prefetcher.nHits() == sequence.size() - 1);
+}
+
+TEST_CASE("FieldlinesPrefetcher: Time Jump Cancels Stale Requests",
+          "[fieldlinesprefetcher]")
+{
+    using namespace openspace;
+
+    FakeLoader loader(100);
+    FieldlinesPrefetcher prefetcher(100, wrap(loader), 3, 1024 * 1024 * 1024);
+
+    // Keep the worker busy with the first state while the time jumps twice
+    loader.block();
+    prefetcher.request(0);
+    loader.waitForLoads(1);
+    prefetcher.request(20);
+    prefetcher.request(80);
+    loader.unblock();
+    prefetcher.waitUntilIdle();
+
+    CHECK(prefetcher.nMisses() == 3);
+    CHECK(prefetcher.nHits() == 0);
+
+    // Nothing around the state at the intermediate jump should have been loaded
+    for (size_t index : loader.loadedIndices) {
+        CHECK((index == 0 || (index >= 77 && index <= 83)));
+    }
+    CHECK(loader.loadedIndices.size() == 8);
+
+    // The state that was loading when the time jumped is no longer needed
+    CHECK_FALSE(prefetcher.acquire(0).has_value());
+    CHECK(prefetcher.acquire(80).has_value());
+}
+
+TEST_CASE("FieldlinesPrefetcher: Memory Budget", "[fieldlinesprefetcher]") {
+    using namespace openspace;
+
+    FakeLoader loader(1000);
+    FieldlinesState reference;
+    REQUIRE(loader(0, reference));
+    const size_t stateSize = FieldlinesPrefetcher::memoryFootprint(reference);
+    loader.loadedIndices.clear();
+    loader.threadIds.clear();
+
+    // Only three states fit into the budget even though five are requested
+    const size_t budget = 3 * stateSize;
+    FieldlinesPrefetcher prefetcher(20, wrap(loader), 2, budget);
+
+    std::optional<FieldlinesState> activeState;
+    for (size_t i = 0; i < 20; ++i) {
+        prefetcher.request(i);
+        prefetcher.waitUntilIdle();
+        CHECK(prefetcher.cachedBytes() <= budget);
+
+        std::optional<FieldlinesState> state = prefetcher.acquire(i);
+        REQUIRE(state.has_value());
+        if (activeState.has_value()) {
+            prefetcher.release(i - 1, std::move(*activeState));
+            CHECK(prefetcher.cachedBytes() <= budget);
+        }
+        activeState = std::move(state);
+    }
+
+    // The next state in the playback direction is always kept in favor of the others
+    CHECK(prefetcher.nMisses() == 1);
+}
+
+TEST_CASE("FieldlinesPrefetcher: No Leaked Threads", "[fieldlinesprefetcher]") {
+    using namespace openspace;
+
+    const size_t nThreadsBefore = nRunningThreads();
+    for (int i = 0; i < 10; ++i) {
+        FakeLoader loader(10);
+        FieldlinesPrefetcher prefetcher(100, wrap(loader), 4, 1024 * 1024);
+        prefetcher.request(static_cast<size_t>(i * 10));
+        // Destroy the prefetcher while the worker is in the middle of loading
+        loader.waitForLoads(1);
+    }
+    CHECK(nRunningThreads() == nThreadsBefore);
+}
+
+#endif // OPENSPACE_MODULE_FIELDLINESSEQUENCE_ENABLED
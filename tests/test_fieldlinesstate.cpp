@@ -0,0 +1,237 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_FIELDLINESSEQUENCE_ENABLED
+
+#include "catch2/catch.hpp"
+
+#include <modules/fieldlinessequence/util/fieldlinesstate.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+namespace {
+    openspace::FieldlinesState createState(size_t nLines, size_t nPointsPerLine,
+                                           size_t nExtras, unsigned int seed)
+    {
+        using namespace openspace;
+
+        FieldlinesState state;
+        state.setModel(fls::Model::Enlil);
+        state.setTriggerTime(1234.5);
+        std::vector<std::string> names;
+        for (size_t i = 0; i < nExtras; ++i) {
+            names.push_back(fmt::format("quantity{}", i));
+        }
+        state.setExtraQuantityNames(names);
+
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+        for (size_t l = 0; l < nLines; ++l) {
+            std::vector<glm::vec3> line(nPointsPerLine);
+            for (glm::vec3& p : line) {
+                p = glm::vec3(dist(gen), dist(gen), dist(gen));
+            }
+            state.addLine(line);
+            for (size_t p = 0; p < nPointsPerLine; ++p) {
+                for (size_t e = 0; e < nExtras; ++e) {
+                    state.appendToExtra(e, dist(gen));
+                }
+            }
+        }
+        return state;
+    }
+
+    // Writes the state in the unaligned layout of version 0 files that was used before
+    void writeVersion0(const openspace::FieldlinesState& state, const std::string& path) {
+        using namespace openspace;
+
+        std::string names;
+        for (const std::string& name : state.extraQuantityNames()) {
+            names += name + '\0';
+        }
+
+        const int32_t version = 0;
+        const double triggerTime = state.triggerTime();
+        const int32_t model = static_cast<int32_t>(state.model());
+        const bool isMorphable = false;
+        const uint64_t nLines = state.lineStart().size();
+        const uint64_t nPoints = state.vertexPositions().size();
+        const uint64_t nExtras = state.nExtraQuantities();
+        const uint64_t nNameBytes = names.size();
+
+        std::ofstream file(path, std::ofstream::binary);
+        file.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+        file.write(reinterpret_cast<const char*>(&triggerTime), sizeof(double));
+        file.write(reinterpret_cast<const char*>(&model), sizeof(int32_t));
+        file.write(reinterpret_cast<const char*>(&isMorphable), sizeof(bool));
+        file.write(reinterpret_cast<const char*>(&nLines), sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&nPoints), sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&nExtras), sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&nNameBytes), sizeof(uint64_t));
+        file.write(
+            reinterpret_cast<const char*>(state.lineStart().data()),
+            nLines * sizeof(int32_t)
+        );
+        file.write(
+            reinterpret_cast<const char*>(state.lineCount().data()),
+            nLines * sizeof(int32_t)
+        );
+        file.write(
+            reinterpret_cast<const char*>(state.vertexPositions().data()),
+            nPoints * 3 * sizeof(float)
+        );
+        for (size_t i = 0; i < nExtras; ++i) {
+            bool isSuccessful;
+            const float* quantity = state.extraQuantity(i, isSuccessful).data();
+            file.write(
+                reinterpret_cast<const char*>(quantity),
+                nPoints * sizeof(float)
+            );
+        }
+        file.write(names.data(), names.size());
+    }
+
+    void checkEqual(const openspace::FieldlinesState& lhs,
+                    const openspace::FieldlinesState& rhs)
+    {
+        REQUIRE(lhs.triggerTime() == rhs.triggerTime());
+        REQUIRE(lhs.model() == rhs.model());
+        REQUIRE(lhs.extraQuantityNames() == rhs.extraQuantityNames());
+        REQUIRE(lhs.nExtraQuantities() == rhs.nExtraQuantities());
+
+        auto equal = [](const auto& a, const auto& b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+        };
+        REQUIRE(equal(lhs.lineStart(), rhs.lineStart()));
+        REQUIRE(equal(lhs.lineCount(), rhs.lineCount()));
+        REQUIRE(equal(lhs.vertexPositions(), rhs.vertexPositions()));
+        for (size_t i = 0; i < lhs.nExtraQuantities(); ++i) {
+            bool lhsSuccessful;
+            bool rhsSuccessful;
+            REQUIRE(equal(
+                lhs.extraQuantity(i, lhsSuccessful),
+                rhs.extraQuantity(i, rhsSuccessful)
+            ));
+            REQUIRE(lhsSuccessful);
+            REQUIRE(rhsSuccessful);
+        }
+    }
+} // namespace
+
+TEST_CASE("FieldlinesState: Osfls Roundtrip", "[fieldlinesstate]") {
+    using namespace openspace;
+
+    const std::string path = absPath("${TESTDIR}/roundtrip.osfls");
+    const FieldlinesState state = createState(7, 13, 3, 1337);
+    REQUIRE(state.writeOsflsFile(path));
+
+    FieldlinesState loaded;
+    REQUIRE(loaded.loadStateFromOsfls(path));
+    CHECK(loaded.isMemoryMapped());
+    checkEqual(state, loaded);
+
+    // All arrays must be aligned so that they can be used directly from the mapping
+    bool isSuccessful;
+    const uintptr_t extra = reinterpret_cast<uintptr_t>(
+        loaded.extraQuantity(2, isSuccessful).data()
+    );
+    CHECK(reinterpret_cast<uintptr_t>(loaded.lineStart().data()) % 64 == 0);
+    CHECK(reinterpret_cast<uintptr_t>(loaded.lineCount().data()) % 64 == 0);
+    CHECK(reinterpret_cast<uintptr_t>(loaded.vertexPositions().data()) % 64 == 0);
+    CHECK(extra % 64 == 0);
+
+    // Memory mapped states can be written again
+    const std::string copyPath = absPath("${TESTDIR}/roundtripcopy.osfls");
+    REQUIRE(loaded.writeOsflsFile(copyPath));
+    FieldlinesState copy;
+    REQUIRE(copy.loadStateFromOsfls(copyPath));
+    checkEqual(state, copy);
+}
+
+TEST_CASE("FieldlinesState: Osfls Version 0", "[fieldlinesstate]") {
+    using namespace openspace;
+
+    const std::string path = absPath("${TESTDIR}/version0.osfls");
+    const FieldlinesState state = createState(5, 11, 2, 42);
+    writeVersion0(state, path);
+
+    FieldlinesState loaded;
+    REQUIRE(loaded.loadStateFromOsfls(path));
+    CHECK_FALSE(loaded.isMemoryMapped());
+    checkEqual(state, loaded);
+}
+
+TEST_CASE("FieldlinesState: Modify Memory Mapped State", "[fieldlinesstate]") {
+    using namespace openspace;
+
+    const std::string path = absPath("${TESTDIR}/modify.osfls");
+    const FieldlinesState state = createState(3, 4, 2, 7);
+    REQUIRE(state.writeOsflsFile(path));
+
+    FieldlinesState loaded;
+    REQUIRE(loaded.loadStateFromOsfls(path));
+    const FieldlinesState copy = loaded;
+    CHECK(copy.isMemoryMapped());
+
+    loaded.scalePositions(2.f);
+    CHECK_FALSE(loaded.isMemoryMapped());
+    CHECK(copy.isMemoryMapped());
+    REQUIRE(loaded.vertexPositions().size() == state.vertexPositions().size());
+    for (size_t i = 0; i < state.vertexPositions().size(); ++i) {
+        CHECK(loaded.vertexPositions()[i].x == 2.f * state.vertexPositions()[i].x);
+    }
+
+    // Everything but the positions is left untouched
+    loaded.scalePositions(0.5f);
+    checkEqual(state, loaded);
+    checkEqual(state, copy);
+}
+
+TEST_CASE("FieldlinesState: Truncated Osfls File", "[fieldlinesstate]") {
+    using namespace openspace;
+
+    const std::string path = absPath("${TESTDIR}/truncated.osfls");
+    const FieldlinesState state = createState(3, 4, 2, 7);
+    REQUIRE(state.writeOsflsFile(path));
+
+    std::vector<char> content;
+    {
+        std::ifstream file(path, std::ifstream::binary);
+        content.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    {
+        std::ofstream file(path, std::ofstream::binary | std::ofstream::trunc);
+        file.write(content.data(), content.size() - 4);
+    }
+
+    FieldlinesState loaded;
+    CHECK_FALSE(loaded.loadStateFromOsfls(path));
+}
+
+#endif // OPENSPACE_MODULE_FIELDLINESSEQUENCE_ENABLED
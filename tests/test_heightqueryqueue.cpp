@@ -0,0 +1,192 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/heightqueryqueue.h>
+#include <ghoul/misc/exception.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+using namespace openspace::globebrowsing;
+
+namespace {
+    constexpr const int MaxFrames = 10;
+
+    bool isReady(const std::future<std::vector<float>>& future) {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Simulates the height tiles of a globe that arrive a number of frames after they
+    // were first requested. The height of a position is its latitude, or -1 if the
+    // resolver settled for the available data before the tile arrived
+    struct DelayedTiles {
+        explicit DelayedTiles(int delay) : loadDelay(delay) {}
+
+        HeightQueryQueue::Resolver resolver() {
+            return [this](const Geodetic2& position, int, bool useAvailableData) {
+                nRequests++;
+                if (frame >= loadDelay) {
+                    return std::optional<float>(static_cast<float>(position.lat));
+                }
+                return useAvailableData ? std::optional<float>(-1.f) : std::nullopt;
+            };
+        }
+
+        int loadDelay = 0;
+        int frame = 0;
+        int nRequests = 0;
+    };
+} // namespace
+
+TEST_CASE("HeightQueryQueue: Resolve Available Data", "[heightqueryqueue]") {
+    HeightQueryQueue queue(MaxFrames);
+    DelayedTiles tiles(0);
+
+    std::future<std::vector<float>> f = queue.enqueue({ { 1.0, 0.0 }, { 2.0, 0.0 } }, 5);
+    REQUIRE(queue.hasPendingQueries());
+    REQUIRE_FALSE(isReady(f));
+
+    queue.resolve(tiles.resolver());
+    REQUIRE(isReady(f));
+    REQUIRE(f.get() == std::vector<float>{ 1.f, 2.f });
+    REQUIRE_FALSE(queue.hasPendingQueries());
+}
+
+TEST_CASE("HeightQueryQueue: Resolve Once Tiles Arrive", "[heightqueryqueue]") {
+    HeightQueryQueue queue(MaxFrames);
+    DelayedTiles tiles(3);
+
+    std::future<std::vector<float>> f = queue.enqueue({ { 1.0, 0.0 }, { 2.0, 0.0 } }, 5);
+    for (; tiles.frame < 3; tiles.frame++) {
+        queue.resolve(tiles.resolver());
+        REQUIRE_FALSE(isReady(f));
+    }
+    queue.resolve(tiles.resolver());
+    REQUIRE(isReady(f));
+    REQUIRE(f.get() == std::vector<float>{ 1.f, 2.f });
+
+    // Resolved positions are not requested again
+    const int nRequests = tiles.nRequests;
+    queue.resolve(tiles.resolver());
+    REQUIRE(tiles.nRequests == nRequests);
+}
+
+TEST_CASE("HeightQueryQueue: Settle For Available Data", "[heightqueryqueue]") {
+    // This is what happens if the globe is updated, but culled or not rendered, and the
+    // tiles never arrive. The query still has to be answered after a bounded number of
+    // frames instead of waiting forever
+    HeightQueryQueue queue(MaxFrames);
+    DelayedTiles tiles(std::numeric_limits<int>::max());
+
+    std::future<std::vector<float>> f = queue.enqueue({ { 1.0, 0.0 } }, 5);
+    for (int i = 0; i < MaxFrames; ++i) {
+        queue.resolve(tiles.resolver());
+        REQUIRE_FALSE(isReady(f));
+    }
+    queue.resolve(tiles.resolver());
+    REQUIRE(isReady(f));
+    REQUIRE(f.get() == std::vector<float>{ -1.f });
+}
+
+TEST_CASE("HeightQueryQueue: Disabled", "[heightqueryqueue]") {
+    // If the globe is disabled, nobody resolves the queries anymore, so the outstanding
+    // ones and the new ones have to fail right away
+    HeightQueryQueue queue(MaxFrames);
+    DelayedTiles tiles(std::numeric_limits<int>::max());
+
+    std::future<std::vector<float>> pending = queue.enqueue({ { 1.0, 0.0 } }, 5);
+    queue.resolve(tiles.resolver());
+    std::future<std::vector<float>> unseen = queue.enqueue({ { 2.0, 0.0 } }, 5);
+
+    queue.disable("Disabled");
+    REQUIRE(isReady(pending));
+    REQUIRE_THROWS_AS(pending.get(), ghoul::RuntimeError);
+    REQUIRE(isReady(unseen));
+    REQUIRE_THROWS_AS(unseen.get(), ghoul::RuntimeError);
+    REQUIRE_FALSE(queue.hasPendingQueries());
+
+    std::future<std::vector<float>> whileDisabled = queue.enqueue({ { 3.0, 0.0 } }, 5);
+    REQUIRE(isReady(whileDisabled));
+    REQUIRE_THROWS_AS(whileDisabled.get(), ghoul::RuntimeError);
+
+    queue.enable();
+    tiles.loadDelay = 0;
+    std::future<std::vector<float>> enabled = queue.enqueue({ { 4.0, 0.0 } }, 5);
+    queue.resolve(tiles.resolver());
+    REQUIRE(enabled.get() == std::vector<float>{ 4.f });
+}
+
+TEST_CASE("HeightQueryQueue: Abandon", "[heightqueryqueue]") {
+    HeightQueryQueue queue(MaxFrames);
+
+    std::future<std::vector<float>> f = queue.enqueue({ { 1.0, 0.0 } }, 5);
+    queue.abandon("Deinitialized");
+    REQUIRE(isReady(f));
+    REQUIRE_THROWS_AS(f.get(), ghoul::RuntimeError);
+
+    // Abandoning does not prevent new queries
+    DelayedTiles tiles(0);
+    std::future<std::vector<float>> g = queue.enqueue({ { 2.0, 0.0 } }, 5);
+    queue.resolve(tiles.resolver());
+    REQUIRE(g.get() == std::vector<float>{ 2.f });
+}
+
+TEST_CASE("HeightQueryQueue: Enqueue From Other Threads", "[heightqueryqueue]") {
+    constexpr const int NThreads = 4;
+    constexpr const int NQueriesPerThread = 250;
+    constexpr const int NQueries = NThreads * NQueriesPerThread;
+
+    HeightQueryQueue queue(MaxFrames);
+    DelayedTiles tiles(0);
+
+    std::vector<std::future<std::vector<float>>> futures(NQueries);
+    std::atomic<int> nEnqueued = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < NQueriesPerThread; ++i) {
+                const int index = t * NQueriesPerThread + i;
+                const double lat = static_cast<double>(index);
+                futures[index] = queue.enqueue({ { lat, 0.0 } }, 5);
+                nEnqueued++;
+            }
+        });
+    }
+
+    // Resolve concurrently to the enqueueing, as the globe would do every frame
+    while (nEnqueued < NQueries || queue.hasPendingQueries()) {
+        queue.resolve(tiles.resolver());
+        std::this_thread::yield();
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < NQueries; ++i) {
+        REQUIRE(futures[i].get() == std::vector<float>{ static_cast<float>(i) });
+    }
+}
@@ -0,0 +1,194 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/space/translation/keplerpropagator.h>
+#include <modules/space/translation/keplertranslation.h>
+#include <openspace/util/threadpool.h>
+#include <openspace/util/updatestructures.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+    // Random orbits with eccentricities in [minEccentricity, maxEccentricity]
+    openspace::KeplerPropagator::Elements randomElements(int n, double minEccentricity,
+                                                         double maxEccentricity)
+    {
+        std::mt19937 generator(1337);
+        std::uniform_real_distribution<double> ecc(minEccentricity, maxEccentricity);
+        std::uniform_real_distribution<double> angle(0.0, 360.0);
+        std::uniform_real_distribution<double> axis(7000.0, 50000.0);
+
+        openspace::KeplerPropagator::Elements elements;
+        for (int i = 0; i < n; ++i) {
+            elements.eccentricity.push_back(ecc(generator));
+            elements.semiMajorAxis.push_back(axis(generator));
+            elements.inclination.push_back(angle(generator) / 2.0);
+            elements.ascendingNode.push_back(angle(generator));
+            elements.argumentOfPeriapsis.push_back(angle(generator));
+            elements.meanAnomalyAtEpoch.push_back(angle(generator));
+            elements.period.push_back(5400.0 + 100.0 * angle(generator));
+            elements.epoch.push_back(1e5 * angle(generator));
+        }
+        return elements;
+    }
+
+    glm::dvec3 referencePosition(const openspace::KeplerPropagator::Elements& elements,
+                                 int i, double time)
+    {
+        openspace::KeplerTranslation translation;
+        translation.setKeplerElements(
+            elements.eccentricity[i],
+            elements.semiMajorAxis[i],
+            elements.inclination[i],
+            elements.ascendingNode[i],
+            elements.argumentOfPeriapsis[i],
+            elements.meanAnomalyAtEpoch[i],
+            elements.period[i],
+            elements.epoch[i]
+        );
+        return translation.position({ {}, openspace::Time(time), openspace::Time(0.0) });
+    }
+} // namespace
+
+TEST_CASE("KeplerPropagator: Kepler Equation Residual", "[keplerpropagator]") {
+    using namespace openspace;
+
+    const double eccentricities[] = { 0.0, 1e-6, 0.05, 0.3, 0.7, 0.95, 0.999, 0.9999 };
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> anomaly(-1000.0, 1000.0);
+
+    for (double ecc : eccentricities) {
+        std::vector<double> e(1000, ecc);
+        std::vector<double> m(1000);
+        for (double& v : m) {
+            v = anomaly(generator);
+        }
+        // Mean anomalies close to the periapsis are the hardest case for e close to 1
+        m[0] = 0.0;
+        m[1] = 1e-9;
+        m[2] = -1e-4;
+        std::vector<double> result(1000);
+        KeplerPropagator::solveKeplerEquation(
+            e.data(),
+            m.data(),
+            e.size(),
+            result.data()
+        );
+
+        for (size_t i = 0; i < e.size(); ++i) {
+            const double residual = result[i] - ecc * std::sin(result[i]) - m[i];
+            REQUIRE(std::abs(residual) <= 1e-14 * (1.0 + std::abs(m[i])));
+        }
+    }
+
+    // Non-elliptical orbits are not solved, as in KeplerTranslation
+    const double e = 1.0;
+    const double m = 2.0;
+    double result = -1.0;
+    KeplerPropagator::solveKeplerEquation(&e, &m, 1, &result);
+    CHECK(result == 0.0);
+}
+
+TEST_CASE("KeplerPropagator: Matches KeplerTranslation", "[keplerpropagator]") {
+    using namespace openspace;
+
+    // The iteration in KeplerTranslation stops early for small eccentricities, so the
+    // accepted difference depends on the eccentricity
+    auto tolerance = [](double e) {
+        return e < 0.2 ? std::max(2.0 * std::pow(e, 6.0), 1e-9) : 1e-9;
+    };
+
+    const std::pair<double, double> ranges[] = {
+        { 0.0, 0.0 }, { 0.0, 0.2 }, { 0.2, 0.9 }, { 0.9, 0.99 }
+    };
+    for (const std::pair<double, double>& range : ranges) {
+        constexpr const int NOrbits = 100;
+        const KeplerPropagator::Elements elements =
+            randomElements(NOrbits, range.first, range.second);
+        const KeplerPropagator propagator(elements);
+        REQUIRE(propagator.nOrbits() == NOrbits);
+
+        std::vector<uint32_t> orbits;
+        std::vector<double> times;
+        for (uint32_t i = 0; i < NOrbits; ++i) {
+            for (int j = 0; j < 7; ++j) {
+                orbits.push_back(i);
+                times.push_back(elements.epoch[i] + j * 0.37 * elements.period[i]);
+            }
+        }
+        std::vector<glm::dvec3> positions(orbits.size());
+        propagator.evaluate(orbits.data(), times.data(), orbits.size(), positions.data());
+
+        for (size_t i = 0; i < orbits.size(); ++i) {
+            const int orbit = static_cast<int>(orbits[i]);
+            const glm::dvec3 reference = referencePosition(elements, orbit, times[i]);
+            const double scale = elements.semiMajorAxis[orbit] * 1000.0;
+            const double error = glm::length(positions[i] - reference) / scale;
+            REQUIRE(error <= tolerance(elements.eccentricity[orbit]));
+        }
+    }
+}
+
+TEST_CASE("KeplerPropagator: Threaded Evaluation", "[keplerpropagator]") {
+    using namespace openspace;
+
+    constexpr const int NOrbits = 500;
+    const KeplerPropagator propagator(randomElements(NOrbits, 0.0, 0.95));
+
+    std::vector<uint32_t> orbits(100000);
+    std::vector<double> times(orbits.size());
+    for (size_t i = 0; i < orbits.size(); ++i) {
+        orbits[i] = static_cast<uint32_t>(i % NOrbits);
+        times[i] = 60.0 * static_cast<double>(i);
+    }
+
+    std::vector<glm::dvec3> serial(orbits.size());
+    propagator.evaluate(orbits.data(), times.data(), orbits.size(), serial.data());
+
+    ThreadPool pool(3);
+    std::vector<glm::dvec3> threaded(orbits.size());
+    propagator.evaluate(
+        orbits.data(),
+        times.data(),
+        orbits.size(),
+        threaded.data(),
+        pool
+    );
+    CHECK(serial == threaded);
+}
+
+TEST_CASE("KeplerPropagator: Range Errors", "[keplerpropagator]") {
+    using namespace openspace;
+
+    KeplerPropagator::Elements elements = randomElements(10, 0.0, 0.5);
+    elements.eccentricity[5] = 1.5;
+    CHECK_THROWS_AS(KeplerPropagator(elements), KeplerTranslation::RangeError);
+
+    elements.eccentricity[5] = 0.5;
+    elements.inclination[3] = -10.0;
+    CHECK_THROWS_AS(KeplerPropagator(elements), KeplerTranslation::RangeError);
+}
@@ -0,0 +1,218 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_GAIA_ENABLED
+
+#include "catch2/catch.hpp"
+
+#include <modules/gaia/rendering/octreemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr const int ValuesPerStar = 8;
+    constexpr const int MaxDist = 10;
+
+    std::string folder(const std::string& name) {
+        const std::string path = absPath("${TESTDIR}/octreemanager/" + name) + "/";
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        return path;
+    }
+
+    // Creates stars that are concentrated around the origin, which creates a deep
+    // Octree. The magnitudes are rounded to get stars with the same magnitude
+    std::vector<std::vector<float>> createStars(size_t nStars) {
+        std::mt19937 gen(static_cast<unsigned int>(nStars));
+        std::normal_distribution<float> position(0.f, MaxDist / 8.f);
+        std::uniform_real_distribution<float> magnitude(-5.f, 20.f);
+        std::uniform_real_distribution<float> other(-1.f, 1.f);
+
+        constexpr const float Limit = 0.99f * MaxDist;
+        std::vector<std::vector<float>> stars(nStars, std::vector<float>(ValuesPerStar));
+        for (std::vector<float>& star : stars) {
+            for (int c = 0; c < 3; ++c) {
+                star[c] = std::clamp(position(gen), -Limit, Limit);
+            }
+            star[3] = std::round(magnitude(gen) * 10.f) / 10.f;
+            for (int c = 4; c < ValuesPerStar; ++c) {
+                star[c] = other(gen);
+            }
+        }
+        return stars;
+    }
+
+    struct FileNode {
+        bool isLeaf = false;
+        int32_t numStars = 0;
+        std::vector<float> data;
+        std::vector<FileNode> children;
+    };
+
+    // Parses a node written by OctreeManager::writeToFile including its data
+    FileNode readFileNode(std::ifstream& stream) {
+        FileNode node;
+        stream.read(reinterpret_cast<char*>(&node.isLeaf), sizeof(bool));
+        stream.read(reinterpret_cast<char*>(&node.numStars), sizeof(int32_t));
+        int32_t nValues = 0;
+        stream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
+        node.data.resize(nValues);
+        stream.read(reinterpret_cast<char*>(node.data.data()), nValues * sizeof(float));
+        if (!node.isLeaf) {
+            for (int i = 0; i < 8; ++i) {
+                node.children.push_back(readFileNode(stream));
+            }
+        }
+        return node;
+    }
+
+    // Magnitudes are the first of the two color values, which follow all positions
+    std::vector<float> magnitudes(const FileNode& node) {
+        const size_t nStars = node.data.size() / ValuesPerStar;
+        std::vector<float> result;
+        for (size_t i = 0; i < nStars; ++i) {
+            result.push_back(node.data[nStars * 3 + i * 2]);
+        }
+        return result;
+    }
+
+    std::vector<float> leafMagnitudes(const FileNode& node) {
+        if (node.isLeaf) {
+            return magnitudes(node);
+        }
+        std::vector<float> result;
+        for (const FileNode& child : node.children) {
+            std::vector<float> m = leafMagnitudes(child);
+            result.insert(result.end(), m.begin(), m.end());
+        }
+        return result;
+    }
+
+    void checkLodCache(const FileNode& node, size_t maxStarsPerNode) {
+        if (node.isLeaf) {
+            return;
+        }
+
+        // Inner nodes store the brightest stars of all their leaves, sorted
+        std::vector<float> lod = magnitudes(node);
+        REQUIRE(lod.size() == maxStarsPerNode);
+        REQUIRE(std::is_sorted(lod.begin(), lod.end()));
+
+        std::vector<float> leaves = leafMagnitudes(node);
+        std::sort(leaves.begin(), leaves.end());
+        leaves.resize(maxStarsPerNode);
+        REQUIRE(lod == leaves);
+
+        for (const FileNode& child : node.children) {
+            checkLodCache(child, maxStarsPerNode);
+        }
+    }
+} // namespace
+
+TEST_CASE("OctreeManager: Leaves Keep All Stars", "[octreemanager]") {
+    using namespace openspace;
+
+    const std::vector<std::vector<float>> stars = createStars(20000);
+    OctreeManager octree;
+    octree.initOctree(0, MaxDist, 64);
+    for (const std::vector<float>& star : stars) {
+        octree.insert(star);
+    }
+    REQUIRE(octree.totalDepth() > 2);
+
+    std::vector<float> expected;
+    for (const std::vector<float>& star : stars) {
+        expected.insert(expected.end(), star.begin(), star.end());
+    }
+    std::vector<float> data = octree.getAllData(gaia::RenderOption::Motion);
+    std::sort(expected.begin(), expected.end());
+    std::sort(data.begin(), data.end());
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("OctreeManager: LOD Cache Holds Brightest Stars", "[octreemanager]") {
+    using namespace openspace;
+
+    constexpr const int MaxStarsPerNode = 64;
+    const std::string path = folder("lodcache");
+    OctreeManager octree;
+    octree.initOctree(0, MaxDist, MaxStarsPerNode);
+    for (const std::vector<float>& star : createStars(20000)) {
+        octree.insert(star);
+    }
+    octree.sliceLodData();
+    {
+        std::ofstream file(path + "octree.bin", std::ofstream::binary);
+        octree.writeToFile(file, true);
+    }
+
+    std::ifstream file(path + "octree.bin", std::ifstream::binary);
+    file.seekg(3 * sizeof(int32_t));
+    for (int i = 0; i < 8; ++i) {
+        FileNode branch = readFileNode(file);
+        checkLodCache(branch, MaxStarsPerNode);
+    }
+}
+
+TEST_CASE("OctreeManager: File Round Trip", "[octreemanager]") {
+    using namespace openspace;
+
+    const std::string path = folder("roundtrip");
+    const std::vector<std::vector<float>> stars = createStars(20000);
+    {
+        OctreeManager octree;
+        octree.initOctree(0, MaxDist, 64);
+        for (const std::vector<float>& star : stars) {
+            octree.insert(star);
+        }
+        octree.sliceLodData();
+        std::ofstream file(path + "octree.bin", std::ofstream::binary);
+        octree.writeToFile(file, true);
+    }
+
+    OctreeManager octree;
+    octree.initOctree();
+    std::ifstream in(path + "octree.bin", std::ifstream::binary);
+    REQUIRE(octree.readFromFile(in, true) == static_cast<int>(stars.size()));
+    {
+        std::ofstream file(path + "copy.bin", std::ofstream::binary);
+        octree.writeToFile(file, true);
+    }
+
+    std::ifstream original(path + "octree.bin", std::ifstream::binary);
+    std::ifstream copy(path + "copy.bin", std::ifstream::binary);
+    REQUIRE(std::equal(
+        std::istreambuf_iterator<char>(original),
+        std::istreambuf_iterator<char>(),
+        std::istreambuf_iterator<char>(copy),
+        std::istreambuf_iterator<char>()
+    ));
+}
+
+#endif // OPENSPACE_MODULE_GAIA_ENABLED
@@ -0,0 +1,247 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/space/rendering/orbitalcatalog.h>
+#include <modules/space/rendering/renderablesatellites.h>
+#include <modules/space/rendering/renderablesmallbody.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/misc/exception.h>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <random>
+
+using namespace openspace;
+
+namespace {
+    void writeFile(const std::string& path, const std::string& content) {
+        std::ofstream file(path, std::ofstream::binary);
+        file << content;
+    }
+
+    constexpr const char* SbdbHeader = "full_name,epoch_cal,e,a,i,om,w,ma,per\n";
+
+    constexpr const char* SbdbContent =
+        "full_name,epoch_cal,e,a,i,om,w,ma,per\n"
+        "\"     1 Ceres (A801 AA)\",20210705.0000000,.0778,2.766,10.59,80.27,73.73,"
+        "291.3,1680.\r\n"
+        "\"     2 Pallas (A802 FA)\",20210705.0000000,.2299,2.774,34.84,173.1,310.0,"
+        "-23.6,1686.\n"
+        "\"     3 Juno (A804 RA)\",20210705.0000000,abc,2.669,12.99,169.8,248.1,"
+        "125.5,1592.\n"
+        "\"     4 Vesta (A807 FA)\",20210705.0000000,.0885,2.362,7.142,103.8,150.7,"
+        "-400.0,1325.\n";
+
+    constexpr const char* TleContent =
+        "ISS (ZARYA)\n"
+        "1 25544U 98067A   21185.51782528  .00001264  00000-0  31434-4 0  9993\n"
+        "2 25544  51.6441 212.2035 0001970 203.1718 256.3537 15.48756254291328\n"
+        "HUBBLE\n"
+        "1 20580U 90037B   21185.18399306  .00000770  00000-0  38622-4 0  9990\n"
+        "2 20580  28.4694 312.5386 0002746 127.6433 327.1786 15.09836286510015\n";
+
+    bool isSameEntry(const orbitalcatalog::Entry& lhs, const orbitalcatalog::Entry& rhs) {
+        return std::memcmp(&lhs, &rhs, sizeof(orbitalcatalog::Entry)) == 0;
+    }
+
+    void requireSameCatalog(const orbitalcatalog::Catalog& lhs,
+                            const orbitalcatalog::Catalog& rhs)
+    {
+        REQUIRE(lhs.nEntries() == rhs.nEntries());
+        for (size_t i = 0; i < lhs.nEntries(); ++i) {
+            REQUIRE(lhs.isValid(i) == rhs.isValid(i));
+            REQUIRE(isSameEntry(lhs.entry(i), rhs.entry(i)));
+            REQUIRE(lhs.name(i) == rhs.name(i));
+        }
+    }
+
+    // A synthetic Small-Body Database file with nLines objects
+    void writeSbdbFile(const std::string& path, int nLines) {
+        std::mt19937 gen(1337);
+        std::uniform_real_distribution<double> ecc(0.0, 0.95);
+        std::uniform_real_distribution<double> axis(0.5, 50.0);
+        std::uniform_real_distribution<double> angle(0.0, 360.0);
+        std::uniform_int_distribution<int> day(1, 28);
+
+        std::ofstream file(path, std::ofstream::binary);
+        file << SbdbHeader;
+        for (int i = 0; i < nLines; ++i) {
+            file << fmt::format(
+                "\"{:>7} Object {}\",202107{:02}.0000000,{:.6f},{:.6f},{:.5f},{:.5f},"
+                "{:.5f},{:.5f},{:.2f}\n",
+                i, i, day(gen), ecc(gen), axis(gen), angle(gen) / 2.0,
+                angle(gen), angle(gen), angle(gen), 100.0 + angle(gen) * 10.0
+            );
+        }
+    }
+} // namespace
+
+TEST_CASE("OrbitalCatalog: Small Body Database", "[orbitalcatalog]") {
+    const std::string path = absPath("${TESTDIR}/catalog.csv");
+    writeFile(path, SbdbContent);
+
+    const orbitalcatalog::Catalog catalog =
+        orbitalcatalog::loadCatalog(path, RenderableSmallBody::catalogFormat());
+    REQUIRE(catalog.nEntries() == 4);
+    CHECK_FALSE(catalog.isMemoryMapped());
+
+    CHECK(catalog.isValid(0));
+    CHECK(catalog.name(0) == "1 Ceres (A801 AA)");
+    CHECK(catalog.entry(0).eccentricity == Approx(0.0778));
+    CHECK(catalog.entry(0).semiMajorAxis == Approx(2.766 * 1.496e8));
+    CHECK(catalog.entry(0).inclination == Approx(10.59));
+    CHECK(catalog.entry(0).period == Approx(1680.0 * 86400.0));
+
+    // Negative angles are wrapped into [0, 360)
+    CHECK(catalog.isValid(1));
+    CHECK(catalog.entry(1).meanAnomaly == Approx(336.4));
+
+    // Objects that cannot be parsed keep their index so that all following objects
+    // have the same index as in the file
+    CHECK_FALSE(catalog.isValid(2));
+    CHECK(catalog.isValid(3));
+    CHECK(catalog.name(3) == "4 Vesta (A807 FA)");
+    CHECK(catalog.entry(3).meanAnomaly == Approx(320.0));
+}
+
+TEST_CASE("OrbitalCatalog: Rejected Files", "[orbitalcatalog]") {
+    const std::string path = absPath("${TESTDIR}/rejected.csv");
+    const orbitalcatalog::Format format = RenderableSmallBody::catalogFormat();
+
+    writeFile(path, "name,epoch,e\n\"1 Ceres\",20210705.0000000,.0778\n");
+    CHECK(orbitalcatalog::loadCatalog(path, format).nEntries() == 0);
+
+    std::string content = SbdbHeader;
+    for (int i = 0; i < format.maxSequentialErrors; ++i) {
+        content += "\"Broken\",20210705.0000000,a,b,c,d,e,f,g\n";
+    }
+    writeFile(path, content);
+    CHECK(orbitalcatalog::loadCatalog(path, format).nEntries() == 0);
+
+    CHECK_THROWS_AS(
+        orbitalcatalog::loadCatalog(absPath("${TESTDIR}/missing.csv"), format),
+        ghoul::RuntimeError
+    );
+}
+
+TEST_CASE("OrbitalCatalog: Two-Line Elements", "[orbitalcatalog]") {
+    const std::string path = absPath("${TESTDIR}/catalog.tle");
+    writeFile(path, TleContent);
+
+    const orbitalcatalog::Catalog catalog =
+        orbitalcatalog::loadCatalog(path, RenderableSatellites::catalogFormat());
+    REQUIRE(catalog.nEntries() == 2);
+    CHECK(catalog.isValid(0));
+    CHECK(catalog.name(0) == "ISS (ZARYA) 25544U 98067A  ");
+    CHECK(catalog.entry(0).inclination == Approx(51.6441));
+    CHECK(catalog.entry(0).eccentricity == Approx(0.000197));
+    CHECK(catalog.entry(0).meanMotion == Approx(15.48756254));
+    CHECK(catalog.entry(0).period == Approx(86400.0 / 15.48756254));
+    CHECK(catalog.entry(1).ascendingNode == Approx(312.5386));
+
+    // A missing line header makes the entire file unusable
+    std::string broken = TleContent;
+    broken[broken.find("\n2 20580") + 1] = '3';
+    writeFile(path, broken);
+    CHECK_THROWS_AS(
+        orbitalcatalog::loadCatalog(path, RenderableSatellites::catalogFormat()),
+        ghoul::RuntimeError
+    );
+}
+
+TEST_CASE("OrbitalCatalog: Malformed Two-Line Elements", "[orbitalcatalog]") {
+    const std::string path = absPath("${TESTDIR}/malformed.tle");
+    const std::string content = std::string(TleContent) +
+        // The second line is cut off after the inclination
+        "TRUNCATED\n"
+        "1 00001U 98067A   21185.51782528  .00001264  00000-0  31434-4 0  9993\n"
+        "2 00001  51.6441\n"
+        // A mean motion of zero has no orbital period
+        "STATIONARY\n"
+        "1 00002U 98067A   21185.51782528  .00001264  00000-0  31434-4 0  9993\n"
+        "2 00002  51.6441 212.2035 0001970 203.1718 256.3537  0.00000000291328\n";
+    writeFile(path, content);
+
+    const orbitalcatalog::Catalog catalog =
+        orbitalcatalog::loadCatalog(path, RenderableSatellites::catalogFormat());
+    REQUIRE(catalog.nEntries() == 4);
+    CHECK(catalog.isValid(0));
+    CHECK(catalog.isValid(1));
+    CHECK_FALSE(catalog.isValid(2));
+    CHECK_FALSE(catalog.isValid(3));
+
+    // Only the valid entries can be propagated, which is why the renderable skips the
+    // others
+    for (size_t i = 0; i < catalog.nEntries(); ++i) {
+        const double period = catalog.entry(i).period;
+        CHECK((std::isfinite(period) && period > 0.0) == catalog.isValid(i));
+    }
+}
+
+TEST_CASE("OrbitalCatalog: Parallel Parsing Matches Serial", "[orbitalcatalog]") {
+    const std::string path = absPath("${TESTDIR}/parallel.csv");
+    writeSbdbFile(path, 20000);
+
+    const orbitalcatalog::Format format = RenderableSmallBody::catalogFormat();
+    const orbitalcatalog::Catalog serial = orbitalcatalog::loadCatalog(
+        path,
+        format,
+        orbitalcatalog::Parallel::No
+    );
+    const orbitalcatalog::Catalog parallel = orbitalcatalog::loadCatalog(path, format);
+    REQUIRE(serial.nEntries() == 20000);
+    requireSameCatalog(serial, parallel);
+}
+
+TEST_CASE("OrbitalCatalog: Cache Roundtrip", "[orbitalcatalog]") {
+    const std::string path = absPath("${TESTDIR}/roundtrip.csv");
+    const std::string cachePath = absPath("${TESTDIR}/roundtrip.orbitalcache");
+    writeSbdbFile(path, 1000);
+
+    const orbitalcatalog::Catalog catalog =
+        orbitalcatalog::loadCatalog(path, RenderableSmallBody::catalogFormat());
+    const uint64_t hash = orbitalcatalog::contentHash(path);
+    orbitalcatalog::saveCachedCatalog(catalog, cachePath, hash);
+
+    std::optional<orbitalcatalog::Catalog> cached =
+        orbitalcatalog::loadCachedCatalog(cachePath, hash);
+    REQUIRE(cached.has_value());
+    CHECK(cached->isMemoryMapped());
+    requireSameCatalog(catalog, *cached);
+
+    // Moving a catalog keeps its contents
+    const orbitalcatalog::Catalog moved = std::move(*cached);
+    requireSameCatalog(catalog, moved);
+
+    // A cache file for different file contents is not used
+    CHECK_FALSE(orbitalcatalog::loadCachedCatalog(cachePath, hash + 1).has_value());
+
+    // Any change to the file changes the hash
+    writeSbdbFile(path, 1001);
+    CHECK(orbitalcatalog::contentHash(path) != hash);
+}
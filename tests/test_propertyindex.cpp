@@ -0,0 +1,213 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/properties/propertyindex.h>
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/scalar/boolproperty.h>
+#include <memory>
+
+namespace {
+    using namespace openspace::properties;
+
+    // A tree of PropertyOwners with nOwners owners below the root, each of which owns
+    // nProperties BoolPropertys. Every tenth owner is tagged with "Tagged"
+    struct PropertyTree {
+        PropertyTree(int nOwners, int nProperties) {
+            for (int i = 0; i < nOwners; ++i) {
+                const std::string id = "Owner" + std::to_string(i);
+                owners.push_back(std::make_unique<PropertyOwner>(
+                    PropertyOwner::PropertyOwnerInfo{ id }
+                ));
+                PropertyOwner& owner = *owners.back();
+                if (i % 10 == 0) {
+                    owner.addTag("Tagged");
+                }
+                for (int j = 0; j < nProperties; ++j) {
+                    const std::string pid = "Property" + std::to_string(j);
+                    properties.push_back(std::make_unique<BoolProperty>(
+                        Property::PropertyInfo(pid.c_str(), pid.c_str(), "")
+                    ));
+                    owner.addProperty(*properties.back());
+                }
+                root.addPropertySubOwner(owner);
+            }
+        }
+
+        PropertyOwner root = PropertyOwner({ "Root" });
+        std::vector<std::unique_ptr<PropertyOwner>> owners;
+        std::vector<std::unique_ptr<BoolProperty>> properties;
+    };
+
+    // The matching as it was done before the PropertyIndex existed, restricted to
+    // wildcard patterns without group tags
+    std::vector<Property*> bruteForceMatch(const PropertyOwner& root,
+                                           const std::string& nodeName,
+                                           const std::string& propertyName)
+    {
+        std::vector<Property*> result;
+        for (Property* prop : root.propertiesRecursive()) {
+            const std::string id = prop->fullyQualifiedIdentifier();
+            const size_t propertyPos = id.find(propertyName);
+            if (propertyPos == std::string::npos ||
+                (propertyPos + propertyName.length() + 1) < id.length())
+            {
+                continue;
+            }
+            if (!nodeName.empty() && id.find(nodeName) == std::string::npos) {
+                continue;
+            }
+            result.push_back(prop);
+        }
+        return result;
+    }
+} // namespace
+
+TEST_CASE("PropertyIndex: Literal", "[propertyindex]") {
+    PropertyTree tree(5, 3);
+    PropertyIndex index;
+    index.setRootOwners({ &tree.root });
+
+    REQUIRE(index.properties().size() == 15);
+    REQUIRE(index.property("Root.Owner2.Property1") == tree.properties[7].get());
+    REQUIRE(index.property("Root.Owner2.Property3") == nullptr);
+
+    const std::vector<Property*>& m = index.matchingProperties("Root.Owner4.Property0");
+    REQUIRE(m.size() == 1);
+    REQUIRE(m[0] == tree.properties[12].get());
+    REQUIRE(index.matchingProperties("Root.Owner4.Property").empty());
+}
+
+TEST_CASE("PropertyIndex: Wildcard", "[propertyindex]") {
+    PropertyTree tree(25, 4);
+    PropertyIndex index;
+    index.setRootOwners({ &tree.root });
+
+    REQUIRE(
+        index.matchingProperties("*.Property2") ==
+        bruteForceMatch(tree.root, "", ".Property2")
+    );
+    REQUIRE(
+        index.matchingProperties("Root.Owner1*.Property0") ==
+        bruteForceMatch(tree.root, "Root.Owner1", ".Property0")
+    );
+    REQUIRE(index.matchingProperties("Root.Owner1*.Property0").size() == 11);
+
+    // Node names that are not at the beginning of the URI do not match
+    REQUIRE(index.matchingProperties("Owner3.*").empty());
+    REQUIRE(index.matchingProperties("Root.Owner3.*").size() == 4);
+}
+
+TEST_CASE("PropertyIndex: Tags", "[propertyindex]") {
+    PropertyTree tree(25, 4);
+    PropertyIndex index;
+    index.setRootOwners({ &tree.root });
+
+    REQUIRE(index.propertiesWithTag("Tagged").size() == 3 * 4);
+    REQUIRE(index.propertiesWithTag("Missing").empty());
+
+    // Owners 0, 10, and 20 are tagged
+    const std::vector<Property*>& m = index.matchingProperties(".Property1", "Tagged");
+    REQUIRE(m.size() == 3);
+    REQUIRE(m[0] == tree.properties[1].get());
+    REQUIRE(m[1] == tree.properties[41].get());
+    REQUIRE(m[2] == tree.properties[81].get());
+
+    // The tag applies to the Propertys of all sub-owners as well
+    tree.root.addTag("Tagged");
+    REQUIRE(index.propertiesWithTag("Tagged").size() == 25 * 4);
+    REQUIRE(index.matchingProperties(".Property1", "Tagged").size() == 25);
+}
+
+TEST_CASE("PropertyIndex: Invalidation", "[propertyindex]") {
+    PropertyTree tree(5, 3);
+    PropertyIndex index;
+    index.setRootOwners({ &tree.root });
+    REQUIRE(index.matchingProperties("*.Property0").size() == 5);
+
+    BoolProperty added(Property::PropertyInfo("Property0", "Property0", ""));
+    PropertyOwner owner({ "Owner5" });
+    owner.addProperty(added);
+    tree.root.addPropertySubOwner(owner);
+    REQUIRE(index.matchingProperties("*.Property0").size() == 6);
+    REQUIRE(index.property("Root.Owner5.Property0") == &added);
+
+    owner.setIdentifier("Renamed");
+    REQUIRE(index.property("Root.Owner5.Property0") == nullptr);
+    REQUIRE(index.property("Root.Renamed.Property0") == &added);
+
+    owner.removeProperty(added);
+    REQUIRE(index.matchingProperties("*.Property0").size() == 5);
+    tree.root.removePropertySubOwner(owner);
+}
+
+TEST_CASE("PropertyIndex: Incremental Update", "[propertyindex]") {
+    PropertyTree tree(20, 3);
+    PropertyIndex index;
+    index.setRootOwners({ &tree.root });
+
+    const std::vector<Property*>* wildcard =
+        &index.matchingProperties("Root.Owner1*.Property0");
+    REQUIRE(wildcard->size() == 11);
+    REQUIRE(index.matchingProperties(".Property2", "Tagged").size() == 2);
+
+    // Changes that do not match a pattern keep its cached result, even if the changed
+    // owner has Propertys that match the pattern
+    BoolProperty added(Property::PropertyInfo("Property3", "Property3", ""));
+    tree.owners[12]->addProperty(added);
+    REQUIRE(index.property("Root.Owner12.Property3") == &added);
+    REQUIRE(&index.matchingProperties("Root.Owner1*.Property0") == wildcard);
+    REQUIRE(index.properties() == tree.root.propertiesRecursive());
+
+    BoolProperty child(Property::PropertyInfo("Property0", "Property0", ""));
+    PropertyOwner childOwner({ "Child" });
+    childOwner.addProperty(child);
+    tree.owners[19]->addPropertySubOwner(childOwner);
+    REQUIRE(index.matchingProperties("Root.Owner1*.Property0").size() == 12);
+    REQUIRE(index.property("Root.Owner19.Child.Property0") == &child);
+
+    // Moving an owner changes the URIs of its whole subtree
+    tree.root.removePropertySubOwner(*tree.owners[3]);
+    tree.owners[4]->addPropertySubOwner(*tree.owners[3]);
+    REQUIRE(index.property("Root.Owner3.Property0") == nullptr);
+    REQUIRE(index.property("Root.Owner4.Owner3.Property0") == tree.properties[9].get());
+    REQUIRE(index.properties() == tree.root.propertiesRecursive());
+
+    // Removing a tag removes the Propertys of all sub-owners from the tag
+    tree.owners[19]->addTag("Tagged");
+    REQUIRE(index.propertiesWithTag("Tagged").size() == 2 * 3 + 3 + 1);
+    REQUIRE(index.matchingProperties(".Property2", "Tagged").size() == 3);
+    tree.owners[0]->removeTag("Tagged");
+    tree.owners[19]->removeTag("Tagged");
+    REQUIRE(index.propertiesWithTag("Tagged").size() == 3);
+    REQUIRE(index.matchingProperties(".Property2", "Tagged").size() == 1);
+
+    tree.owners[19]->removePropertySubOwner(childOwner);
+    tree.owners[12]->removeProperty(added);
+    REQUIRE(index.property("Root.Owner19.Child.Property0") == nullptr);
+    REQUIRE(index.property("Root.Owner12.Property3") == nullptr);
+    REQUIRE(index.matchingProperties("Root.Owner1*.Property0").size() == 11);
+    REQUIRE(index.properties() == tree.root.propertiesRecursive());
+}
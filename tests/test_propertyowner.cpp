@@ -0,0 +1,125 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/engine/globals.h>
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/scalar/boolproperty.h>
+#include <openspace/query/query.h>
+#include <ghoul/fmt.h>
+#include <array>
+#include <memory>
+
+namespace {
+    using namespace openspace::properties;
+
+    constexpr const char* DeepUri = "Earth.Renderable.Layers.ColorLayers.X.Enabled";
+
+    // Builds the hierarchy Earth.Renderable.Layers.ColorLayers.X.Enabled where every
+    // level has nSiblings additional sub-owners and properties that do not match
+    struct OwnerHierarchy {
+        explicit OwnerHierarchy(int nSiblings) {
+            PropertyOwner* parent = &root;
+            const std::array<const char*, 5> ids = {
+                "Earth", "Renderable", "Layers", "ColorLayers", "X"
+            };
+            for (const char* id : ids) {
+                for (int i = 0; i < nSiblings; ++i) {
+                    const std::string sid = fmt::format("{}{}", id, i);
+                    owners.push_back(std::make_unique<PropertyOwner>(
+                        PropertyOwner::PropertyOwnerInfo{ sid }
+                    ));
+                    parent->addPropertySubOwner(*owners.back());
+
+                    const std::string pid = fmt::format("{}Property{}", id, i);
+                    properties.push_back(std::make_unique<BoolProperty>(
+                        Property::PropertyInfo(pid.c_str(), pid.c_str(), "")
+                    ));
+                    parent->addProperty(*properties.back());
+                }
+
+                owners.push_back(std::make_unique<PropertyOwner>(
+                    PropertyOwner::PropertyOwnerInfo{ id }
+                ));
+                parent->addPropertySubOwner(*owners.back());
+                parent = owners.back().get();
+            }
+
+            enabled = std::make_unique<BoolProperty>(
+                Property::PropertyInfo("Enabled", "Enabled", "")
+            );
+            parent->addProperty(*enabled);
+        }
+
+        ~OwnerHierarchy() {
+            if (root.owner()) {
+                root.owner()->removePropertySubOwner(root);
+            }
+        }
+
+        PropertyOwner root = PropertyOwner({ "Hierarchy" });
+        std::vector<std::unique_ptr<PropertyOwner>> owners;
+        std::vector<std::unique_ptr<BoolProperty>> properties;
+        std::unique_ptr<BoolProperty> enabled;
+    };
+} // namespace
+
+TEST_CASE("PropertyOwner: Resolve URI", "[propertyowner]") {
+    OwnerHierarchy h(3);
+
+    REQUIRE(h.root.property(DeepUri) == h.enabled.get());
+    REQUIRE(h.root.property("Earth.Renderable.Layers.ColorLayers.X.Missing") == nullptr);
+    REQUIRE(h.root.property("Earth.Renderable.Layers.Missing.X.Enabled") == nullptr);
+    REQUIRE(h.root.property("Earth.Renderable.Layers.ColorLayers.X.") == nullptr);
+    REQUIRE(h.root.property("") == nullptr);
+    REQUIRE(h.root.property("EarthProperty1") == h.properties[1].get());
+    REQUIRE(h.root.property("Earth.RenderableProperty2") == h.properties[5].get());
+    REQUIRE(h.root.hasProperty(std::string(DeepUri)));
+
+    // Only the part up to the end of the view is used
+    const std::string_view withSuffix = "EarthProperty1.Suffix";
+    REQUIRE(h.root.property(withSuffix.substr(0, 14)) == h.properties[1].get());
+}
+
+TEST_CASE("PropertyOwner: URI Lookup", "[propertyowner]") {
+    using namespace openspace;
+
+    OwnerHierarchy h(3);
+    global::rootPropertyOwner->addPropertySubOwner(h.root);
+
+    const std::string uri = std::string("Hierarchy.") + DeepUri;
+    REQUIRE(property(uri) == h.enabled.get());
+    REQUIRE(property(uri) == h.enabled.get());
+
+    // Renaming an owner has to be reflected in the lookup
+    h.owners.back()->setIdentifier("Y");
+    REQUIRE(property(uri) == nullptr);
+    REQUIRE(property("Hierarchy.Earth.Renderable.Layers.ColorLayers.Y.Enabled") ==
+            h.enabled.get());
+
+    h.owners.back()->removeProperty(*h.enabled);
+    REQUIRE(property("Hierarchy.Earth.Renderable.Layers.ColorLayers.Y.Enabled") ==
+            nullptr);
+}
@@ -0,0 +1,133 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <array>
+#include <filesystem>
+#include <vector>
+#include <gdal.h>
+#include <ogr_srs_api.h>
+
+namespace {
+    // Creates a global, pixel-interleaved GeoTIFF with internal overviews. Every band
+    // is filled by the function f(band, x, y)
+    template <typename Func>
+    void createGeoTiff(const std::string& path, int width, int height, int nBands,
+                       Func f, const char* compression = "NONE")
+    {
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        GDALAllRegister();
+
+        GDALDriverH driver = GDALGetDriverByName("GTiff");
+        REQUIRE(driver);
+        const std::string compress = fmt::format("COMPRESS={}", compression);
+        char* options[] = {
+            const_cast<char*>("TILED=YES"),
+            const_cast<char*>("INTERLEAVE=PIXEL"),
+            const_cast<char*>(compress.c_str()),
+            nullptr
+        };
+        GDALDatasetH ds = GDALCreate(
+            driver, path.c_str(), width, height, nBands, GDT_Byte, options
+        );
+        REQUIRE(ds);
+        double transform[6] = { -180.0, 360.0 / width, 0.0, 90.0, 0.0, -180.0 / height };
+        GDALSetGeoTransform(ds, transform);
+        OGRSpatialReferenceH srs = OSRNewSpatialReference(nullptr);
+        OSRSetWellKnownGeogCS(srs, "WGS84");
+        char* wkt = nullptr;
+        OSRExportToWkt(srs, &wkt);
+        GDALSetProjection(ds, wkt);
+        CPLFree(wkt);
+        OSRDestroySpatialReference(srs);
+
+        std::vector<uint8_t> line(static_cast<size_t>(width) * nBands);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                for (int b = 0; b < nBands; ++b) {
+                    line[static_cast<size_t>(x) * nBands + b] = f(b + 1, x, y);
+                }
+            }
+            const CPLErr err = GDALDatasetRasterIO(
+                ds, GF_Write, 0, y, width, 1, line.data(), width, 1, GDT_Byte, nBands,
+                nullptr, nBands, 0, 1
+            );
+            REQUIRE(err == CE_None);
+        }
+        int levels[] = { 2, 4, 8 };
+        GDALBuildOverviews(ds, "NEAREST", 3, levels, 0, nullptr, nullptr, nullptr);
+        GDALClose(ds);
+    }
+
+    // Reads the tile (0, 0, 1) into a BGRA color tile and checks every pixel
+    void checkChannels(int nBands, std::array<uint8_t, 4> expected) {
+        using namespace openspace::globebrowsing;
+
+        const std::string path = absPath(
+            fmt::format("${{TESTDIR}}/rawtiledatareader/bands{}.tif", nBands)
+        );
+        createGeoTiff(
+            path, 256, 128, nBands,
+            [](int band, int, int) { return static_cast<uint8_t>(10 * band); }
+        );
+
+        const TileTextureInitData initData =
+            tileTextureInitData(layergroupid::GroupID::ColorLayers, false, 64);
+        RawTileDataReader reader(path, initData);
+        const RawTile tile = reader.readTileData(TileIndex(0, 0, 1));
+        REQUIRE(tile.error == RawTile::ReadError::None);
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(tile.imageData.get());
+        for (size_t i = 0; i < initData.totalNumBytes; i += 4) {
+            INFO(fmt::format("Pixel {}", i / 4));
+            REQUIRE(data[i + 0] == expected[0]);
+            REQUIRE(data[i + 1] == expected[1]);
+            REQUIRE(data[i + 2] == expected[2]);
+            REQUIRE(data[i + 3] == expected[3]);
+        }
+    }
+} // namespace
+
+TEST_CASE("RawTileDataReader: Grayscale", "[rawtiledatareader]") {
+    // The gray band is replicated into all color channels, alpha is not written
+    checkChannels(1, { 10, 10, 10, 0xFF });
+}
+
+TEST_CASE("RawTileDataReader: Grayscale Alpha", "[rawtiledatareader]") {
+    checkChannels(2, { 10, 10, 10, 20 });
+}
+
+TEST_CASE("RawTileDataReader: RGB", "[rawtiledatareader]") {
+    // Color tiles are stored as BGRA
+    checkChannels(3, { 30, 20, 10, 0xFF });
+}
+
+TEST_CASE("RawTileDataReader: RGBA", "[rawtiledatareader]") {
+    checkChannels(4, { 30, 20, 10, 40 });
+}
@@ -0,0 +1,293 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/rendering/renderable.h>
+#include <openspace/scene/scene.h>
+#include <openspace/scene/scenegraphnode.h>
+#include <openspace/scene/sceneinitializer.h>
+#include <openspace/scene/translation.h>
+#include <openspace/util/factorymanager.h>
+#include <openspace/util/updatestructures.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/templatefactory.h>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace {
+    // A Translation that is not thread-safe and records the thread it was updated on
+    class MainThreadTranslation : public openspace::Translation {
+    public:
+        MainThreadTranslation(const ghoul::Dictionary& dictionary)
+            : _offset(dictionary.value<double>("Offset"))
+        {}
+
+        glm::dvec3 position(const openspace::UpdateData& data) const override {
+            updateThread = std::this_thread::get_id();
+            return glm::dvec3(_offset, data.time.j2000Seconds() * 1e-3, 1.0);
+        }
+
+        static inline std::thread::id updateThread;
+
+    private:
+        double _offset;
+    };
+
+    // A Renderable that records the world position of another node during its update
+    class RecordingRenderable : public openspace::Renderable {
+    public:
+        RecordingRenderable(const ghoul::Dictionary& dictionary)
+            : openspace::Renderable(dictionary)
+        {}
+
+        bool isReady() const override {
+            return true;
+        }
+
+        void update(const openspace::UpdateData&) override {
+            recordedPosition = target->worldPosition();
+        }
+
+        static inline openspace::SceneGraphNode* target = nullptr;
+        static inline glm::dvec3 recordedPosition = glm::dvec3(0.0);
+    };
+
+    openspace::Translation* translationOf(openspace::SceneGraphNode* node) {
+        return dynamic_cast<openspace::Translation*>(
+            node->propertySubOwner("Translation")
+        );
+    }
+
+    ghoul::Dictionary staticTransform(int index) {
+        const double i = static_cast<double>(index);
+
+        ghoul::Dictionary translation;
+        translation.setValue("Type", std::string("StaticTranslation"));
+        translation.setValue("Position", glm::dvec3(i, 2.0 * i, -0.5 * i));
+
+        ghoul::Dictionary rotation;
+        rotation.setValue("Type", std::string("StaticRotation"));
+        rotation.setValue("Rotation", glm::dvec3(0.1 * i, 0.2, -0.3 * i));
+
+        ghoul::Dictionary scale;
+        scale.setValue("Type", std::string("StaticScale"));
+        scale.setValue("Scale", 1.0 + 0.01 * i);
+
+        ghoul::Dictionary transform;
+        transform.setValue("Translation", translation);
+        transform.setValue("Rotation", rotation);
+        transform.setValue("Scale", scale);
+        return transform;
+    }
+
+    ghoul::Dictionary mainThreadTransform(int index) {
+        ghoul::Dictionary translation;
+        translation.setValue("Type", std::string("MainThreadTranslation"));
+        translation.setValue("Offset", static_cast<double>(index));
+
+        ghoul::Dictionary transform;
+        transform.setValue("Translation", translation);
+        return transform;
+    }
+
+    // Creates a tree of nNodes nodes in which every node has up to four children. Every
+    // seventh node uses a Translation that is not thread-safe
+    std::vector<openspace::SceneGraphNode*> createScene(openspace::Scene& scene,
+                                                        int nNodes)
+    {
+        using namespace openspace;
+
+        auto factory = FactoryManager::ref().factory<Translation>();
+        if (!factory->hasClass("MainThreadTranslation")) {
+            factory->registerClass<MainThreadTranslation>("MainThreadTranslation");
+        }
+
+        std::vector<SceneGraphNode*> nodes;
+        for (int i = 0; i < nNodes; ++i) {
+            ghoul::Dictionary dict;
+            dict.setValue("Identifier", "Node" + std::to_string(i));
+            if (i > 0) {
+                dict.setValue("Parent", "Node" + std::to_string((i - 1) / 4));
+            }
+            dict.setValue(
+                "Transform",
+                i % 7 == 3 ? mainThreadTransform(i) : staticTransform(i)
+            );
+
+            SceneGraphNode* node = scene.loadNode(dict);
+            scene.initializeNode(node);
+            nodes.push_back(node);
+        }
+        return nodes;
+    }
+
+    openspace::UpdateData updateData(double time) {
+        using namespace openspace;
+        return UpdateData{ TransformData(), Time(time), Time(time - 1.0) };
+    }
+} // namespace
+
+TEST_CASE("SceneUpdate: Parallel Matches Serial", "[sceneupdate]") {
+    using namespace openspace;
+
+    constexpr const int NNodes = 500;
+
+    Scene serial(std::make_unique<SingleThreadedSceneInitializer>());
+    std::vector<SceneGraphNode*> serialNodes = createScene(serial, NNodes);
+
+    Scene parallel(std::make_unique<SingleThreadedSceneInitializer>());
+    std::vector<SceneGraphNode*> parallelNodes = createScene(parallel, NNodes);
+    parallel.setParallelUpdate(true);
+
+    for (double time : { 0.0, 1000.0, 1e6 }) {
+        serial.update(updateData(time));
+
+        MainThreadTranslation::updateThread = std::thread::id();
+        parallel.update(updateData(time));
+        REQUIRE(MainThreadTranslation::updateThread == std::this_thread::get_id());
+
+        bool allEqual = true;
+        for (int i = 0; i < NNodes; ++i) {
+            allEqual &= serialNodes[i]->modelTransform() ==
+                        parallelNodes[i]->modelTransform();
+            allEqual &= serialNodes[i]->worldPosition() ==
+                        parallelNodes[i]->worldPosition();
+        }
+        REQUIRE(allEqual);
+    }
+}
+
+TEST_CASE("SceneUpdate: Disable Parallel Update", "[sceneupdate]") {
+    using namespace openspace;
+
+    Scene scene(std::make_unique<SingleThreadedSceneInitializer>());
+    std::vector<SceneGraphNode*> nodes = createScene(scene, 50);
+    scene.setParallelUpdate(true);
+    scene.update(updateData(10.0));
+    const glm::dmat4 parallelTransform = nodes.back()->modelTransform();
+
+    scene.setParallelUpdate(false);
+    scene.update(updateData(10.0));
+    REQUIRE(nodes.back()->modelTransform() == parallelTransform);
+}
+
+TEST_CASE("SceneUpdate: Translation Observers On Main Thread", "[sceneupdate]") {
+    using namespace openspace;
+
+    constexpr const int NNodes = 500;
+
+    Scene serial(std::make_unique<SingleThreadedSceneInitializer>());
+    std::vector<SceneGraphNode*> serialNodes = createScene(serial, NNodes);
+    int nSerialNotifications = 0;
+    for (SceneGraphNode* node : serialNodes) {
+        translationOf(node)->onParameterChange([&]() { ++nSerialNotifications; });
+    }
+
+    Scene parallel(std::make_unique<SingleThreadedSceneInitializer>());
+    std::vector<SceneGraphNode*> parallelNodes = createScene(parallel, NNodes);
+    parallel.setParallelUpdate(true);
+    std::mutex mutex;
+    std::set<std::thread::id> threadIds;
+    int nParallelNotifications = 0;
+    for (SceneGraphNode* node : parallelNodes) {
+        translationOf(node)->onParameterChange([&]() {
+            std::lock_guard lock(mutex);
+            threadIds.insert(std::this_thread::get_id());
+            ++nParallelNotifications;
+        });
+    }
+
+    for (double time : { 0.0, 1000.0, 1e6 }) {
+        serial.update(updateData(time));
+        parallel.update(updateData(time));
+    }
+
+    REQUIRE(nSerialNotifications > 0);
+    REQUIRE(nParallelNotifications == nSerialNotifications);
+    REQUIRE(threadIds == std::set<std::thread::id>{ std::this_thread::get_id() });
+}
+
+TEST_CASE("SceneUpdate: Renderables See Transforms Of Later Nodes", "[sceneupdate]") {
+    using namespace openspace;
+
+    auto factory = FactoryManager::ref().factory<Renderable>();
+    if (!factory->hasClass("RecordingRenderable")) {
+        factory->registerClass<RecordingRenderable>("RecordingRenderable");
+    }
+
+    // The first node records the position of its child, which comes later in the
+    // topological order and moves with the time
+    auto createRecordingScene = [](Scene& scene) {
+        ghoul::Dictionary renderable;
+        renderable.setValue("Type", std::string("RecordingRenderable"));
+
+        ghoul::Dictionary parent;
+        parent.setValue("Identifier", std::string("Parent"));
+        parent.setValue("Transform", staticTransform(1));
+        parent.setValue("Renderable", renderable);
+        scene.initializeNode(scene.loadNode(parent));
+
+        ghoul::Dictionary child;
+        child.setValue("Identifier", std::string("Child"));
+        child.setValue("Parent", std::string("Parent"));
+        child.setValue("Transform", mainThreadTransform(2));
+        SceneGraphNode* node = scene.loadNode(child);
+        scene.initializeNode(node);
+        return node;
+    };
+
+    SECTION("Serial") {
+        Scene scene(std::make_unique<SingleThreadedSceneInitializer>());
+        RecordingRenderable::target = createRecordingScene(scene);
+        scene.update(updateData(1000.0));
+        const glm::dvec3 previousPosition = RecordingRenderable::target->worldPosition();
+
+        // The Renderable is updated before the transformation of the child, so it sees
+        // the position of the previous frame
+        scene.update(updateData(2000.0));
+        REQUIRE(RecordingRenderable::recordedPosition == previousPosition);
+        REQUIRE(RecordingRenderable::target->worldPosition() != previousPosition);
+    }
+
+    SECTION("Parallel") {
+        Scene scene(std::make_unique<SingleThreadedSceneInitializer>());
+        RecordingRenderable::target = createRecordingScene(scene);
+        scene.setParallelUpdate(true);
+        scene.update(updateData(1000.0));
+        const glm::dvec3 previousPosition = RecordingRenderable::target->worldPosition();
+
+        // All transformations are updated before the first Renderable, so it sees the
+        // position of the current frame
+        scene.update(updateData(2000.0));
+        REQUIRE(
+            RecordingRenderable::recordedPosition ==
+            RecordingRenderable::target->worldPosition()
+        );
+        REQUIRE(RecordingRenderable::recordedPosition != previousPosition);
+    }
+
+    RecordingRenderable::target = nullptr;
+}
@@ -0,0 +1,363 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/util/speckloader.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/glm.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace openspace;
+
+namespace {
+    void writeFile(const std::string& path, const std::string& content) {
+        std::ofstream file(path, std::ofstream::binary);
+        file << content;
+    }
+
+    constexpr const char* SpeckContent =
+        "# A comment at the beginning\r\n"
+        "maxcomment 8\n"
+        "datavar 0 colorb_v\n"
+        "datavar 1 lum\n"
+        "datavar 2 orientation\n"
+        "polyorivar 2\n"
+        "texturevar 8\n"
+        "datavar 8 texnum\n"
+        "texture -M 1 first.sgi\n"
+        "texture 2 second.png\n"
+        "\n"
+        "1 2 3 0.5 10 1 0 0 0 1 0 1 # first entry\r\n"
+        "# A comment in between\n"
+        "4 5 6 0.25 20 0 1 0 0 0 1 2\n"
+        "7 8 9 0.125\n";
+
+    // The line-by-line stringstream parser that all renderables used before the speck
+    // loader was shared. The parallel parser has to produce exactly the same values
+    struct ReferenceData {
+        int nColumns = 0;
+        std::vector<std::vector<float>> entries;
+    };
+
+    ReferenceData referenceParse(const std::string& path) {
+        std::ifstream file(path);
+        ReferenceData res;
+
+        int nValues = 0;
+        std::string line;
+        bool hasDataLine = false;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line = line.substr(0, line.length() - 1);
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            if (line.substr(0, 7) != "datavar" &&
+                line.substr(0, 10) != "texturevar" &&
+                line.substr(0, 7) != "texture" &&
+                line.substr(0, 10) != "polyorivar" &&
+                line.substr(0, 10) != "maxcomment")
+            {
+                hasDataLine = true;
+                break;
+            }
+
+            if (line.substr(0, 7) == "datavar") {
+                std::stringstream str(line);
+                std::string dummy;
+                int index = 0;
+                std::string name;
+                str >> dummy >> index >> name;
+                const int n = (name == "orientation" || name == "ori") ? 6 : 1;
+                nValues = std::max(nValues, index + n);
+            }
+        }
+
+        res.nColumns = nValues + 3;
+        while (hasDataLine) {
+            if (!line.empty() && line.back() == '\r') {
+                line = line.substr(0, line.length() - 1);
+            }
+            if (!line.empty() && line[0] != '#') {
+                std::stringstream str(line);
+                std::vector<float> values(res.nColumns);
+                for (int i = 0; i < res.nColumns; ++i) {
+                    str >> values[i];
+                }
+                res.entries.push_back(std::move(values));
+            }
+            hasDataLine = static_cast<bool>(std::getline(file, line));
+        }
+        return res;
+    }
+
+    void checkEqual(const speck::Dataset& dataset, const ReferenceData& reference) {
+        REQUIRE(dataset.nColumns() == reference.nColumns);
+        REQUIRE(dataset.nEntries() == reference.entries.size());
+        for (size_t e = 0; e < reference.entries.size(); ++e) {
+            for (int c = 0; c < reference.nColumns; ++c) {
+                if (dataset.value(e, c) != reference.entries[e][c]) {
+                    FAIL(fmt::format(
+                        "Entry {} column {}: {} != {}",
+                        e, c, dataset.value(e, c), reference.entries[e][c]
+                    ));
+                }
+            }
+        }
+    }
+
+    // Writes a speck file with random values that also contains comments, empty lines,
+    // Windows line endings, and entries with missing values in between the data lines
+    void writeRandomSpeck(const std::string& path, int nEntries, int nValues,
+                          unsigned int seed)
+    {
+        std::ofstream file(path, std::ofstream::binary);
+        file << "# Randomly generated\n";
+        for (int i = 0; i < nValues; ++i) {
+            file << fmt::format("datavar {} value{}\n", i, i);
+        }
+
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dist(-1e4f, 1e4f);
+        std::uniform_int_distribution<int> special(0, 99);
+        for (int i = 0; i < nEntries; ++i) {
+            const int s = special(gen);
+            if (s == 0) {
+                file << "# A comment in between\n";
+            }
+            else if (s == 1) {
+                file << "\n";
+            }
+
+            const int nColumns = (s == 2) ? nValues : nValues + 3;
+            for (int j = 0; j < nColumns; ++j) {
+                file << dist(gen) << ' ';
+            }
+            file << ((s == 3) ? "\r\n" : "\n");
+        }
+    }
+} // namespace
+
+TEST_CASE("SpeckLoader: Parse Header", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/header.speck");
+    writeFile(path, SpeckContent);
+
+    speck::Dataset dataset = speck::loadSpeckFile(path);
+
+    CHECK(!dataset.isMemoryMapped());
+    REQUIRE(dataset.nColumns() == 12);
+    REQUIRE(dataset.variables().size() == 4);
+    CHECK(dataset.index("colorb_v") == 3);
+    CHECK(dataset.index("lum") == 4);
+    CHECK(dataset.index("orientation") == 5);
+    CHECK(dataset.index("texnum") == 11);
+    CHECK(dataset.index("unknown") == -1);
+    CHECK(dataset.orientationDataIndex() == 5);
+    CHECK(dataset.textureDataIndex() == 11);
+
+    REQUIRE(dataset.textures().size() == 2);
+    CHECK(dataset.textures()[0].index == 1);
+    CHECK(dataset.textures()[0].file == "first.sgi");
+    CHECK(dataset.textures()[1].index == 2);
+    CHECK(dataset.textures()[1].file == "second.png");
+}
+
+TEST_CASE("SpeckLoader: Parse Data", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/data.speck");
+    writeFile(path, SpeckContent);
+
+    speck::Dataset dataset = speck::loadSpeckFile(path);
+
+    REQUIRE(dataset.nEntries() == 3);
+    CHECK(dataset.position(0) == glm::vec3(1.f, 2.f, 3.f));
+    CHECK(dataset.position(1) == glm::vec3(4.f, 5.f, 6.f));
+    CHECK(dataset.position(2) == glm::vec3(7.f, 8.f, 9.f));
+
+    const int lum = dataset.index("lum");
+    CHECK(dataset.value(0, lum) == 10.f);
+    CHECK(dataset.value(1, lum) == 20.f);
+    // Missing values are filled with 0
+    CHECK(dataset.value(2, lum) == 0.f);
+
+    const int ori = dataset.orientationDataIndex();
+    CHECK(dataset.value(1, ori + 1) == 1.f);
+    CHECK(dataset.value(1, ori + 5) == 1.f);
+    CHECK(dataset.value(0, dataset.textureDataIndex()) == 1.f);
+    CHECK(dataset.value(1, dataset.textureDataIndex()) == 2.f);
+}
+
+TEST_CASE("SpeckLoader: Remove Entries", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/remove.speck");
+    writeFile(path, SpeckContent);
+
+    speck::Dataset dataset = speck::loadSpeckFile(path);
+    const int lum = dataset.index("lum");
+    dataset.removeEntries([&dataset, lum](size_t i) {
+        return dataset.value(i, lum) == 0.f;
+    });
+
+    REQUIRE(dataset.nEntries() == 2);
+    CHECK(dataset.position(1) == glm::vec3(4.f, 5.f, 6.f));
+    CHECK(dataset.value(1, lum) == 20.f);
+}
+
+TEST_CASE("SpeckLoader: Cache Roundtrip", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/roundtrip.speck");
+    const std::string cachePath = absPath("${TESTDIR}/roundtrip.speckcache");
+    writeFile(path, SpeckContent);
+
+    const speck::Dataset original = speck::loadSpeckFile(path);
+    speck::saveCachedDataset(original, cachePath);
+
+    std::optional<speck::Dataset> cached = speck::loadCachedDataset(cachePath);
+    REQUIRE(cached.has_value());
+    CHECK(cached->isMemoryMapped());
+
+    REQUIRE(cached->nEntries() == original.nEntries());
+    REQUIRE(cached->nColumns() == original.nColumns());
+    CHECK(cached->textureDataIndex() == original.textureDataIndex());
+    CHECK(cached->orientationDataIndex() == original.orientationDataIndex());
+
+    REQUIRE(cached->variables().size() == original.variables().size());
+    for (size_t i = 0; i < original.variables().size(); ++i) {
+        CHECK(cached->variables()[i].index == original.variables()[i].index);
+        CHECK(cached->variables()[i].name == original.variables()[i].name);
+    }
+    REQUIRE(cached->textures().size() == original.textures().size());
+    for (size_t i = 0; i < original.textures().size(); ++i) {
+        CHECK(cached->textures()[i].index == original.textures()[i].index);
+        CHECK(cached->textures()[i].file == original.textures()[i].file);
+    }
+
+    for (int c = 0; c < original.nColumns(); ++c) {
+        for (size_t e = 0; e < original.nEntries(); ++e) {
+            CHECK(cached->value(e, c) == original.value(e, c));
+        }
+    }
+}
+
+TEST_CASE("SpeckLoader: Cache Version Mismatch", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/version.speck");
+    const std::string cachePath = absPath("${TESTDIR}/version.speckcache");
+    writeFile(path, SpeckContent);
+    speck::saveCachedDataset(speck::loadSpeckFile(path), cachePath);
+
+    // Overwrite the version that follows the 4 byte magic number
+    {
+        std::fstream file(cachePath, std::fstream::in | std::fstream::out |
+            std::fstream::binary);
+        file.seekp(4);
+        const int32_t version = -1;
+        file.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+    }
+    CHECK_FALSE(speck::loadCachedDataset(cachePath).has_value());
+
+    // A truncated file must not be accepted either
+    writeFile(cachePath, "SPCK");
+    CHECK_FALSE(speck::loadCachedDataset(cachePath).has_value());
+}
+
+TEST_CASE("SpeckLoader: Cached Post Processing", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/postprocessing.speck");
+    writeFile(path, SpeckContent);
+
+    int nCalls = 0;
+    auto postProcessing = [&nCalls](speck::Dataset& dataset) {
+        nCalls++;
+        dataset.removeEntries([](size_t i) { return i == 0; });
+    };
+
+    speck::Dataset first = speck::loadSpeckFileCached(
+        path,
+        "SpeckLoaderTest",
+        postProcessing
+    );
+    speck::Dataset second = speck::loadSpeckFileCached(
+        path,
+        "SpeckLoaderTest",
+        postProcessing
+    );
+
+    // The second load comes from the cache that contains the post processed data
+    CHECK(nCalls <= 1);
+    CHECK(second.isMemoryMapped());
+    REQUIRE(first.nEntries() == 2);
+    REQUIRE(second.nEntries() == 2);
+    CHECK(second.position(0) == glm::vec3(4.f, 5.f, 6.f));
+}
+
+TEST_CASE("SpeckLoader: Golden File", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/SpeckLoaderTest/golden.speck");
+    const ReferenceData reference = referenceParse(path);
+    REQUIRE(reference.entries.size() == 6);
+
+    for (size_t nThreads : { 1, 2, 4 }) {
+        speck::Dataset dataset = speck::loadSpeckFile(path, nThreads);
+        checkEqual(dataset, reference);
+
+        CHECK(dataset.index("absmag") == 5);
+        CHECK(dataset.orientationDataIndex() == 6);
+        CHECK(dataset.textureDataIndex() == 12);
+        REQUIRE(dataset.textures().size() == 2);
+        CHECK(dataset.textures()[0].file == "first.sgi");
+    }
+}
+
+TEST_CASE("SpeckLoader: Parallel Parsing Matches Reference", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/parallel.speck");
+    // Large enough to be split into several chunks
+    writeRandomSpeck(path, 100'000, 8, 42);
+    const ReferenceData reference = referenceParse(path);
+
+    for (size_t nThreads : { 1, 3, 8 }) {
+        checkEqual(speck::loadSpeckFile(path, nThreads), reference);
+    }
+}
+
+TEST_CASE("SpeckLoader: Label File", "[speckloader]") {
+    const std::string path = absPath("${TESTDIR}/labels.label");
+    writeFile(
+        path,
+        "# Labels\n"
+        "textcolor 1\n"
+        "1 2 3 text Alpha Centauri # a comment\r\n"
+        "\n"
+        "4.5 5 6 text Sol\n"
+    );
+
+    std::vector<speck::Label> labels = speck::loadLabelFile(path);
+    REQUIRE(labels.size() == 2);
+    CHECK(labels[0].position == glm::vec3(1.f, 2.f, 3.f));
+    CHECK(labels[0].text == "Alpha Centauri");
+    CHECK(labels[1].position == glm::vec3(4.5f, 5.f, 6.f));
+    CHECK(labels[1].text == "Sol");
+}
@@ -490,3 +490,76 @@ TEST_CASE("SpiceManager: Get Field Of View", "[spicemanager]") {
 
     openspace::SpiceManager::deinitialize();
 }
+
+TEST_CASE("SpiceManager: Handles Match Names", "[spicemanager]") {
+    openspace::SpiceManager::initialize();
+
+    using openspace::SpiceManager;
+    loadMetaKernel();
+    SpiceManager& spice = SpiceManager::ref();
+
+    const SpiceManager::AberrationCorrection corr = {
+        SpiceManager::AberrationCorrection::Type::LightTimeStellar,
+        SpiceManager::AberrationCorrection::Direction::Reception
+    };
+
+    // The last time is outside of Cassini's coverage, so the position is estimated
+    const double times[] = {
+        spice.ephemerisTimeFromDate("2004 jun 11 19:32:00"),
+        spice.ephemerisTimeFromDate("2004 jun 20 00:00:00"),
+        spice.ephemerisTimeFromDate("1990 jan 01 00:00:00")
+    };
+    const std::pair<const char*, const char*> pairs[] = {
+        { "EARTH", "CASSINI" },
+        { "CASSINI", "PHOEBE" },
+        { "PHOEBE", "SATURN" }
+    };
+    const SpiceManager::FrameHandle frame = spice.frameHandle("J2000");
+    for (const std::pair<const char*, const char*>& p : pairs) {
+        const SpiceManager::BodyHandle target = spice.bodyHandle(p.first);
+        const SpiceManager::BodyHandle observer = spice.bodyHandle(p.second);
+        for (double et : times) {
+            double lightTimeName = 0.0;
+            const glm::dvec3 byName = spice.targetPosition(
+                p.first, p.second, "J2000", corr, et, lightTimeName
+            );
+            double lightTimeHandle = 0.0;
+            const glm::dvec3 byHandle = spice.targetPosition(
+                target, observer, frame, corr, et, lightTimeHandle
+            );
+            REQUIRE(byName == byHandle);
+            REQUIRE(lightTimeName == lightTimeHandle);
+        }
+    }
+
+    const double et = times[0];
+    const glm::dmat3 byName = spice.positionTransformMatrix("CASSINI_HGA", "J2000", et);
+    const glm::dmat3 byHandle = spice.positionTransformMatrix(
+        spice.frameHandle("CASSINI_HGA"),
+        frame,
+        et
+    );
+    REQUIRE(byName == byHandle);
+
+    openspace::SpiceManager::deinitialize();
+}
+
+TEST_CASE("SpiceManager: Handle Sees Later Kernels", "[spicemanager]") {
+    openspace::SpiceManager::initialize();
+
+    using openspace::SpiceManager;
+    SpiceManager& spice = SpiceManager::ref();
+    loadLSKKernel();
+
+    const double et = spice.ephemerisTimeFromDate("2004 jun 11 19:32:00");
+    const SpiceManager::BodyHandle cassini = spice.bodyHandle("CASSINI");
+    REQUIRE_FALSE(spice.hasSpkCoverage(cassini, et));
+
+    spice.loadKernel(
+        absPath("${TESTDIR}/SpiceTest/spicekernels/030201AP_SK_SM546_T45.bsp")
+    );
+    REQUIRE(spice.hasSpkCoverage(cassini, et));
+    REQUIRE(spice.hasSpkCoverage("CASSINI", et));
+
+    openspace::SpiceManager::deinitialize();
+}
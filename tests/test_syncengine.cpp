@@ -0,0 +1,126 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/engine/syncengine.h>
+#include <openspace/util/syncable.h>
+#include <openspace/util/syncbuffer.h>
+#include <openspace/util/syncdata.h>
+
+namespace {
+    // A Syncable that encodes a stream of events, similar to the ScriptEngine, and thus
+    // has to be decoded every frame even if the encoded bytes did not change
+    class EventSyncable : public openspace::Syncable {
+    public:
+        int nEvents = 0;
+        int nDecodedEvents = 0;
+
+    protected:
+        void encode(openspace::SyncBuffer* syncBuffer) override {
+            syncBuffer->encode(nEvents);
+        }
+
+        void decode(openspace::SyncBuffer* syncBuffer) override {
+            int n;
+            syncBuffer->decode(n);
+            nDecodedEvents += n;
+        }
+    };
+} // namespace
+
+TEST_CASE("SyncEngine: Full Encoding", "[syncengine]") {
+    using namespace openspace;
+
+    SyncData<double> masterValue = 1.0;
+    SyncData<std::string> masterString = std::string("abc");
+    SyncEngine master(32);
+    master.addSyncables({ &masterValue, &masterString });
+
+    SyncData<double> slaveValue = 0.0;
+    SyncData<std::string> slaveString;
+    SyncEngine slave(32);
+    slave.addSyncables({ &slaveValue, &slaveString });
+
+    // Longer than the initial buffer size to make sure the buffer grows
+    masterString = std::string(100, 'x');
+    SyncBufferView view = master.encodeSyncables();
+    slave.decodeSyncables(view);
+    slave.postSynchronization(SyncEngine::IsMaster::No);
+
+    REQUIRE(slaveValue.data() == 1.0);
+    REQUIRE(slaveString.data() == std::string(100, 'x'));
+}
+
+TEST_CASE("SyncEngine: Delta Encoding", "[syncengine]") {
+    using namespace openspace;
+
+    SyncData<double> masterA = 1.0;
+    SyncData<glm::dvec3> masterB = glm::dvec3(1.0, 2.0, 3.0);
+    EventSyncable masterEvents;
+    SyncEngine master(64);
+    master.setDeltaEncodingEnabled(true);
+    master.addSyncables({ &masterA, &masterB, &masterEvents });
+
+    SyncData<double> slaveA = 0.0;
+    SyncData<glm::dvec3> slaveB = glm::dvec3(0.0);
+    EventSyncable slaveEvents;
+    SyncEngine slave(64);
+    slave.addSyncables({ &slaveA, &slaveB, &slaveEvents });
+
+    auto transmit = [&]() {
+        SyncBufferView view = master.encodeSyncables();
+        slave.decodeSyncables(view);
+        slave.postSynchronization(SyncEngine::IsMaster::No);
+        return view.size;
+    };
+
+    masterEvents.nEvents = 1;
+    const size_t fullSize = transmit();
+    REQUIRE(slaveA.data() == 1.0);
+    REQUIRE(slaveB.data() == glm::dvec3(1.0, 2.0, 3.0));
+    REQUIRE(slaveEvents.nDecodedEvents == 1);
+
+    // Nothing changed, but the events still have to arrive
+    const size_t unchangedSize = transmit();
+    REQUIRE(unchangedSize < fullSize);
+    REQUIRE(slaveA.data() == 1.0);
+    REQUIRE(slaveB.data() == glm::dvec3(1.0, 2.0, 3.0));
+    REQUIRE(slaveEvents.nDecodedEvents == 2);
+
+    masterA = 5.0;
+    const size_t partialSize = transmit();
+    REQUIRE(partialSize > unchangedSize);
+    REQUIRE(partialSize < fullSize);
+    REQUIRE(slaveA.data() == 5.0);
+    REQUIRE(slaveB.data() == glm::dvec3(1.0, 2.0, 3.0));
+
+    // Adding a new Syncable forces all values to be transmitted again
+    SyncData<int> masterC = 7;
+    SyncData<int> slaveC = 0;
+    master.addSyncable(&masterC);
+    slave.addSyncable(&slaveC);
+    REQUIRE(transmit() > fullSize);
+    REQUIRE(slaveC.data() == 7);
+}
@@ -24,12 +24,185 @@
 
 #include "catch2/catch.hpp"
 
+#include <modules/globebrowsing/src/layergroupid.h>
 #include <modules/globebrowsing/src/tileprovider.h>
+#include <openspace/engine/globals.h>
+#include <openspace/util/spicemanager.h>
 #include <openspace/util/time.h>
+#include <openspace/util/timemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/dictionary.h>
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace openspace;
+using namespace openspace::globebrowsing;
 
 namespace {
     constexpr const char* fileName = "data/scene/debugglobe/map_service_configs/"
         "VIIRS_SNPP_CorrectedReflectance_TrueColor_temporal.xml";
+
+    // The number of tile providers of different times that may be alive at once
+    constexpr const int CacheSize = 12;
+
+    // 2015-11-24 12:00:00, the middle of the first day of the dataset
+    constexpr const double FirstDay = 501595200.0 + 12.0 * 3600.0;
+    constexpr const double Day = 24.0 * 3600.0;
+
+    ghoul::Dictionary temporalDictionary() {
+        ghoul::Dictionary dictionary;
+        dictionary.setValue("FilePath", absPath(fileName));
+        dictionary.setValue(
+            "LayerGroupID",
+            static_cast<int>(layergroupid::GroupID::ColorLayers)
+        );
+        dictionary.setValue("CacheSize", static_cast<double>(CacheSize));
+        return dictionary;
+    }
+
+    void setTime(double j2000Seconds, double deltaTime = 1.0) {
+        global::timeManager->setDeltaTime(deltaTime);
+        global::timeManager->setTimeNextFrame(Time(j2000Seconds));
+        global::timeManager->preSynchronization(0.0);
+    }
 } // namespace
 
+TEST_CASE("TemporalTileProvider: Bounded Tile Providers", "[temporaltileprovider]") {
+    SpiceManager::initialize();
+    SpiceManager::ref().loadKernel(
+        absPath("${TESTDIR}/SpiceTest/spicekernels/naif0008.tls")
+    );
+
+    tileprovider::TemporalTileProvider tp(temporalDictionary());
+    REQUIRE(tp.successfulInitialization);
+    tileprovider::initialize(tp);
+    REQUIRE(tp.tileProviderCache.maximumCacheSize() == CacheSize);
+
+    // Every tile provider that was ever used. A tile provider owns a GDAL dataset and
+    // its tiles, so the number of them that are still alive bounds the memory usage
+    std::vector<std::weak_ptr<tileprovider::TileProvider>> used;
+    auto isReleased = [](const std::weak_ptr<tileprovider::TileProvider>& p) {
+        return p.expired();
+    };
+
+    for (int i = 0; i < 10000; ++i) {
+        // Jump around in the first 1500 days so that almost every step is a new one, and
+        // alternate the direction of time so that preloading goes both ways
+        const int day = (i * 7919) % 1500;
+        setTime(FirstDay + day * Day, (i % 3 == 0) ? 0.0 : ((i % 2) ? Day : -Day));
+        tileprovider::update(tp);
+
+        REQUIRE(tp.currentTileProvider);
+        used.push_back(tp.currentTileProvider);
+        for (const std::shared_ptr<tileprovider::TileProvider>& p :
+             tp.preloadedTileProviders)
+        {
+            used.push_back(p);
+        }
+        used.erase(std::remove_if(used.begin(), used.end(), isReleased), used.end());
+
+        REQUIRE(tp.tileProviderCache.size() <= CacheSize);
+        REQUIRE(tp.retiredTileProviders.size() <= CacheSize);
+
+        // Duplicates in the list are fine as long as the alive ones are bounded
+        std::vector<tileprovider::TileProvider*> alive;
+        for (const std::weak_ptr<tileprovider::TileProvider>& p : used) {
+            alive.push_back(p.lock().get());
+        }
+        std::sort(alive.begin(), alive.end());
+        alive.erase(std::unique(alive.begin(), alive.end()), alive.end());
+        REQUIRE(alive.size() <= CacheSize);
+    }
+
+    tileprovider::deinitialize(tp);
+    REQUIRE(tp.tileProviderCache.isEmpty());
+    REQUIRE_FALSE(tp.currentTileProvider);
+    used.erase(std::remove_if(used.begin(), used.end(), isReleased), used.end());
+    REQUIRE(used.empty());
+
+    SpiceManager::deinitialize();
+}
+
+TEST_CASE("TemporalTileProvider: Reuse Tile Providers", "[temporaltileprovider]") {
+    SpiceManager::initialize();
+    SpiceManager::ref().loadKernel(
+        absPath("${TESTDIR}/SpiceTest/spicekernels/naif0008.tls")
+    );
+
+    tileprovider::TemporalTileProvider tp(temporalDictionary());
+    REQUIRE(tp.successfulInitialization);
+    tileprovider::initialize(tp);
+
+    setTime(FirstDay + 100 * Day);
+    tileprovider::update(tp);
+    const uint16_t first = tp.currentTileProvider->uniqueIdentifier;
+
+    setTime(FirstDay + 200 * Day);
+    tileprovider::update(tp);
+    const uint16_t second = tp.currentTileProvider->uniqueIdentifier;
+    REQUIRE(first != second);
+
+    // Switching back and forth must not recreate the tile providers
+    for (int i = 0; i < 10; ++i) {
+        setTime(FirstDay + 100 * Day);
+        tileprovider::update(tp);
+        REQUIRE(tp.currentTileProvider->uniqueIdentifier == first);
+
+        setTime(FirstDay + 200 * Day);
+        tileprovider::update(tp);
+        REQUIRE(tp.currentTileProvider->uniqueIdentifier == second);
+    }
+
+    tileprovider::deinitialize(tp);
+    SpiceManager::deinitialize();
+}
+
+TEST_CASE("TemporalTileProvider: Preload In Background", "[temporaltileprovider]") {
+    SpiceManager::initialize();
+    SpiceManager::ref().loadKernel(
+        absPath("${TESTDIR}/SpiceTest/spicekernels/naif0008.tls")
+    );
+
+    tileprovider::TemporalTileProvider tp(temporalDictionary());
+    REQUIRE(tp.successfulInitialization);
+    tileprovider::initialize(tp);
+    REQUIRE(tp.preloadSteps == 2);
+
+    // Only the current tile provider is created right away, the preloaded ones are added
+    // in a later update once they have been created
+    setTime(FirstDay + 100 * Day, Day);
+    tileprovider::update(tp);
+    REQUIRE(tp.currentTileProvider);
+    CHECK(tp.tileProviderCache.size() == 1);
+    CHECK(tp.pendingTileProviders.size() == 2);
+    CHECK(tp.preloadedTileProviders.empty());
+
+    for (int i = 0; i < 1000 && tp.preloadedTileProviders.size() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        tileprovider::update(tp);
+    }
+    REQUIRE(tp.preloadedTileProviders.size() == 2);
+    CHECK(tp.pendingTileProviders.empty());
+    const uint16_t next = tp.preloadedTileProviders.front()->uniqueIdentifier;
+
+    // The preloaded tile provider of the next day is used once that day is reached
+    setTime(FirstDay + 101 * Day, Day);
+    tileprovider::update(tp);
+    REQUIRE(tp.currentTileProvider->uniqueIdentifier == next);
+
+    // Jumping away discards the tile providers that are still being created
+    setTime(FirstDay + 500 * Day, Day);
+    tileprovider::update(tp);
+    setTime(FirstDay + 900 * Day, Day);
+    tileprovider::update(tp);
+    CHECK(tp.pendingTileProviders.size() == 2);
+
+    tileprovider::deinitialize(tp);
+    CHECK(tp.pendingTileProviders.empty());
+    CHECK(tp.discardedTileProviders.empty());
+    SpiceManager::deinitialize();
+}
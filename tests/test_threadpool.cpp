@@ -0,0 +1,199 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/util/threadpool.h>
+#include <atomic>
+#include <chrono>
+
+TEST_CASE("ThreadPool: Executes All Tasks", "[threadpool]") {
+    using namespace openspace;
+
+    std::atomic<int> counter = 0;
+    {
+        ThreadPool pool(4);
+        std::vector<ThreadPool::TaskHandle> handles;
+        for (int i = 0; i < 1000; ++i) {
+            handles.push_back(pool.submit([&counter]() { ++counter; }));
+        }
+        for (const ThreadPool::TaskHandle& h : handles) {
+            pool.wait(h);
+        }
+        REQUIRE(counter == 1000);
+    }
+}
+
+TEST_CASE("ThreadPool: Continuation", "[threadpool]") {
+    using namespace openspace;
+
+    ThreadPool pool(2);
+    std::atomic<int> value = 0;
+    ThreadPool::TaskHandle first = pool.submit([&value]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        value = 1;
+    });
+    ThreadPool::TaskHandle second = pool.then(first, [&value]() { value = value * 10; });
+    pool.wait(second);
+    REQUIRE(first.isFinished());
+    REQUIRE(value == 10);
+
+    // Attaching a continuation to an already finished task runs it right away
+    ThreadPool::TaskHandle third = pool.then(first, [&value]() { value = value + 1; });
+    pool.wait(third);
+    REQUIRE(value == 11);
+}
+
+TEST_CASE("ThreadPool: Priority", "[threadpool]") {
+    using namespace openspace;
+
+    ThreadPool pool(1);
+    std::mutex mutex;
+    std::vector<int> order;
+
+    // Block the only worker so that the following tasks are all queued up
+    std::atomic_bool release = false;
+    pool.enqueue([&release]() {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    auto record = [&](int v) {
+        return [&, v]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(v);
+        };
+    };
+    pool.submit(record(2), ThreadPool::Priority::Low);
+    pool.submit(record(1), ThreadPool::Priority::Normal);
+    ThreadPool::TaskHandle h = pool.submit(record(0), ThreadPool::Priority::High);
+    release = true;
+    pool.wait(h);
+
+    ThreadPool::TaskHandle last = pool.submit([]() {}, ThreadPool::Priority::Low);
+    pool.wait(last);
+    std::lock_guard<std::mutex> lock(mutex);
+    REQUIRE(order == std::vector<int>{ 0, 1, 2 });
+}
+
+TEST_CASE("ThreadPool: ParallelFor", "[threadpool]") {
+    using namespace openspace;
+
+    ThreadPool pool(4);
+    std::vector<int> values(10000, 0);
+    pool.parallelFor(0, values.size(), [&values](size_t i) { values[i] = int(i); }, 64);
+    for (size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(values[i] == int(i));
+    }
+
+    // Nested parallelFor must not deadlock even if all workers are waiting
+    std::atomic<int> sum = 0;
+    pool.parallelFor(0, 16, [&](size_t) {
+        pool.parallelFor(0, 100, [&sum](size_t) { ++sum; });
+    });
+    REQUIRE(sum == 1600);
+}
+
+TEST_CASE("ThreadPool: Clear Tasks", "[threadpool]") {
+    using namespace openspace;
+
+    std::atomic<int> counter = 0;
+    ThreadPool pool(1);
+    std::atomic_bool release = false;
+    pool.enqueue([&release]() {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (int i = 0; i < 100; ++i) {
+        pool.enqueue([&counter]() { ++counter; });
+    }
+    pool.clearTasks();
+    release = true;
+
+    ThreadPool::TaskHandle h = pool.submit([]() {});
+    pool.wait(h);
+    REQUIRE(counter == 0);
+}
+
+TEST_CASE("ThreadPool: Clear Tasks Finishes Handles", "[threadpool]") {
+    using namespace openspace;
+
+    ThreadPool pool(1);
+    std::atomic_bool release = false;
+    pool.enqueue([&release]() {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::atomic<int> counter = 0;
+    ThreadPool::TaskHandle h = pool.submit([&counter]() { ++counter; });
+    ThreadPool::TaskHandle c = pool.then(h, [&counter]() { ++counter; });
+    pool.clearTasks();
+    release = true;
+
+    // Neither of these must block as the cleared task will never be executed
+    pool.wait(h);
+    pool.wait(c);
+    REQUIRE(h.isCancelled());
+    REQUIRE(c.isCancelled());
+    REQUIRE(pool.then(h, [&counter]() { ++counter; }).isCancelled());
+    REQUIRE(counter == 0);
+}
+
+TEST_CASE("ThreadPool: Clear Tasks During ParallelFor", "[threadpool]") {
+    using namespace openspace;
+
+    ThreadPool pool(2);
+    constexpr const size_t N = 2000;
+    std::atomic<size_t> nCalls = 0;
+    std::atomic_bool hasStarted = false;
+    std::thread caller([&]() {
+        pool.parallelFor(0, N, [&](size_t) {
+            hasStarted = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ++nCalls;
+        });
+    });
+    while (!hasStarted) {
+        std::this_thread::yield();
+    }
+    pool.clearTasks();
+
+    // The parallelFor has to return once the chunks that were already running finish
+    // instead of waiting for the removed ones forever
+    caller.join();
+    REQUIRE(nCalls > 0);
+    REQUIRE(nCalls < N);
+
+    // The pool is still usable afterwards
+    std::atomic<size_t> sum = 0;
+    pool.parallelFor(0, 100, [&sum](size_t) { ++sum; });
+    REQUIRE(sum == 100);
+}
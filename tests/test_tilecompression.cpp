@@ -0,0 +1,392 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/memoryawaretilecache.h>
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tilecompression.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <ghoul/fmt.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+    using Pixel = std::array<int, 4>; // blue, green, red, alpha
+
+    std::array<int, 3> expand565(uint16_t c) {
+        const int r = (c >> 11) & 31;
+        const int g = (c >> 5) & 63;
+        const int b = c & 31;
+        return { (b << 3) | (b >> 2), (g << 2) | (g >> 4), (r << 3) | (r >> 2) };
+    }
+
+    // Straightforward decoder written after the BC1 (DXT1) specification, independent
+    // of the encoder, that returns the BGRA pixels of an image with size \p dimensions
+    std::vector<Pixel> decodeBC1(const std::vector<std::byte>& blocks,
+                                 glm::ivec2 dimensions)
+    {
+        const int nBlocksX = (dimensions.x + 3) / 4;
+        const int nBlocksY = (dimensions.y + 3) / 4;
+        std::vector<Pixel> result(static_cast<size_t>(dimensions.x) * dimensions.y);
+        for (int by = 0; by < nBlocksY; ++by) {
+            for (int bx = 0; bx < nBlocksX; ++bx) {
+                const size_t offset = 8 * (static_cast<size_t>(by) * nBlocksX + bx);
+                auto byte = [&](size_t i) {
+                    return std::to_integer<uint32_t>(blocks[offset + i]);
+                };
+                const uint16_t c0 = static_cast<uint16_t>(byte(0) | (byte(1) << 8));
+                const uint16_t c1 = static_cast<uint16_t>(byte(2) | (byte(3) << 8));
+                const uint32_t indices =
+                    byte(4) | (byte(5) << 8) | (byte(6) << 16) | (byte(7) << 24);
+
+                const std::array<int, 3> e0 = expand565(c0);
+                const std::array<int, 3> e1 = expand565(c1);
+                std::array<Pixel, 4> palette;
+                for (int ch = 0; ch < 3; ++ch) {
+                    palette[0][ch] = e0[ch];
+                    palette[1][ch] = e1[ch];
+                    if (c0 > c1) {
+                        palette[2][ch] = (2 * e0[ch] + e1[ch]) / 3;
+                        palette[3][ch] = (e0[ch] + 2 * e1[ch]) / 3;
+                    }
+                    else {
+                        palette[2][ch] = (e0[ch] + e1[ch]) / 2;
+                        palette[3][ch] = 0;
+                    }
+                }
+                palette[0][3] = palette[1][3] = palette[2][3] = 255;
+                palette[3][3] = c0 > c1 ? 255 : 0;
+
+                for (int i = 0; i < 16; ++i) {
+                    const int x = bx * 4 + i % 4;
+                    const int y = by * 4 + i / 4;
+                    if (x < dimensions.x && y < dimensions.y) {
+                        result[static_cast<size_t>(y) * dimensions.x + x] =
+                            palette[(indices >> (2 * i)) & 3];
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::byte> toBytes(const std::vector<Pixel>& pixels) {
+        std::vector<std::byte> bytes(pixels.size() * 4);
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            for (size_t c = 0; c < 4; ++c) {
+                bytes[4 * i + c] = static_cast<std::byte>(pixels[i][c]);
+            }
+        }
+        return bytes;
+    }
+
+    std::vector<Pixel> roundTrip(const std::vector<Pixel>& pixels, glm::ivec2 size) {
+        const size_t nBlocks = static_cast<size_t>((size.x + 3) / 4) * ((size.y + 3) / 4);
+        std::vector<std::byte> blocks(8 * nBlocks);
+        const std::vector<std::byte> bytes = toBytes(pixels);
+        openspace::globebrowsing::compressBC1(bytes.data(), size, blocks.data());
+        return decodeBC1(blocks, size);
+    }
+
+    // Root mean square error of the color channels of the opaque pixels
+    double colorError(const std::vector<Pixel>& lhs, const std::vector<Pixel>& rhs) {
+        double sum = 0.0;
+        size_t count = 0;
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs[i][3] < 128) {
+                continue;
+            }
+            for (int c = 0; c < 3; ++c) {
+                const double d = lhs[i][c] - rhs[i][c];
+                sum += d * d;
+            }
+            count += 3;
+        }
+        return count > 0 ? std::sqrt(sum / count) : 0.0;
+    }
+
+    // A color with 5:6:5 representable channels
+    Pixel representable(int r5, int g6, int b5) {
+        return {
+            (b5 << 3) | (b5 >> 2), (g6 << 2) | (g6 >> 4), (r5 << 3) | (r5 >> 2), 255
+        };
+    }
+
+    std::vector<Pixel> gradient(glm::ivec2 size) {
+        std::vector<Pixel> pixels(static_cast<size_t>(size.x) * size.y);
+        for (int y = 0; y < size.y; ++y) {
+            for (int x = 0; x < size.x; ++x) {
+                pixels[static_cast<size_t>(y) * size.x + x] = {
+                    (x * 255) / std::max(size.x - 1, 1),
+                    (y * 255) / std::max(size.y - 1, 1),
+                    ((x + y) * 127) / std::max(size.x + size.y - 2, 1) + 64,
+                    255
+                };
+            }
+        }
+        return pixels;
+    }
+} // namespace
+
+TEST_CASE("TileCompression: Init Data", "[tilecompression]") {
+    using namespace openspace::globebrowsing;
+
+    const TileTextureInitData color(
+        512, 512, GL_UNSIGNED_BYTE, ghoul::opengl::Texture::Format::BGRA,
+        TileTextureInitData::PadTiles::No,
+        TileTextureInitData::ShouldAllocateDataOnCPU::No
+    );
+    CHECK(isCompressible(color, TileCompression::BC1));
+    CHECK_FALSE(isCompressible(color, TileCompression::None));
+
+    const TileTextureInitData compressed =
+        compressedTileTextureInitData(color, TileCompression::BC1);
+    CHECK(compressed.compression == TileCompression::BC1);
+    CHECK(compressed.totalNumBytes == 512 * 512 / 2);
+    CHECK(compressed.totalNumBytes * 8 == color.totalNumBytes);
+    CHECK(compressed.dimensions == color.dimensions);
+    CHECK(compressed.hashKey != color.hashKey);
+    CHECK_FALSE(isCompressible(compressed, TileCompression::BC1));
+
+    const TileTextureInitData height(
+        64, 64, GL_FLOAT, ghoul::opengl::Texture::Format::Red,
+        TileTextureInitData::PadTiles::Yes
+    );
+    CHECK_FALSE(isCompressible(height, TileCompression::BC1));
+
+    // Sizes that are not a multiple of the block size are rounded up
+    const TileTextureInitData odd(
+        10, 6, GL_UNSIGNED_BYTE, ghoul::opengl::Texture::Format::BGRA,
+        TileTextureInitData::PadTiles::No,
+        TileTextureInitData::ShouldAllocateDataOnCPU::No,
+        TileCompression::BC1
+    );
+    CHECK(odd.totalNumBytes == 3 * 2 * 8);
+}
+
+TEST_CASE("TileCompression: Solid Blocks Are Exact", "[tilecompression]") {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> dist5(0, 31);
+    std::uniform_int_distribution<int> dist6(0, 63);
+    for (int i = 0; i < 100; ++i) {
+        const std::vector<Pixel> pixels(
+            16,
+            representable(dist5(gen), dist6(gen), dist5(gen))
+        );
+        CHECK(roundTrip(pixels, { 4, 4 }) == pixels);
+    }
+}
+
+TEST_CASE("TileCompression: Two Color Blocks Are Exact", "[tilecompression]") {
+    std::mt19937 gen(2);
+    std::uniform_int_distribution<int> dist5(0, 31);
+    std::uniform_int_distribution<int> dist6(0, 63);
+    std::uniform_int_distribution<int> select(0, 1);
+    for (int i = 0; i < 100; ++i) {
+        const Pixel a = representable(dist5(gen), dist6(gen), dist5(gen));
+        const Pixel b = representable(dist5(gen), dist6(gen), dist5(gen));
+        std::vector<Pixel> pixels(16);
+        for (Pixel& p : pixels) {
+            p = select(gen) == 0 ? a : b;
+        }
+        CHECK(roundTrip(pixels, { 4, 4 }) == pixels);
+    }
+}
+
+TEST_CASE("TileCompression: Gradient Error", "[tilecompression]") {
+    const glm::ivec2 size = { 64, 64 };
+    const std::vector<Pixel> pixels = gradient(size);
+    const std::vector<Pixel> decoded = roundTrip(pixels, size);
+    const double error = colorError(pixels, decoded);
+    INFO(fmt::format("RMSE {}", error));
+    // The 5:6:5 quantization alone results in an error of about 2
+    CHECK(error < 4.0);
+    for (const Pixel& p : decoded) {
+        CHECK(p[3] == 255);
+    }
+}
+
+TEST_CASE("TileCompression: Random Noise Error", "[tilecompression]") {
+    // Noise is the worst case for BC1, but the error has to stay within the bounds of
+    // what four interpolated colors per block can represent
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(0, 255);
+    const glm::ivec2 size = { 32, 32 };
+    std::vector<Pixel> pixels(static_cast<size_t>(size.x) * size.y);
+    for (Pixel& p : pixels) {
+        p = { dist(gen), dist(gen), dist(gen), 255 };
+    }
+    const double error = colorError(pixels, roundTrip(pixels, size));
+    INFO(fmt::format("RMSE {}", error));
+    CHECK(error < 60.0);
+}
+
+TEST_CASE("TileCompression: Transparent Pixels", "[tilecompression]") {
+    const glm::ivec2 size = { 64, 64 };
+    std::vector<Pixel> pixels = gradient(size);
+    for (int y = 0; y < size.y; ++y) {
+        for (int x = 0; x < size.x; ++x) {
+            if ((x * 3 + y * 5) % 7 == 0) {
+                pixels[static_cast<size_t>(y) * size.x + x][3] = 127;
+            }
+        }
+    }
+    // One block that is fully transparent
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            pixels[static_cast<size_t>(y) * size.x + x][3] = 0;
+        }
+    }
+
+    const std::vector<Pixel> decoded = roundTrip(pixels, size);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        CHECK((decoded[i][3] == 255) == (pixels[i][3] >= 128));
+    }
+    const double error = colorError(pixels, decoded);
+    INFO(fmt::format("RMSE {}", error));
+    CHECK(error < 6.0);
+}
+
+TEST_CASE("TileCompression: Partial Blocks", "[tilecompression]") {
+    // Images whose size is not a multiple of 4 are compressed as if their last row and
+    // column were repeated up to the next multiple of 4
+    const std::vector<glm::ivec2> sizes = { { 1, 1 }, { 3, 5 }, { 10, 6 }, { 67, 65 } };
+    for (const glm::ivec2& size : sizes) {
+        const glm::ivec2 padded = { (size.x + 3) / 4 * 4, (size.y + 3) / 4 * 4 };
+        const std::vector<Pixel> pixels = gradient(size);
+        std::vector<Pixel> paddedPixels(static_cast<size_t>(padded.x) * padded.y);
+        for (int y = 0; y < padded.y; ++y) {
+            for (int x = 0; x < padded.x; ++x) {
+                const size_t source = static_cast<size_t>(std::min(y, size.y - 1)) *
+                    size.x + std::min(x, size.x - 1);
+                paddedPixels[static_cast<size_t>(y) * padded.x + x] = pixels[source];
+            }
+        }
+
+        const std::vector<Pixel> decoded = roundTrip(pixels, size);
+        const std::vector<Pixel> paddedDecoded = roundTrip(paddedPixels, padded);
+        INFO(fmt::format("{}x{} pixels", size.x, size.y));
+        for (int y = 0; y < size.y; ++y) {
+            for (int x = 0; x < size.x; ++x) {
+                CHECK(
+                    decoded[static_cast<size_t>(y) * size.x + x] ==
+                    paddedDecoded[static_cast<size_t>(y) * padded.x + x]
+                );
+            }
+        }
+    }
+}
+
+TEST_CASE("TileCompression: Compress Raw Tile", "[tilecompression]") {
+    using namespace openspace::globebrowsing;
+
+    const glm::ivec2 size = { 64, 64 };
+    const std::vector<Pixel> pixels = gradient(size);
+    const std::vector<std::byte> bytes = toBytes(pixels);
+
+    RawTile tile;
+    tile.textureInitData.emplace(
+        size.x, size.y, GL_UNSIGNED_BYTE, ghoul::opengl::Texture::Format::BGRA,
+        TileTextureInitData::PadTiles::No,
+        TileTextureInitData::ShouldAllocateDataOnCPU::No
+    );
+    tile.imageData = std::unique_ptr<std::byte[]>(new std::byte[bytes.size()]);
+    std::copy(bytes.begin(), bytes.end(), tile.imageData.get());
+
+    compressRawTile(tile, TileCompression::BC1);
+    REQUIRE(tile.textureInitData.has_value());
+    REQUIRE(tile.textureInitData->compression == TileCompression::BC1);
+    const size_t nBytes = tile.textureInitData->totalNumBytes;
+    REQUIRE(nBytes == bytes.size() / 8);
+    const std::vector<std::byte> blocks(
+        tile.imageData.get(),
+        tile.imageData.get() + nBytes
+    );
+    CHECK(decodeBC1(blocks, size) == roundTrip(pixels, size));
+
+    // Tiles that can not be compressed are left untouched
+    RawTile height;
+    height.textureInitData.emplace(
+        16, 16, GL_FLOAT, ghoul::opengl::Texture::Format::Red,
+        TileTextureInitData::PadTiles::No,
+        TileTextureInitData::ShouldAllocateDataOnCPU::No
+    );
+    height.imageData = std::unique_ptr<std::byte[]>(new std::byte[16 * 16 * 4]);
+    const std::byte* heightData = height.imageData.get();
+    compressRawTile(height, TileCompression::BC1);
+    CHECK(height.imageData.get() == heightData);
+    CHECK(height.textureInitData->compression == TileCompression::None);
+
+    RawTile failed;
+    failed.error = RawTile::ReadError::Failure;
+    compressRawTile(failed, TileCompression::BC1);
+    CHECK_FALSE(failed.textureInitData.has_value());
+}
+
+TEST_CASE("TileCompression: Cached Tiles In Fixed Budget", "[tilecompression]") {
+    using namespace openspace::globebrowsing;
+
+    constexpr const size_t Budget = 512 * 1024 * 1024;
+
+    const TileTextureInitData color(
+        512, 512, GL_UNSIGNED_BYTE, ghoul::opengl::Texture::Format::BGRA,
+        TileTextureInitData::PadTiles::No,
+        TileTextureInitData::ShouldAllocateDataOnCPU::No
+    );
+    const TileTextureInitData compressed =
+        compressedTileTextureInitData(color, TileCompression::BC1);
+    const TileTextureInitData height(
+        64, 64, GL_FLOAT, ghoul::opengl::Texture::Format::Red,
+        TileTextureInitData::PadTiles::Yes
+    );
+
+    const std::vector<size_t> uncompressedCounts = cache::numTexturesInBudget(
+        Budget,
+        { color.totalNumBytes, height.totalNumBytes }
+    );
+    const std::vector<size_t> compressedCounts = cache::numTexturesInBudget(
+        Budget,
+        { compressed.totalNumBytes, height.totalNumBytes }
+    );
+    REQUIRE(uncompressedCounts.size() == 2);
+    REQUIRE(compressedCounts.size() == 2);
+
+    // Compressing the color tiles lets eight times as many of them fit into the same
+    // budget, without taking anything away from the other texture types
+    CHECK(compressedCounts[0] == 8 * uncompressedCounts[0]);
+    CHECK(compressedCounts[1] == uncompressedCounts[1]);
+
+    const size_t nBytes = compressedCounts[0] * compressed.totalNumBytes +
+                          compressedCounts[1] * height.totalNumBytes;
+    CHECK(nBytes <= Budget);
+
+    // Every texture type gets at least one texture, even if the budget is too small
+    CHECK(cache::numTexturesInBudget(1, { color.totalNumBytes }).front() == 1);
+    CHECK(cache::numTexturesInBudget(Budget, {}).empty());
+}
@@ -0,0 +1,202 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/tilemetadata.h>
+#include <ghoul/fmt.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+    // Creates random values that contain the no data value, NaNs, infinities, and zeros
+    // of both signs with a probability of about 1% each
+    template <typename T>
+    std::vector<std::byte> createData(size_t count, T noData, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> special(0, 99);
+
+        std::vector<T> values(count);
+        for (T& v : values) {
+            const int s = special(gen);
+            if constexpr (std::is_floating_point_v<T>) {
+                std::uniform_real_distribution<T> dist(T(-1000), T(1000));
+                switch (s) {
+                    case 0:  v = noData; break;
+                    case 1:  v = std::numeric_limits<T>::quiet_NaN(); break;
+                    case 2:  v = std::numeric_limits<T>::infinity(); break;
+                    case 3:  v = -std::numeric_limits<T>::infinity(); break;
+                    case 4:  v = T(0); break;
+                    case 5:  v = -T(0); break;
+                    default: v = dist(gen); break;
+                }
+            }
+            else {
+                std::uniform_int_distribution<int64_t> dist(
+                    std::numeric_limits<T>::lowest(),
+                    std::numeric_limits<T>::max()
+                );
+                v = (s == 0) ? noData : static_cast<T>(dist(gen));
+            }
+        }
+
+        std::vector<std::byte> data(count * sizeof(T));
+        std::memcpy(data.data(), values.data(), data.size());
+        return data;
+    }
+
+    template <typename T>
+    void compareWithScalar(GLenum glType, T noData, float noDataValue) {
+        using namespace openspace::globebrowsing;
+
+        const std::vector<glm::ivec2> sizes = {
+            { 1, 1 }, { 3, 5 }, { 64, 64 }, { 67, 65 }, { 260, 3 }
+        };
+        unsigned int seed = 0;
+        for (const glm::ivec2& size : sizes) {
+            for (size_t nRasters = 1; nRasters <= 4; ++nRasters) {
+                const size_t count = static_cast<size_t>(size.x * size.y) * nRasters;
+                std::vector<std::byte> simd = createData<T>(count, noData, ++seed);
+                std::vector<std::byte> scalar = simd;
+
+                bool simdAllIsMissing = false;
+                const TileMetaData simdRes = computeTileMetaData(
+                    simd.data(), size, nRasters, glType, noDataValue, simdAllIsMissing
+                );
+                bool scalarAllIsMissing = false;
+                const TileMetaData scalarRes = detail::computeTileMetaDataScalar(
+                    scalar.data(), size, nRasters, glType, noDataValue, scalarAllIsMissing
+                );
+
+                INFO(fmt::format("{}x{} pixels, {} rasters", size.x, size.y, nRasters));
+                CHECK(simdAllIsMissing == scalarAllIsMissing);
+                CHECK(simdRes.nValues == scalarRes.nValues);
+                CHECK(simdRes.hasMissingData == scalarRes.hasMissingData);
+                // Compare the bit patterns to also distinguish the sign of zeros
+                CHECK(std::memcmp(
+                    simdRes.maxValues.data(), scalarRes.maxValues.data(),
+                    sizeof(float) * 4
+                ) == 0);
+                CHECK(std::memcmp(
+                    simdRes.minValues.data(), scalarRes.minValues.data(),
+                    sizeof(float) * 4
+                ) == 0);
+                CHECK(simd == scalar);
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("TileMetaData: Float32 Matches Scalar", "[tilemetadata]") {
+    compareWithScalar<GLfloat>(GL_FLOAT, -9999.f, -9999.f);
+    compareWithScalar<GLfloat>(GL_FLOAT, 0.f, 0.f);
+    compareWithScalar<GLfloat>(
+        GL_FLOAT,
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::quiet_NaN()
+    );
+}
+
+TEST_CASE("TileMetaData: Sign Of Zero Extremes Matches Scalar", "[tilemetadata]") {
+    using namespace openspace::globebrowsing;
+
+    // Only non-positive values and zeros of both signs, so that the maximum is a zero
+    // and its sign depends on the order in which the values are inspected
+    for (unsigned int seed = 0; seed < 20; ++seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dist(-3, 1);
+        std::vector<float> values(67 * 13 * 2);
+        for (float& v : values) {
+            const int i = dist(gen);
+            v = (i == 0) ? -0.f : static_cast<float>(std::min(i, 0));
+        }
+        std::vector<float> scalar = values;
+
+        bool allIsMissing = false;
+        const TileMetaData simdRes = computeTileMetaData(
+            reinterpret_cast<std::byte*>(values.data()), { 67, 13 }, 2, GL_FLOAT,
+            -9999.f, allIsMissing
+        );
+        const TileMetaData scalarRes = detail::computeTileMetaDataScalar(
+            reinterpret_cast<std::byte*>(scalar.data()), { 67, 13 }, 2, GL_FLOAT,
+            -9999.f, allIsMissing
+        );
+        REQUIRE(simdRes.maxValues[0] == 0.f);
+        CHECK(std::signbit(simdRes.maxValues[0]) == std::signbit(scalarRes.maxValues[0]));
+        CHECK(std::signbit(simdRes.maxValues[1]) == std::signbit(scalarRes.maxValues[1]));
+    }
+}
+
+TEST_CASE("TileMetaData: Int16 Matches Scalar", "[tilemetadata]") {
+    compareWithScalar<GLshort>(GL_SHORT, -32768, -32768.f);
+    compareWithScalar<GLshort>(GL_SHORT, 17, 17.f);
+    // No data values that are not representable never match
+    compareWithScalar<GLshort>(GL_SHORT, 17, 17.5f);
+    compareWithScalar<GLshort>(GL_SHORT, 0, 1e10f);
+}
+
+TEST_CASE("TileMetaData: UInt8 Matches Scalar", "[tilemetadata]") {
+    compareWithScalar<GLubyte>(GL_UNSIGNED_BYTE, 0, 0.f);
+    compareWithScalar<GLubyte>(GL_UNSIGNED_BYTE, 255, 255.f);
+    compareWithScalar<GLubyte>(GL_UNSIGNED_BYTE, 0, -1.f);
+}
+
+TEST_CASE("TileMetaData: Other Types Match Scalar", "[tilemetadata]") {
+    compareWithScalar<GLushort>(GL_UNSIGNED_SHORT, 0, 0.f);
+    compareWithScalar<GLint>(GL_INT, -1, -1.f);
+    compareWithScalar<GLuint>(GL_UNSIGNED_INT, 0, 0.f);
+    compareWithScalar<GLdouble>(GL_DOUBLE, -9999.0, -9999.f);
+}
+
+TEST_CASE("TileMetaData: Values", "[tilemetadata]") {
+    using namespace openspace::globebrowsing;
+
+    std::vector<float> values = {
+        1.f, -5.f, std::numeric_limits<float>::quiet_NaN(), 3.f, -9999.f, 2.f, 7.f, 0.5f,
+        -1.f
+    };
+    bool allIsMissing = true;
+    const TileMetaData res = computeTileMetaData(
+        reinterpret_cast<std::byte*>(values.data()), { 3, 3 }, 1, GL_FLOAT, -9999.f,
+        allIsMissing
+    );
+    CHECK_FALSE(allIsMissing);
+    CHECK(res.nValues == 1);
+    CHECK(res.maxValues[0] == 7.f);
+    CHECK(res.minValues[0] == -5.f);
+    CHECK(res.hasMissingData[0]);
+    CHECK(values[2] == -std::numeric_limits<float>::max());
+    CHECK(values[4] == -std::numeric_limits<float>::max());
+
+    std::vector<float> missing(16, -9999.f);
+    computeTileMetaData(
+        reinterpret_cast<std::byte*>(missing.data()), { 4, 4 }, 1, GL_FLOAT, -9999.f,
+        allIsMissing
+    );
+    CHECK(allIsMissing);
+}
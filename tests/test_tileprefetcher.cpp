@@ -0,0 +1,241 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tileprefetcher.h>
+#include <ghoul/glm.h>
+#include <algorithm>
+#include <optional>
+#include <set>
+
+using namespace openspace::globebrowsing;
+
+namespace {
+    constexpr const double Radius = 6378137.0;
+} // namespace
+
+TEST_CASE("TilePrefetcher: Distant Camera", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+
+    // Far away from the globe, no tile should be split and both roots are visible
+    const std::vector<TileIndex> tiles = TilePrefetcher::predictedTiles(
+        glm::dvec3(1000.0 * Radius, 0.0, 0.0),
+        ellipsoid,
+        1.0,
+        22,
+        TilePriorities(),
+        1024
+    );
+    REQUIRE(tiles.size() == 2);
+    CHECK(tiles[0].level == 1);
+    CHECK(tiles[1].level == 1);
+}
+
+TEST_CASE("TilePrefetcher: Breadth-First Order", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+
+    const std::vector<TileIndex> tiles = TilePrefetcher::predictedTiles(
+        glm::dvec3(1.01 * Radius, 0.0, 0.0),
+        ellipsoid,
+        10.0,
+        22,
+        TilePriorities(),
+        1024
+    );
+    REQUIRE(tiles.size() > 2);
+    for (size_t i = 1; i < tiles.size(); ++i) {
+        CHECK(tiles[i - 1].level <= tiles[i].level);
+    }
+}
+
+TEST_CASE("TilePrefetcher: Maximum Level", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+
+    const std::vector<TileIndex> tiles = TilePrefetcher::predictedTiles(
+        glm::dvec3(1.0001 * Radius, 0.0, 0.0),
+        ellipsoid,
+        10.0,
+        5,
+        TilePriorities(),
+        1024
+    );
+    REQUIRE(!tiles.empty());
+    CHECK(tiles.back().level == 5);
+}
+
+TEST_CASE("TilePrefetcher: Maximum Tiles", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+
+    const std::vector<TileIndex> tiles = TilePrefetcher::predictedTiles(
+        glm::dvec3(1.0001 * Radius, 0.0, 0.0),
+        ellipsoid,
+        10.0,
+        22,
+        TilePriorities(),
+        10
+    );
+    CHECK(tiles.size() == 10);
+}
+
+TEST_CASE("TilePrefetcher: Exclude", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+    const glm::dvec3 camera = glm::dvec3(1.01 * Radius, 0.0, 0.0);
+
+    const std::vector<TileIndex> all = TilePrefetcher::predictedTiles(
+        camera,
+        ellipsoid,
+        10.0,
+        22,
+        TilePriorities(),
+        1024
+    );
+
+    // Excluding the coarse tiles must not prevent their children from being returned
+    TilePriorities exclude;
+    for (const TileIndex& tileIndex : all) {
+        if (tileIndex.level <= 2) {
+            exclude[tileIndex.hashKey()] = 1.f;
+        }
+    }
+    const std::vector<TileIndex> tiles = TilePrefetcher::predictedTiles(
+        camera,
+        ellipsoid,
+        10.0,
+        22,
+        exclude,
+        1024
+    );
+    REQUIRE(tiles.size() == all.size() - exclude.size());
+    for (const TileIndex& tileIndex : tiles) {
+        CHECK(tileIndex.level > 2);
+    }
+}
+
+TEST_CASE("TilePrefetcher: Horizon Culling", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+
+    const std::vector<TileIndex> tiles = TilePrefetcher::predictedTiles(
+        glm::dvec3(1.01 * Radius, 0.0, 0.0),
+        ellipsoid,
+        10.0,
+        22,
+        TilePriorities(),
+        1024
+    );
+    // The camera hovers above longitude 0, so tiles on the far side of the globe are not
+    // visible
+    for (const TileIndex& tileIndex : tiles) {
+        if (tileIndex.level < 3) {
+            continue;
+        }
+        const GeodeticPatch patch(tileIndex);
+        const double minLon = patch.center().lon - patch.halfSize().lon;
+        const double maxLon = patch.center().lon + patch.halfSize().lon;
+        CHECK(maxLon > -glm::half_pi<double>());
+        CHECK(minLon < glm::half_pi<double>());
+    }
+}
+
+TEST_CASE("TilePrefetcher: Used And Wasted Tiles", "[tileprefetcher]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(Radius));
+    TilePrefetcher prefetcher;
+
+    std::set<TileIndex::TileHashKey> loaded;
+    auto isLoaded = [&loaded](const TileIndex& tileIndex) {
+        return loaded.find(tileIndex.hashKey()) != loaded.end();
+    };
+    auto update = [&](double time, const TilePriorities& requestedTiles) {
+        prefetcher.update(
+            glm::dvec3(2.0 * Radius, 0.0, 0.0),
+            glm::dmat4(1.0),
+            ellipsoid,
+            1.0,
+            22,
+            requestedTiles,
+            time,
+            isLoaded
+        );
+    };
+
+    update(0.0, TilePriorities());
+    const TileIndex used = TileIndex(0, 0, 3);
+    const TileIndex wasted = TileIndex(1, 0, 3);
+    const TileIndex dropped = TileIndex(2, 0, 3);
+    const TileIndex late = TileIndex(3, 0, 3);
+    for (const TileIndex& tileIndex : { used, wasted, dropped, late }) {
+        prefetcher.addRequestedTile(tileIndex);
+    }
+
+    // The globe needs one of the tiles before its data has been loaded, so prefetching
+    // it did not help
+    loaded = { used.hashKey(), wasted.hashKey() };
+    update(0.5, TilePriorities{ { late.hashKey(), 1.f } });
+    CHECK(prefetcher.nUsedTiles() == 0);
+    CHECK(prefetcher.nWastedTiles() == 0);
+
+    loaded.insert(late.hashKey());
+    update(1.0, TilePriorities{ { used.hashKey(), 1.f }, { late.hashKey(), 1.f } });
+    CHECK(prefetcher.nUsedTiles() == 1);
+    CHECK(prefetcher.nWastedTiles() == 0);
+
+    // Twice the look-ahead time after its data arrived, the tile that was never requested
+    // by the globe is wasted. The request that never finished is not counted at all
+    update(5.0, TilePriorities());
+    CHECK(prefetcher.nUsedTiles() == 1);
+    CHECK(prefetcher.nWastedTiles() == 1);
+}
+
+TEST_CASE("TilePrefetcher: Predict Camera Position", "[tileprefetcher]") {
+    TilePrefetcher prefetcher;
+    const glm::dmat4 inverseModelTransform =
+        glm::translate(glm::dmat4(1.0), glm::dvec3(-Radius, 0.0, 0.0));
+    const glm::dvec3 start = glm::dvec3(3.0 * Radius, 0.0, 0.0);
+
+    // A camera that has not moved is not expected to move in the future either
+    CHECK_FALSE(prefetcher.predictCameraPosition(start, inverseModelTransform, 0.0));
+    CHECK_FALSE(prefetcher.predictCameraPosition(start, inverseModelTransform, 1.0));
+
+    // A constant velocity is extrapolated by the look-ahead time once the smoothed
+    // velocity has caught up with it
+    const glm::dvec3 velocity = glm::dvec3(1000.0, -2000.0, 500.0);
+    const double lookAhead = 2.0;
+    std::optional<glm::dvec3> predicted;
+    glm::dvec3 position = start;
+    for (int i = 1; i <= 100; ++i) {
+        position = start + velocity * static_cast<double>(i);
+        predicted = prefetcher.predictCameraPosition(
+            position,
+            inverseModelTransform,
+            1.0 + i
+        );
+        REQUIRE(predicted.has_value());
+    }
+    const glm::dvec3 future = position + velocity * lookAhead;
+    const glm::dvec3 expected =
+        glm::dvec3(inverseModelTransform * glm::dvec4(future, 1.0));
+    CHECK(glm::distance(*predicted, expected) < 1e-3);
+}
@@ -0,0 +1,375 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/lrucache.h>
+#include <modules/globebrowsing/src/prioritytaskqueue.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    using namespace openspace::globebrowsing;
+    using Key = TileIndex::TileHashKey;
+
+    // The queue size and number of tiles that finish per frame of a single
+    // AsyncTileDataProvider
+    constexpr const size_t QueueSize = 10;
+    constexpr const int TilesPerFrame = 2;
+    constexpr const int MaxLevel = 12;
+    constexpr const int MaxFrames = 2000;
+
+    struct CameraKeyframe {
+        double x;
+        double y;
+        double altitude;
+        int nFrames;
+    };
+
+    struct RequestedTile {
+        TileIndex tileIndex;
+        float priority;
+    };
+
+    struct Frame {
+        // All tiles that are requested by the chunk tree in traversal order
+        std::vector<RequestedTile> requests;
+        // The tiles of all visible leaf chunks, that are needed for full resolution
+        std::vector<Key> fullResolution;
+    };
+
+    // Simulates the chunked LOD tree of a flat, square globe covering [0,1]x[0,1] that is
+    // seen from a camera looking straight down at (x, y) from the provided altitude.
+    // Chunks that are visible are split until their size is small enough compared to
+    // their distance to the camera. This mirrors RenderableGlobe::updateChunkTree
+    class ChunkTreeModel {
+    public:
+        Frame traverse(double x, double y, double altitude) const {
+            Frame frame;
+            traverse(TileIndex(0, 0, 0), x, y, altitude, frame);
+            return frame;
+        }
+
+    private:
+        void traverse(const TileIndex& ti, double cx, double cy, double altitude,
+                      Frame& frame) const
+        {
+            const double size = std::ldexp(1.0, -ti.level);
+            const double minX = ti.x * size;
+            const double minY = ti.y * size;
+
+            // The camera sees a square on the ground whose half-width is its altitude
+            const bool isVisible =
+                minX <= cx + altitude && cx - altitude <= minX + size &&
+                minY <= cy + altitude && cy - altitude <= minY + size;
+
+            const double dx = std::max({ minX - cx, 0.0, cx - (minX + size) });
+            const double dy = std::max({ minY - cy, 0.0, cy - (minY + size) });
+            const double distance = std::sqrt(dx * dx + dy * dy + altitude * altitude);
+            const int desiredLevel = std::clamp(
+                static_cast<int>(std::ceil(std::log2(2.0 / distance))),
+                0,
+                MaxLevel
+            );
+
+            // Same priority function as used by RenderableGlobe
+            float priority = -static_cast<float>(ti.level);
+            if (isVisible) {
+                const int deficit = std::max(desiredLevel - ti.level, 0);
+                priority = 1.f + deficit + 1.f / (ti.level + 1);
+            }
+            frame.requests.push_back({ ti, priority });
+
+            if (isVisible && desiredLevel > ti.level) {
+                for (int q = 0; q < 4; ++q) {
+                    const TileIndex child(
+                        2 * ti.x + q % 2,
+                        2 * ti.y + q / 2,
+                        static_cast<uint8_t>(ti.level + 1)
+                    );
+                    traverse(child, cx, cy, altitude, frame);
+                }
+            }
+            else if (isVisible) {
+                frame.fullResolution.push_back(ti.hashKey());
+            }
+        }
+    };
+
+    // The scheduling policy that was used before tile requests were prioritized. The
+    // most recently requested tile is loaded first and the least recently requested
+    // tile is dropped if too many tiles are enqueued
+    class MostRecentlyUsedScheduler {
+    public:
+        void request(const RequestedTile& tile) {
+            const Key key = tile.tileIndex.hashKey();
+            if (_queue.touch(key) || _enqueued.count(key) > 0) {
+                return;
+            }
+            for (const auto& [k, v] : _queue.putAndFetchPopped(key, true)) {
+                _enqueued.erase(k);
+            }
+            _enqueued.insert(key);
+        }
+
+        void endFrame() {}
+
+        std::optional<Key> pop() {
+            if (_queue.isEmpty()) {
+                return std::nullopt;
+            }
+            const Key key = _queue.popMRU().first;
+            _enqueued.erase(key);
+            return key;
+        }
+
+    private:
+        struct Hasher {
+            unsigned long long operator()(const Key& key) const {
+                return static_cast<unsigned long long>(key);
+            }
+        };
+
+        cache::LRUCache<Key, bool, Hasher> _queue{ QueueSize };
+        std::unordered_set<Key> _enqueued;
+    };
+
+    // The scheduling policy of the AsyncTileDataProvider. Tiles are enqueued with the
+    // priority of the previous frame and all queued requests are reprioritized and
+    // pruned once per frame
+    class PriorityScheduler {
+    public:
+        void request(const RequestedTile& tile) {
+            const Key key = tile.tileIndex.hashKey();
+            _requested.insert(key);
+            _current[key] = std::max(_current[key], tile.priority);
+            if (_queue.touch(key)) {
+                return;
+            }
+            const auto it = _previous.find(key);
+            const float priority = it != _previous.end() ? it->second : 0.f;
+            _queue.push(key, true, priority);
+        }
+
+        void endFrame() {
+            _queue.reprioritize([this](const Key& key, float p) -> std::optional<float> {
+                if (_requested.count(key) == 0) {
+                    return std::nullopt;
+                }
+                const auto it = _current.find(key);
+                return it != _current.end() ? it->second : p;
+            });
+            _requested.clear();
+            _previous = std::move(_current);
+            _current.clear();
+        }
+
+        std::optional<Key> pop() {
+            if (_queue.isEmpty()) {
+                return std::nullopt;
+            }
+            return _queue.pop().first;
+        }
+
+    private:
+        PriorityTaskQueue<Key, bool> _queue{ QueueSize };
+        std::unordered_set<Key> _requested;
+        std::unordered_map<Key, float> _current;
+        std::unordered_map<Key, float> _previous;
+    };
+
+    struct SimulationResult {
+        // The number of frames after the camera came to rest until all visible chunks
+        // had their tiles loaded, for each of the resting keyframes
+        std::vector<int> timeToFullResolution;
+        int nLoadedTiles = 0;
+    };
+
+    // Replays the camera path and returns, for every keyframe at which the camera stops
+    // moving, the number of frames until all tiles for the full resolution are loaded
+    template <typename Scheduler>
+    SimulationResult simulate(const std::vector<CameraKeyframe>& path) {
+        const ChunkTreeModel model;
+        Scheduler scheduler;
+        std::unordered_set<Key> loaded;
+        SimulationResult result;
+
+        auto runFrame = [&](double x, double y, double altitude) {
+            const Frame frame = model.traverse(x, y, altitude);
+            for (const RequestedTile& tile : frame.requests) {
+                if (loaded.count(tile.tileIndex.hashKey()) == 0) {
+                    scheduler.request(tile);
+                }
+            }
+            scheduler.endFrame();
+
+            for (int i = 0; i < TilesPerFrame; ++i) {
+                std::optional<Key> key = scheduler.pop();
+                if (!key.has_value()) {
+                    break;
+                }
+                loaded.insert(*key);
+                result.nLoadedTiles++;
+            }
+
+            return std::all_of(
+                frame.fullResolution.begin(),
+                frame.fullResolution.end(),
+                [&loaded](Key k) { return loaded.count(k) > 0; }
+            );
+        };
+
+        for (size_t i = 1; i < path.size(); ++i) {
+            const CameraKeyframe& from = path[i - 1];
+            const CameraKeyframe& to = path[i];
+            for (int f = 0; f < to.nFrames; ++f) {
+                const double t = static_cast<double>(f + 1) / to.nFrames;
+                // Interpolate the altitude exponentially to simulate a zooming camera
+                runFrame(
+                    from.x + t * (to.x - from.x),
+                    from.y + t * (to.y - from.y),
+                    from.altitude * std::pow(to.altitude / from.altitude, t)
+                );
+            }
+
+            // Rest at the keyframe until everything is loaded
+            int nFrames = 0;
+            while (!runFrame(to.x, to.y, to.altitude) && nFrames < MaxFrames) {
+                nFrames++;
+            }
+            result.timeToFullResolution.push_back(nFrames);
+        }
+        return result;
+    }
+
+    // A flyover at low altitude, followed by a zoom-out and a dive onto another region
+    const std::vector<CameraKeyframe> CameraPath = {
+        { 0.10, 0.10, 0.5, 0 },
+        { 0.15, 0.20, 0.01, 60 },
+        { 0.85, 0.70, 0.01, 90 },
+        { 0.50, 0.50, 0.4, 45 },
+        { 0.30, 0.80, 0.002, 90 },
+        { 0.35, 0.75, 0.002, 30 }
+    };
+} // namespace
+
+TEST_CASE("PriorityTaskQueue: Priority Order", "[tilescheduling]") {
+    PriorityTaskQueue<int, int> queue(10);
+    queue.push(1, 10, 1.f);
+    queue.push(2, 20, 3.f);
+    queue.push(3, 30, 2.f);
+
+    REQUIRE(queue.size() == 3);
+    REQUIRE(queue.pop() == std::pair(2, 20));
+    REQUIRE(queue.pop() == std::pair(3, 30));
+    REQUIRE(queue.pop() == std::pair(1, 10));
+    REQUIRE(queue.isEmpty());
+}
+
+TEST_CASE("PriorityTaskQueue: Equal Priority Is Most Recently Used", "[tilescheduling]") {
+    PriorityTaskQueue<int, int> queue(10);
+    queue.push(1, 10, 0.f);
+    queue.push(2, 20, 0.f);
+    queue.push(3, 30, 0.f);
+    REQUIRE(queue.touch(1));
+    REQUIRE_FALSE(queue.touch(4));
+
+    REQUIRE(queue.popAllKeys() == std::vector<int>{ 1, 3, 2 });
+}
+
+TEST_CASE("PriorityTaskQueue: Evicts Lowest Priority", "[tilescheduling]") {
+    PriorityTaskQueue<int, int> queue(2);
+    REQUIRE(queue.push(1, 10, 5.f).empty());
+    REQUIRE(queue.push(2, 20, 1.f).empty());
+
+    // The new task has a higher priority than task 2, which gets dropped
+    REQUIRE(queue.push(3, 30, 2.f) == std::vector<int>{ 2 });
+    // The new task has the lowest priority and is not enqueued at all
+    REQUIRE(queue.push(4, 40, 0.f) == std::vector<int>{ 4 });
+
+    REQUIRE(queue.size() == 2);
+    REQUIRE(queue.exist(1));
+    REQUIRE(queue.exist(3));
+    REQUIRE_FALSE(queue.exist(4));
+}
+
+TEST_CASE("PriorityTaskQueue: Push Existing Key", "[tilescheduling]") {
+    PriorityTaskQueue<int, int> queue(2);
+    queue.push(1, 10, 1.f);
+    queue.push(2, 20, 2.f);
+
+    // Pushing an existing key replaces the task and does not evict anything
+    REQUIRE(queue.push(1, 11, 3.f).empty());
+    REQUIRE(queue.size() == 2);
+    REQUIRE(queue.pop() == std::pair(1, 11));
+}
+
+TEST_CASE("PriorityTaskQueue: Reprioritize", "[tilescheduling]") {
+    PriorityTaskQueue<int, int> queue(10);
+    for (int i = 0; i < 6; ++i) {
+        queue.push(i, i, static_cast<float>(i));
+    }
+    REQUIRE(queue.setPriority(0, 100.f));
+    REQUIRE_FALSE(queue.setPriority(7, 100.f));
+
+    // Invert the priorities of the even tasks and cancel the odd ones
+    std::vector<int> cancelled = queue.reprioritize(
+        [](int key, float priority) -> std::optional<float> {
+            if (key % 2 == 1) {
+                return std::nullopt;
+            }
+            return key == 0 ? priority : -priority;
+        }
+    );
+    std::sort(cancelled.begin(), cancelled.end());
+    REQUIRE(cancelled == std::vector<int>{ 1, 3, 5 });
+    REQUIRE(queue.popAllKeys() == std::vector<int>{ 0, 2, 4 });
+}
+
+TEST_CASE("TileScheduling: Camera Path Time To Full Resolution", "[tilescheduling]") {
+    // The simulation is fully deterministic, so the results are stable between runs
+    const SimulationResult mru = simulate<MostRecentlyUsedScheduler>(CameraPath);
+    const SimulationResult prio = simulate<PriorityScheduler>(CameraPath);
+
+    REQUIRE(mru.timeToFullResolution.size() == CameraPath.size() - 1);
+    REQUIRE(prio.timeToFullResolution.size() == CameraPath.size() - 1);
+
+    int totalMru = 0;
+    int totalPrio = 0;
+    for (size_t i = 0; i < mru.timeToFullResolution.size(); ++i) {
+        INFO(fmt::format("Keyframe {}", i + 1));
+        // Every keyframe must eventually reach full resolution
+        REQUIRE(prio.timeToFullResolution[i] < MaxFrames);
+        totalMru += mru.timeToFullResolution[i];
+        totalPrio += prio.timeToFullResolution[i];
+    }
+    REQUIRE(totalPrio < totalMru);
+    // Cancelling stale requests means that fewer tiles are loaded in total
+    REQUIRE(prio.nLoadedTiles <= mru.nLoadedTiles);
+}
@@ -0,0 +1,374 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2021                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/base/rendering/trailsampler.h>
+#include <modules/space/translation/keplertranslation.h>
+#include <modules/space/translation/spicetranslation.h>
+#include <openspace/util/spicemanager.h>
+#include <openspace/util/time.h>
+#include <openspace/util/updatestructures.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/dictionary.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace {
+    glm::dvec3 trajectory(double time) {
+        return glm::dvec3(
+            1e6 * std::cos(time * 1e-4),
+            1e6 * std::sin(time * 1e-4),
+            time
+        );
+    }
+
+    // Counts the calls to the trajectory and records the threads they happened on
+    struct CountingSampler {
+        glm::dvec3 operator()(double time) {
+            ++nCalls;
+            {
+                std::lock_guard lock(mutex);
+                threadIds.insert(std::this_thread::get_id());
+            }
+            return trajectory(time);
+        }
+
+        std::atomic_int nCalls = 0;
+        std::mutex mutex;
+        std::set<std::thread::id> threadIds;
+    };
+
+    openspace::TrailSampler::Sampler wrap(CountingSampler& sampler) {
+        return [&sampler](double time) { return sampler(time); };
+    }
+
+    void checkExact(const std::vector<glm::vec3>& positions, double start,
+                    double interval, int nValues)
+    {
+        REQUIRE(positions.size() == static_cast<size_t>(nValues));
+        for (int i = 0; i < nValues; ++i) {
+            const glm::vec3 expected = glm::vec3(trajectory(start + i * interval));
+            REQUIRE(positions[i].x == expected.x);
+            REQUIRE(positions[i].y == expected.y);
+            REQUIRE(positions[i].z == expected.z);
+        }
+    }
+} // namespace
+
+TEST_CASE("TrailSampler: Parallel Matches Direct Sampling", "[trailsampler]") {
+    using namespace openspace;
+
+    for (int nValues : { 0, 1, 2, 3, 255, 256, 257, 511, 513, 10000, 100001 }) {
+        CountingSampler counter;
+        TrailSampler sampler(wrap(counter));
+
+        TrailSampler::Request request;
+        request.start = -5000.0;
+        request.interval = 60.0;
+        request.nValues = nValues;
+        request.isThreadSafe = true;
+        sampler.request(request);
+        sampler.waitUntilFinished();
+
+        REQUIRE(sampler.isFinished());
+        std::optional<TrailSampler::Result> result = sampler.popResult();
+        REQUIRE(result.has_value());
+        REQUIRE(result->isFinal);
+        checkExact(result->positions, request.start, request.interval, nValues);
+        // Every sample is computed exactly once
+        REQUIRE(counter.nCalls == nValues);
+        REQUIRE_FALSE(sampler.popResult().has_value());
+    }
+}
+
+TEST_CASE("TrailSampler: Progressive Refinement", "[trailsampler]") {
+    using namespace openspace;
+
+    constexpr const int NValues = 5000;
+    CountingSampler counter;
+    TrailSampler sampler(wrap(counter));
+
+    TrailSampler::Request request;
+    request.start = 0.0;
+    request.interval = 10.0;
+    request.nValues = NValues;
+    request.isThreadSafe = false;
+    sampler.request(request);
+
+    std::vector<TrailSampler::Result> results;
+    while (!sampler.isFinished()) {
+        sampler.update(std::chrono::microseconds(0));
+        std::optional<TrailSampler::Result> result = sampler.popResult();
+        if (result.has_value()) {
+            results.push_back(std::move(*result));
+        }
+    }
+
+    // 5000 samples start with a stride of 16 and refine over 4 passes
+    REQUIRE(results.size() == 5);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const TrailSampler::Result& r = results[i];
+        REQUIRE(r.isFinal == (i == results.size() - 1));
+        REQUIRE(r.positions.size() == NValues);
+
+        // The computed samples are always exact, no matter how coarse the pass
+        const int stride = 16 >> i;
+        for (int j = 0; j < NValues; j += stride) {
+            REQUIRE(r.positions[j].z == static_cast<float>(j * request.interval));
+        }
+        REQUIRE(r.positions.back().z == static_cast<float>((NValues - 1) * 10.0));
+
+        // The interpolated samples lie between their computed neighbors
+        for (int j = 0; j < NValues; ++j) {
+            REQUIRE(r.positions[j].z == Approx(j * request.interval).margin(1e-2));
+        }
+    }
+    checkExact(results.back().positions, request.start, request.interval, NValues);
+    REQUIRE(counter.nCalls == NValues);
+
+    // Requests that are not thread safe are only sampled on the calling thread
+    REQUIRE(counter.threadIds.size() == 1);
+    REQUIRE(*counter.threadIds.begin() == std::this_thread::get_id());
+}
+
+TEST_CASE("TrailSampler: New Request Replaces Old", "[trailsampler]") {
+    using namespace openspace;
+
+    CountingSampler counter;
+    TrailSampler sampler(wrap(counter));
+
+    TrailSampler::Request first;
+    first.start = 0.0;
+    first.interval = 1.0;
+    first.nValues = 500000;
+    first.isThreadSafe = true;
+    sampler.request(first);
+
+    TrailSampler::Request second = first;
+    second.start = 1e6;
+    second.nValues = 20000;
+    sampler.request(second);
+    sampler.waitUntilFinished();
+
+    std::optional<TrailSampler::Result> result = sampler.popResult();
+    REQUIRE(result.has_value());
+    REQUIRE(result->isFinal);
+    checkExact(result->positions, second.start, second.interval, second.nValues);
+
+    // Cancelling drops the request and everything that was published for it
+    sampler.request(first);
+    sampler.cancel();
+    sampler.waitUntilFinished();
+    REQUIRE(sampler.isFinished());
+    REQUIRE_FALSE(sampler.popResult().has_value());
+}
+
+TEST_CASE("TrailSampler: Disk Cache", "[trailsampler]") {
+    using namespace openspace;
+
+    const std::string path = absPath("${TESTDIR}/trailsampler.cache");
+    std::filesystem::remove(path);
+
+    TrailSampler::Request request;
+    request.start = 100.0;
+    request.interval = 30.0;
+    request.nValues = 3000;
+    request.cacheFile = path;
+    request.cacheKey = "Translation|100|30|3000";
+
+    for (bool isThreadSafe : { true, false }) {
+        request.isThreadSafe = isThreadSafe;
+
+        // The first time the trail is sampled and written to the cache ...
+        {
+            std::filesystem::remove(path);
+            CountingSampler counter;
+            TrailSampler sampler(wrap(counter));
+            sampler.request(request);
+            while (!sampler.isFinished()) {
+                sampler.update(std::chrono::milliseconds(1));
+            }
+            sampler.waitUntilFinished();
+            REQUIRE(counter.nCalls == request.nValues);
+            REQUIRE(sampler.nCacheHits() == 0);
+            REQUIRE(std::filesystem::exists(path));
+        }
+
+        // ... after which it is loaded without calling the sampler
+        {
+            CountingSampler counter;
+            TrailSampler sampler(wrap(counter));
+            sampler.request(request);
+            sampler.waitUntilFinished();
+            REQUIRE(sampler.isFinished());
+            REQUIRE(counter.nCalls == 0);
+            REQUIRE(sampler.nCacheHits() == 1);
+
+            std::optional<TrailSampler::Result> result = sampler.popResult();
+            REQUIRE(result.has_value());
+            REQUIRE(result->isFinal);
+            checkExact(result->positions, request.start, request.interval, 3000);
+        }
+
+        // A different key ignores the cached file
+        {
+            TrailSampler::Request changed = request;
+            changed.cacheKey = "Translation|100|30|3000|other";
+            CountingSampler counter;
+            TrailSampler sampler(wrap(counter));
+            sampler.request(changed);
+            while (!sampler.isFinished()) {
+                sampler.update(std::chrono::milliseconds(1));
+            }
+            sampler.waitUntilFinished();
+            REQUIRE(counter.nCalls == changed.nValues);
+            REQUIRE(sampler.nCacheHits() == 0);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("TrailSampler: Change Target While Sampling", "[trailsampler]") {
+    using namespace openspace;
+    SpiceManager::initialize();
+    const char* kernels[] = {
+        "${TESTDIR}/SpiceTest/spicekernels/naif0008.tls",
+        "${TESTDIR}/SpiceTest/spicekernels/981005_PLTEPH-DE405S.bsp"
+    };
+    for (const char* kernel : kernels) {
+        SpiceManager::ref().loadKernel(absPath(kernel));
+    }
+
+    {
+        ghoul::Dictionary dictionary;
+        dictionary.setValue("Target", std::string("EARTH"));
+        dictionary.setValue("Observer", std::string("SUN"));
+        dictionary.setValue("Frame", std::string("J2000"));
+        dictionary.setValue("UseEphemerisCache", true);
+        SpiceTranslation translation(dictionary);
+        REQUIRE(translation.isThreadSafe());
+
+        TrailSampler sampler([&translation](double time) {
+            return translation.position({ {}, Time(time), Time(0.0) });
+        });
+
+        const double center =
+            SpiceManager::ref().ephemerisTimeFromDate("2004 jun 11 19:32:00");
+        TrailSampler::Request request;
+        request.start = center - 15 * 86400.0;
+        request.interval = 60.0;
+        request.nValues = 30 * 1440;
+        request.isThreadSafe = true;
+
+        // Every change replaces the ephemeris cache while the passes of the previous
+        // request are still using it, and SPICE is called from this thread concurrently
+        for (const char* target : { "MOON", "EARTH", "MARS BARYCENTER", "MOON" }) {
+            sampler.request(request);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            translation.property("Target")->set(std::string(target));
+            for (int i = 0; i < 100; ++i) {
+                const double t = request.start + i * 3600.0;
+                SpiceManager::ref().targetPosition("EARTH", "SUN", "J2000", {}, t);
+                SpiceManager::ref().dateFromEphemerisTime(t);
+            }
+        }
+
+        sampler.request(request);
+        sampler.waitUntilFinished();
+        std::optional<TrailSampler::Result> result = sampler.popResult();
+        REQUIRE(result.has_value());
+        REQUIRE(result->isFinal);
+        REQUIRE(result->positions.size() == static_cast<size_t>(request.nValues));
+
+        // The finished trail belongs to the last target. The samples are stored as
+        // floats, so they are only compared up to their precision
+        for (int i = 0; i < request.nValues; i += 997) {
+            const glm::dvec3 expected = SpiceManager::ref().targetPosition(
+                "MOON",
+                "SUN",
+                "J2000",
+                {},
+                request.start + i * request.interval
+            ) * 1000.0;
+            const glm::dvec3 sampled = glm::dvec3(result->positions[i]);
+            REQUIRE(glm::length(sampled - expected) <= 1e-6 * glm::length(expected));
+        }
+    }
+
+    SpiceManager::deinitialize();
+}
+
+TEST_CASE("TrailSampler: Change Kepler Elements While Sampling", "[trailsampler]") {
+    using namespace openspace;
+
+    KeplerTranslation translation;
+    translation.setKeplerElements(0.1, 7000.0, 30.0, 40.0, 50.0, 60.0, 6000.0, 0.0);
+    REQUIRE(translation.isThreadSafe());
+
+    TrailSampler sampler([&translation](double time) {
+        return translation.position({ {}, Time(time), Time(0.0) });
+    });
+
+    TrailSampler::Request request;
+    request.start = 0.0;
+    request.interval = 1.0;
+    request.nValues = 100000;
+    request.isThreadSafe = true;
+
+    // Every change replaces the orbit on this thread while the passes of the previous
+    // request are still evaluating the old one on the worker threads
+    for (double inclination : { 10.0, 80.0, 120.0, 45.0 }) {
+        sampler.request(request);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        translation.property("Inclination")->set(inclination);
+        translation.property("Eccentricity")->set(inclination / 200.0);
+        translation.property("Period")->set(inclination * 100.0);
+    }
+
+    sampler.request(request);
+    sampler.waitUntilFinished();
+    std::optional<TrailSampler::Result> result = sampler.popResult();
+    REQUIRE(result.has_value());
+    REQUIRE(result->isFinal);
+    REQUIRE(result->positions.size() == static_cast<size_t>(request.nValues));
+
+    // The finished trail belongs to the final elements
+    KeplerTranslation reference;
+    reference.setKeplerElements(0.225, 7000.0, 45.0, 40.0, 50.0, 60.0, 4500.0, 0.0);
+    for (int i = 0; i < request.nValues; i += 997) {
+        const double time = request.start + i * request.interval;
+        const glm::vec3 expected =
+            glm::vec3(reference.position({ {}, Time(time), Time(0.0) }));
+        REQUIRE(result->positions[i].x == expected.x);
+        REQUIRE(result->positions[i].y == expected.y);
+        REQUIRE(result->positions[i].z == expected.z);
+    }
+}